@@ -0,0 +1,102 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GenerateAccount.h"
+#include "SyntheticAccountGenerator.h"
+
+#include <quentier/utility/EventLoopWithExitStatus.h>
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QTimer>
+
+#include <cmath>
+#include <iostream>
+
+namespace quentier {
+
+bool generateAccount(
+    const GeneratorOptions & options,
+    LocalStorageManagerAsync & localStorageManager,
+    ErrorString & errorDescription)
+{
+    auto * pGenerator =
+        new SyntheticAccountGenerator(options, localStorageManager);
+
+    auto * pGeneratorThread = new QThread;
+
+    pGeneratorThread->setObjectName(
+        QStringLiteral("SyntheticAccountGeneratorThread"));
+
+    QObject::connect(
+        pGeneratorThread, &QThread::finished, pGeneratorThread,
+        &QThread::deleteLater);
+
+    pGeneratorThread->start();
+    pGenerator->moveToThread(pGeneratorThread);
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    auto status = EventLoopWithExitStatus::ExitStatus::Failure;
+    {
+        EventLoopWithExitStatus loop;
+
+        QObject::connect(
+            pGenerator, &SyntheticAccountGenerator::finished, &loop,
+            &EventLoopWithExitStatus::exitAsSuccess);
+
+        QObject::connect(
+            pGenerator, &SyntheticAccountGenerator::failure, &loop,
+            &EventLoopWithExitStatus::exitAsFailureWithErrorString);
+
+        quint32 lastReportedProgress = 0;
+        QObject::connect(
+            pGenerator, &SyntheticAccountGenerator::progress, &loop,
+            [&lastReportedProgress](double percentage) {
+                quint32 roundedPercentage = static_cast<quint32>(
+                    std::max(std::floor(percentage * 100.0), 0.0));
+
+                if (roundedPercentage > lastReportedProgress) {
+                    std::cout << "Generating account: " << roundedPercentage
+                              << "%" << std::endl;
+                    lastReportedProgress = roundedPercentage;
+                }
+            });
+
+        QTimer::singleShot(0, pGenerator, SLOT(start()));
+
+        Q_UNUSED(loop.exec())
+        status = loop.exitStatus();
+        errorDescription = loop.errorDescription();
+    }
+
+    pGenerator->deleteLater();
+    pGeneratorThread->quit();
+
+    if (status == EventLoopWithExitStatus::ExitStatus::Success) {
+        std::cout << "Generated account in " << elapsedTimer.elapsed()
+                  << " ms" << std::endl;
+        errorDescription.clear();
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace quentier
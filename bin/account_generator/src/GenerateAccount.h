@@ -0,0 +1,44 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_ACCOUNT_GENERATOR_GENERATE_ACCOUNT_H
+#define QUENTIER_ACCOUNT_GENERATOR_GENERATE_ACCOUNT_H
+
+#include "ProcessGeneratorOptions.h"
+
+#include <quentier/types/ErrorString.h>
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
+
+/**
+ * Generates synthetic account contents and adds them to the local storage,
+ * blocks until done while reporting progress to stdout
+ *
+ * @return                          True if the account was generated
+ *                                  successfully, false otherwise
+ */
+bool generateAccount(
+    const GeneratorOptions & options,
+    LocalStorageManagerAsync & localStorageManager,
+    ErrorString & errorDescription);
+
+} // namespace quentier
+
+#endif // QUENTIER_ACCOUNT_GENERATOR_GENERATE_ACCOUNT_H
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProcessGeneratorOptions.h"
+
+#include <lib/initialization/Initialize.h>
+
+#include <QDebug>
+
+namespace quentier {
+
+namespace {
+
+bool processNumberOption(
+    const CommandLineParser::Options & options, const QString & optionName,
+    quint32 & value)
+{
+    auto it = options.find(optionName);
+    if (it == options.end()) {
+        return true;
+    }
+
+    bool conversionResult = false;
+    quint32 num = it.value().toUInt(&conversionResult);
+    if (!conversionResult) {
+        qWarning() << "Failed to parse " << optionName
+                   << " option value to unsigned integer";
+        return false;
+    }
+
+    value = num;
+    return true;
+}
+
+} // namespace
+
+void prepareAvailableCommandLineOptions(
+    QHash<QString, CommandLineParser::OptionData> & options)
+{
+    using ArgumentType = CommandLineParser::ArgumentType;
+
+    composeCommonAvailableCommandLineOptions(options);
+
+    auto & newAccountData = options[QStringLiteral("new-account")];
+
+    newAccountData.m_description =
+        QStringLiteral("add generated notes to a new local account");
+
+    auto & seedData = options[QStringLiteral("seed")];
+    seedData.m_type = ArgumentType::Int;
+
+    seedData.m_description = QStringLiteral(
+        "seed for generated data; the same seed and options always "
+        "produce the same account; by default 0");
+
+    auto & numNotebooksData = options[QStringLiteral("num-notebooks")];
+    numNotebooksData.m_type = ArgumentType::Int;
+
+    numNotebooksData.m_description =
+        QStringLiteral("number of notebooks to generate; by default 10");
+
+    auto & numTagsData = options[QStringLiteral("num-tags")];
+    numTagsData.m_type = ArgumentType::Int;
+
+    numTagsData.m_description =
+        QStringLiteral("number of tags to generate; by default 100");
+
+    auto & numNotesData = options[QStringLiteral("num-notes")];
+    numNotesData.m_type = ArgumentType::Int;
+
+    numNotesData.m_description =
+        QStringLiteral("number of notes to generate");
+
+    auto & minTagsPerNote = options[QStringLiteral("min-tags-per-note")];
+    minTagsPerNote.m_type = ArgumentType::Int;
+
+    minTagsPerNote.m_description =
+        QStringLiteral("min number of tags assigned to each generated note");
+
+    auto & maxTagsPerNote = options[QStringLiteral("max-tags-per-note")];
+    maxTagsPerNote.m_type = ArgumentType::Int;
+
+    maxTagsPerNote.m_description =
+        QStringLiteral("max number of tags assigned to each generated note");
+
+    auto & maxResourcesPerNote =
+        options[QStringLiteral("max-resources-per-note")];
+
+    maxResourcesPerNote.m_type = ArgumentType::Int;
+
+    maxResourcesPerNote.m_description = QStringLiteral(
+        "max number of image resources attached to generated notes; "
+        "by default 3");
+
+    auto & batchSizeData = options[QStringLiteral("batch-size")];
+    batchSizeData.m_type = ArgumentType::Int;
+
+    batchSizeData.m_description = QStringLiteral(
+        "number of items sent to the local storage at once; by default 500");
+}
+
+bool processGeneratorOptions(
+    const CommandLineParser::Options & options,
+    GeneratorOptions & generatorOptions)
+{
+    bool res = processNumberOption(
+        options, QStringLiteral("seed"), generatorOptions.m_seed);
+
+    if (!res) {
+        return false;
+    }
+
+    res = processNumberOption(
+        options, QStringLiteral("num-notebooks"),
+        generatorOptions.m_numNotebooks);
+
+    if (!res) {
+        return false;
+    }
+
+    if (generatorOptions.m_numNotebooks == 0) {
+        qWarning() << "At least one notebook is required to put notes into";
+        return false;
+    }
+
+    res = processNumberOption(
+        options, QStringLiteral("num-tags"), generatorOptions.m_numTags);
+
+    if (!res) {
+        return false;
+    }
+
+    res = processNumberOption(
+        options, QStringLiteral("max-resources-per-note"),
+        generatorOptions.m_maxResourcesPerNote);
+
+    if (!res) {
+        return false;
+    }
+
+    res = processNumberOption(
+        options, QStringLiteral("batch-size"), generatorOptions.m_batchSize);
+
+    if (!res) {
+        return false;
+    }
+
+    if (generatorOptions.m_batchSize == 0) {
+        qWarning() << "Batch size must be positive";
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace quentier
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_ACCOUNT_GENERATOR_PROCESS_GENERATOR_OPTIONS_H
+#define QUENTIER_ACCOUNT_GENERATOR_PROCESS_GENERATOR_OPTIONS_H
+
+#include <lib/initialization/CommandLineParser.h>
+
+namespace quentier {
+
+/**
+ * @brief The GeneratorOptions struct describes the shape of the synthetic
+ * account to generate; the same options along with the same seed always
+ * produce the same account contents
+ */
+struct GeneratorOptions
+{
+    quint32 m_seed = 0;
+
+    quint32 m_numNotebooks = 10;
+    quint32 m_numTags = 100;
+    quint32 m_numNotes = 0;
+
+    quint32 m_minTagsPerNote = 0;
+    quint32 m_maxTagsPerNote = 0;
+
+    quint32 m_maxResourcesPerNote = 3;
+
+    // Max number of items sent to the local storage at once
+    quint32 m_batchSize = 500;
+};
+
+void prepareAvailableCommandLineOptions(
+    QHash<QString, CommandLineParser::OptionData> & options);
+
+/**
+ * Processes command line options specific to the account generator; number
+ * of notes and tags per note are processed separately via
+ * processNoteOptions and processTagOptions
+ *
+ * @param options                   Command line options
+ * @param generatorOptions          Parsed generator options
+ * @return                          True if command line options were
+ *                                  processed successfully, false otherwise
+ */
+bool processGeneratorOptions(
+    const CommandLineParser::Options & options,
+    GeneratorOptions & generatorOptions);
+
+} // namespace quentier
+
+#endif // QUENTIER_ACCOUNT_GENERATOR_PROCESS_GENERATOR_OPTIONS_H
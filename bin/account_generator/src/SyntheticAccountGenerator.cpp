@@ -0,0 +1,274 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyntheticAccountGenerator.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/local_storage/LocalStorageManagerAsync.h>
+#include <quentier/logging/QuentierLogger.h>
+
+#include <algorithm>
+
+namespace quentier {
+
+SyntheticAccountGenerator::SyntheticAccountGenerator(
+    const GeneratorOptions & options,
+    LocalStorageManagerAsync & localStorageManager, QObject * parent) :
+    QObject(parent),
+    m_options(options), m_generator(options)
+{
+    createConnections(localStorageManager);
+}
+
+SyntheticAccountGenerator::~SyntheticAccountGenerator() = default;
+
+void SyntheticAccountGenerator::start()
+{
+    QNDEBUG(
+        "account_generator",
+        "SyntheticAccountGenerator::start: seed = "
+            << m_options.m_seed << ", num notebooks = "
+            << m_options.m_numNotebooks << ", num tags = "
+            << m_options.m_numTags << ", num notes = " << m_options.m_numNotes
+            << ", batch size = " << m_options.m_batchSize);
+
+    if (Q_UNLIKELY(m_started)) {
+        QNWARNING(
+            "account_generator",
+            "SyntheticAccountGenerator is already started");
+        return;
+    }
+
+    m_started = true;
+    m_stage = Stage::Notebooks;
+    m_nextItemIndex = 0;
+    m_numAddedItems = 0;
+
+    advance();
+}
+
+void SyntheticAccountGenerator::onAddNotebookComplete(
+    Notebook notebook, QUuid requestId)
+{
+    Q_UNUSED(notebook)
+    onItemAdded(requestId);
+}
+
+void SyntheticAccountGenerator::onAddNotebookFailed(
+    Notebook notebook, ErrorString errorDescription, QUuid requestId)
+{
+    if (m_addRequestIds.contains(requestId)) {
+        QNWARNING(
+            "account_generator",
+            "Failed to add notebook: " << errorDescription << ", notebook: "
+                                       << notebook);
+    }
+
+    onItemAddingFailed(requestId, errorDescription);
+}
+
+void SyntheticAccountGenerator::onAddTagComplete(Tag tag, QUuid requestId)
+{
+    Q_UNUSED(tag)
+    onItemAdded(requestId);
+}
+
+void SyntheticAccountGenerator::onAddTagFailed(
+    Tag tag, ErrorString errorDescription, QUuid requestId)
+{
+    if (m_addRequestIds.contains(requestId)) {
+        QNWARNING(
+            "account_generator",
+            "Failed to add tag: " << errorDescription << ", tag: " << tag);
+    }
+
+    onItemAddingFailed(requestId, errorDescription);
+}
+
+void SyntheticAccountGenerator::onAddNoteComplete(Note note, QUuid requestId)
+{
+    Q_UNUSED(note)
+    onItemAdded(requestId);
+}
+
+void SyntheticAccountGenerator::onAddNoteFailed(
+    Note note, ErrorString errorDescription, QUuid requestId)
+{
+    if (m_addRequestIds.contains(requestId)) {
+        QNWARNING(
+            "account_generator",
+            "Failed to add note: " << errorDescription << ", note: " << note);
+    }
+
+    onItemAddingFailed(requestId, errorDescription);
+}
+
+void SyntheticAccountGenerator::createConnections(
+    LocalStorageManagerAsync & localStorageManager)
+{
+    QObject::connect(
+        this, &SyntheticAccountGenerator::addNotebook, &localStorageManager,
+        &LocalStorageManagerAsync::onAddNotebookRequest);
+
+    QObject::connect(
+        this, &SyntheticAccountGenerator::addTag, &localStorageManager,
+        &LocalStorageManagerAsync::onAddTagRequest);
+
+    QObject::connect(
+        this, &SyntheticAccountGenerator::addNote, &localStorageManager,
+        &LocalStorageManagerAsync::onAddNoteRequest);
+
+    QObject::connect(
+        &localStorageManager, &LocalStorageManagerAsync::addNotebookComplete,
+        this, &SyntheticAccountGenerator::onAddNotebookComplete);
+
+    QObject::connect(
+        &localStorageManager, &LocalStorageManagerAsync::addNotebookFailed,
+        this, &SyntheticAccountGenerator::onAddNotebookFailed);
+
+    QObject::connect(
+        &localStorageManager, &LocalStorageManagerAsync::addTagComplete, this,
+        &SyntheticAccountGenerator::onAddTagComplete);
+
+    QObject::connect(
+        &localStorageManager, &LocalStorageManagerAsync::addTagFailed, this,
+        &SyntheticAccountGenerator::onAddTagFailed);
+
+    QObject::connect(
+        &localStorageManager, &LocalStorageManagerAsync::addNoteComplete, this,
+        &SyntheticAccountGenerator::onAddNoteComplete);
+
+    QObject::connect(
+        &localStorageManager, &LocalStorageManagerAsync::addNoteFailed, this,
+        &SyntheticAccountGenerator::onAddNoteFailed);
+}
+
+void SyntheticAccountGenerator::onItemAdded(const QUuid & requestId)
+{
+    if (!m_addRequestIds.remove(requestId)) {
+        return;
+    }
+
+    ++m_numAddedItems;
+    updateProgress();
+    advance();
+}
+
+void SyntheticAccountGenerator::onItemAddingFailed(
+    const QUuid & requestId, ErrorString errorDescription)
+{
+    if (!m_addRequestIds.remove(requestId)) {
+        return;
+    }
+
+    m_addRequestIds.clear();
+    m_started = false;
+
+    Q_EMIT failure(errorDescription);
+}
+
+quint32 SyntheticAccountGenerator::numItemsInStage(const Stage stage) const
+{
+    switch (stage) {
+    case Stage::Notebooks:
+        return m_options.m_numNotebooks;
+    case Stage::Tags:
+        return m_options.m_numTags;
+    case Stage::Notes:
+        return m_options.m_numNotes;
+    default:
+        return 0;
+    }
+}
+
+void SyntheticAccountGenerator::advance()
+{
+    if (!m_started) {
+        return;
+    }
+
+    quint32 numItems = numItemsInStage(m_stage);
+
+    // Items of the next stage depend on items of the current one so
+    // switch stages only once everything is in the local storage
+    while ((m_stage != Stage::Finished) && (m_nextItemIndex >= numItems) &&
+           m_addRequestIds.isEmpty())
+    {
+        m_stage = static_cast<Stage>(static_cast<int>(m_stage) + 1);
+        m_nextItemIndex = 0;
+        numItems = numItemsInStage(m_stage);
+
+        QNDEBUG(
+            "account_generator",
+            "Switched to stage " << static_cast<int>(m_stage) << ", "
+                                 << numItems << " items to add");
+    }
+
+    if (m_stage == Stage::Finished) {
+        m_started = false;
+        Q_EMIT finished();
+        return;
+    }
+
+    const int batchSize = static_cast<int>(m_options.m_batchSize);
+    if (m_addRequestIds.size() > batchSize / 2) {
+        return;
+    }
+
+    while ((m_nextItemIndex < numItems) &&
+           (m_addRequestIds.size() < batchSize))
+    {
+        QUuid requestId = QUuid::createUuid();
+        Q_UNUSED(m_addRequestIds.insert(requestId))
+
+        switch (m_stage) {
+        case Stage::Notebooks:
+            Q_EMIT addNotebook(
+                m_generator.notebook(m_nextItemIndex), requestId);
+            break;
+        case Stage::Tags:
+            Q_EMIT addTag(m_generator.tag(m_nextItemIndex), requestId);
+            break;
+        case Stage::Notes:
+            Q_EMIT addNote(m_generator.note(m_nextItemIndex), requestId);
+            break;
+        default:
+            break;
+        }
+
+        ++m_nextItemIndex;
+    }
+}
+
+void SyntheticAccountGenerator::updateProgress()
+{
+    quint64 numItems = static_cast<quint64>(m_options.m_numNotebooks) +
+        m_options.m_numTags + m_options.m_numNotes;
+
+    if (numItems == 0) {
+        return;
+    }
+
+    double percentage =
+        static_cast<double>(m_numAddedItems) / static_cast<double>(numItems);
+
+    Q_EMIT progress(std::min(percentage, 1.0));
+}
+
+} // namespace quentier
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_ACCOUNT_GENERATOR_SYNTHETIC_ACCOUNT_GENERATOR_H
+#define QUENTIER_ACCOUNT_GENERATOR_SYNTHETIC_ACCOUNT_GENERATOR_H
+
+#include "SyntheticDataGenerator.h"
+
+#include <quentier/types/ErrorString.h>
+
+#include <QObject>
+#include <QSet>
+#include <QUuid>
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
+
+/**
+ * @brief The SyntheticAccountGenerator class adds generated notebooks, tags
+ * and notes to the local storage.
+ *
+ * Items are sent to the local storage in batches: the next batch is
+ * generated and sent once the local storage has processed at least half of
+ * the previous one so the local storage thread always has work to do while
+ * the number of items held in memory stays bounded.
+ */
+class SyntheticAccountGenerator final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SyntheticAccountGenerator(
+        const GeneratorOptions & options,
+        LocalStorageManagerAsync & localStorageManager,
+        QObject * parent = nullptr);
+
+    virtual ~SyntheticAccountGenerator() override;
+
+Q_SIGNALS:
+    void finished();
+    void failure(ErrorString errorDescription);
+    void progress(double percentage);
+
+    // private signals
+    void addNotebook(Notebook notebook, QUuid requestId);
+    void addTag(Tag tag, QUuid requestId);
+    void addNote(Note note, QUuid requestId);
+
+public Q_SLOTS:
+    void start();
+
+private Q_SLOTS:
+    void onAddNotebookComplete(Notebook notebook, QUuid requestId);
+
+    void onAddNotebookFailed(
+        Notebook notebook, ErrorString errorDescription, QUuid requestId);
+
+    void onAddTagComplete(Tag tag, QUuid requestId);
+    void onAddTagFailed(Tag tag, ErrorString errorDescription, QUuid requestId);
+
+    void onAddNoteComplete(Note note, QUuid requestId);
+
+    void onAddNoteFailed(
+        Note note, ErrorString errorDescription, QUuid requestId);
+
+private:
+    enum class Stage
+    {
+        Notebooks = 0,
+        Tags,
+        Notes,
+        Finished
+    };
+
+    void createConnections(LocalStorageManagerAsync & localStorageManager);
+
+    void onItemAdded(const QUuid & requestId);
+    void onItemAddingFailed(
+        const QUuid & requestId, ErrorString errorDescription);
+
+    quint32 numItemsInStage(const Stage stage) const;
+
+    // Sends the next batch of items to the local storage if the previous
+    // one has been processed enough, switches to the next stage if the
+    // current one is complete
+    void advance();
+
+    void updateProgress();
+
+private:
+    const GeneratorOptions m_options;
+    const SyntheticDataGenerator m_generator;
+
+    Stage m_stage = Stage::Notebooks;
+    bool m_started = false;
+
+    // Index of the next item to generate within the current stage
+    quint32 m_nextItemIndex = 0;
+
+    quint32 m_numAddedItems = 0;
+    QSet<QUuid> m_addRequestIds;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_ACCOUNT_GENERATOR_SYNTHETIC_ACCOUNT_GENERATOR_H
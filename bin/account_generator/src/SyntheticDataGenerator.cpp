@@ -0,0 +1,391 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyntheticDataGenerator.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+
+// 2015-01-01T00:00:00Z
+#define SYNTHETIC_DATA_BASE_TIMESTAMP (Q_INT64_C(1420070400000))
+
+#define SYNTHETIC_DATA_MSEC_PER_DAY (Q_INT64_C(86400000))
+
+namespace quentier {
+
+namespace {
+
+const char * const gWords[] = {
+    "alpha",    "bravo",     "charlie",  "delta",     "echo",
+    "foxtrot",  "golf",      "hotel",    "india",     "juliet",
+    "kilo",     "lima",      "mike",     "november",  "oscar",
+    "papa",     "quebec",    "romeo",    "sierra",    "tango",
+    "uniform",  "victor",    "whiskey",  "xray",      "yankee",
+    "zulu",     "account",   "balance",  "budget",    "calendar",
+    "meeting",  "project",   "report",   "schedule",  "summary",
+    "travel",   "recipe",    "garden",   "kitchen",   "library",
+    "mountain", "river",     "ocean",    "forest",    "desert",
+    "network",  "protocol",  "storage",  "database",  "compiler",
+    "kernel",   "thread",    "memory",   "process",   "document",
+    "note",     "idea",      "draft",    "review",    "archive",
+    "the",      "of",        "and",      "with",      "for",
+    "about",    "between",   "under",    "over",      "through"};
+
+const int gNumWords = static_cast<int>(sizeof(gWords) / sizeof(gWords[0]));
+
+template <class Engine>
+double uniformReal(Engine & engine)
+{
+    // Not using std::uniform_real_distribution as its output is
+    // implementation defined, unlike that of the engine itself
+    return static_cast<double>(engine() - Engine::min()) /
+        (static_cast<double>(Engine::max() - Engine::min()) + 1.0);
+}
+
+template <class Engine>
+quint32 uniformInt(Engine & engine, const quint32 low, const quint32 high)
+{
+    if (high <= low) {
+        return low;
+    }
+
+    double range = static_cast<double>(high - low) + 1.0;
+    return low + static_cast<quint32>(std::floor(range * uniformReal(engine)));
+}
+
+// Returns index in range [0, size) with lower indices more likely so that
+// a few notebooks and tags are much more popular than the rest
+template <class Engine>
+quint32 skewedIndex(Engine & engine, const quint32 size)
+{
+    double value = uniformReal(engine);
+    return std::min(
+        static_cast<quint32>(std::floor(value * value * value * size)),
+        size - 1);
+}
+
+template <class Engine>
+double logNormal(Engine & engine, const double mu, const double sigma)
+{
+    // Box-Muller transform
+    const double pi = 3.14159265358979323846;
+    double u1 = 1.0 - uniformReal(engine);
+    double u2 = uniformReal(engine);
+    double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * pi * u2);
+    return std::exp(mu + sigma * z);
+}
+
+} // namespace
+
+SyntheticDataGenerator::SyntheticDataGenerator(
+    const GeneratorOptions & options) :
+    m_options(options),
+    m_namespaceUuid(QUuid::createUuidV5(
+        QUuid(),
+        QStringLiteral("quentier account generator ") +
+            QString::number(options.m_seed)))
+{}
+
+Notebook SyntheticDataGenerator::notebook(const quint32 index) const
+{
+    auto engine = randomEngine(ItemKind::Notebook, index);
+
+    Notebook notebook;
+    notebook.setLocalUid(localUid(ItemKind::Notebook, index));
+
+    QString name = words(engine, static_cast<int>(uniformInt(engine, 1, 3)));
+    name += QStringLiteral(" #") + QString::number(m_options.m_seed) +
+        QStringLiteral("-") + QString::number(index + 1);
+
+    notebook.setName(name);
+
+    // Put roughly a third of notebooks into a few stacks
+    if (uniformReal(engine) < 0.3) {
+        quint32 numStacks = std::max(m_options.m_numNotebooks / 10, 1U);
+        notebook.setStack(
+            QStringLiteral("Stack ") +
+            QString::number(uniformInt(engine, 1, numStacks)));
+    }
+
+    return notebook;
+}
+
+Tag SyntheticDataGenerator::tag(const quint32 index) const
+{
+    auto engine = randomEngine(ItemKind::Tag, index);
+
+    Tag tag;
+    tag.setLocalUid(localUid(ItemKind::Tag, index));
+
+    QString name = words(engine, static_cast<int>(uniformInt(engine, 1, 2)));
+    name += QStringLiteral(" #") + QString::number(m_options.m_seed) +
+        QStringLiteral("-") + QString::number(index + 1);
+
+    tag.setName(name);
+
+    // The first tags are roots, about half of the rest have parents; parents
+    // always have lower indices so they are added to the local storage first
+    quint32 numRootTags = std::max(m_options.m_numTags / 10, 1U);
+    if ((index >= numRootTags) && (uniformReal(engine) < 0.5)) {
+        quint32 parentIndex = skewedIndex(engine, index);
+        tag.setParentLocalUid(localUid(ItemKind::Tag, parentIndex));
+    }
+
+    return tag;
+}
+
+Note SyntheticDataGenerator::note(const quint32 index) const
+{
+    auto engine = randomEngine(ItemKind::Note, index);
+
+    Note note;
+    note.setLocalUid(localUid(ItemKind::Note, index));
+
+    quint32 notebookIndex = skewedIndex(engine, m_options.m_numNotebooks);
+    note.setNotebookLocalUid(localUid(ItemKind::Notebook, notebookIndex));
+
+    QString title =
+        words(engine, static_cast<int>(uniformInt(engine, 2, 8)));
+
+    title[0] = title[0].toUpper();
+    note.setTitle(title);
+
+    if (m_options.m_numTags > 0) {
+        quint32 maxTagsPerNote =
+            std::min(m_options.m_maxTagsPerNote, m_options.m_numTags);
+
+        quint32 numTags = uniformInt(
+            engine, std::min(m_options.m_minTagsPerNote, maxTagsPerNote),
+            maxTagsPerNote);
+
+        QSet<quint32> tagIndices;
+        QStringList tagLocalUids;
+        tagLocalUids.reserve(static_cast<int>(numTags));
+
+        while (static_cast<quint32>(tagLocalUids.size()) < numTags) {
+            quint32 tagIndex = skewedIndex(engine, m_options.m_numTags);
+            if (tagIndices.contains(tagIndex)) {
+                // Fall back to the next free index to avoid looping for long
+                // when most tags are already picked
+                while (tagIndices.contains(tagIndex)) {
+                    tagIndex = (tagIndex + 1) % m_options.m_numTags;
+                }
+            }
+
+            Q_UNUSED(tagIndices.insert(tagIndex))
+            tagLocalUids << localUid(ItemKind::Tag, tagIndex);
+        }
+
+        if (!tagLocalUids.isEmpty()) {
+            note.setTagLocalUids(tagLocalUids);
+        }
+    }
+
+    // About a quarter of notes have image attachments
+    QList<Resource> resources;
+    if ((m_options.m_maxResourcesPerNote > 0) && (uniformReal(engine) < 0.25))
+    {
+        quint32 numResources =
+            uniformInt(engine, 1, m_options.m_maxResourcesPerNote);
+
+        for (quint32 i = 0; i < numResources; ++i) {
+            QImage image;
+            resources << resource(
+                note.localUid(), index * m_options.m_maxResourcesPerNote + i,
+                image);
+
+            if (i == 0) {
+                note.setThumbnailData(thumbnail(image));
+            }
+        }
+
+        note.setResources(resources);
+    }
+
+    note.setContent(noteContent(engine, resources));
+
+    qint64 creationTimestamp = SYNTHETIC_DATA_BASE_TIMESTAMP +
+        static_cast<qint64>(
+            uniformReal(engine) * 5 * 365 * SYNTHETIC_DATA_MSEC_PER_DAY);
+
+    qint64 modificationTimestamp = creationTimestamp +
+        static_cast<qint64>(
+            uniformReal(engine) * 365 * SYNTHETIC_DATA_MSEC_PER_DAY);
+
+    note.setCreationTimestamp(creationTimestamp);
+    note.setModificationTimestamp(modificationTimestamp);
+
+    return note;
+}
+
+SyntheticDataGenerator::RandomEngine SyntheticDataGenerator::randomEngine(
+    const ItemKind kind, const quint32 index) const
+{
+    std::seed_seq seedSequence{
+        static_cast<quint32>(m_options.m_seed), static_cast<quint32>(kind),
+        static_cast<quint32>(index)};
+
+    return RandomEngine(seedSequence);
+}
+
+QString SyntheticDataGenerator::localUid(
+    const ItemKind kind, const quint32 index) const
+{
+    QString data = QString::number(static_cast<int>(kind)) +
+        QStringLiteral("/") + QString::number(index);
+
+    QString uid = QUuid::createUuidV5(m_namespaceUuid, data).toString();
+
+    // Strip curly braces to match the format of local uids
+    // generated by libquentier
+    return uid.mid(1, uid.size() - 2);
+}
+
+QString SyntheticDataGenerator::words(
+    RandomEngine & engine, const int numWords) const
+{
+    QString result;
+    for (int i = 0; i < numWords; ++i) {
+        if (i > 0) {
+            result += QChar::fromLatin1(' ');
+        }
+
+        int wordIndex = static_cast<int>(
+            uniformInt(engine, 0, static_cast<quint32>(gNumWords - 1)));
+
+        result += QString::fromLatin1(gWords[wordIndex]);
+    }
+
+    return result;
+}
+
+QString SyntheticDataGenerator::noteContent(
+    RandomEngine & engine, const QList<Resource> & resources) const
+{
+    // Note sizes roughly follow log-normal distribution: most notes are
+    // small, a few ones are huge
+    int targetSize = static_cast<int>(
+        std::min(std::max(logNormal(engine, 7.3, 1.1), 32.0), 200000.0));
+
+    QString content;
+    content.reserve(targetSize + 512);
+    content += QStringLiteral("<en-note>");
+
+    bool resourcesInserted = resources.isEmpty();
+    while (content.size() < targetSize) {
+        if (uniformReal(engine) < 0.1) {
+            content += QStringLiteral("<ul>");
+            quint32 numItems = uniformInt(engine, 2, 6);
+            for (quint32 i = 0; i < numItems; ++i) {
+                content += QStringLiteral("<li>");
+                content += words(
+                    engine, static_cast<int>(uniformInt(engine, 2, 10)));
+                content += QStringLiteral("</li>");
+            }
+            content += QStringLiteral("</ul>");
+        }
+        else {
+            content += QStringLiteral("<div>");
+            content +=
+                words(engine, static_cast<int>(uniformInt(engine, 10, 120)));
+            content += QStringLiteral("</div>");
+        }
+
+        if (!resourcesInserted) {
+            for (const auto & resource: qAsConst(resources)) {
+                content += QStringLiteral("<div><en-media type=\"");
+                content += resource.mime();
+                content += QStringLiteral("\" hash=\"");
+                content += QString::fromLatin1(resource.dataHash().toHex());
+                content += QStringLiteral("\"/></div>");
+            }
+
+            resourcesInserted = true;
+        }
+    }
+
+    content += QStringLiteral("</en-note>");
+    return content;
+}
+
+Resource SyntheticDataGenerator::resource(
+    const QString & noteLocalUid, const quint32 resourceIndex,
+    QImage & image) const
+{
+    auto engine = randomEngine(ItemKind::Resource, resourceIndex);
+
+    int width = static_cast<int>(uniformInt(engine, 64, 512));
+    int height = static_cast<int>(uniformInt(engine, 64, 512));
+
+    int red = static_cast<int>(uniformInt(engine, 0, 255));
+    int green = static_cast<int>(uniformInt(engine, 0, 255));
+    int blue = static_cast<int>(uniformInt(engine, 0, 255));
+
+    // Simple gradient is cheap to generate and yet compresses like a real
+    // picture rather than like a solid fill
+    image = QImage(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        auto * pLine = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            pLine[x] = qRgb(
+                (red + x * 255 / width) & 0xff,
+                (green + y * 255 / height) & 0xff, (blue + x + y) & 0xff);
+        }
+    }
+
+    QByteArray imageData;
+    QBuffer buffer(&imageData);
+    Q_UNUSED(buffer.open(QIODevice::WriteOnly))
+    Q_UNUSED(image.save(&buffer, "PNG"))
+
+    Resource resource;
+    resource.setLocalUid(localUid(ItemKind::Resource, resourceIndex));
+    resource.setNoteLocalUid(noteLocalUid);
+    resource.setDataBody(imageData);
+    resource.setDataSize(imageData.size());
+
+    resource.setDataHash(
+        QCryptographicHash::hash(imageData, QCryptographicHash::Md5));
+
+    resource.setMime(QStringLiteral("image/png"));
+
+    auto & attributes = resource.resourceAttributes();
+    attributes.fileName = QStringLiteral("image") +
+        QString::number(resourceIndex + 1) + QStringLiteral(".png");
+
+    return resource;
+}
+
+QByteArray SyntheticDataGenerator::thumbnail(const QImage & image) const
+{
+    QImage thumbnailImage =
+        image.scaled(100, 100, Qt::KeepAspectRatio, Qt::FastTransformation);
+
+    QByteArray thumbnailData;
+    QBuffer buffer(&thumbnailData);
+    Q_UNUSED(buffer.open(QIODevice::WriteOnly))
+    Q_UNUSED(thumbnailImage.save(&buffer, "PNG"))
+
+    return thumbnailData;
+}
+
+} // namespace quentier
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_ACCOUNT_GENERATOR_SYNTHETIC_DATA_GENERATOR_H
+#define QUENTIER_ACCOUNT_GENERATOR_SYNTHETIC_DATA_GENERATOR_H
+
+#include "ProcessGeneratorOptions.h"
+
+#include <quentier/types/Note.h>
+#include <quentier/types/Notebook.h>
+#include <quentier/types/Resource.h>
+#include <quentier/types/Tag.h>
+
+#include <QImage>
+#include <QUuid>
+
+#include <random>
+
+namespace quentier {
+
+/**
+ * @brief The SyntheticDataGenerator class deterministically generates
+ * notebooks, tags and notes for the synthetic account.
+ *
+ * Each item is generated from its own random engine seeded by the seed from
+ * options, the item's kind and index so the result doesn't depend on
+ * the order in which items are generated. Local uids are derived from
+ * the same data so the generated account is fully reproducible.
+ */
+class SyntheticDataGenerator
+{
+public:
+    explicit SyntheticDataGenerator(const GeneratorOptions & options);
+
+    Notebook notebook(const quint32 index) const;
+    Tag tag(const quint32 index) const;
+    Note note(const quint32 index) const;
+
+private:
+    enum class ItemKind
+    {
+        Notebook = 1,
+        Tag,
+        Note,
+        Resource
+    };
+
+    using RandomEngine = std::mt19937;
+
+    RandomEngine randomEngine(
+        const ItemKind kind, const quint32 index) const;
+
+    QString localUid(const ItemKind kind, const quint32 index) const;
+
+    QString words(RandomEngine & engine, const int numWords) const;
+
+    QString noteContent(
+        RandomEngine & engine, const QList<Resource> & resources) const;
+
+    Resource resource(
+        const QString & noteLocalUid, const quint32 resourceIndex,
+        QImage & image) const;
+
+    QByteArray thumbnail(const QImage & image) const;
+
+private:
+    const GeneratorOptions m_options;
+    const QUuid m_namespaceUuid;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_ACCOUNT_GENERATOR_SYNTHETIC_DATA_GENERATOR_H
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GenerateAccount.h"
+#include "ProcessGeneratorOptions.h"
+
+// Reused from wiki2account
+#include "PrepareLocalStorageManager.h"
+#include "ProcessNoteOptions.h"
+#include "ProcessStartupAccount.h"
+#include "ProcessTagOptions.h"
+
+#include <lib/initialization/Initialize.h>
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Initialize.h>
+#include <quentier/utility/StandardPaths.h>
+
+#include <QApplication>
+#include <QThread>
+
+#include <iostream>
+
+using namespace quentier;
+
+int main(int argc, char * argv[])
+{
+    QApplication app(argc, argv);
+    app.setOrganizationName(QStringLiteral("quentier.org"));
+    app.setApplicationName(QStringLiteral("account_generator"));
+
+    QHash<QString, CommandLineParser::OptionData> availableCmdOptions;
+    prepareAvailableCommandLineOptions(availableCmdOptions);
+
+    ParseCommandLineResult parseCmdResult;
+    parseCommandLine(argc, argv, availableCmdOptions, parseCmdResult);
+    if (!parseCmdResult.m_errorDescription.isEmpty()) {
+        std::cerr << parseCmdResult.m_errorDescription.nonLocalizedString()
+                         .toLocal8Bit()
+                         .constData();
+        return 1;
+    }
+
+    auto storageDirIt =
+        parseCmdResult.m_cmdOptions.find(QStringLiteral("storageDir"));
+
+    if (storageDirIt == parseCmdResult.m_cmdOptions.end()) {
+        // Set storageDir to the location of Quentier app's persistence
+        app.setApplicationName(QStringLiteral("quentier"));
+        QString path = applicationPersistentStoragePath();
+        parseCmdResult.m_cmdOptions[QStringLiteral("storageDir")] = path;
+        app.setApplicationName(QStringLiteral("account_generator"));
+    }
+
+    if (!processStorageDirCommandLineOption(parseCmdResult.m_cmdOptions)) {
+        return 1;
+    }
+
+    // Initialize logging
+    QUENTIER_INITIALIZE_LOGGING();
+    QUENTIER_SET_MIN_LOG_LEVEL(Info);
+
+    initializeLibquentier();
+
+    Account account = processStartupAccount(
+        parseCmdResult.m_cmdOptions, QStringLiteral("Synthetic notes"));
+
+    if (account.isEmpty()) {
+        return 1;
+    }
+
+    GeneratorOptions generatorOptions;
+
+    bool res = processGeneratorOptions(
+        parseCmdResult.m_cmdOptions, generatorOptions);
+
+    if (!res) {
+        return 1;
+    }
+
+    res = processTagOptions(
+        parseCmdResult.m_cmdOptions, generatorOptions.m_minTagsPerNote,
+        generatorOptions.m_maxTagsPerNote);
+
+    if (!res) {
+        return 1;
+    }
+
+    res = processNoteOptions(
+        parseCmdResult.m_cmdOptions, generatorOptions.m_numNotes);
+
+    if (!res) {
+        return 1;
+    }
+
+    auto * pLocalStorageManagerThread = new QThread;
+
+    pLocalStorageManagerThread->setObjectName(
+        QStringLiteral("LocalStorageManagerThread"));
+
+    QObject::connect(
+        pLocalStorageManagerThread, &QThread::finished,
+        pLocalStorageManagerThread, &QThread::deleteLater);
+
+    pLocalStorageManagerThread->start();
+
+    ErrorString errorDescription;
+
+    auto * pLocalStorageManager = prepareLocalStorageManager(
+        account, *pLocalStorageManagerThread, errorDescription);
+
+    if (!pLocalStorageManager) {
+        std::cerr << errorDescription.nonLocalizedString()
+                         .toLocal8Bit()
+                         .constData()
+                  << std::endl;
+        pLocalStorageManagerThread->quit();
+        return 1;
+    }
+
+    errorDescription.clear();
+
+    res = generateAccount(
+        generatorOptions, *pLocalStorageManager, errorDescription);
+
+    if (!res) {
+        std::cerr << "Failed to generate account: "
+                  << errorDescription.nonLocalizedString()
+                         .toLocal8Bit()
+                         .constData()
+                  << std::endl;
+        pLocalStorageManagerThread->quit();
+        return 1;
+    }
+
+    pLocalStorageManagerThread->quit();
+    return 0;
+}
@@ -49,6 +49,8 @@ MainWindow::MainWindow(
     m_minidumpLocation = nativePathToUnixPath(minidumpLocation);
     m_pUi->minidumpFilePathLineEdit->setText(m_minidumpLocation);
 
+    m_crashedModuleFileName = crashedModuleFileName(m_minidumpLocation);
+
     m_stackwalkBinary = nativePathToUnixPath(stackwalkBinaryLocation);
     QFileInfo stackwalkBinaryInfo(m_stackwalkBinary);
     if (Q_UNLIKELY(!stackwalkBinaryInfo.exists())) {
@@ -136,6 +138,10 @@ void MainWindow::onMinidumpStackwalkReadyReadStandardOutput()
         return;
     }
 
+    if (pStackwalkProcess != m_pStackwalkProcess) {
+        return;
+    }
+
     m_output += readData(*pStackwalkProcess, /* from stdout = */ true);
 
     QString output;
@@ -159,6 +165,10 @@ void MainWindow::onMinidumpStackwalkReadyReadStandardError()
         return;
     }
 
+    if (pStackwalkProcess != m_pStackwalkProcess) {
+        return;
+    }
+
     m_error += readData(*pStackwalkProcess, /* from stdout = */ false);
 }
 
@@ -167,6 +177,10 @@ void MainWindow::onMinidumpStackwalkProcessFinished(
 {
     Q_UNUSED(exitStatus)
 
+    if (sender() != m_pStackwalkProcess) {
+        return;
+    }
+
     QString output;
 
     if (!m_symbolsUnpackingErrors.isEmpty()) {
@@ -181,6 +195,13 @@ void MainWindow::onMinidumpStackwalkProcessFinished(
     output += tr("Stacktrace extraction finished, exit code") +
         QStringLiteral(": ") + QString::number(exitCode) + QStringLiteral("\n");
 
+    if (m_stackwalkIsPreliminary) {
+        output += tr("Only the symbols of the crashed module have been "
+                     "loaded so far, the stacktrace will be updated once "
+                     "the rest of debugging symbols are loaded") +
+            QStringLiteral("\n");
+    }
+
     output += m_output;
     output += QStringLiteral("\n\n");
     output += m_error;
@@ -189,7 +210,7 @@ void MainWindow::onMinidumpStackwalkProcessFinished(
 }
 
 void MainWindow::onSymbolsUnpackerFinished(
-    bool status, QString errorDescription)
+    bool status, QString errorDescription, QString moduleName)
 {
     if (m_numPendingSymbolsUnpackers != 0) {
         --m_numPendingSymbolsUnpackers;
@@ -206,11 +227,38 @@ void MainWindow::onSymbolsUnpackerFinished(
         m_symbolsUnpackingErrors += QStringLiteral("\n");
     }
 
-    if (m_numPendingSymbolsUnpackers != 0) {
+    if (m_numPendingSymbolsUnpackers == 0) {
+        m_stackwalkIsPreliminary = false;
+        startStackwalk();
         return;
     }
 
+    // Symbols of the crashed module are enough for the top of the stack
+    // which is what matters the most so there's no need to wait for the rest
+    // of symbols to show it
+    if (status && !m_pStackwalkProcess &&
+        isSameModule(m_crashedModuleFileName, moduleName))
+    {
+        m_stackwalkIsPreliminary = true;
+        startStackwalk();
+    }
+}
+
+void MainWindow::startStackwalk()
+{
+    if (m_pStackwalkProcess) {
+        // Preliminary stack walk is no longer needed
+        QObject::disconnect(m_pStackwalkProcess, nullptr, this, nullptr);
+        m_pStackwalkProcess->kill();
+        m_pStackwalkProcess->deleteLater();
+        m_pStackwalkProcess = nullptr;
+    }
+
+    m_output.clear();
+    m_error.clear();
+
     auto * pStackwalkProcess = new QProcess(this);
+    m_pStackwalkProcess = pStackwalkProcess;
 
     QObject::connect(
         pStackwalkProcess, &QProcess::readyReadStandardOutput, this,
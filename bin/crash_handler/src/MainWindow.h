@@ -46,9 +46,12 @@ private Q_SLOTS:
     void onMinidumpStackwalkProcessFinished(
         int exitCode, QProcess::ExitStatus ExitStatus);
 
-    void onSymbolsUnpackerFinished(bool status, QString errorDescription);
+    void onSymbolsUnpackerFinished(
+        bool status, QString errorDescription, QString moduleName);
 
 private:
+    void startStackwalk();
+
     QString readData(QProcess & process, const bool fromStdout);
     QString versionInfos() const;
 
@@ -57,6 +60,12 @@ private:
 
     int m_numPendingSymbolsUnpackers = 0;
 
+    // The stack walk is started as soon as the symbols of the crashed module
+    // are unpacked; it is restarted once the rest of symbols are unpacked
+    QString m_crashedModuleFileName;
+    QProcess * m_pStackwalkProcess = nullptr;
+    bool m_stackwalkIsPreliminary = false;
+
     QString m_minidumpLocation;
     QString m_stackwalkBinary;
     QString m_unpackedSymbolsRootPath;
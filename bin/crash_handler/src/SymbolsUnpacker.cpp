@@ -19,6 +19,8 @@
 #include "SymbolsUnpacker.h"
 #include "Utility.h"
 
+#include <SymbolsCompression.h>
+
 #include <VersionInfo.h>
 
 #include <quentier/utility/FileSystem.h>
@@ -28,11 +30,9 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QRegExp>
-#include <QTemporaryFile>
+#include <QSaveFile>
 
-#include <cstring>
-#include <fstream>
-#include <iostream>
+#include <algorithm>
 
 SymbolsUnpacker::SymbolsUnpacker(
     const QString & compressedSymbolsFilePath,
@@ -62,7 +62,7 @@ void SymbolsUnpacker::run()
                 QStringLiteral(": ") +
                 QDir::toNativeSeparators(unpackedSymbolsRootPath);
 
-            Q_EMIT finished(/* status = */ false, errorDescription);
+            Q_EMIT finished(/* status = */ false, errorDescription, QString());
             return;
         }
     }
@@ -73,7 +73,7 @@ void SymbolsUnpacker::run()
             QStringLiteral(": ") +
             QDir::toNativeSeparators(unpackedSymbolsRootPath);
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
     else if (Q_UNLIKELY(!unpackedSymbolsRootDirInfo.isWritable())) {
@@ -83,7 +83,7 @@ void SymbolsUnpacker::run()
             QStringLiteral(": ") +
             QDir::toNativeSeparators(unpackedSymbolsRootPath);
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
@@ -100,7 +100,7 @@ void SymbolsUnpacker::run()
             QStringLiteral(": ") +
             QDir::toNativeSeparators(compressedSymbolsFilePath);
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
@@ -111,7 +111,7 @@ void SymbolsUnpacker::run()
             QStringLiteral(": ") +
             QDir::toNativeSeparators(compressedSymbolsFilePath);
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
@@ -122,63 +122,39 @@ void SymbolsUnpacker::run()
             QStringLiteral(": ") +
             QDir::toNativeSeparators(compressedSymbolsFilePath);
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
-    QByteArray symbolsUncompressedData = compressedSymbolsFile.readAll();
-    compressedSymbolsFile.close();
+    // 3) Uncompress the first piece of symbols data; the rest of it would be
+    // uncompressed and written into the final symbols file piece by piece
 
-    // 3) Uncompress the symbols data and write them into a temporary file
+    CompressedSymbolsReader compressedSymbolsReader(compressedSymbolsFile);
 
-    QTemporaryFile uncompressedSymbolsFile;
-    if (!uncompressedSymbolsFile.open()) {
+    QByteArray symbolsUncompressedData;
+    QString uncompressionErrorDescription;
+    if (Q_UNLIKELY(!compressedSymbolsReader.readNext(
+            symbolsUncompressedData, uncompressionErrorDescription)))
+    {
         QString errorDescription =
-            tr("Error: can't create the temporary file to store "
-               "the uncompressed symbols read from the compressed file");
+            tr("Error: failed to uncompress the symbols") +
+            QStringLiteral(": ") + uncompressionErrorDescription;
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
-    uncompressedSymbolsFile.setAutoRemove(true);
-
-    symbolsUncompressedData = qUncompress(symbolsUncompressedData);
-    uncompressedSymbolsFile.write(symbolsUncompressedData);
-
-    // 4) Read the first line from the uncompressed symbols file and use that
-    // data to identify the name of the symbols source as well as its id
+    // 4) Read the first line from the uncompressed symbols data and use it
+    // to identify the name of the symbols source as well as its id
 
-    QFileInfo uncompressedSymbolsFileInfo(uncompressedSymbolsFile);
-
-    // NOTE: all attempts to read the first line from the symbols file using
-    // QFile's API result in crash for unknown reason; maybe it doesn't like
-    // what it finds within the file, I have no idea.
-    // Working around this crap by using C++ standard library's API.
-    std::ifstream symbolsFileStream;
-
-    symbolsFileStream.open(
-        QDir::toNativeSeparators(uncompressedSymbolsFileInfo.absoluteFilePath())
-            .toLocal8Bit()
-            .constData(),
-        std::ifstream::in);
-
-    if (Q_UNLIKELY(!symbolsFileStream.good())) {
-        QString errorDescription =
-            tr("Error: can't open the temporary uncompressed symbols file for "
-               "reading") +
-            QStringLiteral(": ") +
-            QDir::toNativeSeparators(
-                uncompressedSymbolsFileInfo.absoluteFilePath());
-
-        Q_EMIT finished(/* status = */ false, errorDescription);
-        return;
+    int firstLineSize = symbolsUncompressedData.indexOf('\n');
+    if ((firstLineSize < 0) || (firstLineSize > 1024)) {
+        firstLineSize = std::min(symbolsUncompressedData.size(), 1024);
     }
 
-    char buf[1024];
-    symbolsFileStream.getline(buf, 1024);
+    QByteArray symbolsFirstLineBytes =
+        symbolsUncompressedData.left(firstLineSize);
 
-    QByteArray symbolsFirstLineBytes(buf, 1024);
     QString symbolsFirstLine = QString::fromUtf8(symbolsFirstLineBytes);
     QString symbolsSourceName = compressedSymbolsFileInfo.fileName();
 
@@ -202,9 +178,10 @@ void SymbolsUnpacker::run()
             tr("Error: can't find the symbols source name hint") +
             QStringLiteral(" \"") + symbolsSourceName + QStringLiteral("\" ") +
             tr("within the first 1024 bytes read from the symbols file") +
-            QStringLiteral(": ") + QString::fromLocal8Bit(buf, 1024);
+            QStringLiteral(": ") +
+            QString::fromLocal8Bit(symbolsFirstLineBytes);
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
@@ -221,7 +198,7 @@ void SymbolsUnpacker::run()
             QStringLiteral(": ") +
             symbolsFirstLineTokens.join(QStringLiteral(", "));
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
@@ -232,11 +209,12 @@ void SymbolsUnpacker::run()
             QStringLiteral(": ") +
             symbolsFirstLineTokens.join(QStringLiteral(", "));
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
     symbolsSourceName = symbolsFirstLineTokens.at(4);
+    const QString moduleName = symbolsSourceName;
     if (Q_UNLIKELY(symbolsSourceName.isEmpty())) {
         QString errorDescription =
             tr("Error: minidump's application name is empty, first line of "
@@ -244,7 +222,7 @@ void SymbolsUnpacker::run()
             QStringLiteral(": ") +
             symbolsFirstLineTokens.join(QStringLiteral(", "));
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
@@ -286,7 +264,7 @@ void SymbolsUnpacker::run()
                "exists and it can't be removed") +
             QStringLiteral(":\n") + QDir::toNativeSeparators(unpackDirPath);
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
@@ -298,7 +276,7 @@ void SymbolsUnpacker::run()
                "the symbols") +
             QStringLiteral(":\n") + QDir::toNativeSeparators(unpackDirPath);
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
@@ -312,7 +290,9 @@ void SymbolsUnpacker::run()
     QString newSymbolsFilePath = unpackDirPath + QStringLiteral("/") +
         symbolsSourceName + QStringLiteral(".sym");
 
-    QFile newSymbolsFile(newSymbolsFilePath);
+    // The stack walk might be started while symbols are still being unpacked
+    // so the symbols file only appears at its path once it is complete
+    QSaveFile newSymbolsFile(newSymbolsFilePath);
     res = newSymbolsFile.open(QIODevice::WriteOnly);
     if (Q_UNLIKELY(!res)) {
         QString errorDescription =
@@ -320,7 +300,7 @@ void SymbolsUnpacker::run()
                "for writing") +
             QStringLiteral(":\n") + QDir::toNativeSeparators(unpackDirPath);
 
-        Q_EMIT finished(/* status = */ false, errorDescription);
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
         return;
     }
 
@@ -344,8 +324,50 @@ void SymbolsUnpacker::run()
     }
 #endif
 
-    newSymbolsFile.write(symbolsUncompressedData);
-    newSymbolsFile.close();
+    // 5) Write the uncompressed symbols data into the final file piece by
+    // piece
+
+    while (!symbolsUncompressedData.isEmpty()) {
+        if (Q_UNLIKELY(
+                newSymbolsFile.write(symbolsUncompressedData) !=
+                symbolsUncompressedData.size()))
+        {
+            QString errorDescription =
+                tr("Error: failed to write the unpacked symbols") +
+                QStringLiteral(": ") + newSymbolsFile.errorString();
+
+            newSymbolsFile.cancelWriting();
+            Q_EMIT finished(/* status = */ false, errorDescription, QString());
+            return;
+        }
+
+        if (compressedSymbolsReader.atEnd()) {
+            break;
+        }
+
+        if (Q_UNLIKELY(!compressedSymbolsReader.readNext(
+                symbolsUncompressedData, uncompressionErrorDescription)))
+        {
+            QString errorDescription =
+                tr("Error: failed to uncompress the symbols") +
+                QStringLiteral(": ") + uncompressionErrorDescription;
+
+            newSymbolsFile.cancelWriting();
+            Q_EMIT finished(/* status = */ false, errorDescription, QString());
+            return;
+        }
+    }
+
+    compressedSymbolsFile.close();
+
+    if (Q_UNLIKELY(!newSymbolsFile.commit())) {
+        QString errorDescription =
+            tr("Error: failed to write the unpacked symbols") +
+            QStringLiteral(": ") + newSymbolsFile.errorString();
+
+        Q_EMIT finished(/* status = */ false, errorDescription, QString());
+        return;
+    }
 
-    emit finished(/* status = */ true, QString());
+    Q_EMIT finished(/* status = */ true, QString(), moduleName);
 }
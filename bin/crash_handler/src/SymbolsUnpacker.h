@@ -37,7 +37,11 @@ public:
     virtual void run() override;
 
 Q_SIGNALS:
-    void finished(bool status, QString errorDescription);
+    /**
+     * @param moduleName        The name of the module from the symbols file,
+     *                          empty if the symbols were not unpacked
+     */
+    void finished(bool status, QString errorDescription, QString moduleName);
 
 private:
     QString m_compressedSymbolsFilePath;
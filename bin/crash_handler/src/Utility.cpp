@@ -18,10 +18,106 @@
 
 #include "Utility.h"
 
+#include <QDataStream>
 #include <QDir>
 #include <QFile>
 #include <QFileInfoList>
 
+// See minidump format description at
+// https://docs.microsoft.com/en-us/windows/win32/api/minidumpapiset
+#define MINIDUMP_SIGNATURE          (0x504d444d)
+#define MINIDUMP_MODULE_LIST_STREAM (4)
+#define MINIDUMP_EXCEPTION_STREAM   (6)
+#define MINIDUMP_MODULE_SIZE        (108)
+
+// Offset of thread context location within the exception stream
+#define MINIDUMP_EXCEPTION_CONTEXT_OFFSET (160)
+
+#define CONTEXT_AMD64_FLAG       (0x00100000)
+#define CONTEXT_AMD64_FLAGS_POS  (48)
+#define CONTEXT_AMD64_RIP_POS    (248)
+#define CONTEXT_X86_FLAG         (0x00010000)
+#define CONTEXT_X86_EIP_POS      (184)
+
+namespace {
+
+bool readUInt32(QFile & file, const qint64 pos, quint32 & value)
+{
+    if (!file.seek(pos)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream >> value;
+    return stream.status() == QDataStream::Ok;
+}
+
+bool readUInt64(QFile & file, const qint64 pos, quint64 & value)
+{
+    if (!file.seek(pos)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream >> value;
+    return stream.status() == QDataStream::Ok;
+}
+
+bool readInstructionPointer(
+    QFile & file, const quint32 contextRva, const quint32 contextSize,
+    quint64 & instructionPointer)
+{
+    quint32 flags = 0;
+
+    if ((contextSize >= CONTEXT_AMD64_RIP_POS + 8) &&
+        readUInt32(file, contextRva + CONTEXT_AMD64_FLAGS_POS, flags) &&
+        (flags & CONTEXT_AMD64_FLAG))
+    {
+        return readUInt64(
+            file, contextRva + CONTEXT_AMD64_RIP_POS, instructionPointer);
+    }
+
+    if ((contextSize >= CONTEXT_X86_EIP_POS + 4) &&
+        readUInt32(file, contextRva, flags) && (flags & CONTEXT_X86_FLAG))
+    {
+        quint32 eip = 0;
+        if (!readUInt32(file, contextRva + CONTEXT_X86_EIP_POS, eip)) {
+            return false;
+        }
+
+        instructionPointer = eip;
+        return true;
+    }
+
+    return false;
+}
+
+QString readModuleName(QFile & file, const quint32 nameRva)
+{
+    quint32 length = 0;
+    if (!readUInt32(file, nameRva, length) || (length > 65536)) {
+        return {};
+    }
+
+    const QByteArray data = file.read(length);
+    if (data.size() != static_cast<int>(length)) {
+        return {};
+    }
+
+    QString name;
+    for (int i = 0; i + 1 < data.size(); i += 2) {
+        name += QChar(
+            static_cast<ushort>(static_cast<uchar>(data[i])) |
+            static_cast<ushort>(static_cast<uchar>(data[i + 1]) << 8));
+    }
+
+    return name;
+}
+
+} // namespace
+
 QString nativePathToUnixPath(const QString & path)
 {
     QString result = path;
@@ -33,3 +129,108 @@ QString nativePathToUnixPath(const QString & path)
 
     return result;
 }
+
+QString crashedModuleFileName(const QString & minidumpFilePath)
+{
+    QFile file(minidumpFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    quint32 signature = 0;
+    quint32 streamCount = 0;
+    quint32 streamDirectoryRva = 0;
+    if (!readUInt32(file, 0, signature) ||
+        (signature != MINIDUMP_SIGNATURE) ||
+        !readUInt32(file, 8, streamCount) ||
+        !readUInt32(file, 12, streamDirectoryRva))
+    {
+        return {};
+    }
+
+    quint32 exceptionStreamRva = 0;
+    quint32 moduleListStreamRva = 0;
+    for (quint32 i = 0; i < streamCount; ++i) {
+        const qint64 entryPos = streamDirectoryRva + qint64(i) * 12;
+
+        quint32 streamType = 0;
+        quint32 streamRva = 0;
+        if (!readUInt32(file, entryPos, streamType) ||
+            !readUInt32(file, entryPos + 8, streamRva))
+        {
+            return {};
+        }
+
+        if (streamType == MINIDUMP_EXCEPTION_STREAM) {
+            exceptionStreamRva = streamRva;
+        }
+        else if (streamType == MINIDUMP_MODULE_LIST_STREAM) {
+            moduleListStreamRva = streamRva;
+        }
+    }
+
+    if ((exceptionStreamRva == 0) || (moduleListStreamRva == 0)) {
+        return {};
+    }
+
+    quint32 contextSize = 0;
+    quint32 contextRva = 0;
+    quint64 instructionPointer = 0;
+    if (!readUInt32(
+            file, exceptionStreamRva + MINIDUMP_EXCEPTION_CONTEXT_OFFSET,
+            contextSize) ||
+        !readUInt32(
+            file, exceptionStreamRva + MINIDUMP_EXCEPTION_CONTEXT_OFFSET + 4,
+            contextRva) ||
+        !readInstructionPointer(
+            file, contextRva, contextSize, instructionPointer))
+    {
+        return {};
+    }
+
+    quint32 moduleCount = 0;
+    if (!readUInt32(file, moduleListStreamRva, moduleCount)) {
+        return {};
+    }
+
+    for (quint32 i = 0; i < moduleCount; ++i) {
+        const qint64 modulePos =
+            moduleListStreamRva + 4 + qint64(i) * MINIDUMP_MODULE_SIZE;
+
+        quint64 baseOfImage = 0;
+        quint32 sizeOfImage = 0;
+        quint32 nameRva = 0;
+        if (!readUInt64(file, modulePos, baseOfImage) ||
+            !readUInt32(file, modulePos + 8, sizeOfImage) ||
+            !readUInt32(file, modulePos + 20, nameRva))
+        {
+            return {};
+        }
+
+        if ((instructionPointer < baseOfImage) ||
+            (instructionPointer - baseOfImage >= sizeOfImage))
+        {
+            continue;
+        }
+
+        // Module names are paths from the crashed system which might use
+        // separators different from the local ones
+        QString name = readModuleName(file, nameRva);
+        name.replace(QChar::fromLatin1('\\'), QChar::fromLatin1('/'));
+        return name.mid(name.lastIndexOf(QChar::fromLatin1('/')) + 1);
+    }
+
+    return {};
+}
+
+bool isSameModule(
+    const QString & moduleFileName, const QString & symbolsModuleName)
+{
+    const auto baseName = [](const QString & name) {
+        return name.left(name.indexOf(QChar::fromLatin1('.')));
+    };
+
+    return !moduleFileName.isEmpty() &&
+        (baseName(moduleFileName)
+             .compare(baseName(symbolsModuleName), Qt::CaseInsensitive) == 0);
+}
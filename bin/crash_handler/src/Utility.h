@@ -23,4 +23,25 @@
 
 QString nativePathToUnixPath(const QString & path);
 
+/**
+ * Finds the module within which the crashed thread's instruction pointer was
+ * at the moment of the crash
+ *
+ * @param minidumpFilePath      The path to the minidump file
+ * @return                      The name of the module's file without the path
+ *                              or empty string if the module can't be found,
+ *                              for example, because the minidump comes from
+ *                              an unsupported CPU architecture
+ */
+QString crashedModuleFileName(const QString & minidumpFilePath);
+
+/**
+ * @return      True if the module's file name and the name of the module
+ *              from symbols file refer to the same module, false otherwise;
+ *              names are compared up to the first dot as platforms decorate
+ *              them differently, e.g. "quentier.exe" vs "quentier.pdb"
+ */
+bool isSameModule(
+    const QString & moduleFileName, const QString & symbolsModuleName);
+
 #endif // QUENTIER_CRASH_HANDLER_UTILITY_H
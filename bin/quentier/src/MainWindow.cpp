@@ -42,9 +42,15 @@
 #include <lib/exception/LocalStorageVersionTooHighException.h>
 #include <lib/initialization/DefaultAccountFirstNotebookAndNoteCreator.h>
 #include <lib/model/common/ColumnChangeRerouter.h>
+#include <lib/model/common/LocalStorageRequestScheduler.h>
+#include <lib/model/common/NoteCountAggregator.h>
+#include <lib/model/common/LocalStorageRequestTracer.h>
+#include <lib/model/common/ModelSnapshot.h>
+#include <lib/model/note/NoteSearchIndex.h>
 #include <lib/network/NetworkProxySettingsHelpers.h>
 #include <lib/preferences/PreferencesDialog.h>
 #include <lib/preferences/UpdateSettings.h>
+#include <lib/preferences/defaults/Account.h>
 #include <lib/preferences/defaults/Appearance.h>
 #include <lib/preferences/defaults/Synchronization.h>
 #include <lib/preferences/keys/Account.h>
@@ -59,6 +65,7 @@
 #include <lib/utility/AsyncFileWriter.h>
 #include <lib/utility/ExitCodes.h>
 #include <lib/utility/Keychain.h>
+#include <lib/utility/Log.h>
 #include <lib/utility/QObjectThreadMover.h>
 #include <lib/view/DeletedNoteItemView.h>
 #include <lib/view/FavoriteItemView.h>
@@ -179,6 +186,14 @@ using quentier::LogViewerWidget;
 #define CREATE_SIDE_BORDERS_CONTROLLER_DELAY (200)
 #define NOTIFY_SIDE_BORDERS_CONTROLLER_DELAY (200)
 
+// Rough estimates of memory occupied by a single item of the corresponding
+// model, used to keep the models of inactive accounts within the memory limit
+#define NOTE_MODEL_ITEM_SIZE_ESTIMATE         (2048)
+#define FAVORITES_MODEL_ITEM_SIZE_ESTIMATE    (512)
+#define NOTEBOOK_MODEL_ITEM_SIZE_ESTIMATE     (512)
+#define TAG_MODEL_ITEM_SIZE_ESTIMATE          (384)
+#define SAVED_SEARCH_MODEL_ITEM_SIZE_ESTIMATE (384)
+
 using namespace quentier;
 
 #ifdef WITH_UPDATE_MANAGER
@@ -334,6 +349,8 @@ MainWindow::~MainWindow()
         m_pLocalStorageManagerAsync = nullptr;
     }
 
+    saveModelSnapshots();
+
     delete m_pUi;
 }
 
@@ -1975,8 +1992,8 @@ void MainWindow::onImportEnexAction()
     }
 
     auto * pImporter = new EnexImporter(
-        enexFilePath, notebookName, *m_pLocalStorageManagerAsync, *m_pTagModel,
-        *m_pNotebookModel, this);
+        enexFilePath, notebookName, *m_pAccount, *m_pLocalStorageManagerAsync,
+        *m_pTagModel, *m_pNotebookModel, this);
 
     QObject::connect(
         pImporter, &EnexImporter::enexImportedSuccessfully, this,
@@ -1986,6 +2003,11 @@ void MainWindow::onImportEnexAction()
         pImporter, &EnexImporter::enexImportFailed, this,
         &MainWindow::onEnexImportFailed);
 
+    QObject::connect(
+        pImporter, &EnexImporter::enexImportProgress, this,
+        &MainWindow::onEnexImportProgress);
+
+    pImporter->setCheckpointingEnabled(pEnexImportDialog->resumableImport());
     pImporter->start();
 }
 
@@ -3372,6 +3394,24 @@ void MainWindow::onEnexImportFailed(ErrorString errorDescription)
     }
 }
 
+void MainWindow::onEnexImportProgress(
+    int addedNotesCount, int totalNotesCount, double notesPerSecond)
+{
+    QNDEBUG(
+        "quentier:main_window",
+        "MainWindow::onEnexImportProgress: added "
+            << addedNotesCount << " notes out of " << totalNotesCount << ", "
+            << notesPerSecond << " notes per second");
+
+    onSetStatusBarText(
+        tr("Importing notes from ENEX") + QStringLiteral(": ") +
+            QString::number(addedNotesCount) + QStringLiteral("/") +
+            QString::number(totalNotesCount) + QStringLiteral(" (") +
+            tr("notes per second") + QStringLiteral(": ") +
+            QString::number(notesPerSecond, 'f', 1) + QStringLiteral(")"),
+        secondsToMilliseconds(5));
+}
+
 void MainWindow::onUseLimitedFontsPreferenceChanged(bool flag)
 {
     QNDEBUG(
@@ -3608,7 +3648,8 @@ void MainWindow::onViewLogsActionTriggered()
         return;
     }
 
-    pLogViewerWidget = new LogViewerWidget(this);
+    pLogViewerWidget =
+        new LogViewerWidget(this, m_pLocalStorageRequestTracer);
     pLogViewerWidget->setAttribute(Qt::WA_DeleteOnClose);
     pLogViewerWidget->show();
 }
@@ -3849,6 +3890,8 @@ void MainWindow::onAccountSwitched(Account account)
 
     m_pLocalStorageManagerAsync->setUseCache(false);
 
+    m_localStorageChangeMarker = localStorageChangeMarker(account);
+
     ErrorString errorDescription;
     try {
         m_pLocalStorageManagerAsync->localStorageManager()->switchUser(account);
@@ -4324,10 +4367,16 @@ void MainWindow::onLocalStorageSwitchUserRequestComplete(
         return;
     }
 
-    m_notebookCache.clear();
-    m_tagCache.clear();
-    m_savedSearchCache.clear();
-    m_noteCache.clear();
+    // Caches are keyed by local uids which are unique across accounts so
+    // there's no need to clear them if the models of the previous account
+    // are kept in memory: these models would continue to use the caches after
+    // switching back to that account
+    if (!keepInactiveAccountModels()) {
+        m_notebookCache.clear();
+        m_tagCache.clear();
+        m_savedSearchCache.clear();
+        m_noteCache.clear();
+    }
 
     if (m_geometryAndStatePersistingDelayTimerId != 0) {
         killTimer(m_geometryAndStatePersistingDelayTimerId);
@@ -5148,6 +5197,7 @@ void MainWindow::setupLocalStorageManager()
         LocalStorageManager::StartupOptions(0));
 #endif
 
+    m_localStorageChangeMarker = localStorageChangeMarker(*m_pAccount);
     m_pLocalStorageManagerAsync->init();
 
     ErrorString errorDescription;
@@ -5203,6 +5253,13 @@ void MainWindow::setupLocalStorageManager()
         m_pLocalStorageManagerAsync,
         &LocalStorageManagerAsync::switchUserFailed, this,
         &MainWindow::onLocalStorageSwitchUserRequestFailed);
+
+    m_pLocalStorageRequestScheduler = new LocalStorageRequestScheduler(
+        *m_pLocalStorageManagerAsync,
+        LOCAL_STORAGE_REQUEST_SCHEDULER_DEFAULT_MAX_REQUESTS_IN_FLIGHT, this);
+
+    m_pLocalStorageRequestTracer = new LocalStorageRequestTracer(
+        *m_pLocalStorageManagerAsync, *m_pLocalStorageRequestScheduler, this);
 }
 
 void MainWindow::setupDisableNativeMenuBarPreference()
@@ -5248,33 +5305,65 @@ void MainWindow::setupModels()
 
     clearModels();
 
-    auto noteSortingMode = restoreNoteSortingMode();
-    if (noteSortingMode == NoteModel::NoteSortingMode::None) {
-        noteSortingMode = NoteModel::NoteSortingMode::ModifiedDescending;
-    }
+    if (!unparkModels(*m_pAccount)) {
+        auto noteSortingMode = restoreNoteSortingMode();
+        if (noteSortingMode == NoteModel::NoteSortingMode::None) {
+            noteSortingMode = NoteModel::NoteSortingMode::ModifiedDescending;
+        }
+
+        m_pNoteModel = new NoteModel(
+            *m_pAccount, *m_pLocalStorageManagerAsync, m_noteCache,
+            m_notebookCache, this, NoteModel::IncludedNotes::NonDeleted,
+            noteSortingMode, nullptr, m_pLocalStorageRequestScheduler);
+
+        m_pNoteCountAggregator = new NoteCountAggregator(
+            *m_pLocalStorageManagerAsync, this,
+            m_pLocalStorageRequestScheduler);
+
+        QObject::connect(
+            m_pNoteCountAggregator, &NoteCountAggregator::notifyError, this,
+            &MainWindow::onModelViewError);
+
+        m_pFavoritesModel = new FavoritesModel(
+            *m_pAccount, *m_pLocalStorageManagerAsync, m_noteCache,
+            m_notebookCache, m_tagCache, m_savedSearchCache, this,
+            m_pLocalStorageRequestScheduler, m_pNoteCountAggregator);
 
-    m_pNoteModel = new NoteModel(
-        *m_pAccount, *m_pLocalStorageManagerAsync, m_noteCache, m_notebookCache,
-        this, NoteModel::IncludedNotes::NonDeleted, noteSortingMode);
+        ModelSnapshot notebookModelSnapshot(
+            modelSnapshotFilePath(*m_pAccount, QStringLiteral("NotebookModel")),
+            m_localStorageChangeMarker);
 
-    m_pFavoritesModel = new FavoritesModel(
-        *m_pAccount, *m_pLocalStorageManagerAsync, m_noteCache, m_notebookCache,
-        m_tagCache, m_savedSearchCache, this);
+        m_pNotebookModel = new NotebookModel(
+            *m_pAccount, *m_pLocalStorageManagerAsync, m_notebookCache, this,
+            &notebookModelSnapshot, m_pLocalStorageRequestScheduler,
+            m_pNoteCountAggregator);
 
-    m_pNotebookModel = new NotebookModel(
-        *m_pAccount, *m_pLocalStorageManagerAsync, m_notebookCache, this);
+        ModelSnapshot tagModelSnapshot(
+            modelSnapshotFilePath(*m_pAccount, QStringLiteral("TagModel")),
+            m_localStorageChangeMarker);
 
-    m_pTagModel = new TagModel(
-        *m_pAccount, *m_pLocalStorageManagerAsync, m_tagCache, this);
+        m_pTagModel = new TagModel(
+            *m_pAccount, *m_pLocalStorageManagerAsync, m_tagCache, this,
+            &tagModelSnapshot, m_pLocalStorageRequestScheduler,
+            m_pNoteCountAggregator);
 
-    m_pSavedSearchModel = new SavedSearchModel(
-        *m_pAccount, *m_pLocalStorageManagerAsync, m_savedSearchCache, this);
+        ModelSnapshot savedSearchModelSnapshot(
+            modelSnapshotFilePath(
+                *m_pAccount, QStringLiteral("SavedSearchModel")),
+            m_localStorageChangeMarker);
 
-    m_pDeletedNotesModel = new NoteModel(
-        *m_pAccount, *m_pLocalStorageManagerAsync, m_noteCache, m_notebookCache,
-        this, NoteModel::IncludedNotes::Deleted);
+        m_pSavedSearchModel = new SavedSearchModel(
+            *m_pAccount, *m_pLocalStorageManagerAsync, m_savedSearchCache,
+            this, &savedSearchModelSnapshot, m_pLocalStorageRequestScheduler);
+
+        m_pDeletedNotesModel = new NoteModel(
+            *m_pAccount, *m_pLocalStorageManagerAsync, m_noteCache,
+            m_notebookCache, this, NoteModel::IncludedNotes::Deleted,
+            NoteModel::NoteSortingMode::ModifiedAscending, nullptr,
+            m_pLocalStorageRequestScheduler);
 
-    m_pDeletedNotesModel->start();
+        m_pDeletedNotesModel->start();
+    }
 
     if (m_pNoteCountLabelController == nullptr) {
         m_pNoteCountLabelController =
@@ -5283,6 +5372,19 @@ void MainWindow::setupModels()
 
     m_pNoteCountLabelController->setNoteModel(*m_pNoteModel);
 
+    if (useNoteSearchIndex()) {
+        ModelSnapshot noteSearchIndexSnapshot(
+            modelSnapshotFilePath(
+                *m_pAccount, QStringLiteral("NoteSearchIndex")),
+            m_localStorageChangeMarker);
+
+        // Must be created before note filters manager so that the index
+        // processes local storage's notifications about notes first
+        m_pNoteSearchIndex = new NoteSearchIndex(
+            *m_pAccount, *m_pLocalStorageManagerAsync, this,
+            &noteSearchIndexSnapshot, m_pLocalStorageRequestScheduler);
+    }
+
     setupNoteFilters();
 
     m_pUi->favoritesTableView->setModel(m_pFavoritesModel);
@@ -5308,6 +5410,23 @@ void MainWindow::clearModels()
 
     clearViews();
 
+    // By now local storage has already been switched to another account so
+    // the database file of models' account is closed and won't change
+    saveModelSnapshots();
+
+    if (m_pNoteSearchIndex) {
+        delete m_pNoteSearchIndex;
+        m_pNoteSearchIndex = nullptr;
+    }
+
+    if (parkModels()) {
+        return;
+    }
+
+    if (!keepInactiveAccountModels()) {
+        releaseParkedModels(0);
+    }
+
     if (m_pNotebookModel) {
         delete m_pNotebookModel;
         m_pNotebookModel = nullptr;
@@ -5339,6 +5458,301 @@ void MainWindow::clearModels()
         delete m_pFavoritesModel;
         m_pFavoritesModel = nullptr;
     }
+
+    // Deleted after the models using it
+    if (m_pNoteCountAggregator) {
+        delete m_pNoteCountAggregator;
+        m_pNoteCountAggregator = nullptr;
+    }
+}
+
+void MainWindow::saveModelSnapshots()
+{
+    QNDEBUG("quentier:main_window", "MainWindow::saveModelSnapshots");
+
+    if (!m_pNotebookModel || !m_pTagModel || !m_pSavedSearchModel) {
+        QNDEBUG("quentier:main_window", "No models to save snapshots of");
+        return;
+    }
+
+    const Account & account = m_pNotebookModel->account();
+    const QByteArray marker = localStorageChangeMarker(account);
+    if (marker.isEmpty()) {
+        QNDEBUG(
+            "quentier:main_window",
+            "No local storage database file for account " << account.name());
+        return;
+    }
+
+    const auto saveSnapshot = [&](const auto & model, const QString & name) {
+        const QString filePath = modelSnapshotFilePath(account, name);
+
+        ModelSnapshotWriter writer(marker);
+        if (!model.saveSnapshot(writer)) {
+            // Stale snapshot would only cause unnecessary reconciliation
+            Q_UNUSED(QFile::remove(filePath))
+            return;
+        }
+
+        ErrorString errorDescription;
+        if (!writer.save(filePath, errorDescription)) {
+            QNWARNING(
+                "quentier:main_window",
+                "Failed to save " << name << " snapshot: "
+                                  << errorDescription);
+        }
+    };
+
+    saveSnapshot(*m_pNotebookModel, QStringLiteral("NotebookModel"));
+    saveSnapshot(*m_pTagModel, QStringLiteral("TagModel"));
+    saveSnapshot(*m_pSavedSearchModel, QStringLiteral("SavedSearchModel"));
+
+    if (m_pNoteSearchIndex) {
+        saveSnapshot(*m_pNoteSearchIndex, QStringLiteral("NoteSearchIndex"));
+    }
+}
+
+bool MainWindow::keepInactiveAccountModels() const
+{
+    ApplicationSettings appSettings;
+    appSettings.beginGroup(preferences::keys::accountGroup);
+
+    bool result = appSettings
+                      .value(
+                          preferences::keys::keepInactiveAccountModels,
+                          preferences::defaults::keepInactiveAccountModels)
+                      .toBool();
+
+    appSettings.endGroup();
+    return result;
+}
+
+qint64 MainWindow::inactiveAccountModelsMemoryLimit() const
+{
+    ApplicationSettings appSettings;
+    appSettings.beginGroup(preferences::keys::accountGroup);
+
+    bool conversionResult = false;
+    int limitMb =
+        appSettings
+            .value(
+                preferences::keys::inactiveAccountModelsMemoryLimitMb,
+                preferences::defaults::inactiveAccountModelsMemoryLimitMb)
+            .toInt(&conversionResult);
+
+    appSettings.endGroup();
+
+    if (!conversionResult || (limitMb < 0)) {
+        QNWARNING(
+            "quentier:main_window",
+            "Invalid memory limit for models of inactive accounts: "
+                << limitMb << ", using the default one");
+        limitMb = preferences::defaults::inactiveAccountModelsMemoryLimitMb;
+    }
+
+    return static_cast<qint64>(limitMb) * 1024 * 1024;
+}
+
+bool MainWindow::useNoteSearchIndex() const
+{
+    ApplicationSettings appSettings;
+    appSettings.beginGroup(preferences::keys::accountGroup);
+
+    bool result = appSettings
+                      .value(
+                          preferences::keys::useNoteSearchIndex,
+                          preferences::defaults::useNoteSearchIndex)
+                      .toBool();
+
+    appSettings.endGroup();
+    return result;
+}
+
+namespace {
+
+qint64 countModelItems(
+    const QAbstractItemModel & model,
+    const QModelIndex & parent = QModelIndex())
+{
+    const int rowCount = model.rowCount(parent);
+    qint64 count = rowCount;
+    for (int row = 0; row < rowCount; ++row) {
+        auto index = model.index(row, 0, parent);
+        if (model.hasChildren(index)) {
+            count += countModelItems(model, index);
+        }
+    }
+
+    return count;
+}
+
+} // namespace
+
+bool MainWindow::parkModels()
+{
+    QNDEBUG("quentier:main_window", "MainWindow::parkModels");
+
+    if (!m_pNotebookModel || !m_pTagModel || !m_pSavedSearchModel ||
+        !m_pNoteModel || !m_pDeletedNotesModel || !m_pFavoritesModel)
+    {
+        QNDEBUG("quentier:main_window", "No complete set of models to park");
+        return false;
+    }
+
+    if (!keepInactiveAccountModels()) {
+        QNDEBUG(
+            "quentier:main_window",
+            "Keeping models of inactive accounts is disabled");
+        return false;
+    }
+
+    // Parked models are disconnected from local storage so only the models
+    // which have nothing left to receive from it can be parked: otherwise
+    // they would stay partially loaded forever
+    if (!m_pNotebookModel->allItemsListed() ||
+        !m_pTagModel->allItemsListed() ||
+        !m_pSavedSearchModel->allItemsListed() ||
+        !m_pFavoritesModel->allItemsListed() ||
+        m_pNoteModel->hasPendingLocalStorageRequests() ||
+        m_pDeletedNotesModel->hasPendingLocalStorageRequests())
+    {
+        QNDEBUG(
+            "quentier:main_window",
+            "Models are not fully loaded yet, won't park them");
+        return false;
+    }
+
+    ParkedModels models;
+    models.m_account = m_pNotebookModel->account();
+    models.m_pNotebookModel = m_pNotebookModel;
+    models.m_pTagModel = m_pTagModel;
+    models.m_pSavedSearchModel = m_pSavedSearchModel;
+    models.m_pNoteModel = m_pNoteModel;
+    models.m_pDeletedNotesModel = m_pDeletedNotesModel;
+    models.m_pFavoritesModel = m_pFavoritesModel;
+    models.m_pNoteCountAggregator = m_pNoteCountAggregator;
+
+    models.m_estimatedSize =
+        countModelItems(*m_pNotebookModel) * NOTEBOOK_MODEL_ITEM_SIZE_ESTIMATE +
+        countModelItems(*m_pTagModel) * TAG_MODEL_ITEM_SIZE_ESTIMATE +
+        countModelItems(*m_pSavedSearchModel) *
+            SAVED_SEARCH_MODEL_ITEM_SIZE_ESTIMATE +
+        countModelItems(*m_pFavoritesModel) *
+            FAVORITES_MODEL_ITEM_SIZE_ESTIMATE +
+        (countModelItems(*m_pNoteModel) +
+         countModelItems(*m_pDeletedNotesModel)) *
+            NOTE_MODEL_ITEM_SIZE_ESTIMATE;
+
+    QNDEBUG(
+        "quentier:main_window",
+        "Parking models of account " << models.m_account.name()
+                                     << ", estimated size = "
+                                     << models.m_estimatedSize);
+
+    m_pNotebookModel->disconnectFromLocalStorage();
+    m_pTagModel->disconnectFromLocalStorage();
+    m_pSavedSearchModel->disconnectFromLocalStorage();
+    m_pNoteModel->disconnectFromLocalStorage();
+    m_pDeletedNotesModel->disconnectFromLocalStorage();
+    m_pFavoritesModel->disconnectFromLocalStorage();
+
+    // Note count requests pending at this moment are sent again once
+    // the aggregator is connected back to local storage
+    m_pNoteCountAggregator->disconnectFromLocalStorage();
+
+    m_pNotebookModel = nullptr;
+    m_pTagModel = nullptr;
+    m_pSavedSearchModel = nullptr;
+    m_pNoteModel = nullptr;
+    m_pDeletedNotesModel = nullptr;
+    m_pFavoritesModel = nullptr;
+    m_pNoteCountAggregator = nullptr;
+
+    m_parkedModels.push_back(models);
+    releaseParkedModels(inactiveAccountModelsMemoryLimit());
+    return true;
+}
+
+bool MainWindow::unparkModels(const Account & account)
+{
+    QNDEBUG(
+        "quentier:main_window",
+        "MainWindow::unparkModels: account = " << account.name());
+
+    auto it = std::find_if(
+        m_parkedModels.begin(), m_parkedModels.end(),
+        [&account](const ParkedModels & models) {
+            return models.m_account == account;
+        });
+
+    if (it == m_parkedModels.end()) {
+        QNDEBUG("quentier:main_window", "No parked models for this account");
+        return false;
+    }
+
+    m_pNotebookModel = it->m_pNotebookModel;
+    m_pTagModel = it->m_pTagModel;
+    m_pSavedSearchModel = it->m_pSavedSearchModel;
+    m_pNoteModel = it->m_pNoteModel;
+    m_pDeletedNotesModel = it->m_pDeletedNotesModel;
+    m_pFavoritesModel = it->m_pFavoritesModel;
+    m_pNoteCountAggregator = it->m_pNoteCountAggregator;
+
+    m_parkedModels.erase(it);
+
+    // Account's details such as display name might have been updated since
+    // the models were parked
+    m_pNotebookModel->setAccount(account);
+    m_pTagModel->setAccount(account);
+    m_pSavedSearchModel->setAccount(account);
+    m_pNoteModel->updateAccount(account);
+    m_pDeletedNotesModel->updateAccount(account);
+    m_pFavoritesModel->setAccount(account);
+
+    m_pNotebookModel->connectToLocalStorage();
+    m_pTagModel->connectToLocalStorage();
+    m_pSavedSearchModel->connectToLocalStorage();
+    m_pNoteModel->connectToLocalStorage();
+    m_pDeletedNotesModel->connectToLocalStorage();
+    m_pFavoritesModel->connectToLocalStorage();
+    m_pNoteCountAggregator->connectToLocalStorage();
+
+    return true;
+}
+
+void MainWindow::releaseParkedModels(const qint64 memoryLimit)
+{
+    QNDEBUG(
+        "quentier:main_window",
+        "MainWindow::releaseParkedModels: memory limit = " << memoryLimit);
+
+    qint64 totalSize = 0;
+    for (const auto & models: qAsConst(m_parkedModels)) {
+        totalSize += models.m_estimatedSize;
+    }
+
+    while (!m_parkedModels.empty() && (totalSize > memoryLimit)) {
+        auto & models = m_parkedModels.front();
+
+        QNDEBUG(
+            "quentier:main_window",
+            "Releasing parked models of account " << models.m_account.name());
+
+        totalSize -= models.m_estimatedSize;
+
+        models.m_pNoteModel->stop(IStartable::StopMode::Forced);
+        models.m_pDeletedNotesModel->stop(IStartable::StopMode::Forced);
+
+        delete models.m_pNotebookModel;
+        delete models.m_pTagModel;
+        delete models.m_pSavedSearchModel;
+        delete models.m_pNoteModel;
+        delete models.m_pDeletedNotesModel;
+        delete models.m_pFavoritesModel;
+        delete models.m_pNoteCountAggregator;
+
+        m_parkedModels.erase(m_parkedModels.begin());
+    }
 }
 
 void MainWindow::setupShowHideStartupSettings()
@@ -6056,7 +6470,7 @@ void MainWindow::setupNoteFilters()
         *m_pAccount, *m_pUi->filterByTagsWidget,
         *m_pUi->filterByNotebooksWidget, *m_pNoteModel,
         *m_pUi->filterBySavedSearchComboBox, *m_pUi->filterBySearchStringWidget,
-        *m_pLocalStorageManagerAsync, this);
+        *m_pLocalStorageManagerAsync, this, m_pNoteSearchIndex);
 
     m_pNoteModel->start();
 
@@ -75,9 +75,12 @@ QT_FORWARD_DECLARE_CLASS(ColumnChangeRerouter)
 namespace quentier {
 
 QT_FORWARD_DECLARE_CLASS(EditNoteDialogsManager)
+QT_FORWARD_DECLARE_CLASS(LocalStorageRequestTracer)
 QT_FORWARD_DECLARE_CLASS(NoteCountLabelController)
+QT_FORWARD_DECLARE_CLASS(NoteCountAggregator)
 QT_FORWARD_DECLARE_CLASS(NoteEditor)
 QT_FORWARD_DECLARE_CLASS(NoteFiltersManager)
+QT_FORWARD_DECLARE_CLASS(NoteSearchIndex)
 QT_FORWARD_DECLARE_CLASS(PreferencesDialog)
 QT_FORWARD_DECLARE_CLASS(SystemTrayIconManager)
 
@@ -288,6 +291,9 @@ private Q_SLOTS:
     void onEnexImportCompletedSuccessfully(QString enexFilePath);
     void onEnexImportFailed(ErrorString errorDescription);
 
+    void onEnexImportProgress(
+        int addedNotesCount, int totalNotesCount, double notesPerSecond);
+
     // Preferences dialog slots
     void onUseLimitedFontsPreferenceChanged(bool flag);
     void onShowNoteThumbnailsPreferenceChanged();
@@ -381,6 +387,17 @@ private:
     void setupModels();
     void clearModels();
 
+    bool keepInactiveAccountModels() const;
+    qint64 inactiveAccountModelsMemoryLimit() const;
+    bool useNoteSearchIndex() const;
+
+    bool parkModels();
+    bool unparkModels(const Account & account);
+    void releaseParkedModels(const qint64 memoryLimit);
+
+    // Should only be called when local storage of models' account is closed
+    void saveModelSnapshots();
+
     void setupShowHideStartupSettings();
     void setupViews();
     void clearViews();
@@ -519,6 +536,14 @@ private:
     QThread * m_pLocalStorageManagerThread = nullptr;
     LocalStorageManagerAsync * m_pLocalStorageManagerAsync = nullptr;
 
+    // Throttles and prioritizes read requests models send to local storage
+    LocalStorageRequestScheduler * m_pLocalStorageRequestScheduler = nullptr;
+    LocalStorageRequestTracer * m_pLocalStorageRequestTracer = nullptr;
+
+    // Identity of local storage database file captured right before it was
+    // opened, used to tell whether model snapshots are still up to date
+    QByteArray m_localStorageChangeMarker;
+
     QUuid m_lastLocalStorageSwitchUserRequest;
 
     QThread * m_pSynchronizationManagerThread = nullptr;
@@ -565,10 +590,35 @@ private:
     NoteModel * m_pDeletedNotesModel = nullptr;
     FavoritesModel * m_pFavoritesModel = nullptr;
 
+    // Note counts shared by notebook, tag and favorites models
+    NoteCountAggregator * m_pNoteCountAggregator = nullptr;
+
+    // Models of previously active accounts kept in memory, disconnected from
+    // local storage, so that switching back to these accounts doesn't require
+    // loading all the data from local storage again
+    struct ParkedModels
+    {
+        Account m_account;
+        NotebookModel * m_pNotebookModel = nullptr;
+        TagModel * m_pTagModel = nullptr;
+        SavedSearchModel * m_pSavedSearchModel = nullptr;
+        NoteModel * m_pNoteModel = nullptr;
+        NoteModel * m_pDeletedNotesModel = nullptr;
+        FavoritesModel * m_pFavoritesModel = nullptr;
+        NoteCountAggregator * m_pNoteCountAggregator = nullptr;
+        qint64 m_estimatedSize = 0;
+    };
+
+    // Ordered from the least recently parked to the most recently parked
+    std::vector<ParkedModels> m_parkedModels;
+
     QStandardItemModel m_blankModel;
 
     NoteFiltersManager * m_pNoteFiltersManager = nullptr;
 
+    // Not parked along with models as it is restored from its snapshot
+    NoteSearchIndex * m_pNoteSearchIndex = nullptr;
+
     int m_setDefaultAccountsFirstNoteAsCurrentDelayTimerId = 0;
     QString m_defaultAccountFirstNoteLocalUid;
 
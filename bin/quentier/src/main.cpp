@@ -25,6 +25,7 @@
 #include <lib/initialization/LoadDependencies.h>
 #include <lib/tray/SystemTrayIconManager.h>
 #include <lib/utility/ExitCodes.h>
+#include <lib/utility/Log.h>
 #include <lib/utility/RestartApp.h>
 
 #include <quentier/exception/DatabaseLockedException.h>
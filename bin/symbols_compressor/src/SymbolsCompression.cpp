@@ -0,0 +1,341 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SymbolsCompression.h"
+
+#include <QCoreApplication>
+#include <QIODevice>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// qCompress adds 4 bytes of size header and zlib's worst case overhead is
+// a few bytes per 16 KB so anything noticeably larger is garbage; computed
+// in 64 bits so that it can't overflow
+#define MAX_COMPRESSED_BLOCK_SIZE(blockSize)                                   \
+    (static_cast<quint64>(blockSize) + static_cast<quint64>(blockSize) / 8 +   \
+     1024)
+
+class BlockProcessor final : public QRunnable
+{
+public:
+    BlockProcessor(
+        const QByteArray & input, const bool compress, QByteArray & output) :
+        m_input(input),
+        m_compress(compress), m_output(output)
+    {}
+
+    virtual void run() override
+    {
+        if (m_compress) {
+            m_output = qCompress(m_input, 9);
+        }
+        else {
+            m_output = qUncompress(m_input);
+        }
+    }
+
+private:
+    const QByteArray m_input;
+    const bool m_compress;
+    QByteArray & m_output;
+};
+
+int numBlocksPerRound()
+{
+    return std::max(QThread::idealThreadCount(), 1);
+}
+
+void processBlocks(
+    const QVector<QByteArray> & inputs, const bool compress,
+    QVector<QByteArray> & outputs)
+{
+    outputs.clear();
+    outputs.resize(inputs.size());
+
+    if (inputs.size() == 1) {
+        BlockProcessor processor(inputs[0], compress, outputs[0]);
+        processor.run();
+        return;
+    }
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(numBlocksPerRound());
+
+    for (int i = 0, size = inputs.size(); i < size; ++i) {
+        threadPool.start(new BlockProcessor(inputs[i], compress, outputs[i]));
+    }
+
+    threadPool.waitForDone();
+}
+
+bool writeUInt32(QIODevice & output, const quint32 value)
+{
+    uchar buffer[4];
+    qToBigEndian(value, buffer);
+
+    return output.write(reinterpret_cast<const char *>(buffer), 4) == 4;
+}
+
+bool readUInt32(QIODevice & input, quint32 & value)
+{
+    uchar buffer[4];
+    if (input.read(reinterpret_cast<char *>(buffer), 4) != 4) {
+        return false;
+    }
+
+    value = qFromBigEndian<quint32>(buffer);
+    return true;
+}
+
+QString writeErrorDescription(QIODevice & output)
+{
+    return QCoreApplication::translate(
+               "SymbolsCompression", "failed to write compressed symbols") +
+        QStringLiteral(": ") + output.errorString();
+}
+
+QString truncatedFileErrorDescription()
+{
+    return QCoreApplication::translate(
+        "SymbolsCompression", "compressed symbols file is truncated");
+}
+
+} // namespace
+
+bool compressSymbols(
+    QIODevice & input, QIODevice & output, const int blockSize,
+    QString & errorDescription)
+{
+    if ((blockSize <= 0) || (blockSize > SYMBOLS_COMPRESSION_MAX_BLOCK_SIZE)) {
+        errorDescription = QCoreApplication::translate(
+            "SymbolsCompression", "invalid block size");
+        return false;
+    }
+
+    if ((output.write(
+             SYMBOLS_COMPRESSION_MAGIC, SYMBOLS_COMPRESSION_MAGIC_SIZE) !=
+         SYMBOLS_COMPRESSION_MAGIC_SIZE) ||
+        !writeUInt32(output, SYMBOLS_COMPRESSION_FORMAT_VERSION) ||
+        !writeUInt32(output, static_cast<quint32>(blockSize)))
+    {
+        errorDescription = writeErrorDescription(output);
+        return false;
+    }
+
+    const int numBlocks = numBlocksPerRound();
+
+    QVector<QByteArray> blocks;
+    QVector<QByteArray> compressedBlocks;
+
+    while (true) {
+        blocks.clear();
+        for (int i = 0; i < numBlocks; ++i) {
+            QByteArray block = input.read(blockSize);
+            if (block.isEmpty()) {
+                break;
+            }
+
+            blocks << block;
+        }
+
+        if (blocks.isEmpty()) {
+            break;
+        }
+
+        processBlocks(blocks, /* compress = */ true, compressedBlocks);
+
+        for (const auto & compressedBlock: qAsConst(compressedBlocks)) {
+            bool res = writeUInt32(
+                output, static_cast<quint32>(compressedBlock.size()));
+
+            res = res &&
+                (output.write(compressedBlock) == compressedBlock.size());
+
+            if (!res) {
+                errorDescription = writeErrorDescription(output);
+                return false;
+            }
+        }
+    }
+
+    if (!writeUInt32(output, 0)) {
+        errorDescription = writeErrorDescription(output);
+        return false;
+    }
+
+    return true;
+}
+
+CompressedSymbolsReader::CompressedSymbolsReader(QIODevice & input) :
+    m_input(input)
+{}
+
+bool CompressedSymbolsReader::readNext(
+    QByteArray & data, QString & errorDescription)
+{
+    data.clear();
+
+    if (m_atEnd) {
+        return true;
+    }
+
+    if (!m_headerRead) {
+        if (!readHeader(errorDescription)) {
+            return false;
+        }
+    }
+
+    if (m_legacyFormat) {
+        data = qUncompress(m_input.readAll());
+        m_atEnd = true;
+
+        if (data.isEmpty()) {
+            errorDescription = QCoreApplication::translate(
+                "SymbolsCompression", "failed to uncompress symbols");
+            return false;
+        }
+
+        return true;
+    }
+
+    // The blocks uncompressed in one round are joined into a single byte array
+    const int numBlocks = std::max(
+        std::min(
+            numBlocksPerRound(),
+            static_cast<int>(
+                std::numeric_limits<int>::max() / m_blockSize)),
+        1);
+
+    QVector<QByteArray> compressedBlocks;
+    compressedBlocks.reserve(numBlocks);
+
+    for (int i = 0; i < numBlocks; ++i) {
+        quint32 compressedBlockSize = 0;
+        if (!readUInt32(m_input, compressedBlockSize)) {
+            errorDescription = truncatedFileErrorDescription();
+            return false;
+        }
+
+        if (compressedBlockSize == 0) {
+            m_atEnd = true;
+            break;
+        }
+
+        if (static_cast<quint64>(compressedBlockSize) >
+            MAX_COMPRESSED_BLOCK_SIZE(m_blockSize))
+        {
+            errorDescription = QCoreApplication::translate(
+                "SymbolsCompression",
+                "compressed symbols file is corrupted: invalid block size");
+            return false;
+        }
+
+        QByteArray compressedBlock =
+            m_input.read(static_cast<qint64>(compressedBlockSize));
+
+        if (compressedBlock.size() != static_cast<int>(compressedBlockSize)) {
+            errorDescription = truncatedFileErrorDescription();
+            return false;
+        }
+
+        compressedBlocks << compressedBlock;
+    }
+
+    if (compressedBlocks.isEmpty()) {
+        return true;
+    }
+
+    QVector<QByteArray> blocks;
+    processBlocks(compressedBlocks, /* compress = */ false, blocks);
+
+    int totalSize = 0;
+    for (const auto & block: qAsConst(blocks)) {
+        if (block.isEmpty() ||
+            (static_cast<quint32>(block.size()) > m_blockSize))
+        {
+            errorDescription = QCoreApplication::translate(
+                "SymbolsCompression", "failed to uncompress symbols block");
+            return false;
+        }
+
+        totalSize += block.size();
+    }
+
+    if (blocks.size() == 1) {
+        data = blocks[0];
+        return true;
+    }
+
+    data.reserve(totalSize);
+    for (const auto & block: qAsConst(blocks)) {
+        data += block;
+    }
+
+    return true;
+}
+
+bool CompressedSymbolsReader::readHeader(QString & errorDescription)
+{
+    m_headerRead = true;
+
+    QByteArray magic = m_input.peek(SYMBOLS_COMPRESSION_MAGIC_SIZE);
+    if (magic != QByteArray(SYMBOLS_COMPRESSION_MAGIC)) {
+        m_legacyFormat = true;
+        return true;
+    }
+
+    Q_UNUSED(m_input.read(SYMBOLS_COMPRESSION_MAGIC_SIZE))
+
+    quint32 version = 0;
+    if (!readUInt32(m_input, version) || !readUInt32(m_input, m_blockSize)) {
+        errorDescription = truncatedFileErrorDescription();
+        return false;
+    }
+
+    if (version != SYMBOLS_COMPRESSION_FORMAT_VERSION) {
+        errorDescription =
+            QCoreApplication::translate(
+                "SymbolsCompression",
+                "unsupported compressed symbols format version") +
+            QStringLiteral(": ") + QString::number(version);
+        return false;
+    }
+
+    if ((m_blockSize == 0) ||
+        (m_blockSize > quint32(SYMBOLS_COMPRESSION_MAX_BLOCK_SIZE)))
+    {
+        errorDescription =
+            QCoreApplication::translate(
+                "SymbolsCompression",
+                "compressed symbols file is corrupted: invalid block size in "
+                "the header") +
+            QStringLiteral(": ") + QString::number(m_blockSize);
+        return false;
+    }
+
+    return true;
+}
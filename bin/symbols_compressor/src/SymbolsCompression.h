@@ -0,0 +1,116 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_SYMBOLS_COMPRESSOR_SYMBOLS_COMPRESSION_H
+#define QUENTIER_SYMBOLS_COMPRESSOR_SYMBOLS_COMPRESSION_H
+
+#include <QByteArray>
+#include <QString>
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+/**
+ * Compressed symbols files consist of a header followed by independently
+ * compressed blocks of data:
+ *
+ * - 8 bytes of SYMBOLS_COMPRESSION_MAGIC
+ * - quint32 format version
+ * - quint32 max size of uncompressed block
+ * - sequence of blocks, each one is quint32 size of compressed block followed
+ *   by the block's data compressed with qCompress
+ * - quint32 zero terminating the sequence of blocks
+ *
+ * All numbers are big endian. As blocks are independent, they are compressed
+ * and uncompressed in parallel and neither compression nor decompression
+ * needs to hold the whole symbols file in memory.
+ *
+ * Files produced by older versions of symbols compressor are single
+ * qCompress'ed buffers without any header.
+ */
+
+#define SYMBOLS_COMPRESSION_MAGIC "QNSYMBLK"
+#define SYMBOLS_COMPRESSION_MAGIC_SIZE (8)
+#define SYMBOLS_COMPRESSION_FORMAT_VERSION (1)
+
+#define SYMBOLS_COMPRESSION_DEFAULT_BLOCK_SIZE (4 * 1024 * 1024)
+
+// Larger block sizes in the header mean the file is corrupted; the limit also
+// keeps the memory used by the reader's parallel blocks bounded
+#define SYMBOLS_COMPRESSION_MAX_BLOCK_SIZE (64 * 1024 * 1024)
+
+/**
+ * Compresses the data read from input into the chunked format written to
+ * output
+ *
+ * @param input             Device to read uncompressed symbols from
+ * @param output            Device to write compressed symbols to
+ * @param blockSize         Size of uncompressed blocks
+ * @param errorDescription  Textual description of the error if compression
+ *                          failed
+ * @return                  True in case of success, false otherwise
+ */
+bool compressSymbols(
+    QIODevice & input, QIODevice & output, const int blockSize,
+    QString & errorDescription);
+
+/**
+ * @brief The CompressedSymbolsReader class reads compressed symbols file
+ * piece by piece. Both chunked and legacy formats are supported; legacy
+ * files are returned as a single piece.
+ */
+class CompressedSymbolsReader
+{
+public:
+    explicit CompressedSymbolsReader(QIODevice & input);
+
+    bool isLegacyFormat() const
+    {
+        return m_legacyFormat;
+    }
+
+    bool atEnd() const
+    {
+        return m_atEnd;
+    }
+
+    /**
+     * Reads and uncompresses the next several blocks of data in parallel
+     *
+     * @param data              Uncompressed data of the blocks read
+     * @param errorDescription  Textual description of the error if reading
+     *                          failed
+     * @return                  True in case of success, false otherwise;
+     *                          when the end of data is reached, true is
+     *                          returned along with empty data
+     */
+    bool readNext(QByteArray & data, QString & errorDescription);
+
+private:
+    bool readHeader(QString & errorDescription);
+
+private:
+    QIODevice & m_input;
+
+    bool m_headerRead = false;
+    bool m_legacyFormat = false;
+    bool m_atEnd = false;
+
+    quint32 m_blockSize = 0;
+};
+
+#endif // QUENTIER_SYMBOLS_COMPRESSOR_SYMBOLS_COMPRESSION_H
@@ -16,7 +16,8 @@
  * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <QByteArray>
+#include "SymbolsCompression.h"
+
 #include <QCoreApplication>
 #include <QDebug>
 #include <QFile>
@@ -41,11 +42,6 @@ int main(int argc, char * argv[])
         return 1;
     }
 
-    QByteArray fileContents = symbolsFile.readAll();
-    symbolsFile.close();
-
-    fileContents = qCompress(fileContents, 9);
-
     QFileInfo symbolsFileInfo(args[1]);
 
     QFile compressedSymbolsFile(
@@ -58,8 +54,20 @@ int main(int argc, char * argv[])
         return 1;
     }
 
-    compressedSymbolsFile.write(fileContents);
+    QString errorDescription;
+    res = compressSymbols(
+        symbolsFile, compressedSymbolsFile,
+        SYMBOLS_COMPRESSION_DEFAULT_BLOCK_SIZE, errorDescription);
+
+    symbolsFile.close();
     compressedSymbolsFile.close();
 
+    if (!res) {
+        qWarning() << "Failed to compress the symbols file: "
+                   << errorDescription;
+        Q_UNUSED(compressedSymbolsFile.remove())
+        return 1;
+    }
+
     return 0;
 }
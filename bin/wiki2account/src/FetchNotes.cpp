@@ -19,6 +19,7 @@
 #include "FetchNotes.h"
 #include "WikiArticlesFetcher.h"
 #include "WikiArticlesFetchingTracker.h"
+#include "WikiArticlesPipeline.h"
 
 #include <quentier/utility/EventLoopWithExitStatus.h>
 
@@ -27,14 +28,11 @@
 
 namespace quentier {
 
-bool fetchNotes(
-    const QList<Notebook> & notebooks, const QList<Tag> & tags,
-    const quint32 minTagsPerNote, const quint32 numNotes,
-    LocalStorageManagerAsync & localStorageManager)
-{
-    auto * pFetcher = new WikiArticlesFetcher(
-        notebooks, tags, minTagsPerNote, numNotes, localStorageManager);
+namespace {
 
+template <class Fetcher>
+bool runFetcher(Fetcher * pFetcher)
+{
     auto * pWikiArticlerFetcherThread = new QThread;
 
     pWikiArticlerFetcherThread->setObjectName(
@@ -50,15 +48,15 @@ bool fetchNotes(
     WikiArticlesFetchingTracker tracker;
 
     QObject::connect(
-        pFetcher, &WikiArticlesFetcher::finished, &tracker,
+        pFetcher, &Fetcher::finished, &tracker,
         &WikiArticlesFetchingTracker::onWikiArticlesFetchingFinished);
 
     QObject::connect(
-        pFetcher, &WikiArticlesFetcher::failure, &tracker,
+        pFetcher, &Fetcher::failure, &tracker,
         &WikiArticlesFetchingTracker::onWikiArticlesFetchingFailed);
 
     QObject::connect(
-        pFetcher, &WikiArticlesFetcher::progress, &tracker,
+        pFetcher, &Fetcher::progress, &tracker,
         &WikiArticlesFetchingTracker::onWikiArticlesFetchingProgressUpdate);
 
     auto status = EventLoopWithExitStatus::ExitStatus::Failure;
@@ -92,4 +90,22 @@ bool fetchNotes(
     return false;
 }
 
+} // namespace
+
+bool fetchNotes(
+    const QList<Notebook> & notebooks, const QList<Tag> & tags,
+    const quint32 minTagsPerNote, const quint32 numNotes,
+    const PipelineOptions & pipelineOptions,
+    LocalStorageManagerAsync & localStorageManager)
+{
+    if (pipelineOptions.m_enabled) {
+        return runFetcher(new WikiArticlesPipeline(
+            notebooks, tags, minTagsPerNote, numNotes, pipelineOptions,
+            localStorageManager));
+    }
+
+    return runFetcher(new WikiArticlesFetcher(
+        notebooks, tags, minTagsPerNote, numNotes, localStorageManager));
+}
+
 } // namespace quentier
@@ -19,6 +19,8 @@
 #ifndef QUENTIER_WIKI2ACCOUNT_FETCH_NOTES_H
 #define QUENTIER_WIKI2ACCOUNT_FETCH_NOTES_H
 
+#include "ProcessPipelineOptions.h"
+
 #include <quentier/types/Notebook.h>
 #include <quentier/types/Tag.h>
 
@@ -29,6 +31,7 @@ QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
 bool fetchNotes(
     const QList<Notebook> & notebooks, const QList<Tag> & tags,
     const quint32 minTagsPerNote, const quint32 numNotes,
+    const PipelineOptions & pipelineOptions,
     LocalStorageManagerAsync & localStorageManager);
 
 } // namespace quentier
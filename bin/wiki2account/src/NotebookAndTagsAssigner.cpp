@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NotebookAndTagsAssigner.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+namespace quentier {
+
+NotebookAndTagsAssigner::NotebookAndTagsAssigner(
+    QList<Notebook> notebooks, QList<Tag> tags, quint32 minTagsPerNote) :
+    m_notebooks(std::move(notebooks)),
+    m_tags(std::move(tags)), m_minTagsPerNote(minTagsPerNote)
+{}
+
+void NotebookAndTagsAssigner::assign(Note & note)
+{
+    int notebookIndex = nextNotebookIndex();
+    auto & notebook = m_notebooks[notebookIndex];
+    note.setNotebookLocalUid(notebook.localUid());
+
+    addTagsToNote(note);
+}
+
+void NotebookAndTagsAssigner::addTagsToNote(Note & note)
+{
+    QNDEBUG("wiki2account", "NotebookAndTagsAssigner::addTagsToNote");
+
+    if (m_tags.isEmpty()) {
+        QNDEBUG("wiki2account", "No tags to assign to note");
+        return;
+    }
+
+    int lowest = static_cast<int>(m_minTagsPerNote);
+    int highest = m_tags.size();
+
+    // Protect from the case in which lowest > highest
+    lowest = std::min(lowest, highest);
+
+    int range = (highest - lowest) + 1;
+    int randomValue = std::rand();
+    int numTags = lowest +
+        static_cast<int>(std::floor(
+            static_cast<double>(range) * static_cast<double>(randomValue) /
+            (RAND_MAX + 1.0)));
+
+    QNTRACE("wiki2account", "Adding " << numTags << " tags to note");
+    for (int i = 0; i < numTags; ++i) {
+        note.addTagLocalUid(m_tags[i].localUid());
+    }
+}
+
+int NotebookAndTagsAssigner::nextNotebookIndex()
+{
+    ++m_notebookIndex;
+    if (m_notebookIndex >= m_notebooks.size()) {
+        m_notebookIndex = 0;
+    }
+
+    return m_notebookIndex;
+}
+
+} // namespace quentier
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_WIKI2ACCOUNT_NOTEBOOK_AND_TAGS_ASSIGNER_H
+#define QUENTIER_WIKI2ACCOUNT_NOTEBOOK_AND_TAGS_ASSIGNER_H
+
+#include <quentier/types/Note.h>
+#include <quentier/types/Notebook.h>
+#include <quentier/types/Tag.h>
+
+#include <QList>
+
+namespace quentier {
+
+/**
+ * @brief The NotebookAndTagsAssigner class distributes notes created from
+ * wiki articles between notebooks in round robin fashion and assigns
+ * a random number of tags to each note
+ */
+class NotebookAndTagsAssigner
+{
+public:
+    explicit NotebookAndTagsAssigner(
+        QList<Notebook> notebooks, QList<Tag> tags, quint32 minTagsPerNote);
+
+    void assign(Note & note);
+
+private:
+    void addTagsToNote(Note & note);
+    int nextNotebookIndex();
+
+private:
+    QList<Notebook> m_notebooks;
+    QList<Tag> m_tags;
+    quint32 m_minTagsPerNote;
+
+    int m_notebookIndex = 0;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_WIKI2ACCOUNT_NOTEBOOK_AND_TAGS_ASSIGNER_H
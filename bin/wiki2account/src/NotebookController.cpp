@@ -18,6 +18,8 @@
 
 #include "NotebookController.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/local_storage/LocalStorageManagerAsync.h>
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
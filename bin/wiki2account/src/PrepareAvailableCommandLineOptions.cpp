@@ -58,6 +58,52 @@ void prepareAvailableCommandLineOptions(
     maxTagsPerNote.m_description = QStringLiteral(
         "max number of new tags to be assigned to notes created "
         "from wiki articles; by default 0");
+
+    auto & pipelinedData = options[QStringLiteral("pipelined")];
+
+    pipelinedData.m_description = QStringLiteral(
+        "overlap downloading of wiki articles, their conversion to notes "
+        "and adding notes to the local storage; implied by any of the "
+        "options below");
+
+    auto & fetchParallelismData = options[QStringLiteral("fetch-parallelism")];
+    fetchParallelismData.m_type = CommandLineParser::ArgumentType::Int;
+
+    fetchParallelismData.m_description = QStringLiteral(
+        "max number of wiki articles downloaded simultaneously in "
+        "pipelined mode; by default 8");
+
+    auto & conversionThreadsData =
+        options[QStringLiteral("conversion-threads")];
+
+    conversionThreadsData.m_type = CommandLineParser::ArgumentType::Int;
+
+    conversionThreadsData.m_description = QStringLiteral(
+        "number of threads converting wiki articles to notes in pipelined "
+        "mode; by default the number of CPU cores");
+
+    auto & insertBatchSizeData = options[QStringLiteral("insert-batch-size")];
+    insertBatchSizeData.m_type = CommandLineParser::ArgumentType::Int;
+
+    insertBatchSizeData.m_description = QStringLiteral(
+        "number of notes sent to the local storage at once in pipelined "
+        "mode; by default 50");
+
+    auto & articlesDirData = options[QStringLiteral("articles-dir")];
+    articlesDirData.m_type = CommandLineParser::ArgumentType::String;
+
+    articlesDirData.m_description = QStringLiteral(
+        "dir into which downloaded wiki articles and their images are saved "
+        "in pipelined mode; with --offline notes are created from articles "
+        "saved there before");
+
+    auto & offlineData = options[QStringLiteral("offline")];
+
+    offlineData.m_description = QStringLiteral(
+        "create notes from wiki articles saved to --articles-dir before "
+        "instead of downloading them; articles are reused in a loop if "
+        "more notes than saved articles are requested; no images are "
+        "downloaded so articles with images not saved before fail");
 }
 
 } // namespace quentier
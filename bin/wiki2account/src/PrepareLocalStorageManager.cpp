@@ -44,7 +44,7 @@ LocalStorageManagerAsync * prepareLocalStorageManager(
     if (!localStoragePatches.isEmpty()) {
         errorDescription.setBase(
             QT_TR_NOOP("Local storage requires upgrade. "
-                       "Please start Quentier before running wiki2account"));
+                       "Please start Quentier before running this tool"));
         return nullptr;
     }
 
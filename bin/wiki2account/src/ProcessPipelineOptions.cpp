@@ -0,0 +1,134 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProcessPipelineOptions.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+namespace quentier {
+
+namespace {
+
+bool processPositiveNumberOption(
+    const CommandLineParser::Options & options, const QString & optionName,
+    quint32 & value)
+{
+    auto it = options.find(optionName);
+    if (it == options.end()) {
+        return true;
+    }
+
+    bool conversionResult = false;
+    quint32 num = it.value().toUInt(&conversionResult);
+    if (!conversionResult || (num == 0)) {
+        qWarning() << "Failed to parse " << optionName
+                   << " option value to positive integer";
+        return false;
+    }
+
+    value = num;
+    return true;
+}
+
+} // namespace
+
+bool processPipelineOptions(
+    const CommandLineParser::Options & options,
+    PipelineOptions & pipelineOptions)
+{
+    pipelineOptions = PipelineOptions();
+
+    pipelineOptions.m_enabled =
+        options.contains(QStringLiteral("pipelined")) ||
+        options.contains(QStringLiteral("fetch-parallelism")) ||
+        options.contains(QStringLiteral("conversion-threads")) ||
+        options.contains(QStringLiteral("insert-batch-size")) ||
+        options.contains(QStringLiteral("articles-dir")) ||
+        options.contains(QStringLiteral("offline"));
+
+    if (!pipelineOptions.m_enabled) {
+        return true;
+    }
+
+    bool res = processPositiveNumberOption(
+        options, QStringLiteral("fetch-parallelism"),
+        pipelineOptions.m_numParallelFetches);
+
+    if (!res) {
+        return false;
+    }
+
+    res = processPositiveNumberOption(
+        options, QStringLiteral("conversion-threads"),
+        pipelineOptions.m_numConversionThreads);
+
+    if (!res) {
+        return false;
+    }
+
+    res = processPositiveNumberOption(
+        options, QStringLiteral("insert-batch-size"),
+        pipelineOptions.m_insertBatchSize);
+
+    if (!res) {
+        return false;
+    }
+
+    pipelineOptions.m_offline = options.contains(QStringLiteral("offline"));
+
+    auto articlesDirIt = options.find(QStringLiteral("articles-dir"));
+    if (articlesDirIt != options.end()) {
+        QString path = articlesDirIt.value().toString();
+        if (path.isEmpty()) {
+            qWarning() << "Empty articles dir path";
+            return false;
+        }
+
+        QFileInfo articlesDirInfo(path);
+        if (!articlesDirInfo.exists()) {
+            if (pipelineOptions.m_offline) {
+                qWarning() << "Articles dir doesn't exist: " << path;
+                return false;
+            }
+
+            QDir articlesDir(path);
+            if (!articlesDir.mkpath(path)) {
+                qWarning() << "Failed to create articles dir: " << path;
+                return false;
+            }
+        }
+        else if (!articlesDirInfo.isDir()) {
+            qWarning() << "Articles dir path doesn't point to a dir: "
+                       << path;
+            return false;
+        }
+
+        pipelineOptions.m_articlesDirPath = path;
+    }
+    else if (pipelineOptions.m_offline) {
+        qWarning() << "Offline mode requires articles dir to be specified "
+                      "via --articles-dir";
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace quentier
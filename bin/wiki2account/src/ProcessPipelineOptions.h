@@ -0,0 +1,76 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_WIKI2ACCOUNT_PROCESS_PIPELINE_OPTIONS_H
+#define QUENTIER_WIKI2ACCOUNT_PROCESS_PIPELINE_OPTIONS_H
+
+#include <lib/initialization/CommandLineParser.h>
+
+#include <QString>
+
+#define PIPELINE_DEFAULT_NUM_PARALLEL_FETCHES (8)
+#define PIPELINE_DEFAULT_INSERT_BATCH_SIZE (50)
+
+namespace quentier {
+
+/**
+ * @brief The PipelineOptions struct describes the parameters of pipelined
+ * notes generation mode in which article fetching, article conversion to
+ * notes and adding notes to the local storage overlap
+ */
+struct PipelineOptions
+{
+    // Whether pipelined mode should be used at all
+    bool m_enabled = false;
+
+    // Max number of wiki articles being downloaded simultaneously
+    quint32 m_numParallelFetches = PIPELINE_DEFAULT_NUM_PARALLEL_FETCHES;
+
+    // Number of threads converting articles to notes; zero means
+    // the ideal thread count for the machine
+    quint32 m_numConversionThreads = 0;
+
+    // Number of notes sent to the local storage at once
+    quint32 m_insertBatchSize = PIPELINE_DEFAULT_INSERT_BATCH_SIZE;
+
+    // Dir in which downloaded articles' HTML is saved (in online mode) or
+    // from which it is replayed (in offline mode)
+    QString m_articlesDirPath;
+
+    // Whether notes should be generated from articles previously saved
+    // to articles dir instead of downloading them from wiki
+    bool m_offline = false;
+};
+
+/**
+ * Processes command line options related to pipelined notes generation
+ * mode; this mode is enabled if any of these options is specified
+ *
+ * @param options                   Command line options
+ * @param pipelineOptions           Parsed pipeline options
+ * @return                          True if pipeline related command line
+ *                                  options were processed successfully,
+ *                                  false otherwise
+ */
+bool processPipelineOptions(
+    const CommandLineParser::Options & options,
+    PipelineOptions & pipelineOptions);
+
+} // namespace quentier
+
+#endif // QUENTIER_WIKI2ACCOUNT_PROCESS_PIPELINE_OPTIONS_H
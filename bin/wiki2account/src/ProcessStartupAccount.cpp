@@ -54,7 +54,8 @@ Account createNewLocalAccount(
 
 } // namespace
 
-Account processStartupAccount(const CommandLineParser::Options & options)
+Account processStartupAccount(
+    const CommandLineParser::Options & options, const QString & newAccountName)
 {
     std::unique_ptr<Account> pAccount;
     if (!processAccountCommandLineOption(options, pAccount)) {
@@ -67,8 +68,7 @@ Account processStartupAccount(const CommandLineParser::Options & options)
 
     AccountManager accountManager;
     if (options.contains(QStringLiteral("new-account"))) {
-        return createNewLocalAccount(
-            QStringLiteral("Wiki notes"), accountManager);
+        return createNewLocalAccount(newAccountName, accountManager);
     }
 
     auto availableAccounts = accountManager.availableAccounts();
@@ -109,8 +109,7 @@ Account processStartupAccount(const CommandLineParser::Options & options)
     while (true) {
         QString line = stdinStrm.readLine().trimmed();
         if (line == QStringLiteral("new")) {
-            return createNewLocalAccount(
-                QStringLiteral("Wiki notes"), accountManager);
+            return createNewLocalAccount(newAccountName, accountManager);
         }
 
         bool conversionResult = false;
@@ -25,7 +25,19 @@
 
 namespace quentier {
 
-Account processStartupAccount(const CommandLineParser::Options & options);
+/**
+ * Finds the account specified via command line options or asks the user
+ * to choose one or to create a new local account
+ *
+ * @param options                   Command line options
+ * @param newAccountName            Name of the local account to create if
+ *                                  the user chooses to create a new one
+ * @return                          Chosen account or empty account in case
+ *                                  of error
+ */
+Account processStartupAccount(
+    const CommandLineParser::Options & options,
+    const QString & newAccountName = QStringLiteral("Wiki notes"));
 
 } // namespace quentier
 
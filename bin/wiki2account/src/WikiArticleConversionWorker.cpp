@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WikiArticleConversionWorker.h"
+
+#include <lib/network/NetworkFetchService.h>
+#include <lib/utility/Log.h>
+#include <lib/wiki2note/WikiArticleToNote.h>
+
+#include <quentier/logging/QuentierLogger.h>
+
+namespace quentier {
+
+WikiArticleConversionWorker::WikiArticleConversionWorker(
+    const QString & imagesCacheDirPath, const qint64 timeoutMsec,
+    const bool offline, QObject * parent) :
+    QObject(parent),
+    m_imagesCacheDirPath(imagesCacheDirPath), m_timeoutMsec(timeoutMsec),
+    m_offline(offline)
+{}
+
+WikiArticleConversionWorker::~WikiArticleConversionWorker() = default;
+
+void WikiArticleConversionWorker::convert(
+    QUuid requestId, QByteArray articleHtml)
+{
+    QNDEBUG(
+        "wiki2account",
+        "WikiArticleConversionWorker::convert: request id = " << requestId);
+
+    if (!m_pFetchService) {
+        m_pFetchService = new NetworkFetchService(
+            NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS,
+            m_imagesCacheDirPath, m_timeoutMsec, this);
+
+        m_pFetchService->setCacheOnly(m_offline);
+    }
+
+    auto * pWikiArticleToNote =
+        new WikiArticleToNote(m_enmlConverter, *m_pFetchService, this);
+
+    QObject::connect(
+        pWikiArticleToNote, &WikiArticleToNote::finished, this,
+        &WikiArticleConversionWorker::onWikiArticleToNoteFinished);
+
+    m_requestIdsByConverter[pWikiArticleToNote] = requestId;
+    pWikiArticleToNote->start(articleHtml);
+}
+
+void WikiArticleConversionWorker::onWikiArticleToNoteFinished(
+    bool status, ErrorString errorDescription, Note note)
+{
+    auto * pWikiArticleToNote = qobject_cast<WikiArticleToNote *>(sender());
+    auto it = m_requestIdsByConverter.find(pWikiArticleToNote);
+    if (it == m_requestIdsByConverter.end()) {
+        QNWARNING(
+            "wiki2account",
+            "Received finished signal from unrecognized "
+                << "WikiArticleToNote");
+        return;
+    }
+
+    QUuid requestId = it.value();
+    m_requestIdsByConverter.erase(it);
+
+    QNDEBUG(
+        "wiki2account",
+        "WikiArticleConversionWorker::onWikiArticleToNoteFinished: "
+            << (status ? "success" : "failure") << ", request id = "
+            << requestId << ", error description = " << errorDescription);
+
+    pWikiArticleToNote->disconnect(this);
+    pWikiArticleToNote->deleteLater();
+
+    Q_EMIT finished(requestId, status, errorDescription, note);
+}
+
+} // namespace quentier
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_WIKI2ACCOUNT_WIKI_ARTICLE_CONVERSION_WORKER_H
+#define QUENTIER_WIKI2ACCOUNT_WIKI_ARTICLE_CONVERSION_WORKER_H
+
+#include <quentier/enml/ENMLConverter.h>
+#include <quentier/types/ErrorString.h>
+#include <quentier/types/Note.h>
+
+#include <QHash>
+#include <QObject>
+#include <QUuid>
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(NetworkFetchService)
+QT_FORWARD_DECLARE_CLASS(WikiArticleToNote)
+
+/**
+ * @brief The WikiArticleConversionWorker class converts wiki articles' HTML
+ * to notes; it is meant to live in its own thread so that several articles
+ * can be converted in parallel. Each worker uses its own NetworkFetchService
+ * to download images; services of different workers may share the same
+ * cache dir. In offline mode images are only taken from the cache and
+ * articles with images missing from it fail to convert.
+ */
+class WikiArticleConversionWorker final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WikiArticleConversionWorker(
+        const QString & imagesCacheDirPath, const qint64 timeoutMsec,
+        const bool offline, QObject * parent = nullptr);
+
+    virtual ~WikiArticleConversionWorker() override;
+
+Q_SIGNALS:
+    void finished(
+        QUuid requestId, bool status, ErrorString errorDescription,
+        Note note);
+
+public Q_SLOTS:
+    void convert(QUuid requestId, QByteArray articleHtml);
+
+private Q_SLOTS:
+    void onWikiArticleToNoteFinished(
+        bool status, ErrorString errorDescription, Note note);
+
+private:
+    Q_DISABLE_COPY(WikiArticleConversionWorker)
+
+private:
+    ENMLConverter m_enmlConverter;
+    const QString m_imagesCacheDirPath;
+    const qint64 m_timeoutMsec;
+    const bool m_offline;
+
+    // Created lazily so that it lives in the worker's thread
+    NetworkFetchService * m_pFetchService = nullptr;
+
+    QHash<WikiArticleToNote *, QUuid> m_requestIdsByConverter;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_WIKI2ACCOUNT_WIKI_ARTICLE_CONVERSION_WORKER_H
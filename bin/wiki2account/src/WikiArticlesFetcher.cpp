@@ -19,12 +19,16 @@
 #include "WikiArticlesFetcher.h"
 #include "WikiRandomArticleFetcher.h"
 
+#include <lib/network/NetworkFetchService.h>
+#include <lib/utility/Log.h>
+
 #include <quentier/local_storage/LocalStorageManagerAsync.h>
 #include <quentier/logging/QuentierLogger.h>
 
+#include <QStandardPaths>
+
 #include <algorithm>
-#include <cmath>
-#include <cstdlib>
+#include <utility>
 
 namespace quentier {
 
@@ -33,7 +37,8 @@ WikiArticlesFetcher::WikiArticlesFetcher(
     quint32 numNotes, LocalStorageManagerAsync & localStorageManager,
     QObject * parent) :
     QObject(parent),
-    m_notebooks(notebooks), m_tags(tags), m_minTagsPerNote(minTagsPerNote),
+    m_notebookAndTagsAssigner(
+        std::move(notebooks), std::move(tags), minTagsPerNote),
     m_numNotes(numNotes)
 {
     createConnections(localStorageManager);
@@ -49,8 +54,20 @@ void WikiArticlesFetcher::start()
     QNDEBUG("wiki2account", "WikiArticlesFetcher::start");
 
     const qint64 timeoutMsec = -1;
+
+    if (!m_pFetchService) {
+        QString cacheDirPath =
+            QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+            QStringLiteral("/wiki2note");
+
+        m_pFetchService = new NetworkFetchService(
+            NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS,
+            cacheDirPath, timeoutMsec, this);
+    }
+
     for (quint32 i = 0; i < m_numNotes; ++i) {
-        auto * pFetcher = new WikiRandomArticleFetcher(timeoutMsec);
+        auto * pFetcher =
+            new WikiRandomArticleFetcher(*m_pFetchService, timeoutMsec);
         m_wikiRandomArticleFetchersWithProgress[pFetcher] = 0.0;
 
         QObject::connect(
@@ -84,12 +101,7 @@ void WikiArticlesFetcher::onWikiArticleFetched()
     }
 
     auto note = pFetcher->note();
-
-    int notebookIndex = nextNotebookIndex();
-    auto & notebook = m_notebooks[notebookIndex];
-    note.setNotebookLocalUid(notebook.localUid());
-
-    addTagsToNote(note);
+    m_notebookAndTagsAssigner.assign(note);
 
     QUuid requestId = QUuid::createUuid();
     Q_UNUSED(m_addNoteRequestIds.insert(requestId))
@@ -207,44 +219,6 @@ void WikiArticlesFetcher::clear()
     m_addNoteRequestIds.clear();
 }
 
-void WikiArticlesFetcher::addTagsToNote(Note & note)
-{
-    QNDEBUG("wiki2account", "WikiArticlesFetcher::addTagsToNote");
-
-    if (m_tags.isEmpty()) {
-        QNDEBUG("wiki2account", "No tags to assign to note");
-        return;
-    }
-
-    int lowest = static_cast<int>(m_minTagsPerNote);
-    int highest = m_tags.size();
-
-    // Protect from the case in which lowest > highest
-    lowest = std::min(lowest, highest);
-
-    int range = (highest - lowest) + 1;
-    int randomValue = std::rand();
-    int numTags = lowest +
-        static_cast<int>(std::floor(
-            static_cast<double>(range) * static_cast<double>(randomValue) /
-            (RAND_MAX + 1.0)));
-
-    QNTRACE("wiki2account", "Adding " << numTags << " tags to note");
-    for (int i = 0; i < numTags; ++i) {
-        note.addTagLocalUid(m_tags[i].localUid());
-    }
-}
-
-int WikiArticlesFetcher::nextNotebookIndex()
-{
-    ++m_notebookIndex;
-    if (m_notebookIndex >= m_notebooks.size()) {
-        m_notebookIndex = 0;
-    }
-
-    return m_notebookIndex;
-}
-
 void WikiArticlesFetcher::updateProgress()
 {
     QNDEBUG("wiki2account", "WikiArticlesFetcher::updateProgress");
@@ -19,9 +19,7 @@
 #ifndef QUENTIER_WIKI2ACCOUNT_WIKI_ARTICLES_FETCHER_H
 #define QUENTIER_WIKI2ACCOUNT_WIKI_ARTICLES_FETCHER_H
 
-#include <quentier/types/Note.h>
-#include <quentier/types/Notebook.h>
-#include <quentier/types/Tag.h>
+#include "NotebookAndTagsAssigner.h"
 
 #include <QHash>
 #include <QObject>
@@ -31,6 +29,7 @@
 namespace quentier {
 
 QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
+QT_FORWARD_DECLARE_CLASS(NetworkFetchService)
 QT_FORWARD_DECLARE_CLASS(WikiRandomArticleFetcher)
 
 class WikiArticlesFetcher : public QObject
@@ -69,21 +68,18 @@ private:
     void createConnections(LocalStorageManagerAsync & localStorageManager);
     void clear();
 
-    void addTagsToNote(Note & note);
-
-    int nextNotebookIndex();
     void updateProgress();
 
 private:
-    QList<Notebook> m_notebooks;
-    QList<Tag> m_tags;
-    quint32 m_minTagsPerNote;
+    NotebookAndTagsAssigner m_notebookAndTagsAssigner;
     quint32 m_numNotes;
 
-    int m_notebookIndex = 0;
-
     double m_currentProgress = 0.0;
 
+    // Shared by all WikiRandomArticleFetchers so that connections are reused
+    // and images common for multiple articles are downloaded only once
+    NetworkFetchService * m_pFetchService = nullptr;
+
     QHash<WikiRandomArticleFetcher *, double>
         m_wikiRandomArticleFetchersWithProgress;
     QSet<QUuid> m_addNoteRequestIds;
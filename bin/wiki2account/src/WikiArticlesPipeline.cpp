@@ -0,0 +1,638 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WikiArticlesPipeline.h"
+#include "WikiArticleConversionWorker.h"
+
+#include <lib/network/NetworkFetchService.h>
+#include <lib/utility/Log.h>
+#include <lib/wiki2note/WikiRandomArticleUrlFetcher.h>
+
+#include <quentier/local_storage/LocalStorageManagerAsync.h>
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <algorithm>
+#include <utility>
+
+// Max number of articles being converted to notes by a single worker at
+// the same time; more than one as conversion involves waiting for images
+#define PIPELINE_MAX_CONVERSIONS_PER_WORKER (2)
+
+// Wiki downloads are slow but steady so no timeout by default
+#define PIPELINE_NETWORK_TIMEOUT_MSEC (-1)
+
+namespace quentier {
+
+WikiArticlesPipeline::WikiArticlesPipeline(
+    QList<Notebook> notebooks, QList<Tag> tags, quint32 minTagsPerNote,
+    quint32 numNotes, PipelineOptions options,
+    LocalStorageManagerAsync & localStorageManager, QObject * parent) :
+    QObject(parent),
+    m_notebookAndTagsAssigner(
+        std::move(notebooks), std::move(tags), minTagsPerNote),
+    m_numNotes(numNotes), m_options(std::move(options))
+{
+    createConnections(localStorageManager);
+}
+
+WikiArticlesPipeline::~WikiArticlesPipeline()
+{
+    clear();
+}
+
+void WikiArticlesPipeline::start()
+{
+    QNDEBUG(
+        "wiki2account",
+        "WikiArticlesPipeline::start: num notes = "
+            << m_numNotes << ", num parallel fetches = "
+            << m_options.m_numParallelFetches << ", num conversion threads = "
+            << m_options.m_numConversionThreads << ", insert batch size = "
+            << m_options.m_insertBatchSize << ", articles dir = "
+            << m_options.m_articlesDirPath << ", offline = "
+            << (m_options.m_offline ? "true" : "false"));
+
+    if (Q_UNLIKELY(m_started)) {
+        QNWARNING("wiki2account", "WikiArticlesPipeline is already started");
+        return;
+    }
+
+    if (m_numNotes == 0) {
+        Q_EMIT finished();
+        return;
+    }
+
+    if (m_options.m_offline) {
+        ErrorString errorDescription;
+        if (!collectOfflineArticles(errorDescription)) {
+            Q_EMIT failure(errorDescription);
+            return;
+        }
+    }
+    else if (!m_pArticlesFetchService) {
+        m_pArticlesFetchService = new NetworkFetchService(
+            static_cast<int>(m_options.m_numParallelFetches), QString(),
+            PIPELINE_NETWORK_TIMEOUT_MSEC, this);
+
+        QObject::connect(
+            m_pArticlesFetchService, &NetworkFetchService::finished, this,
+            &WikiArticlesPipeline::onArticleFetched);
+    }
+
+    m_started = true;
+    startConversionWorkers();
+    advance();
+}
+
+void WikiArticlesPipeline::onRandomArticleUrlFetchFinished(
+    bool status, QUrl randomArticleUrl, ErrorString errorDescription)
+{
+    QNDEBUG(
+        "wiki2account",
+        "WikiArticlesPipeline::onRandomArticleUrlFetchFinished: "
+            << (status ? "success" : "failure")
+            << ", url = " << randomArticleUrl
+            << ", error description = " << errorDescription);
+
+    auto * pFetcher = qobject_cast<WikiRandomArticleUrlFetcher *>(sender());
+    if (!m_randomArticleUrlFetchers.remove(pFetcher)) {
+        QNWARNING(
+            "wiki2account",
+            "Received finished signal from unrecognized "
+                << "WikiRandomArticleUrlFetcher");
+        return;
+    }
+
+    pFetcher->disconnect(this);
+    pFetcher->deleteLater();
+
+    if (!status) {
+        finishWithError(errorDescription);
+        return;
+    }
+
+    QUuid requestId = m_pArticlesFetchService->fetch(randomArticleUrl);
+    m_articleUrlsByFetchRequestId[requestId] = randomArticleUrl;
+}
+
+void WikiArticlesPipeline::onArticleFetched(
+    QUuid requestId, bool status, QByteArray fetchedData,
+    ErrorString errorDescription)
+{
+    auto it = m_articleUrlsByFetchRequestId.find(requestId);
+    if (it == m_articleUrlsByFetchRequestId.end()) {
+        return;
+    }
+
+    QUrl url = it.value();
+    m_articleUrlsByFetchRequestId.erase(it);
+
+    QNDEBUG(
+        "wiki2account",
+        "WikiArticlesPipeline::onArticleFetched: "
+            << (status ? "success" : "failure") << ", url = " << url
+            << ", error description = " << errorDescription);
+
+    if (!status) {
+        finishWithError(errorDescription);
+        return;
+    }
+
+    ++m_numFetchedArticles;
+
+    if (!m_options.m_articlesDirPath.isEmpty()) {
+        saveArticle(url, fetchedData);
+    }
+
+    m_articlesPendingConversion.enqueue(fetchedData);
+
+    updateProgress();
+    advance();
+}
+
+void WikiArticlesPipeline::onArticleConverted(
+    QUuid requestId, bool status, ErrorString errorDescription, Note note)
+{
+    auto it = m_conversionWorkerIndexByRequestId.find(requestId);
+    if (it == m_conversionWorkerIndexByRequestId.end()) {
+        return;
+    }
+
+    QNDEBUG(
+        "wiki2account",
+        "WikiArticlesPipeline::onArticleConverted: "
+            << (status ? "success" : "failure") << ", request id = "
+            << requestId << ", error description = " << errorDescription);
+
+    --m_numConversionsByWorker[it.value()];
+    m_conversionWorkerIndexByRequestId.erase(it);
+
+    if (!status) {
+        finishWithError(errorDescription);
+        return;
+    }
+
+    ++m_numConvertedArticles;
+
+    m_notebookAndTagsAssigner.assign(note);
+    m_notesPendingAdding.enqueue(note);
+
+    updateProgress();
+    advance();
+}
+
+void WikiArticlesPipeline::onAddNoteComplete(Note note, QUuid requestId)
+{
+    auto it = m_addNoteRequestIds.find(requestId);
+    if (it == m_addNoteRequestIds.end()) {
+        return;
+    }
+
+    QNDEBUG(
+        "wiki2account",
+        "WikiArticlesPipeline::onAddNoteComplete: "
+            << "request id = " << requestId);
+
+    QNTRACE("wiki2account", note);
+
+    m_addNoteRequestIds.erase(it);
+    ++m_numAddedNotes;
+
+    updateProgress();
+
+    if (m_numAddedNotes == m_numNotes) {
+        clear();
+        Q_EMIT finished();
+        return;
+    }
+
+    advance();
+}
+
+void WikiArticlesPipeline::onAddNoteFailed(
+    Note note, ErrorString errorDescription, QUuid requestId)
+{
+    auto it = m_addNoteRequestIds.find(requestId);
+    if (it == m_addNoteRequestIds.end()) {
+        return;
+    }
+
+    QNWARNING(
+        "wiki2account",
+        "WikiArticlesPipeline::onAddNoteFailed: "
+            << "request id = " << requestId << ", error description: "
+            << errorDescription << ", note: " << note);
+
+    m_addNoteRequestIds.erase(it);
+    finishWithError(errorDescription);
+}
+
+void WikiArticlesPipeline::createConnections(
+    LocalStorageManagerAsync & localStorageManager)
+{
+    QObject::connect(
+        this, &WikiArticlesPipeline::addNote, &localStorageManager,
+        &LocalStorageManagerAsync::onAddNoteRequest);
+
+    QObject::connect(
+        &localStorageManager, &LocalStorageManagerAsync::addNoteComplete, this,
+        &WikiArticlesPipeline::onAddNoteComplete);
+
+    QObject::connect(
+        &localStorageManager, &LocalStorageManagerAsync::addNoteFailed, this,
+        &WikiArticlesPipeline::onAddNoteFailed);
+}
+
+bool WikiArticlesPipeline::collectOfflineArticles(
+    ErrorString & errorDescription)
+{
+    QDir articlesDir(m_options.m_articlesDirPath);
+
+    auto fileInfos = articlesDir.entryInfoList(
+        QStringList() << QStringLiteral("*.html"), QDir::Files, QDir::Name);
+
+    m_offlineArticleFilePaths.clear();
+    m_offlineArticleFilePaths.reserve(fileInfos.size());
+    for (const auto & fileInfo: qAsConst(fileInfos)) {
+        m_offlineArticleFilePaths << fileInfo.absoluteFilePath();
+    }
+
+    QNDEBUG(
+        "wiki2account",
+        "Found " << m_offlineArticleFilePaths.size()
+                 << " saved wiki articles in " << m_options.m_articlesDirPath);
+
+    if (m_offlineArticleFilePaths.isEmpty()) {
+        errorDescription.setBase(
+            QT_TR_NOOP("No saved wiki articles found in articles dir"));
+        errorDescription.details() = m_options.m_articlesDirPath;
+        QNWARNING("wiki2account", errorDescription);
+        return false;
+    }
+
+    m_nextOfflineArticleIndex = 0;
+    return true;
+}
+
+void WikiArticlesPipeline::startConversionWorkers()
+{
+    int numThreads = static_cast<int>(m_options.m_numConversionThreads);
+    if (numThreads == 0) {
+        numThreads = std::max(QThread::idealThreadCount(), 1);
+    }
+
+    QNDEBUG(
+        "wiki2account",
+        "WikiArticlesPipeline::startConversionWorkers: " << numThreads);
+
+    // Images are saved next to articles so that offline mode doesn't need
+    // network access at all: in offline mode images are only taken from
+    // there and articles with images which are not saved fail to convert
+    QString imagesCacheDirPath;
+    if (!m_options.m_articlesDirPath.isEmpty()) {
+        imagesCacheDirPath =
+            m_options.m_articlesDirPath + QStringLiteral("/images");
+    }
+    else {
+        imagesCacheDirPath =
+            QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+            QStringLiteral("/wiki2note");
+    }
+
+    m_conversionThreads.reserve(numThreads);
+    m_conversionWorkers.reserve(numThreads);
+    m_numConversionsByWorker.fill(0, numThreads);
+
+    for (int i = 0; i < numThreads; ++i) {
+        auto * pThread = new QThread;
+
+        pThread->setObjectName(
+            QStringLiteral("WikiArticleConversionThread-") +
+            QString::number(i));
+
+        auto * pWorker = new WikiArticleConversionWorker(
+            imagesCacheDirPath, PIPELINE_NETWORK_TIMEOUT_MSEC,
+            m_options.m_offline);
+
+        pWorker->moveToThread(pThread);
+
+        QObject::connect(
+            pThread, &QThread::finished, pWorker, &QObject::deleteLater);
+
+        QObject::connect(
+            pThread, &QThread::finished, pThread, &QThread::deleteLater);
+
+        QObject::connect(
+            pWorker, &WikiArticleConversionWorker::finished, this,
+            &WikiArticlesPipeline::onArticleConverted);
+
+        pThread->start();
+
+        m_conversionThreads << pThread;
+        m_conversionWorkers << pWorker;
+    }
+}
+
+void WikiArticlesPipeline::stopConversionWorkers()
+{
+    for (auto * pWorker: qAsConst(m_conversionWorkers)) {
+        pWorker->disconnect(this);
+    }
+
+    for (auto * pThread: qAsConst(m_conversionThreads)) {
+        pThread->quit();
+    }
+
+    m_conversionWorkers.clear();
+    m_conversionThreads.clear();
+    m_numConversionsByWorker.clear();
+    m_conversionWorkerIndexByRequestId.clear();
+}
+
+void WikiArticlesPipeline::clear()
+{
+    QNDEBUG("wiki2account", "WikiArticlesPipeline::clear");
+
+    m_started = false;
+
+    for (auto * pFetcher: qAsConst(m_randomArticleUrlFetchers)) {
+        pFetcher->disconnect(this);
+        pFetcher->deleteLater();
+    }
+
+    m_randomArticleUrlFetchers.clear();
+
+    if (m_pArticlesFetchService) {
+        for (auto it = m_articleUrlsByFetchRequestId.constBegin(),
+                  end = m_articleUrlsByFetchRequestId.constEnd();
+             it != end; ++it)
+        {
+            m_pArticlesFetchService->cancel(it.key());
+        }
+    }
+
+    m_articleUrlsByFetchRequestId.clear();
+    m_articlesPendingConversion.clear();
+
+    stopConversionWorkers();
+
+    m_notesPendingAdding.clear();
+    m_addNoteRequestIds.clear();
+}
+
+void WikiArticlesPipeline::finishWithError(ErrorString errorDescription)
+{
+    QNWARNING(
+        "wiki2account",
+        "WikiArticlesPipeline::finishWithError: " << errorDescription);
+
+    clear();
+    Q_EMIT failure(errorDescription);
+}
+
+void WikiArticlesPipeline::advance()
+{
+    // Stages are advanced from the last to the first one so that the work
+    // already in the pipeline is given preference over the new work
+    addNotes();
+    if (!m_started) {
+        return;
+    }
+
+    convertArticles();
+    if (!m_started) {
+        return;
+    }
+
+    fetchArticles();
+    if (!m_started) {
+        return;
+    }
+
+    // Reading articles in offline mode doesn't involve waiting so the read
+    // articles can be sent for conversion right away
+    convertArticles();
+}
+
+int WikiArticlesPipeline::numArticlesBeingFetched() const
+{
+    return m_randomArticleUrlFetchers.size() +
+        m_articleUrlsByFetchRequestId.size();
+}
+
+bool WikiArticlesPipeline::canFetchMoreArticles() const
+{
+    if (m_numRequestedArticles >= m_numNotes) {
+        return false;
+    }
+
+    if (numArticlesBeingFetched() >=
+        static_cast<int>(m_options.m_numParallelFetches))
+    {
+        return false;
+    }
+
+    // Don't let fetching run too far ahead of conversion and adding to
+    // the local storage
+    int maxArticlesPendingConversion = 2 * m_conversionWorkers.size() *
+        PIPELINE_MAX_CONVERSIONS_PER_WORKER;
+
+    if (m_articlesPendingConversion.size() >= maxArticlesPendingConversion) {
+        return false;
+    }
+
+    int maxNotesPendingAdding =
+        2 * static_cast<int>(m_options.m_insertBatchSize);
+
+    return m_notesPendingAdding.size() < maxNotesPendingAdding;
+}
+
+void WikiArticlesPipeline::fetchArticles()
+{
+    while (canFetchMoreArticles()) {
+        if (m_options.m_offline) {
+            ErrorString errorDescription;
+            if (!readOfflineArticle(errorDescription)) {
+                finishWithError(errorDescription);
+                return;
+            }
+
+            continue;
+        }
+
+        auto * pFetcher = new WikiRandomArticleUrlFetcher(
+            PIPELINE_NETWORK_TIMEOUT_MSEC, this);
+
+        QObject::connect(
+            pFetcher, &WikiRandomArticleUrlFetcher::finished, this,
+            &WikiArticlesPipeline::onRandomArticleUrlFetchFinished);
+
+        Q_UNUSED(m_randomArticleUrlFetchers.insert(pFetcher))
+        ++m_numRequestedArticles;
+
+        pFetcher->start();
+    }
+}
+
+bool WikiArticlesPipeline::readOfflineArticle(ErrorString & errorDescription)
+{
+    // Saved articles are reused in a loop if more notes are requested than
+    // there are saved articles
+    const QString & filePath =
+        m_offlineArticleFilePaths[m_nextOfflineArticleIndex];
+
+    ++m_nextOfflineArticleIndex;
+    if (m_nextOfflineArticleIndex >= m_offlineArticleFilePaths.size()) {
+        m_nextOfflineArticleIndex = 0;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to open saved wiki article for reading"));
+        errorDescription.details() = filePath;
+        return false;
+    }
+
+    m_articlesPendingConversion.enqueue(file.readAll());
+
+    ++m_numRequestedArticles;
+    ++m_numFetchedArticles;
+    return true;
+}
+
+void WikiArticlesPipeline::saveArticle(
+    const QUrl & url, const QByteArray & articleHtml)
+{
+    QString fileName = QString::fromUtf8(
+        QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Sha1)
+            .toHex());
+
+    QString filePath = m_options.m_articlesDirPath + QStringLiteral("/") +
+        fileName + QStringLiteral(".html");
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) ||
+        (file.write(articleHtml) != articleHtml.size()) || !file.commit())
+    {
+        // Not critical, the article just won't be available in offline mode
+        QNWARNING(
+            "wiki2account",
+            "Failed to save wiki article to " << filePath << ": "
+                                              << file.errorString());
+    }
+}
+
+void WikiArticlesPipeline::convertArticles()
+{
+    int maxNotesPendingAdding =
+        2 * static_cast<int>(m_options.m_insertBatchSize);
+
+    while (!m_articlesPendingConversion.isEmpty() &&
+           (m_notesPendingAdding.size() < maxNotesPendingAdding))
+    {
+        int workerIndex = -1;
+        int minNumConversions = PIPELINE_MAX_CONVERSIONS_PER_WORKER;
+        for (int i = 0, size = m_numConversionsByWorker.size(); i < size; ++i)
+        {
+            if (m_numConversionsByWorker[i] < minNumConversions) {
+                workerIndex = i;
+                minNumConversions = m_numConversionsByWorker[i];
+            }
+        }
+
+        if (workerIndex < 0) {
+            // All workers are busy
+            break;
+        }
+
+        QByteArray articleHtml = m_articlesPendingConversion.dequeue();
+        QUuid requestId = QUuid::createUuid();
+
+        m_conversionWorkerIndexByRequestId[requestId] = workerIndex;
+        ++m_numConversionsByWorker[workerIndex];
+
+        QNTRACE(
+            "wiki2account",
+            "Sending article to conversion worker " << workerIndex
+                                                    << ", request id = "
+                                                    << requestId);
+
+        QMetaObject::invokeMethod(
+            m_conversionWorkers[workerIndex], "convert", Qt::QueuedConnection,
+            Q_ARG(QUuid, requestId), Q_ARG(QByteArray, articleHtml));
+    }
+}
+
+void WikiArticlesPipeline::addNotes()
+{
+    const int batchSize = static_cast<int>(m_options.m_insertBatchSize);
+
+    while (!m_notesPendingAdding.isEmpty()) {
+        // Wait until the local storage has processed the previous batch
+        // for the most part
+        if (m_addNoteRequestIds.size() > batchSize / 2) {
+            return;
+        }
+
+        // Wait for the batch to fill up unless it's the last one
+        if ((m_notesPendingAdding.size() < batchSize) &&
+            (m_numConvertedArticles < m_numNotes))
+        {
+            return;
+        }
+
+        int numNotes = std::min(batchSize, m_notesPendingAdding.size());
+
+        QNDEBUG(
+            "wiki2account",
+            "Adding batch of " << numNotes << " notes to the local storage");
+
+        for (int i = 0; i < numNotes; ++i) {
+            Note note = m_notesPendingAdding.dequeue();
+            QUuid requestId = QUuid::createUuid();
+            Q_UNUSED(m_addNoteRequestIds.insert(requestId))
+            Q_EMIT addNote(note, requestId);
+        }
+    }
+}
+
+void WikiArticlesPipeline::updateProgress()
+{
+    // Fetching and conversion take 40% of the progress each, the remaining
+    // 20% is for adding notes to the local storage
+    double percentage = 0.4 * m_numFetchedArticles +
+        0.4 * m_numConvertedArticles + 0.2 * m_numAddedNotes;
+
+    percentage /= m_numNotes;
+
+    // Just in case ensure the progress doesn't exceed 1.0
+    percentage = std::min(percentage, 1.0);
+
+    QNTRACE("wiki2account", "Progress: " << percentage);
+    Q_EMIT progress(percentage);
+}
+
+} // namespace quentier
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_WIKI2ACCOUNT_WIKI_ARTICLES_PIPELINE_H
+#define QUENTIER_WIKI2ACCOUNT_WIKI_ARTICLES_PIPELINE_H
+
+#include "NotebookAndTagsAssigner.h"
+#include "ProcessPipelineOptions.h"
+
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+#include <QUuid>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(QThread)
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
+QT_FORWARD_DECLARE_CLASS(NetworkFetchService)
+QT_FORWARD_DECLARE_CLASS(WikiArticleConversionWorker)
+QT_FORWARD_DECLARE_CLASS(WikiRandomArticleUrlFetcher)
+
+/**
+ * @brief The WikiArticlesPipeline class creates notes from wiki articles
+ * in three overlapping stages: articles are downloaded (or read from
+ * the articles dir in offline mode) with bounded parallelism, converted
+ * to notes by workers living in separate threads and sent to the local
+ * storage in batches.
+ *
+ * Each stage only accepts as much work as the next one can keep up with
+ * so memory consumption stays bounded regardless of the number of notes
+ * to create.
+ */
+class WikiArticlesPipeline final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WikiArticlesPipeline(
+        QList<Notebook> notebooks, QList<Tag> tags, quint32 minTagsPerNote,
+        quint32 numNotes, PipelineOptions options,
+        LocalStorageManagerAsync & localStorageManager,
+        QObject * parent = nullptr);
+
+    virtual ~WikiArticlesPipeline() override;
+
+Q_SIGNALS:
+    void finished();
+    void failure(ErrorString errorDescription);
+    void progress(double percentage);
+
+    // private signals
+    void addNote(Note note, QUuid requestId);
+
+public Q_SLOTS:
+    void start();
+
+private Q_SLOTS:
+    void onRandomArticleUrlFetchFinished(
+        bool status, QUrl randomArticleUrl, ErrorString errorDescription);
+
+    void onArticleFetched(
+        QUuid requestId, bool status, QByteArray fetchedData,
+        ErrorString errorDescription);
+
+    void onArticleConverted(
+        QUuid requestId, bool status, ErrorString errorDescription,
+        Note note);
+
+    void onAddNoteComplete(Note note, QUuid requestId);
+
+    void onAddNoteFailed(
+        Note note, ErrorString errorDescription, QUuid requestId);
+
+private:
+    void createConnections(LocalStorageManagerAsync & localStorageManager);
+    bool collectOfflineArticles(ErrorString & errorDescription);
+    void startConversionWorkers();
+    void stopConversionWorkers();
+
+    void clear();
+    void finishWithError(ErrorString errorDescription);
+
+    // Moves work along all the stages of the pipeline as far as possible
+    void advance();
+
+    int numArticlesBeingFetched() const;
+    bool canFetchMoreArticles() const;
+
+    void fetchArticles();
+    bool readOfflineArticle(ErrorString & errorDescription);
+    void saveArticle(const QUrl & url, const QByteArray & articleHtml);
+
+    void convertArticles();
+    void addNotes();
+
+    void updateProgress();
+
+private:
+    Q_DISABLE_COPY(WikiArticlesPipeline)
+
+private:
+    NotebookAndTagsAssigner m_notebookAndTagsAssigner;
+    const quint32 m_numNotes;
+    const PipelineOptions m_options;
+
+    bool m_started = false;
+
+    // Number of notes which passed through each stage of the pipeline
+    quint32 m_numRequestedArticles = 0;
+    quint32 m_numFetchedArticles = 0;
+    quint32 m_numConvertedArticles = 0;
+    quint32 m_numAddedNotes = 0;
+
+    // Fetching stage
+    NetworkFetchService * m_pArticlesFetchService = nullptr;
+    QSet<WikiRandomArticleUrlFetcher *> m_randomArticleUrlFetchers;
+    QHash<QUuid, QUrl> m_articleUrlsByFetchRequestId;
+
+    QStringList m_offlineArticleFilePaths;
+    int m_nextOfflineArticleIndex = 0;
+
+    // Conversion stage
+    QQueue<QByteArray> m_articlesPendingConversion;
+
+    QVector<QThread *> m_conversionThreads;
+    QVector<WikiArticleConversionWorker *> m_conversionWorkers;
+    QVector<int> m_numConversionsByWorker;
+    QHash<QUuid, int> m_conversionWorkerIndexByRequestId;
+
+    // Adding to local storage stage
+    QQueue<Note> m_notesPendingAdding;
+    QSet<QUuid> m_addNoteRequestIds;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_WIKI2ACCOUNT_WIKI_ARTICLES_PIPELINE_H
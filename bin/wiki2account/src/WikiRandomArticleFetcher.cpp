@@ -19,6 +19,7 @@
 #include "WikiRandomArticleFetcher.h"
 
 #include <lib/network/NetworkReplyFetcher.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 
@@ -30,6 +31,14 @@ WikiRandomArticleFetcher::WikiRandomArticleFetcher(
     m_enmlConverter(), m_networkReplyFetcherTimeout(timeoutMsec)
 {}
 
+WikiRandomArticleFetcher::WikiRandomArticleFetcher(
+    NetworkFetchService & fetchService, const qint64 timeoutMsec,
+    QObject * parent) :
+    QObject(parent),
+    m_enmlConverter(), m_networkReplyFetcherTimeout(timeoutMsec),
+    m_pFetchService(&fetchService)
+{}
+
 WikiRandomArticleFetcher::~WikiRandomArticleFetcher()
 {
     clear();
@@ -165,8 +174,14 @@ void WikiRandomArticleFetcher::onWikiArticleDownloadFinished(
         return;
     }
 
-    m_pWikiArticleToNote =
-        new WikiArticleToNote(m_enmlConverter, m_networkReplyFetcherTimeout);
+    if (m_pFetchService) {
+        m_pWikiArticleToNote =
+            new WikiArticleToNote(m_enmlConverter, *m_pFetchService);
+    }
+    else {
+        m_pWikiArticleToNote = new WikiArticleToNote(
+            m_enmlConverter, m_networkReplyFetcherTimeout);
+    }
 
     QObject::connect(
         m_pWikiArticleToNote, &WikiArticleToNote::progress, this,
@@ -34,6 +34,16 @@ public:
         const qint64 timeoutMsec = NETWORK_REPLY_FETCHER_DEFAULT_TIMEOUT_MSEC,
         QObject * parent = nullptr);
 
+    /**
+     * Constructs WikiRandomArticleFetcher which would use the passed in
+     * NetworkFetchService to download article's images; the service must
+     * outlive the fetcher
+     */
+    explicit WikiRandomArticleFetcher(
+        NetworkFetchService & fetchService,
+        const qint64 timeoutMsec = NETWORK_REPLY_FETCHER_DEFAULT_TIMEOUT_MSEC,
+        QObject * parent = nullptr);
+
     virtual ~WikiRandomArticleFetcher() override;
 
     bool isStarted() const
@@ -86,6 +96,7 @@ private:
 private:
     ENMLConverter m_enmlConverter;
     const qint64 m_networkReplyFetcherTimeout;
+    NetworkFetchService * m_pFetchService = nullptr;
 
     bool m_started = false;
     bool m_finished = false;
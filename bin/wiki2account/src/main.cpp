@@ -23,6 +23,7 @@
 #include "PrepareTags.h"
 #include "ProcessNoteOptions.h"
 #include "ProcessNotebookOptions.h"
+#include "ProcessPipelineOptions.h"
 #include "ProcessStartupAccount.h"
 #include "ProcessTagOptions.h"
 
@@ -116,6 +117,12 @@ int main(int argc, char * argv[])
         return 1;
     }
 
+    PipelineOptions pipelineOptions;
+    res = processPipelineOptions(parseCmdResult.m_cmdOptions, pipelineOptions);
+    if (!res) {
+        return 1;
+    }
+
     auto * pLocalStorageManagerThread = new QThread;
 
     pLocalStorageManagerThread->setObjectName(
@@ -168,7 +175,8 @@ int main(int argc, char * argv[])
     std::cout << "Fetching notes..." << std::endl;
 
     res = fetchNotes(
-        notebooks, tags, minTagsPerNote, numNotes, *pLocalStorageManager);
+        notebooks, tags, minTagsPerNote, numNotes, pipelineOptions,
+        *pLocalStorageManager);
 
     if (!res) {
         pLocalStorageManagerThread->quit();
@@ -19,6 +19,7 @@
 #include "WikiArticleFetcher.h"
 
 #include <lib/network/NetworkReplyFetcher.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 
@@ -43,9 +44,10 @@
 namespace quentier {
 
 WikiArticleFetcher::WikiArticleFetcher(
-    ENMLConverter & enmlConverter, const QUrl & url, QObject * parent) :
+    ENMLConverter & enmlConverter, NetworkFetchService & fetchService,
+    const QUrl & url, QObject * parent) :
     QObject(parent),
-    m_enmlConverter(enmlConverter), m_url(url)
+    m_enmlConverter(enmlConverter), m_fetchService(fetchService), m_url(url)
 {}
 
 WikiArticleFetcher::~WikiArticleFetcher()
@@ -200,10 +202,8 @@ void WikiArticleFetcher::onWikiArticleDownloadFinished(
         return;
     }
 
-    const qint64 timeoutMsec = 180000;
-
     m_pWikiArticleToNote =
-        new WikiArticleToNote(m_enmlConverter, timeoutMsec, this);
+        new WikiArticleToNote(m_enmlConverter, m_fetchService, this);
 
     QObject::connect(
         m_pWikiArticleToNote, &WikiArticleToNote::progress, this,
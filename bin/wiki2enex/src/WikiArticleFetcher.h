@@ -30,8 +30,8 @@ class WikiArticleFetcher : public QObject
     Q_OBJECT
 public:
     explicit WikiArticleFetcher(
-        ENMLConverter & enmlConverter, const QUrl & url,
-        QObject * parent = nullptr);
+        ENMLConverter & enmlConverter, NetworkFetchService & fetchService,
+        const QUrl & url, QObject * parent = nullptr);
 
     virtual ~WikiArticleFetcher();
 
@@ -90,6 +90,7 @@ private:
 
 private:
     ENMLConverter & m_enmlConverter;
+    NetworkFetchService & m_fetchService;
     QUrl m_url;
 
     bool m_started = false;
@@ -18,11 +18,14 @@
 
 #include "WikiArticleFetcher.h"
 
+#include <lib/network/NetworkFetchService.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/EventLoopWithExitStatus.h>
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QStandardPaths>
 #include <QTime>
 #include <QTimer>
 #include <QUrl>
@@ -59,6 +62,14 @@ int main(int argc, char * argv[])
     ENMLConverter enmlConverter;
     ErrorString errorDescription;
 
+    const qint64 imageFetchTimeoutMsec = 180000;
+
+    NetworkFetchService fetchService(
+        NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS,
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+            QStringLiteral("/wiki2note"),
+        imageFetchTimeoutMsec);
+
     QVector<Note> notes(1);
     Note & note = notes.back();
 
@@ -68,7 +79,7 @@ int main(int argc, char * argv[])
         timer.setInterval(600000);
         timer.setSingleShot(true);
 
-        WikiArticleFetcher fetcher(enmlConverter, url);
+        WikiArticleFetcher fetcher(enmlConverter, fetchService, url);
         EventLoopWithExitStatus loop;
 
         QObject::connect(
@@ -19,6 +19,8 @@
 #include "AccountFilterModel.h"
 #include "AccountModel.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
 
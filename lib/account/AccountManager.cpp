@@ -23,6 +23,7 @@
 #include "ManageAccountsDialog.h"
 
 #include <lib/preferences/keys/Account.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
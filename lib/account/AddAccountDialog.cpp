@@ -19,6 +19,8 @@
 #include "AddAccountDialog.h"
 #include "ui_AddAccountDialog.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/types/ErrorString.h>
 #include <quentier/utility/StandardPaths.h>
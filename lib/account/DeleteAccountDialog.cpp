@@ -21,6 +21,8 @@
 #include "AccountModel.h"
 #include "ui_DeleteAccountDialog.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/types/ErrorString.h>
 #include <quentier/utility/FileSystem.h>
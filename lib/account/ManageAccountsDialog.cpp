@@ -25,6 +25,8 @@
 #include "AddAccountDialog.h"
 #include "DeleteAccountDialog.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/types/ErrorString.h>
 #include <quentier/utility/MessageBox.h>
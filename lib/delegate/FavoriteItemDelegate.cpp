@@ -22,6 +22,7 @@
 #include <lib/model/favorites/FavoritesModelItem.h>
 #include <lib/model/notebook/NotebookModel.h>
 #include <lib/model/tag/TagModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 
@@ -118,15 +118,17 @@ QSize LogViewerDelegate::sizeHint(
     if ((column == LogViewerModel::Column::SourceFileName) ||
         (column == LogViewerModel::Column::Component))
     {
-        const auto & field =
+        const quint32 fieldIndex =
             (column == LogViewerModel::Column::Component
-                 ? pDataEntry->m_component
-                 : pDataEntry->m_sourceFileName);
+                 ? pDataEntry->m_componentIndex
+                 : pDataEntry->m_sourceFileNameIndex);
 
         int numSubRows = 1;
 
         int originalWidth = static_cast<int>(std::floor(
-            fontMetricsWidth(fontMetrics, field) * (1.0 + m_margin) + 0.5));
+            internedStringWidth(*pModel, fieldIndex, option.font, fontMetrics) *
+                (1.0 + m_margin) +
+            0.5));
 
         int width = originalWidth;
         while (width > MAX_SOURCE_FILE_NAME_COLUMN_WIDTH) {
@@ -144,22 +146,22 @@ QSize LogViewerDelegate::sizeHint(
     }
 
     int numDisplayedLines = 0;
-    const int logEntrySize = pDataEntry->m_logEntry.size();
+    const QStringRef logEntry = pDataEntry->logEntry();
+    const int logEntrySize = logEntry.size();
     int maxLineSize = 0;
     int lineStartPos = -1;
-    QString logEntryLineBuffer;
+    QStringRef logEntryLineBuffer;
     while (true) {
         int lineEndPos = -1;
 
-        int index =
-            pDataEntry->m_logEntry.indexOf(m_newlineChar, (lineStartPos + 1));
+        int index = logEntry.indexOf(m_newlineChar, (lineStartPos + 1));
 
         if (index < 0) {
             lineEndPos =
                 (lineStartPos + LOG_VIEWER_MODEL_MAX_LOG_ENTRY_LINE_SIZE);
 
-            int previousWhitespaceIndex = pDataEntry->m_logEntry.lastIndexOf(
-                m_whitespaceChar, (lineEndPos - 1));
+            int previousWhitespaceIndex =
+                logEntry.lastIndexOf(m_whitespaceChar, (lineEndPos - 1));
 
             if (previousWhitespaceIndex > lineStartPos) {
                 lineEndPos = previousWhitespaceIndex;
@@ -174,8 +176,7 @@ QSize LogViewerDelegate::sizeHint(
                     lineStartPos + LOG_VIEWER_MODEL_MAX_LOG_ENTRY_LINE_SIZE;
 
                 int previousWhitespaceIndex =
-                    pDataEntry->m_logEntry.lastIndexOf(
-                        m_whitespaceChar, (lineEndPos - 1));
+                    logEntry.lastIndexOf(m_whitespaceChar, (lineEndPos - 1));
 
                 if (previousWhitespaceIndex > lineStartPos) {
                     lineEndPos = previousWhitespaceIndex;
@@ -189,9 +190,8 @@ QSize LogViewerDelegate::sizeHint(
 
         bool lastIteration = (lineEndPos == logEntrySize);
 
-        logEntryLineBuffer = pDataEntry->m_logEntry
-                                 .mid(lineStartPos, (lineEndPos - lineStartPos))
-                                 .trimmed();
+        logEntryLineBuffer =
+            logEntry.mid(lineStartPos, (lineEndPos - lineStartPos)).trimmed();
 
         int lineSize = logEntryLineBuffer.size();
         if (lineSize > maxLineSize) {
@@ -267,7 +267,7 @@ bool LogViewerDelegate::paintImpl(
     switch (column) {
     case LogViewerModel::Column::Timestamp:
     {
-        const QDateTime & timestamp = pDataEntry->m_timestamp;
+        const QDateTime timestamp = pDataEntry->timestamp();
         QDate date = timestamp.date();
         QTime time = timestamp.time();
 
@@ -286,8 +286,8 @@ bool LogViewerDelegate::paintImpl(
         pPainter->drawText(
             adjustedRect,
             (column == LogViewerModel::Column::Component
-                 ? pDataEntry->m_component
-                 : pDataEntry->m_sourceFileName),
+                 ? pModel->component(*pDataEntry)
+                 : pModel->sourceFileName(*pDataEntry)),
             textOption);
     } break;
     case LogViewerModel::Column::SourceFileLineNumber:
@@ -319,7 +319,8 @@ void LogViewerDelegate::paintLogEntry(
     const LogViewerModel::Data & dataEntry,
     const QFontMetrics & fontMetrics) const
 {
-    if (Q_UNLIKELY(dataEntry.m_logEntry.isEmpty())) {
+    const QStringRef logEntry = dataEntry.logEntry();
+    if (Q_UNLIKELY(logEntry.isEmpty())) {
         return;
     }
 
@@ -342,19 +343,18 @@ void LogViewerDelegate::paintLogEntry(
     textOption.setWrapMode(QTextOption::NoWrap);
 
     int lineStartPos = -1;
-    const int logEntrySize = dataEntry.m_logEntry.size();
+    const int logEntrySize = logEntry.size();
     while (true) {
         int lineEndPos = -1;
 
-        int index =
-            dataEntry.m_logEntry.indexOf(m_newlineChar, (lineStartPos + 1));
+        int index = logEntry.indexOf(m_newlineChar, (lineStartPos + 1));
 
         if (index < 0) {
             lineEndPos =
                 (lineStartPos + LOG_VIEWER_MODEL_MAX_LOG_ENTRY_LINE_SIZE);
 
-            int previousWhitespaceIndex = dataEntry.m_logEntry.lastIndexOf(
-                m_whitespaceChar, (lineEndPos - 1));
+            int previousWhitespaceIndex =
+                logEntry.lastIndexOf(m_whitespaceChar, (lineEndPos - 1));
 
             if (previousWhitespaceIndex > lineStartPos) {
                 lineEndPos = previousWhitespaceIndex;
@@ -368,8 +368,8 @@ void LogViewerDelegate::paintLogEntry(
                 lineEndPos =
                     lineStartPos + LOG_VIEWER_MODEL_MAX_LOG_ENTRY_LINE_SIZE;
 
-                int previousWhitespaceIndex = dataEntry.m_logEntry.lastIndexOf(
-                    m_whitespaceChar, (lineEndPos - 1));
+                int previousWhitespaceIndex =
+                    logEntry.lastIndexOf(m_whitespaceChar, (lineEndPos - 1));
 
                 if (previousWhitespaceIndex > lineStartPos) {
                     lineEndPos = previousWhitespaceIndex;
@@ -384,8 +384,9 @@ void LogViewerDelegate::paintLogEntry(
         bool lastIteration = (lineEndPos == logEntrySize);
 
         logEntryLineBuffer =
-            dataEntry.m_logEntry.mid(lineStartPos, (lineEndPos - lineStartPos))
-                .trimmed();
+            logEntry.mid(lineStartPos, (lineEndPos - lineStartPos))
+                .trimmed()
+                .toString();
 
         painter.drawText(currentRect, logEntryLineBuffer, textOption);
 
@@ -398,4 +399,32 @@ void LogViewerDelegate::paintLogEntry(
     }
 }
 
+int LogViewerDelegate::internedStringWidth(
+    const LogViewerModel & model, const quint32 stringIndex,
+    const QFont & font, const QFontMetrics & fontMetrics) const
+{
+    if ((m_pInternedStringWidthsModel.data() != &model) ||
+        (m_internedStringWidthsFont != font))
+    {
+        m_pInternedStringWidthsModel = &model;
+        m_internedStringWidthsFont = font;
+        m_internedStringWidths.clear();
+    }
+
+    const int index = static_cast<int>(stringIndex);
+    if (m_internedStringWidths.size() <= index) {
+        m_internedStringWidths.insert(
+            m_internedStringWidths.size(),
+            index + 1 - m_internedStringWidths.size(), -1);
+    }
+
+    int & width = m_internedStringWidths[index];
+    if (width < 0) {
+        width =
+            fontMetricsWidth(fontMetrics, model.internedString(stringIndex));
+    }
+
+    return width;
+}
+
 } // namespace quentier
@@ -21,7 +21,10 @@
 
 #include <lib/model/log_viewer/LogViewerModel.h>
 
+#include <QFont>
+#include <QPointer>
 #include <QStyledItemDelegate>
+#include <QVector>
 
 #define MAX_SOURCE_FILE_NAME_COLUMN_WIDTH (200)
 
@@ -57,6 +60,16 @@ private:
         const LogViewerModel::Data & dataEntry,
         const QFontMetrics & fontMetrics) const;
 
+    /**
+     * @return      Width of the interned string measured with the given font;
+     *              widths are measured only once per interned string and
+     *              font because sizeHint is called for each row of the model
+     *              on resizing columns to contents
+     */
+    int internedStringWidth(
+        const LogViewerModel & model, const quint32 stringIndex,
+        const QFont & font, const QFontMetrics & fontMetrics) const;
+
 private:
     double m_margin;
     QString m_widestLogLevelName;
@@ -65,6 +78,10 @@ private:
 
     QChar m_newlineChar;
     QChar m_whitespaceChar;
+
+    mutable QPointer<const LogViewerModel> m_pInternedStringWidthsModel;
+    mutable QFont m_internedStringWidthsFont;
+    mutable QVector<int> m_internedStringWidths;
 };
 
 } // namespace quentier
@@ -21,6 +21,7 @@
 
 #include <lib/model/note/NoteModel.h>
 #include <lib/preferences/defaults/Appearance.h>
+#include <lib/utility/Log.h>
 #include <lib/view/NoteListView.h>
 
 #include <quentier/logging/QuentierLogger.h>
@@ -19,6 +19,7 @@
 #include "NotebookItemDelegate.h"
 
 #include <lib/model/notebook/NotebookModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 
@@ -19,6 +19,7 @@
 #include "TagItemDelegate.h"
 
 #include <lib/model/tag/TagModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 
@@ -20,6 +20,7 @@
 #include "ui_AddOrEditNotebookDialog.h"
 
 #include <lib/preferences/keys/Files.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
@@ -20,6 +20,7 @@
 #include "ui_AddOrEditSavedSearchDialog.h"
 
 #include <lib/model/saved_search/SavedSearchModel.h>
+#include <lib/utility/Log.h>
 #include <quentier/local_storage/NoteSearchQuery.h>
 #include <quentier/logging/QuentierLogger.h>
 
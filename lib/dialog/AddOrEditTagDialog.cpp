@@ -21,6 +21,7 @@
 #include "ui_AddOrEditTagDialog.h"
 
 #include <lib/preferences/keys/Files.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
@@ -20,6 +20,7 @@
 #include "EditNoteDialog.h"
 
 #include <lib/model/notebook/NotebookModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 
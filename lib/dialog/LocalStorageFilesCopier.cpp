@@ -0,0 +1,204 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStorageFilesCopier.h"
+
+#include <lib/utility/FileCopy.h>
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/FileSystem.h>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cmath>
+
+#define LOCAL_STORAGE_DATABASE_FILE_NAME_FILTER "qn.storage.sqlite*"
+#define LOCAL_STORAGE_RESOURCES_DIR_NAME        "Resources"
+
+namespace quentier {
+
+LocalStorageFilesCopier::LocalStorageFilesCopier(
+    QString sourceDirPath, QString targetDirPath,
+    std::shared_ptr<QAtomicInt> pCancelled, QObject * parent) :
+    QObject(parent),
+    m_sourceDirPath(std::move(sourceDirPath)),
+    m_targetDirPath(std::move(targetDirPath)),
+    m_pCancelled(std::move(pCancelled))
+{}
+
+void LocalStorageFilesCopier::run()
+{
+    QNDEBUG(
+        "dialog",
+        "LocalStorageFilesCopier::run: from " << m_sourceDirPath << " to "
+                                              << m_targetDirPath);
+
+    ErrorString errorDescription;
+    if (!collectFilesToCopy(errorDescription)) {
+        QNWARNING("dialog", errorDescription);
+        Q_EMIT finished(false, false, errorDescription);
+        return;
+    }
+
+    // The resources dir is replaced entirely as the target might contain
+    // resource files which the source doesn't have
+    const QString targetResourcesDirPath = m_targetDirPath +
+        QStringLiteral("/") + QStringLiteral(LOCAL_STORAGE_RESOURCES_DIR_NAME);
+
+    if (QFileInfo::exists(targetResourcesDirPath) &&
+        !removeDir(targetResourcesDirPath))
+    {
+        errorDescription.setBase(
+            QT_TR_NOOP("can't remove the directory with resource files"));
+        errorDescription.details() =
+            QDir::toNativeSeparators(targetResourcesDirPath);
+        QNWARNING("dialog", errorDescription);
+        Q_EMIT finished(false, false, errorDescription);
+        return;
+    }
+
+    if (!copyFiles(errorDescription)) {
+        const bool cancelled = isCancelled();
+        if (cancelled) {
+            QNINFO("dialog", "Copying of local storage files was cancelled");
+        }
+        else {
+            QNWARNING("dialog", errorDescription);
+        }
+
+        Q_EMIT finished(false, cancelled, errorDescription);
+        return;
+    }
+
+    QNDEBUG("dialog", "Copied local storage files");
+    Q_EMIT finished(true, false, ErrorString());
+}
+
+bool LocalStorageFilesCopier::isCancelled() const
+{
+    return m_pCancelled && (m_pCancelled->loadAcquire() != 0);
+}
+
+bool LocalStorageFilesCopier::collectFilesToCopy(
+    ErrorString & errorDescription)
+{
+    m_filesToCopy.clear();
+    m_filesToCopyTotalSize = 0;
+
+    QDir sourceDir(m_sourceDirPath);
+
+    const QStringList databaseFileNameFilters = QStringList()
+        << QStringLiteral(LOCAL_STORAGE_DATABASE_FILE_NAME_FILTER);
+
+    const auto databaseFileInfos = sourceDir.entryInfoList(
+        databaseFileNameFilters, QDir::Files | QDir::Hidden);
+
+    for (const auto & fileInfo: qAsConst(databaseFileInfos)) {
+        m_filesToCopy << fileInfo.fileName();
+        m_filesToCopyTotalSize += fileInfo.size();
+    }
+
+    if (Q_UNLIKELY(m_filesToCopy.isEmpty())) {
+        errorDescription.setBase(
+            QT_TR_NOOP("found no local storage database file"));
+        errorDescription.details() = QDir::toNativeSeparators(m_sourceDirPath);
+        return false;
+    }
+
+    QDirIterator it(
+        m_sourceDirPath + QStringLiteral("/") +
+            QStringLiteral(LOCAL_STORAGE_RESOURCES_DIR_NAME),
+        QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+
+    while (it.hasNext()) {
+        Q_UNUSED(it.next())
+        m_filesToCopy << sourceDir.relativeFilePath(it.filePath());
+        m_filesToCopyTotalSize += it.fileInfo().size();
+    }
+
+    QNDEBUG(
+        "dialog",
+        "Collected " << m_filesToCopy.size() << " files to copy, total size = "
+                     << m_filesToCopyTotalSize);
+
+    return true;
+}
+
+bool LocalStorageFilesCopier::copyFiles(ErrorString & errorDescription)
+{
+    const double totalSize =
+        static_cast<double>(std::max<qint64>(m_filesToCopyTotalSize, 1));
+
+    qint64 bytesCopiedBefore = 0;
+    int lastReportedPercent = -1;
+
+    const auto reportProgress = [&](const qint64 bytesCopied) {
+        const double progress = std::min(
+            1.0,
+            static_cast<double>(bytesCopiedBefore + bytesCopied) / totalSize);
+
+        // Not flooding the GUI thread's event loop with progress updates
+        const int percent = static_cast<int>(std::floor(progress * 100.0));
+        if (percent != lastReportedPercent) {
+            lastReportedPercent = percent;
+            Q_EMIT this->progress(progress);
+        }
+
+        return !isCancelled();
+    };
+
+    for (const auto & relativeFilePath: qAsConst(m_filesToCopy)) {
+        if (isCancelled()) {
+            errorDescription.setBase(QT_TR_NOOP("file copying was cancelled"));
+            return false;
+        }
+
+        const QString sourceFilePath =
+            m_sourceDirPath + QStringLiteral("/") + relativeFilePath;
+
+        const QString targetFilePath =
+            m_targetDirPath + QStringLiteral("/") + relativeFilePath;
+
+        const QString targetFileDirPath =
+            QFileInfo(targetFilePath).absolutePath();
+
+        if (Q_UNLIKELY(!QDir().mkpath(targetFileDirPath))) {
+            errorDescription.setBase(QT_TR_NOOP("can't create directory"));
+            errorDescription.details() =
+                QDir::toNativeSeparators(targetFileDirPath);
+            return false;
+        }
+
+        if (!copyFile(
+                sourceFilePath, targetFilePath, reportProgress,
+                errorDescription))
+        {
+            return false;
+        }
+
+        bytesCopiedBefore += QFileInfo(sourceFilePath).size();
+    }
+
+    return true;
+}
+
+} // namespace quentier
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_DIALOG_LOCAL_STORAGE_FILES_COPIER_H
+#define QUENTIER_LIB_DIALOG_LOCAL_STORAGE_FILES_COPIER_H
+
+#include <quentier/types/ErrorString.h>
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QRunnable>
+#include <QStringList>
+
+#include <memory>
+
+namespace quentier {
+
+/**
+ * @brief The LocalStorageFilesCopier class copies local storage files, i.e.
+ * the database files and the resources dir, from one dir to another; it is
+ * meant to be run on a thread pool. The copying doesn't need the database
+ * connection so making or restoring a backup of even a large local storage
+ * doesn't block the GUI thread. Files are cloned using copy-on-write where
+ * the filesystem supports it.
+ */
+class LocalStorageFilesCopier final : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    /**
+     * @param sourceDirPath     Dir to copy local storage files from
+     * @param targetDirPath     Dir to copy local storage files to
+     * @param pCancelled        Flag set to non-zero from another thread to
+     *                          cancel the copying; if null, the copying
+     *                          cannot be cancelled
+     */
+    explicit LocalStorageFilesCopier(
+        QString sourceDirPath, QString targetDirPath,
+        std::shared_ptr<QAtomicInt> pCancelled, QObject * parent = nullptr);
+
+Q_SIGNALS:
+    void progress(double progress);
+
+    /**
+     * @param status                True if all files were copied, false
+     *                              otherwise
+     * @param cancelled             True if the copying was cancelled
+     * @param errorDescription      Description of the error if copying
+     *                              failed
+     */
+    void finished(bool status, bool cancelled, ErrorString errorDescription);
+
+private:
+    virtual void run() override;
+
+    bool isCancelled() const;
+
+    bool collectFilesToCopy(ErrorString & errorDescription);
+    bool copyFiles(ErrorString & errorDescription);
+
+private:
+    const QString m_sourceDirPath;
+    const QString m_targetDirPath;
+    const std::shared_ptr<QAtomicInt> m_pCancelled;
+
+    // Paths relative to source dir
+    QStringList m_filesToCopy;
+    qint64 m_filesToCopyTotalSize = 0;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_DIALOG_LOCAL_STORAGE_FILES_COPIER_H
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStoragePatchApplier.h"
+#include "LocalStorageFilesCopier.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/local_storage/ILocalStoragePatch.h>
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/FileSystem.h>
+#include <quentier/utility/StandardPaths.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <cmath>
+
+namespace quentier {
+
+LocalStoragePatchApplier::LocalStoragePatchApplier(
+    std::shared_ptr<ILocalStoragePatch> pPatch, const Account & account,
+    const bool backupLocalStorage, const bool removeBackupAfterUpgrade,
+    QObject * parent) :
+    QObject(parent),
+    m_pPatch(std::move(pPatch)),
+    m_localStorageDirPath(accountPersistentStoragePath(account)),
+    m_backupLocalStorage(backupLocalStorage),
+    m_removeBackupAfterUpgrade(removeBackupAfterUpgrade),
+    m_pCancelled(std::make_shared<QAtomicInt>(0))
+{
+    QObject::connect(
+        m_pPatch.get(), &ILocalStoragePatch::progress, this,
+        &LocalStoragePatchApplier::onPatchProgress);
+
+    QObject::connect(
+        this, &LocalStoragePatchApplier::succeeded, this,
+        &LocalStoragePatchApplier::deleteLater);
+
+    QObject::connect(
+        this, &LocalStoragePatchApplier::cancelled, this,
+        &LocalStoragePatchApplier::deleteLater);
+
+    QObject::connect(
+        this, &LocalStoragePatchApplier::failed, this,
+        &LocalStoragePatchApplier::deleteLater);
+}
+
+LocalStoragePatchApplier::~LocalStoragePatchApplier()
+{
+    QObject::disconnect(m_pPatch.get(), nullptr, this, nullptr);
+}
+
+void LocalStoragePatchApplier::start()
+{
+    QNDEBUG(
+        "dialog",
+        "LocalStoragePatchApplier::start: from version "
+            << m_pPatch->fromVersion() << " to version "
+            << m_pPatch->toVersion() << ", backup = "
+            << (m_backupLocalStorage ? "true" : "false"));
+
+    if (m_backupLocalStorage) {
+        backupLocalStorage();
+        return;
+    }
+
+    // Letting the dialog show the upgrade's initial state before the patch
+    // blocks the event loop
+    QTimer::singleShot(0, this, SLOT(applyPatch()));
+}
+
+void LocalStoragePatchApplier::cancel()
+{
+    QNDEBUG("dialog", "LocalStoragePatchApplier::cancel");
+    m_pCancelled->storeRelease(1);
+}
+
+void LocalStoragePatchApplier::backupLocalStorage()
+{
+    m_backupDirPath = m_localStorageDirPath +
+        QStringLiteral("/backup_upgrade_") +
+        QString::number(m_pPatch->fromVersion()) + QStringLiteral("_to_") +
+        QString::number(m_pPatch->toVersion()) + QStringLiteral("_") +
+        QDateTime::currentDateTime().toString(
+            QStringLiteral("yyyy-MM-ddThh-mm-ss"));
+
+    QNDEBUG(
+        "dialog",
+        "LocalStoragePatchApplier::backupLocalStorage: " << m_backupDirPath);
+
+    auto * pCopier = new LocalStorageFilesCopier(
+        m_localStorageDirPath, m_backupDirPath, m_pCancelled);
+
+    QObject::connect(
+        pCopier, &LocalStorageFilesCopier::progress, this,
+        &LocalStoragePatchApplier::backupProgress);
+
+    QObject::connect(
+        pCopier, &LocalStorageFilesCopier::finished, this,
+        &LocalStoragePatchApplier::onBackupFinished);
+
+    QThreadPool::globalInstance()->start(pCopier);
+}
+
+void LocalStoragePatchApplier::onBackupFinished(
+    bool status, bool cancelled, ErrorString errorDescription)
+{
+    QNDEBUG(
+        "dialog",
+        "LocalStoragePatchApplier::onBackupFinished: status = "
+            << (status ? "true" : "false") << ", cancelled = "
+            << (cancelled ? "true" : "false") << ", error: "
+            << errorDescription);
+
+    if (cancelled || (m_pCancelled->loadAcquire() != 0)) {
+        QNINFO("dialog", "Local storage upgrade was cancelled");
+        removeBackup();
+        Q_EMIT this->cancelled();
+        return;
+    }
+
+    if (!status) {
+        // Even a partially made backup needs to be removed
+        removeBackup();
+
+        ErrorString error(QT_TR_NOOP("Failed to backup local storage"));
+        error.appendBase(errorDescription.base());
+        error.appendBase(errorDescription.additionalBases());
+        error.details() = errorDescription.details();
+        QNWARNING("dialog", error);
+        Q_EMIT failed(error, ErrorString());
+        return;
+    }
+
+    // Letting the dialog update before the patch blocks the event loop
+    QTimer::singleShot(0, this, SLOT(applyPatch()));
+}
+
+void LocalStoragePatchApplier::applyPatch()
+{
+    QNDEBUG("dialog", "LocalStoragePatchApplier::applyPatch");
+
+    if (m_pCancelled->loadAcquire() != 0) {
+        QNINFO("dialog", "Local storage upgrade was cancelled");
+        removeBackup();
+        Q_EMIT cancelled();
+        return;
+    }
+
+    Q_EMIT patchStarted();
+
+    m_lastReportedPercent = -1;
+
+    ErrorString errorDescription;
+    if (m_pPatch->apply(errorDescription)) {
+        QNINFO(
+            "dialog",
+            "Successfully applied local storage patch from version "
+                << m_pPatch->fromVersion() << " to version "
+                << m_pPatch->toVersion());
+
+        if (m_removeBackupAfterUpgrade) {
+            removeBackup();
+        }
+
+        Q_EMIT succeeded();
+        return;
+    }
+
+    m_patchErrorDescription.setBase(
+        QT_TR_NOOP("Failed to upgrade local storage"));
+    m_patchErrorDescription.appendBase(errorDescription.base());
+    m_patchErrorDescription.appendBase(errorDescription.additionalBases());
+    m_patchErrorDescription.details() = errorDescription.details();
+    QNWARNING("dialog", m_patchErrorDescription);
+
+    if (m_backupDirPath.isEmpty()) {
+        Q_EMIT failed(m_patchErrorDescription, ErrorString());
+        return;
+    }
+
+    restoreLocalStorageFromBackup();
+}
+
+void LocalStoragePatchApplier::restoreLocalStorageFromBackup()
+{
+    QNDEBUG(
+        "dialog",
+        "LocalStoragePatchApplier::restoreLocalStorageFromBackup: "
+            << m_backupDirPath);
+
+    // The patch has returned so the database connection is idle while its
+    // files are replaced; restoring cannot be cancelled as it would leave
+    // local storage half restored
+    auto * pCopier = new LocalStorageFilesCopier(
+        m_backupDirPath, m_localStorageDirPath, nullptr);
+
+    QObject::connect(
+        pCopier, &LocalStorageFilesCopier::progress, this,
+        &LocalStoragePatchApplier::restoreBackupProgress);
+
+    QObject::connect(
+        pCopier, &LocalStorageFilesCopier::finished, this,
+        &LocalStoragePatchApplier::onRestoreFromBackupFinished);
+
+    QThreadPool::globalInstance()->start(pCopier);
+}
+
+void LocalStoragePatchApplier::onRestoreFromBackupFinished(
+    bool status, bool cancelled, ErrorString errorDescription)
+{
+    QNDEBUG(
+        "dialog",
+        "LocalStoragePatchApplier::onRestoreFromBackupFinished: status = "
+            << (status ? "true" : "false") << ", error: "
+            << errorDescription);
+
+    Q_UNUSED(cancelled)
+
+    ErrorString restoreErrorDescription;
+    if (status) {
+        if (m_removeBackupAfterUpgrade) {
+            removeBackup();
+        }
+    }
+    else {
+        restoreErrorDescription.setBase(
+            QT_TR_NOOP("Failed to restore local storage from backup"));
+        restoreErrorDescription.appendBase(errorDescription.base());
+        restoreErrorDescription.appendBase(
+            errorDescription.additionalBases());
+        restoreErrorDescription.details() = errorDescription.details();
+        QNWARNING("dialog", restoreErrorDescription);
+    }
+
+    Q_EMIT failed(m_patchErrorDescription, restoreErrorDescription);
+}
+
+void LocalStoragePatchApplier::onPatchProgress(double progress)
+{
+    const int percent = static_cast<int>(std::floor(progress * 100.0));
+    if (percent == m_lastReportedPercent) {
+        return;
+    }
+
+    m_lastReportedPercent = percent;
+    Q_EMIT patchProgress(progress);
+
+    // The patch blocks the event loop so the dialog is repainted from here;
+    // user input is not processed as nothing can be done until the patch
+    // finishes
+    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+}
+
+void LocalStoragePatchApplier::removeBackup()
+{
+    if (m_backupDirPath.isEmpty()) {
+        return;
+    }
+
+    QNDEBUG(
+        "dialog",
+        "LocalStoragePatchApplier::removeBackup: " << m_backupDirPath);
+
+    if (!removeDir(m_backupDirPath)) {
+        QNWARNING(
+            "dialog",
+            "Failed to remove local storage backup: " << m_backupDirPath);
+    }
+
+    m_backupDirPath.clear();
+}
+
+} // namespace quentier
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_DIALOG_LOCAL_STORAGE_PATCH_APPLIER_H
+#define QUENTIER_LIB_DIALOG_LOCAL_STORAGE_PATCH_APPLIER_H
+
+#include <quentier/types/Account.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QAtomicInt>
+#include <QObject>
+
+#include <memory>
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(ILocalStoragePatch)
+
+/**
+ * @brief The LocalStoragePatchApplier class applies a single local storage
+ * patch, optionally backing up local storage before that and restoring it
+ * from the backup if the patch fails.
+ *
+ * The patch works with the database connection of the local storage manager
+ * which can only be used from the thread in which it was opened, so the
+ * applier lives in that thread and applies the patch there. The backup and
+ * restoring from it are file level operations which don't need
+ * the connection: they are done by LocalStorageFilesCopier on the thread pool
+ * so the upgrade dialog stays responsive and the backup can be cancelled at
+ * any moment.
+ *
+ * The applier deletes itself after emitting one of its terminal signals:
+ * succeeded, cancelled or failed.
+ */
+class LocalStoragePatchApplier final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LocalStoragePatchApplier(
+        std::shared_ptr<ILocalStoragePatch> pPatch, const Account & account,
+        const bool backupLocalStorage, const bool removeBackupAfterUpgrade,
+        QObject * parent = nullptr);
+
+    virtual ~LocalStoragePatchApplier() override;
+
+    /**
+     * Starts the upgrade
+     */
+    void start();
+
+    /**
+     * Requests the cancellation of the upgrade. Only the backup stage can be
+     * cancelled: the backup made by the time of cancellation is removed and
+     * the patch is not applied. Once the patch starts being applied, it runs
+     * to the end.
+     */
+    void cancel();
+
+Q_SIGNALS:
+    void backupProgress(double progress);
+    void patchStarted();
+    void patchProgress(double progress);
+    void restoreBackupProgress(double progress);
+
+    void succeeded();
+    void cancelled();
+
+    /**
+     * @param errorDescription          Description of patch or backup error
+     * @param restoreErrorDescription   Description of error of restoring
+     *                                  local storage from the backup, empty
+     *                                  if restoring succeeded or was not
+     *                                  attempted
+     */
+    void failed(
+        ErrorString errorDescription, ErrorString restoreErrorDescription);
+
+private Q_SLOTS:
+    void applyPatch();
+
+    void onBackupFinished(
+        bool status, bool cancelled, ErrorString errorDescription);
+
+    void onRestoreFromBackupFinished(
+        bool status, bool cancelled, ErrorString errorDescription);
+
+    void onPatchProgress(double progress);
+
+private:
+    void backupLocalStorage();
+    void restoreLocalStorageFromBackup();
+    void removeBackup();
+
+private:
+    Q_DISABLE_COPY(LocalStoragePatchApplier)
+
+private:
+    const std::shared_ptr<ILocalStoragePatch> m_pPatch;
+    const QString m_localStorageDirPath;
+    const bool m_backupLocalStorage;
+    const bool m_removeBackupAfterUpgrade;
+
+    QString m_backupDirPath;
+
+    // Shared with the copier making the backup
+    const std::shared_ptr<QAtomicInt> m_pCancelled;
+
+    ErrorString m_patchErrorDescription;
+
+    // Patch progress updates are passed on only when the percentage changes
+    // to avoid processing events too often
+    int m_lastReportedPercent = -1;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_DIALOG_LOCAL_STORAGE_PATCH_APPLIER_H
@@ -17,10 +17,12 @@
  */
 
 #include "LocalStorageUpgradeDialog.h"
+#include "LocalStoragePatchApplier.h"
 #include "ui_LocalStorageUpgradeDialog.h"
 
 #include <lib/account/AccountFilterModel.h>
 #include <lib/account/AccountModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/local_storage/ILocalStoragePatch.h>
 #include <quentier/logging/QuentierLogger.h>
@@ -46,6 +48,7 @@ LocalStorageUpgradeDialog::LocalStorageUpgradeDialog(
     m_pUi->statusBar->hide();
     m_pUi->accountsTableView->verticalHeader()->hide();
     m_pUi->switchToAnotherAccountPushButton->setEnabled(false);
+    m_pUi->cancelPushButton->hide();
 
     m_pUi->backupLocalStorageLabel->hide();
     m_pUi->backupLocalStorageProgressBar->hide();
@@ -94,6 +97,10 @@ LocalStorageUpgradeDialog::LocalStorageUpgradeDialog(
 
 LocalStorageUpgradeDialog::~LocalStorageUpgradeDialog()
 {
+    if (!m_pPatchApplier.isNull()) {
+        m_pPatchApplier->cancel();
+    }
+
     delete m_pUi;
 }
 
@@ -172,130 +179,96 @@ void LocalStorageUpgradeDialog::onApplyPatchButtonPressed()
         return;
     }
 
+    if (Q_UNLIKELY(!m_pPatchApplier.isNull())) {
+        QNDEBUG("dialog", "The patch is already being applied");
+        return;
+    }
+
     lockControls();
+    m_pUi->upgradeProgressBar->setValue(0);
 
-    auto * pPatch = m_patches[m_currentPatchIndex].get();
+    const bool backupLocalStorage =
+        m_pUi->backupLocalStorageCheckBox->isChecked();
 
-    if (m_pUi->backupLocalStorageCheckBox->isChecked()) {
-        QObject::connect(
-            pPatch, &ILocalStoragePatch::backupProgress, this,
-            &LocalStorageUpgradeDialog::onBackupLocalStorageProgressUpdate);
+    const bool removeBackupAfterUpgrade =
+        m_pUi->removeLocalStorageBackupAfterUpgradeCheckBox->isChecked();
 
-        QObject::connect(
-            this, &LocalStorageUpgradeDialog::backupLocalStorageProgress,
-            m_pUi->backupLocalStorageProgressBar, &QProgressBar::setValue);
+    // The applier lives in the GUI thread as the patch uses the database
+    // connection opened in this thread
+    m_pPatchApplier = new LocalStoragePatchApplier(
+        m_patches[m_currentPatchIndex],
+        m_pAccountFilterModel->filteredAccounts()[0], backupLocalStorage,
+        removeBackupAfterUpgrade);
 
-        m_pUi->backupLocalStorageLabel->show();
-        m_pUi->backupLocalStorageProgressBar->show();
+    QObject::connect(
+        m_pPatchApplier.data(), &LocalStoragePatchApplier::backupProgress,
+        this, &LocalStorageUpgradeDialog::onBackupLocalStorageProgressUpdate);
 
-        ErrorString errorDescription;
-        bool res = pPatch->backupLocalStorage(errorDescription);
+    QObject::connect(
+        m_pPatchApplier.data(), &LocalStoragePatchApplier::patchStarted, this,
+        &LocalStorageUpgradeDialog::onPatchStarted);
 
-        QObject::disconnect(
-            pPatch, &ILocalStoragePatch::backupProgress, this,
-            &LocalStorageUpgradeDialog::onBackupLocalStorageProgressUpdate);
+    QObject::connect(
+        m_pPatchApplier.data(), &LocalStoragePatchApplier::patchProgress, this,
+        &LocalStorageUpgradeDialog::onApplyPatchProgressUpdate);
 
-        QObject::disconnect(
-            this, &LocalStorageUpgradeDialog::backupLocalStorageProgress,
-            m_pUi->backupLocalStorageProgressBar, &QProgressBar::setValue);
+    QObject::connect(
+        m_pPatchApplier.data(),
+        &LocalStoragePatchApplier::restoreBackupProgress, this,
+        &LocalStorageUpgradeDialog::
+            onRestoreLocalStorageFromBackupProgressUpdate);
 
-        m_pUi->backupLocalStorageLabel->hide();
-        m_pUi->backupLocalStorageProgressBar->setValue(0);
-        m_pUi->backupLocalStorageProgressBar->hide();
+    QObject::connect(
+        m_pPatchApplier.data(), &LocalStoragePatchApplier::succeeded, this,
+        &LocalStorageUpgradeDialog::onPatchSucceeded);
 
-        if (Q_UNLIKELY(!res)) {
-            setErrorToStatusBar(errorDescription);
-            unlockControls();
-            return;
-        }
-    }
+    QObject::connect(
+        m_pPatchApplier.data(), &LocalStoragePatchApplier::cancelled, this,
+        &LocalStorageUpgradeDialog::onPatchCancelled);
 
     QObject::connect(
-        pPatch, &ILocalStoragePatch::progress, this,
-        &LocalStorageUpgradeDialog::onApplyPatchProgressUpdate,
-        Qt::ConnectionType(Qt::DirectConnection | Qt::UniqueConnection));
+        m_pPatchApplier.data(), &LocalStoragePatchApplier::failed, this,
+        &LocalStorageUpgradeDialog::onPatchFailed);
 
-    ErrorString errorDescription;
-    bool res = pPatch->apply(errorDescription);
+    if (backupLocalStorage) {
+        m_pUi->backupLocalStorageProgressBar->setValue(0);
+        m_pUi->backupLocalStorageLabel->show();
+        m_pUi->backupLocalStorageProgressBar->show();
 
-    QObject::disconnect(
-        pPatch, &ILocalStoragePatch::progress, this,
-        &LocalStorageUpgradeDialog::onApplyPatchProgressUpdate);
+        // Only the backup can be cancelled
+        m_pUi->cancelPushButton->setEnabled(true);
+        m_pUi->cancelPushButton->show();
+    }
 
-    if (Q_UNLIKELY(!res)) {
-        ErrorString error(QT_TR_NOOP("Failed to upgrade local storage"));
-        error.appendBase(errorDescription.base());
-        error.appendBase(errorDescription.additionalBases());
-        error.details() = errorDescription.details();
-        QNWARNING("dialog", error);
-        setErrorToStatusBar(error);
-
-        if (m_pUi->backupLocalStorageCheckBox->isChecked()) {
-            QObject::connect(
-                pPatch, &ILocalStoragePatch::restoreBackupProgress, this,
-                &LocalStorageUpgradeDialog::
-                    onRestoreLocalStorageFromBackupProgressUpdate);
-
-            QObject::connect(
-                this,
-                &LocalStorageUpgradeDialog::
-                    restoreLocalStorageFromBackupProgress,
-                m_pUi->restoreLocalStorageFromBackupProgressBar,
-                &QProgressBar::setValue);
-
-            m_pUi->restoreLocalStorageFromBackupLabel->show();
-            m_pUi->restoreLocalStorageFromBackupProgressBar->show();
-
-            errorDescription.clear();
-            res = pPatch->restoreLocalStorageFromBackup(errorDescription);
-
-            QObject::disconnect(
-                pPatch, &ILocalStoragePatch::restoreBackupProgress, this,
-                &LocalStorageUpgradeDialog::
-                    onRestoreLocalStorageFromBackupProgressUpdate);
-
-            QObject::disconnect(
-                this,
-                &LocalStorageUpgradeDialog::
-                    restoreLocalStorageFromBackupProgress,
-                m_pUi->restoreLocalStorageFromBackupProgressBar,
-                &QProgressBar::setValue);
-
-            m_pUi->restoreLocalStorageFromBackupLabel->hide();
-            m_pUi->restoreLocalStorageFromBackupProgressBar->setValue(0);
-            m_pUi->restoreLocalStorageFromBackupProgressBar->hide();
-
-            if (Q_UNLIKELY(!res)) {
-                QString message = QStringLiteral(
-                    "<html><head/><body><p><span style=\" font-size:12pt; "
-                    "color:#ff0000;\">");
-
-                message += errorDescription.localizedString();
-                message += QStringLiteral("</span></p></body></html>");
-                m_pUi->restoreLocalStorageFromBackupLabel->setText(message);
-                m_pUi->restoreLocalStorageFromBackupLabel->show();
-            }
-
-            if (m_pUi->removeLocalStorageBackupAfterUpgradeCheckBox
-                    ->isChecked()) {
-                errorDescription.clear();
-                Q_UNUSED(!pPatch->removeLocalStorageBackup(errorDescription))
-            }
-        }
-
-        unlockControls();
+    m_pPatchApplier->start();
+}
+
+void LocalStorageUpgradeDialog::onCancelButtonPressed()
+{
+    QNDEBUG("dialog", "LocalStorageUpgradeDialog::onCancelButtonPressed");
+
+    if (Q_UNLIKELY(m_pPatchApplier.isNull())) {
+        QNDEBUG("dialog", "No patch is being applied");
         return;
     }
 
-    if (m_pUi->removeLocalStorageBackupAfterUpgradeCheckBox->isChecked()) {
-        errorDescription.clear();
-        Q_UNUSED(pPatch->removeLocalStorageBackup(errorDescription))
-    }
+    m_pUi->cancelPushButton->setEnabled(false);
+    m_pPatchApplier->cancel();
+}
 
-    QNINFO(
-        "dialog",
-        "Successfully applied local storage patch from version "
-            << pPatch->fromVersion() << " to version " << pPatch->toVersion());
+void LocalStorageUpgradeDialog::onPatchStarted()
+{
+    QNDEBUG("dialog", "LocalStorageUpgradeDialog::onPatchStarted");
+
+    m_pUi->cancelPushButton->hide();
+    hideBackupProgress();
+}
+
+void LocalStorageUpgradeDialog::onPatchSucceeded()
+{
+    QNDEBUG("dialog", "LocalStorageUpgradeDialog::onPatchSucceeded");
+
+    m_pPatchApplier.clear();
 
     ++m_currentPatchIndex;
 
@@ -307,7 +280,50 @@ void LocalStorageUpgradeDialog::onApplyPatchButtonPressed()
     }
 
     // Otherwise set patch descriptions
+    setPatchInfoLabel();
     setPatchDescriptions(*m_patches[m_currentPatchIndex].get());
+    m_pUi->upgradeProgressBar->setValue(0);
+    unlockControls();
+}
+
+void LocalStorageUpgradeDialog::onPatchCancelled()
+{
+    QNDEBUG("dialog", "LocalStorageUpgradeDialog::onPatchCancelled");
+
+    m_pPatchApplier.clear();
+
+    m_pUi->cancelPushButton->hide();
+    hideBackupProgress();
+    unlockControls();
+}
+
+void LocalStorageUpgradeDialog::onPatchFailed(
+    ErrorString errorDescription, ErrorString restoreErrorDescription)
+{
+    QNDEBUG(
+        "dialog",
+        "LocalStorageUpgradeDialog::onPatchFailed: " << errorDescription
+            << "; restore error: " << restoreErrorDescription);
+
+    m_pPatchApplier.clear();
+
+    m_pUi->cancelPushButton->hide();
+    hideBackupProgress();
+    hideRestoreFromBackupProgress();
+
+    setErrorToStatusBar(errorDescription);
+
+    if (!restoreErrorDescription.isEmpty()) {
+        QString message = QStringLiteral(
+            "<html><head/><body><p><span style=\" font-size:12pt; "
+            "color:#ff0000;\">");
+
+        message += restoreErrorDescription.localizedString();
+        message += QStringLiteral("</span></p></body></html>");
+        m_pUi->restoreLocalStorageFromBackupLabel->setText(message);
+        m_pUi->restoreLocalStorageFromBackupLabel->show();
+    }
+
     unlockControls();
 }
 
@@ -361,13 +377,7 @@ void LocalStorageUpgradeDialog::onBackupLocalStorageProgressUpdate(
     int scaledProgress =
         std::min(100, static_cast<int>(std::floor(progress * 100.0 + 0.5)));
 
-    Q_EMIT backupLocalStorageProgress(scaledProgress);
-
-    if (scaledProgress == 100) {
-        m_pUi->backupLocalStorageLabel->hide();
-        m_pUi->backupLocalStorageProgressBar->setValue(0);
-        m_pUi->backupLocalStorageProgressBar->hide();
-    }
+    m_pUi->backupLocalStorageProgressBar->setValue(scaledProgress);
 }
 
 void LocalStorageUpgradeDialog::onRestoreLocalStorageFromBackupProgressUpdate(
@@ -382,13 +392,12 @@ void LocalStorageUpgradeDialog::onRestoreLocalStorageFromBackupProgressUpdate(
     int scaledProgress =
         std::min(100, static_cast<int>(std::floor(progress * 100.0 + 0.5)));
 
-    Q_EMIT restoreLocalStorageFromBackupProgress(scaledProgress);
-
-    if (scaledProgress == 100) {
-        m_pUi->restoreLocalStorageFromBackupLabel->hide();
-        m_pUi->restoreLocalStorageFromBackupProgressBar->setValue(0);
-        m_pUi->restoreLocalStorageFromBackupProgressBar->hide();
+    if (m_pUi->restoreLocalStorageFromBackupProgressBar->isHidden()) {
+        m_pUi->restoreLocalStorageFromBackupLabel->show();
+        m_pUi->restoreLocalStorageFromBackupProgressBar->show();
     }
+
+    m_pUi->restoreLocalStorageFromBackupProgressBar->setValue(scaledProgress);
 }
 
 void LocalStorageUpgradeDialog::createConnections()
@@ -420,6 +429,10 @@ void LocalStorageUpgradeDialog::createConnections()
     QObject::connect(
         m_pUi->applyPatchPushButton, &QPushButton::pressed, this,
         &LocalStorageUpgradeDialog::onApplyPatchButtonPressed);
+
+    QObject::connect(
+        m_pUi->cancelPushButton, &QPushButton::pressed, this,
+        &LocalStorageUpgradeDialog::onCancelButtonPressed);
 }
 
 void LocalStorageUpgradeDialog::setPatchInfoLabel()
@@ -539,6 +552,20 @@ void LocalStorageUpgradeDialog::unlockControls()
     m_pUi->accountsTableView->setEnabled(true);
 }
 
+void LocalStorageUpgradeDialog::hideBackupProgress()
+{
+    m_pUi->backupLocalStorageLabel->hide();
+    m_pUi->backupLocalStorageProgressBar->setValue(0);
+    m_pUi->backupLocalStorageProgressBar->hide();
+}
+
+void LocalStorageUpgradeDialog::hideRestoreFromBackupProgress()
+{
+    m_pUi->restoreLocalStorageFromBackupLabel->hide();
+    m_pUi->restoreLocalStorageFromBackupProgressBar->setValue(0);
+    m_pUi->restoreLocalStorageFromBackupProgressBar->hide();
+}
+
 void LocalStorageUpgradeDialog::showAccountInfo(const Account & account)
 {
     QNDEBUG(
@@ -20,9 +20,11 @@
 #define QUENTIER_LIB_DIALOG_LOCAL_STORAGE_UPGRADE_DIALOG_H
 
 #include <quentier/types/Account.h>
+#include <quentier/types/ErrorString.h>
 
 #include <QDialog>
 #include <QFlags>
+#include <QPointer>
 #include <QSharedPointer>
 #include <QVector>
 
@@ -36,10 +38,10 @@ QT_FORWARD_DECLARE_CLASS(QItemSelection)
 
 namespace quentier {
 
-QT_FORWARD_DECLARE_CLASS(ErrorString)
 QT_FORWARD_DECLARE_CLASS(AccountModel)
 QT_FORWARD_DECLARE_CLASS(AccountFilterModel)
 QT_FORWARD_DECLARE_CLASS(ILocalStoragePatch)
+QT_FORWARD_DECLARE_CLASS(LocalStoragePatchApplier)
 
 class LocalStorageUpgradeDialog final : public QDialog
 {
@@ -72,15 +74,12 @@ Q_SIGNALS:
     void shouldCreateNewAccount();
     void shouldQuitApp();
 
-    // private signals:
-    void backupLocalStorageProgress(int progress);
-    void restoreLocalStorageFromBackupProgress(int progress);
-
 private Q_SLOTS:
     void onSwitchToAccountPushButtonPressed();
     void onCreateNewAccountButtonPressed();
     void onQuitAppButtonPressed();
     void onApplyPatchButtonPressed();
+    void onCancelButtonPressed();
 
     void onApplyPatchProgressUpdate(double progress);
 
@@ -90,6 +89,13 @@ private Q_SLOTS:
     void onBackupLocalStorageProgressUpdate(double progress);
     void onRestoreLocalStorageFromBackupProgressUpdate(double progress);
 
+    void onPatchStarted();
+    void onPatchSucceeded();
+    void onPatchCancelled();
+
+    void onPatchFailed(
+        ErrorString errorDescription, ErrorString restoreErrorDescription);
+
 private:
     void createConnections();
     void setPatchInfoLabel();
@@ -99,6 +105,9 @@ private:
     void lockControls();
     void unlockControls();
 
+    void hideBackupProgress();
+    void hideRestoreFromBackupProgress();
+
 private:
     void showAccountInfo(const Account & account);
     void showHideDialogPartsAccordingToOptions();
@@ -115,6 +124,8 @@ private:
 
     Options m_options;
 
+    QPointer<LocalStoragePatchApplier> m_pPatchApplier;
+
     int m_currentPatchIndex = 0;
     bool m_upgradeDone = false;
 };
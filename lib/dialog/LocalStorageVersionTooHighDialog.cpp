@@ -21,6 +21,7 @@
 
 #include <lib/account/AccountFilterModel.h>
 #include <lib/account/AccountModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/local_storage/LocalStorageManager.h>
 #include <quentier/logging/QuentierLogger.h>
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EnexChunkConverter.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/enml/ENMLConverter.h>
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Compat.h>
+
+#include <QCryptographicHash>
+
+#include <algorithm>
+
+namespace quentier {
+
+namespace {
+
+/**
+ * @return      The position right after the end tag of the note starting
+ *              at the given position or -1 if the note is not terminated
+ */
+int findNoteEnd(const QByteArray & enex, const int noteStart)
+{
+    const QByteArray noteEndTag = QByteArrayLiteral("</note>");
+    const QByteArray cdataStartTag = QByteArrayLiteral("<![CDATA[");
+    const QByteArray cdataEndTag = QByteArrayLiteral("]]>");
+
+    int searchPos = noteStart;
+    while (true) {
+        const int noteEnd = enex.indexOf(noteEndTag, searchPos);
+        if (noteEnd < 0) {
+            return -1;
+        }
+
+        const int cdataStart = enex.indexOf(cdataStartTag, searchPos);
+        if ((cdataStart < 0) || (cdataStart > noteEnd)) {
+            return noteEnd + noteEndTag.size();
+        }
+
+        const int cdataEnd =
+            enex.indexOf(cdataEndTag, cdataStart + cdataStartTag.size());
+
+        if (cdataEnd < 0) {
+            return -1;
+        }
+
+        searchPos = cdataEnd + cdataEndTag.size();
+    }
+}
+
+} // namespace
+
+bool splitEnexIntoChunks(
+    const QByteArray & enex, const int maxNotesPerChunk,
+    QVector<EnexChunk> & chunks, ErrorString & errorDescription,
+    const int startPos, const int firstNoteIndex)
+{
+    QNDEBUG(
+        "enex",
+        "splitEnexIntoChunks: ENEX size = "
+            << enex.size() << ", max notes per chunk = " << maxNotesPerChunk
+            << ", start pos = " << startPos
+            << ", first note index = " << firstNoteIndex);
+
+    chunks.clear();
+
+    const QByteArray noteStartTag = QByteArrayLiteral("<note>");
+    const QByteArray enexEndTag = QByteArrayLiteral("</en-export>");
+
+    const int firstNoteStart = enex.indexOf(noteStartTag);
+
+    const QByteArray header =
+        (firstNoteStart < 0 ? enex : enex.left(firstNoteStart));
+
+    if (Q_UNLIKELY(!header.contains("<en-export"))) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't import ENEX: the file doesn't look like ENEX"));
+        QNWARNING("enex", errorDescription);
+        return false;
+    }
+
+    if (firstNoteStart < 0) {
+        QNDEBUG("enex", "ENEX contains no notes");
+        return true;
+    }
+
+    EnexChunk chunk;
+    int noteIndex = firstNoteIndex;
+    int pos = std::max(firstNoteStart, startPos);
+    while (true) {
+        const int noteStart = enex.indexOf(noteStartTag, pos);
+        if (noteStart < 0) {
+            break;
+        }
+
+        const int noteEnd = findNoteEnd(enex, noteStart + noteStartTag.size());
+
+        if (Q_UNLIKELY(noteEnd < 0)) {
+            errorDescription.setBase(
+                QT_TR_NOOP("Can't import ENEX: the file is truncated"));
+            QNWARNING("enex", errorDescription);
+            return false;
+        }
+
+        if (chunk.m_noteRanges.isEmpty()) {
+            chunk.m_data = header;
+            chunk.m_firstNoteIndex = noteIndex;
+        }
+
+        chunk.m_noteRanges << qMakePair(
+            chunk.m_data.size(), noteEnd - noteStart);
+
+        chunk.m_noteEndFilePositions << noteEnd;
+
+        chunk.m_data.append(enex.constData() + noteStart, noteEnd - noteStart);
+        chunk.m_data.append('\n');
+
+        ++noteIndex;
+
+        if (chunk.m_noteRanges.size() == maxNotesPerChunk) {
+            chunk.m_data.append(enexEndTag);
+            chunks << chunk;
+            chunk = EnexChunk();
+        }
+
+        pos = noteEnd;
+    }
+
+    if (!chunk.m_noteRanges.isEmpty()) {
+        chunk.m_data.append(enexEndTag);
+        chunks << chunk;
+    }
+
+    QNDEBUG(
+        "enex",
+        "Split " << (noteIndex - firstNoteIndex) << " notes into "
+                 << chunks.size() << " chunks");
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+EnexChunkConverter::EnexChunkConverter(
+    const int chunkIndex, EnexChunk chunk, QObject * parent) :
+    QObject(parent),
+    QRunnable(), m_chunkIndex(chunkIndex), m_chunk(std::move(chunk))
+{}
+
+void EnexChunkConverter::run()
+{
+    QNDEBUG(
+        "enex",
+        "EnexChunkConverter::run: chunk index = "
+            << m_chunkIndex << ", first note index = "
+            << m_chunk.m_firstNoteIndex
+            << ", notes count = " << m_chunk.m_noteRanges.size());
+
+    QVector<Note> notes;
+    QHash<QString, QStringList> tagNamesByNoteLocalUid;
+    ErrorString errorDescription;
+
+    QVector<QByteArray> noteContentHashes;
+    noteContentHashes.reserve(m_chunk.m_noteRanges.size());
+    for (const auto & noteRange: qAsConst(m_chunk.m_noteRanges)) {
+        noteContentHashes << QCryptographicHash::hash(
+            QByteArray::fromRawData(
+                m_chunk.m_data.constData() + noteRange.first,
+                noteRange.second),
+            QCryptographicHash::Md5);
+    }
+
+    // Each converter has its own ENMLConverter as the latter is not meant to
+    // be used from multiple threads at once
+    ENMLConverter converter;
+
+    const bool res = converter.importEnex(
+        QString::fromUtf8(m_chunk.m_data), notes, tagNamesByNoteLocalUid,
+        errorDescription);
+
+    // The chunk's data is not needed anymore and can be large
+    m_chunk.m_data.clear();
+
+    if (!res) {
+        notes.clear();
+        tagNamesByNoteLocalUid.clear();
+        noteContentHashes.clear();
+
+        if (errorDescription.isEmpty()) {
+            errorDescription.setBase(
+                QT_TR_NOOP("Can't import ENEX: failed to convert notes"));
+        }
+    }
+    else if (Q_UNLIKELY(notes.size() != m_chunk.m_noteRanges.size())) {
+        QNWARNING(
+            "enex",
+            "Converted " << notes.size() << " notes from ENEX chunk "
+                         << m_chunkIndex << " while expected "
+                         << m_chunk.m_noteRanges.size());
+        noteContentHashes.clear();
+    }
+
+    Q_EMIT finished(
+        m_chunkIndex, notes, tagNamesByNoteLocalUid, noteContentHashes,
+        errorDescription);
+}
+
+} // namespace quentier
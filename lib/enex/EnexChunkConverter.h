@@ -0,0 +1,100 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_ENEX_ENEX_CHUNK_CONVERTER_H
+#define QUENTIER_LIB_ENEX_ENEX_CHUNK_CONVERTER_H
+
+#include <quentier/types/ErrorString.h>
+#include <quentier/types/Note.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QRunnable>
+#include <QStringList>
+#include <QVector>
+
+namespace quentier {
+
+/**
+ * @brief The EnexChunk struct is a standalone ENEX document containing a part
+ * of notes from the original ENEX file
+ */
+struct EnexChunk
+{
+    QByteArray m_data;
+
+    // Index of the chunk's first note among all notes of the original file
+    int m_firstNoteIndex = 0;
+
+    // Positions and sizes of notes within m_data
+    QVector<QPair<int, int>> m_noteRanges;
+
+    // Positions within the original file right after the end of each note
+    QVector<qint64> m_noteEndFilePositions;
+};
+
+/**
+ * Splits the contents of ENEX file into chunks containing at most
+ * maxNotesPerChunk notes each; each chunk gets the original file's header
+ * so that it can be converted independently of others. Notes' boundaries are
+ * found without parsing the XML, only CDATA sections are skipped as they
+ * might contain anything.
+ *
+ * @param startPos          Position within the file from which to look for
+ *                          notes, used to skip notes imported before
+ * @param firstNoteIndex    Index of the first note found after startPos
+ *                          among all notes of the file
+ */
+bool splitEnexIntoChunks(
+    const QByteArray & enex, const int maxNotesPerChunk,
+    QVector<EnexChunk> & chunks, ErrorString & errorDescription,
+    const int startPos = 0, const int firstNoteIndex = 0);
+
+/**
+ * @brief The EnexChunkConverter class converts ENEX chunk into notes; it is
+ * meant to be run on a thread pool so that many chunks are converted
+ * in parallel. Along with notes the converter computes hashes of notes' ENEX
+ * contents; if the number of converted notes doesn't match the number of notes
+ * in the chunk, no hashes are reported as they cannot be matched with notes.
+ */
+class EnexChunkConverter final : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    explicit EnexChunkConverter(
+        const int chunkIndex, EnexChunk chunk, QObject * parent = nullptr);
+
+Q_SIGNALS:
+    void finished(
+        int chunkIndex, QVector<Note> notes,
+        QHash<QString, QStringList> tagNamesByNoteLocalUid,
+        QVector<QByteArray> noteContentHashes, ErrorString errorDescription);
+
+private:
+    virtual void run() override;
+
+private:
+    int m_chunkIndex;
+    EnexChunk m_chunk;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_ENEX_ENEX_CHUNK_CONVERTER_H
@@ -21,6 +21,7 @@
 
 #include <lib/preferences/keys/Enex.h>
 #include <lib/preferences/keys/Files.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
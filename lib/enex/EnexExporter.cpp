@@ -19,6 +19,7 @@
 #include "EnexExporter.h"
 
 #include <lib/model/tag/TagModel.h>
+#include <lib/utility/Log.h>
 #include <lib/widget/NoteEditorTabsAndWindowsCoordinator.h>
 #include <lib/widget/NoteEditorWidget.h>
 
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "EnexImportCheckpoint.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#define ENEX_IMPORT_CHECKPOINT_MAGIC   (0x514E4943) // QNIC
+#define ENEX_IMPORT_CHECKPOINT_VERSION (3)
+
+namespace quentier {
+
+QString enexImportCheckpointFilePath(const QString & enexFilePath)
+{
+    return enexFilePath + QStringLiteral(".import-checkpoint");
+}
+
+QString enexImportCheckpointAccountIdentity(const Account & account)
+{
+    QString identity = QString::number(static_cast<int>(account.type()));
+    identity += QStringLiteral(":");
+    identity += QString::number(account.id());
+    identity += QStringLiteral(":");
+
+    // Local accounts don't have user ids so they are told apart by names
+    if (account.type() == Account::Type::Local) {
+        identity += account.name();
+    }
+    else {
+        identity += account.evernoteHost();
+    }
+
+    return identity;
+}
+
+QByteArray enexFileMarker(const QString & enexFilePath)
+{
+    QFileInfo enexFileInfo(enexFilePath);
+    if (!enexFileInfo.exists()) {
+        return {};
+    }
+
+    QByteArray marker = QByteArray::number(enexFileInfo.size());
+    marker += ':';
+
+    marker +=
+        QByteArray::number(enexFileInfo.lastModified().toMSecsSinceEpoch());
+
+    return marker;
+}
+
+bool readEnexImportCheckpoint(
+    const QString & enexFilePath, EnexImportCheckpoint & checkpoint)
+{
+    const QString filePath = enexImportCheckpointFilePath(enexFilePath);
+
+    QFile file(filePath);
+    if (!file.exists()) {
+        QNDEBUG("enex", "No ENEX import checkpoint at " << filePath);
+        return false;
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        QNWARNING(
+            "enex",
+            "Failed to open ENEX import checkpoint file "
+                << filePath << ": " << file.errorString());
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_5);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+
+    if ((stream.status() != QDataStream::Ok) ||
+        (magic != ENEX_IMPORT_CHECKPOINT_MAGIC) ||
+        (version != ENEX_IMPORT_CHECKPOINT_VERSION))
+    {
+        QNWARNING(
+            "enex",
+            "ENEX import checkpoint file " << filePath << " is corrupted or "
+                                           << "has unsupported version, "
+                                           << "ignoring it");
+        return false;
+    }
+
+    EnexImportCheckpoint result;
+    qint32 noteIndex = 0;
+
+    stream >> result.m_enexFileMarker >> result.m_accountIdentity >>
+        result.m_notebookLocalUid >> result.m_filePos >> noteIndex >>
+        result.m_storedNoteContentHashesByIndex >>
+        result.m_inFlightNotesByIndex;
+
+    if ((stream.status() != QDataStream::Ok) || (result.m_filePos < 0) ||
+        (noteIndex < 0))
+    {
+        QNWARNING(
+            "enex",
+            "ENEX import checkpoint file " << filePath
+                                           << " is corrupted, ignoring it");
+        return false;
+    }
+
+    if (result.m_enexFileMarker != enexFileMarker(enexFilePath)) {
+        QNINFO(
+            "enex",
+            "ENEX file " << enexFilePath << " was modified after the import "
+                         << "checkpoint was made, ignoring the checkpoint");
+        return false;
+    }
+
+    result.m_noteIndex = noteIndex;
+    checkpoint = std::move(result);
+    return true;
+}
+
+bool writeEnexImportCheckpoint(
+    const QString & enexFilePath, const EnexImportCheckpoint & checkpoint,
+    ErrorString & errorDescription)
+{
+    const QString filePath = enexImportCheckpointFilePath(enexFilePath);
+
+    QNDEBUG(
+        "enex",
+        "writeEnexImportCheckpoint: " << filePath
+                                      << ", file pos = " << checkpoint.m_filePos
+                                      << ", note index = "
+                                      << checkpoint.m_noteIndex);
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't open ENEX import checkpoint file for writing"));
+        errorDescription.details() = file.errorString();
+        QNWARNING("enex", errorDescription);
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_5);
+
+    stream << quint32(ENEX_IMPORT_CHECKPOINT_MAGIC)
+           << quint32(ENEX_IMPORT_CHECKPOINT_VERSION)
+           << checkpoint.m_enexFileMarker << checkpoint.m_accountIdentity
+           << checkpoint.m_notebookLocalUid << checkpoint.m_filePos
+           << qint32(checkpoint.m_noteIndex)
+           << checkpoint.m_storedNoteContentHashesByIndex
+           << checkpoint.m_inFlightNotesByIndex;
+
+    if ((stream.status() != QDataStream::Ok) || !file.commit()) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't write ENEX import checkpoint file"));
+        errorDescription.details() = file.errorString();
+        QNWARNING("enex", errorDescription);
+        return false;
+    }
+
+    return true;
+}
+
+void removeEnexImportCheckpoint(const QString & enexFilePath)
+{
+    const QString filePath = enexImportCheckpointFilePath(enexFilePath);
+
+    QFile file(filePath);
+    if (file.exists() && !file.remove()) {
+        QNWARNING(
+            "enex",
+            "Failed to remove ENEX import checkpoint file "
+                << filePath << ": " << file.errorString());
+    }
+}
+
+} // namespace quentier
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QUENTIER_LIB_ENEX_ENEX_IMPORT_CHECKPOINT_H
+#define QUENTIER_LIB_ENEX_ENEX_IMPORT_CHECKPOINT_H
+
+#include <quentier/types/Account.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QString>
+
+namespace quentier {
+
+/**
+ * @brief The EnexImportCheckpoint struct describes the progress of ENEX import
+ * which can be resumed later: all notes up to the checkpoint's position within
+ * ENEX file are known to be stored in the local storage.
+ */
+struct EnexImportCheckpoint
+{
+    // Identifies the version of ENEX file for which the checkpoint was made
+    QByteArray m_enexFileMarker;
+
+    // Identify the account and the notebook into which notes were imported
+    QString m_accountIdentity;
+    QString m_notebookLocalUid;
+
+    // Position within ENEX file right after the last note stored before
+    // the checkpoint
+    qint64 m_filePos = 0;
+
+    // Index of the first note after the checkpoint among all notes of ENEX
+    // file
+    int m_noteIndex = 0;
+
+    // Hashes of contents of notes located after the checkpoint's position
+    // but which are already stored in the local storage by indexes of these
+    // notes among all notes of ENEX file; ENEX file might contain several
+    // identical notes so hashes only guard against mismatches
+    QHash<int, QByteArray> m_storedNoteContentHashesByIndex;
+
+    // Local uids and hashes of contents of notes for which the requests to add
+    // them to the local storage were pending when the checkpoint was made by
+    // indexes of these notes among all notes of ENEX file; the local storage
+    // needs to be checked for these notes when the import is resumed
+    QHash<int, QPair<QString, QByteArray>> m_inFlightNotesByIndex;
+};
+
+/**
+ * @return      The string identifying the account within ENEX import
+ *              checkpoint
+ */
+QString enexImportCheckpointAccountIdentity(const Account & account);
+
+/**
+ * @return      The path to the file next to ENEX file in which the checkpoint
+ *              of ENEX file import is stored
+ */
+QString enexImportCheckpointFilePath(const QString & enexFilePath);
+
+/**
+ * @return      The marker which changes when ENEX file is modified or empty
+ *              byte array if there is no such file
+ */
+QByteArray enexFileMarker(const QString & enexFilePath);
+
+/**
+ * Reads the checkpoint of ENEX file import
+ *
+ * @return      True if the checkpoint was read and it corresponds to the
+ *              current version of ENEX file, false otherwise
+ */
+bool readEnexImportCheckpoint(
+    const QString & enexFilePath, EnexImportCheckpoint & checkpoint);
+
+/**
+ * Writes the checkpoint of ENEX file import, the previous checkpoint is
+ * replaced atomically
+ */
+bool writeEnexImportCheckpoint(
+    const QString & enexFilePath, const EnexImportCheckpoint & checkpoint,
+    ErrorString & errorDescription);
+
+void removeEnexImportCheckpoint(const QString & enexFilePath);
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_ENEX_ENEX_IMPORT_CHECKPOINT_H
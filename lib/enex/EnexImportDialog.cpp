@@ -22,6 +22,7 @@
 #include <lib/model/notebook/NotebookModel.h>
 #include <lib/preferences/keys/Enex.h>
 #include <lib/preferences/keys/Files.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/types/Notebook.h>
@@ -129,6 +130,11 @@ QString EnexImportDialog::notebookName(ErrorString * pErrorDescription) const
     return QString();
 }
 
+bool EnexImportDialog::resumableImport() const
+{
+    return m_pUi->resumableImportCheckBox->isChecked();
+}
+
 void EnexImportDialog::onBrowsePushButtonClicked()
 {
     QNDEBUG("enex", "EnexImportDialog::onBrowsePushButtonClicked");
@@ -312,6 +318,10 @@ void EnexImportDialog::accept()
     appSettings.setValue(
         preferences::keys::lastImportEnexNotebookName, notebookName);
 
+    appSettings.setValue(
+        preferences::keys::lastImportEnexResumable,
+        m_pUi->resumableImportCheckBox->isChecked());
+
     appSettings.endGroup();
 
     QDialog::accept();
@@ -386,8 +396,14 @@ void EnexImportDialog::fillDialogContents()
         appSettings.value(preferences::keys::lastImportEnexNotebookName)
             .toString();
 
+    const bool lastImportEnexResumable =
+        appSettings.value(preferences::keys::lastImportEnexResumable, false)
+            .toBool();
+
     appSettings.endGroup();
 
+    m_pUi->resumableImportCheckBox->setChecked(lastImportEnexResumable);
+
     if (lastImportEnexNotebookName.isEmpty()) {
         lastImportEnexNotebookName = tr("Imported notes");
     }
@@ -50,6 +50,13 @@ public:
     QString importEnexFilePath(ErrorString * pErrorDescription = nullptr) const;
     QString notebookName(ErrorString * pErrorDescription = nullptr) const;
 
+    /**
+     * @return      True if the progress of the import should be recorded
+     *              so that the interrupted import can be resumed, false
+     *              otherwise
+     */
+    bool resumableImport() const;
+
 private Q_SLOTS:
     void onBrowsePushButtonClicked();
     void onNotebookIndexChanged(int notebookNameIndex);
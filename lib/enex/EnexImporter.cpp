@@ -17,27 +17,36 @@
  */
 
 #include "EnexImporter.h"
+#include "EnexChunkConverter.h"
 
 #include <lib/model/notebook/NotebookModel.h>
 #include <lib/model/tag/TagModel.h>
+#include <lib/utility/Log.h>
 
-#include <quentier/enml/ENMLConverter.h>
 #include <quentier/local_storage/LocalStorageManagerAsync.h>
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
 
 #include <QFile>
+#include <QSet>
+#include <QThreadPool>
+
+#include <algorithm>
+
+#define ENEX_IMPORTER_NOTES_PER_CHUNK (50)
+#define ENEX_IMPORTER_NOTES_BATCH_SIZE (200)
 
 namespace quentier {
 
 EnexImporter::EnexImporter(
     const QString & enexFilePath, const QString & notebookName,
+    const Account & account,
     LocalStorageManagerAsync & localStorageManagerAsync, TagModel & tagModel,
     NotebookModel & notebookModel, QObject * parent) :
     QObject(parent),
     m_localStorageManagerAsync(localStorageManagerAsync), m_tagModel(tagModel),
-    m_notebookModel(notebookModel), m_enexFilePath(enexFilePath),
-    m_notebookName(notebookName)
+    m_notebookModel(notebookModel), m_account(account),
+    m_enexFilePath(enexFilePath), m_notebookName(notebookName)
 {
     if (!m_tagModel.allTagsListed()) {
         QObject::connect(
@@ -52,10 +61,32 @@ EnexImporter::EnexImporter(
     }
 }
 
+EnexImporter::~EnexImporter()
+{
+    // Record the progress if the import is interrupted, e.g. by app's exit
+    saveCheckpoint();
+}
+
 bool EnexImporter::isInProgress() const
 {
     QNDEBUG("enex", "EnexImporter::isInProgress");
 
+    if (m_pendingEnexChunksCount > 0) {
+        QNDEBUG(
+            "enex",
+            "There are " << m_pendingEnexChunksCount
+                         << " ENEX chunks pending conversion");
+        return true;
+    }
+
+    if (!m_findInFlightNoteRequestIds.isEmpty()) {
+        QNDEBUG(
+            "enex",
+            "There are " << m_findInFlightNoteRequestIds.size()
+                         << " pending requests to find note");
+        return true;
+    }
+
     if (!m_addTagRequestIdByTagNameBimap.empty()) {
         QNDEBUG(
             "enex",
@@ -72,11 +103,11 @@ bool EnexImporter::isInProgress() const
         return true;
     }
 
-    if (!m_tagModel.allTagsListed() && !m_notesPendingTagAddition.isEmpty()) {
+    if (m_pendingTagModelToCreateMissingTags) {
         QNDEBUG(
             "enex",
             "Not all tags were listed in the tag model yet + "
-                << "there are " << m_notesPendingTagAddition.size()
+                << "there are " << m_importedNotes.size()
                 << " notes pending tag addition");
         return true;
     }
@@ -94,6 +125,21 @@ bool EnexImporter::isInProgress() const
     return false;
 }
 
+bool EnexImporter::checkpointingEnabled() const
+{
+    return m_checkpointingEnabled;
+}
+
+void EnexImporter::setCheckpointingEnabled(const bool enabled)
+{
+    QNDEBUG(
+        "enex",
+        "EnexImporter::setCheckpointingEnabled: "
+            << (enabled ? "true" : "false"));
+
+    m_checkpointingEnabled = enabled;
+}
+
 void EnexImporter::start()
 {
     QNDEBUG("enex", "EnexImporter::start");
@@ -170,110 +216,119 @@ void EnexImporter::start()
         return;
     }
 
-    QString enex = QString::fromUtf8(enexFile.readAll());
-    enexFile.close();
-
-    QVector<Note> importedNotes;
-    ErrorString errorDescription;
-    ENMLConverter converter;
-
-    res = converter.importEnex(
-        enex, importedNotes, m_tagNamesByImportedNoteLocalUid,
-        errorDescription);
-
-    if (!res) {
-        Q_EMIT enexImportFailed(errorDescription);
-        return;
-    }
+    m_importTimer.start();
 
-    for (auto it = importedNotes.begin(); it != importedNotes.end();) {
-        auto & note = *it;
-        note.setNotebookLocalUid(m_notebookLocalUid);
+    if (m_checkpointingEnabled) {
+        EnexImportCheckpoint checkpoint;
+        if (readEnexImportCheckpoint(m_enexFilePath, checkpoint)) {
+            const QString accountIdentity =
+                enexImportCheckpointAccountIdentity(m_account);
 
-        auto tagIt = m_tagNamesByImportedNoteLocalUid.find(note.localUid());
-        if (tagIt == m_tagNamesByImportedNoteLocalUid.end()) {
-            QNTRACE(
-                "enex",
-                "Imported note doesn't have tag names assigned "
-                    << "to it, can add it to local storage right away: "
-                    << note);
+            if (checkpoint.m_accountIdentity != accountIdentity) {
+                QNINFO(
+                    "enex",
+                    "ENEX import checkpoint was made for import into "
+                        << "another account: " << checkpoint.m_accountIdentity
+                        << ", ignoring it");
+            }
+            else if (checkpoint.m_notebookLocalUid != m_notebookLocalUid) {
+                QNINFO(
+                    "enex",
+                    "ENEX import checkpoint was made for import into "
+                        << "another notebook: "
+                        << checkpoint.m_notebookLocalUid << ", ignoring it");
+            }
+            else if (Q_UNLIKELY(checkpoint.m_filePos > enexFile.size())) {
+                QNWARNING(
+                    "enex",
+                    "ENEX import checkpoint's position is beyond the end of "
+                        << "ENEX file, ignoring it");
+            }
+            else {
+                QNINFO(
+                    "enex",
+                    "Resuming the import of ENEX file "
+                        << m_enexFilePath << " from note "
+                        << checkpoint.m_noteIndex << " at position "
+                        << checkpoint.m_filePos);
 
-            addNoteToLocalStorage(note);
-            it = importedNotes.erase(it);
-            continue;
+                m_checkpoint = std::move(checkpoint);
+            }
         }
 
-        auto & tagNames = tagIt.value();
-        for (auto tagNameIt = tagNames.begin(); tagNameIt != tagNames.end();) {
-            const auto & tagName = *tagNameIt;
-            if (!tagName.isEmpty()) {
-                ++tagNameIt;
-                continue;
-            }
+        m_checkpoint.m_enexFileMarker = enexFileMarker(m_enexFilePath);
 
-            QNDEBUG(
-                "enex",
-                "Removing empty tag name from the list of tag "
-                    << "names for note " << note.localUid());
+        m_checkpoint.m_accountIdentity =
+            enexImportCheckpointAccountIdentity(m_account);
 
-            tagNameIt = tagNames.erase(tagNameIt);
-        }
+        m_checkpoint.m_notebookLocalUid = m_notebookLocalUid;
+    }
 
-        if (Q_UNLIKELY(tagNames.isEmpty())) {
-            QNDEBUG(
-                "enex",
-                "No tag names are left for note "
-                    << note.localUid()
-                    << " after the cleanup of empty tag names, can add the "
-                    << "note to local storage right away");
+    QByteArray enex = enexFile.readAll();
+    enexFile.close();
 
-            addNoteToLocalStorage(note);
-            it = importedNotes.erase(it);
-            continue;
-        }
+    QVector<EnexChunk> chunks;
+    ErrorString errorDescription;
 
-        ++it;
-    }
+    res = splitEnexIntoChunks(
+        enex, ENEX_IMPORTER_NOTES_PER_CHUNK, chunks, errorDescription,
+        static_cast<int>(m_checkpoint.m_filePos), m_checkpoint.m_noteIndex);
 
-    if (importedNotes.isEmpty()) {
-        QNDEBUG(
-            "enex",
-            "No notes had any tags, waiting for the completion "
-                << "of all add note requests");
+    if (!res) {
+        Q_EMIT enexImportFailed(errorDescription);
         return;
     }
 
-    m_notesPendingTagAddition = importedNotes;
-    QNDEBUG(
-        "enex",
-        "There are " << m_notesPendingTagAddition.size()
-                     << " notes which need tags assignment to them");
+    // The chunks contain copies of all the notes' data
+    enex.clear();
 
-    if (!m_tagModel.allTagsListed()) {
-        QNDEBUG(
-            "enex",
-            "Not all tags were listed from the tag model, waiting "
-                << "for it");
+    if (chunks.isEmpty()) {
+        QNDEBUG("enex", "No notes to import");
+
+        if (m_checkpointingEnabled) {
+            removeEnexImportCheckpoint(m_enexFilePath);
+        }
+
+        Q_EMIT enexImportedSuccessfully(m_enexFilePath);
         return;
     }
 
-    processNotesPendingTagAddition();
+    convertEnexChunks(std::move(chunks));
 }
 
 void EnexImporter::clear()
 {
     QNDEBUG("enex", "EnexImporter::clear");
 
+    saveCheckpoint();
+
     m_tagNamesByImportedNoteLocalUid.clear();
     m_addTagRequestIdByTagNameBimap.clear();
     m_expungedTagLocalUids.clear();
 
     m_addNotebookRequestId = QUuid();
 
-    m_notesPendingTagAddition.clear();
+    ++m_importGeneration;
+    m_pendingEnexChunksCount = 0;
+    m_notesByEnexChunk.clear();
+    m_notesCheckpointDataByEnexChunk.clear();
+
+    m_tagLocalUidsByLowerCaseName.clear();
+
+    m_importedNotes.clear();
+    m_nextNoteIndex = 0;
+    m_addedNotesCount = 0;
     m_addNoteRequestIds.clear();
 
+    m_findInFlightNoteRequestIds.clear();
+
+    m_checkpoint = EnexImportCheckpoint();
+    m_checkpointAddedNotesCount = 0;
+    m_checkpointNextNoteIndex = 0;
+    m_importedNotesCheckpointData.clear();
+
     m_pendingNotebookModelToStart = false;
+    m_pendingTagModelToCreateMissingTags = false;
 }
 
 void EnexImporter::onAddTagComplete(Tag tag, QUuid requestId)
@@ -288,6 +343,7 @@ void EnexImporter::onAddTagComplete(Tag tag, QUuid requestId)
         "EnexImporter::onAddTagComplete: request id = " << requestId
                                                         << ", tag: " << tag);
 
+    const QString lowerCaseTagName = it->second;
     Q_UNUSED(m_addTagRequestIdByTagNameBimap.right.erase(it))
 
     if (Q_UNLIKELY(!tag.hasName())) {
@@ -300,70 +356,23 @@ void EnexImporter::onAddTagComplete(Tag tag, QUuid requestId)
         return;
     }
 
-    QString tagName = tag.name().toLower();
-
-    for (auto noteIt = m_notesPendingTagAddition.begin();
-         noteIt != m_notesPendingTagAddition.end();)
-    {
-        auto & note = *noteIt;
-
-        auto tagIt = m_tagNamesByImportedNoteLocalUid.find(note.localUid());
-        if (Q_UNLIKELY(tagIt == m_tagNamesByImportedNoteLocalUid.end())) {
-            QNWARNING(
-                "enex",
-                "Detected note within the list of those "
-                    << "pending tags addition which doesn't "
-                    << "really wait for tags addition");
-
-            addNoteToLocalStorage(note);
-            noteIt = m_notesPendingTagAddition.erase(noteIt);
-            continue;
-        }
+    m_tagLocalUidsByLowerCaseName[lowerCaseTagName] = tag.localUid();
 
-        auto & tagNames = tagIt.value();
-        for (auto tagNameIt = tagNames.begin(); tagNameIt != tagNames.end();) {
-            const auto & currentTagName = *tagNameIt;
-            if (currentTagName.toLower() != tagName) {
-                ++tagNameIt;
-                continue;
-            }
-
-            QNDEBUG(
-                "enex",
-                "Found tag for note " << note.localUid()
-                                      << ": name = " << tagName
-                                      << ", local uid = " << tag.localUid());
-
-            if (!note.hasTagLocalUids() ||
-                !note.tagLocalUids().contains(tag.localUid())) {
-                note.addTagLocalUid(tag.localUid());
-            }
-
-            Q_UNUSED(tagNames.erase(tagNameIt))
-            break;
-        }
-
-        if (!tagNames.isEmpty()) {
-            QNTRACE(
-                "enex",
-                "Still pending " << tagNames.size() << " tag names for note "
-                                 << note.localUid());
-
-            ++noteIt;
-            continue;
-        }
-
-        QNDEBUG(
+    if (!m_addTagRequestIdByTagNameBimap.empty()) {
+        QNTRACE(
             "enex",
-            "Added the last missing tag for note "
-                << note.localUid()
-                << ", can send it to the local storage right away");
+            "Still pending " << m_addTagRequestIdByTagNameBimap.size()
+                             << " add tag requests");
+        return;
+    }
 
-        Q_UNUSED(m_tagNamesByImportedNoteLocalUid.erase(tagIt))
+    QNDEBUG(
+        "enex",
+        "Created all missing tags, elapsed " << m_importTimer.elapsed()
+                                             << " msec since the start");
 
-        addNoteToLocalStorage(note);
-        noteIt = m_notesPendingTagAddition.erase(noteIt);
-    }
+    assignTagsToNotes();
+    addNextNotesBatch();
 }
 
 void EnexImporter::onAddTagFailed(
@@ -413,9 +422,23 @@ void EnexImporter::onExpungeTagComplete(
         Q_UNUSED(m_expungedTagLocalUids.insert(expungedTagLocalUid))
     }
 
-    // Just in case check if some of our pending notes have either of these tag
-    // local uids, if so, remove them
-    for (auto & note: m_notesPendingTagAddition) {
+    // Tags with these local uids should not be assigned to notes anymore
+    for (auto it = m_tagLocalUidsByLowerCaseName.begin();
+         it != m_tagLocalUidsByLowerCaseName.end();)
+    {
+        if (expungedTagLocalUids.contains(it.value())) {
+            it = m_tagLocalUidsByLowerCaseName.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    // Just in case check if some of our notes not yet sent to local storage
+    // have either of these tag local uids, if so, remove them
+    for (int i = m_nextNoteIndex, size = m_importedNotes.size(); i < size; ++i)
+    {
+        auto & note = m_importedNotes[i];
         if (!note.hasTagLocalUids()) {
             continue;
         }
@@ -485,6 +508,12 @@ void EnexImporter::onExpungeNotebookComplete(Notebook notebook, QUuid requestId)
                        "expunged during the import"));
         QNWARNING("enex", error << ", notebook: " << notebook);
         clear();
+
+        // The notes imported so far were expunged along with the notebook
+        if (m_checkpointingEnabled) {
+            removeEnexImportCheckpoint(m_enexFilePath);
+        }
+
         Q_EMIT enexImportFailed(error);
     }
 }
@@ -502,6 +531,34 @@ void EnexImporter::onAddNoteComplete(Note note, QUuid requestId)
                                                          << ", note: " << note);
 
     Q_UNUSED(m_addNoteRequestIds.erase(it))
+    ++m_addedNotesCount;
+
+    // Local storage is kept busy with the rest of the current batch while
+    // the next one is being sent
+    if (m_addNoteRequestIds.size() >= ENEX_IMPORTER_NOTES_BATCH_SIZE / 2) {
+        return;
+    }
+
+    const qint64 elapsedMsec = std::max(m_addNotesTimer.elapsed(), qint64(1));
+
+    const double notesPerSecond =
+        static_cast<double>(m_addedNotesCount) * 1000.0 /
+        static_cast<double>(elapsedMsec);
+
+    if (m_nextNoteIndex < m_importedNotes.size()) {
+        QNDEBUG(
+            "enex",
+            "Added " << m_addedNotesCount << " notes out of "
+                     << m_importedNotes.size() << ", " << notesPerSecond
+                     << " notes per second");
+
+        Q_EMIT enexImportProgress(
+            m_addedNotesCount, m_importedNotes.size(), notesPerSecond);
+
+        addNextNotesBatch();
+        saveCheckpoint();
+        return;
+    }
 
     if (!m_addNoteRequestIds.isEmpty()) {
         QNDEBUG(
@@ -511,20 +568,60 @@ void EnexImporter::onAddNoteComplete(Note note, QUuid requestId)
         return;
     }
 
-    if (!m_notesPendingTagAddition.isEmpty()) {
-        QNDEBUG(
-            "enex",
-            "There are still " << m_notesPendingTagAddition.size()
-                               << " notes pending tag addition");
+    QNINFO(
+        "enex",
+        "Imported " << m_addedNotesCount << " notes from ENEX in "
+                    << m_importTimer.elapsed() << " msec, added notes to "
+                    << "local storage at " << notesPerSecond
+                    << " notes per second");
+
+    Q_EMIT enexImportProgress(
+        m_addedNotesCount, m_importedNotes.size(), notesPerSecond);
+
+    if (m_checkpointingEnabled) {
+        removeEnexImportCheckpoint(m_enexFilePath);
+    }
+
+    Q_EMIT enexImportedSuccessfully(m_enexFilePath);
+}
+
+void EnexImporter::onFindNoteComplete(
+    Note foundNote, LocalStorageManager::GetNoteOptions options,
+    QUuid requestId)
+{
+    if (!m_findInFlightNoteRequestIds.contains(requestId)) {
         return;
     }
 
     QNDEBUG(
         "enex",
-        "There are no pending add note requests and no notes "
-            << "pending tags addition => it looks like the import has "
-               "finished");
-    Q_EMIT enexImportedSuccessfully(m_enexFilePath);
+        "EnexImporter::onFindNoteComplete: request id = "
+            << requestId << ", note local uid = " << foundNote.localUid());
+
+    Q_UNUSED(options)
+
+    onInFlightNoteLookedUp(requestId, /* found = */ true);
+}
+
+void EnexImporter::onFindNoteFailed(
+    Note note, LocalStorageManager::GetNoteOptions options,
+    ErrorString errorDescription, QUuid requestId)
+{
+    if (!m_findInFlightNoteRequestIds.contains(requestId)) {
+        return;
+    }
+
+    // The note which was being added when the import was interrupted didn't
+    // make it to the local storage, it would be added again
+    QNDEBUG(
+        "enex",
+        "EnexImporter::onFindNoteFailed: request id = "
+            << requestId << ", note local uid = " << note.localUid()
+            << ", error description = " << errorDescription);
+
+    Q_UNUSED(options)
+
+    onInFlightNoteLookedUp(requestId, /* found = */ false);
 }
 
 void EnexImporter::onAddNoteFailed(
@@ -541,7 +638,10 @@ void EnexImporter::onAddNoteFailed(
             << requestId << ", error description = " << errorDescription
             << ", note: " << note);
 
-    Q_UNUSED(m_addNoteRequestIds.erase(it))
+    // The request is still considered pending while the checkpoint is made
+    // so that the failed note is not skipped when the import is resumed
+    saveCheckpoint();
+    clear();
 
     ErrorString error(QT_TR_NOOP("Can't import ENEX"));
     error.appendBase(errorDescription.base());
@@ -558,11 +658,12 @@ void EnexImporter::onAllTagsListed()
         &m_tagModel, &TagModel::notifyAllTagsListed, this,
         &EnexImporter::onAllTagsListed);
 
-    if (!isInProgress()) {
+    if (!m_pendingTagModelToCreateMissingTags) {
         return;
     }
 
-    processNotesPendingTagAddition();
+    m_pendingTagModelToCreateMissingTags = false;
+    createMissingTags();
 }
 
 void EnexImporter::onAllNotebooksListed()
@@ -638,6 +739,19 @@ void EnexImporter::connectToLocalStorage()
         &m_localStorageManagerAsync, &LocalStorageManagerAsync::addNoteFailed,
         this, &EnexImporter::onAddNoteFailed);
 
+    QObject::connect(
+        this, &EnexImporter::findNote, &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onFindNoteRequest);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::findNoteComplete, this,
+        &EnexImporter::onFindNoteComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::findNoteFailed,
+        this, &EnexImporter::onFindNoteFailed);
+
     m_connectedToLocalStorage = true;
 }
 
@@ -698,123 +812,522 @@ void EnexImporter::disconnectFromLocalStorage()
         &m_localStorageManagerAsync, &LocalStorageManagerAsync::addNoteFailed,
         this, &EnexImporter::onAddNoteFailed);
 
+    QObject::disconnect(
+        this, &EnexImporter::findNote, &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onFindNoteRequest);
+
+    QObject::disconnect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::findNoteComplete, this,
+        &EnexImporter::onFindNoteComplete);
+
+    QObject::disconnect(
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::findNoteFailed,
+        this, &EnexImporter::onFindNoteFailed);
+
     m_connectedToLocalStorage = false;
 }
 
-void EnexImporter::processNotesPendingTagAddition()
+void EnexImporter::convertEnexChunks(QVector<EnexChunk> chunks)
 {
-    QNDEBUG("enex", "EnexImporter::processNotesPendingTagAddition");
+    QNDEBUG(
+        "enex",
+        "EnexImporter::convertEnexChunks: " << chunks.size() << " chunks");
+
+    m_pendingEnexChunksCount = chunks.size();
+    m_notesByEnexChunk.resize(chunks.size());
+    m_notesCheckpointDataByEnexChunk.resize(chunks.size());
+
+    const quint64 importGeneration = m_importGeneration;
+
+    for (int i = 0, size = chunks.size(); i < size; ++i) {
+        const auto & chunk = chunks[i];
+        auto & notesCheckpointData = m_notesCheckpointDataByEnexChunk[i];
+        notesCheckpointData.resize(chunk.m_noteEndFilePositions.size());
+        for (int j = 0, count = notesCheckpointData.size(); j < count; ++j) {
+            auto & noteCheckpointData = notesCheckpointData[j];
+            noteCheckpointData.m_noteIndex = chunk.m_firstNoteIndex + j;
+            noteCheckpointData.m_endFilePos = chunk.m_noteEndFilePositions[j];
+        }
+
+        auto * pConverter = new EnexChunkConverter(i, std::move(chunks[i]));
 
-    for (auto it = m_notesPendingTagAddition.begin();
-         it != m_notesPendingTagAddition.end();)
+        QObject::connect(
+            pConverter, &EnexChunkConverter::finished, this,
+            [this, importGeneration](
+                int chunkIndex, QVector<Note> notes,
+                QHash<QString, QStringList> tagNamesByNoteLocalUid,
+                QVector<QByteArray> noteContentHashes,
+                ErrorString errorDescription) {
+                if (importGeneration != m_importGeneration) {
+                    return;
+                }
+
+                onEnexChunkConverted(
+                    chunkIndex, std::move(notes),
+                    std::move(tagNamesByNoteLocalUid),
+                    std::move(noteContentHashes), std::move(errorDescription));
+            },
+            Qt::QueuedConnection);
+
+        QThreadPool::globalInstance()->start(pConverter);
+    }
+}
+
+void EnexImporter::onEnexChunkConverted(
+    int chunkIndex, QVector<Note> notes,
+    QHash<QString, QStringList> tagNamesByNoteLocalUid,
+    QVector<QByteArray> noteContentHashes, ErrorString errorDescription)
+{
+    QNDEBUG(
+        "enex",
+        "EnexImporter::onEnexChunkConverted: chunk index = "
+            << chunkIndex << ", " << notes.size() << " notes");
+
+    if (!errorDescription.isEmpty()) {
+        QNWARNING(
+            "enex",
+            "Failed to convert ENEX chunk " << chunkIndex << ": "
+                                            << errorDescription);
+        clear();
+        Q_EMIT enexImportFailed(errorDescription);
+        return;
+    }
+
+    if (Q_UNLIKELY(
+            (chunkIndex < 0) || (chunkIndex >= m_notesByEnexChunk.size())))
     {
-        auto & note = *it;
+        QNWARNING("enex", "Unexpected ENEX chunk index: " << chunkIndex);
+        return;
+    }
 
-        auto tagIt = m_tagNamesByImportedNoteLocalUid.find(note.localUid());
-        if (Q_UNLIKELY(tagIt == m_tagNamesByImportedNoteLocalUid.end())) {
-            QNWARNING(
-                "enex",
-                "Detected note within the list of those pending "
-                    << "tags addition which doesn't really wait for tags "
-                       "addition");
-            addNoteToLocalStorage(note);
-            it = m_notesPendingTagAddition.erase(it);
-            continue;
+    auto & notesCheckpointData = m_notesCheckpointDataByEnexChunk[chunkIndex];
+    if (noteContentHashes.size() == notesCheckpointData.size()) {
+        for (int i = 0, size = noteContentHashes.size(); i < size; ++i) {
+            notesCheckpointData[i].m_contentHash = noteContentHashes[i];
+        }
+    }
+    else {
+        // The notes cannot be matched with their positions in ENEX file
+        notesCheckpointData.clear();
+    }
+
+    m_notesByEnexChunk[chunkIndex] = std::move(notes);
+
+    for (auto it = tagNamesByNoteLocalUid.constBegin(),
+              end = tagNamesByNoteLocalUid.constEnd();
+         it != end; ++it)
+    {
+        m_tagNamesByImportedNoteLocalUid[it.key()] = it.value();
+    }
+
+    --m_pendingEnexChunksCount;
+    if (m_pendingEnexChunksCount > 0) {
+        QNTRACE(
+            "enex",
+            "Still pending " << m_pendingEnexChunksCount
+                             << " ENEX chunks conversion");
+        return;
+    }
+
+    if (!m_checkpoint.m_inFlightNotesByIndex.isEmpty()) {
+        findInFlightNotes();
+        return;
+    }
+
+    collectImportedNotes();
+}
+
+void EnexImporter::findInFlightNotes()
+{
+    QNDEBUG(
+        "enex",
+        "EnexImporter::findInFlightNotes: "
+            << m_checkpoint.m_inFlightNotesByIndex.size() << " notes");
+
+    connectToLocalStorage();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    const LocalStorageManager::GetNoteOptions options;
+#else
+    const LocalStorageManager::GetNoteOptions options(0);
+#endif
+
+    for (auto it = m_checkpoint.m_inFlightNotesByIndex.constBegin(),
+              end = m_checkpoint.m_inFlightNotesByIndex.constEnd();
+         it != end; ++it)
+    {
+        Note note;
+        note.setLocalUid(it.value().first);
+
+        QUuid requestId = QUuid::createUuid();
+        m_findInFlightNoteRequestIds[requestId] = it.key();
+
+        QNTRACE(
+            "enex",
+            "Emitting the request to find note in local storage: "
+                << "request id = " << requestId
+                << ", note local uid = " << note.localUid());
+
+        Q_EMIT findNote(note, options, requestId);
+    }
+}
+
+void EnexImporter::onInFlightNoteLookedUp(
+    const QUuid & requestId, const bool found)
+{
+    auto it = m_findInFlightNoteRequestIds.find(requestId);
+    if (it == m_findInFlightNoteRequestIds.end()) {
+        return;
+    }
+
+    const int noteIndex = it.value();
+    Q_UNUSED(m_findInFlightNoteRequestIds.erase(it))
+
+    if (found) {
+        const auto noteIt =
+            m_checkpoint.m_inFlightNotesByIndex.constFind(noteIndex);
+
+        if (noteIt != m_checkpoint.m_inFlightNotesByIndex.constEnd()) {
+            m_checkpoint.m_storedNoteContentHashesByIndex[noteIndex] =
+                noteIt.value().second;
+        }
+    }
+
+    if (!m_findInFlightNoteRequestIds.isEmpty()) {
+        return;
+    }
+
+    QNDEBUG(
+        "enex",
+        "Looked up all notes which were being added when the import was "
+            << "interrupted");
+
+    m_checkpoint.m_inFlightNotesByIndex.clear();
+    collectImportedNotes();
+}
+
+void EnexImporter::collectImportedNotes()
+{
+    QNDEBUG("enex", "EnexImporter::collectImportedNotes");
+
+    // Notes are added to local storage in the same order as they are
+    // in ENEX file
+    int notesCount = 0;
+    bool canMakeCheckpoints = m_checkpointingEnabled;
+    for (int i = 0, size = m_notesByEnexChunk.size(); i < size; ++i) {
+        const int chunkNotesCount = m_notesByEnexChunk[i].size();
+        notesCount += chunkNotesCount;
+
+        if (m_notesCheckpointDataByEnexChunk[i].size() != chunkNotesCount) {
+            canMakeCheckpoints = false;
+        }
+    }
+
+    if (Q_UNLIKELY(m_checkpointingEnabled && !canMakeCheckpoints)) {
+        QNWARNING(
+            "enex",
+            "Some notes could not be matched with their positions in ENEX "
+                << "file, won't make checkpoints during the import");
+    }
+
+    const auto & storedNoteContentHashesByIndex =
+        m_checkpoint.m_storedNoteContentHashesByIndex;
+
+    int skippedNotesCount = 0;
+
+    m_importedNotes.reserve(notesCount);
+    if (canMakeCheckpoints) {
+        m_importedNotesCheckpointData.reserve(notesCount);
+    }
+
+    for (int i = 0, size = m_notesByEnexChunk.size(); i < size; ++i) {
+        auto & chunkNotes = m_notesByEnexChunk[i];
+        const auto & notesCheckpointData = m_notesCheckpointDataByEnexChunk[i];
+
+        for (int j = 0, count = chunkNotes.size(); j < count; ++j) {
+            auto & note = chunkNotes[j];
+
+            if (canMakeCheckpoints) {
+                const auto & noteCheckpointData = notesCheckpointData[j];
+
+                const auto storedIt = storedNoteContentHashesByIndex.constFind(
+                    noteCheckpointData.m_noteIndex);
+
+                if ((storedIt != storedNoteContentHashesByIndex.constEnd()) &&
+                    (storedIt.value() == noteCheckpointData.m_contentHash))
+                {
+                    QNDEBUG(
+                        "enex",
+                        "Skipping note " << noteCheckpointData.m_noteIndex
+                                         << " which was already imported");
+
+                    Q_UNUSED(m_tagNamesByImportedNoteLocalUid.remove(
+                        note.localUid()))
+
+                    ++skippedNotesCount;
+                    continue;
+                }
+
+                m_importedNotesCheckpointData << noteCheckpointData;
+            }
+
+            note.setNotebookLocalUid(m_notebookLocalUid);
+            m_importedNotes << note;
         }
+    }
+
+    m_notesByEnexChunk.clear();
+    m_notesCheckpointDataByEnexChunk.clear();
+
+    QNDEBUG(
+        "enex",
+        "Converted " << m_importedNotes.size() << " notes from ENEX in "
+                     << m_importTimer.elapsed() << " msec, skipped "
+                     << skippedNotesCount << " already imported notes");
+
+    if (Q_UNLIKELY(m_importedNotes.isEmpty())) {
+        QNDEBUG("enex", "No notes to import");
+
+        if (m_checkpointingEnabled) {
+            removeEnexImportCheckpoint(m_enexFilePath);
+        }
+
+        Q_EMIT enexImportedSuccessfully(m_enexFilePath);
+        return;
+    }
+
+    if (!m_tagModel.allTagsListed()) {
+        QNDEBUG(
+            "enex",
+            "Not all tags were listed from the tag model, waiting "
+                << "for it");
+        m_pendingTagModelToCreateMissingTags = true;
+        return;
+    }
+
+    createMissingTags();
+}
+
+void EnexImporter::createMissingTags()
+{
+    QNDEBUG("enex", "EnexImporter::createMissingTags");
 
-        auto & tagNames = tagIt.value();
-        QStringList nonexistentTagNames;
-        nonexistentTagNames.reserve(tagNames.size());
+    for (auto it = m_tagNamesByImportedNoteLocalUid.constBegin(),
+              end = m_tagNamesByImportedNoteLocalUid.constEnd();
+         it != end; ++it)
+    {
+        for (const auto & tagName: qAsConst(it.value())) {
+            if (tagName.isEmpty()) {
+                continue;
+            }
+
+            const QString lowerCaseTagName = tagName.toLower();
+            if (m_tagLocalUidsByLowerCaseName.contains(lowerCaseTagName)) {
+                continue;
+            }
 
-        for (auto tagNameIt = tagNames.begin(); tagNameIt != tagNames.end();) {
-            const auto & tagName = *tagNameIt;
+            const auto requestIdIt =
+                m_addTagRequestIdByTagNameBimap.left.find(lowerCaseTagName);
+
+            if (requestIdIt != m_addTagRequestIdByTagNameBimap.left.end()) {
+                continue;
+            }
 
             QString tagLocalUid = m_tagModel.localUidForItemName(
                 tagName,
                 /* linked notebook guid = */ {});
 
-            if (tagLocalUid.isEmpty()) {
-                nonexistentTagNames << tagName;
-                QNDEBUG(
+            if (!tagLocalUid.isEmpty() &&
+                !m_expungedTagLocalUids.contains(tagLocalUid))
+            {
+                QNTRACE(
                     "enex",
-                    "No tag called \""
-                        << tagName << "\" exists, it would need to be created");
-                ++tagNameIt;
+                    "Local uid for tag name " << tagName << " is "
+                                              << tagLocalUid);
+
+                m_tagLocalUidsByLowerCaseName[lowerCaseTagName] = tagLocalUid;
                 continue;
             }
 
-            if (m_expungedTagLocalUids.contains(tagLocalUid)) {
-                nonexistentTagNames << tagName;
+            QNDEBUG(
+                "enex",
+                "No tag called \"" << tagName
+                                   << "\" exists, it would need to be created");
 
-                QNDEBUG(
-                    "enex",
-                    "Tag local uid "
-                        << tagLocalUid
-                        << " found within the model has been marked "
-                        << "as the one of expunged tag; will need "
-                        << "to create a new tag with such name");
+            addTagToLocalStorage(tagName);
+        }
+    }
 
-                ++tagNameIt;
+    if (!m_addTagRequestIdByTagNameBimap.empty()) {
+        QNDEBUG(
+            "enex",
+            "Waiting for " << m_addTagRequestIdByTagNameBimap.size()
+                           << " missing tags to be created");
+        return;
+    }
+
+    assignTagsToNotes();
+    addNextNotesBatch();
+}
+
+void EnexImporter::assignTagsToNotes()
+{
+    QNDEBUG("enex", "EnexImporter::assignTagsToNotes");
+
+    for (auto & note: m_importedNotes) {
+        const auto tagIt =
+            m_tagNamesByImportedNoteLocalUid.constFind(note.localUid());
+
+        if (tagIt == m_tagNamesByImportedNoteLocalUid.constEnd()) {
+            continue;
+        }
+
+        for (const auto & tagName: qAsConst(tagIt.value())) {
+            if (tagName.isEmpty()) {
                 continue;
             }
 
-            QNTRACE(
-                "enex",
-                "Local uid for tag name " << tagName << " is " << tagLocalUid);
+            const QString tagLocalUid =
+                m_tagLocalUidsByLowerCaseName.value(tagName.toLower());
+
+            if (Q_UNLIKELY(tagLocalUid.isEmpty())) {
+                QNWARNING(
+                    "enex",
+                    "Found no local uid for tag " << tagName << " of note "
+                                                  << note.localUid());
+                continue;
+            }
 
             if (!note.hasTagLocalUids() ||
-                !note.tagLocalUids().contains(tagLocalUid)) {
+                !note.tagLocalUids().contains(tagLocalUid))
+            {
                 note.addTagLocalUid(tagLocalUid);
             }
-
-            tagNameIt = tagNames.erase(tagNameIt);
         }
+    }
 
-        if (tagNames.isEmpty()) {
-            QNTRACE(
-                "enex",
-                "Found all tags for note with local uid " << note.localUid());
-            Q_UNUSED(m_tagNamesByImportedNoteLocalUid.erase(tagIt))
-        }
+    m_tagNamesByImportedNoteLocalUid.clear();
+}
 
-        if (nonexistentTagNames.isEmpty()) {
-            QNDEBUG(
-                "enex",
-                "Found no nonexistent tags, can send this note to "
-                    << "the local storage right away");
-            addNoteToLocalStorage(note);
-            it = m_notesPendingTagAddition.erase(it);
-            continue;
+void EnexImporter::addNextNotesBatch()
+{
+    if (m_nextNoteIndex == 0) {
+        m_addNotesTimer.start();
+    }
+
+    const int end = std::min(
+        m_nextNoteIndex + ENEX_IMPORTER_NOTES_BATCH_SIZE,
+        m_importedNotes.size());
+
+    QNDEBUG(
+        "enex",
+        "EnexImporter::addNextNotesBatch: adding notes from "
+            << m_nextNoteIndex << " to " << end << " out of "
+            << m_importedNotes.size());
+
+    for (; m_nextNoteIndex < end; ++m_nextNoteIndex) {
+        addNoteToLocalStorage(m_nextNoteIndex);
+    }
+}
+
+void EnexImporter::saveCheckpoint()
+{
+    if (!m_checkpointingEnabled || m_importedNotesCheckpointData.isEmpty()) {
+        return;
+    }
+
+    if ((m_addedNotesCount == m_checkpointAddedNotesCount) &&
+        (m_nextNoteIndex == m_checkpointNextNoteIndex))
+    {
+        return;
+    }
+
+    if (m_addNoteRequestIds.isEmpty() &&
+        (m_nextNoteIndex == m_importedNotes.size()))
+    {
+        // The import is complete, no need for the checkpoint anymore
+        return;
+    }
+
+    QNDEBUG("enex", "EnexImporter::saveCheckpoint");
+
+    // Find the notes which were stored in the local storage: all the notes
+    // before the first one for which the request is still pending are
+    // definitely stored, some of the following ones might be stored as well.
+    // The notes for which the requests are still pending might be stored
+    // by the time the import is resumed so their local uids are recorded
+    // to look for them in the local storage then
+    int storedNotesEnd = m_nextNoteIndex;
+    QSet<int> pendingNoteIndexes;
+    for (const int noteIndex: qAsConst(m_addNoteRequestIds)) {
+        storedNotesEnd = std::min(storedNotesEnd, noteIndex);
+        Q_UNUSED(pendingNoteIndexes.insert(noteIndex))
+    }
+
+    if (storedNotesEnd > 0) {
+        const auto & lastStoredNoteCheckpointData =
+            m_importedNotesCheckpointData[storedNotesEnd - 1];
+
+        m_checkpoint.m_filePos = lastStoredNoteCheckpointData.m_endFilePos;
+
+        m_checkpoint.m_noteIndex =
+            lastStoredNoteCheckpointData.m_noteIndex + 1;
+    }
+
+    auto & storedNoteContentHashesByIndex =
+        m_checkpoint.m_storedNoteContentHashesByIndex;
+
+    for (auto it = storedNoteContentHashesByIndex.begin();
+         it != storedNoteContentHashesByIndex.end();)
+    {
+        if (it.key() < m_checkpoint.m_noteIndex) {
+            it = storedNoteContentHashesByIndex.erase(it);
         }
+        else {
+            ++it;
+        }
+    }
 
-        for (const auto & nonexistentTag: qAsConst(nonexistentTagNames)) {
-            auto requestIdIt = m_addTagRequestIdByTagNameBimap.left.find(
-                nonexistentTag.toLower());
+    auto & inFlightNotesByIndex = m_checkpoint.m_inFlightNotesByIndex;
+    inFlightNotesByIndex.clear();
 
-            if (requestIdIt != m_addTagRequestIdByTagNameBimap.left.end()) {
-                QNTRACE(
-                    "enex",
-                    "Nonexistent tag "
-                        << nonexistentTag
-                        << " is already being added to the local storage");
-            }
-            else {
-                addTagToLocalStorage(nonexistentTag);
-            }
+    for (int i = storedNotesEnd; i < m_nextNoteIndex; ++i) {
+        const auto & noteCheckpointData = m_importedNotesCheckpointData[i];
+        const int noteIndex = noteCheckpointData.m_noteIndex;
+
+        if (pendingNoteIndexes.contains(i)) {
+            inFlightNotesByIndex[noteIndex] = qMakePair(
+                m_importedNotes[i].localUid(),
+                noteCheckpointData.m_contentHash);
+            continue;
         }
 
-        ++it;
+        storedNoteContentHashesByIndex[noteIndex] =
+            noteCheckpointData.m_contentHash;
     }
+
+    ErrorString errorDescription;
+    if (!writeEnexImportCheckpoint(
+            m_enexFilePath, m_checkpoint, errorDescription))
+    {
+        return;
+    }
+
+    m_checkpointAddedNotesCount = m_addedNotesCount;
+    m_checkpointNextNoteIndex = m_nextNoteIndex;
 }
 
-void EnexImporter::addNoteToLocalStorage(const Note & note)
+void EnexImporter::addNoteToLocalStorage(const int noteIndex)
 {
-    QNDEBUG("enex", "EnexImporter::addNoteToLocalStorage");
+    QNDEBUG("enex", "EnexImporter::addNoteToLocalStorage: " << noteIndex);
 
     connectToLocalStorage();
 
+    const auto & note = m_importedNotes[noteIndex];
+
     QUuid requestId = QUuid::createUuid();
-    Q_UNUSED(m_addNoteRequestIds.insert(requestId));
+    m_addNoteRequestIds[requestId] = noteIndex;
 
     QNTRACE(
         "enex",
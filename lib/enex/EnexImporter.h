@@ -19,12 +19,17 @@
 #ifndef QUENTIER_LIB_ENEX_ENEX_IMPORTER_H
 #define QUENTIER_LIB_ENEX_ENEX_IMPORTER_H
 
+#include "EnexImportCheckpoint.h"
+
+#include <quentier/local_storage/LocalStorageManager.h>
+#include <quentier/types/Account.h>
 #include <quentier/types/ErrorString.h>
 #include <quentier/types/Note.h>
 #include <quentier/types/Notebook.h>
 #include <quentier/types/Tag.h>
 #include <quentier/utility/SuppressWarnings.h>
 
+#include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
 #include <QUuid>
@@ -43,17 +48,46 @@ QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
 QT_FORWARD_DECLARE_CLASS(TagModel)
 QT_FORWARD_DECLARE_CLASS(NotebookModel)
 
+struct EnexChunk;
+
+/**
+ * @brief The EnexImporter class imports notes from ENEX file into the local
+ * storage.
+ *
+ * The import goes in stages: the file is split into chunks which are
+ * converted into notes in parallel on the thread pool; then the tags missing
+ * from the local storage are created for all notes at once; then the notes
+ * are sent to the local storage in batches, the next batch is sent when
+ * the local storage is done with the most part of the previous one.
+ *
+ * With checkpointing enabled the progress of the import is recorded in a file
+ * next to ENEX file each time a batch of notes is sent to the local storage
+ * and when the import is interrupted. Starting the import of the same ENEX
+ * file into the same notebook of the same account again resumes it from
+ * the last checkpoint. The notes already stored beyond the checkpoint are
+ * recognized by hashes of their contents and skipped; the notes which were
+ * being added when the import was interrupted are looked up in the local
+ * storage by their local uids first. The checkpoint file is removed once
+ * the import is complete.
+ */
 class EnexImporter final : public QObject
 {
     Q_OBJECT
 public:
     explicit EnexImporter(
         const QString & enexFilePath, const QString & notebookName,
+        const Account & account,
         LocalStorageManagerAsync & localStorageManagerAsync,
         TagModel & tagModel, NotebookModel & notebookModel,
         QObject * parent = nullptr);
 
+    virtual ~EnexImporter() override;
+
     bool isInProgress() const;
+
+    bool checkpointingEnabled() const;
+    void setCheckpointingEnabled(const bool enabled);
+
     void start();
 
     void clear();
@@ -62,11 +96,18 @@ Q_SIGNALS:
     void enexImportedSuccessfully(QString enexFilePath);
     void enexImportFailed(ErrorString errorDescription);
 
+    void enexImportProgress(
+        int addedNotesCount, int totalNotesCount, double notesPerSecond);
+
     // private signals:
     void addTag(Tag tag, QUuid requestId);
     void addNotebook(Notebook notebook, QUuid requestId);
     void addNote(Note note, QUuid requestId);
 
+    void findNote(
+        Note note, LocalStorageManager::GetNoteOptions options,
+        QUuid requestId);
+
 private Q_SLOTS:
     void onAddTagComplete(Tag tag, QUuid requestId);
     void onAddTagFailed(Tag tag, ErrorString errorDescription, QUuid requestId);
@@ -86,6 +127,14 @@ private Q_SLOTS:
     void onAddNoteFailed(
         Note note, ErrorString errorDescription, QUuid requestId);
 
+    void onFindNoteComplete(
+        Note foundNote, LocalStorageManager::GetNoteOptions options,
+        QUuid requestId);
+
+    void onFindNoteFailed(
+        Note note, LocalStorageManager::GetNoteOptions options,
+        ErrorString errorDescription, QUuid requestId);
+
     void onAllTagsListed();
     void onAllNotebooksListed();
 
@@ -93,16 +142,42 @@ private:
     void connectToLocalStorage();
     void disconnectFromLocalStorage();
 
-    void processNotesPendingTagAddition();
+    void convertEnexChunks(QVector<EnexChunk> chunks);
+
+    void onEnexChunkConverted(
+        int chunkIndex, QVector<Note> notes,
+        QHash<QString, QStringList> tagNamesByNoteLocalUid,
+        QVector<QByteArray> noteContentHashes, ErrorString errorDescription);
 
-    void addNoteToLocalStorage(const Note & note);
+    void findInFlightNotes();
+    void onInFlightNoteLookedUp(const QUuid & requestId, const bool found);
+    void collectImportedNotes();
+
+    void createMissingTags();
+    void assignTagsToNotes();
+    void addNextNotesBatch();
+
+    void saveCheckpoint();
+
+    void addNoteToLocalStorage(const int noteIndex);
     void addTagToLocalStorage(const QString & tagName);
     void addNotebookToLocalStorage(const QString & notebookName);
 
 private:
+    // Index of the note among all notes of ENEX file, the position within
+    // ENEX file right after the end of the note and the hash of the note's
+    // contents
+    struct NoteCheckpointData
+    {
+        int m_noteIndex = 0;
+        qint64 m_endFilePos = 0;
+        QByteArray m_contentHash;
+    };
+
     LocalStorageManagerAsync & m_localStorageManagerAsync;
     TagModel & m_tagModel;
     NotebookModel & m_notebookModel;
+    Account m_account;
     QString m_enexFilePath;
     QString m_notebookName;
     QString m_notebookLocalUid;
@@ -116,10 +191,43 @@ private:
 
     QUuid m_addNotebookRequestId;
 
-    QVector<Note> m_notesPendingTagAddition;
-    QSet<QUuid> m_addNoteRequestIds;
+    // Results of ENEX chunks conversions coming from the thread pool are
+    // ignored if the import was cleared after the conversions were started
+    quint64 m_importGeneration = 0;
+
+    int m_pendingEnexChunksCount = 0;
+    QVector<QVector<Note>> m_notesByEnexChunk;
+    QVector<QVector<NoteCheckpointData>> m_notesCheckpointDataByEnexChunk;
+
+    QHash<QString, QString> m_tagLocalUidsByLowerCaseName;
+
+    QVector<Note> m_importedNotes;
+    int m_nextNoteIndex = 0;
+    int m_addedNotesCount = 0;
+
+    // Indexes of notes within m_importedNotes by add note request ids
+    QHash<QUuid, int> m_addNoteRequestIds;
+
+    bool m_checkpointingEnabled = false;
+
+    // The checkpoint the import was resumed from or the last saved one
+    EnexImportCheckpoint m_checkpoint;
+    int m_checkpointAddedNotesCount = 0;
+    int m_checkpointNextNoteIndex = 0;
+
+    // Indexes of notes among all notes of ENEX file which were being added
+    // when the import was interrupted by find note request ids
+    QHash<QUuid, int> m_findInFlightNoteRequestIds;
+
+    // Corresponds to m_importedNotes; empty if checkpoints cannot be made
+    // for the current import
+    QVector<NoteCheckpointData> m_importedNotesCheckpointData;
+
+    QElapsedTimer m_importTimer;
+    QElapsedTimer m_addNotesTimer;
 
     bool m_pendingNotebookModelToStart = false;
+    bool m_pendingTagModelToCreateMissingTags = false;
     bool m_connectedToLocalStorage = false;
 };
 
@@ -0,0 +1,348 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EnexImportTester.h"
+
+#include <lib/enex/EnexChunkConverter.h>
+#include <lib/enex/EnexImportCheckpoint.h>
+
+#include <quentier/types/Account.h>
+#include <quentier/utility/Initialize.h>
+
+#include <QtTest/QtTest>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+
+using namespace quentier;
+
+namespace {
+
+const QByteArray enexHeader = QByteArrayLiteral(
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<!DOCTYPE en-export SYSTEM "
+    "\"http://xml.evernote.com/pub/evernote-export3.dtd\">\n"
+    "<en-export export-date=\"20210101T000000Z\" application=\"Evernote\" "
+    "version=\"10\">\n");
+
+const QByteArray enexEndTag = QByteArrayLiteral("</en-export>");
+
+QByteArray enexNote(const QByteArray & title, const QByteArray & text)
+{
+    return QByteArrayLiteral("<note><title>") + title +
+        QByteArrayLiteral("</title><content><![CDATA[<en-note>") + text +
+        QByteArrayLiteral("</en-note>]]></content></note>");
+}
+
+// Notes of the test ENEX; the second one contains the note's end tag within
+// CDATA section and the last two ones are identical
+QVector<QByteArray> testEnexNotes()
+{
+    return QVector<QByteArray>()
+        << enexNote("First", "First note")
+        << enexNote("Second", "Mentions </note> in the text")
+        << enexNote("Third", "Third note")
+        << enexNote("Duplicate", "Same note")
+        << enexNote("Duplicate", "Same note");
+}
+
+QByteArray composeEnex(
+    const QVector<QByteArray> & notes, QVector<qint64> & noteEndFilePositions)
+{
+    QByteArray enex = enexHeader;
+    noteEndFilePositions.clear();
+
+    for (const auto & note: qAsConst(notes)) {
+        enex += note;
+        noteEndFilePositions << enex.size();
+        enex += '\n';
+    }
+
+    enex += enexEndTag;
+    enex += '\n';
+    return enex;
+}
+
+bool writeFile(const QString & filePath, const QByteArray & data)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    return file.write(data) == data.size();
+}
+
+EnexImportCheckpoint testCheckpoint(const QString & enexFilePath)
+{
+    const QByteArray firstHash = QByteArrayLiteral("0123456789abcdef");
+    const QByteArray secondHash = QByteArrayLiteral("fedcba9876543210");
+
+    EnexImportCheckpoint checkpoint;
+    checkpoint.m_enexFileMarker = enexFileMarker(enexFilePath);
+
+    checkpoint.m_accountIdentity = enexImportCheckpointAccountIdentity(
+        Account(QStringLiteral("Local user"), Account::Type::Local));
+
+    checkpoint.m_notebookLocalUid = QUuid::createUuid().toString();
+    checkpoint.m_filePos = 1234;
+    checkpoint.m_noteIndex = 2;
+
+    // Identical notes have the same hashes but must not collapse
+    checkpoint.m_storedNoteContentHashesByIndex[3] = firstHash;
+    checkpoint.m_storedNoteContentHashesByIndex[5] = firstHash;
+
+    checkpoint.m_inFlightNotesByIndex[4] =
+        qMakePair(QUuid::createUuid().toString(), secondHash);
+
+    checkpoint.m_inFlightNotesByIndex[6] =
+        qMakePair(QUuid::createUuid().toString(), secondHash);
+
+    return checkpoint;
+}
+
+} // namespace
+
+EnexImportTester::EnexImportTester(QObject * parent) : QObject(parent) {}
+
+EnexImportTester::~EnexImportTester() = default;
+
+void EnexImportTester::testSplitEnexIntoChunks()
+{
+    const auto notes = testEnexNotes();
+    QVector<qint64> noteEndFilePositions;
+    const QByteArray enex = composeEnex(notes, noteEndFilePositions);
+
+    QVector<EnexChunk> chunks;
+    ErrorString errorDescription;
+    QVERIFY2(
+        splitEnexIntoChunks(enex, 2, chunks, errorDescription),
+        qPrintable(errorDescription.nonLocalizedString()));
+
+    QCOMPARE(chunks.size(), 3);
+
+    int noteIndex = 0;
+    for (int i = 0, size = chunks.size(); i < size; ++i) {
+        const auto & chunk = chunks[i];
+
+        // Each chunk is a standalone ENEX document
+        QVERIFY(chunk.m_data.startsWith(enexHeader));
+        QVERIFY(chunk.m_data.endsWith(enexEndTag));
+
+        QCOMPARE(chunk.m_firstNoteIndex, noteIndex);
+        QCOMPARE(chunk.m_noteRanges.size(), (i < 2 ? 2 : 1));
+        QCOMPARE(
+            chunk.m_noteEndFilePositions.size(), chunk.m_noteRanges.size());
+
+        for (int j = 0, count = chunk.m_noteRanges.size(); j < count; ++j) {
+            const auto & range = chunk.m_noteRanges[j];
+            QCOMPARE(
+                chunk.m_data.mid(range.first, range.second),
+                notes[noteIndex]);
+
+            QCOMPARE(
+                chunk.m_noteEndFilePositions[j],
+                noteEndFilePositions[noteIndex]);
+            ++noteIndex;
+        }
+    }
+
+    QCOMPARE(noteIndex, notes.size());
+}
+
+void EnexImportTester::testSplitEnexIntoChunksFromPosition()
+{
+    const auto notes = testEnexNotes();
+    QVector<qint64> noteEndFilePositions;
+    const QByteArray enex = composeEnex(notes, noteEndFilePositions);
+
+    // Resume right after the second note as if it was imported before
+    QVector<EnexChunk> chunks;
+    ErrorString errorDescription;
+    QVERIFY2(
+        splitEnexIntoChunks(
+            enex, 10, chunks, errorDescription,
+            static_cast<int>(noteEndFilePositions[1]), 2),
+        qPrintable(errorDescription.nonLocalizedString()));
+
+    QCOMPARE(chunks.size(), 1);
+
+    const auto & chunk = chunks[0];
+    QVERIFY(chunk.m_data.startsWith(enexHeader));
+    QCOMPARE(chunk.m_firstNoteIndex, 2);
+    QCOMPARE(chunk.m_noteRanges.size(), 3);
+
+    for (int j = 0; j < 3; ++j) {
+        const auto & range = chunk.m_noteRanges[j];
+        QCOMPARE(chunk.m_data.mid(range.first, range.second), notes[j + 2]);
+        QCOMPARE(chunk.m_noteEndFilePositions[j], noteEndFilePositions[j + 2]);
+    }
+
+    // Nothing to split after the last note
+    QVERIFY(splitEnexIntoChunks(
+        enex, 10, chunks, errorDescription,
+        static_cast<int>(noteEndFilePositions.last()), notes.size()));
+
+    QVERIFY(chunks.isEmpty());
+}
+
+void EnexImportTester::testSplitMalformedEnex()
+{
+    QVector<EnexChunk> chunks;
+    ErrorString errorDescription;
+
+    // ENEX without notes is fine
+    QVERIFY(splitEnexIntoChunks(
+        enexHeader + enexEndTag, 10, chunks, errorDescription));
+
+    QVERIFY(chunks.isEmpty());
+
+    QVERIFY(!splitEnexIntoChunks(
+        QByteArrayLiteral("<html><body><note></note></body></html>"), 10,
+        chunks, errorDescription));
+
+    QVERIFY(!errorDescription.isEmpty());
+
+    // Unterminated note
+    errorDescription.clear();
+    QByteArray enex = enexHeader + enexNote("First", "First note") +
+        QByteArrayLiteral("<note><title>Second</title>");
+
+    QVERIFY(!splitEnexIntoChunks(enex, 10, chunks, errorDescription));
+    QVERIFY(!errorDescription.isEmpty());
+
+    // Unterminated CDATA section swallowing the note's end tag
+    errorDescription.clear();
+    enex = enexHeader +
+        QByteArrayLiteral(
+            "<note><content><![CDATA[<en-note></en-note></content></note>") +
+        enexEndTag;
+
+    QVERIFY(!splitEnexIntoChunks(enex, 10, chunks, errorDescription));
+    QVERIFY(!errorDescription.isEmpty());
+}
+
+void EnexImportTester::testCheckpointRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString enexFilePath = dir.path() + QStringLiteral("/notes.enex");
+
+    QVector<qint64> noteEndFilePositions;
+    QVERIFY(writeFile(
+        enexFilePath, composeEnex(testEnexNotes(), noteEndFilePositions)));
+
+    const auto checkpoint = testCheckpoint(enexFilePath);
+    QVERIFY(!checkpoint.m_enexFileMarker.isEmpty());
+
+    ErrorString errorDescription;
+    QVERIFY2(
+        writeEnexImportCheckpoint(enexFilePath, checkpoint, errorDescription),
+        qPrintable(errorDescription.nonLocalizedString()));
+
+    QVERIFY(QFile::exists(enexImportCheckpointFilePath(enexFilePath)));
+
+    EnexImportCheckpoint readCheckpoint;
+    QVERIFY(readEnexImportCheckpoint(enexFilePath, readCheckpoint));
+
+    QCOMPARE(readCheckpoint.m_enexFileMarker, checkpoint.m_enexFileMarker);
+    QCOMPARE(readCheckpoint.m_accountIdentity, checkpoint.m_accountIdentity);
+    QCOMPARE(readCheckpoint.m_notebookLocalUid, checkpoint.m_notebookLocalUid);
+    QCOMPARE(readCheckpoint.m_filePos, checkpoint.m_filePos);
+    QCOMPARE(readCheckpoint.m_noteIndex, checkpoint.m_noteIndex);
+
+    QVERIFY(
+        readCheckpoint.m_storedNoteContentHashesByIndex ==
+        checkpoint.m_storedNoteContentHashesByIndex);
+
+    QVERIFY(
+        readCheckpoint.m_inFlightNotesByIndex ==
+        checkpoint.m_inFlightNotesByIndex);
+
+    QCOMPARE(readCheckpoint.m_storedNoteContentHashesByIndex.size(), 2);
+    QCOMPARE(readCheckpoint.m_inFlightNotesByIndex.size(), 2);
+
+    removeEnexImportCheckpoint(enexFilePath);
+    QVERIFY(!QFile::exists(enexImportCheckpointFilePath(enexFilePath)));
+    QVERIFY(!readEnexImportCheckpoint(enexFilePath, readCheckpoint));
+}
+
+void EnexImportTester::testCheckpointOfModifiedEnex()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString enexFilePath = dir.path() + QStringLiteral("/notes.enex");
+
+    QVector<qint64> noteEndFilePositions;
+    const auto notes = testEnexNotes();
+    QVERIFY(writeFile(enexFilePath, composeEnex(notes, noteEndFilePositions)));
+
+    ErrorString errorDescription;
+    QVERIFY(writeEnexImportCheckpoint(
+        enexFilePath, testCheckpoint(enexFilePath), errorDescription));
+
+    // Positions and indexes of notes recorded in the checkpoint are no longer
+    // valid once the file changes
+    QVERIFY(writeFile(
+        enexFilePath,
+        composeEnex(notes.mid(0, notes.size() - 1), noteEndFilePositions)));
+
+    EnexImportCheckpoint readCheckpoint;
+    QVERIFY(!readEnexImportCheckpoint(enexFilePath, readCheckpoint));
+}
+
+void EnexImportTester::testCorruptedCheckpoint()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString enexFilePath = dir.path() + QStringLiteral("/notes.enex");
+
+    QVector<qint64> noteEndFilePositions;
+    QVERIFY(writeFile(
+        enexFilePath, composeEnex(testEnexNotes(), noteEndFilePositions)));
+
+    ErrorString errorDescription;
+    QVERIFY(writeEnexImportCheckpoint(
+        enexFilePath, testCheckpoint(enexFilePath), errorDescription));
+
+    const QString checkpointFilePath =
+        enexImportCheckpointFilePath(enexFilePath);
+
+    QFile checkpointFile(checkpointFilePath);
+    QVERIFY(checkpointFile.open(QIODevice::ReadWrite));
+    QVERIFY(checkpointFile.resize(checkpointFile.size() - 3));
+    checkpointFile.close();
+
+    EnexImportCheckpoint readCheckpoint;
+    QVERIFY(!readEnexImportCheckpoint(enexFilePath, readCheckpoint));
+
+    QVERIFY(writeFile(checkpointFilePath, QByteArrayLiteral("garbage")));
+    QVERIFY(!readEnexImportCheckpoint(enexFilePath, readCheckpoint));
+}
+
+int main(int argc, char * argv[])
+{
+    QCoreApplication app(argc, argv);
+    quentier::initializeLibquentier();
+    EnexImportTester tester;
+    return QTest::qExec(&tester, argc, argv);
+}
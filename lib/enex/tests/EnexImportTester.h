@@ -0,0 +1,41 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_ENEX_TESTS_ENEX_IMPORT_TESTER_H
+#define QUENTIER_LIB_ENEX_TESTS_ENEX_IMPORT_TESTER_H
+
+#include <QObject>
+
+class EnexImportTester : public QObject
+{
+    Q_OBJECT
+public:
+    EnexImportTester(QObject * parent = nullptr);
+
+    virtual ~EnexImportTester() override;
+
+private Q_SLOTS:
+    void testSplitEnexIntoChunks();
+    void testSplitEnexIntoChunksFromPosition();
+    void testSplitMalformedEnex();
+    void testCheckpointRoundTrip();
+    void testCheckpointOfModifiedEnex();
+    void testCorruptedCheckpoint();
+};
+
+#endif // QUENTIER_LIB_ENEX_TESTS_ENEX_IMPORT_TESTER_H
@@ -18,6 +18,7 @@
 
 #include "DefaultAccountFirstNotebookAndNoteCreator.h"
 
+#include <lib/utility/Log.h>
 #include <lib/widget/NoteFiltersManager.h>
 
 #include <quentier/local_storage/LocalStorageManagerAsync.h>
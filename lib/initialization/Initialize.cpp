@@ -173,11 +173,13 @@ bool initialize(
 
     // Initialize logging
     QUENTIER_INITIALIZE_LOGGING();
-    QuentierSetMinLogLevel(pLogLevel ? *pLogLevel : LogLevel::Info);
+    applyMinLogLevel(pLogLevel ? *pLogLevel : LogLevel::Info);
     QUENTIER_ADD_STDOUT_LOG_DESTINATION();
 
     auto logFilterByComponent = restoreLogFilterByComponent();
-    QuentierSetLogComponentFilter(QRegularExpression(logFilterByComponent));
+    applyLogComponentFilter(QRegularExpression(logFilterByComponent));
+    applyStructuredLogEnabled(restoreStructuredLogEnabled());
+    startAsyncLogWriter();
 
 #ifdef BUILDING_WITH_BREAKPAD
     if (libquentierUsesQtWebEngine()) {
@@ -203,8 +205,7 @@ bool initialize(
                                   .toInt(&conversionResult);
 
             if (conversionResult && (0 <= minLogLevel) && (minLogLevel < 6)) {
-                quentier::QuentierSetMinLogLevel(
-                    static_cast<quentier::LogLevel>(minLogLevel));
+                applyMinLogLevel(static_cast<quentier::LogLevel>(minLogLevel));
             }
         }
     }
@@ -380,6 +381,8 @@ bool processOverrideSystemTrayAvailabilityCommandLineOption(
 
 void finalize()
 {
+    stopAsyncLogWriter();
+
 #ifdef BUILDING_WITH_BREAKPAD
     detachBreakpad();
 #endif
@@ -20,6 +20,7 @@
 
 #include <lib/preferences/defaults/StartAtLogin.h>
 #include <lib/preferences/keys/StartAtLogin.h>
+#include <lib/utility/Log.h>
 #include <lib/utility/StartAtLogin.h>
 
 #include <quentier/logging/QuentierLogger.h>
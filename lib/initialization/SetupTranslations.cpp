@@ -19,6 +19,7 @@
 #include "SetupTranslations.h"
 
 #include <lib/preferences/keys/Translations.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
@@ -18,6 +18,8 @@
 
 #include "BreakpadIntegration.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 
 #include <QFileInfoList>
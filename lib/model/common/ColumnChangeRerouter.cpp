@@ -18,6 +18,8 @@
 
 #include "ColumnChangeRerouter.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 
 #include <algorithm>
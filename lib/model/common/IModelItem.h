@@ -59,7 +59,20 @@ public:
 
     int rowForChild(const TSubclass * pChild) const
     {
-        return m_children.indexOf(const_cast<TSubclass *>(pChild));
+        if (Q_UNLIKELY(!pChild)) {
+            return -1;
+        }
+
+        // Each child caches its own row within the parent so there's no need
+        // to search for it, only to check the cached value is still relevant
+        const int row = pChild->m_row;
+        if ((pChild->m_pParent != this) || (row < 0) ||
+            (row >= m_children.size()) || (m_children[row] != pChild))
+        {
+            return -1;
+        }
+
+        return row;
     }
 
     bool hasChildren() const
@@ -85,6 +98,7 @@ public:
 
         pItem->m_pParent = static_cast<TSubclass *>(this);
         m_children.insert(row, pItem);
+        updateChildRows(row);
     }
 
     void addChild(TSubclass * pItem)
@@ -106,6 +120,8 @@ public:
         m_children.swap(srcRow, dstRow);
 #endif
 
+        m_children[srcRow]->m_row = srcRow;
+        m_children[dstRow]->m_row = dstRow;
         return true;
     }
 
@@ -118,8 +134,10 @@ public:
         auto * pItem = m_children.takeAt(row);
         if (pItem) {
             pItem->m_pParent = nullptr;
+            pItem->m_row = -1;
         }
 
+        updateChildRows(row);
         return pItem;
     }
 
@@ -127,6 +145,7 @@ public:
     void sortChildren(Comparator comparator)
     {
         std::sort(m_children.begin(), m_children.end(), comparator);
+        updateChildRows(0);
     }
 
     virtual QDataStream & serializeItemData(QDataStream & out) const
@@ -139,9 +158,24 @@ public:
         return in;
     }
 
+protected:
+    void updateChildRows(const int firstRow)
+    {
+        for (int row = firstRow, size = m_children.size(); row < size; ++row)
+        {
+            auto * pChild = m_children[row];
+            if (pChild) {
+                pChild->m_row = row;
+            }
+        }
+    }
+
 protected:
     TSubclass * m_pParent = nullptr;
     QList<TSubclass *> m_children;
+
+    // Row of this item within its parent's children
+    int m_row = -1;
 };
 
 } // namespace quentier
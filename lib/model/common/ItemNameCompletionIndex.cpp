@@ -0,0 +1,373 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ItemNameCompletionIndex.h"
+
+#include "AbstractItemModel.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Compat.h>
+
+#include <QStringListModel>
+
+#include <algorithm>
+#include <iterator>
+
+namespace quentier {
+
+namespace {
+
+bool lessCaseInsensitively(const QString & lhs, const QString & rhs)
+{
+    return lhs.compare(rhs, Qt::CaseInsensitive) < 0;
+}
+
+} // namespace
+
+ItemNameCompletionIndex * ItemNameCompletionIndex::forModel(
+    AbstractItemModel & model)
+{
+    auto * pIndex = model.findChild<ItemNameCompletionIndex *>(
+        QString(), Qt::FindDirectChildrenOnly);
+
+    if (!pIndex) {
+        pIndex = new ItemNameCompletionIndex(model);
+    }
+
+    return pIndex;
+}
+
+ItemNameCompletionIndex::ItemNameCompletionIndex(AbstractItemModel & model) :
+    QObject(&model), m_pModel(&model)
+{
+    m_allItemsScope.m_pModel = new QStringListModel(this);
+
+    QObject::connect(
+        &model, &AbstractItemModel::rowsInserted, this,
+        &ItemNameCompletionIndex::onRowsInserted);
+
+    QObject::connect(
+        &model, &AbstractItemModel::rowsAboutToBeRemoved, this,
+        &ItemNameCompletionIndex::onRowsAboutToBeRemoved);
+
+    QObject::connect(
+        &model, &AbstractItemModel::dataChanged, this,
+        &ItemNameCompletionIndex::onDataChanged);
+
+    QObject::connect(
+        &model, &AbstractItemModel::modelReset, this,
+        &ItemNameCompletionIndex::onModelReset);
+
+    rebuild();
+}
+
+ItemNameCompletionIndex::~ItemNameCompletionIndex() = default;
+
+QAbstractItemModel * ItemNameCompletionIndex::completionModel(
+    const QString & linkedNotebookGuid)
+{
+    if (linkedNotebookGuid.isNull()) {
+        return m_allItemsScope.m_pModel;
+    }
+
+    auto it = m_scopesByLinkedNotebookGuid.find(linkedNotebookGuid);
+    if (it == m_scopesByLinkedNotebookGuid.end()) {
+        Scope scope;
+        scope.m_pModel = new QStringListModel(this);
+        fillScope(scope, linkedNotebookGuid);
+        it = m_scopesByLinkedNotebookGuid.insert(linkedNotebookGuid, scope);
+    }
+
+    return it.value().m_pModel;
+}
+
+void ItemNameCompletionIndex::onRowsInserted(
+    const QModelIndex & parent, int start, int end)
+{
+    QNTRACE(
+        "model:item_name_completion",
+        "ItemNameCompletionIndex::onRowsInserted: start = "
+            << start << ", end = " << end);
+
+    QStringList localUids;
+    collectLocalUids(parent, start, end, localUids);
+
+    for (const auto & localUid: qAsConst(localUids)) {
+        addItem(localUid);
+    }
+}
+
+void ItemNameCompletionIndex::onRowsAboutToBeRemoved(
+    const QModelIndex & parent, int start, int end)
+{
+    QNTRACE(
+        "model:item_name_completion",
+        "ItemNameCompletionIndex::onRowsAboutToBeRemoved: start = "
+            << start << ", end = " << end);
+
+    QStringList localUids;
+    collectLocalUids(parent, start, end, localUids);
+
+    for (const auto & localUid: qAsConst(localUids)) {
+        removeItem(localUid);
+    }
+}
+
+void ItemNameCompletionIndex::onDataChanged(
+    const QModelIndex & topLeft, const QModelIndex & bottomRight,
+    const QVector<int> & roles)
+{
+    Q_UNUSED(roles)
+
+    if (m_pModel.isNull()) {
+        return;
+    }
+
+    // Only renaming of items matters for completion
+    int nameColumn = m_pModel->nameColumn();
+    if ((topLeft.column() > nameColumn) || (bottomRight.column() < nameColumn))
+    {
+        return;
+    }
+
+    QModelIndex parent = topLeft.parent();
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        auto index = m_pModel->index(row, 0, parent);
+
+        QString localUid = m_pModel->localUidForItemIndex(index);
+        if (localUid.isEmpty()) {
+            if (!m_pModel->linkedNotebookGuidForItemIndex(index).isEmpty()) {
+                // The username of linked notebook's owner might have changed,
+                // it is a part of completions for all items from the linked
+                // notebook
+                rebuild();
+                return;
+            }
+
+            continue;
+        }
+
+        Entry entry;
+        if (!entryForItem(localUid, entry)) {
+            removeItem(localUid);
+            continue;
+        }
+
+        auto it = m_entriesByLocalUid.constFind(localUid);
+        if ((it != m_entriesByLocalUid.constEnd()) &&
+            (it.value().m_completion == entry.m_completion) &&
+            (it.value().m_linkedNotebookGuid == entry.m_linkedNotebookGuid))
+        {
+            continue;
+        }
+
+        QNTRACE(
+            "model:item_name_completion",
+            "Item with local uid " << localUid << " was renamed to "
+                                   << entry.m_completion);
+
+        removeItem(localUid);
+        addItem(localUid);
+    }
+}
+
+void ItemNameCompletionIndex::onModelReset()
+{
+    QNTRACE(
+        "model:item_name_completion", "ItemNameCompletionIndex::onModelReset");
+
+    rebuild();
+}
+
+void ItemNameCompletionIndex::rebuild()
+{
+    QNDEBUG("model:item_name_completion", "ItemNameCompletionIndex::rebuild");
+
+    m_entriesByLocalUid.clear();
+
+    if (!m_pModel.isNull()) {
+        QStringList localUids;
+
+        int rowCount = m_pModel->rowCount(QModelIndex());
+        if (rowCount > 0) {
+            collectLocalUids(QModelIndex(), 0, rowCount - 1, localUids);
+        }
+
+        m_entriesByLocalUid.reserve(localUids.size());
+        for (const auto & localUid: qAsConst(localUids)) {
+            Entry entry;
+            if (entryForItem(localUid, entry)) {
+                m_entriesByLocalUid[localUid] = entry;
+            }
+        }
+    }
+
+    fillScope(m_allItemsScope, QString());
+
+    for (auto it = m_scopesByLinkedNotebookGuid.begin(),
+              end = m_scopesByLinkedNotebookGuid.end();
+         it != end; ++it)
+    {
+        fillScope(it.value(), it.key());
+    }
+}
+
+void ItemNameCompletionIndex::fillScope(
+    Scope & scope, const QString & linkedNotebookGuid)
+{
+    scope.m_completions.clear();
+    scope.m_completions.reserve(m_entriesByLocalUid.size());
+
+    for (auto it = m_entriesByLocalUid.constBegin(),
+              end = m_entriesByLocalUid.constEnd();
+         it != end; ++it)
+    {
+        const auto & entry = it.value();
+        if (linkedNotebookGuid.isNull() ||
+            (entry.m_linkedNotebookGuid == linkedNotebookGuid))
+        {
+            scope.m_completions << entry.m_completion;
+        }
+    }
+
+    std::sort(
+        scope.m_completions.begin(), scope.m_completions.end(),
+        lessCaseInsensitively);
+
+    scope.m_pModel->setStringList(scope.m_completions);
+}
+
+void ItemNameCompletionIndex::collectLocalUids(
+    const QModelIndex & parent, int start, int end,
+    QStringList & localUids) const
+{
+    for (int row = start; row <= end; ++row) {
+        auto index = m_pModel->index(row, 0, parent);
+        if (!index.isValid()) {
+            continue;
+        }
+
+        QString localUid = m_pModel->localUidForItemIndex(index);
+        if (!localUid.isEmpty()) {
+            localUids << localUid;
+        }
+
+        int childCount = m_pModel->rowCount(index);
+        if (childCount > 0) {
+            collectLocalUids(index, 0, childCount - 1, localUids);
+        }
+    }
+}
+
+void ItemNameCompletionIndex::addItem(const QString & localUid)
+{
+    if (m_entriesByLocalUid.contains(localUid)) {
+        return;
+    }
+
+    Entry entry;
+    if (!entryForItem(localUid, entry)) {
+        return;
+    }
+
+    m_entriesByLocalUid[localUid] = entry;
+
+    insertCompletion(m_allItemsScope, entry.m_completion);
+
+    auto it = m_scopesByLinkedNotebookGuid.find(entry.m_linkedNotebookGuid);
+    if (it != m_scopesByLinkedNotebookGuid.end()) {
+        insertCompletion(it.value(), entry.m_completion);
+    }
+}
+
+void ItemNameCompletionIndex::removeItem(const QString & localUid)
+{
+    auto entryIt = m_entriesByLocalUid.find(localUid);
+    if (entryIt == m_entriesByLocalUid.end()) {
+        return;
+    }
+
+    const Entry entry = entryIt.value();
+    m_entriesByLocalUid.erase(entryIt);
+
+    removeCompletion(m_allItemsScope, entry.m_completion);
+
+    auto it = m_scopesByLinkedNotebookGuid.find(entry.m_linkedNotebookGuid);
+    if (it != m_scopesByLinkedNotebookGuid.end()) {
+        removeCompletion(it.value(), entry.m_completion);
+    }
+}
+
+bool ItemNameCompletionIndex::entryForItem(
+    const QString & localUid, Entry & entry) const
+{
+    if (m_pModel.isNull()) {
+        return false;
+    }
+
+    auto info = m_pModel->itemInfoForLocalUid(localUid);
+    if (info.m_name.isEmpty()) {
+        return false;
+    }
+
+    entry.m_completion = info.m_name;
+    entry.m_linkedNotebookGuid = info.m_linkedNotebookGuid;
+
+    if (!info.m_linkedNotebookGuid.isEmpty()) {
+        entry.m_completion += QStringLiteral(" \\ @");
+        entry.m_completion += info.m_linkedNotebookUsername;
+    }
+
+    return true;
+}
+
+void ItemNameCompletionIndex::insertCompletion(
+    Scope & scope, const QString & completion)
+{
+    auto it = std::lower_bound(
+        scope.m_completions.begin(), scope.m_completions.end(), completion,
+        lessCaseInsensitively);
+
+    int row = static_cast<int>(std::distance(scope.m_completions.begin(), it));
+    scope.m_completions.insert(row, completion);
+
+    Q_UNUSED(scope.m_pModel->insertRows(row, 1))
+    Q_UNUSED(scope.m_pModel->setData(scope.m_pModel->index(row), completion))
+}
+
+void ItemNameCompletionIndex::removeCompletion(
+    Scope & scope, const QString & completion)
+{
+    auto range = std::equal_range(
+        scope.m_completions.begin(), scope.m_completions.end(), completion,
+        lessCaseInsensitively);
+
+    auto it = std::find(range.first, range.second, completion);
+    if (it == range.second) {
+        return;
+    }
+
+    int row = static_cast<int>(std::distance(scope.m_completions.begin(), it));
+    scope.m_completions.removeAt(row);
+
+    Q_UNUSED(scope.m_pModel->removeRows(row, 1))
+}
+
+} // namespace quentier
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_MODEL_COMMON_ITEM_NAME_COMPLETION_INDEX_H
+#define QUENTIER_LIB_MODEL_COMMON_ITEM_NAME_COMPLETION_INDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(QAbstractItemModel)
+QT_FORWARD_DECLARE_CLASS(QModelIndex)
+QT_FORWARD_DECLARE_CLASS(QStringListModel)
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(AbstractItemModel)
+
+/**
+ * @brief The ItemNameCompletionIndex class keeps the names of items of some
+ * item model sorted for completion of item names being entered by the user
+ *
+ * There's only one index per model, it is shared by all completers dealing
+ * with the model's item names. The index is built once and then kept up to
+ * date as items are added to the model, renamed or removed from it.
+ *
+ * Names of items from linked notebooks are suffixed with " \ @username" of
+ * the linked notebook's owner. Names are sorted case insensitively so that
+ * QCompleter could search them with
+ * QCompleter::CaseInsensitivelySortedModel sorting.
+ */
+class ItemNameCompletionIndex final : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @return      The completion index of the model, the index is created
+     *              on the first call and is owned by the model
+     */
+    static ItemNameCompletionIndex * forModel(AbstractItemModel & model);
+
+    virtual ~ItemNameCompletionIndex() override;
+
+    /**
+     * @param linkedNotebookGuid    If null, the returned model contains
+     *                              the names of all items; if empty, only
+     *                              the names of items from user's own account;
+     *                              otherwise only the names of items from
+     *                              the linked notebook with this guid
+     * @return                      String list model with sorted item names
+     *                              suitable for QCompleter; the model is owned
+     *                              by the index
+     */
+    QAbstractItemModel * completionModel(const QString & linkedNotebookGuid);
+
+private Q_SLOTS:
+    void onRowsInserted(const QModelIndex & parent, int start, int end);
+
+    void onRowsAboutToBeRemoved(
+        const QModelIndex & parent, int start, int end);
+
+    void onDataChanged(
+        const QModelIndex & topLeft, const QModelIndex & bottomRight,
+        const QVector<int> & roles = QVector<int>());
+
+    void onModelReset();
+
+private:
+    explicit ItemNameCompletionIndex(AbstractItemModel & model);
+
+    struct Entry
+    {
+        QString m_completion;
+        QString m_linkedNotebookGuid;
+    };
+
+    struct Scope
+    {
+        QStringList m_completions;
+        QStringListModel * m_pModel = nullptr;
+    };
+
+    void rebuild();
+    void fillScope(Scope & scope, const QString & linkedNotebookGuid);
+
+    // Collects local uids of items within the specified rows and of all
+    // their descendants
+    void collectLocalUids(
+        const QModelIndex & parent, int start, int end,
+        QStringList & localUids) const;
+
+    void addItem(const QString & localUid);
+    void removeItem(const QString & localUid);
+
+    bool entryForItem(const QString & localUid, Entry & entry) const;
+
+    void insertCompletion(Scope & scope, const QString & completion);
+    void removeCompletion(Scope & scope, const QString & completion);
+
+private:
+    Q_DISABLE_COPY(ItemNameCompletionIndex)
+
+private:
+    QPointer<AbstractItemModel> m_pModel;
+
+    // Scope containing all items' names
+    Scope m_allItemsScope;
+
+    // Scopes containing names of items from user's own account (empty key)
+    // and from particular linked notebooks; created on demand
+    QHash<QString, Scope> m_scopesByLinkedNotebookGuid;
+
+    QHash<QString, Entry> m_entriesByLocalUid;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_MODEL_COMMON_ITEM_NAME_COMPLETION_INDEX_H
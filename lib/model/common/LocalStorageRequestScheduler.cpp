@@ -0,0 +1,542 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStorageRequestScheduler.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/local_storage/LocalStorageManagerAsync.h>
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QDebug>
+#include <QTimer>
+
+#include <algorithm>
+#include <tuple>
+
+namespace quentier {
+
+LocalStorageRequestScheduler::LocalStorageRequestScheduler(
+    LocalStorageManagerAsync & localStorageManagerAsync,
+    const int maxRequestsInFlight, QObject * parent) :
+    QObject(parent),
+    m_localStorageManagerAsync(localStorageManagerAsync),
+    m_maxRequestsInFlight(std::max(maxRequestsInFlight, 1)),
+    m_pTimeoutTimer(new QTimer(this))
+{
+    m_clock.start();
+
+    m_pTimeoutTimer->setInterval(
+        LOCAL_STORAGE_REQUEST_SCHEDULER_REQUEST_TIMEOUT_MSEC / 2);
+
+    QObject::connect(
+        m_pTimeoutTimer, &QTimer::timeout, this,
+        &LocalStorageRequestScheduler::checkForTimeouts);
+
+    using LSMA = LocalStorageManagerAsync;
+
+    trackRequestCompletion(&LSMA::findNoteComplete);
+    trackRequestCompletion(&LSMA::findNoteFailed);
+    trackRequestCompletion(&LSMA::findNotebookComplete);
+    trackRequestCompletion(&LSMA::findNotebookFailed);
+    trackRequestCompletion(&LSMA::findTagComplete);
+    trackRequestCompletion(&LSMA::findTagFailed);
+    trackRequestCompletion(&LSMA::findSavedSearchComplete);
+    trackRequestCompletion(&LSMA::findSavedSearchFailed);
+
+    trackRequestCompletion(&LSMA::listNotesComplete);
+    trackRequestCompletion(&LSMA::listNotesFailed);
+    trackRequestCompletion(&LSMA::listNotesByLocalUidsComplete);
+    trackRequestCompletion(&LSMA::listNotesByLocalUidsFailed);
+    trackRequestCompletion(&LSMA::listNotesPerNotebooksAndTagsComplete);
+    trackRequestCompletion(&LSMA::listNotesPerNotebooksAndTagsFailed);
+    trackRequestCompletion(&LSMA::listNotebooksComplete);
+    trackRequestCompletion(&LSMA::listNotebooksFailed);
+    trackRequestCompletion(&LSMA::listTagsComplete);
+    trackRequestCompletion(&LSMA::listTagsFailed);
+    trackRequestCompletion(&LSMA::listSavedSearchesComplete);
+    trackRequestCompletion(&LSMA::listSavedSearchesFailed);
+    trackRequestCompletion(&LSMA::listAllLinkedNotebooksComplete);
+    trackRequestCompletion(&LSMA::listAllLinkedNotebooksFailed);
+
+    trackRequestCompletion(&LSMA::getNoteCountComplete);
+    trackRequestCompletion(&LSMA::getNoteCountFailed);
+    trackRequestCompletion(&LSMA::getNoteCountPerNotebookComplete);
+    trackRequestCompletion(&LSMA::getNoteCountPerNotebookFailed);
+    trackRequestCompletion(&LSMA::getNoteCountPerTagComplete);
+    trackRequestCompletion(&LSMA::getNoteCountPerTagFailed);
+    trackRequestCompletion(&LSMA::getNoteCountsPerAllTagsComplete);
+    trackRequestCompletion(&LSMA::getNoteCountsPerAllTagsFailed);
+    trackRequestCompletion(&LSMA::getNoteCountPerNotebooksAndTagsComplete);
+    trackRequestCompletion(&LSMA::getNoteCountPerNotebooksAndTagsFailed);
+}
+
+LocalStorageRequestScheduler::~LocalStorageRequestScheduler() = default;
+
+QUuid LocalStorageRequestScheduler::schedule(
+    QObject & requester, const Priority priority, Dispatcher dispatcher,
+    const QString & coalescingKey, const QString & supersedingKey)
+{
+    QNTRACE(
+        "model:request_scheduler",
+        "LocalStorageRequestScheduler::schedule: priority = "
+            << priority << ", coalescing key = " << coalescingKey
+            << ", superseding key = " << supersedingKey);
+
+    ++m_statistics.m_scheduledRequestsCount;
+
+    // Superseding keys are only unique within the requester
+    const QString requesterSupersedingKey =
+        (supersedingKey.isEmpty()
+             ? QString()
+             : LocalStorageRequestScheduler::supersedingKey(
+                   &requester, supersedingKey));
+
+    Requester item;
+    item.m_pRequester = &requester;
+    item.m_priority = priority;
+    item.m_dispatcher = std::move(dispatcher);
+    item.m_supersedingKey = requesterSupersedingKey;
+    item.m_scheduledAtMsec = m_clock.elapsed();
+
+    const int previousQueueDepth = queueDepth();
+
+    if (!requesterSupersedingKey.isEmpty()) {
+        auto it =
+            m_queuedRequestIdsBySupersedingKey.find(requesterSupersedingKey);
+
+        if (it != m_queuedRequestIdsBySupersedingKey.end()) {
+            const QUuid supersededRequestId = it.value();
+            m_queuedRequestIdsBySupersedingKey.erase(it);
+
+            QNDEBUG(
+                "model:request_scheduler",
+                "Dropping superseded request: " << supersededRequestId);
+
+            ++m_statistics.m_supersededRequestsCount;
+            dropRequester(supersededRequestId, &requester);
+        }
+    }
+
+    if (!coalescingKey.isEmpty()) {
+        auto it = m_queuedRequestIdsByCoalescingKey.constFind(coalescingKey);
+        if (it != m_queuedRequestIdsByCoalescingKey.constEnd()) {
+            const QUuid requestId = it.value();
+            auto & request = m_queuedRequests[requestId];
+
+            if (priorityIndex(priority) < priorityIndex(request.m_priority)) {
+                auto & queue = m_queues[priorityIndex(request.m_priority)];
+                queue.erase(std::find(queue.begin(), queue.end(), requestId));
+                m_queues[priorityIndex(priority)].push_back(requestId);
+                request.m_priority = priority;
+            }
+
+            request.m_requesters << item;
+
+            if (!requesterSupersedingKey.isEmpty()) {
+                m_queuedRequestIdsBySupersedingKey[requesterSupersedingKey] =
+                    requestId;
+            }
+
+            QNTRACE(
+                "model:request_scheduler",
+                "Merged the request with queued request " << requestId);
+
+            ++m_statistics.m_coalescedRequestsCount;
+
+            if (previousQueueDepth != queueDepth()) {
+                Q_EMIT queueDepthChanged(queueDepth());
+            }
+
+            return requestId;
+        }
+    }
+
+    const QUuid requestId = QUuid::createUuid();
+
+    Request request;
+    request.m_coalescingKey = coalescingKey;
+    request.m_priority = priority;
+    request.m_requesters << item;
+
+    m_queuedRequests[requestId] = request;
+    m_queues[priorityIndex(priority)].push_back(requestId);
+
+    if (!coalescingKey.isEmpty()) {
+        m_queuedRequestIdsByCoalescingKey[coalescingKey] = requestId;
+    }
+
+    if (!requesterSupersedingKey.isEmpty()) {
+        m_queuedRequestIdsBySupersedingKey[requesterSupersedingKey] =
+            requestId;
+    }
+
+    // Sends the new request right away if there is room for it
+    dispatchQueuedRequests();
+
+    if (previousQueueDepth != queueDepth()) {
+        Q_EMIT queueDepthChanged(queueDepth());
+    }
+
+    return requestId;
+}
+
+void LocalStorageRequestScheduler::sendDirectly(
+    const QUuid & requestId, const Dispatcher & dispatcher)
+{
+    QNTRACE(
+        "model:request_scheduler",
+        "LocalStorageRequestScheduler::sendDirectly: request id = "
+            << requestId);
+
+    Q_EMIT requestDispatched(requestId, 0);
+    dispatcher(requestId);
+}
+
+void LocalStorageRequestScheduler::cancelRequests(const QObject & requester)
+{
+    QNDEBUG(
+        "model:request_scheduler",
+        "LocalStorageRequestScheduler::cancelRequests");
+
+    const int previousQueueDepth = queueDepth();
+
+    const auto requestIds = m_queuedRequests.keys();
+    for (const auto & requestId: qAsConst(requestIds)) {
+        dropRequester(requestId, &requester);
+    }
+
+    const int currentQueueDepth = queueDepth();
+    if (previousQueueDepth != currentQueueDepth) {
+        m_statistics.m_cancelledRequestsCount +=
+            static_cast<quint64>(previousQueueDepth - currentQueueDepth);
+
+        Q_EMIT queueDepthChanged(currentQueueDepth);
+    }
+}
+
+int LocalStorageRequestScheduler::queueDepth(const Priority priority) const
+{
+    return static_cast<int>(m_queues[priorityIndex(priority)].size());
+}
+
+int LocalStorageRequestScheduler::queueDepth() const
+{
+    return m_queuedRequests.size();
+}
+
+const LocalStorageRequestScheduler::Statistics::LatencyBucketUpperBounds &
+LocalStorageRequestScheduler::Statistics::latencyBucketUpperBoundsMsec()
+{
+    static const LatencyBucketUpperBounds bounds = {
+        {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 5000}};
+
+    return bounds;
+}
+
+const LocalStorageRequestScheduler::Statistics::LatencyHistogram &
+LocalStorageRequestScheduler::latencyHistogram(const Priority priority) const
+{
+    return m_statistics.m_latencyHistograms[priorityIndex(priority)];
+}
+
+void LocalStorageRequestScheduler::checkForTimeouts()
+{
+    const qint64 now = m_clock.elapsed();
+
+    for (auto it = m_requestsInFlight.begin();
+         it != m_requestsInFlight.end();)
+    {
+        if (now - it.value().m_dispatchedAtMsec <
+            LOCAL_STORAGE_REQUEST_SCHEDULER_REQUEST_TIMEOUT_MSEC)
+        {
+            ++it;
+            continue;
+        }
+
+        QNWARNING(
+            "model:request_scheduler",
+            "Local storage didn't respond to request "
+                << it.key() << " in time, no longer waiting for it");
+
+        ++m_statistics.m_timedOutRequestsCount;
+        it = m_requestsInFlight.erase(it);
+    }
+
+    const int previousQueueDepth = queueDepth();
+    dispatchQueuedRequests();
+
+    if (previousQueueDepth != queueDepth()) {
+        Q_EMIT queueDepthChanged(queueDepth());
+    }
+}
+
+template <typename... Args>
+void LocalStorageRequestScheduler::trackRequestCompletion(
+    void (LocalStorageManagerAsync::*signal)(Args...))
+{
+    // Request id is the last argument of all local storage signals
+    QObject::connect(
+        &m_localStorageManagerAsync, signal, this, [this](Args... args) {
+            const auto arguments = std::forward_as_tuple(args...);
+            onRequestFinished(std::get<sizeof...(Args) - 1>(arguments));
+        });
+}
+
+void LocalStorageRequestScheduler::onRequestFinished(const QUuid & requestId)
+{
+    auto it = m_requestsInFlight.find(requestId);
+    if (it == m_requestsInFlight.end()) {
+        return;
+    }
+
+    QNTRACE(
+        "model:request_scheduler",
+        "LocalStorageRequestScheduler::onRequestFinished: " << requestId);
+
+    const qint64 now = m_clock.elapsed();
+    for (const auto & requester: qAsConst(it.value().m_requesters)) {
+        recordLatency(requester.m_priority, now - requester.m_scheduledAtMsec);
+    }
+
+    m_requestsInFlight.erase(it);
+
+    const int previousQueueDepth = queueDepth();
+    dispatchQueuedRequests();
+
+    if (previousQueueDepth != queueDepth()) {
+        Q_EMIT queueDepthChanged(queueDepth());
+    }
+}
+
+void LocalStorageRequestScheduler::dispatchQueuedRequests()
+{
+    while (m_requestsInFlight.size() < m_maxRequestsInFlight) {
+        auto queueIt = std::find_if(
+            m_queues.begin(), m_queues.end(),
+            [](const std::deque<QUuid> & queue) { return !queue.empty(); });
+
+        if (queueIt == m_queues.end()) {
+            break;
+        }
+
+        const QUuid requestId = queueIt->front();
+        auto request = m_queuedRequests.value(requestId);
+        removeQueuedRequest(requestId);
+
+        auto requesterIt = std::find_if(
+            request.m_requesters.constBegin(), request.m_requesters.constEnd(),
+            [](const Requester & requester) {
+                return !requester.m_pRequester.isNull();
+            });
+
+        if (requesterIt == request.m_requesters.constEnd()) {
+            QNDEBUG(
+                "model:request_scheduler",
+                "All requesters of request " << requestId
+                                             << " are gone, dropping it");
+            ++m_statistics.m_cancelledRequestsCount;
+            continue;
+        }
+
+        const auto dispatcher = requesterIt->m_dispatcher;
+
+        QNTRACE(
+            "model:request_scheduler",
+            "Dispatching request " << requestId << " with priority "
+                                   << request.m_priority);
+
+        request.m_dispatchedAtMsec = m_clock.elapsed();
+        m_requestsInFlight[requestId] = request;
+
+        if (!m_pTimeoutTimer->isActive()) {
+            m_pTimeoutTimer->start();
+        }
+
+        qint64 scheduledAtMsec = request.m_dispatchedAtMsec;
+        for (const auto & requester: qAsConst(request.m_requesters)) {
+            scheduledAtMsec =
+                std::min(scheduledAtMsec, requester.m_scheduledAtMsec);
+        }
+
+        Q_EMIT requestDispatched(
+            requestId, request.m_dispatchedAtMsec - scheduledAtMsec);
+
+        dispatcher(requestId);
+    }
+
+    if (m_requestsInFlight.isEmpty()) {
+        m_pTimeoutTimer->stop();
+    }
+}
+
+void LocalStorageRequestScheduler::recordLatency(
+    const Priority priority, const qint64 latencyMsec)
+{
+    const auto & bounds = Statistics::latencyBucketUpperBoundsMsec();
+    const auto bucket = static_cast<std::size_t>(std::distance(
+        bounds.begin(),
+        std::lower_bound(bounds.begin(), bounds.end(), latencyMsec)));
+
+    const int index = priorityIndex(priority);
+    ++m_statistics.m_latencyHistograms[index][bucket];
+
+    auto & maxLatency = m_statistics.m_maxLatenciesMsec[index];
+    maxLatency = std::max(maxLatency, latencyMsec);
+}
+
+void LocalStorageRequestScheduler::removeQueuedRequest(const QUuid & requestId)
+{
+    auto it = m_queuedRequests.find(requestId);
+    if (it == m_queuedRequests.end()) {
+        return;
+    }
+
+    const auto & request = it.value();
+
+    auto & queue = m_queues[priorityIndex(request.m_priority)];
+    auto queueIt = std::find(queue.begin(), queue.end(), requestId);
+    if (queueIt != queue.end()) {
+        queue.erase(queueIt);
+    }
+
+    if (!request.m_coalescingKey.isEmpty()) {
+        auto keyIt =
+            m_queuedRequestIdsByCoalescingKey.find(request.m_coalescingKey);
+
+        if ((keyIt != m_queuedRequestIdsByCoalescingKey.end()) &&
+            (keyIt.value() == requestId))
+        {
+            m_queuedRequestIdsByCoalescingKey.erase(keyIt);
+        }
+    }
+
+    for (const auto & requester: qAsConst(request.m_requesters)) {
+        if (requester.m_supersedingKey.isEmpty()) {
+            continue;
+        }
+
+        auto keyIt =
+            m_queuedRequestIdsBySupersedingKey.find(requester.m_supersedingKey);
+
+        if ((keyIt != m_queuedRequestIdsBySupersedingKey.end()) &&
+            (keyIt.value() == requestId))
+        {
+            m_queuedRequestIdsBySupersedingKey.erase(keyIt);
+        }
+    }
+
+    m_queuedRequests.erase(it);
+}
+
+void LocalStorageRequestScheduler::dropRequester(
+    const QUuid & requestId, const QObject * pRequester)
+{
+    auto it = m_queuedRequests.find(requestId);
+    if (it == m_queuedRequests.end()) {
+        return;
+    }
+
+    auto & requesters = it.value().m_requesters;
+    for (auto requesterIt = requesters.begin();
+         requesterIt != requesters.end();)
+    {
+        if (requesterIt->m_pRequester.data() != pRequester) {
+            ++requesterIt;
+            continue;
+        }
+
+        if (!requesterIt->m_supersedingKey.isEmpty()) {
+            auto keyIt = m_queuedRequestIdsBySupersedingKey.find(
+                requesterIt->m_supersedingKey);
+
+            if ((keyIt != m_queuedRequestIdsBySupersedingKey.end()) &&
+                (keyIt.value() == requestId))
+            {
+                m_queuedRequestIdsBySupersedingKey.erase(keyIt);
+            }
+        }
+
+        requesterIt = requesters.erase(requesterIt);
+    }
+
+    if (requesters.isEmpty()) {
+        removeQueuedRequest(requestId);
+    }
+}
+
+QString LocalStorageRequestScheduler::supersedingKey(
+    const QObject * pRequester, const QString & key)
+{
+    return QString::number(reinterpret_cast<quintptr>(pRequester), 16) +
+        QStringLiteral(":") + key;
+}
+
+QDebug & operator<<(
+    QDebug & dbg, const LocalStorageRequestScheduler::Priority priority)
+{
+    using Priority = LocalStorageRequestScheduler::Priority;
+
+    switch (priority) {
+    case Priority::Interactive:
+        dbg << "Interactive";
+        break;
+    case Priority::VisibleView:
+        dbg << "Visible view";
+        break;
+    case Priority::Background:
+        dbg << "Background";
+        break;
+    default:
+        dbg << "Unknown (" << static_cast<qint64>(priority) << ")";
+        break;
+    }
+
+    return dbg;
+}
+
+QUuid scheduleLocalStorageRequest(
+    LocalStorageRequestScheduler * pScheduler, QObject & requester,
+    const LocalStorageRequestScheduler::Priority priority,
+    LocalStorageRequestScheduler::Dispatcher dispatcher,
+    const QString & coalescingKey, const QString & supersedingKey)
+{
+    if (pScheduler) {
+        return pScheduler->schedule(
+            requester, priority, std::move(dispatcher), coalescingKey,
+            supersedingKey);
+    }
+
+    const QUuid requestId = QUuid::createUuid();
+    dispatcher(requestId);
+    return requestId;
+}
+
+void sendLocalStorageRequest(
+    LocalStorageRequestScheduler * pScheduler, const QUuid & requestId,
+    const LocalStorageRequestScheduler::Dispatcher & dispatcher)
+{
+    if (pScheduler) {
+        pScheduler->sendDirectly(requestId, dispatcher);
+        return;
+    }
+
+    dispatcher(requestId);
+}
+
+} // namespace quentier
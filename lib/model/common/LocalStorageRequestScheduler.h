@@ -0,0 +1,351 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_MODEL_COMMON_LOCAL_STORAGE_REQUEST_SCHEDULER_H
+#define QUENTIER_LIB_MODEL_COMMON_LOCAL_STORAGE_REQUEST_SCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QUuid>
+#include <QVector>
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+
+#define LOCAL_STORAGE_REQUEST_SCHEDULER_DEFAULT_MAX_REQUESTS_IN_FLIGHT (2)
+
+// If local storage doesn't respond to the dispatched request within this
+// time, the scheduler stops waiting for it so that the rest of requests are
+// not stuck in the queue forever
+#define LOCAL_STORAGE_REQUEST_SCHEDULER_REQUEST_TIMEOUT_MSEC (30000)
+
+#define LOCAL_STORAGE_REQUEST_SCHEDULER_LATENCY_BUCKET_COUNT (12)
+
+QT_FORWARD_DECLARE_CLASS(QDebug)
+QT_FORWARD_DECLARE_CLASS(QTimer)
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
+
+/**
+ * @brief The LocalStorageRequestScheduler class orders the read requests sent
+ * to LocalStorageManagerAsync by their priority instead of sending them in
+ * the order in which they were issued
+ *
+ * Local storage processes the requests one by one in FIFO order so once
+ * a request is sent, all the requests sent after it have to wait for it.
+ * The scheduler keeps only a few requests in flight and holds the rest in
+ * per priority queues so that the request issued in response to user's
+ * action doesn't wait behind a bunch of background ones.
+ *
+ * Requesters don't talk to the scheduler when results arrive: they keep
+ * listening to LocalStorageManagerAsync signals and matching request ids
+ * as before. The scheduler only decides when the request is sent; for that
+ * the requester passes a dispatcher which sends the request with the given
+ * id i.e. emits the requester's signal connected to local storage.
+ *
+ * Queued requests with equal non-empty coalescing keys are merged into one:
+ * the id of the already queued request is returned to the requester which
+ * must track that id instead of its own one. Only the requests which are
+ * interchangeable for all requesters, for example finding the notebook by
+ * local uid, should have coalescing keys. Requests already sent to local
+ * storage are never merged with new ones as the results of the former might
+ * be outdated by the time the latter are issued.
+ *
+ * The queued request of some requester is dropped if the same requester
+ * schedules another request with the same non-empty superseding key. Such
+ * requester must no longer be interested in the results of the superseded
+ * request, for example because it has already reset its request id.
+ *
+ * Write requests are not meant to wait in the scheduler's queues: they are
+ * sent right away via sendDirectly and thus overtake all the queued read
+ * requests. The scheduler only reports them via requestDispatched signal so
+ * that they are traced along with the scheduled ones.
+ */
+class LocalStorageRequestScheduler final : public QObject
+{
+    Q_OBJECT
+public:
+    enum class Priority
+    {
+        // Requests issued in response to user's actions
+        Interactive = 0,
+        // Requests for data displayed in views
+        VisibleView,
+        // Requests for auxiliary data such as note counts
+        Background
+    };
+
+    friend QDebug & operator<<(QDebug & dbg, const Priority priority);
+
+    using Dispatcher = std::function<void(const QUuid &)>;
+
+    explicit LocalStorageRequestScheduler(
+        LocalStorageManagerAsync & localStorageManagerAsync,
+        const int maxRequestsInFlight =
+            LOCAL_STORAGE_REQUEST_SCHEDULER_DEFAULT_MAX_REQUESTS_IN_FLIGHT,
+        QObject * parent = nullptr);
+
+    virtual ~LocalStorageRequestScheduler() override;
+
+    /**
+     * @brief schedule method schedules sending the request to local storage
+     *
+     * @param requester         The object issuing the request; the request
+     *                          is not sent on behalf of destroyed requester
+     * @param priority          Priority of the request
+     * @param dispatcher        Function sending the request with the given id
+     *                          to local storage; it can be called from within
+     *                          schedule method
+     * @param coalescingKey     Key identifying interchangeable requests
+     * @param supersedingKey    Key identifying the requests of the same
+     *                          requester superseding each other
+     * @return                  The id of the request results of which
+     *                          the requester should wait for
+     */
+    QUuid schedule(
+        QObject & requester, const Priority priority, Dispatcher dispatcher,
+        const QString & coalescingKey = QString(),
+        const QString & supersedingKey = QString());
+
+    /**
+     * @brief cancelRequests method drops all the queued requests of the given
+     * requester; the requests merged with the ones of other requesters are
+     * still sent on behalf of those other requesters
+     */
+    void cancelRequests(const QObject & requester);
+
+    /**
+     * @brief sendDirectly method sends the request to local storage right
+     * away bypassing the queues and the limit of requests in flight
+     *
+     * @param requestId         Id of the request to send
+     * @param dispatcher        Function sending the request with the given id
+     *                          to local storage; it is called from within
+     *                          this method
+     */
+    void sendDirectly(const QUuid & requestId, const Dispatcher & dispatcher);
+
+    /**
+     * @return      Number of requests waiting in the queue of the given
+     *              priority
+     */
+    int queueDepth(const Priority priority) const;
+
+    /**
+     * @return      Total number of requests waiting in the queues
+     */
+    int queueDepth() const;
+
+    int requestsInFlight() const
+    {
+        return m_requestsInFlight.size();
+    }
+
+    int maxRequestsInFlight() const
+    {
+        return m_maxRequestsInFlight;
+    }
+
+    /**
+     * @brief The Statistics struct contains the counters of requests passed
+     * through the scheduler and the histograms of requests' latencies
+     *
+     * The latency is the time from scheduling the request until local storage
+     * responds to it, so it includes the time spent in the queue. For merged
+     * requests the latency is counted for each requester separately.
+     */
+    struct Statistics
+    {
+        using LatencyHistogram = std::array<
+            quint64, LOCAL_STORAGE_REQUEST_SCHEDULER_LATENCY_BUCKET_COUNT>;
+
+        using LatencyBucketUpperBounds = std::array<
+            qint64, LOCAL_STORAGE_REQUEST_SCHEDULER_LATENCY_BUCKET_COUNT - 1>;
+
+        /**
+         * @return      The upper bounds in milliseconds of latency histogram
+         *              buckets; the last bucket has no upper bound and
+         *              contains all latencies greater than the previous
+         *              bucket's bound
+         */
+        static const LatencyBucketUpperBounds & latencyBucketUpperBoundsMsec();
+
+        quint64 m_scheduledRequestsCount = 0;
+        quint64 m_coalescedRequestsCount = 0;
+        quint64 m_supersededRequestsCount = 0;
+        quint64 m_cancelledRequestsCount = 0;
+        quint64 m_timedOutRequestsCount = 0;
+
+        std::array<LatencyHistogram, 3> m_latencyHistograms = {};
+        std::array<qint64, 3> m_maxLatenciesMsec = {};
+    };
+
+    const Statistics & statistics() const
+    {
+        return m_statistics;
+    }
+
+    const Statistics::LatencyHistogram & latencyHistogram(
+        const Priority priority) const;
+
+Q_SIGNALS:
+    /**
+     * @brief queueDepthChanged signal is emitted when the number of queued
+     * requests changes
+     */
+    void queueDepthChanged(int queueDepth);
+
+    /**
+     * @brief requestDispatched signal is emitted right before the request is
+     * sent to local storage
+     *
+     * @param requestId         Id of the request being sent
+     * @param queueWaitMsec     Time the request has spent in the queue; for
+     *                          merged requests the time since the earliest
+     *                          of them was scheduled
+     */
+    void requestDispatched(QUuid requestId, qint64 queueWaitMsec);
+
+private Q_SLOTS:
+    void checkForTimeouts();
+
+private:
+    template <typename... Args>
+    void trackRequestCompletion(
+        void (LocalStorageManagerAsync::*signal)(Args...));
+
+    void onRequestFinished(const QUuid & requestId);
+
+    void dispatchQueuedRequests();
+    void recordLatency(const Priority priority, const qint64 latencyMsec);
+
+    struct Requester
+    {
+        QPointer<QObject> m_pRequester;
+        Priority m_priority = Priority::Background;
+        Dispatcher m_dispatcher;
+        // Superseding key prefixed with requester's address
+        QString m_supersedingKey;
+        qint64 m_scheduledAtMsec = 0;
+    };
+
+    struct Request
+    {
+        QString m_coalescingKey;
+        Priority m_priority = Priority::Background;
+        QVector<Requester> m_requesters;
+        qint64 m_dispatchedAtMsec = 0;
+    };
+
+    void removeQueuedRequest(const QUuid & requestId);
+    void dropRequester(const QUuid & requestId, const QObject * pRequester);
+
+    static QString supersedingKey(
+        const QObject * pRequester, const QString & key);
+
+    static constexpr int priorityIndex(const Priority priority)
+    {
+        return static_cast<int>(priority);
+    }
+
+private:
+    Q_DISABLE_COPY(LocalStorageRequestScheduler)
+
+private:
+    LocalStorageManagerAsync & m_localStorageManagerAsync;
+    const int m_maxRequestsInFlight;
+
+    QElapsedTimer m_clock;
+    QTimer * m_pTimeoutTimer = nullptr;
+
+    std::array<std::deque<QUuid>, 3> m_queues;
+
+    QHash<QUuid, Request> m_queuedRequests;
+    QHash<QUuid, Request> m_requestsInFlight;
+
+    QHash<QString, QUuid> m_queuedRequestIdsByCoalescingKey;
+    QHash<QString, QUuid> m_queuedRequestIdsBySupersedingKey;
+
+    Statistics m_statistics;
+};
+
+inline QString localStorageRequestKeyPart(const QString & value)
+{
+    return value;
+}
+
+template <typename T>
+QString localStorageRequestKeyPart(const T & value)
+{
+    return QString::number(static_cast<qint64>(value));
+}
+
+/**
+ * @brief localStorageRequestKey function composes the coalescing key for
+ * the request from its name and its parameters other than request id
+ *
+ * Requesters issuing the same kind of request should use the same name and
+ * parameters order so that their requests can be merged.
+ */
+template <typename... Args>
+QString localStorageRequestKey(const char * requestName, const Args &... args)
+{
+    QString key = QString::fromUtf8(requestName);
+
+    const std::initializer_list<QString> parts = {
+        localStorageRequestKeyPart(args)...};
+
+    for (const auto & part: parts) {
+        key += QStringLiteral(":");
+        key += part;
+    }
+
+    return key;
+}
+
+/**
+ * @brief scheduleLocalStorageRequest function schedules the request via
+ * the scheduler if it is not null or sends it right away otherwise
+ *
+ * @return      The id of the request results of which the requester should
+ *              wait for
+ */
+QUuid scheduleLocalStorageRequest(
+    LocalStorageRequestScheduler * pScheduler, QObject & requester,
+    const LocalStorageRequestScheduler::Priority priority,
+    LocalStorageRequestScheduler::Dispatcher dispatcher,
+    const QString & coalescingKey = QString(),
+    const QString & supersedingKey = QString());
+
+/**
+ * @brief sendLocalStorageRequest function sends the request to local storage
+ * right away via the scheduler if it is not null or by itself otherwise
+ */
+void sendLocalStorageRequest(
+    LocalStorageRequestScheduler * pScheduler, const QUuid & requestId,
+    const LocalStorageRequestScheduler::Dispatcher & dispatcher);
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_MODEL_COMMON_LOCAL_STORAGE_REQUEST_SCHEDULER_H
@@ -0,0 +1,430 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStorageRequestTracer.h"
+#include "LocalStorageRequestScheduler.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/local_storage/LocalStorageManagerAsync.h>
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+#include <algorithm>
+#include <tuple>
+
+namespace quentier {
+
+namespace {
+
+// Number of data items carried by the argument of local storage's response
+// signal; arguments other than the found data items don't count
+
+template <typename T>
+quint64 payloadSize(const T &)
+{
+    return 0;
+}
+
+template <typename T>
+quint64 payloadSize(const QList<T> & items)
+{
+    return static_cast<quint64>(std::max(items.size(), 0));
+}
+
+template <typename Key, typename Value>
+quint64 payloadSize(const QHash<Key, Value> & items)
+{
+    return static_cast<quint64>(std::max(items.size(), 0));
+}
+
+// Local uids used as the request's parameters
+quint64 payloadSize(const QStringList &)
+{
+    return 0;
+}
+
+quint64 payloadSize(const Note &)
+{
+    return 1;
+}
+
+quint64 payloadSize(const Notebook &)
+{
+    return 1;
+}
+
+quint64 payloadSize(const Tag &)
+{
+    return 1;
+}
+
+quint64 payloadSize(const SavedSearch &)
+{
+    return 1;
+}
+
+template <typename... Args>
+quint64 totalPayloadSize(const Args &... args)
+{
+    quint64 result = 0;
+    for (const auto size: {quint64(0), payloadSize(args)...}) {
+        result += size;
+    }
+
+    return result;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+LocalStorageRequestTracer::LocalStorageRequestTracer(
+    LocalStorageManagerAsync & localStorageManagerAsync,
+    LocalStorageRequestScheduler & requestScheduler, QObject * parent) :
+    QObject(parent),
+    m_localStorageManagerAsync(localStorageManagerAsync),
+    m_pExpiryTimer(new QTimer(this))
+{
+    m_clock.start();
+
+    m_pExpiryTimer->setInterval(
+        LOCAL_STORAGE_REQUEST_SCHEDULER_REQUEST_TIMEOUT_MSEC / 2);
+
+    QObject::connect(
+        m_pExpiryTimer, &QTimer::timeout, this,
+        &LocalStorageRequestTracer::expireRequests);
+
+    QObject::connect(
+        &requestScheduler, &LocalStorageRequestScheduler::requestDispatched,
+        this, &LocalStorageRequestTracer::onRequestDispatched);
+
+    using LSMA = LocalStorageManagerAsync;
+
+    traceResponses(
+        &LSMA::findNoteComplete, &LSMA::findNoteFailed,
+        QStringLiteral("findNote"));
+
+    traceResponses(
+        &LSMA::findNotebookComplete, &LSMA::findNotebookFailed,
+        QStringLiteral("findNotebook"));
+
+    traceResponses(
+        &LSMA::findTagComplete, &LSMA::findTagFailed,
+        QStringLiteral("findTag"));
+
+    traceResponses(
+        &LSMA::findSavedSearchComplete, &LSMA::findSavedSearchFailed,
+        QStringLiteral("findSavedSearch"));
+
+    traceResponses(
+        &LSMA::listNotesComplete, &LSMA::listNotesFailed,
+        QStringLiteral("listNotes"));
+
+    traceResponses(
+        &LSMA::listNotesByLocalUidsComplete, &LSMA::listNotesByLocalUidsFailed,
+        QStringLiteral("listNotesByLocalUids"));
+
+    traceResponses(
+        &LSMA::listNotesPerNotebooksAndTagsComplete,
+        &LSMA::listNotesPerNotebooksAndTagsFailed,
+        QStringLiteral("listNotesPerNotebooksAndTags"));
+
+    traceResponses(
+        &LSMA::listNotebooksComplete, &LSMA::listNotebooksFailed,
+        QStringLiteral("listNotebooks"));
+
+    traceResponses(
+        &LSMA::listTagsComplete, &LSMA::listTagsFailed,
+        QStringLiteral("listTags"));
+
+    traceResponses(
+        &LSMA::listSavedSearchesComplete, &LSMA::listSavedSearchesFailed,
+        QStringLiteral("listSavedSearches"));
+
+    traceResponses(
+        &LSMA::listAllLinkedNotebooksComplete,
+        &LSMA::listAllLinkedNotebooksFailed,
+        QStringLiteral("listAllLinkedNotebooks"));
+
+    traceResponses(
+        &LSMA::getNoteCountComplete, &LSMA::getNoteCountFailed,
+        QStringLiteral("getNoteCount"));
+
+    traceResponses(
+        &LSMA::getNoteCountPerNotebookComplete,
+        &LSMA::getNoteCountPerNotebookFailed,
+        QStringLiteral("getNoteCountPerNotebook"));
+
+    traceResponses(
+        &LSMA::getNoteCountPerTagComplete, &LSMA::getNoteCountPerTagFailed,
+        QStringLiteral("getNoteCountPerTag"));
+
+    traceResponses(
+        &LSMA::getNoteCountsPerAllTagsComplete,
+        &LSMA::getNoteCountsPerAllTagsFailed,
+        QStringLiteral("getNoteCountsPerAllTags"));
+
+    traceResponses(
+        &LSMA::getNoteCountPerNotebooksAndTagsComplete,
+        &LSMA::getNoteCountPerNotebooksAndTagsFailed,
+        QStringLiteral("getNoteCountPerNotebooksAndTags"));
+
+    traceResponses(
+        &LSMA::listAllTagsPerNoteComplete, &LSMA::listAllTagsPerNoteFailed,
+        QStringLiteral("listAllTagsPerNote"));
+
+    traceResponses(
+        &LSMA::addNoteComplete, &LSMA::addNoteFailed,
+        QStringLiteral("addNote"));
+
+    traceResponses(
+        &LSMA::updateNoteComplete, &LSMA::updateNoteFailed,
+        QStringLiteral("updateNote"));
+
+    traceResponses(
+        &LSMA::expungeNoteComplete, &LSMA::expungeNoteFailed,
+        QStringLiteral("expungeNote"));
+
+    traceResponses(
+        &LSMA::addNotebookComplete, &LSMA::addNotebookFailed,
+        QStringLiteral("addNotebook"));
+
+    traceResponses(
+        &LSMA::updateNotebookComplete, &LSMA::updateNotebookFailed,
+        QStringLiteral("updateNotebook"));
+
+    traceResponses(
+        &LSMA::expungeNotebookComplete, &LSMA::expungeNotebookFailed,
+        QStringLiteral("expungeNotebook"));
+
+    traceResponses(
+        &LSMA::addTagComplete, &LSMA::addTagFailed, QStringLiteral("addTag"));
+
+    traceResponses(
+        &LSMA::updateTagComplete, &LSMA::updateTagFailed,
+        QStringLiteral("updateTag"));
+
+    traceResponses(
+        &LSMA::expungeTagComplete, &LSMA::expungeTagFailed,
+        QStringLiteral("expungeTag"));
+
+    traceResponses(
+        &LSMA::addSavedSearchComplete, &LSMA::addSavedSearchFailed,
+        QStringLiteral("addSavedSearch"));
+
+    traceResponses(
+        &LSMA::updateSavedSearchComplete, &LSMA::updateSavedSearchFailed,
+        QStringLiteral("updateSavedSearch"));
+
+    traceResponses(
+        &LSMA::expungeSavedSearchComplete, &LSMA::expungeSavedSearchFailed,
+        QStringLiteral("expungeSavedSearch"));
+}
+
+LocalStorageRequestTracer::~LocalStorageRequestTracer() = default;
+
+void LocalStorageRequestTracer::reset()
+{
+    QNDEBUG("model:request_tracer", "LocalStorageRequestTracer::reset");
+    m_statistics.clear();
+    m_expiredRequestsCount = 0;
+}
+
+bool LocalStorageRequestTracer::exportToFile(
+    const QString & filePath, ErrorString & errorDescription) const
+{
+    QNDEBUG(
+        "model:request_tracer",
+        "LocalStorageRequestTracer::exportToFile: " << filePath);
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't open the file to export local storage request "
+                       "statistics to"));
+        errorDescription.details() = file.errorString();
+        QNWARNING("model:request_tracer", errorDescription);
+        return false;
+    }
+
+    const auto average = [](const qint64 total, const quint64 count) {
+        return (count == 0 ? 0.0
+                           : static_cast<double>(total) /
+                    static_cast<double>(count));
+    };
+
+    QTextStream strm(&file);
+
+    strm << "request_type,requests,failed_requests,avg_latency_msec,"
+         << "max_latency_msec,avg_queue_wait_msec,max_queue_wait_msec,"
+         << "avg_payload_size,max_payload_size\n";
+
+    for (auto it = m_statistics.constBegin(), end = m_statistics.constEnd();
+         it != end; ++it)
+    {
+        const auto & statistics = it.value();
+        const quint64 count = statistics.m_requestsCount;
+
+        strm << it.key() << "," << count << ","
+             << statistics.m_failedRequestsCount << ","
+             << average(statistics.m_totalLatencyMsec, count) << ","
+             << statistics.m_maxLatencyMsec << ","
+             << average(statistics.m_totalQueueWaitMsec, count) << ","
+             << statistics.m_maxQueueWaitMsec << ","
+             << average(
+                    static_cast<qint64>(statistics.m_totalPayloadSize), count)
+             << "," << statistics.m_maxPayloadSize << "\n";
+    }
+
+    strm.flush();
+
+    if (strm.status() != QTextStream::Ok) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to write local storage request statistics "
+                       "to file"));
+        errorDescription.details() = file.errorString();
+        QNWARNING("model:request_tracer", errorDescription);
+        return false;
+    }
+
+    return true;
+}
+
+void LocalStorageRequestTracer::onRequestDispatched(
+    QUuid requestId, qint64 queueWaitMsec)
+{
+    auto & request = m_requestsInFlight[requestId];
+    request.m_dispatchedAtMsec = m_clock.elapsed();
+    request.m_queueWaitMsec = queueWaitMsec;
+
+    if (!m_pExpiryTimer->isActive()) {
+        m_pExpiryTimer->start();
+    }
+}
+
+void LocalStorageRequestTracer::expireRequests()
+{
+    const qint64 now = m_clock.elapsed();
+
+    for (auto it = m_requestsInFlight.begin();
+         it != m_requestsInFlight.end();)
+    {
+        if (now - it.value().m_dispatchedAtMsec <
+            LOCAL_STORAGE_REQUEST_SCHEDULER_REQUEST_TIMEOUT_MSEC)
+        {
+            ++it;
+            continue;
+        }
+
+        QNDEBUG(
+            "model:request_tracer",
+            "No response to request " << it.key()
+                                      << " within the timeout, won't trace "
+                                      << "it anymore");
+
+        ++m_expiredRequestsCount;
+        it = m_requestsInFlight.erase(it);
+    }
+
+    if (m_requestsInFlight.isEmpty()) {
+        m_pExpiryTimer->stop();
+    }
+}
+
+template <typename... CompleteArgs, typename... FailedArgs>
+void LocalStorageRequestTracer::traceResponses(
+    void (LocalStorageManagerAsync::*completeSignal)(CompleteArgs...),
+    void (LocalStorageManagerAsync::*failedSignal)(FailedArgs...),
+    const QString & requestType)
+{
+    traceResponse(completeSignal, requestType, true);
+    traceResponse(failedSignal, requestType, false);
+}
+
+template <typename... Args>
+void LocalStorageRequestTracer::traceResponse(
+    void (LocalStorageManagerAsync::*signal)(Args...),
+    const QString & requestType, const bool success)
+{
+    // Request id is the last argument of all local storage signals
+    QObject::connect(
+        &m_localStorageManagerAsync, signal, this,
+        [this, requestType, success](Args... args) {
+            const auto arguments = std::forward_as_tuple(args...);
+            const QUuid & requestId =
+                std::get<sizeof...(Args) - 1>(arguments);
+
+            // Requests sent by other components (synchronization, note
+            // editor etc.) are not traced, no need to count the payload for
+            // responses to them
+            if (!m_requestsInFlight.contains(requestId)) {
+                return;
+            }
+
+            onResponse(
+                requestId, requestType, success, totalPayloadSize(args...));
+        });
+}
+
+void LocalStorageRequestTracer::onResponse(
+    const QUuid & requestId, const QString & requestType, const bool success,
+    const quint64 payloadSize)
+{
+    auto it = m_requestsInFlight.find(requestId);
+    if (it == m_requestsInFlight.end()) {
+        return;
+    }
+
+    const auto & request = it.value();
+    const qint64 latencyMsec = m_clock.elapsed() - request.m_dispatchedAtMsec;
+    const qint64 queueWaitMsec = request.m_queueWaitMsec;
+    m_requestsInFlight.erase(it);
+
+    QNTRACE(
+        "model:request_tracer",
+        "Local storage responded to " << requestType << " request "
+                                      << requestId << " in " << latencyMsec
+                                      << " msec after " << queueWaitMsec
+                                      << " msec in queue, payload size = "
+                                      << payloadSize);
+
+    auto & statistics = m_statistics[requestType];
+
+    ++statistics.m_requestsCount;
+    if (!success) {
+        ++statistics.m_failedRequestsCount;
+    }
+
+    statistics.m_totalLatencyMsec += latencyMsec;
+    statistics.m_maxLatencyMsec =
+        std::max(statistics.m_maxLatencyMsec, latencyMsec);
+
+    statistics.m_totalQueueWaitMsec += queueWaitMsec;
+    statistics.m_maxQueueWaitMsec =
+        std::max(statistics.m_maxQueueWaitMsec, queueWaitMsec);
+
+    statistics.m_totalPayloadSize += payloadSize;
+    statistics.m_maxPayloadSize =
+        std::max(statistics.m_maxPayloadSize, payloadSize);
+}
+
+} // namespace quentier
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_MODEL_COMMON_LOCAL_STORAGE_REQUEST_TRACER_H
+#define QUENTIER_LIB_MODEL_COMMON_LOCAL_STORAGE_REQUEST_TRACER_H
+
+#include <quentier/types/ErrorString.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QUuid>
+
+QT_FORWARD_DECLARE_CLASS(QTimer)
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
+QT_FORWARD_DECLARE_CLASS(LocalStorageRequestScheduler)
+
+/**
+ * @brief The LocalStorageRequestTracer class collects timings of requests
+ * which models send to local storage through LocalStorageRequestScheduler
+ *
+ * Read requests are queued by the scheduler while writes are sent to local
+ * storage right away via LocalStorageRequestScheduler::sendDirectly so that
+ * both are traced. For each type of request the tracer records how long
+ * the requests waited in the scheduler's queue (always zero for writes),
+ * how long local storage took to respond to them once sent and how many items
+ * the responses carried. Together these tell
+ * whether the slowness comes from the storage thread or from the requests
+ * piling up in the queue.
+ *
+ * Requests local storage doesn't respond to within the scheduler's timeout
+ * stop being traced as the scheduler stops waiting for them too.
+ */
+class LocalStorageRequestTracer final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LocalStorageRequestTracer(
+        LocalStorageManagerAsync & localStorageManagerAsync,
+        LocalStorageRequestScheduler & requestScheduler,
+        QObject * parent = nullptr);
+
+    virtual ~LocalStorageRequestTracer() override;
+
+    struct Statistics
+    {
+        quint64 m_requestsCount = 0;
+        quint64 m_failedRequestsCount = 0;
+
+        // Time from sending the request until local storage responded to it
+        qint64 m_totalLatencyMsec = 0;
+        qint64 m_maxLatencyMsec = 0;
+
+        // Time the request has spent in the scheduler's queue before sending
+        qint64 m_totalQueueWaitMsec = 0;
+        qint64 m_maxQueueWaitMsec = 0;
+
+        // Number of data items (notes, notebooks, note counts etc.) carried by
+        // the response
+        quint64 m_totalPayloadSize = 0;
+        quint64 m_maxPayloadSize = 0;
+    };
+
+    /**
+     * @return      Statistics per request type; request types are named after
+     *              local storage's requests, like "listNotes" or
+     *              "getNoteCountPerTag"
+     */
+    const QMap<QString, Statistics> & statistics() const
+    {
+        return m_statistics;
+    }
+
+    /**
+     * @return      Number of sent requests local storage hasn't responded to
+     *              yet
+     */
+    int requestsInFlight() const
+    {
+        return m_requestsInFlight.size();
+    }
+
+    /**
+     * @return      Number of sent requests local storage hasn't responded to
+     *              within the timeout
+     */
+    quint64 expiredRequestsCount() const
+    {
+        return m_expiredRequestsCount;
+    }
+
+    /**
+     * @brief reset method drops the collected statistics and the number of
+     * expired requests; requests in flight are still traced
+     */
+    void reset();
+
+    /**
+     * @brief exportToFile method writes the collected statistics into
+     * the file in CSV format, one line per request type
+     *
+     * @param filePath          Path to the file to write the statistics to;
+     *                          the file is overwritten if it exists
+     * @param errorDescription  Textual description of the error if
+     *                          the statistics could not be written
+     * @return                  True on success, false otherwise
+     */
+    bool exportToFile(
+        const QString & filePath, ErrorString & errorDescription) const;
+
+private Q_SLOTS:
+    void onRequestDispatched(QUuid requestId, qint64 queueWaitMsec);
+    void expireRequests();
+
+private:
+    template <typename... CompleteArgs, typename... FailedArgs>
+    void traceResponses(
+        void (LocalStorageManagerAsync::*completeSignal)(CompleteArgs...),
+        void (LocalStorageManagerAsync::*failedSignal)(FailedArgs...),
+        const QString & requestType);
+
+    template <typename... Args>
+    void traceResponse(
+        void (LocalStorageManagerAsync::*signal)(Args...),
+        const QString & requestType, const bool success);
+
+    void onResponse(
+        const QUuid & requestId, const QString & requestType,
+        const bool success, const quint64 payloadSize);
+
+private:
+    Q_DISABLE_COPY(LocalStorageRequestTracer)
+
+private:
+    struct Request
+    {
+        qint64 m_dispatchedAtMsec = 0;
+        qint64 m_queueWaitMsec = 0;
+    };
+
+    LocalStorageManagerAsync & m_localStorageManagerAsync;
+
+    QElapsedTimer m_clock;
+    QHash<QUuid, Request> m_requestsInFlight;
+    QTimer * m_pExpiryTimer;
+    quint64 m_expiredRequestsCount = 0;
+    QMap<QString, Statistics> m_statistics;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_MODEL_COMMON_LOCAL_STORAGE_REQUEST_TRACER_H
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ModelItemMimeData.h"
+
+#include <utility>
+
+namespace quentier {
+
+ModelItemMimeData::ModelItemMimeData(
+    QString mimeType, const qint32 itemType, QString itemLocalUid,
+    QString itemGuid, Encoder encoder) :
+    m_mimeType(std::move(mimeType)),
+    m_itemType(itemType), m_itemLocalUid(std::move(itemLocalUid)),
+    m_itemGuid(std::move(itemGuid)), m_encoder(std::move(encoder))
+{}
+
+ModelItemMimeData::~ModelItemMimeData() = default;
+
+QStringList ModelItemMimeData::formats() const
+{
+    return QStringList() << m_mimeType;
+}
+
+bool ModelItemMimeData::hasFormat(const QString & mimeType) const
+{
+    return mimeType == m_mimeType;
+}
+
+QVariant ModelItemMimeData::retrieveData(
+    const QString & mimeType, QVariant::Type type) const
+{
+    if (mimeType != m_mimeType) {
+        return QMimeData::retrieveData(mimeType, type);
+    }
+
+    if (m_encodedData.isEmpty() && m_encoder) {
+        m_encodedData =
+            qCompress(m_encoder(), MODEL_ITEM_MIME_DATA_COMPRESSION_LEVEL);
+    }
+
+    return m_encodedData;
+}
+
+} // namespace quentier
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_MODEL_COMMON_MODEL_ITEM_MIME_DATA_H
+#define QUENTIER_LIB_MODEL_COMMON_MODEL_ITEM_MIME_DATA_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QMimeData>
+
+#include <functional>
+
+// Serialized items are only needed for drags to other processes which are
+// rare so it's not worth making the user wait for stronger compression
+#define MODEL_ITEM_MIME_DATA_COMPRESSION_LEVEL (1)
+
+namespace quentier {
+
+/**
+ * @brief The ModelItemMimeData class is the mime data for items dragged
+ * from tag or notebook models
+ *
+ * Within the process the dragged item is referred to by its type, local uid
+ * and guid which are readily available so starting the drag costs nothing.
+ * The serialized and compressed item is only produced if some other process
+ * asks for the data in the item model's mime type.
+ */
+class ModelItemMimeData final : public QMimeData
+{
+    Q_OBJECT
+public:
+    using Encoder = std::function<QByteArray()>;
+
+    /**
+     * @param mimeType      Item model's mime type
+     * @param itemType      Type of the dragged item within its model
+     * @param itemLocalUid  Local uid of the dragged item
+     * @param itemGuid      Guid of the dragged item, if any
+     * @param encoder       Callback serializing the item into the format
+     *                      of the item model's mime data
+     */
+    explicit ModelItemMimeData(
+        QString mimeType, const qint32 itemType, QString itemLocalUid,
+        QString itemGuid, Encoder encoder);
+
+    virtual ~ModelItemMimeData() override;
+
+    qint32 itemType() const
+    {
+        return m_itemType;
+    }
+
+    const QString & itemLocalUid() const
+    {
+        return m_itemLocalUid;
+    }
+
+    const QString & itemGuid() const
+    {
+        return m_itemGuid;
+    }
+
+    virtual QStringList formats() const override;
+    virtual bool hasFormat(const QString & mimeType) const override;
+
+protected:
+    virtual QVariant retrieveData(
+        const QString & mimeType, QVariant::Type type) const override;
+
+private:
+    Q_DISABLE_COPY(ModelItemMimeData)
+
+private:
+    const QString m_mimeType;
+    const qint32 m_itemType;
+    const QString m_itemLocalUid;
+    const QString m_itemGuid;
+    const Encoder m_encoder;
+
+    mutable QByteArray m_encodedData;
+};
+
+/**
+ * @brief readModelItemMimeData function reads the local uid and guid of
+ * the dragged model item from the mime data
+ *
+ * The item is read directly from ModelItemMimeData if the drag was started
+ * within the same process or deserialized from the data in the item model's
+ * mime type otherwise.
+ *
+ * @param mimeData      Mime data of the drop
+ * @param mimeType      Item model's mime type
+ * @param itemType      Type of the model item which can be dropped
+ * @param itemLocalUid  Local uid of the dropped item
+ * @param itemGuid      Guid of the dropped item, if any
+ * @return              True if the mime data contains the item of the given
+ *                      type, false otherwise
+ */
+template <class Item>
+bool readModelItemMimeData(
+    const QMimeData & mimeData, const QString & mimeType,
+    const qint32 itemType, QString & itemLocalUid, QString & itemGuid)
+{
+    const auto * pModelItemMimeData =
+        qobject_cast<const ModelItemMimeData *>(&mimeData);
+
+    if (pModelItemMimeData) {
+        if (pModelItemMimeData->itemType() != itemType) {
+            return false;
+        }
+
+        itemLocalUid = pModelItemMimeData->itemLocalUid();
+        itemGuid = pModelItemMimeData->itemGuid();
+        return true;
+    }
+
+    if (!mimeData.hasFormat(mimeType)) {
+        return false;
+    }
+
+    QByteArray data = qUncompress(mimeData.data(mimeType));
+    QDataStream in(&data, QIODevice::ReadOnly);
+
+    qint32 type = 0;
+    in >> type;
+
+    if (type != itemType) {
+        return false;
+    }
+
+    Item item;
+    in >> item;
+
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    itemLocalUid = item.localUid();
+    itemGuid = item.guid();
+    return true;
+}
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_MODEL_COMMON_MODEL_ITEM_MIME_DATA_H
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ModelSnapshot.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/StandardPaths.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#define MODEL_SNAPSHOT_MAGIC   (0x514E4D53) // QNMS
+#define MODEL_SNAPSHOT_VERSION (1)
+
+#define LOCAL_STORAGE_DATABASE_FILE_NAME QStringLiteral("qn.storage.sqlite")
+
+namespace quentier {
+
+QByteArray localStorageChangeMarker(const Account & account)
+{
+    const QString databaseFilePath = accountPersistentStoragePath(account) +
+        QStringLiteral("/") + LOCAL_STORAGE_DATABASE_FILE_NAME;
+
+    QFileInfo databaseFileInfo(databaseFilePath);
+    if (!databaseFileInfo.exists()) {
+        return {};
+    }
+
+    // Changes which haven't been checkpointed into the database file yet
+    // reside in the write-ahead log file
+    QFileInfo walFileInfo(databaseFilePath + QStringLiteral("-wal"));
+
+    QByteArray marker = QByteArray::number(databaseFileInfo.size());
+    marker += ':';
+
+    marker += QByteArray::number(
+        databaseFileInfo.lastModified().toMSecsSinceEpoch());
+
+    marker += ':';
+    marker += QByteArray::number(walFileInfo.exists() ? walFileInfo.size() : 0);
+    return marker;
+}
+
+QString modelSnapshotFilePath(
+    const Account & account, const QString & modelName)
+{
+    return accountPersistentStoragePath(account) +
+        QStringLiteral("/model_snapshots/") + modelName +
+        QStringLiteral(".snapshot");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ModelSnapshot::ModelSnapshot(
+    const QString & filePath, const QByteArray & localStorageMarker) :
+    m_file(filePath)
+{
+    if (!m_file.exists()) {
+        QNDEBUG("model:snapshot", "No model snapshot at " << filePath);
+        return;
+    }
+
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        QNWARNING(
+            "model:snapshot",
+            "Failed to open model snapshot file " << filePath << ": "
+                                                  << m_file.errorString());
+        return;
+    }
+
+    m_pMappedData = m_file.map(0, m_file.size());
+    if (m_pMappedData) {
+        m_data = QByteArray::fromRawData(
+            reinterpret_cast<const char *>(m_pMappedData),
+            static_cast<int>(m_file.size()));
+    }
+    else {
+        QNDEBUG(
+            "model:snapshot",
+            "Failed to map model snapshot file into memory, reading it");
+        m_data = m_file.readAll();
+    }
+
+    auto pStream = std::make_unique<QDataStream>(m_data);
+    pStream->setVersion(QDataStream::Qt_5_5);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray marker;
+    *pStream >> magic >> version >> marker;
+
+    if ((pStream->status() != QDataStream::Ok) ||
+        (magic != MODEL_SNAPSHOT_MAGIC) || (version != MODEL_SNAPSHOT_VERSION))
+    {
+        QNWARNING(
+            "model:snapshot",
+            "Model snapshot file " << filePath << " is corrupted or has "
+                                   << "unsupported version, ignoring it");
+        return;
+    }
+
+    m_upToDate = !marker.isEmpty() && (marker == localStorageMarker);
+    m_pStream = std::move(pStream);
+
+    QNDEBUG(
+        "model:snapshot",
+        "Opened model snapshot " << filePath
+                                 << ", up to date = " << m_upToDate);
+}
+
+ModelSnapshot::~ModelSnapshot()
+{
+    m_pStream.reset();
+    m_data.clear();
+
+    if (m_pMappedData) {
+        Q_UNUSED(m_file.unmap(m_pMappedData))
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ModelSnapshotWriter::ModelSnapshotWriter(
+    const QByteArray & localStorageMarker) :
+    m_localStorageMarker(localStorageMarker),
+    m_stream(&m_data, QIODevice::WriteOnly)
+{
+    m_stream.setVersion(QDataStream::Qt_5_5);
+}
+
+bool ModelSnapshotWriter::save(
+    const QString & filePath, ErrorString & errorDescription)
+{
+    QNDEBUG("model:snapshot", "ModelSnapshotWriter::save: " << filePath);
+
+    QFileInfo fileInfo(filePath);
+    QDir dir = fileInfo.absoluteDir();
+    if (!dir.exists() && !dir.mkpath(dir.absolutePath())) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't create the directory for model snapshot"));
+        errorDescription.details() = dir.absolutePath();
+        QNWARNING("model:snapshot", errorDescription);
+        return false;
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't open model snapshot file for writing"));
+        errorDescription.details() = file.errorString();
+        QNWARNING("model:snapshot", errorDescription);
+        return false;
+    }
+
+    QDataStream headerStream(&file);
+    headerStream.setVersion(QDataStream::Qt_5_5);
+
+    headerStream << quint32(MODEL_SNAPSHOT_MAGIC)
+                 << quint32(MODEL_SNAPSHOT_VERSION) << m_localStorageMarker;
+
+    if ((headerStream.status() != QDataStream::Ok) ||
+        (file.write(m_data) != m_data.size()) || !file.commit())
+    {
+        errorDescription.setBase(QT_TR_NOOP("Can't write model snapshot file"));
+        errorDescription.details() = file.errorString();
+        QNWARNING("model:snapshot", errorDescription);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace quentier
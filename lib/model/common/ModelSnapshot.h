@@ -0,0 +1,127 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_MODEL_COMMON_MODEL_SNAPSHOT_H
+#define QUENTIER_LIB_MODEL_COMMON_MODEL_SNAPSHOT_H
+
+#include <quentier/types/Account.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+
+#include <memory>
+
+namespace quentier {
+
+/**
+ * @brief localStorageChangeMarker function computes the value which changes
+ * whenever the local storage database of the given account is modified
+ *
+ * The marker is computed from the size and the modification time of
+ * the database files so it is only meaningful when the database is not opened
+ * by the local storage manager i.e. before opening it or after closing it.
+ */
+QByteArray localStorageChangeMarker(const Account & account);
+
+/**
+ * @brief modelSnapshotFilePath function returns the path to the file
+ * containing the snapshot of the model with the given name for the given
+ * account
+ */
+QString modelSnapshotFilePath(
+    const Account & account, const QString & modelName);
+
+/**
+ * @brief The ModelSnapshot class provides read access to the snapshot of
+ * model's items persisted by ModelSnapshotWriter
+ *
+ * The snapshot file is mapped into memory rather than read so that models can
+ * be populated from it right on startup. The snapshot is considered up to
+ * date if the local storage change marker it was written with matches
+ * the current one; otherwise the snapshot can still be used to populate
+ * the model but the model needs to reconcile its contents with the local
+ * storage.
+ */
+class ModelSnapshot
+{
+public:
+    explicit ModelSnapshot(
+        const QString & filePath, const QByteArray & localStorageMarker);
+
+    ~ModelSnapshot();
+
+    bool isEmpty() const
+    {
+        return !m_pStream;
+    }
+
+    bool isUpToDate() const
+    {
+        return m_upToDate;
+    }
+
+    /**
+     * @return      The stream containing the snapshot data written by
+     *              the model; must not be called for empty snapshot
+     */
+    QDataStream & stream()
+    {
+        return *m_pStream;
+    }
+
+private:
+    Q_DISABLE_COPY(ModelSnapshot)
+
+private:
+    QFile m_file;
+    uchar * m_pMappedData = nullptr;
+    QByteArray m_data;
+    std::unique_ptr<QDataStream> m_pStream;
+    bool m_upToDate = false;
+};
+
+/**
+ * @brief The ModelSnapshotWriter class accumulates the snapshot data written
+ * by the model and atomically saves it to the file
+ */
+class ModelSnapshotWriter
+{
+public:
+    explicit ModelSnapshotWriter(const QByteArray & localStorageMarker);
+
+    QDataStream & stream()
+    {
+        return m_stream;
+    }
+
+    bool save(const QString & filePath, ErrorString & errorDescription);
+
+private:
+    Q_DISABLE_COPY(ModelSnapshotWriter)
+
+private:
+    QByteArray m_localStorageMarker;
+    QByteArray m_data;
+    QDataStream m_stream;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_MODEL_COMMON_MODEL_SNAPSHOT_H
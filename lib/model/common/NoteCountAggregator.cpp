@@ -0,0 +1,915 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NoteCountAggregator.h"
+#include "LocalStorageRequestScheduler.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Compat.h>
+
+#include <algorithm>
+
+namespace quentier {
+
+NoteCountAggregator::NoteCountAggregator(
+    LocalStorageManagerAsync & localStorageManagerAsync, QObject * parent,
+    LocalStorageRequestScheduler * pRequestScheduler) :
+    QObject(parent),
+    m_localStorageManagerAsync(localStorageManagerAsync),
+    m_pRequestScheduler(pRequestScheduler)
+{
+    connectToLocalStorage();
+}
+
+NoteCountAggregator::~NoteCountAggregator()
+{
+    if (m_pRequestScheduler) {
+        m_pRequestScheduler->cancelRequests(*this);
+    }
+}
+
+void NoteCountAggregator::connectToLocalStorage()
+{
+    QNDEBUG(
+        "model:note_count", "NoteCountAggregator::connectToLocalStorage");
+
+    if (m_connectedToLocalStorage) {
+        QNDEBUG("model:note_count", "Already connected to local storage");
+        return;
+    }
+
+    // Local signals to localStorageManagerAsync's slots
+    QObject::connect(
+        this, &NoteCountAggregator::requestNoteCountPerNotebook,
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onGetNoteCountPerNotebookRequest);
+
+    QObject::connect(
+        this, &NoteCountAggregator::requestNoteCountPerTag,
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onGetNoteCountPerTagRequest);
+
+    QObject::connect(
+        this, &NoteCountAggregator::requestNoteCountsPerAllTags,
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onGetNoteCountsPerAllTagsRequest);
+
+    QObject::connect(
+        this, &NoteCountAggregator::listAllTagsPerNote,
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onListAllTagsPerNoteRequest);
+
+    // localStorageManagerAsync's signals to local slots
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::getNoteCountPerNotebookComplete, this,
+        &NoteCountAggregator::onGetNoteCountPerNotebookComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::getNoteCountPerNotebookFailed, this,
+        &NoteCountAggregator::onGetNoteCountPerNotebookFailed);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::getNoteCountPerTagComplete, this,
+        &NoteCountAggregator::onGetNoteCountPerTagComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::getNoteCountPerTagFailed, this,
+        &NoteCountAggregator::onGetNoteCountPerTagFailed);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::getNoteCountsPerAllTagsComplete, this,
+        &NoteCountAggregator::onGetNoteCountsPerAllTagsComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::getNoteCountsPerAllTagsFailed, this,
+        &NoteCountAggregator::onGetNoteCountsPerAllTagsFailed);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listAllTagsPerNoteComplete, this,
+        &NoteCountAggregator::onListAllTagsPerNoteComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listAllTagsPerNoteFailed, this,
+        &NoteCountAggregator::onListAllTagsPerNoteFailed);
+
+    QObject::connect(
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::addNoteComplete,
+        this, &NoteCountAggregator::onAddNoteComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::noteMovedToAnotherNotebook, this,
+        &NoteCountAggregator::onNoteMovedToAnotherNotebook);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::noteTagListChanged, this,
+        &NoteCountAggregator::onNoteTagListChanged);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeNoteComplete, this,
+        &NoteCountAggregator::onExpungeNoteComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeNotebookComplete, this,
+        &NoteCountAggregator::onExpungeNotebookComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeTagComplete, this,
+        &NoteCountAggregator::onExpungeTagComplete);
+
+    m_connectedToLocalStorage = true;
+
+    const auto notebookLocalUids = m_notebookLocalUidsPendingReconnection;
+    m_notebookLocalUidsPendingReconnection.clear();
+    for (const auto & notebookLocalUid: qAsConst(notebookLocalUids)) {
+        scheduleNoteCountRequestForNotebook(notebookLocalUid);
+    }
+
+    const auto tagLocalUids = m_tagLocalUidsPendingReconnection;
+    m_tagLocalUidsPendingReconnection.clear();
+    for (const auto & tagLocalUid: qAsConst(tagLocalUids)) {
+        scheduleNoteCountRequestForTag(tagLocalUid);
+    }
+
+    if (m_noteCountsForAllTagsPendingReconnection) {
+        m_noteCountsForAllTagsPendingReconnection = false;
+        scheduleNoteCountsRequestForAllTags();
+    }
+}
+
+void NoteCountAggregator::disconnectFromLocalStorage()
+{
+    QNDEBUG(
+        "model:note_count", "NoteCountAggregator::disconnectFromLocalStorage");
+
+    if (!m_connectedToLocalStorage) {
+        QNDEBUG("model:note_count", "Already disconnected from local storage");
+        return;
+    }
+
+    QObject::disconnect(&m_localStorageManagerAsync);
+    m_localStorageManagerAsync.disconnect(this);
+    m_connectedToLocalStorage = false;
+
+    // Queued requests would go nowhere now
+    if (m_pRequestScheduler) {
+        m_pRequestScheduler->cancelRequests(*this);
+    }
+
+    // Results of requests which are already in flight won't be received
+    // either so all pending requests need to be sent again on reconnection
+    for (const auto & entry: m_notebookLocalUidToNoteCountRequestIdBimap) {
+        Q_UNUSED(m_notebookLocalUidsPendingReconnection.insert(entry.left))
+    }
+
+    m_notebookLocalUidToNoteCountRequestIdBimap.clear();
+
+    for (const auto & entry: m_tagLocalUidToNoteCountRequestIdBimap) {
+        Q_UNUSED(m_tagLocalUidsPendingReconnection.insert(entry.left))
+    }
+
+    m_tagLocalUidToNoteCountRequestIdBimap.clear();
+
+    if (!m_noteCountsPerAllTagsRequestId.isNull() ||
+        !m_listTagsPerNoteRequestIds.isEmpty())
+    {
+        m_noteCountsForAllTagsPendingReconnection = true;
+    }
+
+    m_noteCountsPerAllTagsRequestId = QUuid();
+    m_listTagsPerNoteRequestIds.clear();
+}
+
+int NoteCountAggregator::noteCountForNotebook(
+    const QString & notebookLocalUid) const
+{
+    auto it = m_noteCountsByNotebookLocalUid.find(notebookLocalUid);
+    if (it == m_noteCountsByNotebookLocalUid.end()) {
+        return -1;
+    }
+
+    return it.value();
+}
+
+int NoteCountAggregator::noteCountForTag(const QString & tagLocalUid) const
+{
+    auto it = m_noteCountsByTagLocalUid.find(tagLocalUid);
+    if (it == m_noteCountsByTagLocalUid.end()) {
+        return (m_hasNoteCountsForAllTags ? 0 : -1);
+    }
+
+    return it.value();
+}
+
+void NoteCountAggregator::requestNoteCountForNotebook(
+    const QString & notebookLocalUid)
+{
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::requestNoteCountForNotebook: "
+            << notebookLocalUid);
+
+    if (m_noteCountsByNotebookLocalUid.contains(notebookLocalUid)) {
+        QNTRACE("model:note_count", "The note count is already known");
+        return;
+    }
+
+    scheduleNoteCountRequestForNotebook(notebookLocalUid);
+}
+
+void NoteCountAggregator::requestNoteCountForTag(const QString & tagLocalUid)
+{
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::requestNoteCountForTag: " << tagLocalUid);
+
+    if (m_hasNoteCountsForAllTags ||
+        m_noteCountsByTagLocalUid.contains(tagLocalUid))
+    {
+        QNTRACE("model:note_count", "The note count is already known");
+        return;
+    }
+
+    scheduleNoteCountRequestForTag(tagLocalUid);
+}
+
+void NoteCountAggregator::requestNoteCountsForAllTags()
+{
+    QNTRACE(
+        "model:note_count", "NoteCountAggregator::requestNoteCountsForAllTags");
+
+    if (m_hasNoteCountsForAllTags) {
+        QNTRACE("model:note_count", "Note counts for all tags are known");
+        return;
+    }
+
+    scheduleNoteCountsRequestForAllTags();
+}
+
+void NoteCountAggregator::seedNoteCountForNotebook(
+    const QString & notebookLocalUid, const int noteCount)
+{
+    if ((noteCount < 0) ||
+        m_noteCountsByNotebookLocalUid.contains(notebookLocalUid) ||
+        m_notebookLocalUidsPendingReconnection.contains(notebookLocalUid))
+    {
+        return;
+    }
+
+    auto it =
+        m_notebookLocalUidToNoteCountRequestIdBimap.left.find(notebookLocalUid);
+
+    if (it != m_notebookLocalUidToNoteCountRequestIdBimap.left.end()) {
+        return;
+    }
+
+    m_noteCountsByNotebookLocalUid[notebookLocalUid] = noteCount;
+}
+
+void NoteCountAggregator::seedNoteCountForTag(
+    const QString & tagLocalUid, const int noteCount)
+{
+    if ((noteCount < 0) || (noteCountForTag(tagLocalUid) >= 0) ||
+        m_tagLocalUidsPendingReconnection.contains(tagLocalUid))
+    {
+        return;
+    }
+
+    auto it = m_tagLocalUidToNoteCountRequestIdBimap.left.find(tagLocalUid);
+    if (it != m_tagLocalUidToNoteCountRequestIdBimap.left.end()) {
+        return;
+    }
+
+    m_noteCountsByTagLocalUid[tagLocalUid] = noteCount;
+}
+
+bool NoteCountAggregator::hasPendingNotebookNoteCountRequests() const
+{
+    return !m_notebookLocalUidToNoteCountRequestIdBimap.empty() ||
+        !m_notebookLocalUidsPendingReconnection.isEmpty();
+}
+
+bool NoteCountAggregator::hasPendingTagNoteCountRequests() const
+{
+    return !m_tagLocalUidToNoteCountRequestIdBimap.empty() ||
+        !m_noteCountsPerAllTagsRequestId.isNull() ||
+        !m_listTagsPerNoteRequestIds.isEmpty() ||
+        !m_tagLocalUidsPendingReconnection.isEmpty() ||
+        m_noteCountsForAllTagsPendingReconnection;
+}
+
+void NoteCountAggregator::onGetNoteCountPerNotebookComplete(
+    int noteCount, Notebook notebook,
+    LocalStorageManager::NoteCountOptions options, QUuid requestId)
+{
+    Q_UNUSED(options)
+
+    auto it = m_notebookLocalUidToNoteCountRequestIdBimap.right.find(requestId);
+    if (it == m_notebookLocalUidToNoteCountRequestIdBimap.right.end()) {
+        return;
+    }
+
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onGetNoteCountPerNotebookComplete: "
+            << "note count = " << noteCount << ", notebook local uid = "
+            << it->second << ", request id = " << requestId);
+
+    const QString notebookLocalUid = it->second;
+    Q_UNUSED(m_notebookLocalUidToNoteCountRequestIdBimap.right.erase(it))
+
+    setNoteCountForNotebook(notebookLocalUid, noteCount);
+}
+
+void NoteCountAggregator::onGetNoteCountPerNotebookFailed(
+    ErrorString errorDescription, Notebook notebook,
+    LocalStorageManager::NoteCountOptions options, QUuid requestId)
+{
+    Q_UNUSED(options)
+
+    auto it = m_notebookLocalUidToNoteCountRequestIdBimap.right.find(requestId);
+    if (it == m_notebookLocalUidToNoteCountRequestIdBimap.right.end()) {
+        return;
+    }
+
+    QNWARNING(
+        "model:note_count",
+        "NoteCountAggregator::onGetNoteCountPerNotebookFailed: "
+            << "error description = " << errorDescription
+            << ", notebook: " << notebook << "\nRequest id = " << requestId);
+
+    const QString notebookLocalUid = it->second;
+    Q_UNUSED(m_notebookLocalUidToNoteCountRequestIdBimap.right.erase(it))
+
+    // Not much can be done here - will just "remove" the count so that it is
+    // requested again when needed
+    if (m_noteCountsByNotebookLocalUid.remove(notebookLocalUid) != 0) {
+        Q_EMIT noteCountForNotebookChanged(notebookLocalUid, -1);
+    }
+
+    ErrorString error(
+        QT_TR_NOOP("Failed to get note count for one of notebooks"));
+    error.appendBase(errorDescription.base());
+    error.appendBase(errorDescription.additionalBases());
+    error.details() = errorDescription.details();
+    Q_EMIT notifyError(error);
+}
+
+void NoteCountAggregator::onGetNoteCountPerTagComplete(
+    int noteCount, Tag tag, LocalStorageManager::NoteCountOptions options,
+    QUuid requestId)
+{
+    Q_UNUSED(options)
+
+    auto it = m_tagLocalUidToNoteCountRequestIdBimap.right.find(requestId);
+    if (it == m_tagLocalUidToNoteCountRequestIdBimap.right.end()) {
+        return;
+    }
+
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onGetNoteCountPerTagComplete: "
+            << "note count = " << noteCount
+            << ", tag local uid = " << it->second
+            << ", request id = " << requestId);
+
+    const QString tagLocalUid = it->second;
+    Q_UNUSED(m_tagLocalUidToNoteCountRequestIdBimap.right.erase(it))
+
+    setNoteCountForTag(tagLocalUid, noteCount);
+}
+
+void NoteCountAggregator::onGetNoteCountPerTagFailed(
+    ErrorString errorDescription, Tag tag,
+    LocalStorageManager::NoteCountOptions options, QUuid requestId)
+{
+    Q_UNUSED(options)
+
+    auto it = m_tagLocalUidToNoteCountRequestIdBimap.right.find(requestId);
+    if (it == m_tagLocalUidToNoteCountRequestIdBimap.right.end()) {
+        return;
+    }
+
+    QNWARNING(
+        "model:note_count",
+        "NoteCountAggregator::onGetNoteCountPerTagFailed: "
+            << "error description = " << errorDescription << ", tag = " << tag
+            << ", request id = " << requestId);
+
+    Q_UNUSED(m_tagLocalUidToNoteCountRequestIdBimap.right.erase(it))
+
+    ErrorString error(QT_TR_NOOP("Failed to get note count for one of tags"));
+    error.appendBase(errorDescription.base());
+    error.appendBase(errorDescription.additionalBases());
+    error.details() = errorDescription.details();
+    Q_EMIT notifyError(error);
+}
+
+void NoteCountAggregator::onGetNoteCountsPerAllTagsComplete(
+    QHash<QString, int> noteCountsPerTagLocalUid,
+    LocalStorageManager::NoteCountOptions options, QUuid requestId)
+{
+    Q_UNUSED(options)
+
+    if (requestId != m_noteCountsPerAllTagsRequestId) {
+        return;
+    }
+
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onGetNoteCountsPerAllTagsComplete: note "
+            << "counts were received for " << noteCountsPerTagLocalUid.size()
+            << " tag local uids; request id = " << requestId);
+
+    m_noteCountsPerAllTagsRequestId = QUuid();
+
+    m_noteCountsByTagLocalUid = noteCountsPerTagLocalUid;
+    m_hasNoteCountsForAllTags = true;
+
+    Q_EMIT noteCountsForAllTagsChanged();
+}
+
+void NoteCountAggregator::onGetNoteCountsPerAllTagsFailed(
+    ErrorString errorDescription, LocalStorageManager::NoteCountOptions options,
+    QUuid requestId)
+{
+    Q_UNUSED(options)
+
+    if (requestId != m_noteCountsPerAllTagsRequestId) {
+        return;
+    }
+
+    QNWARNING(
+        "model:note_count",
+        "NoteCountAggregator::onGetNoteCountsPerAllTagsFailed: error "
+            << "description = " << errorDescription
+            << ", request id = " << requestId);
+
+    m_noteCountsPerAllTagsRequestId = QUuid();
+
+    ErrorString error(QT_TR_NOOP("Failed to get note counts for tags"));
+    error.appendBase(errorDescription.base());
+    error.appendBase(errorDescription.additionalBases());
+    error.details() = errorDescription.details();
+    Q_EMIT notifyError(error);
+}
+
+void NoteCountAggregator::onListAllTagsPerNoteComplete(
+    QList<Tag> foundTags, Note note,
+    LocalStorageManager::ListObjectsOptions flag, size_t limit, size_t offset,
+    LocalStorageManager::ListTagsOrder order,
+    LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
+{
+    auto it = m_listTagsPerNoteRequestIds.find(requestId);
+    if (it == m_listTagsPerNoteRequestIds.end()) {
+        return;
+    }
+
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onListAllTagsPerNoteComplete: note = "
+            << note << "\nFlag = " << flag << ", limit = " << limit
+            << ", offset = " << offset << ", order = " << order
+            << ", order direction = " << orderDirection
+            << ", request id = " << requestId);
+
+    Q_UNUSED(m_listTagsPerNoteRequestIds.erase(it))
+
+    for (const auto & foundTag: qAsConst(foundTags)) {
+        refreshNoteCountForTag(foundTag.localUid());
+    }
+}
+
+void NoteCountAggregator::onListAllTagsPerNoteFailed(
+    Note note, LocalStorageManager::ListObjectsOptions flag, size_t limit,
+    size_t offset, LocalStorageManager::ListTagsOrder order,
+    LocalStorageManager::OrderDirection orderDirection,
+    ErrorString errorDescription, QUuid requestId)
+{
+    auto it = m_listTagsPerNoteRequestIds.find(requestId);
+    if (it == m_listTagsPerNoteRequestIds.end()) {
+        return;
+    }
+
+    QNWARNING(
+        "model:note_count",
+        "NoteCountAggregator::onListAllTagsPerNoteFailed: note = "
+            << note << "\nFlag = " << flag << ", limit = " << limit
+            << ", offset = " << offset << ", order = " << order
+            << ", order direction = " << orderDirection << ", request id = "
+            << requestId << ", error description = " << errorDescription);
+
+    Q_UNUSED(m_listTagsPerNoteRequestIds.erase(it))
+
+    // Trying to work around this problem by re-requesting the note count for
+    // all tags
+    refreshNoteCountsForAllTags();
+}
+
+void NoteCountAggregator::onAddNoteComplete(Note note, QUuid requestId)
+{
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onAddNoteComplete: note = "
+            << note << "\nRequest id = " << requestId);
+
+    if (Q_UNLIKELY(note.hasDeletionTimestamp())) {
+        return;
+    }
+
+    if (note.hasNotebookLocalUid()) {
+        adjustNoteCountForNotebook(note.notebookLocalUid(), 1);
+    }
+    else {
+        QNDEBUG(
+            "model:note_count",
+            "Added note has no notebook local uid, re-requesting the note "
+                << "count for all notebooks");
+        refreshNoteCountsForAllNotebooks();
+    }
+
+    if (note.hasTagLocalUids()) {
+        const auto & tagLocalUids = note.tagLocalUids();
+        for (const auto & tagLocalUid: qAsConst(tagLocalUids)) {
+            adjustNoteCountForTag(tagLocalUid, 1);
+        }
+    }
+    else if (note.hasTagGuids()) {
+        QNDEBUG(
+            "model:note_count",
+            "The note has tag guids but not tag local uids, need to request "
+                << "the proper list of tags from this note before their note "
+                << "counts can be updated");
+        requestTagsPerNote(note);
+    }
+}
+
+void NoteCountAggregator::onNoteMovedToAnotherNotebook(
+    QString noteLocalUid, QString previousNotebookLocalUid,
+    QString newNotebookLocalUid)
+{
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onNoteMovedToAnotherNotebook: "
+            << "note local uid = " << noteLocalUid
+            << ", previous notebook local uid = " << previousNotebookLocalUid
+            << ", new notebook local uid = " << newNotebookLocalUid);
+
+    adjustNoteCountForNotebook(previousNotebookLocalUid, -1);
+    adjustNoteCountForNotebook(newNotebookLocalUid, 1);
+}
+
+void NoteCountAggregator::onNoteTagListChanged(
+    QString noteLocalUid, QStringList previousNoteTagLocalUids,
+    QStringList newNoteTagLocalUids)
+{
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onNoteTagListChanged: note local uid = "
+            << noteLocalUid << ", previous note tag local uids = "
+            << previousNoteTagLocalUids.join(QStringLiteral(","))
+            << ", new note tag local uids = "
+            << newNoteTagLocalUids.join(QStringLiteral(",")));
+
+    for (const auto & tagLocalUid: qAsConst(previousNoteTagLocalUids)) {
+        if (!newNoteTagLocalUids.contains(tagLocalUid)) {
+            adjustNoteCountForTag(tagLocalUid, -1);
+        }
+    }
+
+    for (const auto & tagLocalUid: qAsConst(newNoteTagLocalUids)) {
+        if (!previousNoteTagLocalUids.contains(tagLocalUid)) {
+            adjustNoteCountForTag(tagLocalUid, 1);
+        }
+    }
+}
+
+void NoteCountAggregator::onExpungeNoteComplete(Note note, QUuid requestId)
+{
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onExpungeNoteComplete: note = "
+            << note << "\nRequest id = " << requestId);
+
+    // NOTE: it's not sufficient to decrement the note counts as this note
+    // might have had deletion timestamp set so it did not actually contribute
+    // to the note counts
+
+    if (note.hasNotebookLocalUid()) {
+        refreshNoteCountForNotebook(note.notebookLocalUid());
+    }
+    else {
+        QNDEBUG(
+            "model:note_count",
+            "Expunged note has no notebook local uid, re-requesting the note "
+                << "count for all notebooks");
+        refreshNoteCountsForAllNotebooks();
+    }
+
+    if (note.hasTagLocalUids()) {
+        const auto & tagLocalUids = note.tagLocalUids();
+        for (const auto & tagLocalUid: qAsConst(tagLocalUids)) {
+            refreshNoteCountForTag(tagLocalUid);
+        }
+    }
+    else {
+        QNDEBUG(
+            "model:note_count",
+            "Expunged note has no tag local uids, re-requesting the note "
+                << "count for all tags");
+        refreshNoteCountsForAllTags();
+    }
+}
+
+void NoteCountAggregator::onExpungeNotebookComplete(
+    Notebook notebook, QUuid requestId)
+{
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onExpungeNotebookComplete: local uid = "
+            << notebook.localUid() << ", request id = " << requestId);
+
+    Q_UNUSED(m_noteCountsByNotebookLocalUid.remove(notebook.localUid()))
+
+    // Notes from this notebook have been expunged along with it; need to
+    // re-request the number of notes per tag for all tags
+    refreshNoteCountsForAllTags();
+}
+
+void NoteCountAggregator::onExpungeTagComplete(
+    Tag tag, QStringList expungedChildTagLocalUids, QUuid requestId)
+{
+    QNTRACE(
+        "model:note_count",
+        "NoteCountAggregator::onExpungeTagComplete: local uid = "
+            << tag.localUid() << ", expunged child tag local uids: "
+            << expungedChildTagLocalUids.join(QStringLiteral(","))
+            << ", request id = " << requestId);
+
+    Q_UNUSED(m_noteCountsByTagLocalUid.remove(tag.localUid()))
+
+    for (const auto & childTagLocalUid: qAsConst(expungedChildTagLocalUids)) {
+        Q_UNUSED(m_noteCountsByTagLocalUid.remove(childTagLocalUid))
+    }
+}
+
+void NoteCountAggregator::scheduleNoteCountRequestForNotebook(
+    const QString & notebookLocalUid)
+{
+    if (!m_connectedToLocalStorage) {
+        Q_UNUSED(m_notebookLocalUidsPendingReconnection.insert(
+            notebookLocalUid))
+        return;
+    }
+
+    auto it =
+        m_notebookLocalUidToNoteCountRequestIdBimap.left.find(notebookLocalUid);
+
+    if (it != m_notebookLocalUidToNoteCountRequestIdBimap.left.end()) {
+        QNTRACE(
+            "model:note_count",
+            "The note count for notebook " << notebookLocalUid
+                                           << " is already being requested");
+        return;
+    }
+
+    Notebook dummyNotebook;
+    dummyNotebook.setLocalUid(notebookLocalUid);
+
+    LocalStorageManager::NoteCountOptions options(
+        LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes);
+
+    auto requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, dummyNotebook, options](const QUuid & id) {
+            Q_EMIT requestNoteCountPerNotebook(dummyNotebook, options, id);
+        },
+        localStorageRequestKey(
+            "getNoteCountPerNotebook", notebookLocalUid, options));
+
+    m_notebookLocalUidToNoteCountRequestIdBimap.insert(
+        LocalUidToRequestIdBimap::value_type(notebookLocalUid, requestId));
+
+    QNTRACE(
+        "model:note_count",
+        "Scheduled the request to get the note count per notebook: "
+            << "notebook local uid = " << notebookLocalUid
+            << ", request id = " << requestId);
+}
+
+void NoteCountAggregator::scheduleNoteCountRequestForTag(
+    const QString & tagLocalUid)
+{
+    if (!m_connectedToLocalStorage) {
+        Q_UNUSED(m_tagLocalUidsPendingReconnection.insert(tagLocalUid))
+        return;
+    }
+
+    auto it = m_tagLocalUidToNoteCountRequestIdBimap.left.find(tagLocalUid);
+    if (it != m_tagLocalUidToNoteCountRequestIdBimap.left.end()) {
+        QNTRACE(
+            "model:note_count",
+            "The note count for tag " << tagLocalUid
+                                      << " is already being requested");
+        return;
+    }
+
+    Tag dummyTag;
+    dummyTag.setLocalUid(tagLocalUid);
+
+    LocalStorageManager::NoteCountOptions options(
+        LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes);
+
+    auto requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, dummyTag, options](const QUuid & id) {
+            Q_EMIT requestNoteCountPerTag(dummyTag, options, id);
+        },
+        localStorageRequestKey("getNoteCountPerTag", tagLocalUid, options));
+
+    m_tagLocalUidToNoteCountRequestIdBimap.insert(
+        LocalUidToRequestIdBimap::value_type(tagLocalUid, requestId));
+
+    QNTRACE(
+        "model:note_count",
+        "Scheduled the request to get the note count per tag: "
+            << "tag local uid = " << tagLocalUid
+            << ", request id = " << requestId);
+}
+
+void NoteCountAggregator::scheduleNoteCountsRequestForAllTags()
+{
+    if (!m_connectedToLocalStorage) {
+        m_noteCountsForAllTagsPendingReconnection = true;
+        return;
+    }
+
+    if (!m_noteCountsPerAllTagsRequestId.isNull()) {
+        QNTRACE(
+            "model:note_count",
+            "Note counts for all tags are already being requested");
+        return;
+    }
+
+    LocalStorageManager::NoteCountOptions options(
+        LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes);
+
+    m_noteCountsPerAllTagsRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, options](const QUuid & id) {
+            Q_EMIT requestNoteCountsPerAllTags(options, id);
+        },
+        localStorageRequestKey("getNoteCountsPerAllTags", options));
+
+    QNTRACE(
+        "model:note_count",
+        "Scheduled the request to get note counts for all tags: request id = "
+            << m_noteCountsPerAllTagsRequestId);
+}
+
+void NoteCountAggregator::requestTagsPerNote(const Note & note)
+{
+    QNTRACE(
+        "model:note_count", "NoteCountAggregator::requestTagsPerNote: "
+                                << note);
+
+    QUuid requestId = QUuid::createUuid();
+    Q_UNUSED(m_listTagsPerNoteRequestIds.insert(requestId))
+
+    QNTRACE(
+        "model:note_count",
+        "Emitting the request to list tags per note: request id = "
+            << requestId);
+
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT listAllTagsPerNote(
+                note, LocalStorageManager::ListObjectsOption::ListAll,
+                /* limit = */ 0,
+                /* offset = */ 0, LocalStorageManager::ListTagsOrder::NoOrder,
+                LocalStorageManager::OrderDirection::Ascending, id);
+        });
+}
+
+void NoteCountAggregator::refreshNoteCountForNotebook(
+    const QString & notebookLocalUid)
+{
+    if (m_noteCountsByNotebookLocalUid.contains(notebookLocalUid)) {
+        scheduleNoteCountRequestForNotebook(notebookLocalUid);
+    }
+}
+
+void NoteCountAggregator::refreshNoteCountsForAllNotebooks()
+{
+    const auto notebookLocalUids = m_noteCountsByNotebookLocalUid.keys();
+    for (const auto & notebookLocalUid: qAsConst(notebookLocalUids)) {
+        scheduleNoteCountRequestForNotebook(notebookLocalUid);
+    }
+}
+
+void NoteCountAggregator::refreshNoteCountForTag(const QString & tagLocalUid)
+{
+    if (m_hasNoteCountsForAllTags ||
+        m_noteCountsByTagLocalUid.contains(tagLocalUid))
+    {
+        scheduleNoteCountRequestForTag(tagLocalUid);
+    }
+}
+
+void NoteCountAggregator::refreshNoteCountsForAllTags()
+{
+    if (m_hasNoteCountsForAllTags) {
+        scheduleNoteCountsRequestForAllTags();
+        return;
+    }
+
+    const auto tagLocalUids = m_noteCountsByTagLocalUid.keys();
+    for (const auto & tagLocalUid: qAsConst(tagLocalUids)) {
+        scheduleNoteCountRequestForTag(tagLocalUid);
+    }
+}
+
+void NoteCountAggregator::adjustNoteCountForNotebook(
+    const QString & notebookLocalUid, const int delta)
+{
+    auto it = m_noteCountsByNotebookLocalUid.find(notebookLocalUid);
+    if (it == m_noteCountsByNotebookLocalUid.end()) {
+        // Either nobody needs this count or it is being requested and then
+        // the received count would already reflect the change
+        return;
+    }
+
+    setNoteCountForNotebook(notebookLocalUid, std::max(it.value() + delta, 0));
+}
+
+void NoteCountAggregator::adjustNoteCountForTag(
+    const QString & tagLocalUid, const int delta)
+{
+    const int noteCount = noteCountForTag(tagLocalUid);
+    if (noteCount < 0) {
+        // Either nobody needs this count or it is being requested and then
+        // the received count would already reflect the change
+        return;
+    }
+
+    setNoteCountForTag(tagLocalUid, std::max(noteCount + delta, 0));
+}
+
+void NoteCountAggregator::setNoteCountForNotebook(
+    const QString & notebookLocalUid, const int noteCount)
+{
+    auto it = m_noteCountsByNotebookLocalUid.find(notebookLocalUid);
+    if ((it != m_noteCountsByNotebookLocalUid.end()) &&
+        (it.value() == noteCount))
+    {
+        return;
+    }
+
+    m_noteCountsByNotebookLocalUid[notebookLocalUid] = noteCount;
+    Q_EMIT noteCountForNotebookChanged(notebookLocalUid, noteCount);
+}
+
+void NoteCountAggregator::setNoteCountForTag(
+    const QString & tagLocalUid, const int noteCount)
+{
+    if (noteCountForTag(tagLocalUid) == noteCount) {
+        return;
+    }
+
+    m_noteCountsByTagLocalUid[tagLocalUid] = noteCount;
+    Q_EMIT noteCountForTagChanged(tagLocalUid, noteCount);
+}
+
+} // namespace quentier
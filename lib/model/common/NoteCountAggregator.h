@@ -0,0 +1,281 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_MODEL_COMMON_NOTE_COUNT_AGGREGATOR_H
+#define QUENTIER_LIB_MODEL_COMMON_NOTE_COUNT_AGGREGATOR_H
+
+#include <quentier/local_storage/LocalStorageManagerAsync.h>
+#include <quentier/types/ErrorString.h>
+#include <quentier/utility/SuppressWarnings.h>
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QUuid>
+
+SAVE_WARNINGS
+
+MSVC_SUPPRESS_WARNING(4834)
+
+#include <boost/bimap.hpp>
+
+RESTORE_WARNINGS
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageRequestScheduler)
+
+/**
+ * @brief The NoteCountAggregator class keeps the numbers of non-deleted notes
+ * per notebook and per tag for all the models displaying these numbers
+ *
+ * The count is requested from the local storage only once, when some model
+ * needs it for the first time. After that the aggregator keeps it up to date
+ * by itself: moving notes between notebooks and changing notes' tags adjust
+ * the known counts without querying the local storage and the counts which
+ * can't be adjusted this way, for example after the note is expunged, are
+ * re-requested once for all the models. The models learn about the changes
+ * of counts from the aggregator's signals.
+ *
+ * Local storage processes the requests in the order in which they were sent
+ * so the count received after the notification about some change of notes
+ * already takes this change into account. For this reason the changes
+ * occurring while the count is being requested don't need another request.
+ */
+class NoteCountAggregator final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NoteCountAggregator(
+        LocalStorageManagerAsync & localStorageManagerAsync,
+        QObject * parent = nullptr,
+        LocalStorageRequestScheduler * pRequestScheduler = nullptr);
+
+    virtual ~NoteCountAggregator() override;
+
+    /**
+     * @brief connectToLocalStorage and disconnectFromLocalStorage methods
+     * allow to temporarily detach the aggregator from local storage along
+     * with the models using it; the counts being requested at the moment of
+     * disconnection are requested again on reconnection. The aggregator is
+     * connected to local storage on construction.
+     */
+    void connectToLocalStorage();
+    void disconnectFromLocalStorage();
+
+    bool isConnectedToLocalStorage() const
+    {
+        return m_connectedToLocalStorage;
+    }
+
+    /**
+     * @return      Number of non-deleted notes in the notebook or -1 if it is
+     *              not known yet
+     */
+    int noteCountForNotebook(const QString & notebookLocalUid) const;
+
+    /**
+     * @return      Number of non-deleted notes labeled with the tag or -1 if
+     *              it is not known yet
+     */
+    int noteCountForTag(const QString & tagLocalUid) const;
+
+    /**
+     * @return      True if note counts for all tags have been received from
+     *              the local storage, false otherwise
+     */
+    bool hasNoteCountsForAllTags() const
+    {
+        return m_hasNoteCountsForAllTags;
+    }
+
+    /**
+     * @brief requestNoteCountForNotebook method requests the note count for
+     * the notebook from the local storage unless the count is already known
+     * or is being requested; noteCountForNotebookChanged signal is emitted
+     * once the count is received
+     */
+    void requestNoteCountForNotebook(const QString & notebookLocalUid);
+
+    /**
+     * @brief requestNoteCountForTag method requests the note count for
+     * the tag from the local storage unless the count is already known
+     * or is being requested; noteCountForTagChanged signal is emitted once
+     * the count is received
+     */
+    void requestNoteCountForTag(const QString & tagLocalUid);
+
+    /**
+     * @brief requestNoteCountsForAllTags method requests the note counts for
+     * all tags at once unless they are already known or are being requested;
+     * noteCountsForAllTagsChanged signal is emitted once the counts are
+     * received
+     */
+    void requestNoteCountsForAllTags();
+
+    /**
+     * @brief seedNoteCountForNotebook and seedNoteCountForTag methods let
+     * the aggregator know the note counts obtained elsewhere, for example
+     * restored from the up to date snapshot of the model, so that the counts
+     * are kept up to date without requesting them from the local storage;
+     * the seeded count is ignored if the aggregator already knows the count
+     * or is requesting it
+     */
+    void seedNoteCountForNotebook(
+        const QString & notebookLocalUid, const int noteCount);
+
+    void seedNoteCountForTag(const QString & tagLocalUid, const int noteCount);
+
+    bool hasPendingNotebookNoteCountRequests() const;
+    bool hasPendingTagNoteCountRequests() const;
+
+Q_SIGNALS:
+    void noteCountForNotebookChanged(QString notebookLocalUid, int noteCount);
+    void noteCountForTagChanged(QString tagLocalUid, int noteCount);
+
+    // Emitted instead of noteCountForTagChanged signals when the counts for
+    // all tags are received at once
+    void noteCountsForAllTagsChanged();
+
+    void notifyError(ErrorString errorDescription);
+
+    // Informative signals for local storage
+    void requestNoteCountPerNotebook(
+        Notebook notebook, LocalStorageManager::NoteCountOptions options,
+        QUuid requestId);
+
+    void requestNoteCountPerTag(
+        Tag tag, LocalStorageManager::NoteCountOptions options,
+        QUuid requestId);
+
+    void requestNoteCountsPerAllTags(
+        LocalStorageManager::NoteCountOptions options, QUuid requestId);
+
+    void listAllTagsPerNote(
+        Note note, LocalStorageManager::ListObjectsOptions flag, size_t limit,
+        size_t offset, LocalStorageManager::ListTagsOrder order,
+        LocalStorageManager::OrderDirection orderDirection, QUuid requestId);
+
+private Q_SLOTS:
+    void onGetNoteCountPerNotebookComplete(
+        int noteCount, Notebook notebook,
+        LocalStorageManager::NoteCountOptions options, QUuid requestId);
+
+    void onGetNoteCountPerNotebookFailed(
+        ErrorString errorDescription, Notebook notebook,
+        LocalStorageManager::NoteCountOptions options, QUuid requestId);
+
+    void onGetNoteCountPerTagComplete(
+        int noteCount, Tag tag, LocalStorageManager::NoteCountOptions options,
+        QUuid requestId);
+
+    void onGetNoteCountPerTagFailed(
+        ErrorString errorDescription, Tag tag,
+        LocalStorageManager::NoteCountOptions options, QUuid requestId);
+
+    void onGetNoteCountsPerAllTagsComplete(
+        QHash<QString, int> noteCountsPerTagLocalUid,
+        LocalStorageManager::NoteCountOptions options, QUuid requestId);
+
+    void onGetNoteCountsPerAllTagsFailed(
+        ErrorString errorDescription,
+        LocalStorageManager::NoteCountOptions options, QUuid requestId);
+
+    void onListAllTagsPerNoteComplete(
+        QList<Tag> foundTags, Note note,
+        LocalStorageManager::ListObjectsOptions flag, size_t limit,
+        size_t offset, LocalStorageManager::ListTagsOrder order,
+        LocalStorageManager::OrderDirection orderDirection, QUuid requestId);
+
+    void onListAllTagsPerNoteFailed(
+        Note note, LocalStorageManager::ListObjectsOptions flag, size_t limit,
+        size_t offset, LocalStorageManager::ListTagsOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        ErrorString errorDescription, QUuid requestId);
+
+    void onAddNoteComplete(Note note, QUuid requestId);
+
+    void onNoteMovedToAnotherNotebook(
+        QString noteLocalUid, QString previousNotebookLocalUid,
+        QString newNotebookLocalUid);
+
+    void onNoteTagListChanged(
+        QString noteLocalUid, QStringList previousNoteTagLocalUids,
+        QStringList newNoteTagLocalUids);
+
+    void onExpungeNoteComplete(Note note, QUuid requestId);
+
+    void onExpungeNotebookComplete(Notebook notebook, QUuid requestId);
+
+    void onExpungeTagComplete(
+        Tag tag, QStringList expungedChildTagLocalUids, QUuid requestId);
+
+private:
+    void scheduleNoteCountRequestForNotebook(const QString & notebookLocalUid);
+    void scheduleNoteCountRequestForTag(const QString & tagLocalUid);
+    void scheduleNoteCountsRequestForAllTags();
+    void requestTagsPerNote(const Note & note);
+
+    // Re-request the counts which are known, the counts nobody has asked for
+    // yet are left alone
+    void refreshNoteCountForNotebook(const QString & notebookLocalUid);
+    void refreshNoteCountsForAllNotebooks();
+    void refreshNoteCountForTag(const QString & tagLocalUid);
+    void refreshNoteCountsForAllTags();
+
+    void adjustNoteCountForNotebook(
+        const QString & notebookLocalUid, const int delta);
+
+    void adjustNoteCountForTag(const QString & tagLocalUid, const int delta);
+
+    void setNoteCountForNotebook(
+        const QString & notebookLocalUid, const int noteCount);
+
+    void setNoteCountForTag(const QString & tagLocalUid, const int noteCount);
+
+private:
+    Q_DISABLE_COPY(NoteCountAggregator)
+
+private:
+    using LocalUidToRequestIdBimap = boost::bimap<QString, QUuid>;
+
+    LocalStorageManagerAsync & m_localStorageManagerAsync;
+    LocalStorageRequestScheduler * m_pRequestScheduler;
+    bool m_connectedToLocalStorage = false;
+
+    QHash<QString, int> m_noteCountsByNotebookLocalUid;
+    QHash<QString, int> m_noteCountsByTagLocalUid;
+
+    // If true, tags missing from m_noteCountsByTagLocalUid have no notes
+    bool m_hasNoteCountsForAllTags = false;
+
+    LocalUidToRequestIdBimap m_notebookLocalUidToNoteCountRequestIdBimap;
+    LocalUidToRequestIdBimap m_tagLocalUidToNoteCountRequestIdBimap;
+    QUuid m_noteCountsPerAllTagsRequestId;
+    QSet<QUuid> m_listTagsPerNoteRequestIds;
+
+    // Counts which were being requested when the aggregator was disconnected
+    // from local storage
+    QSet<QString> m_notebookLocalUidsPendingReconnection;
+    QSet<QString> m_tagLocalUidsPendingReconnection;
+    bool m_noteCountsForAllTagsPendingReconnection = false;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_MODEL_COMMON_NOTE_COUNT_AGGREGATOR_H
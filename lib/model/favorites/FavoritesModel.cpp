@@ -18,6 +18,9 @@
 
 #include "FavoritesModel.h"
 
+#include <lib/model/common/NoteCountAggregator.h>
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
 
@@ -38,12 +41,42 @@ FavoritesModel::FavoritesModel(
     const Account & account,
     LocalStorageManagerAsync & localStorageManagerAsync, NoteCache & noteCache,
     NotebookCache & notebookCache, TagCache & tagCache,
-    SavedSearchCache & savedSearchCache, QObject * parent) :
+    SavedSearchCache & savedSearchCache, QObject * parent,
+    LocalStorageRequestScheduler * pRequestScheduler,
+    NoteCountAggregator * pNoteCountAggregator) :
     AbstractItemModel(account, parent),
-    m_noteCache(noteCache), m_notebookCache(notebookCache),
-    m_tagCache(tagCache), m_savedSearchCache(savedSearchCache)
+    m_localStorageManagerAsync(localStorageManagerAsync),
+    m_pRequestScheduler(pRequestScheduler),
+    m_pNoteCountAggregator(pNoteCountAggregator), m_noteCache(noteCache),
+    m_notebookCache(notebookCache), m_tagCache(tagCache),
+    m_savedSearchCache(savedSearchCache)
 {
-    createConnections(localStorageManagerAsync);
+    if (!m_pNoteCountAggregator) {
+        m_pNoteCountAggregator = new NoteCountAggregator(
+            localStorageManagerAsync, this, pRequestScheduler);
+
+        m_ownsNoteCountAggregator = true;
+
+        QObject::connect(
+            m_pNoteCountAggregator, &NoteCountAggregator::notifyError, this,
+            &FavoritesModel::notifyError);
+    }
+
+    QObject::connect(
+        m_pNoteCountAggregator,
+        &NoteCountAggregator::noteCountForNotebookChanged, this,
+        &FavoritesModel::onNoteCountForNotebookChanged);
+
+    QObject::connect(
+        m_pNoteCountAggregator, &NoteCountAggregator::noteCountForTagChanged,
+        this, &FavoritesModel::onNoteCountForTagChanged);
+
+    QObject::connect(
+        m_pNoteCountAggregator,
+        &NoteCountAggregator::noteCountsForAllTagsChanged, this,
+        &FavoritesModel::onNoteCountsForAllTagsChanged);
+
+    connectToLocalStorage();
 
     requestNotebooksList();
     requestTagsList();
@@ -777,67 +810,6 @@ void FavoritesModel::onUpdateNoteComplete(
         note, (options & LocalStorageManager::UpdateNoteOption::UpdateTags));
 }
 
-void FavoritesModel::onNoteMovedToAnotherNotebook(
-    QString noteLocalUid, QString previousNotebookLocalUid,
-    QString newNotebookLocalUid)
-{
-    QNDEBUG(
-        "model:favorites",
-        "FavoritesModel::onNoteMovedToAnotherNotebook: "
-            << "note local uid = " << noteLocalUid
-            << ", previous notebook local uid = " << previousNotebookLocalUid
-            << ", new notebook local uid = " << newNotebookLocalUid);
-
-    checkAndDecrementNoteCountPerNotebook(previousNotebookLocalUid);
-    checkAndIncrementNoteCountPerNotebook(newNotebookLocalUid);
-}
-
-void FavoritesModel::onNoteTagListChanged(
-    QString noteLocalUid, QStringList previousNoteTagLocalUids,
-    QStringList newNoteTagLocalUids)
-{
-    QNDEBUG(
-        "model:favorites",
-        "FavoritesModel::onNoteTagListChanged: "
-            << "note local uid = " << noteLocalUid
-            << ", previous tag local uids = "
-            << previousNoteTagLocalUids.join(QStringLiteral(","))
-            << ", new tag local uids = "
-            << newNoteTagLocalUids.join(QStringLiteral(",")));
-
-    std::sort(previousNoteTagLocalUids.begin(), previousNoteTagLocalUids.end());
-    std::sort(newNoteTagLocalUids.begin(), newNoteTagLocalUids.end());
-
-    std::vector<QString> commonTagLocalUids;
-
-    std::set_intersection(
-        previousNoteTagLocalUids.begin(), previousNoteTagLocalUids.end(),
-        newNoteTagLocalUids.begin(), newNoteTagLocalUids.end(),
-        std::back_inserter(commonTagLocalUids));
-
-    for (const auto & tagLocalUid: qAsConst(previousNoteTagLocalUids)) {
-        auto it = std::find(
-            commonTagLocalUids.begin(), commonTagLocalUids.end(), tagLocalUid);
-
-        if (it != commonTagLocalUids.end()) {
-            continue;
-        }
-
-        checkAndDecrementNoteCountPerTag(tagLocalUid);
-    }
-
-    for (const auto & tagLocalUid: qAsConst(newNoteTagLocalUids)) {
-        auto it = std::find(
-            commonTagLocalUids.begin(), commonTagLocalUids.end(), tagLocalUid);
-
-        if (it != commonTagLocalUids.end()) {
-            continue;
-        }
-
-        checkAndIncrementNoteCountPerTag(tagLocalUid);
-    }
-}
-
 void FavoritesModel::onUpdateNoteFailed(
     Note note, LocalStorageManager::UpdateNoteOptions options,
     ErrorString errorDescription, QUuid requestId)
@@ -870,19 +842,23 @@ void FavoritesModel::onUpdateNoteFailed(
 
     Q_UNUSED(m_updateNoteRequestIds.erase(it))
 
-    requestId = QUuid::createUuid();
+    LocalStorageManager::GetNoteOptions getNoteOptions(
+        LocalStorageManager::GetNoteOption::WithResourceMetadata);
+
+    requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, note, getNoteOptions](const QUuid & id) {
+            Q_EMIT findNote(note, getNoteOptions, id);
+        });
+
     Q_UNUSED(m_findNoteToRestoreFailedUpdateRequestIds.insert(requestId))
 
     QNTRACE(
         "model:favorites",
-        "Emitting the request to find a note: "
+        "Scheduled the request to find a note: "
             << "local uid = " << note.localUid()
             << ", request id = " << requestId);
-
-    LocalStorageManager::GetNoteOptions getNoteOptions(
-        LocalStorageManager::GetNoteOption::WithResourceMetadata);
-
-    Q_EMIT findNote(note, getNoteOptions, requestId);
 }
 
 void FavoritesModel::onFindNoteComplete(
@@ -1078,12 +1054,6 @@ void FavoritesModel::onExpungeNoteComplete(Note note, QUuid requestId)
             << note << "\nRequest id = " << requestId);
 
     removeItemByLocalUid(note.localUid());
-
-    // Since it's unclear whether some notebook within the favorites model was
-    // affected, need to check and re-subscribe to the note counts for all
-    // notebooks
-    requestNoteCountForAllNotebooks(NoteCountRequestOption::Force);
-    requestNoteCountForAllTags(NoteCountRequestOption::Force);
 }
 
 void FavoritesModel::onAddNotebookComplete(Notebook notebook, QUuid requestId)
@@ -1129,16 +1099,20 @@ void FavoritesModel::onUpdateNotebookFailed(
 
     Q_UNUSED(m_updateNotebookRequestIds.erase(it))
 
-    requestId = QUuid::createUuid();
+    requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, notebook](const QUuid & id) {
+            Q_EMIT findNotebook(notebook, id);
+        });
+
     Q_UNUSED(m_findNotebookToRestoreFailedUpdateRequestIds.insert(requestId))
 
     QNTRACE(
         "model:favorites",
-        "Emitting the request to find a notebook: "
+        "Scheduled the request to find a notebook: "
             << "local uid = " << notebook.localUid()
             << ", request id = " << requestId);
-
-    Q_EMIT findNotebook(notebook, requestId);
 }
 
 void FavoritesModel::onFindNotebookComplete(Notebook notebook, QUuid requestId)
@@ -1348,16 +1322,18 @@ void FavoritesModel::onUpdateTagFailed(
 
     Q_UNUSED(m_updateTagRequestIds.erase(it))
 
-    requestId = QUuid::createUuid();
+    requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, tag](const QUuid & id) { Q_EMIT findTag(tag, id); });
+
     Q_UNUSED(m_findTagToRestoreFailedUpdateRequestIds.insert(requestId))
 
     QNTRACE(
         "model:favorites",
-        "Emitting the request to find a tag: "
+        "Scheduled the request to find a tag: "
             << "local uid = " << tag.localUid()
             << ", request id = " << requestId);
-
-    Q_EMIT findTag(tag, requestId);
 }
 
 void FavoritesModel::onFindTagComplete(Tag tag, QUuid requestId)
@@ -1566,16 +1542,20 @@ void FavoritesModel::onUpdateSavedSearchFailed(
 
     Q_UNUSED(m_updateSavedSearchRequestIds.erase(it))
 
-    requestId = QUuid::createUuid();
+    requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, search](const QUuid & id) {
+            Q_EMIT findSavedSearch(search, id);
+        });
+
     Q_UNUSED(m_findSavedSearchToRestoreFailedUpdateRequestIds.insert(requestId))
 
     QNTRACE(
         "model:favorites",
-        "Emitting the request to find the saved search: "
+        "Scheduled the request to find the saved search: "
             << "local uid = " << search.localUid()
             << ", request id = " << requestId);
-
-    Q_EMIT findSavedSearch(search, requestId);
 }
 
 void FavoritesModel::onFindSavedSearchComplete(
@@ -1747,365 +1727,286 @@ void FavoritesModel::onExpungeSavedSearchComplete(
     removeItemByLocalUid(search.localUid());
 }
 
-void FavoritesModel::onGetNoteCountPerNotebookComplete(
-    int noteCount, Notebook notebook,
-    LocalStorageManager::NoteCountOptions options, QUuid requestId)
+void FavoritesModel::onNoteCountForNotebookChanged(
+    QString notebookLocalUid, int noteCount)
 {
-    Q_UNUSED(options)
-
-    auto it = m_notebookLocalUidToNoteCountRequestIdBimap.right.find(requestId);
-    if (it == m_notebookLocalUidToNoteCountRequestIdBimap.right.end()) {
-        return;
-    }
-
-    QNDEBUG(
+    QNTRACE(
         "model:favorites",
-        "FavoritesModel::onGetNoteCountPerNotebookComplete: "
-            << "note count = " << noteCount << ", notebook local uid = "
-            << notebook.localUid() << ", request id = " << requestId);
-
-    Q_UNUSED(m_notebookLocalUidToNoteCountRequestIdBimap.right.erase(it))
-
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto itemIt = localUidIndex.find(notebook.localUid());
-    if (Q_UNLIKELY(itemIt == localUidIndex.end())) {
-        QNDEBUG(
-            "model:favorites",
-            "Can't find the notebook item within "
-                << "the favorites model for which the note count was received");
-        return;
-    }
+        "FavoritesModel::onNoteCountForNotebookChanged: "
+            << "notebook local uid = " << notebookLocalUid
+            << ", note count = " << noteCount);
 
-    FavoritesModelItem item = *itemIt;
-    item.setNoteCount(noteCount);
-    Q_UNUSED(localUidIndex.replace(itemIt, item))
-    updateItemColumnInView(item, Column::NoteCount);
+    setNoteCountForItem(notebookLocalUid, noteCount);
 }
 
-void FavoritesModel::onGetNoteCountPerNotebookFailed(
-    ErrorString errorDescription, Notebook notebook,
-    LocalStorageManager::NoteCountOptions options, QUuid requestId)
+void FavoritesModel::onNoteCountForTagChanged(
+    QString tagLocalUid, int noteCount)
 {
-    Q_UNUSED(options)
-
-    auto it = m_notebookLocalUidToNoteCountRequestIdBimap.right.find(requestId);
-    if (it == m_notebookLocalUidToNoteCountRequestIdBimap.right.end()) {
-        return;
-    }
-
-    QNDEBUG(
+    QNTRACE(
         "model:favorites",
-        "FavoritesModel::onGetNoteCountPerNotebookFailed: "
-            << "error description = " << errorDescription
-            << "\nNotebook local uid = " << notebook.localUid()
-            << ", request id = " << requestId);
-
-    Q_UNUSED(m_notebookLocalUidToNoteCountRequestIdBimap.right.erase(it))
-
-    QNWARNING(
-        "model:favorites", errorDescription << ", notebook: " << notebook);
+        "FavoritesModel::onNoteCountForTagChanged: tag local uid = "
+            << tagLocalUid << ", note count = " << noteCount);
 
-    Q_EMIT notifyError(errorDescription);
+    setNoteCountForItem(tagLocalUid, noteCount);
 }
 
-void FavoritesModel::onGetNoteCountPerTagComplete(
-    int noteCount, Tag tag, LocalStorageManager::NoteCountOptions options,
-    QUuid requestId)
+void FavoritesModel::onNoteCountsForAllTagsChanged()
 {
-    Q_UNUSED(options)
+    QNTRACE("model:favorites", "FavoritesModel::onNoteCountsForAllTagsChanged");
 
-    auto it = m_tagLocalUidToNoteCountRequestIdBimap.right.find(requestId);
-    if (it == m_tagLocalUidToNoteCountRequestIdBimap.right.end()) {
-        return;
+    QStringList tagLocalUids;
+    const auto & localUidIndex = m_data.get<ByLocalUid>();
+    for (const auto & item: localUidIndex) {
+        if (item.type() == FavoritesModelItem::Type::Tag) {
+            tagLocalUids << item.localUid();
+        }
     }
 
-    QNDEBUG(
-        "model:favorites",
-        "FavoritesModel::onGetNoteCountPerTagComplete: "
-            << "note count = " << noteCount << ", tag local uid = "
-            << tag.localUid() << ", request id = " << requestId);
-
-    Q_UNUSED(m_tagLocalUidToNoteCountRequestIdBimap.right.erase(it))
-
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto itemIt = localUidIndex.find(tag.localUid());
-    if (Q_UNLIKELY(itemIt == localUidIndex.end())) {
-        QNDEBUG(
-            "model:favorites",
-            "Can't find the tag item within "
-                << "the favorites model for which the note count was received");
-        return;
+    for (const auto & tagLocalUid: qAsConst(tagLocalUids)) {
+        setNoteCountForItem(
+            tagLocalUid, m_pNoteCountAggregator->noteCountForTag(tagLocalUid));
     }
-
-    FavoritesModelItem item = *itemIt;
-    item.setNoteCount(noteCount);
-    Q_UNUSED(localUidIndex.replace(itemIt, item))
-    updateItemColumnInView(item, Column::NoteCount);
 }
 
-void FavoritesModel::onGetNoteCountPerTagFailed(
-    ErrorString errorDescription, Tag tag,
-    LocalStorageManager::NoteCountOptions options, QUuid requestId)
+void FavoritesModel::connectToLocalStorage()
 {
-    Q_UNUSED(options)
+    QNDEBUG("model:favorites", "FavoritesModel::connectToLocalStorage");
 
-    auto it = m_tagLocalUidToNoteCountRequestIdBimap.right.find(requestId);
-    if (it == m_tagLocalUidToNoteCountRequestIdBimap.right.end()) {
+    if (m_connectedToLocalStorage) {
+        QNDEBUG("model:favorites", "Already connected to local storage");
         return;
     }
 
-    QNDEBUG(
-        "model:favorites",
-        "FavoritesModel::onGetNoteCountPerTagFailed: "
-            << "error description = " << errorDescription
-            << "\nTag local uid = " << tag.localUid()
-            << ", request id = " << requestId);
-
-    Q_UNUSED(m_tagLocalUidToNoteCountRequestIdBimap.right.erase(it))
-
-    QNWARNING("model:favorites", errorDescription << ", tag: " << tag);
-    Q_EMIT notifyError(errorDescription);
-}
-
-void FavoritesModel::createConnections(
-    LocalStorageManagerAsync & localStorageManagerAsync)
-{
-    QNDEBUG("model:favorites", "FavoritesModel::createConnections");
-
     // Connect local signals to localStorageManagerAsync's slots
     QObject::connect(
-        this, &FavoritesModel::updateNote, &localStorageManagerAsync,
+        this, &FavoritesModel::updateNote, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onUpdateNoteRequest);
 
     QObject::connect(
-        this, &FavoritesModel::findNote, &localStorageManagerAsync,
+        this, &FavoritesModel::findNote, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onFindNoteRequest);
 
     QObject::connect(
-        this, &FavoritesModel::listNotes, &localStorageManagerAsync,
+        this, &FavoritesModel::listNotes, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onListNotesRequest);
 
     QObject::connect(
-        this, &FavoritesModel::updateNotebook, &localStorageManagerAsync,
+        this, &FavoritesModel::updateNotebook, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onUpdateNotebookRequest);
 
     QObject::connect(
-        this, &FavoritesModel::findNotebook, &localStorageManagerAsync,
+        this, &FavoritesModel::findNotebook, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onFindNotebookRequest);
 
     QObject::connect(
-        this, &FavoritesModel::listNotebooks, &localStorageManagerAsync,
+        this, &FavoritesModel::listNotebooks, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onListNotebooksRequest);
 
     QObject::connect(
-        this, &FavoritesModel::updateTag, &localStorageManagerAsync,
+        this, &FavoritesModel::updateTag, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onUpdateTagRequest);
 
     QObject::connect(
-        this, &FavoritesModel::findTag, &localStorageManagerAsync,
+        this, &FavoritesModel::findTag, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onFindTagRequest);
 
     QObject::connect(
-        this, &FavoritesModel::listTags, &localStorageManagerAsync,
+        this, &FavoritesModel::listTags, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onListTagsRequest);
 
     QObject::connect(
-        this, &FavoritesModel::updateSavedSearch, &localStorageManagerAsync,
+        this, &FavoritesModel::updateSavedSearch, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onUpdateSavedSearchRequest);
 
     QObject::connect(
-        this, &FavoritesModel::findSavedSearch, &localStorageManagerAsync,
+        this, &FavoritesModel::findSavedSearch, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onFindSavedSearchRequest);
 
     QObject::connect(
-        this, &FavoritesModel::listSavedSearches, &localStorageManagerAsync,
+        this, &FavoritesModel::listSavedSearches, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onListSavedSearchesRequest);
 
+    // Connect m_localStorageManagerAsync's signals to local slots
     QObject::connect(
-        this, &FavoritesModel::noteCountPerNotebook, &localStorageManagerAsync,
-        &LocalStorageManagerAsync::onGetNoteCountPerNotebookRequest);
-
-    QObject::connect(
-        this, &FavoritesModel::noteCountPerTag, &localStorageManagerAsync,
-        &LocalStorageManagerAsync::onGetNoteCountPerTagRequest);
-
-    // Connect localStorageManagerAsync's signals to local slots
-    QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::addNoteComplete,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::addNoteComplete,
         this, &FavoritesModel::onAddNoteComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateNoteComplete, this,
         &FavoritesModel::onUpdateNoteComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::noteMovedToAnotherNotebook, this,
-        &FavoritesModel::onNoteMovedToAnotherNotebook);
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::updateNoteFailed, this,
+        &FavoritesModel::onUpdateNoteFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::noteTagListChanged, this,
-        &FavoritesModel::onNoteTagListChanged);
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::findNoteComplete, this,
+        &FavoritesModel::onFindNoteComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::updateNoteFailed,
-        this, &FavoritesModel::onUpdateNoteFailed);
-
-    QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::findNoteComplete,
-        this, &FavoritesModel::onFindNoteComplete);
-
-    QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::findNoteFailed,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::findNoteFailed,
         this, &FavoritesModel::onFindNoteFailed);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::listNotesComplete,
-        this, &FavoritesModel::onListNotesComplete);
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listNotesComplete, this,
+        &FavoritesModel::onListNotesComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::listNotesFailed,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::listNotesFailed,
         this, &FavoritesModel::onListNotesFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeNoteComplete, this,
         &FavoritesModel::onExpungeNoteComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::addNotebookComplete, this,
         &FavoritesModel::onAddNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateNotebookComplete, this,
         &FavoritesModel::onUpdateNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateNotebookFailed, this,
         &FavoritesModel::onUpdateNotebookFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findNotebookComplete, this,
         &FavoritesModel::onFindNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findNotebookFailed, this,
         &FavoritesModel::onFindNotebookFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listNotebooksComplete, this,
         &FavoritesModel::onListNotebooksComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listNotebooksFailed, this,
         &FavoritesModel::onListNotebooksFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeNotebookComplete, this,
         &FavoritesModel::onExpungeNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::addTagComplete,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::addTagComplete,
         this, &FavoritesModel::onAddTagComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::updateTagComplete,
-        this, &FavoritesModel::onUpdateTagComplete);
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::updateTagComplete, this,
+        &FavoritesModel::onUpdateTagComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::updateTagFailed,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::updateTagFailed,
         this, &FavoritesModel::onUpdateTagFailed);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::findTagComplete,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::findTagComplete,
         this, &FavoritesModel::onFindTagComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::findTagFailed,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::findTagFailed,
         this, &FavoritesModel::onFindTagFailed);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::listTagsComplete,
-        this, &FavoritesModel::onListTagsComplete);
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listTagsComplete, this,
+        &FavoritesModel::onListTagsComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::listTagsFailed,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::listTagsFailed,
         this, &FavoritesModel::onListTagsFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeTagComplete, this,
         &FavoritesModel::onExpungeTagComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::addSavedSearchComplete, this,
         &FavoritesModel::onAddSavedSearchComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateSavedSearchComplete, this,
         &FavoritesModel::onUpdateSavedSearchComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateSavedSearchFailed, this,
         &FavoritesModel::onUpdateSavedSearchFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findSavedSearchComplete, this,
         &FavoritesModel::onFindSavedSearchComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findSavedSearchFailed, this,
         &FavoritesModel::onFindSavedSearchFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listSavedSearchesComplete, this,
         &FavoritesModel::onListSavedSearchesComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listSavedSearchesFailed, this,
         &FavoritesModel::onListSavedSearchesFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeSavedSearchComplete, this,
         &FavoritesModel::onExpungeSavedSearchComplete);
 
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountPerNotebookComplete, this,
-        &FavoritesModel::onGetNoteCountPerNotebookComplete);
+    if (m_ownsNoteCountAggregator) {
+        m_pNoteCountAggregator->connectToLocalStorage();
+    }
 
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountPerNotebookFailed, this,
-        &FavoritesModel::onGetNoteCountPerNotebookFailed);
+    m_connectedToLocalStorage = true;
+}
 
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountPerTagComplete, this,
-        &FavoritesModel::onGetNoteCountPerTagComplete);
+void FavoritesModel::disconnectFromLocalStorage()
+{
+    QNDEBUG("model:favorites", "FavoritesModel::disconnectFromLocalStorage");
 
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountPerTagFailed, this,
-        &FavoritesModel::onGetNoteCountPerTagFailed);
+    if (!m_connectedToLocalStorage) {
+        QNDEBUG("model:favorites", "Already disconnected from local storage");
+        return;
+    }
+
+    QObject::disconnect(&m_localStorageManagerAsync);
+    m_localStorageManagerAsync.disconnect(this);
+    m_connectedToLocalStorage = false;
+
+    // Queued requests would go nowhere now
+    if (m_pRequestScheduler) {
+        m_pRequestScheduler->cancelRequests(*this);
+    }
+
+    if (m_ownsNoteCountAggregator) {
+        m_pNoteCountAggregator->disconnectFromLocalStorage();
+    }
 }
 
 void FavoritesModel::requestNotesList()
@@ -2123,22 +2024,26 @@ void FavoritesModel::requestNotesList()
     LocalStorageManager::OrderDirection direction =
         LocalStorageManager::OrderDirection::Ascending;
 
-    m_listNotesRequestId = QUuid::createUuid();
-
-    QNTRACE(
-        "model:favorites",
-        "Emitting the request to list notes: offset = "
-            << m_listNotesOffset << ", request id = " << m_listNotesRequestId);
+    const size_t offset = m_listNotesOffset;
 
-    Q_EMIT listNotes(
-        flags,
+    m_listNotesRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, flags, offset, order, direction](const QUuid & id) {
+            Q_EMIT listNotes(
+                flags,
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        LocalStorageManager::GetNoteOptions(),
+                LocalStorageManager::GetNoteOptions(),
 #else
-        LocalStorageManager::GetNoteOptions(0),
+                LocalStorageManager::GetNoteOptions(0),
 #endif
-        NOTE_LIST_LIMIT, m_listNotesOffset, order, direction, QString(),
-        m_listNotesRequestId);
+                NOTE_LIST_LIMIT, offset, order, direction, QString(), id);
+        });
+
+    QNTRACE(
+        "model:favorites",
+        "Scheduled the request to list notes: offset = "
+            << m_listNotesOffset << ", request id = " << m_listNotesRequestId);
 }
 
 void FavoritesModel::requestNotebooksList()
@@ -2161,17 +2066,26 @@ void FavoritesModel::requestNotebooksList()
     LocalStorageManager::OrderDirection direction =
         LocalStorageManager::OrderDirection::Ascending;
 
-    m_listNotebooksRequestId = QUuid::createUuid();
+    const size_t offset = m_listNotebooksOffset;
+
+    // Notebook model lists all notebooks in the same way
+    m_listNotebooksRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, flags, offset, order, direction](const QUuid & id) {
+            Q_EMIT listNotebooks(
+                flags, NOTEBOOK_LIST_LIMIT, offset, order, direction,
+                QString(), id);
+        },
+        localStorageRequestKey(
+            "listNotebooks", flags, NOTEBOOK_LIST_LIMIT, offset, order,
+            direction, QString()));
 
     QNTRACE(
         "model:favorites",
-        "Emitting the request to list notebooks: "
+        "Scheduled the request to list notebooks: "
             << "offset = " << m_listNotebooksOffset
             << ", request id = " << m_listNotebooksRequestId);
-
-    Q_EMIT listNotebooks(
-        flags, NOTEBOOK_LIST_LIMIT, m_listNotebooksOffset, order, direction,
-        QString(), m_listNotebooksRequestId);
 }
 
 void FavoritesModel::requestTagsList()
@@ -2192,16 +2106,24 @@ void FavoritesModel::requestTagsList()
     LocalStorageManager::OrderDirection direction =
         LocalStorageManager::OrderDirection::Ascending;
 
-    m_listTagsRequestId = QUuid::createUuid();
+    const size_t offset = m_listTagsOffset;
+
+    m_listTagsRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, flags, offset, order, direction](const QUuid & id) {
+            Q_EMIT listTags(
+                flags, TAG_LIST_LIMIT, offset, order, direction, QString(),
+                id);
+        },
+        localStorageRequestKey(
+            "listTags", flags, TAG_LIST_LIMIT, offset, order, direction,
+            QString()));
 
     QNTRACE(
         "model:favorites",
-        "Emitting the request to list tags: offset = "
+        "Scheduled the request to list tags: offset = "
             << m_listTagsOffset << ", request id = " << m_listTagsRequestId);
-
-    Q_EMIT listTags(
-        flags, TAG_LIST_LIMIT, m_listTagsOffset, order, direction, QString(),
-        m_listTagsRequestId);
 }
 
 void FavoritesModel::requestSavedSearchesList()
@@ -2223,271 +2145,82 @@ void FavoritesModel::requestSavedSearchesList()
     LocalStorageManager::OrderDirection direction =
         LocalStorageManager::OrderDirection::Ascending;
 
-    m_listSavedSearchesRequestId = QUuid::createUuid();
+    const size_t offset = m_listSavedSearchesOffset;
+
+    m_listSavedSearchesRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, flags, offset, order, direction](const QUuid & id) {
+            Q_EMIT listSavedSearches(
+                flags, SAVED_SEARCH_LIST_LIMIT, offset, order, direction, id);
+        },
+        localStorageRequestKey(
+            "listSavedSearches", flags, SAVED_SEARCH_LIST_LIMIT, offset, order,
+            direction));
 
     QNTRACE(
         "model:favorites",
-        "Emitting the request to list saved searches: "
+        "Scheduled the request to list saved searches: "
             << "offset = " << m_listSavedSearchesOffset
             << ", request id = " << m_listSavedSearchesRequestId);
-
-    Q_EMIT listSavedSearches(
-        flags, SAVED_SEARCH_LIST_LIMIT, m_listSavedSearchesOffset, order,
-        direction, m_listSavedSearchesRequestId);
 }
 
 void FavoritesModel::requestNoteCountForNotebook(
-    const QString & notebookLocalUid, const NoteCountRequestOption::type option)
-{
-    QNDEBUG(
-        "model:favorites",
-        "FavoritesModel::requestNoteCountForNotebook: "
-            << "notebook lcoal uid = " << notebookLocalUid
-            << ", note count request option = " << option);
-
-    if (option != NoteCountRequestOption::Force) {
-        auto it = m_notebookLocalUidToNoteCountRequestIdBimap.left.find(
-            notebookLocalUid);
-
-        if (it != m_notebookLocalUidToNoteCountRequestIdBimap.left.end()) {
-            QNDEBUG(
-                "model:favorites",
-                "There's an active request to fetch "
-                    << "the note count for this notebook local uid");
-            return;
-        }
-    }
-
-    auto requestId = QUuid::createUuid();
-
-    m_notebookLocalUidToNoteCountRequestIdBimap.insert(
-        LocalUidToRequestIdBimap::value_type(notebookLocalUid, requestId));
-
-    Notebook dummyNotebook;
-    dummyNotebook.setLocalUid(notebookLocalUid);
-
-    QNTRACE(
-        "model:favorites",
-        "Emitting the request to get the note count "
-            << "per notebook: notebook local uid = " << notebookLocalUid
-            << ", request id = " << requestId);
-
-    LocalStorageManager::NoteCountOptions options(
-        LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes);
-
-    Q_EMIT noteCountPerNotebook(dummyNotebook, options, requestId);
-}
-
-void FavoritesModel::requestNoteCountForAllNotebooks(
-    const NoteCountRequestOption::type option)
-{
-    QNDEBUG(
-        "model:favorites",
-        "FavoritesModel::requestNoteCountForAllNotebooks: "
-            << "note count request option = " << option);
-
-    const auto & localUidIndex = m_data.get<ByLocalUid>();
-
-    for (const auto & item: localUidIndex) {
-        if (item.type() != FavoritesModelItem::Type::Notebook) {
-            continue;
-        }
-
-        requestNoteCountForNotebook(item.localUid(), option);
-    }
-}
-
-void FavoritesModel::checkAndIncrementNoteCountPerNotebook(
-    const QString & notebookLocalUid)
-{
-    QNDEBUG(
-        "model:favorites",
-        "FavoritesModel::checkAndIncrementNoteCountPerNotebook: "
-            << notebookLocalUid);
-
-    checkAndAdjustNoteCountPerNotebook(
-        notebookLocalUid,
-        /* increment = */ true);
-}
-
-void FavoritesModel::checkAndDecrementNoteCountPerNotebook(
     const QString & notebookLocalUid)
 {
     QNDEBUG(
         "model:favorites",
-        "FavoritesModel::checkAndDecrementNoteCountPerNotebook: "
-            << notebookLocalUid);
-
-    checkAndAdjustNoteCountPerNotebook(
-        notebookLocalUid,
-        /* increment = */ false);
-}
+        "FavoritesModel::requestNoteCountForNotebook: " << notebookLocalUid);
 
-void FavoritesModel::checkAndAdjustNoteCountPerNotebook(
-    const QString & notebookLocalUid, const bool increment)
-{
-    auto requestIt =
-        m_notebookLocalUidToNoteCountRequestIdBimap.left.find(notebookLocalUid);
-
-    if (requestIt != m_notebookLocalUidToNoteCountRequestIdBimap.left.end()) {
-        QNDEBUG(
-            "model:favorites",
-            "There's an active request to fetch "
-                << "the note count for notebook " << notebookLocalUid << ": "
-                << requestIt->second
-                << ", need to restart it to ensure the proper "
-                << "number of notes per notebook");
-
-        requestNoteCountForNotebook(
-            notebookLocalUid, NoteCountRequestOption::Force);
+    // Notebook model is likely to have asked for this count already
+    const int noteCount =
+        m_pNoteCountAggregator->noteCountForNotebook(notebookLocalUid);
 
+    if (noteCount >= 0) {
+        setNoteCountForItem(notebookLocalUid, noteCount);
         return;
     }
 
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto notebookItemIt = localUidIndex.find(notebookLocalUid);
-    if (notebookItemIt == localUidIndex.end()) {
-        QNDEBUG(
-            "model:favorites",
-            "Notebook is not within "
-                << "the favorites model");
-        return;
-    }
-
-    FavoritesModelItem item = *notebookItemIt;
-    int noteCount = item.noteCount();
-
-    if (increment) {
-        ++noteCount;
-        QNDEBUG("model:favorites", "Incremented to " << noteCount);
-    }
-    else {
-        --noteCount;
-        QNDEBUG("model:favorites", "Decremented to " << noteCount);
-    }
-
-    item.setNoteCount(std::max(noteCount, 0));
-    Q_UNUSED(localUidIndex.replace(notebookItemIt, item))
-
-    updateItemColumnInView(item, Column::NoteCount);
+    m_pNoteCountAggregator->requestNoteCountForNotebook(notebookLocalUid);
 }
 
-void FavoritesModel::requestNoteCountForTag(
-    const QString & tagLocalUid, const NoteCountRequestOption::type option)
+void FavoritesModel::requestNoteCountForTag(const QString & tagLocalUid)
 {
     QNDEBUG(
         "model:favorites",
-        "FavoritesModel::requestNoteCountForTag: "
-            << "tag local uid = " << tagLocalUid
-            << ", note count request option = " << option);
-
-    if (option != NoteCountRequestOption::Force) {
-        auto it = m_tagLocalUidToNoteCountRequestIdBimap.left.find(tagLocalUid);
-        if (it != m_tagLocalUidToNoteCountRequestIdBimap.left.end()) {
-            QNDEBUG(
-                "model:favorites",
-                "There's an active request to fetch "
-                    << "the note count for this tag local uid");
-            return;
-        }
-    }
-
-    QUuid requestId = QUuid::createUuid();
-
-    m_tagLocalUidToNoteCountRequestIdBimap.insert(
-        LocalUidToRequestIdBimap::value_type(tagLocalUid, requestId));
-
-    Tag dummyTag;
-    dummyTag.setLocalUid(tagLocalUid);
-
-    QNTRACE(
-        "model:favorites",
-        "Emitting the request to get the note count per "
-            << "tag: tag local uid = " << tagLocalUid
-            << ", request id = " << requestId);
-
-    LocalStorageManager::NoteCountOptions options(
-        LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes);
-
-    Q_EMIT noteCountPerTag(dummyTag, options, requestId);
-}
-
-void FavoritesModel::requestNoteCountForAllTags(
-    const NoteCountRequestOption::type option)
-{
-    QNDEBUG("model:favorites", "FavoritesModel::requestNoteCountForAllTags");
-
-    const auto & localUidIndex = m_data.get<ByLocalUid>();
+        "FavoritesModel::requestNoteCountForTag: " << tagLocalUid);
 
-    for (const auto & item: localUidIndex) {
-        if (item.type() != FavoritesModelItem::Type::Tag) {
-            continue;
-        }
-
-        requestNoteCountForTag(item.localUid(), option);
+    // Tag model is likely to have asked for this count already
+    const int noteCount = m_pNoteCountAggregator->noteCountForTag(tagLocalUid);
+    if (noteCount >= 0) {
+        setNoteCountForItem(tagLocalUid, noteCount);
+        return;
     }
-}
-
-void FavoritesModel::checkAndIncrementNoteCountPerTag(
-    const QString & tagLocalUid)
-{
-    QNDEBUG(
-        "model:favorites",
-        "FavoritesModel::checkAndIncrementNoteCountPerTag: " << tagLocalUid);
 
-    checkAndAdjustNoteCountPerTag(tagLocalUid, /* increment = */ true);
+    m_pNoteCountAggregator->requestNoteCountForTag(tagLocalUid);
 }
 
-void FavoritesModel::checkAndDecrementNoteCountPerTag(
-    const QString & tagLocalUid)
+void FavoritesModel::setNoteCountForItem(
+    const QString & localUid, const int noteCount)
 {
-    QNDEBUG(
-        "model:favorites",
-        "FavoritesModel::checkAndDecrementNoteCountPerTag: " << tagLocalUid);
-
-    checkAndAdjustNoteCountPerTag(tagLocalUid, /* increment = */ false);
-}
-
-void FavoritesModel::checkAndAdjustNoteCountPerTag(
-    const QString & tagLocalUid, const bool increment)
-{
-    auto requestIt =
-        m_tagLocalUidToNoteCountRequestIdBimap.left.find(tagLocalUid);
-
-    if (requestIt != m_tagLocalUidToNoteCountRequestIdBimap.left.end()) {
-        QNDEBUG(
-            "model:favorites",
-            "There's an active request to fetch "
-                << "the note count for tag " << tagLocalUid << ": "
-                << requestIt->second
-                << ", need to restart it to ensure the proper "
-                << "number of notes per tag");
-        requestNoteCountForTag(tagLocalUid, NoteCountRequestOption::Force);
+    if (noteCount < 0) {
+        // The count is unknown at the moment, keep the last known one
         return;
     }
 
     auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto tagItemIt = localUidIndex.find(tagLocalUid);
-    if (tagItemIt == localUidIndex.end()) {
-        QNDEBUG("model:favorites", "Tag is not within the favorites model");
+    auto itemIt = localUidIndex.find(localUid);
+    if (itemIt == localUidIndex.end()) {
         return;
     }
 
-    FavoritesModelItem item = *tagItemIt;
-    int noteCount = item.noteCount();
-
-    if (increment) {
-        ++noteCount;
-        QNDEBUG("model:favorites", "Incremented to " << noteCount);
-    }
-    else {
-        --noteCount;
-        QNDEBUG("model:favorites", "Decremented to " << noteCount);
+    if (itemIt->noteCount() == noteCount) {
+        return;
     }
 
-    item.setNoteCount(std::max(noteCount, 0));
-    Q_UNUSED(localUidIndex.replace(tagItemIt, item))
-
+    FavoritesModelItem item = *itemIt;
+    item.setNoteCount(noteCount);
+    Q_UNUSED(localUidIndex.replace(itemIt, item))
     updateItemColumnInView(item, Column::NoteCount);
 }
 
@@ -2747,22 +2480,26 @@ void FavoritesModel::updateNoteInLocalStorage(const FavoritesModelItem & item)
 
     const auto * pCachedNote = m_noteCache.get(item.localUid());
     if (Q_UNLIKELY(!pCachedNote)) {
-        auto requestId = QUuid::createUuid();
-        Q_UNUSED(m_findNoteToPerformUpdateRequestIds.insert(requestId))
-
         Note dummy;
         dummy.setLocalUid(item.localUid());
 
+        LocalStorageManager::GetNoteOptions options(
+            LocalStorageManager::GetNoteOption::WithResourceMetadata);
+
+        auto requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::Interactive,
+            [this, dummy, options](const QUuid & id) {
+                Q_EMIT findNote(dummy, options, id);
+            });
+
+        Q_UNUSED(m_findNoteToPerformUpdateRequestIds.insert(requestId))
+
         QNTRACE(
             "model:favorites",
-            "Emitting the request to find a note: "
+            "Scheduled the request to find a note: "
                 << "local uid = " << item.localUid()
                 << ", request id = " << requestId);
-
-        LocalStorageManager::GetNoteOptions options(
-            LocalStorageManager::GetNoteOption::WithResourceMetadata);
-
-        Q_EMIT findNote(dummy, options, requestId);
         return;
     }
 
@@ -2787,14 +2524,17 @@ void FavoritesModel::updateNoteInLocalStorage(const FavoritesModelItem & item)
         "Emitting the request to update the note in "
             << "the local storage: id = " << requestId << ", note: " << note);
 
-    Q_EMIT updateNote(
-        note,
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT updateNote(
+                note,
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        LocalStorageManager::UpdateNoteOptions(),
+                LocalStorageManager::UpdateNoteOptions(),
 #else
-        LocalStorageManager::UpdateNoteOptions(0),
+                LocalStorageManager::UpdateNoteOptions(0),
 #endif
-        requestId);
+                id);
+        });
 }
 
 void FavoritesModel::updateNotebookInLocalStorage(
@@ -2808,19 +2548,23 @@ void FavoritesModel::updateNotebookInLocalStorage(
 
     const auto * pCachedNotebook = m_notebookCache.get(item.localUid());
     if (Q_UNLIKELY(!pCachedNotebook)) {
-        auto requestId = QUuid::createUuid();
-        Q_UNUSED(m_findNotebookToPerformUpdateRequestIds.insert(requestId))
-
         Notebook dummy;
         dummy.setLocalUid(item.localUid());
 
+        auto requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::Interactive,
+            [this, dummy](const QUuid & id) {
+                Q_EMIT findNotebook(dummy, id);
+            });
+
+        Q_UNUSED(m_findNotebookToPerformUpdateRequestIds.insert(requestId))
+
         QNTRACE(
             "model:favorites",
-            "Emitting the request to find a notebook: "
+            "Scheduled the request to find a notebook: "
                 << "local uid = " << item.localUid()
                 << ", request id = " << requestId);
-
-        Q_EMIT findNotebook(dummy, requestId);
         return;
     }
 
@@ -2846,7 +2590,10 @@ void FavoritesModel::updateNotebookInLocalStorage(
             << "the local storage: id = " << requestId
             << ", notebook: " << notebook);
 
-    Q_EMIT updateNotebook(notebook, requestId);
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT updateNotebook(notebook, id);
+        });
 }
 
 void FavoritesModel::updateTagInLocalStorage(const FavoritesModelItem & item)
@@ -2859,19 +2606,21 @@ void FavoritesModel::updateTagInLocalStorage(const FavoritesModelItem & item)
 
     const auto * pCachedTag = m_tagCache.get(item.localUid());
     if (Q_UNLIKELY(!pCachedTag)) {
-        auto requestId = QUuid::createUuid();
-        Q_UNUSED(m_findTagToPerformUpdateRequestIds.insert(requestId))
-
         Tag dummy;
         dummy.setLocalUid(item.localUid());
 
+        auto requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::Interactive,
+            [this, dummy](const QUuid & id) { Q_EMIT findTag(dummy, id); });
+
+        Q_UNUSED(m_findTagToPerformUpdateRequestIds.insert(requestId))
+
         QNTRACE(
             "model:favorites",
-            "Emitting the request to find a tag: "
+            "Scheduled the request to find a tag: "
                 << "local uid = " << item.localUid()
                 << ", request id = " << requestId);
-
-        Q_EMIT findTag(dummy, requestId);
         return;
     }
 
@@ -2895,7 +2644,10 @@ void FavoritesModel::updateTagInLocalStorage(const FavoritesModelItem & item)
         "model:favorites",
         "Emitting the request to update the tag in "
             << "the local storage: id = " << requestId << ", tag: " << tag);
-    Q_EMIT updateTag(tag, requestId);
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT updateTag(tag, id);
+        });
 }
 
 void FavoritesModel::updateSavedSearchInLocalStorage(
@@ -2908,19 +2660,23 @@ void FavoritesModel::updateSavedSearchInLocalStorage(
 
     const auto * pCachedSearch = m_savedSearchCache.get(item.localUid());
     if (Q_UNLIKELY(!pCachedSearch)) {
-        auto requestId = QUuid::createUuid();
-        Q_UNUSED(m_findSavedSearchToPerformUpdateRequestIds.insert(requestId))
-
         SavedSearch dummy;
         dummy.setLocalUid(item.localUid());
 
+        auto requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::Interactive,
+            [this, dummy](const QUuid & id) {
+                Q_EMIT findSavedSearch(dummy, id);
+            });
+
+        Q_UNUSED(m_findSavedSearchToPerformUpdateRequestIds.insert(requestId))
+
         QNTRACE(
             "model:favorites",
-            "Emitting the request to find a saved "
+            "Scheduled the request to find a saved "
                 << "search: local uid = " << item.localUid()
                 << ", request id = " << requestId);
-
-        Q_EMIT findSavedSearch(dummy, requestId);
         return;
     }
 
@@ -2946,7 +2702,10 @@ void FavoritesModel::updateSavedSearchInLocalStorage(
             << "search in the local storage: id = " << requestId
             << ", saved search: " << search);
 
-    Q_EMIT updateSavedSearch(search, requestId);
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT updateSavedSearch(search, id);
+        });
 }
 
 bool FavoritesModel::canUpdateNote(const QString & localUid) const
@@ -3022,22 +2781,26 @@ void FavoritesModel::unfavoriteNote(const QString & localUid)
 
     const auto * pCachedNote = m_noteCache.get(localUid);
     if (Q_UNLIKELY(!pCachedNote)) {
-        auto requestId = QUuid::createUuid();
-        Q_UNUSED(m_findNoteToUnfavoriteRequestIds.insert(requestId))
-
         Note dummy;
         dummy.setLocalUid(localUid);
 
+        LocalStorageManager::GetNoteOptions options(
+            LocalStorageManager::GetNoteOption::WithResourceMetadata);
+
+        auto requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::Interactive,
+            [this, dummy, options](const QUuid & id) {
+                Q_EMIT findNote(dummy, options, id);
+            });
+
+        Q_UNUSED(m_findNoteToUnfavoriteRequestIds.insert(requestId))
+
         QNTRACE(
             "model:favorites",
-            "Emitting the request to find a note: "
+            "Scheduled the request to find a note: "
                 << "local uid = " << localUid
                 << ", request id = " << requestId);
-
-        LocalStorageManager::GetNoteOptions options(
-            LocalStorageManager::GetNoteOption::WithResourceMetadata);
-
-        Q_EMIT findNote(dummy, options, requestId);
         return;
     }
 
@@ -3059,14 +2822,17 @@ void FavoritesModel::unfavoriteNote(const QString & localUid)
         "Emitting the request to update the note in "
             << "the local storage: id = " << requestId << ", note: " << note);
 
-    Q_EMIT updateNote(
-        note,
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT updateNote(
+                note,
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        LocalStorageManager::UpdateNoteOptions(),
+                LocalStorageManager::UpdateNoteOptions(),
 #else
-        LocalStorageManager::UpdateNoteOptions(0),
+                LocalStorageManager::UpdateNoteOptions(0),
 #endif
-        requestId);
+                id);
+        });
 }
 
 void FavoritesModel::unfavoriteNotebook(const QString & localUid)
@@ -3078,19 +2844,23 @@ void FavoritesModel::unfavoriteNotebook(const QString & localUid)
 
     const auto * pCachedNotebook = m_notebookCache.get(localUid);
     if (Q_UNLIKELY(!pCachedNotebook)) {
-        auto requestId = QUuid::createUuid();
-        Q_UNUSED(m_findNotebookToUnfavoriteRequestIds.insert(requestId))
-
         Notebook dummy;
         dummy.setLocalUid(localUid);
 
+        auto requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::Interactive,
+            [this, dummy](const QUuid & id) {
+                Q_EMIT findNotebook(dummy, id);
+            });
+
+        Q_UNUSED(m_findNotebookToUnfavoriteRequestIds.insert(requestId))
+
         QNTRACE(
             "model:favorites",
-            "Emitting the request to find a notebook: "
+            "Scheduled the request to find a notebook: "
                 << "local uid = " << localUid
                 << ", request id = " << requestId);
-
-        Q_EMIT findNotebook(dummy, requestId);
         return;
     }
 
@@ -3114,7 +2884,10 @@ void FavoritesModel::unfavoriteNotebook(const QString & localUid)
             << "the local storage: id = " << requestId
             << ", notebook: " << notebook);
 
-    Q_EMIT updateNotebook(notebook, requestId);
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT updateNotebook(notebook, id);
+        });
 }
 
 void FavoritesModel::unfavoriteTag(const QString & localUid)
@@ -3125,19 +2898,21 @@ void FavoritesModel::unfavoriteTag(const QString & localUid)
 
     const auto * pCachedTag = m_tagCache.get(localUid);
     if (Q_UNLIKELY(!pCachedTag)) {
-        auto requestId = QUuid::createUuid();
-        Q_UNUSED(m_findTagToUnfavoriteRequestIds.insert(requestId))
-
         Tag dummy;
         dummy.setLocalUid(localUid);
 
+        auto requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::Interactive,
+            [this, dummy](const QUuid & id) { Q_EMIT findTag(dummy, id); });
+
+        Q_UNUSED(m_findTagToUnfavoriteRequestIds.insert(requestId))
+
         QNTRACE(
             "model:favorites",
-            "Emitting the request to find a tag: "
+            "Scheduled the request to find a tag: "
                 << "local uid = " << localUid
                 << ", request id = " << requestId);
-
-        Q_EMIT findTag(dummy, requestId);
         return;
     }
 
@@ -3160,7 +2935,10 @@ void FavoritesModel::unfavoriteTag(const QString & localUid)
         "Emitting the request to update the tag in "
             << "the local storage: id = " << requestId << ", tag: " << tag);
 
-    Q_EMIT updateTag(tag, requestId);
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT updateTag(tag, id);
+        });
 }
 
 void FavoritesModel::unfavoriteSavedSearch(const QString & localUid)
@@ -3171,19 +2949,23 @@ void FavoritesModel::unfavoriteSavedSearch(const QString & localUid)
 
     const auto * pCachedSearch = m_savedSearchCache.get(localUid);
     if (Q_UNLIKELY(!pCachedSearch)) {
-        auto requestId = QUuid::createUuid();
-        Q_UNUSED(m_findSavedSearchToUnfavoriteRequestIds.insert(requestId))
-
         SavedSearch dummy;
         dummy.setLocalUid(localUid);
 
+        auto requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::Interactive,
+            [this, dummy](const QUuid & id) {
+                Q_EMIT findSavedSearch(dummy, id);
+            });
+
+        Q_UNUSED(m_findSavedSearchToUnfavoriteRequestIds.insert(requestId))
+
         QNTRACE(
             "model:favorites",
-            "Emitting the request to find a saved "
+            "Scheduled the request to find a saved "
                 << "search: local uid = " << localUid
                 << ", request id = " << requestId);
-
-        Q_EMIT findSavedSearch(dummy, requestId);
         return;
     }
 
@@ -3207,7 +2989,10 @@ void FavoritesModel::unfavoriteSavedSearch(const QString & localUid)
             << "search in the local storage: id = " << requestId
             << ", saved search: " << search);
 
-    Q_EMIT updateSavedSearch(search, requestId);
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT updateSavedSearch(search, id);
+        });
 }
 
 void FavoritesModel::onNoteAddedOrUpdated(
@@ -3415,8 +3200,7 @@ void FavoritesModel::onNotebookAddedOrUpdated(const Notebook & notebook)
         Q_EMIT addedItem(addedNotebookIndex);
 
         // Need to figure out how many notes this notebook targets
-        requestNoteCountForNotebook(
-            notebook.localUid(), NoteCountRequestOption::IfNotAlreadyRunning);
+        requestNoteCountForNotebook(notebook.localUid());
 
         return;
     }
@@ -3517,8 +3301,7 @@ void FavoritesModel::onTagAddedOrUpdated(const Tag & tag)
         Q_EMIT addedItem(addedTagIndex);
 
         // Need to figure out how many notes this tag targets
-        requestNoteCountForTag(
-            tag.localUid(), NoteCountRequestOption::IfNotAlreadyRunning);
+        requestNoteCountForTag(tag.localUid());
 
         return;
     }
@@ -22,6 +22,7 @@
 #include "FavoritesModelItem.h"
 
 #include <lib/model/common/AbstractItemModel.h>
+#include <lib/model/common/LocalStorageRequestScheduler.h>
 #include <lib/model/note/NoteCache.h>
 #include <lib/model/notebook/NotebookCache.h>
 #include <lib/model/saved_search/SavedSearchCache.h>
@@ -45,7 +46,6 @@ SAVE_WARNINGS
 
 MSVC_SUPPRESS_WARNING(4834)
 
-#include <boost/bimap.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/random_access_index.hpp>
@@ -57,6 +57,8 @@ QT_FORWARD_DECLARE_CLASS(QDebug)
 
 namespace quentier {
 
+QT_FORWARD_DECLARE_CLASS(NoteCountAggregator)
+
 class FavoritesModel final : public AbstractItemModel
 {
     Q_OBJECT
@@ -66,10 +68,26 @@ public:
         LocalStorageManagerAsync & localStorageManagerAsync,
         NoteCache & noteCache, NotebookCache & notebookCache,
         TagCache & tagCache, SavedSearchCache & savedSearchCache,
-        QObject * parent = nullptr);
+        QObject * parent = nullptr,
+        LocalStorageRequestScheduler * pRequestScheduler = nullptr,
+        NoteCountAggregator * pNoteCountAggregator = nullptr);
 
     virtual ~FavoritesModel() override;
 
+    /**
+     * @brief connectToLocalStorage and disconnectFromLocalStorage methods
+     * allow to temporarily detach the model from local storage i.e. when
+     * the model is kept aside for an account which is not active at
+     * the moment; the model is connected to local storage on construction
+     */
+    void connectToLocalStorage();
+    void disconnectFromLocalStorage();
+
+    bool isConnectedToLocalStorage() const
+    {
+        return m_connectedToLocalStorage;
+    }
+
     enum class Column
     {
         Type,
@@ -257,14 +275,6 @@ Q_SIGNALS:
         size_t offset, LocalStorageManager::ListSavedSearchesOrder order,
         LocalStorageManager::OrderDirection orderDirection, QUuid requestId);
 
-    void noteCountPerNotebook(
-        Notebook notebook, LocalStorageManager::NoteCountOptions options,
-        QUuid requestId);
-
-    void noteCountPerTag(
-        Tag tag, LocalStorageManager::NoteCountOptions options,
-        QUuid requestId);
-
 private Q_SLOTS:
     // Slots for response to events from local storage
 
@@ -275,14 +285,6 @@ private Q_SLOTS:
         Note note, LocalStorageManager::UpdateNoteOptions options,
         QUuid requestId);
 
-    void onNoteMovedToAnotherNotebook(
-        QString noteLocalUid, QString previousNotebookLocalUid,
-        QString newNotebookLocalUid);
-
-    void onNoteTagListChanged(
-        QString noteLocalUid, QStringList previousNoteTagLocalUids,
-        QStringList newNoteTagLocalUids);
-
     void onUpdateNoteFailed(
         Note note, LocalStorageManager::UpdateNoteOptions options,
         ErrorString errorDescription, QUuid requestId);
@@ -395,64 +397,22 @@ private Q_SLOTS:
     void onExpungeSavedSearchComplete(SavedSearch search, QUuid requestId);
 
     // For note counts:
-    void onGetNoteCountPerNotebookComplete(
-        int noteCount, Notebook notebook,
-        LocalStorageManager::NoteCountOptions options, QUuid requestId);
+    void onNoteCountForNotebookChanged(
+        QString notebookLocalUid, int noteCount);
 
-    void onGetNoteCountPerNotebookFailed(
-        ErrorString errorDescription, Notebook notebook,
-        LocalStorageManager::NoteCountOptions options, QUuid requestId);
-
-    void onGetNoteCountPerTagComplete(
-        int noteCount, Tag tag, LocalStorageManager::NoteCountOptions options,
-        QUuid requestId);
-
-    void onGetNoteCountPerTagFailed(
-        ErrorString errorDescription, Tag tag,
-        LocalStorageManager::NoteCountOptions options, QUuid requestId);
+    void onNoteCountForTagChanged(QString tagLocalUid, int noteCount);
+    void onNoteCountsForAllTagsChanged();
 
 private:
-    void createConnections(LocalStorageManagerAsync & localStorageManagerAsync);
     void requestNotesList();
     void requestNotebooksList();
     void requestTagsList();
     void requestSavedSearchesList();
 
-    struct NoteCountRequestOption
-    {
-        enum type
-        {
-            Force = 0,
-            IfNotAlreadyRunning
-        };
-    };
-
-    void requestNoteCountForNotebook(
-        const QString & notebookLocalUid,
-        const NoteCountRequestOption::type option);
-
-    void requestNoteCountForAllNotebooks(
-        const NoteCountRequestOption::type option);
-
-    void checkAndIncrementNoteCountPerNotebook(
-        const QString & notebookLocalUid);
-
-    void checkAndDecrementNoteCountPerNotebook(
-        const QString & notebookLocalUid);
-
-    void checkAndAdjustNoteCountPerNotebook(
-        const QString & notebookLocalUid, const bool increment);
-
-    void requestNoteCountForTag(
-        const QString & tagLocalUid, const NoteCountRequestOption::type option);
+    void requestNoteCountForNotebook(const QString & notebookLocalUid);
+    void requestNoteCountForTag(const QString & tagLocalUid);
 
-    void requestNoteCountForAllTags(const NoteCountRequestOption::type option);
-
-    void checkAndIncrementNoteCountPerTag(const QString & tagLocalUid);
-    void checkAndDecrementNoteCountPerTag(const QString & tagLocalUid);
-
-    void checkAndAdjustNoteCountPerTag(
-        const QString & tagLocalUid, const bool increment);
+    void setNoteCountForItem(const QString & localUid, const int noteCount);
 
     QVariant dataImpl(const int row, const Column column) const;
 
@@ -536,10 +496,17 @@ private:
         Qt::SortOrder m_sortOrder;
     };
 
-    using LocalUidToRequestIdBimap = boost::bimap<QString, QUuid>;
-
 private:
     FavoritesData m_data;
+    LocalStorageManagerAsync & m_localStorageManagerAsync;
+    bool m_connectedToLocalStorage = false;
+
+    LocalStorageRequestScheduler * m_pRequestScheduler;
+
+    // Either shared with other models or owned by this model
+    NoteCountAggregator * m_pNoteCountAggregator;
+    bool m_ownsNoteCountAggregator = false;
+
     NoteCache & m_noteCache;
     NotebookCache & m_notebookCache;
     TagCache & m_tagCache;
@@ -586,9 +553,6 @@ private:
 
     QHash<QString, QString> m_notebookLocalUidByNoteLocalUid;
 
-    LocalUidToRequestIdBimap m_notebookLocalUidToNoteCountRequestIdBimap;
-    LocalUidToRequestIdBimap m_tagLocalUidToNoteCountRequestIdBimap;
-
     QHash<QString, NotebookRestrictionsData> m_notebookRestrictionsData;
 
     Column m_sortedColumn = Column::DisplayName;
@@ -18,8 +18,10 @@
 
 #include "LogViewerModel.h"
 #include "LogViewerModelFileReaderAsync.h"
+#include "LogViewerModelInternedStrings.h"
 
 #include <lib/preferences/keys/Logging.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/utility/ApplicationSettings.h>
 #include <quentier/utility/DateTime.h>
@@ -85,6 +87,7 @@ namespace quentier {
 
 LogViewerModel::LogViewerModel(QObject * parent) :
     QAbstractTableModel(parent),
+    m_pInternedStrings(std::make_shared<InternedStrings>()),
     m_internalLogFile(
         applicationPersistentStoragePath() +
         QStringLiteral("/logs-quentier/LogViewerModelLog.txt"))
@@ -457,6 +460,21 @@ const LogViewerModel::Data * LogViewerModel::dataEntry(const int row) const
     return &data;
 }
 
+QString LogViewerModel::internedString(const quint32 index) const
+{
+    return m_pInternedStrings->string(index);
+}
+
+QString LogViewerModel::sourceFileName(const Data & dataEntry) const
+{
+    return m_pInternedStrings->string(dataEntry.m_sourceFileNameIndex);
+}
+
+QString LogViewerModel::component(const Data & dataEntry) const
+{
+    return m_pInternedStrings->string(dataEntry.m_componentIndex);
+}
+
 const QVector<LogViewerModel::Data> *
 LogViewerModel::dataChunkContainingModelRow(
     const int row, int * pStartModelRow) const
@@ -485,13 +503,13 @@ QString LogViewerModel::dataEntryToString(
     QString result;
     QTextStream strm(&result);
 
-    strm << dataEntry.m_timestamp.toString(
+    strm << dataEntry.timestamp().toString(
         QStringLiteral("yyyy-MM-dd HH:mm:ss.zzz t"));
 
-    strm << " " << dataEntry.m_sourceFileName << QNLOG_FILE_LINENUMBER_DELIMITER
+    strm << " " << sourceFileName(dataEntry) << QNLOG_FILE_LINENUMBER_DELIMITER
          << QString::number(dataEntry.m_sourceFileLineNumber) << " ["
          << LogViewerModel::logLevelToString(dataEntry.m_logLevel)
-         << "]: " << dataEntry.m_logEntry;
+         << "]: " << dataEntry.logEntry().toString();
 
     strm.flush();
     return result;
@@ -707,17 +725,17 @@ QVariant LogViewerModel::data(const QModelIndex & index, int role) const
     if (pDataEntry) {
         switch (static_cast<Column>(columnIndex)) {
         case Column::Timestamp:
-            return pDataEntry->m_timestamp;
+            return pDataEntry->timestamp();
         case Column::SourceFileName:
-            return pDataEntry->m_sourceFileName;
+            return sourceFileName(*pDataEntry);
         case Column::SourceFileLineNumber:
             return pDataEntry->m_sourceFileLineNumber;
         case Column::Component:
-            return pDataEntry->m_component;
+            return component(*pDataEntry);
         case Column::LogLevel:
             return static_cast<qint64>(pDataEntry->m_logLevel);
         case Column::LogEntry:
-            return pDataEntry->m_logEntry;
+            return pDataEntry->logEntry().toString();
         default:
             return {};
         }
@@ -1156,7 +1174,7 @@ void LogViewerModel::requestDataEntriesChunkFromLogFile(
         m_pFileReaderAsync = new FileReaderAsync(
             m_currentLogFileInfo.absoluteFilePath(),
             m_filteringOptions.m_disabledLogLevels,
-            m_filteringOptions.m_logEntryContentFilter);
+            m_filteringOptions.m_logEntryContentFilter, m_pInternedStrings);
 
         m_pFileReaderAsync->moveToThread(m_pReadLogFileIOThread);
 
@@ -1506,17 +1524,6 @@ QTextStream & LogViewerModel::FilteringOptions::print(QTextStream & strm) const
     return strm;
 }
 
-QTextStream & LogViewerModel::Data::print(QTextStream & strm) const
-{
-    strm << "Timestamp = "
-         << printableDateTimeFromTimestamp(m_timestamp.toMSecsSinceEpoch())
-         << ", source file name = " << m_sourceFileName
-         << ", line number = " << m_sourceFileLineNumber
-         << ", component = " << m_component << ", log level = " << m_logLevel
-         << ", log entry: " << m_logEntry;
-    return strm;
-}
-
 QTextStream & LogViewerModel::LogFileChunkMetadata::print(
     QTextStream & strm) const
 {
@@ -36,6 +36,7 @@
 #include <QHash>
 #include <QList>
 #include <QRegExp>
+#include <QStringRef>
 #include <QThread>
 #include <QVector>
 
@@ -43,6 +44,8 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 
+#include <memory>
+
 namespace quentier {
 
 class LogViewerModel final : public QAbstractTableModel
@@ -112,20 +115,52 @@ public:
     void setInternalLogEnabled(const bool enabled);
     bool internalLogEnabled() const;
 
-    struct Data : public Printable
+    /**
+     * Compact representation of a single log entry. Source file name and
+     * component are stored as indices into the table of interned strings
+     * (see internedString method), log entry text is a slice of the text
+     * shared by all entries parsed from the same log file chunk.
+     */
+    struct Data
     {
-        virtual QTextStream & print(QTextStream & strm) const override;
+        QDateTime timestamp() const
+        {
+            return QDateTime::fromMSecsSinceEpoch(
+                m_timestamp, Qt::OffsetFromUTC, m_utcOffset);
+        }
+
+        QStringRef logEntry() const
+        {
+            return QStringRef(
+                &m_logFileChunkText, m_logEntryStart, m_logEntrySize);
+        }
 
-        QDateTime m_timestamp;
-        QString m_sourceFileName;
-        qint64 m_sourceFileLineNumber = -1;
-        QString m_component;
+        // Milliseconds since epoch
+        qint64 m_timestamp = 0;
+
+        // Offset from UTC in seconds of the timezone the entry was logged in
+        qint32 m_utcOffset = 0;
+
+        qint32 m_sourceFileLineNumber = -1;
+        quint32 m_sourceFileNameIndex = 0;
+        quint32 m_componentIndex = 0;
         LogLevel m_logLevel = LogLevel::Info;
-        QString m_logEntry;
+
+        int m_logEntryStart = 0;
+        int m_logEntrySize = 0;
+        QString m_logFileChunkText;
     };
 
     const Data * dataEntry(const int row) const;
 
+    /**
+     * @return      The interned string corresponding to the index
+     */
+    QString internedString(const quint32 index) const;
+
+    QString sourceFileName(const Data & dataEntry) const;
+    QString component(const Data & dataEntry) const;
+
     const QVector<Data> * dataChunkContainingModelRow(
         const int row, int * pStartModelRow = nullptr) const;
 
@@ -220,6 +255,7 @@ private:
 
 private:
     class FileReaderAsync;
+    class InternedStrings;
     class LogFileParser;
 
 private:
@@ -353,6 +389,8 @@ private:
     char m_currentLogFileStartBytes[256];
     qint64 m_currentLogFileStartBytesRead = 0;
 
+    std::shared_ptr<InternedStrings> m_pInternedStrings;
+
     LogFileChunksMetadata m_logFileChunksMetadata;
     LRUCache<qint32, QVector<Data>> m_logFileChunkDataCache;
 
@@ -28,10 +28,12 @@ namespace quentier {
 
 LogViewerModel::FileReaderAsync::FileReaderAsync(
     const QString & targetFilePath, const QVector<LogLevel> & disabledLogLevels,
-    const QString & logEntryContentFilter, QObject * parent) :
+    const QString & logEntryContentFilter,
+    std::shared_ptr<InternedStrings> pInternedStrings, QObject * parent) :
     QObject(parent),
     m_targetFile(targetFilePath), m_disabledLogLevels(disabledLogLevels),
-    m_filterRegExp(logEntryContentFilter, Qt::CaseSensitive, QRegExp::Wildcard)
+    m_filterRegExp(logEntryContentFilter, Qt::CaseSensitive, QRegExp::Wildcard),
+    m_parser(std::move(pInternedStrings))
 {}
 
 LogViewerModel::FileReaderAsync::~FileReaderAsync()
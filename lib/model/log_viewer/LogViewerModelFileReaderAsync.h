@@ -36,7 +36,9 @@ public:
     explicit FileReaderAsync(
         const QString & targetFilePath,
         const QVector<LogLevel> & disabledLogLevels,
-        const QString & logEntryContentFilter, QObject * parent = nullptr);
+        const QString & logEntryContentFilter,
+        std::shared_ptr<InternedStrings> pInternedStrings,
+        QObject * parent = nullptr);
 
     virtual ~FileReaderAsync() override;
 
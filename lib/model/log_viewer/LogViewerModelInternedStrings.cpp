@@ -0,0 +1,75 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LogViewerModelInternedStrings.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace quentier {
+
+LogViewerModel::InternedStrings::InternedStrings()
+{
+    // Index 0 always corresponds to the empty string
+    m_strings << QString();
+    m_indicesByString[QString()] = 0;
+}
+
+quint32 LogViewerModel::InternedStrings::intern(const QString & str)
+{
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_indicesByString.constFind(str);
+        if (it != m_indicesByString.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+
+    // Need to check again as the string might have been interned while
+    // the lock was released
+    auto it = m_indicesByString.constFind(str);
+    if (it != m_indicesByString.constEnd()) {
+        return it.value();
+    }
+
+    quint32 index = static_cast<quint32>(m_strings.size());
+    m_strings << str;
+    m_indicesByString[str] = index;
+    return index;
+}
+
+QString LogViewerModel::InternedStrings::string(const quint32 index) const
+{
+    QReadLocker locker(&m_lock);
+
+    if (Q_UNLIKELY(index >= static_cast<quint32>(m_strings.size()))) {
+        return {};
+    }
+
+    return m_strings.at(static_cast<int>(index));
+}
+
+int LogViewerModel::InternedStrings::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_strings.size();
+}
+
+} // namespace quentier
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_MODEL_LOG_VIEWER_MODEL_INTERNED_STRINGS_H
+#define QUENTIER_LIB_MODEL_LOG_VIEWER_MODEL_INTERNED_STRINGS_H
+
+#include "LogViewerModel.h"
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+namespace quentier {
+
+/**
+ * @brief The LogViewerModel::InternedStrings class is the table of strings
+ * repeating over and over again across log entries, like source file names
+ * and components. Log entries keep indices into this table instead of their
+ * own copies of such strings.
+ *
+ * The table is only ever appended to so indices remain valid for as long as
+ * the table exists. It is filled by the log file parser from the reading
+ * thread while being read from the GUI thread, hence the locking.
+ */
+class LogViewerModel::InternedStrings
+{
+public:
+    InternedStrings();
+
+    /**
+     * @return      Index of the string within the table; the string is added
+     *              to the table if it's not there yet
+     */
+    quint32 intern(const QString & str);
+
+    /**
+     * @return      The string corresponding to the index or empty string if
+     *              there's no such index within the table
+     */
+    QString string(const quint32 index) const;
+
+    int size() const;
+
+private:
+    Q_DISABLE_COPY(InternedStrings)
+
+private:
+    mutable QReadWriteLock m_lock;
+    QHash<QString, quint32> m_indicesByString;
+    QVector<QString> m_strings;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_MODEL_LOG_VIEWER_MODEL_INTERNED_STRINGS_H
@@ -17,6 +17,7 @@
  */
 
 #include "LogViewerModelLogFileParser.h"
+#include "LogViewerModelInternedStrings.h"
 
 #include <lib/preferences/keys/Logging.h>
 
@@ -25,10 +26,14 @@
 #include <quentier/utility/StandardPaths.h>
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDebug>
 #include <QTextStream>
 #include <QTimeZone>
 
+#include <algorithm>
+#include <limits>
+
 #define LOG_VIEWER_MODEL_MAX_LOG_ENTRY_LINE_SIZE (700)
 
 #define LVMPDEBUG(message)                                                     \
@@ -82,9 +87,11 @@ namespace quentier {
     "\\[(\\w+)\\]"                                                             \
     "(?:\\s+\\[((?:\\w+|:|-|_)+)\\])?:\\s+(.+$)"
 
-LogViewerModel::LogFileParser::LogFileParser() :
+LogViewerModel::LogFileParser::LogFileParser(
+    std::shared_ptr<InternedStrings> pInternedStrings) :
     m_logParsingRegex(
         QStringLiteral(REGEX_QNLOG_LINE), Qt::CaseInsensitive, QRegExp::RegExp),
+    m_pInternedStrings(std::move(pInternedStrings)),
     m_internalLogFile(
         applicationPersistentStoragePath() +
         QStringLiteral("/logs-quentier/LogViewerModelLogFileParserLog.txt")),
@@ -126,6 +133,23 @@ bool LogViewerModel::LogFileParser::parseDataEntriesFromLogFile(
         return false;
     }
 
+    if ((m_logFileFormat == LogFileFormat::Unknown) && (logFile.size() > 0)) {
+        m_logFileFormat = isStructuredLogFile(logFile)
+            ? LogFileFormat::Structured
+            : LogFileFormat::Text;
+
+        LVMPDEBUG(
+            "Log file format: "
+            << (m_logFileFormat == LogFileFormat::Structured ? "structured"
+                                                             : "text"));
+    }
+
+    if (m_logFileFormat == LogFileFormat::Structured) {
+        return parseDataEntriesFromStructuredLogFile(
+            fromPos, maxDataEntries, disabledLogLevels, filterContentRegExp,
+            logFile, dataEntries, endPos, errorDescription);
+    }
+
     QTextStream strm(&logFile);
 
     if (!strm.seek(fromPos)) {
@@ -139,6 +163,7 @@ bool LogViewerModel::LogFileParser::parseDataEntriesFromLogFile(
     }
 
     QString line;
+    QString chunkText;
     int numFoundMatches = 0;
     dataEntries.clear();
     dataEntries.reserve(maxDataEntries);
@@ -150,7 +175,7 @@ bool LogViewerModel::LogFileParser::parseDataEntriesFromLogFile(
 
         auto parseLineStatus = parseLogFileLine(
             line, previousParseLineStatus, disabledLogLevels,
-            filterContentRegExp, dataEntries, errorDescription);
+            filterContentRegExp, dataEntries, chunkText, errorDescription);
 
         if (parseLineStatus == ParseLineStatus::Error) {
             LVMPDEBUG("Returning error: " << errorDescription);
@@ -189,15 +214,137 @@ bool LogViewerModel::LogFileParser::parseDataEntriesFromLogFile(
 
     endPos = strm.pos();
     LVMPDEBUG("End pos before returning = " << endPos);
+
+    // All entries from the chunk share the same text
+    chunkText.squeeze();
+    for (auto & dataEntry: dataEntries) {
+        dataEntry.m_logFileChunkText = chunkText;
+    }
+
     return true;
 }
 
+bool LogViewerModel::LogFileParser::parseDataEntriesFromStructuredLogFile(
+    const qint64 fromPos, const int maxDataEntries,
+    const QVector<LogLevel> & disabledLogLevels,
+    const QRegExp & filterContentRegExp, QFile & logFile,
+    QVector<LogViewerModel::Data> & dataEntries, qint64 & endPos,
+    ErrorString & errorDescription)
+{
+    if (!m_pStructuredLogReader) {
+        m_pStructuredLogReader = std::make_unique<StructuredLogReader>(logFile);
+    }
+
+    if (!m_pStructuredLogReader->seek(fromPos, errorDescription)) {
+        LVMPDEBUG(errorDescription);
+        return false;
+    }
+
+    const bool shouldFilterContent =
+        !filterContentRegExp.isEmpty() && filterContentRegExp.isValid();
+
+    QString chunkText;
+    dataEntries.clear();
+    dataEntries.reserve(maxDataEntries);
+
+    StructuredLogEntry entry;
+    while (dataEntries.size() < maxDataEntries) {
+        const auto status =
+            m_pStructuredLogReader->readEntry(entry, errorDescription);
+
+        if (status == StructuredLogReader::Status::Error) {
+            LVMPDEBUG("Returning error: " << errorDescription);
+            return false;
+        }
+
+        if (status == StructuredLogReader::Status::EndOfFile) {
+            break;
+        }
+
+        if (disabledLogLevels.contains(entry.m_logLevel)) {
+            continue;
+        }
+
+        if (shouldFilterContent &&
+            (filterContentRegExp.indexIn(entry.m_message) < 0) &&
+            (filterContentRegExp.indexIn(m_pStructuredLogReader->string(
+                 entry.m_sourceFileNameIndex)) < 0) &&
+            (filterContentRegExp.indexIn(
+                 QDateTime::fromMSecsSinceEpoch(
+                     entry.m_timestamp, Qt::OffsetFromUTC, entry.m_utcOffset)
+                     .toString(QStringLiteral("yyyy-MM-dd HH:mm:ss.zzz"))) <
+             0))
+        {
+            continue;
+        }
+
+        Data data;
+        data.m_timestamp = entry.m_timestamp;
+        data.m_utcOffset = entry.m_utcOffset;
+        data.m_sourceFileLineNumber = entry.m_sourceFileLineNumber;
+
+        data.m_sourceFileNameIndex =
+            internStructuredLogString(entry.m_sourceFileNameIndex);
+
+        data.m_componentIndex =
+            internStructuredLogString(entry.m_componentIndex);
+
+        data.m_logLevel = entry.m_logLevel;
+        data.m_logEntryStart = chunkText.size();
+        data.m_logEntrySize = entry.m_message.size();
+        chunkText += entry.m_message;
+
+        dataEntries.push_back(data);
+    }
+
+    endPos = m_pStructuredLogReader->pos();
+    LVMPDEBUG(
+        "Read " << dataEntries.size() << " entries from structured log, "
+                << "end pos = " << endPos);
+
+    // All entries from the chunk share the same text
+    chunkText.squeeze();
+    for (auto & dataEntry: dataEntries) {
+        dataEntry.m_logFileChunkText = chunkText;
+    }
+
+    return true;
+}
+
+quint32 LogViewerModel::LogFileParser::internStructuredLogString(
+    const quint32 index)
+{
+    // Indexes of strings within the structured log file are dense so plain
+    // vector works as the mapping
+    constexpr quint32 invalidIndex = std::numeric_limits<quint32>::max();
+
+    const int size = m_structuredLogStringIndexes.size();
+    if (index >= static_cast<quint32>(size)) {
+        m_structuredLogStringIndexes.resize(static_cast<int>(index) + 1);
+
+        std::fill(
+            m_structuredLogStringIndexes.begin() + size,
+            m_structuredLogStringIndexes.end(), invalidIndex);
+    }
+
+    quint32 & internedIndex =
+        m_structuredLogStringIndexes[static_cast<int>(index)];
+
+    if (internedIndex == invalidIndex) {
+        internedIndex =
+            m_pInternedStrings->intern(m_pStructuredLogReader->string(index));
+    }
+
+    return internedIndex;
+}
+
 LogViewerModel::LogFileParser::ParseLineStatus
 LogViewerModel::LogFileParser::parseLogFileLine(
     const QString & line, const ParseLineStatus previousParseLineStatus,
     const QVector<LogLevel> & disabledLogLevels,
     const QRegExp & filterContentRegExp,
-    QVector<LogViewerModel::Data> & dataEntries, ErrorString & errorDescription)
+    QVector<LogViewerModel::Data> & dataEntries, QString & chunkText,
+    ErrorString & errorDescription)
 {
     int currentIndex = m_logParsingRegex.indexIn(line);
     if (currentIndex < 0) {
@@ -207,11 +354,14 @@ LogViewerModel::LogFileParser::parseLogFileLine(
 
         if (!dataEntries.isEmpty()) {
             LogViewerModel::Data & lastEntry = dataEntries.back();
-            appendLogEntryLine(lastEntry, line);
+            appendLogEntryLine(lastEntry, line, chunkText);
 
             if (!filterContentRegExp.isEmpty() &&
-                (filterContentRegExp.indexIn(lastEntry.m_logEntry) >= 0))
+                (filterContentRegExp.indexIn(chunkText.mid(
+                     lastEntry.m_logEntryStart, lastEntry.m_logEntrySize)) >=
+                 0))
             {
+                chunkText.truncate(lastEntry.m_logEntryStart);
                 dataEntries.pop_back();
                 return ParseLineStatus::FilteredEntry;
             }
@@ -246,16 +396,22 @@ LogViewerModel::LogFileParser::parseLogFileLine(
     }
 
     Data entry;
-    entry.m_timestamp = QDateTime::fromString(
+
+    QDateTime timestamp = QDateTime::fromString(
         capturedTexts[1], QStringLiteral("yyyy-MM-dd HH:mm:ss.zzz"));
 
     // Trying to add timezone info
-    QTimeZone timezone(capturedTexts[2].toLocal8Bit());
-    if (timezone.isValid()) {
-        entry.m_timestamp.setTimeZone(timezone);
+    if (capturedTexts[2] != m_lastTimeZoneName) {
+        m_lastTimeZoneName = capturedTexts[2];
+        m_lastTimeZone = QTimeZone(m_lastTimeZoneName.toLocal8Bit());
     }
 
-    entry.m_sourceFileName = capturedTexts[3];
+    if (m_lastTimeZone.isValid()) {
+        timestamp.setTimeZone(m_lastTimeZone);
+    }
+
+    entry.m_timestamp = timestamp.toMSecsSinceEpoch();
+    entry.m_utcOffset = timestamp.offsetFromUtc();
     entry.m_sourceFileLineNumber = sourceFileLineNumber;
 
     const QString & logLevel = capturedTexts[5];
@@ -287,30 +443,35 @@ LogViewerModel::LogFileParser::parseLogFileLine(
         return ParseLineStatus::FilteredEntry;
     }
 
-    entry.m_component = capturedTexts[6];
-
     if (!filterContentRegExp.isEmpty() && filterContentRegExp.isValid() &&
         (filterContentRegExp.indexIn(capturedTexts[7]) < 0) &&
         (filterContentRegExp.indexIn(capturedTexts[1]) < 0) &&
-        (filterContentRegExp.indexIn(entry.m_sourceFileName) < 0))
+        (filterContentRegExp.indexIn(capturedTexts[3]) < 0))
     {
         return ParseLineStatus::FilteredEntry;
     }
 
-    appendLogEntryLine(entry, capturedTexts[7]);
+    entry.m_sourceFileNameIndex = m_pInternedStrings->intern(capturedTexts[3]);
+    entry.m_componentIndex = m_pInternedStrings->intern(capturedTexts[6]);
+
+    entry.m_logEntryStart = chunkText.size();
+    appendLogEntryLine(entry, capturedTexts[7], chunkText);
     dataEntries.push_back(entry);
 
     return ParseLineStatus::CreatedNewEntry;
 }
 
 void LogViewerModel::LogFileParser::appendLogEntryLine(
-    LogViewerModel::Data & data, const QString & line) const
+    LogViewerModel::Data & data, const QString & line,
+    QString & chunkText) const
 {
-    if (!data.m_logEntry.isEmpty()) {
-        data.m_logEntry += QStringLiteral("\n");
+    if (data.m_logEntrySize > 0) {
+        chunkText += QChar::fromLatin1('\n');
+        ++data.m_logEntrySize;
     }
 
-    data.m_logEntry += line;
+    chunkText += line;
+    data.m_logEntrySize += line.size();
 }
 
 void LogViewerModel::LogFileParser::setInternalLogEnabled(const bool enabled)
@@ -21,14 +21,19 @@
 
 #include "LogViewerModel.h"
 
+#include <lib/utility/StructuredLog.h>
+
 #include <QRegExp>
+#include <QTimeZone>
+
+#include <memory>
 
 namespace quentier {
 
 class LogViewerModel::LogFileParser
 {
 public:
-    LogFileParser();
+    explicit LogFileParser(std::shared_ptr<InternedStrings> pInternedStrings);
 
     bool parseDataEntriesFromLogFile(
         const qint64 fromPos, const int maxDataEntries,
@@ -38,6 +43,26 @@ public:
         ErrorString & errorDescription);
 
 private:
+    enum class LogFileFormat
+    {
+        Unknown = 0,
+        Text,
+        Structured
+    };
+
+    bool parseDataEntriesFromStructuredLogFile(
+        const qint64 fromPos, const int maxDataEntries,
+        const QVector<LogLevel> & disabledLogLevels,
+        const QRegExp & filterContentRegExp, QFile & logFile,
+        QVector<LogViewerModel::Data> & dataEntries, qint64 & endPos,
+        ErrorString & errorDescription);
+
+    /**
+     * @return      Index within interned strings corresponding to the index
+     *              of the string defined in the structured log file
+     */
+    quint32 internStructuredLogString(const quint32 index);
+
     enum class ParseLineStatus
     {
         AppendedToLastEntry = 0,
@@ -50,16 +75,30 @@ private:
         const QString & line, const ParseLineStatus previousParseLineStatus,
         const QVector<LogLevel> & disabledLogLevels,
         const QRegExp & filterContentRegExp,
-        QVector<LogViewerModel::Data> & dataEntries,
+        QVector<LogViewerModel::Data> & dataEntries, QString & chunkText,
         ErrorString & errorDescription);
 
     void appendLogEntryLine(
-        LogViewerModel::Data & data, const QString & line) const;
+        LogViewerModel::Data & data, const QString & line,
+        QString & chunkText) const;
 
     void setInternalLogEnabled(const bool enabled);
 
 private:
     QRegExp m_logParsingRegex;
+    std::shared_ptr<InternedStrings> m_pInternedStrings;
+
+    // Most of log entries are logged in the same timezone so it's cheaper
+    // to remember the last parsed one than to look it up for each entry
+    QString m_lastTimeZoneName;
+    QTimeZone m_lastTimeZone;
+
+    LogFileFormat m_logFileFormat = LogFileFormat::Unknown;
+
+    // Structured log file is read without any regex matching, all the fields
+    // of the entries are stored in it as is
+    std::unique_ptr<StructuredLogReader> m_pStructuredLogReader;
+    QVector<quint32> m_structuredLogStringIndexes;
 
     QFile m_internalLogFile;
     bool m_internalLogEnabled;
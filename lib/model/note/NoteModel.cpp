@@ -18,6 +18,8 @@
 
 #include "NoteModel.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
 #include <quentier/utility/DateTime.h>
@@ -25,7 +27,10 @@
 
 #include <QImage>
 
+#include <algorithm>
+#include <functional>
 #include <iterator>
+#include <vector>
 
 // Separate logging macros for the note model - to distinguish the one
 // for deleted notes from the one for non-deleted notes
@@ -82,11 +87,13 @@ NoteModel::NoteModel(
     LocalStorageManagerAsync & localStorageManagerAsync, NoteCache & noteCache,
     NotebookCache & notebookCache, QObject * parent,
     const IncludedNotes::type includedNotes,
-    const NoteSortingMode::type noteSortingMode, NoteFilters * pFilters) :
+    const NoteSortingMode::type noteSortingMode, NoteFilters * pFilters,
+    LocalStorageRequestScheduler * pRequestScheduler) :
     QAbstractItemModel(parent),
     m_account(account), m_includedNotes(includedNotes),
     m_noteSortingMode(noteSortingMode),
-    m_localStorageManagerAsync(localStorageManagerAsync), m_cache(noteCache),
+    m_localStorageManagerAsync(localStorageManagerAsync),
+    m_pRequestScheduler(pRequestScheduler), m_cache(noteCache),
     m_notebookCache(notebookCache), m_pFilters(pFilters),
     m_maxNoteCount(NOTE_MIN_CACHE_SIZE * 2)
 {}
@@ -520,19 +527,21 @@ bool NoteModel::moveNoteToNotebook(
     // by name
     dummy.setLocalUid(QString());
 
-    auto requestId = QUuid::createUuid();
+    auto requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, dummy](const QUuid & id) { Q_EMIT findNotebook(dummy, id); });
 
     Q_UNUSED(
         m_noteLocalUidToFindNotebookRequestIdForMoveNoteToNotebookBimap.insert(
             LocalUidToRequestIdBimap::value_type(noteLocalUid, requestId)))
 
     NMTRACE(
-        "Emitting the request to find a notebook by name for "
+        "Scheduled the request to find a notebook by name for "
         << "moving the note to it: request id = " << requestId
         << ", notebook name = " << notebookName
         << ", note local uid = " << noteLocalUid);
 
-    Q_EMIT findNotebook(dummy, requestId);
     return true;
 }
 
@@ -550,6 +559,133 @@ bool NoteModel::unfavoriteNote(
     return setNoteFavorited(noteLocalUid, false, errorDescription);
 }
 
+bool NoteModel::deleteNotes(
+    const QStringList & noteLocalUids, ErrorString & errorDescription)
+{
+    NMDEBUG(
+        "NoteModel::deleteNotes: " << noteLocalUids.join(QStringLiteral(", ")));
+
+    const qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    QVector<NoteModelItem> items;
+    items.reserve(noteLocalUids.size());
+
+    bool res = true;
+    const auto & localUidIndex = m_data.get<ByLocalUid>();
+    for (const auto & noteLocalUid: qAsConst(noteLocalUids)) {
+        auto it = localUidIndex.find(noteLocalUid);
+        if (it == localUidIndex.end()) {
+            errorDescription.setBase(
+                QT_TR_NOOP("note to be deleted was not found"));
+            NMDEBUG(errorDescription << ": " << noteLocalUid);
+            res = false;
+            continue;
+        }
+
+        NoteModelItem item = *it;
+        if (!canUpdateNoteItem(item)) {
+            errorDescription.setBase(
+                QT_TR_NOOP("notebook restrictions don't allow to delete "
+                           "the note"));
+            NMDEBUG(errorDescription << ", item: " << item);
+            res = false;
+            continue;
+        }
+
+        item.setDeletionTimestamp(timestamp);
+        item.setActive(false);
+        item.setDirty(true);
+
+        if (m_includedNotes != IncludedNotes::NonDeleted) {
+            item.setModificationTimestamp(timestamp);
+        }
+
+        items << item;
+    }
+
+    if (items.isEmpty()) {
+        return res;
+    }
+
+    updateItemsWithRespectToSorting(items);
+
+    for (const auto & item: qAsConst(items)) {
+        if (m_includedNotes == IncludedNotes::NonDeleted) {
+            Q_UNUSED(
+                m_localUidsOfBulkDeletedNotesBeingUpdated.insert(
+                    item.localUid()))
+        }
+
+        saveNoteInLocalStorage(item);
+    }
+
+    return res;
+}
+
+bool NoteModel::moveNotesToNotebook(
+    const QStringList & noteLocalUids, const QString & notebookName,
+    ErrorString & errorDescription)
+{
+    NMDEBUG(
+        "NoteModel::moveNotesToNotebook: note local uids = "
+        << noteLocalUids.join(QStringLiteral(", "))
+        << ", notebook name = " << notebookName);
+
+    if (Q_UNLIKELY(notebookName.isEmpty())) {
+        errorDescription.setBase(
+            QT_TR_NOOP("the name of the target notebook is empty"));
+        return false;
+    }
+
+    for (const auto & pair: m_notebookCache) {
+        const auto & notebook = pair.second;
+        if (notebook.hasName() && (notebook.name() == notebookName)) {
+            return moveNotesToNotebookImpl(
+                noteLocalUids, notebook, errorDescription);
+        }
+    }
+
+    // The notebook is looked up in the local storage once for all the notes
+    Notebook dummy;
+    dummy.setName(notebookName);
+    dummy.setLocalUid(QString());
+
+    auto requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, dummy](const QUuid & id) { Q_EMIT findNotebook(dummy, id); });
+
+    m_noteLocalUidsByFindNotebookRequestIdForMoveNotesToNotebook[requestId] =
+        noteLocalUids;
+
+    NMTRACE(
+        "Scheduled the request to find a notebook by name for "
+        << "moving notes to it: request id = " << requestId
+        << ", notebook name = " << notebookName);
+
+    return true;
+}
+
+bool NoteModel::favoriteNotes(
+    const QStringList & noteLocalUids, ErrorString & errorDescription)
+{
+    NMDEBUG(
+        "NoteModel::favoriteNotes: "
+        << noteLocalUids.join(QStringLiteral(", ")));
+
+    return setNotesFavorited(noteLocalUids, true, errorDescription);
+}
+
+bool NoteModel::unfavoriteNotes(
+    const QStringList & noteLocalUids, ErrorString & errorDescription)
+{
+    NMDEBUG(
+        "NoteModel::unfavoriteNotes: "
+        << noteLocalUids.join(QStringLiteral(", ")));
+
+    return setNotesFavorited(noteLocalUids, false, errorDescription);
+}
+
 Qt::ItemFlags NoteModel::flags(const QModelIndex & modelIndex) const
 {
     Qt::ItemFlags indexFlags = QAbstractItemModel::flags(modelIndex);
@@ -974,7 +1110,11 @@ void NoteModel::onUpdateNoteComplete(
         (!note.hasDeletionTimestamp() &&
          (m_includedNotes == IncludedNotes::Deleted));
 
-    if (shouldRemoveNoteFromModel) {
+    if (m_localUidsOfBulkDeletedNotesBeingUpdated.contains(note.localUid())) {
+        onBulkDeletedNoteProcessed(
+            note.localUid(), shouldRemoveNoteFromModel);
+    }
+    else if (shouldRemoveNoteFromModel) {
         removeItemByLocalUid(note.localUid());
     }
 
@@ -1043,6 +1183,7 @@ void NoteModel::onUpdateNoteFailed(
 
     Q_UNUSED(m_updateNoteRequestIds.erase(it))
 
+    onBulkDeletedNoteProcessed(note.localUid(), false);
     findNoteToRestoreFailedUpdate(note);
 }
 
@@ -1113,6 +1254,7 @@ void NoteModel::onFindNoteFailed(
     }
     else if (performUpdateIt != m_findNoteToPerformUpdateRequestIds.end()) {
         Q_UNUSED(m_findNoteToPerformUpdateRequestIds.erase(performUpdateIt))
+        onBulkDeletedNoteProcessed(note.localUid(), false);
     }
 
     Q_EMIT notifyError(errorDescription);
@@ -1471,6 +1613,37 @@ void NoteModel::onExpungeNoteFailed(
 
 void NoteModel::onFindNotebookComplete(Notebook notebook, QUuid requestId)
 {
+    auto bit =
+        m_noteLocalUidsByFindNotebookRequestIdForMoveNotesToNotebook.find(
+            requestId);
+
+    if (bit !=
+        m_noteLocalUidsByFindNotebookRequestIdForMoveNotesToNotebook.end())
+    {
+        NMTRACE(
+            "NoteModel::onFindNotebookComplete: notebook for moving notes "
+            << "to it: " << notebook << "\nRequest id = " << requestId);
+
+        const QStringList noteLocalUids = bit.value();
+        m_noteLocalUidsByFindNotebookRequestIdForMoveNotesToNotebook.erase(bit);
+
+        m_notebookCache.put(notebook.localUid(), notebook);
+
+        ErrorString error;
+        if (!moveNotesToNotebookImpl(noteLocalUids, notebook, error)) {
+            ErrorString errorDescription(
+                QT_TR_NOOP("Can't move notes to another notebook"));
+
+            errorDescription.appendBase(error.base());
+            errorDescription.appendBase(error.additionalBases());
+            errorDescription.details() = error.details();
+            NMWARNING(errorDescription);
+            Q_EMIT notifyError(errorDescription);
+        }
+
+        return;
+    }
+
     auto fit = m_findNotebookRequestForNotebookLocalUid.right.find(requestId);
     auto mit =
         ((fit != m_findNotebookRequestForNotebookLocalUid.right.end())
@@ -1534,6 +1707,27 @@ void NoteModel::onFindNotebookComplete(Notebook notebook, QUuid requestId)
 void NoteModel::onFindNotebookFailed(
     Notebook notebook, ErrorString errorDescription, QUuid requestId)
 {
+    auto bit =
+        m_noteLocalUidsByFindNotebookRequestIdForMoveNotesToNotebook.find(
+            requestId);
+
+    if (bit !=
+        m_noteLocalUidsByFindNotebookRequestIdForMoveNotesToNotebook.end())
+    {
+        m_noteLocalUidsByFindNotebookRequestIdForMoveNotesToNotebook.erase(bit);
+
+        ErrorString error(
+            QT_TR_NOOP("Can't move notes to another notebook: "
+                       "failed to find the target notebook"));
+
+        error.appendBase(errorDescription.base());
+        error.appendBase(errorDescription.additionalBases());
+        error.details() = errorDescription.details();
+        NMWARNING(error << ", notebook: " << notebook);
+        Q_EMIT notifyError(error);
+        return;
+    }
+
     auto fit = m_findNotebookRequestForNotebookLocalUid.right.find(requestId);
     auto mit =
         ((fit != m_findNotebookRequestForNotebookLocalUid.right.end())
@@ -1683,6 +1877,21 @@ void NoteModel::onExpungeTagComplete(
     }
 }
 
+bool NoteModel::hasPendingLocalStorageRequests() const
+{
+    return !m_listNotesRequestId.isNull() ||
+        !m_getNoteCountRequestId.isNull() ||
+        !m_getFullNoteCountPerAccountRequestId.isNull() ||
+        !m_findNotebookRequestForNotebookLocalUid.empty() ||
+        !m_addNoteRequestIds.isEmpty() || !m_updateNoteRequestIds.isEmpty() ||
+        !m_expungeNoteRequestIds.isEmpty() ||
+        !m_findNoteToRestoreFailedUpdateRequestIds.isEmpty() ||
+        !m_findNoteToPerformUpdateRequestIds.isEmpty() ||
+        !m_noteLocalUidToFindNotebookRequestIdForMoveNoteToNotebookBimap
+             .empty() ||
+        !m_findTagRequestForTagLocalUid.empty();
+}
+
 void NoteModel::connectToLocalStorage()
 {
     NMDEBUG("NoteModel::connectToLocalStorage");
@@ -1888,6 +2097,11 @@ void NoteModel::disconnectFromLocalStorage()
     QObject::disconnect(&m_localStorageManagerAsync);
     m_localStorageManagerAsync.disconnect(this);
     m_connectedToLocalStorage = false;
+
+    // Queued requests would go nowhere now
+    if (m_pRequestScheduler) {
+        m_pRequestScheduler->cancelRequests(*this);
+    }
 }
 
 void NoteModel::onNoteAddedOrUpdated(
@@ -1943,17 +2157,25 @@ void NoteModel::onNoteAddedOrUpdated(
                 notebook.setGuid(note.notebookGuid());
             }
 
-            auto requestId = QUuid::createUuid();
+            // Notes of the same notebook are listed by both deleted and
+            // non-deleted notes models
+            auto requestId = scheduleLocalStorageRequest(
+                m_pRequestScheduler, *this,
+                LocalStorageRequestScheduler::Priority::VisibleView,
+                [this, notebook](const QUuid & id) {
+                    Q_EMIT findNotebook(notebook, id);
+                },
+                localStorageRequestKey(
+                    "findNotebook", notebook.localUid(),
+                    (notebook.hasGuid() ? notebook.guid() : QString())));
 
             Q_UNUSED(m_findNotebookRequestForNotebookLocalUid.insert(
                 LocalUidToRequestIdBimap::value_type(
                     item.notebookLocalUid(), requestId)))
 
             NMTRACE(
-                "Emitting the request to find notebook local uid: = "
+                "Scheduled the request to find notebook local uid: = "
                 << item.notebookLocalUid() << ", request id = " << requestId);
-
-            Q_EMIT findNotebook(notebook, requestId);
         }
         else {
             NMTRACE(
@@ -2000,20 +2222,13 @@ void NoteModel::noteToItem(const Note & note, NoteModelItem & item)
         const QStringList & tagLocalUids = note.tagLocalUids();
         item.setTagLocalUids(tagLocalUids);
 
-        QStringList tagNames;
-        tagNames.reserve(tagLocalUids.size());
-
-        for (auto it = tagLocalUids.constBegin(), end = tagLocalUids.constEnd();
-             it != end; ++it)
-        {
-            auto tagIt = m_tagDataByTagLocalUid.find(*it);
-            if (tagIt != m_tagDataByTagLocalUid.end()) {
-                const auto & tagData = tagIt.value();
-                tagNames << tagData.m_name;
-            }
+        QVector<int> tagIds;
+        tagIds.reserve(tagLocalUids.size());
+        for (const auto & tagLocalUid: qAsConst(tagLocalUids)) {
+            tagIds << tagId(tagLocalUid);
         }
 
-        item.setTagNameList(tagNames);
+        item.setTagIds(tagIds);
     }
 
     if (note.hasTagGuids()) {
@@ -2216,23 +2431,31 @@ void NoteModel::requestNotesList()
         break;
     }
 
-    m_listNotesRequestId = QUuid::createUuid();
+    // The request for the previous batch of notes which hasn't been sent yet
+    // is no longer needed
+    const auto supersedingKey = QStringLiteral("listNotes");
+    const size_t offset = m_listNotesOffset;
 
     if (!hasFilters()) {
-        NMDEBUG(
-            "Emitting the request to list notes: offset = "
-            << m_listNotesOffset << ", request id = " << m_listNotesRequestId
-            << ", order = " << order << ", direction = " << direction);
-
-        Q_EMIT listNotes(
-            flags,
+        m_listNotesRequestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this, requestPriority(),
+            [this, flags, offset, order, direction](const QUuid & id) {
+                Q_EMIT listNotes(
+                    flags,
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-            LocalStorageManager::GetNoteOptions(),
+                    LocalStorageManager::GetNoteOptions(),
 #else
-            LocalStorageManager::GetNoteOptions(0),
+                    LocalStorageManager::GetNoteOptions(0),
 #endif
-            NOTE_LIST_QUERY_LIMIT, m_listNotesOffset, order, direction,
-            QString(), m_listNotesRequestId);
+                    NOTE_LIST_QUERY_LIMIT, offset, order, direction, QString(),
+                    id);
+            },
+            QString(), supersedingKey);
+
+        NMDEBUG(
+            "Scheduled the request to list notes: offset = "
+            << m_listNotesOffset << ", request id = " << m_listNotesRequestId
+            << ", order = " << order << ", direction = " << direction);
 
         return;
     }
@@ -2257,45 +2480,54 @@ void NoteModel::requestNotesList()
             noteLocalUids << *it;
         }
 
+        m_listNotesRequestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this, requestPriority(),
+            [this, noteLocalUids, flags, order, direction](const QUuid & id) {
+                Q_EMIT listNotesByLocalUids(
+                    noteLocalUids,
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+                    LocalStorageManager::GetNoteOptions(),
+#else
+                    LocalStorageManager::GetNoteOptions(0),
+#endif
+                    flags, NOTE_LIST_QUERY_LIMIT, 0, order, direction, id);
+            },
+            QString(), supersedingKey);
+
         NMDEBUG(
-            "Emitting the request to list notes by local uids: "
+            "Scheduled the request to list notes by local uids: "
             << ", request id = " << m_listNotesRequestId << ", order = "
             << order << ", direction = " << direction << ", note local uids: "
             << noteLocalUids.join(QStringLiteral(", ")));
 
-        Q_EMIT listNotesByLocalUids(
-            noteLocalUids,
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-            LocalStorageManager::GetNoteOptions(),
-#else
-            LocalStorageManager::GetNoteOptions(0),
-#endif
-            flags, NOTE_LIST_QUERY_LIMIT, 0, order, direction,
-            m_listNotesRequestId);
-
         return;
     }
 
     const auto & notebookLocalUids = m_pFilters->filteredNotebookLocalUids();
     const auto & tagLocalUids = m_pFilters->filteredTagLocalUids();
 
+    m_listNotesRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this, requestPriority(),
+        [this, notebookLocalUids, tagLocalUids, flags, offset, order,
+         direction](const QUuid & id) {
+            Q_EMIT listNotesPerNotebooksAndTags(
+                notebookLocalUids, tagLocalUids,
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+                LocalStorageManager::GetNoteOptions(),
+#else
+                LocalStorageManager::GetNoteOptions(0),
+#endif
+                flags, NOTE_LIST_QUERY_LIMIT, offset, order, direction, id);
+        },
+        QString(), supersedingKey);
+
     NMDEBUG(
-        "Emitting the request to list notes per notebooks "
+        "Scheduled the request to list notes per notebooks "
         << "and tags: offset = " << m_listNotesOffset
         << ", request id = " << m_listNotesRequestId << ", order = " << order
         << ", direction = " << direction << ", notebook local uids: "
         << notebookLocalUids.join(QStringLiteral(", "))
         << "; tag local uids: " << tagLocalUids.join(QStringLiteral(", ")));
-
-    Q_EMIT listNotesPerNotebooksAndTags(
-        notebookLocalUids, tagLocalUids,
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        LocalStorageManager::GetNoteOptions(),
-#else
-        LocalStorageManager::GetNoteOptions(0),
-#endif
-        flags, NOTE_LIST_QUERY_LIMIT, m_listNotesOffset, order, direction,
-        m_listNotesRequestId);
 }
 
 void NoteModel::requestNotesCount()
@@ -2315,29 +2547,41 @@ void NoteModel::requestTotalNotesCountPerAccount()
 {
     NMDEBUG("NoteModel::requestTotalNotesCountPerAccount");
 
-    m_getFullNoteCountPerAccountRequestId = QUuid::createUuid();
+    LocalStorageManager::NoteCountOptions options = noteCountOptions();
+
+    m_getFullNoteCountPerAccountRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this, requestPriority(),
+        [this, options](const QUuid & id) {
+            Q_EMIT getNoteCount(options, id);
+        });
 
     NMDEBUG(
-        "Emitting the request to get full note count per account: request "
+        "Scheduled the request to get full note count per account: request "
         << "id = " << m_getFullNoteCountPerAccountRequestId);
-
-    LocalStorageManager::NoteCountOptions options = noteCountOptions();
-    Q_EMIT getNoteCount(options, m_getFullNoteCountPerAccountRequestId);
 }
 
 void NoteModel::requestTotalFilteredNotesCount()
 {
     NMDEBUG("NoteModel::requestTotalFilteredNotesCount");
 
+    // The request for the count of notes matching the previous filters which
+    // hasn't been sent yet is no longer needed
+    const auto supersedingKey = QStringLiteral("getFilteredNoteCount");
+
     if (!hasFilters()) {
-        m_getNoteCountRequestId = QUuid::createUuid();
         LocalStorageManager::NoteCountOptions options = noteCountOptions();
 
+        m_getNoteCountRequestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this, requestPriority(),
+            [this, options](const QUuid & id) {
+                Q_EMIT getNoteCount(options, id);
+            },
+            localStorageRequestKey("getNoteCount", options), supersedingKey);
+
         NMDEBUG(
-            "Emitting the request to get note count: options = "
+            "Scheduled the request to get note count: options = "
             << options << ", request id = " << m_getNoteCountRequestId);
 
-        Q_EMIT getNoteCount(options, m_getNoteCountRequestId);
         return;
     }
 
@@ -2352,16 +2596,28 @@ void NoteModel::requestTotalFilteredNotesCount()
     const auto & notebookLocalUids = m_pFilters->filteredNotebookLocalUids();
     const auto & tagLocalUids = m_pFilters->filteredTagLocalUids();
 
-    m_getNoteCountRequestId = QUuid::createUuid();
     LocalStorageManager::NoteCountOptions options = noteCountOptions();
 
+    m_getNoteCountRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this, requestPriority(),
+        [this, notebookLocalUids, tagLocalUids, options](const QUuid & id) {
+            Q_EMIT getNoteCountPerNotebooksAndTags(
+                notebookLocalUids, tagLocalUids, options, id);
+        },
+        QString(), supersedingKey);
+
     NMDEBUG(
-        "Emitting the request to get note count per notebooks and tags: "
+        "Scheduled the request to get note count per notebooks and tags: "
         << "options = " << options
         << ", request id = " << m_getNoteCountRequestId);
+}
 
-    Q_EMIT getNoteCountPerNotebooksAndTags(
-        notebookLocalUids, tagLocalUids, options, m_getNoteCountRequestId);
+LocalStorageRequestScheduler::Priority NoteModel::requestPriority() const
+{
+    return (
+        (m_includedNotes == IncludedNotes::Deleted)
+            ? LocalStorageRequestScheduler::Priority::Background
+            : LocalStorageRequestScheduler::Priority::VisibleView);
 }
 
 void NoteModel::findNoteToRestoreFailedUpdate(const Note & note)
@@ -2370,17 +2626,21 @@ void NoteModel::findNoteToRestoreFailedUpdate(const Note & note)
         "NoteModel::findNoteToRestoreFailedUpdate: local uid = "
         << note.localUid());
 
-    auto requestId = QUuid::createUuid();
+    LocalStorageManager::GetNoteOptions getNoteOptions(
+        LocalStorageManager::GetNoteOption::WithResourceMetadata);
+
+    auto requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, note, getNoteOptions](const QUuid & id) {
+            Q_EMIT findNote(note, getNoteOptions, id);
+        });
+
     Q_UNUSED(m_findNoteToRestoreFailedUpdateRequestIds.insert(requestId))
 
     NMTRACE(
-        "Emitting the request to find a note: local uid = "
+        "Scheduled the request to find a note: local uid = "
         << note.localUid() << ", request id = " << requestId);
-
-    LocalStorageManager::GetNoteOptions getNoteOptions(
-        LocalStorageManager::GetNoteOption::WithResourceMetadata);
-
-    Q_EMIT findNote(note, getNoteOptions, requestId);
 }
 
 void NoteModel::clearModel()
@@ -2407,7 +2667,11 @@ void NoteModel::clearModel()
     m_findNoteToPerformUpdateRequestIds.clear();
     m_noteItemsPendingNotebookDataUpdate.clear();
     m_noteLocalUidToFindNotebookRequestIdForMoveNoteToNotebookBimap.clear();
-    m_tagDataByTagLocalUid.clear();
+    m_noteLocalUidsByFindNotebookRequestIdForMoveNotesToNotebook.clear();
+    m_localUidsOfBulkDeletedNotesBeingUpdated.clear();
+    m_localUidsOfBulkDeletedNotesPendingRemoval.clear();
+    m_tagData.clear();
+    m_tagIdByTagLocalUid.clear();
     m_findTagRequestForTagLocalUid.clear();
     m_tagLocalUidToNoteLocalUid.clear();
 
@@ -2462,38 +2726,30 @@ void NoteModel::processTagExpunging(const QString & tagLocalUid)
 {
     NMTRACE("NoteModel::processTagExpunging: tag local uid = " << tagLocalUid);
 
-    auto tagDataIt = m_tagDataByTagLocalUid.find(tagLocalUid);
-    if (tagDataIt == m_tagDataByTagLocalUid.end()) {
+    const int id = m_tagIdByTagLocalUid.value(tagLocalUid, -1);
+    if ((id < 0) || !m_tagData[id].m_found) {
         NMTRACE(
             "Tag data corresponding to the expunged tag was not found "
             << "within the note model");
         return;
     }
 
-    QString tagGuid = tagDataIt->m_guid;
-    QString tagName = tagDataIt->m_name;
-
-    Q_UNUSED(m_tagDataByTagLocalUid.erase(tagDataIt))
+    // The id stays reserved for this tag local uid, just forget its data
+    auto & tagData = m_tagData[id];
+    QString tagGuid = tagData.m_guid;
+    tagData.m_name.resize(0);
+    tagData.m_guid.resize(0);
+    tagData.m_found = false;
 
-    auto noteIt = m_tagLocalUidToNoteLocalUid.find(tagLocalUid);
-    if (noteIt == m_tagLocalUidToNoteLocalUid.end()) {
+    const QStringList affectedNotesLocalUids = noteLocalUidsForTag(tagLocalUid);
+    if (affectedNotesLocalUids.isEmpty()) {
         return;
     }
 
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-
-    QStringList affectedNotesLocalUids;
-    while (noteIt != m_tagLocalUidToNoteLocalUid.end()) {
-        if (noteIt.key() != tagLocalUid) {
-            break;
-        }
-
-        affectedNotesLocalUids << noteIt.value();
-        ++noteIt;
-    }
-
     Q_UNUSED(m_tagLocalUidToNoteLocalUid.remove(tagLocalUid))
 
+    auto & localUidIndex = m_data.get<ByLocalUid>();
+
     NMTRACE(
         "Affected notes local uids: "
         << affectedNotesLocalUids.join(QStringLiteral(", ")));
@@ -2503,25 +2759,23 @@ void NoteModel::processTagExpunging(const QString & tagLocalUid)
         if (Q_UNLIKELY(noteItemIt == localUidIndex.end())) {
             NMDEBUG(
                 "Can't find the note pointed to by the expunged "
-                << "tag by local uid: note local uid = " << noteIt.value());
+                << "tag by local uid: note local uid = " << noteLocalUid);
             continue;
         }
 
         NoteModelItem item = *noteItemIt;
         item.removeTagGuid(tagGuid);
-        item.removeTagName(tagName);
+        item.removeTagId(id);
         item.removeTagLocalUid(tagLocalUid);
 
         Q_UNUSED(localUidIndex.replace(noteItemIt, item))
 
-        auto modelIndex = indexForLocalUid(item.localUid());
-        modelIndex = createIndex(modelIndex.row(), Columns::TagNameList);
-        Q_EMIT dataChanged(modelIndex, modelIndex);
-
         // This note's cache entry is clearly stale now, need to ensure
         // it won't be present in the cache
         Q_UNUSED(m_cache.remove(item.localUid()))
     }
+
+    notifyTagNameListsChanged(affectedNotesLocalUids);
 }
 
 void NoteModel::removeItemByLocalUid(const QString & localUid)
@@ -2606,34 +2860,39 @@ bool NoteModel::updateItemRowWithRespectToSorting(
         return false;
     }
 
-    NoteModelItem itemCopy(item);
-
-    NMTRACE("Removing the moved item from the original row " << originalRow);
-    beginRemoveRows(QModelIndex(), originalRow, originalRow);
-    Q_UNUSED(index.erase(it))
-    endRemoveRows();
+    NoteComparator comparator(sortingColumn(), sortOrder());
 
-    auto positionIter = std::lower_bound(
-        index.begin(), index.end(), itemCopy,
-        NoteComparator(sortingColumn(), sortOrder()));
+    // The rows before and after the item are sorted so the new row is found
+    // by binary search within one of these two ranges; relocating the item
+    // within the random access index doesn't touch the other indices
+    int newRow = originalRow;
+    if ((originalRow > 0) && comparator(*it, *std::prev(it))) {
+        auto positionIter =
+            std::lower_bound(index.begin(), it, *it, comparator);
 
-    if (positionIter == index.end()) {
-        int newRow = static_cast<int>(index.size());
+        newRow = static_cast<int>(std::distance(index.begin(), positionIter));
+    }
+    else if (
+        (std::next(it) != index.end()) && comparator(*std::next(it), *it))
+    {
+        auto positionIter =
+            std::lower_bound(std::next(it), index.end(), *it, comparator);
 
-        NMTRACE("Inserting the moved item at row " << newRow);
-        beginInsertRows(QModelIndex(), newRow, newRow);
-        index.push_back(itemCopy);
-        endInsertRows();
+        newRow = static_cast<int>(std::distance(index.begin(), positionIter));
+    }
 
+    if (newRow == originalRow) {
+        NMTRACE("The item's row " << originalRow << " is still correct");
         return true;
     }
 
-    int newRow = static_cast<int>(std::distance(index.begin(), positionIter));
+    NMTRACE("Moving the item from row " << originalRow << " to row " << newRow);
 
-    NMTRACE("Inserting the moved item at row " << newRow);
-    beginInsertRows(QModelIndex(), newRow, newRow);
-    Q_UNUSED(index.insert(positionIter, itemCopy))
-    endInsertRows();
+    beginMoveRows(
+        QModelIndex(), originalRow, originalRow, QModelIndex(), newRow);
+
+    index.relocate(index.begin() + newRow, it);
+    endMoveRows();
 
     return true;
 }
@@ -2657,20 +2916,24 @@ void NoteModel::saveNoteInLocalStorage(
 
         const auto * pCachedNote = m_cache.get(item.localUid());
         if (Q_UNLIKELY(!pCachedNote)) {
-            auto requestId = QUuid::createUuid();
-            Q_UNUSED(m_findNoteToPerformUpdateRequestIds.insert(requestId))
-
             Note dummy;
             dummy.setLocalUid(item.localUid());
 
-            NMTRACE(
-                "Emitting the request to find note: local uid = "
-                << item.localUid() << ", request id = " << requestId);
-
             LocalStorageManager::GetNoteOptions getNoteOptions(
                 LocalStorageManager::GetNoteOption::WithResourceMetadata);
 
-            Q_EMIT findNote(dummy, getNoteOptions, requestId);
+            auto requestId = scheduleLocalStorageRequest(
+                m_pRequestScheduler, *this,
+                LocalStorageRequestScheduler::Priority::Interactive,
+                [this, dummy, getNoteOptions](const QUuid & id) {
+                    Q_EMIT findNote(dummy, getNoteOptions, id);
+                });
+
+            Q_UNUSED(m_findNoteToPerformUpdateRequestIds.insert(requestId))
+
+            NMTRACE(
+                "Scheduled the request to find note: local uid = "
+                << item.localUid() << ", request id = " << requestId);
             return;
         }
 
@@ -2705,7 +2968,10 @@ void NoteModel::saveNoteInLocalStorage(
             "Emitting the request to add the note to local storage: id = "
             << requestId << ", note: " << note);
 
-        Q_EMIT addNote(note, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT addNote(note, id);
+            });
     }
     else {
         Q_UNUSED(m_updateNoteRequestIds.insert(requestId))
@@ -2728,7 +2994,10 @@ void NoteModel::saveNoteInLocalStorage(
             options |= LocalStorageManager::UpdateNoteOption::UpdateTags;
         }
 
-        Q_EMIT updateNote(note, options, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT updateNote(note, options, id);
+            });
     }
 }
 
@@ -2761,7 +3030,7 @@ QVariant NoteModel::dataImpl(const int row, const Columns::type column) const
     case Columns::NotebookName:
         return item.notebookName();
     case Columns::TagNameList:
-        return item.tagNameList();
+        return tagNames(item);
     case Columns::Size:
         return item.sizeInBytes();
     case Columns::Synchronizable:
@@ -2858,7 +3127,7 @@ QVariant NoteModel::dataAccessibleText(
     }
     case Columns::TagNameList:
     {
-        const QStringList & tagNameList = item.tagNameList();
+        const QStringList tagNameList = tagNames(item);
         if (tagNameList.isEmpty()) {
             accessibleText += tr("tag list is empty");
         }
@@ -3122,7 +3391,10 @@ bool NoteModel::removeRowsImpl(
             << "the local storage: request id = " << requestId
             << ", note local uid: " << noteLocalUid);
 
-        Q_EMIT expungeNote(note, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT expungeNote(note, id);
+            });
     }
 
     endRemoveRows();
@@ -3237,6 +3509,46 @@ bool NoteModel::setNoteFavorited(
     return true;
 }
 
+bool NoteModel::setNotesFavorited(
+    const QStringList & noteLocalUids, const bool favorited,
+    ErrorString & errorDescription)
+{
+    QVector<NoteModelItem> items;
+    items.reserve(noteLocalUids.size());
+
+    bool res = true;
+    auto & localUidIndex = m_data.get<ByLocalUid>();
+    for (const auto & noteLocalUid: qAsConst(noteLocalUids)) {
+        auto it = localUidIndex.find(noteLocalUid);
+        if (Q_UNLIKELY(it == localUidIndex.end())) {
+            errorDescription.setBase(
+                QT_TR_NOOP("internal error, the note to be "
+                           "favorited/unfavorited was not found within "
+                           "the model"));
+            NMWARNING(errorDescription << ": " << noteLocalUid);
+            res = false;
+            continue;
+        }
+
+        if (favorited == it->isFavorited()) {
+            continue;
+        }
+
+        NoteModelItem itemCopy(*it);
+        itemCopy.setFavorited(favorited);
+        localUidIndex.replace(it, itemCopy);
+        items << itemCopy;
+    }
+
+    // Favorited flag is not represented by any column so there are no
+    // notifications to send, only the updates of notes in the local storage
+    for (const auto & item: qAsConst(items)) {
+        saveNoteInLocalStorage(item);
+    }
+
+    return res;
+}
+
 void NoteModel::setSortingColumnAndOrder(
     const int column, const Qt::SortOrder order)
 {
@@ -3374,6 +3686,212 @@ bool NoteModel::moveNoteToNotebookImpl(
     return true;
 }
 
+bool NoteModel::moveNotesToNotebookImpl(
+    const QStringList & noteLocalUids, const Notebook & notebook,
+    ErrorString & errorDescription)
+{
+    NMTRACE(
+        "NoteModel::moveNotesToNotebookImpl: notebook = "
+        << notebook
+        << "\nNote local uids: " << noteLocalUids.join(QStringLiteral(", ")));
+
+    if (!notebook.canCreateNotes()) {
+        errorDescription.setBase(
+            QT_TR_NOOP("the target notebook doesn't allow to create notes in "
+                       "it"));
+        NMINFO(errorDescription << ", notebook: " << notebook);
+        return false;
+    }
+
+    const qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    QVector<NoteModelItem> items;
+    items.reserve(noteLocalUids.size());
+
+    bool res = true;
+    const auto & localUidIndex = m_data.get<ByLocalUid>();
+    for (const auto & noteLocalUid: qAsConst(noteLocalUids)) {
+        auto it = localUidIndex.find(noteLocalUid);
+        if (Q_UNLIKELY(it == localUidIndex.end())) {
+            errorDescription.setBase(
+                QT_TR_NOOP("can't find the note to be moved to another "
+                           "notebook"));
+            NMDEBUG(errorDescription << ": " << noteLocalUid);
+            res = false;
+            continue;
+        }
+
+        NoteModelItem item = *it;
+        if (item.notebookLocalUid() == notebook.localUid()) {
+            continue;
+        }
+
+        item.setNotebookLocalUid(notebook.localUid());
+        item.setNotebookName(notebook.hasName() ? notebook.name() : QString());
+        item.setNotebookGuid(notebook.hasGuid() ? notebook.guid() : QString());
+
+        item.setDirty(true);
+        item.setModificationTimestamp(timestamp);
+
+        items << item;
+    }
+
+    if (items.isEmpty()) {
+        return res;
+    }
+
+    updateItemsWithRespectToSorting(items);
+
+    for (const auto & item: qAsConst(items)) {
+        saveNoteInLocalStorage(item);
+    }
+
+    return res;
+}
+
+void NoteModel::updateItemsWithRespectToSorting(
+    const QVector<NoteModelItem> & items)
+{
+    NMDEBUG(
+        "NoteModel::updateItemsWithRespectToSorting: " << items.size()
+                                                        << " items");
+
+    Q_EMIT layoutAboutToBeChanged();
+
+    auto & index = m_data.get<ByIndex>();
+
+    auto persistentIndices = persistentIndexList();
+    QVector<std::pair<QString, int>> localUidsWithColumns;
+    localUidsWithColumns.reserve(persistentIndices.size());
+
+    for (const auto & modelIndex: qAsConst(persistentIndices)) {
+        int row = modelIndex.row();
+        if (!modelIndex.isValid() || (row < 0) ||
+            (row >= static_cast<int>(m_data.size())))
+        {
+            localUidsWithColumns << std::make_pair(QString(), 0);
+            continue;
+        }
+
+        const auto & item = index.at(static_cast<size_t>(row));
+        localUidsWithColumns << std::make_pair(
+            item.localUid(), modelIndex.column());
+    }
+
+    auto & localUidIndex = m_data.get<ByLocalUid>();
+    for (const auto & item: qAsConst(items)) {
+        auto it = localUidIndex.find(item.localUid());
+        if (it != localUidIndex.end()) {
+            localUidIndex.replace(it, item);
+        }
+    }
+
+    std::vector<boost::reference_wrapper<const NoteModelItem>> sortedItems(
+        index.begin(), index.end());
+
+    std::stable_sort(
+        sortedItems.begin(), sortedItems.end(),
+        NoteComparator(sortingColumn(), sortOrder()));
+
+    index.rearrange(sortedItems.begin());
+
+    QModelIndexList replacementIndices;
+    replacementIndices.reserve(localUidsWithColumns.size());
+
+    for (const auto & pair: qAsConst(localUidsWithColumns)) {
+        if (pair.first.isEmpty()) {
+            replacementIndices << QModelIndex();
+            continue;
+        }
+
+        auto newIndex = indexForLocalUid(pair.first);
+        if (!newIndex.isValid()) {
+            replacementIndices << QModelIndex();
+            continue;
+        }
+
+        replacementIndices << createIndex(newIndex.row(), pair.second);
+    }
+
+    changePersistentIndexList(persistentIndices, replacementIndices);
+
+    Q_EMIT layoutChanged();
+}
+
+void NoteModel::removeItemsByLocalUids(const QStringList & localUids)
+{
+    NMDEBUG(
+        "NoteModel::removeItemsByLocalUids: "
+        << localUids.join(QStringLiteral(", ")));
+
+    const auto & localUidIndex = m_data.get<ByLocalUid>();
+    auto & index = m_data.get<ByIndex>();
+
+    std::vector<int> rows;
+    rows.reserve(static_cast<size_t>(std::max(localUids.size(), 0)));
+
+    for (const auto & localUid: qAsConst(localUids)) {
+        auto it = localUidIndex.find(localUid);
+        if (it == localUidIndex.end()) {
+            continue;
+        }
+
+        auto indexIt = m_data.project<ByIndex>(it);
+        rows.push_back(
+            static_cast<int>(std::distance(index.begin(), indexIt)));
+    }
+
+    // Removing the ranges starting from the last one so that the rows of
+    // the ranges yet to be removed stay intact
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    size_t i = 0;
+    while (i < rows.size()) {
+        const int lastRow = rows[i];
+        int firstRow = lastRow;
+
+        ++i;
+        while ((i < rows.size()) && (rows[i] == firstRow - 1)) {
+            firstRow = rows[i];
+            ++i;
+        }
+
+        NMTRACE("Removing rows from " << firstRow << " to " << lastRow);
+        beginRemoveRows(QModelIndex(), firstRow, lastRow);
+
+        Q_UNUSED(index.erase(
+            index.begin() + firstRow, index.begin() + lastRow + 1))
+
+        endRemoveRows();
+    }
+}
+
+void NoteModel::onBulkDeletedNoteProcessed(
+    const QString & noteLocalUid, const bool shouldRemoveFromModel)
+{
+    NMTRACE(
+        "NoteModel::onBulkDeletedNoteProcessed: "
+        << noteLocalUid << ", should remove from model = "
+        << (shouldRemoveFromModel ? "true" : "false"));
+
+    if (!m_localUidsOfBulkDeletedNotesBeingUpdated.remove(noteLocalUid)) {
+        return;
+    }
+
+    if (shouldRemoveFromModel) {
+        m_localUidsOfBulkDeletedNotesPendingRemoval << noteLocalUid;
+    }
+
+    if (!m_localUidsOfBulkDeletedNotesBeingUpdated.isEmpty()) {
+        return;
+    }
+
+    QStringList localUids;
+    localUids.swap(m_localUidsOfBulkDeletedNotesPendingRemoval);
+    removeItemsByLocalUids(localUids);
+}
+
 void NoteModel::addOrUpdateNoteItem(
     NoteModelItem & item, const NotebookData & notebookData,
     const bool fromNotesListing)
@@ -3420,18 +3938,14 @@ void NoteModel::addOrUpdateNoteItem(
         if (fromNotesListing) {
             findTagNamesForItem(item);
 
-            int row = static_cast<int>(localUidIndex.size());
+            auto & index = m_data.get<ByIndex>();
+            int row = rowForNewItem(item);
+
+            NMTRACE("Inserting listed item at row " << row);
             beginInsertRows(QModelIndex(), row, row);
-            Q_UNUSED(localUidIndex.insert(item))
+            Q_UNUSED(index.insert(index.begin() + row, item))
             endInsertRows();
 
-            ErrorString errorDescription;
-            if (!updateItemRowWithRespectToSorting(item, errorDescription)) {
-                NMWARNING(
-                    "Could not update new note model item's row: "
-                    << errorDescription << "; item: " << item);
-            }
-
             checkMaxNoteCountAndRemoveLastNoteIfNeeded();
             return;
         }
@@ -3604,12 +4118,11 @@ void NoteModel::findTagNamesForItem(NoteModelItem & item)
                                  << ", title = " << item.title());
         }
 
-        auto tagDataIt = m_tagDataByTagLocalUid.find(tagLocalUid);
-        if (tagDataIt != m_tagDataByTagLocalUid.end()) {
+        const auto & tagData = m_tagData[tagId(tagLocalUid)];
+        if (tagData.m_found) {
             NMTRACE(
                 "Found tag data for tag local uid "
-                << tagLocalUid << ": tag name = " << tagDataIt->m_name);
-            item.addTagName(tagDataIt->m_name);
+                << tagLocalUid << ": tag name = " << tagData.m_name);
             continue;
         }
 
@@ -3625,18 +4138,21 @@ void NoteModel::findTagNamesForItem(NoteModelItem & item)
             continue;
         }
 
-        auto requestId = QUuid::createUuid();
-        Q_UNUSED(m_findTagRequestForTagLocalUid.insert(
-            LocalUidToRequestIdBimap::value_type(tagLocalUid, requestId)))
-
         Tag tag;
         tag.setLocalUid(tagLocalUid);
 
+        auto requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::VisibleView,
+            [this, tag](const QUuid & id) { Q_EMIT findTag(tag, id); },
+            localStorageRequestKey("findTag", tagLocalUid));
+
+        Q_UNUSED(m_findTagRequestForTagLocalUid.insert(
+            LocalUidToRequestIdBimap::value_type(tagLocalUid, requestId)))
+
         NMDEBUG(
-            "Emitting the request to find tag: tag local uid = "
+            "Scheduled the request to find tag: tag local uid = "
             << tagLocalUid << ", request id = " << requestId);
-
-        Q_EMIT findTag(tag, requestId);
     }
 }
 
@@ -3644,92 +4160,161 @@ void NoteModel::updateTagData(const Tag & tag)
 {
     NMTRACE("NoteModel::updateTagData: tag local uid = " << tag.localUid());
 
-    bool hasName = tag.hasName();
-    bool hasGuid = tag.hasGuid();
+    auto & tagData = m_tagData[tagId(tag.localUid())];
+    tagData.m_found = true;
 
-    auto & tagData = m_tagDataByTagLocalUid[tag.localUid()];
+    const QString previousName = tagData.m_name;
+    const QString previousGuid = tagData.m_guid;
 
-    if (hasName) {
+    if (tag.hasName()) {
         tagData.m_name = tag.name();
     }
     else {
         tagData.m_name.resize(0);
     }
 
-    if (hasGuid) {
+    if (tag.hasGuid()) {
         tagData.m_guid = tag.guid();
     }
     else {
         tagData.m_guid.resize(0);
     }
 
-    auto noteIt = m_tagLocalUidToNoteLocalUid.find(tag.localUid());
-    if (noteIt == m_tagLocalUidToNoteLocalUid.end()) {
+    const bool nameChanged = (tagData.m_name != previousName);
+    const bool guidChanged = (tagData.m_guid != previousGuid);
+    if (!nameChanged && !guidChanged) {
+        NMTRACE("Neither tag name nor guid has changed");
         return;
     }
 
-    auto & localUidIndex = m_data.get<ByLocalUid>();
+    const QStringList affectedNotesLocalUids =
+        noteLocalUidsForTag(tag.localUid());
 
-    QStringList affectedNotesLocalUids;
-    while (noteIt != m_tagLocalUidToNoteLocalUid.end()) {
-        if (noteIt.key() != tag.localUid()) {
-            break;
-        }
-
-        affectedNotesLocalUids << noteIt.value();
-        ++noteIt;
+    if (affectedNotesLocalUids.isEmpty()) {
+        return;
     }
 
     NMTRACE(
         "Affected notes local uids: "
         << affectedNotesLocalUids.join(QStringLiteral(", ")));
 
-    for (const auto & noteLocalUid: qAsConst(affectedNotesLocalUids)) {
-        auto noteItemIt = localUidIndex.find(noteLocalUid);
-        if (Q_UNLIKELY(noteItemIt == localUidIndex.end())) {
-            NMDEBUG(
-                "Can't find the note pointed to by a tag by "
-                << "local uid: note local uid = " << noteLocalUid);
-            continue;
-        }
-
-        NoteModelItem item = *noteItemIt;
-        auto tagLocalUids = item.tagLocalUids();
-
-        // Need to refresh all the tag names and guids because it is generally
-        // unknown which particular tag was updated
-        item.setTagNameList(QStringList());
-        item.setTagGuids(QStringList());
-
-        for (auto tagLocalUidIt = tagLocalUids.begin(),
-                  tagLocalUidEnd = tagLocalUids.end();
-             tagLocalUidIt != tagLocalUidEnd; ++tagLocalUidIt)
-        {
-            auto tagDataIt = m_tagDataByTagLocalUid.find(*tagLocalUidIt);
-            if (tagDataIt == m_tagDataByTagLocalUid.end()) {
-                NMTRACE(
-                    "Still no tag data for tag with local uid "
-                    << *tagLocalUidIt);
+    if (guidChanged) {
+        // Items keep tag guids themselves, unlike tag names
+        auto & localUidIndex = m_data.get<ByLocalUid>();
+        for (const auto & noteLocalUid: qAsConst(affectedNotesLocalUids)) {
+            auto noteItemIt = localUidIndex.find(noteLocalUid);
+            if (Q_UNLIKELY(noteItemIt == localUidIndex.end())) {
+                NMDEBUG(
+                    "Can't find the note pointed to by a tag by "
+                    << "local uid: note local uid = " << noteLocalUid);
                 continue;
             }
 
-            const auto & tagData = tagDataIt.value();
-
-            if (!tagData.m_name.isEmpty()) {
-                item.addTagName(tagData.m_name);
+            NoteModelItem item = *noteItemIt;
+            if (!previousGuid.isEmpty()) {
+                item.removeTagGuid(previousGuid);
             }
 
             if (!tagData.m_guid.isEmpty()) {
                 item.addTagGuid(tagData.m_guid);
             }
+
+            Q_UNUSED(localUidIndex.replace(noteItemIt, item))
         }
+    }
 
-        Q_UNUSED(localUidIndex.replace(noteItemIt, item))
+    // Items refer to the tag by its id so the new name is already in place,
+    // only the views need to know about it
+    if (nameChanged) {
+        notifyTagNameListsChanged(affectedNotesLocalUids);
+    }
+}
+
+int NoteModel::tagId(const QString & tagLocalUid)
+{
+    auto it = m_tagIdByTagLocalUid.constFind(tagLocalUid);
+    if (it != m_tagIdByTagLocalUid.constEnd()) {
+        return it.value();
+    }
+
+    const int id = m_tagData.size();
+
+    TagData tagData;
+    tagData.m_localUid = tagLocalUid;
+    m_tagData << tagData;
+
+    m_tagIdByTagLocalUid[tagLocalUid] = id;
+    return id;
+}
+
+QStringList NoteModel::tagNames(const NoteModelItem & item) const
+{
+    const auto & tagIds = item.tagIds();
+
+    QStringList result;
+    result.reserve(tagIds.size());
+
+    for (const int id: tagIds) {
+        if (Q_UNLIKELY((id < 0) || (id >= m_tagData.size()))) {
+            continue;
+        }
+
+        const auto & tagData = m_tagData[id];
+        if (tagData.m_found && !tagData.m_name.isEmpty()) {
+            result << tagData.m_name;
+        }
+    }
+
+    return result;
+}
 
-        auto modelIndex = indexForLocalUid(item.localUid());
-        modelIndex = createIndex(modelIndex.row(), Columns::TagNameList);
-        Q_EMIT dataChanged(modelIndex, modelIndex);
+QStringList NoteModel::noteLocalUidsForTag(const QString & tagLocalUid) const
+{
+    QStringList result;
+
+    auto it = m_tagLocalUidToNoteLocalUid.find(tagLocalUid);
+    while (it != m_tagLocalUidToNoteLocalUid.end()) {
+        if (it.key() != tagLocalUid) {
+            break;
+        }
+
+        result << it.value();
+        ++it;
     }
+
+    return result;
+}
+
+void NoteModel::notifyTagNameListsChanged(const QStringList & noteLocalUids)
+{
+    int firstRow = -1;
+    int lastRow = -1;
+
+    for (const auto & noteLocalUid: qAsConst(noteLocalUids)) {
+        const auto modelIndex = indexForLocalUid(noteLocalUid);
+        if (!modelIndex.isValid()) {
+            continue;
+        }
+
+        const int row = modelIndex.row();
+        if ((firstRow < 0) || (row < firstRow)) {
+            firstRow = row;
+        }
+
+        lastRow = std::max(lastRow, row);
+    }
+
+    if (firstRow < 0) {
+        return;
+    }
+
+    NMTRACE(
+        "Tag name lists changed within rows [" << firstRow << ", " << lastRow
+                                               << "]");
+
+    Q_EMIT dataChanged(
+        createIndex(firstRow, Columns::TagNameList),
+        createIndex(lastRow, Columns::TagNameList));
 }
 
 bool NoteModel::NoteFilters::isEmpty() const
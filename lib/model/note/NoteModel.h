@@ -22,6 +22,7 @@
 #include "NoteCache.h"
 #include "NoteModelItem.h"
 
+#include <lib/model/common/LocalStorageRequestScheduler.h>
 #include <lib/model/notebook/NotebookCache.h>
 #include <lib/utility/IStartable.h>
 
@@ -30,6 +31,7 @@
 #include <quentier/utility/SuppressWarnings.h>
 
 #include <QAbstractItemModel>
+#include <QVector>
 
 SAVE_WARNINGS
 
@@ -136,7 +138,8 @@ public:
         const IncludedNotes::type includedNotes = IncludedNotes::NonDeleted,
         const NoteSortingMode::type noteSortingMode =
             NoteSortingMode::ModifiedAscending,
-        NoteFilters * pFilters = nullptr);
+        NoteFilters * pFilters = nullptr,
+        LocalStorageRequestScheduler * pRequestScheduler = nullptr);
 
     virtual ~NoteModel() override;
 
@@ -298,6 +301,77 @@ public:
     bool unfavoriteNote(
         const QString & noteLocalUid, ErrorString & errorDescription);
 
+    /**
+     * @brief deleteNotes - attempts to mark the notes with the specified
+     * local uids as deleted
+     *
+     * Unlike calling deleteNote for each note, the changes to model items are
+     * applied within a single layout change. If the model doesn't include
+     * deleted notes, the rows of deleted notes are removed in a single pass
+     * after the local storage confirms the updates of all of them.
+     *
+     * Notes which cannot be deleted are skipped, the rest are still deleted.
+     *
+     * @param noteLocalUids         The local uids of notes to be marked as
+     *                              deleted
+     * @param errorDescription      Textual description of the error if some
+     *                              of notes could not be marked as deleted
+     * @return                      True if all notes were deleted
+     *                              successfully, false otherwise
+     */
+    bool deleteNotes(
+        const QStringList & noteLocalUids, ErrorString & errorDescription);
+
+    /**
+     * @brief moveNotesToNotebook - attempts to move several notes to
+     * a different notebook
+     *
+     * The target notebook is looked up only once for all notes and the changes
+     * to model items are applied within a single layout change. As with
+     * moveNoteToNotebook, the method returns before the completion of requests
+     * to update the notes within the local storage.
+     *
+     * @param noteLocalUids         The local uids of notes to be moved to
+     *                              another notebook
+     * @param notebookName          The name of the notebook into which
+     *                              the notes need to be moved
+     * @param errorDescription      Textual description of the error if some
+     *                              of notes could not be moved to
+     *                              the specified notebook
+     * @return                      True if all notes were moved to
+     *                              the specified notebook successfully, false
+     *                              otherwise
+     */
+    bool moveNotesToNotebook(
+        const QStringList & noteLocalUids, const QString & notebookName,
+        ErrorString & errorDescription);
+
+    /**
+     * @brief favoriteNotes - attempts to mark the notes with the specified
+     * local uids as favorited
+     *
+     * @param noteLocalUids         The local uids of notes to be favorited
+     * @param errorDescription      Textual description of the error if some
+     *                              of notes could not be favorited
+     * @return                      True if all notes were favorited
+     *                              successfully, false otherwise
+     */
+    bool favoriteNotes(
+        const QStringList & noteLocalUids, ErrorString & errorDescription);
+
+    /**
+     * @brief unfavoriteNotes - attempts to remove the favorited mark from
+     * the notes with the specified local uids
+     *
+     * @param noteLocalUids         The local uids of notes to be unfavorited
+     * @param errorDescription      Textual description of the error if some
+     *                              of notes could not be unfavorited
+     * @return                      True if all notes were unfavorited
+     *                              successfully, false otherwise
+     */
+    bool unfavoriteNotes(
+        const QStringList & noteLocalUids, ErrorString & errorDescription);
+
 public:
     // QAbstractItemModel interface
     virtual Qt::ItemFlags flags(const QModelIndex & modelIndex) const override;
@@ -352,6 +426,26 @@ public:
 
     virtual void stop(const StopMode::type stopMode) override;
 
+    /**
+     * @brief connectToLocalStorage and disconnectFromLocalStorage methods
+     * allow to temporarily detach the started model from local storage
+     * without clearing the loaded notes i.e. when the model is kept aside
+     * for an account which is not active at the moment
+     */
+    void connectToLocalStorage();
+    void disconnectFromLocalStorage();
+
+    bool isConnectedToLocalStorage() const
+    {
+        return m_connectedToLocalStorage;
+    }
+
+    /**
+     * @return      True if the model waits for responses to any of its
+     *              requests to local storage, false otherwise
+     */
+    bool hasPendingLocalStorageRequests() const;
+
 Q_SIGNALS:
     void notifyError(ErrorString errorDescription);
 
@@ -536,9 +630,6 @@ private Q_SLOTS:
         Tag tag, QStringList expungedChildTagLocalUids, QUuid requestId);
 
 private:
-    void connectToLocalStorage();
-    void disconnectFromLocalStorage();
-
     void onNoteAddedOrUpdated(
         const Note & note, const bool fromNotesListing = false);
 
@@ -552,6 +643,10 @@ private:
     void requestTotalNotesCountPerAccount();
     void requestTotalFilteredNotesCount();
 
+    // Deleted notes are only shown on demand so listing them should not delay
+    // the requests for non-deleted notes
+    LocalStorageRequestScheduler::Priority requestPriority() const;
+
     void findNoteToRestoreFailedUpdate(const Note & note);
 
     void clearModel();
@@ -597,6 +692,10 @@ private:
         const QString & noteLocalUid, const bool favorited,
         ErrorString & errorDescription);
 
+    bool setNotesFavorited(
+        const QStringList & noteLocalUids, const bool favorited,
+        ErrorString & errorDescription);
+
     void setSortingColumnAndOrder(const int column, const Qt::SortOrder order);
     void setSortingOrder(const Qt::SortOrder order);
 
@@ -655,8 +754,12 @@ private:
 
     struct TagData
     {
+        QString m_localUid;
         QString m_name;
         QString m_guid;
+
+        // False until the tag is found in local storage
+        bool m_found = false;
     };
 
     using LocalUidToRequestIdBimap = boost::bimap<QString, QUuid>;
@@ -667,6 +770,21 @@ private:
         NoteDataByLocalUid::iterator it, const Notebook & notebook,
         ErrorString & errorDescription);
 
+    bool moveNotesToNotebookImpl(
+        const QStringList & noteLocalUids, const Notebook & notebook,
+        ErrorString & errorDescription);
+
+    // Replaces the items having the same local uids as the passed in ones
+    // and restores the sorting of the model within a single layout change
+    void updateItemsWithRespectToSorting(const QVector<NoteModelItem> & items);
+
+    // Removes the rows of the specified items from the model, one removal per
+    // each range of adjacent rows
+    void removeItemsByLocalUids(const QStringList & localUids);
+
+    void onBulkDeletedNoteProcessed(
+        const QString & noteLocalUid, const bool shouldRemoveFromModel);
+
     void addOrUpdateNoteItem(
         NoteModelItem & item, const NotebookData & notebookData,
         const bool fromNotesListing);
@@ -680,6 +798,18 @@ private:
 
     void updateTagData(const Tag & tag);
 
+    // Returns the id of the tag within the table of tags, adds the tag to
+    // the table if it's not there yet
+    int tagId(const QString & tagLocalUid);
+
+    QStringList tagNames(const NoteModelItem & item) const;
+
+    QStringList noteLocalUidsForTag(const QString & tagLocalUid) const;
+
+    // Emits single dataChanged for tag name list column spanning the rows of
+    // all the given notes
+    void notifyTagNameListsChanged(const QStringList & noteLocalUids);
+
 private:
     Account m_account;
     const IncludedNotes::type m_includedNotes;
@@ -687,6 +817,7 @@ private:
 
     LocalStorageManagerAsync & m_localStorageManagerAsync;
     bool m_connectedToLocalStorage = false;
+    LocalStorageRequestScheduler * m_pRequestScheduler;
 
     bool m_isStarted = false;
 
@@ -728,7 +859,19 @@ private:
     LocalUidToRequestIdBimap
         m_noteLocalUidToFindNotebookRequestIdForMoveNoteToNotebookBimap;
 
-    QHash<QString, TagData> m_tagDataByTagLocalUid;
+    QHash<QUuid, QStringList>
+        m_noteLocalUidsByFindNotebookRequestIdForMoveNotesToNotebook;
+
+    // Local uids of notes deleted via deleteNotes which updates haven't been
+    // confirmed by the local storage yet and those which rows are to be
+    // removed once all such updates are confirmed
+    QSet<QString> m_localUidsOfBulkDeletedNotesBeingUpdated;
+    QStringList m_localUidsOfBulkDeletedNotesPendingRemoval;
+
+    // Table of tags referenced by note items; items refer to tags by their
+    // indexes within it
+    QVector<TagData> m_tagData;
+    QHash<QString, int> m_tagIdByTagLocalUid;
 
     LocalUidToRequestIdBimap m_findTagRequestForTagLocalUid;
     QMultiHash<QString, QString> m_tagLocalUidToNoteLocalUid;
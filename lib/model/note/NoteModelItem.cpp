@@ -82,34 +82,14 @@ int NoteModelItem::numTagGuids() const
     return m_tagGuids.size();
 }
 
-void NoteModelItem::addTagName(const QString & tagName)
+void NoteModelItem::removeTagId(const int tagId)
 {
-    int index = m_tagNameList.indexOf(tagName);
-    if (index >= 0) {
-        return;
-    }
-
-    m_tagNameList << tagName;
-}
-
-void NoteModelItem::removeTagName(const QString & tagName)
-{
-    int index = m_tagNameList.indexOf(tagName);
+    int index = m_tagIds.indexOf(tagId);
     if (index < 0) {
         return;
     }
 
-    m_tagNameList.removeAt(index);
-}
-
-bool NoteModelItem::hasTagName(const QString & tagName) const
-{
-    return m_tagNameList.contains(tagName);
-}
-
-int NoteModelItem::numTagNames() const
-{
-    return m_tagNameList.size();
+    m_tagIds.remove(index);
 }
 
 QTextStream & NoteModelItem::print(QTextStream & strm) const
@@ -122,8 +102,13 @@ QTextStream & NoteModelItem::print(QTextStream & strm) const
          << ", notebook name = " << m_notebookName
          << ", tag local uids = " << m_tagLocalUids.join(QStringLiteral(", "))
          << ", tag guids = " << m_tagGuids.join(QStringLiteral(", "))
-         << ", tag name list = " << m_tagNameList.join(QStringLiteral(", "))
-         << ", creation timestamp = " << m_creationTimestamp << " ("
+         << ", tag ids =";
+
+    for (const int tagId: m_tagIds) {
+        strm << " " << tagId;
+    }
+
+    strm << ", creation timestamp = " << m_creationTimestamp << " ("
          << printableDateTimeFromTimestamp(m_creationTimestamp)
          << "), modification timestamp = " << m_modificationTimestamp << " ("
          << printableDateTimeFromTimestamp(m_modificationTimestamp)
@@ -23,6 +23,7 @@
 
 #include <QByteArray>
 #include <QStringList>
+#include <QVector>
 
 namespace quentier {
 
@@ -149,23 +150,19 @@ public:
 
     int numTagGuids() const;
 
-    const QStringList & tagNameList() const
+    // Tags are referred to by their ids within the note model's table of tags
+    // so that renaming the tag doesn't require updating each item with it
+    const QVector<int> & tagIds() const
     {
-        return m_tagNameList;
+        return m_tagIds;
     }
 
-    void setTagNameList(QStringList tagNameList)
+    void setTagIds(QVector<int> tagIds)
     {
-        m_tagNameList = std::move(tagNameList);
+        m_tagIds = std::move(tagIds);
     }
 
-    void addTagName(const QString & tagName);
-
-    void removeTagName(const QString & tagName);
-
-    bool hasTagName(const QString & tagName) const;
-
-    int numTagNames() const;
+    void removeTagId(const int tagId);
 
     qint64 creationTimestamp() const
     {
@@ -320,7 +317,7 @@ private:
     QString m_notebookName;
     QStringList m_tagLocalUids;
     QStringList m_tagGuids;
-    QStringList m_tagNameList;
+    QVector<int> m_tagIds;
 
     qint64 m_creationTimestamp = -1;
     qint64 m_modificationTimestamp = -1;
@@ -0,0 +1,1063 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NoteSearchIndex.h"
+
+#include <lib/model/common/LocalStorageRequestScheduler.h>
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Compat.h>
+
+#include <QDataStream>
+#include <QThreadPool>
+
+#include <algorithm>
+
+#define NOTE_SEARCH_INDEX_SNAPSHOT_VERSION (2)
+
+#define INTITLE_PREFIX QStringLiteral("intitle:")
+#define TAG_PREFIX     QStringLiteral("tag:")
+
+namespace quentier {
+
+NoteSearchIndex::NoteSearchIndex(
+    const Account & account,
+    LocalStorageManagerAsync & localStorageManagerAsync, QObject * parent,
+    ModelSnapshot * pSnapshot,
+    LocalStorageRequestScheduler * pRequestScheduler) :
+    QObject(parent),
+    m_account(account), m_localStorageManagerAsync(localStorageManagerAsync),
+    m_pRequestScheduler(pRequestScheduler)
+{
+    qRegisterMetaType<QVector<NoteSearchIndexEntry>>(
+        "QVector<NoteSearchIndexEntry>");
+
+    createConnections();
+
+    if (pSnapshot && pSnapshot->isUpToDate() &&
+        restoreFromSnapshot(*pSnapshot))
+    {
+        m_isReady = true;
+        return;
+    }
+
+    requestTagsList();
+}
+
+NoteSearchIndex::~NoteSearchIndex()
+{
+    if (m_pRequestScheduler) {
+        m_pRequestScheduler->cancelRequests(*this);
+    }
+}
+
+bool NoteSearchIndex::findNoteLocalUids(
+    const QString & searchString, QSet<QString> & noteLocalUids) const
+{
+    if (!m_isReady) {
+        return false;
+    }
+
+    QVector<Term> terms;
+    if (!parseSearchString(searchString, terms)) {
+        return false;
+    }
+
+    if (m_notesWithRecognitionDataCount != 0) {
+        for (const auto & term: qAsConst(terms)) {
+            if (term.m_scope == Term::Scope::Any) {
+                QNTRACE(
+                    "model:note_search_index",
+                    "Plain words might match the text recognized in "
+                        << m_notesWithRecognitionDataCount
+                        << " notes' resources which is not indexed");
+                return false;
+            }
+        }
+    }
+
+    noteLocalUids.clear();
+
+    // All terms must match i.e. the sets of notes matching each term are
+    // intersected
+    bool first = true;
+    for (const auto & term: qAsConst(terms)) {
+        auto termNoteLocalUids = findNoteLocalUids(term);
+        if (first) {
+            noteLocalUids = std::move(termNoteLocalUids);
+            first = false;
+        }
+        else {
+            noteLocalUids.intersect(termNoteLocalUids);
+        }
+
+        if (noteLocalUids.isEmpty()) {
+            break;
+        }
+    }
+
+    QNTRACE(
+        "model:note_search_index",
+        "Found " << noteLocalUids.size() << " notes for search string "
+                 << searchString);
+
+    return true;
+}
+
+bool NoteSearchIndex::saveSnapshot(ModelSnapshotWriter & writer) const
+{
+    QNDEBUG("model:note_search_index", "NoteSearchIndex::saveSnapshot");
+
+    if (!m_isReady || !m_listTagsRequestId.isNull() ||
+        !m_listNotesRequestId.isNull() || (m_pendingTokenizersCount != 0))
+    {
+        QNDEBUG(
+            "model:note_search_index",
+            "Note search index is not fully built, won't save its snapshot");
+        return false;
+    }
+
+    auto & stream = writer.stream();
+
+    stream << quint32(NOTE_SEARCH_INDEX_SNAPSHOT_VERSION)
+           << quint32(m_tagNamesByLocalUid.size());
+
+    for (auto it = m_tagNamesByLocalUid.constBegin(),
+              end = m_tagNamesByLocalUid.constEnd();
+         it != end; ++it)
+    {
+        stream << it.key() << it.value();
+    }
+
+    stream << quint32(m_notes.size());
+
+    for (auto it = m_notes.constBegin(), end = m_notes.constEnd(); it != end;
+         ++it)
+    {
+        const auto & entry = it.value();
+        stream << it.key() << entry.m_notebookLocalUid << entry.m_titleTokens
+               << entry.m_textTokens << entry.m_tagLocalUids
+               << entry.m_hasRecognitionData;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+void NoteSearchIndex::onAddNoteComplete(Note note, QUuid requestId)
+{
+    QNTRACE(
+        "model:note_search_index",
+        "NoteSearchIndex::onAddNoteComplete: note local uid = "
+            << note.localUid() << ", request id = " << requestId);
+
+    if (!m_isReady) {
+        Q_UNUSED(m_noteLocalUidsChangedWhileBuilding.insert(note.localUid()))
+        return;
+    }
+
+    addOrUpdateNote(note);
+}
+
+void NoteSearchIndex::onUpdateNoteComplete(
+    Note note, LocalStorageManager::UpdateNoteOptions options, QUuid requestId)
+{
+    QNTRACE(
+        "model:note_search_index",
+        "NoteSearchIndex::onUpdateNoteComplete: note local uid = "
+            << note.localUid() << ", request id = " << requestId);
+
+    if (!m_isReady) {
+        Q_UNUSED(m_noteLocalUidsChangedWhileBuilding.insert(note.localUid()))
+        return;
+    }
+
+    addOrUpdateNote(
+        note,
+        static_cast<bool>(
+            options & LocalStorageManager::UpdateNoteOption::UpdateTags),
+        static_cast<bool>(
+            options &
+            LocalStorageManager::UpdateNoteOption::UpdateResourceMetadata));
+}
+
+void NoteSearchIndex::onExpungeNoteComplete(Note note, QUuid requestId)
+{
+    QNTRACE(
+        "model:note_search_index",
+        "NoteSearchIndex::onExpungeNoteComplete: note local uid = "
+            << note.localUid() << ", request id = " << requestId);
+
+    if (!m_isReady) {
+        Q_UNUSED(m_noteLocalUidsChangedWhileBuilding.insert(note.localUid()))
+    }
+
+    removeNote(note.localUid());
+}
+
+void NoteSearchIndex::onListNotesComplete(
+    LocalStorageManager::ListObjectsOptions flag,
+    LocalStorageManager::GetNoteOptions options, size_t limit, size_t offset,
+    LocalStorageManager::ListNotesOrder order,
+    LocalStorageManager::OrderDirection orderDirection,
+    QString linkedNotebookGuid, QList<Note> foundNotes, QUuid requestId)
+{
+    if (requestId != m_listNotesRequestId) {
+        return;
+    }
+
+    QNDEBUG(
+        "model:note_search_index",
+        "NoteSearchIndex::onListNotesComplete: flag = "
+            << flag << ", limit = " << limit << ", offset = " << offset
+            << ", order = " << order << ", direction = " << orderDirection
+            << ", linked notebook guid = " << linkedNotebookGuid
+            << ", num found notes = " << foundNotes.size()
+            << ", request id = " << requestId);
+
+    Q_UNUSED(options)
+
+    m_listNotesRequestId = QUuid();
+
+    const bool hasMoreNotes = (foundNotes.size() == static_cast<int>(limit));
+    m_listNotesOffset += static_cast<size_t>(foundNotes.size());
+
+    QList<Note> notes;
+    notes.reserve(foundNotes.size());
+    for (auto & note: foundNotes) {
+        if (!m_noteLocalUidsChangedWhileBuilding.contains(note.localUid())) {
+            notes << std::move(note);
+        }
+    }
+
+    if (!notes.isEmpty()) {
+        tokenizeNotes(std::move(notes));
+    }
+
+    // The next page is listed while the current one is being tokenized
+    if (hasMoreNotes) {
+        requestNotesList();
+        return;
+    }
+
+    m_allNotesListed = true;
+    finishBuildingIfPossible();
+}
+
+void NoteSearchIndex::onListNotesFailed(
+    LocalStorageManager::ListObjectsOptions flag,
+    LocalStorageManager::GetNoteOptions options, size_t limit, size_t offset,
+    LocalStorageManager::ListNotesOrder order,
+    LocalStorageManager::OrderDirection orderDirection,
+    QString linkedNotebookGuid, ErrorString errorDescription, QUuid requestId)
+{
+    if (requestId != m_listNotesRequestId) {
+        return;
+    }
+
+    QNWARNING(
+        "model:note_search_index",
+        "NoteSearchIndex::onListNotesFailed: flag = "
+            << flag << ", limit = " << limit << ", offset = " << offset
+            << ", order = " << order << ", direction = " << orderDirection
+            << ", linked notebook guid = " << linkedNotebookGuid
+            << ", error: " << errorDescription
+            << ", request id = " << requestId);
+
+    Q_UNUSED(options)
+
+    // The index stays not ready so all searches go through the local storage
+    m_listNotesRequestId = QUuid();
+}
+
+void NoteSearchIndex::onListNotesByLocalUidsComplete(
+    QStringList noteLocalUids, LocalStorageManager::GetNoteOptions options,
+    LocalStorageManager::ListObjectsOptions flag, size_t limit, size_t offset,
+    LocalStorageManager::ListNotesOrder order,
+    LocalStorageManager::OrderDirection orderDirection, QList<Note> foundNotes,
+    QUuid requestId)
+{
+    if (requestId != m_listChangedNotesRequestId) {
+        return;
+    }
+
+    QNDEBUG(
+        "model:note_search_index",
+        "NoteSearchIndex::onListNotesByLocalUidsComplete: flag = "
+            << flag << ", limit = " << limit << ", offset = " << offset
+            << ", order = " << order << ", direction = " << orderDirection
+            << ", num note local uids = " << noteLocalUids.size()
+            << ", num found notes = " << foundNotes.size()
+            << ", request id = " << requestId);
+
+    Q_UNUSED(options)
+
+    m_listChangedNotesRequestId = QUuid();
+
+    // Notes not found have been expunged and are already removed from
+    // the index; notes changed once again since the request was sent would
+    // be listed with the next request
+    QList<Note> notes;
+    notes.reserve(foundNotes.size());
+    for (auto & note: foundNotes) {
+        if (!m_noteLocalUidsChangedWhileBuilding.contains(note.localUid())) {
+            notes << std::move(note);
+        }
+    }
+
+    if (!notes.isEmpty()) {
+        tokenizeNotes(std::move(notes));
+    }
+
+    finishBuildingIfPossible();
+}
+
+void NoteSearchIndex::onListNotesByLocalUidsFailed(
+    QStringList noteLocalUids, LocalStorageManager::GetNoteOptions options,
+    LocalStorageManager::ListObjectsOptions flag, size_t limit, size_t offset,
+    LocalStorageManager::ListNotesOrder order,
+    LocalStorageManager::OrderDirection orderDirection,
+    ErrorString errorDescription, QUuid requestId)
+{
+    if (requestId != m_listChangedNotesRequestId) {
+        return;
+    }
+
+    QNWARNING(
+        "model:note_search_index",
+        "NoteSearchIndex::onListNotesByLocalUidsFailed: flag = "
+            << flag << ", limit = " << limit << ", offset = " << offset
+            << ", order = " << order << ", direction = " << orderDirection
+            << ", num note local uids = " << noteLocalUids.size()
+            << ", error: " << errorDescription
+            << ", request id = " << requestId);
+
+    Q_UNUSED(options)
+
+    // The index stays not ready so all searches go through the local storage
+    m_listChangedNotesRequestId = QUuid();
+}
+
+void NoteSearchIndex::onExpungeNotebookComplete(
+    Notebook notebook, QUuid requestId)
+{
+    QNTRACE(
+        "model:note_search_index",
+        "NoteSearchIndex::onExpungeNotebookComplete: notebook local uid = "
+            << notebook.localUid() << ", request id = " << requestId);
+
+    QStringList noteLocalUids;
+    for (auto it = m_notes.constBegin(), end = m_notes.constEnd(); it != end;
+         ++it)
+    {
+        if (it.value().m_notebookLocalUid == notebook.localUid()) {
+            noteLocalUids << it.key();
+        }
+    }
+
+    for (const auto & noteLocalUid: qAsConst(noteLocalUids)) {
+        if (!m_isReady) {
+            Q_UNUSED(m_noteLocalUidsChangedWhileBuilding.insert(noteLocalUid))
+        }
+
+        removeNote(noteLocalUid);
+    }
+}
+
+void NoteSearchIndex::onAddTagComplete(Tag tag, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    setTagName(tag.localUid(), tag.hasName() ? tag.name() : QString());
+}
+
+void NoteSearchIndex::onUpdateTagComplete(Tag tag, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    setTagName(tag.localUid(), tag.hasName() ? tag.name() : QString());
+}
+
+void NoteSearchIndex::onExpungeTagComplete(
+    Tag tag, QStringList expungedChildTagLocalUids, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+
+    removeTag(tag.localUid());
+    for (const auto & tagLocalUid: qAsConst(expungedChildTagLocalUids)) {
+        removeTag(tagLocalUid);
+    }
+}
+
+void NoteSearchIndex::onListTagsComplete(
+    LocalStorageManager::ListObjectsOptions flag, size_t limit, size_t offset,
+    LocalStorageManager::ListTagsOrder order,
+    LocalStorageManager::OrderDirection orderDirection,
+    QString linkedNotebookGuid, QList<Tag> foundTags, QUuid requestId)
+{
+    if (requestId != m_listTagsRequestId) {
+        return;
+    }
+
+    QNDEBUG(
+        "model:note_search_index",
+        "NoteSearchIndex::onListTagsComplete: flag = "
+            << flag << ", limit = " << limit << ", offset = " << offset
+            << ", order = " << order << ", direction = " << orderDirection
+            << ", linked notebook guid = " << linkedNotebookGuid
+            << ", num found tags = " << foundTags.size()
+            << ", request id = " << requestId);
+
+    m_listTagsRequestId = QUuid();
+
+    for (const auto & tag: qAsConst(foundTags)) {
+        if (tag.hasName()) {
+            setTagName(tag.localUid(), tag.name());
+        }
+    }
+
+    if (foundTags.size() == static_cast<int>(limit)) {
+        m_listTagsOffset += static_cast<size_t>(foundTags.size());
+        requestTagsList();
+        return;
+    }
+
+    requestNotesList();
+}
+
+void NoteSearchIndex::onNotesTokenized(
+    QStringList noteLocalUids, QVector<NoteSearchIndexEntry> entries)
+{
+    QNDEBUG(
+        "model:note_search_index",
+        "NoteSearchIndex::onNotesTokenized: notes count = "
+            << noteLocalUids.size());
+
+    --m_pendingTokenizersCount;
+
+    for (int i = 0, size = noteLocalUids.size(); i < size; ++i) {
+        const QString & localUid = noteLocalUids[i];
+
+        // The note might have been changed while it was being tokenized
+        if (m_noteLocalUidsChangedWhileBuilding.contains(localUid)) {
+            continue;
+        }
+
+        insertNoteEntry(localUid, std::move(entries[i]));
+    }
+
+    finishBuildingIfPossible();
+}
+
+void NoteSearchIndex::onListTagsFailed(
+    LocalStorageManager::ListObjectsOptions flag, size_t limit, size_t offset,
+    LocalStorageManager::ListTagsOrder order,
+    LocalStorageManager::OrderDirection orderDirection,
+    QString linkedNotebookGuid, ErrorString errorDescription, QUuid requestId)
+{
+    if (requestId != m_listTagsRequestId) {
+        return;
+    }
+
+    QNWARNING(
+        "model:note_search_index",
+        "NoteSearchIndex::onListTagsFailed: flag = "
+            << flag << ", limit = " << limit << ", offset = " << offset
+            << ", order = " << order << ", direction = " << orderDirection
+            << ", linked notebook guid = " << linkedNotebookGuid
+            << ", error: " << errorDescription
+            << ", request id = " << requestId);
+
+    // The index stays not ready so all searches go through the local storage
+    m_listTagsRequestId = QUuid();
+}
+
+bool NoteSearchIndex::parseSearchString(
+    const QString & searchString, QVector<Term> & terms)
+{
+    terms.clear();
+
+    const int length = searchString.size();
+    int pos = 0;
+    while (pos < length) {
+        if (searchString[pos].isSpace()) {
+            ++pos;
+            continue;
+        }
+
+        int end = pos;
+        while ((end < length) && !searchString[end].isSpace()) {
+            ++end;
+        }
+
+        QString word = searchString.mid(pos, end - pos);
+        pos = end;
+
+        Term term;
+        if (word.startsWith(INTITLE_PREFIX, Qt::CaseInsensitive)) {
+            term.m_scope = Term::Scope::Title;
+            word.remove(0, INTITLE_PREFIX.size());
+        }
+        else if (word.startsWith(TAG_PREFIX, Qt::CaseInsensitive)) {
+            term.m_scope = Term::Scope::Tag;
+            word.remove(0, TAG_PREFIX.size());
+        }
+
+        if (word.endsWith(QChar::fromLatin1('*'))) {
+            term.m_isPrefix = true;
+            word.chop(1);
+        }
+
+        if (word.isEmpty()) {
+            return false;
+        }
+
+        // Negations, quoted phrases, other modifiers and wildcards in
+        // the middle of words need the full query grammar
+        if (word.startsWith(QChar::fromLatin1('-')) ||
+            word.contains(QChar::fromLatin1('"')) ||
+            word.contains(QChar::fromLatin1(':')) ||
+            word.contains(QChar::fromLatin1('*')))
+        {
+            return false;
+        }
+
+        // Plain words and words in titles must be single tokens as
+        // the index knows nothing about their order within the text
+        if (term.m_scope != Term::Scope::Tag) {
+            for (const auto & ch: qAsConst(word)) {
+                if (!ch.isLetterOrNumber()) {
+                    return false;
+                }
+            }
+        }
+
+        term.m_text = word.toCaseFolded();
+        terms << term;
+    }
+
+    return !terms.isEmpty();
+}
+
+void NoteSearchIndex::createConnections()
+{
+    QNTRACE("model:note_search_index", "NoteSearchIndex::createConnections");
+
+    // Local signals to localStorageManagerAsync's slots
+    QObject::connect(
+        this, &NoteSearchIndex::listNotes, &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onListNotesRequest);
+
+    QObject::connect(
+        this, &NoteSearchIndex::listNotesByLocalUids,
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onListNotesByLocalUidsRequest);
+
+    QObject::connect(
+        this, &NoteSearchIndex::listTags, &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onListTagsRequest);
+
+    // localStorageManagerAsync's signals to local slots
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::addNoteComplete, this,
+        &NoteSearchIndex::onAddNoteComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::updateNoteComplete, this,
+        &NoteSearchIndex::onUpdateNoteComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeNoteComplete, this,
+        &NoteSearchIndex::onExpungeNoteComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listNotesComplete, this,
+        &NoteSearchIndex::onListNotesComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listNotesFailed, this,
+        &NoteSearchIndex::onListNotesFailed);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listNotesByLocalUidsComplete, this,
+        &NoteSearchIndex::onListNotesByLocalUidsComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listNotesByLocalUidsFailed, this,
+        &NoteSearchIndex::onListNotesByLocalUidsFailed);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeNotebookComplete, this,
+        &NoteSearchIndex::onExpungeNotebookComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::addTagComplete,
+        this, &NoteSearchIndex::onAddTagComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::updateTagComplete, this,
+        &NoteSearchIndex::onUpdateTagComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeTagComplete, this,
+        &NoteSearchIndex::onExpungeTagComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listTagsComplete, this,
+        &NoteSearchIndex::onListTagsComplete);
+
+    QObject::connect(
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::listTagsFailed,
+        this, &NoteSearchIndex::onListTagsFailed);
+}
+
+void NoteSearchIndex::requestTagsList()
+{
+    QNTRACE(
+        "model:note_search_index",
+        "NoteSearchIndex::requestTagsList: offset = " << m_listTagsOffset);
+
+    LocalStorageManager::ListObjectsOptions flags =
+        LocalStorageManager::ListObjectsOption::ListAll;
+
+    auto order = LocalStorageManager::ListTagsOrder::NoOrder;
+    auto direction = LocalStorageManager::OrderDirection::Ascending;
+    const size_t offset = m_listTagsOffset;
+
+    m_listTagsRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, flags, offset, order, direction](const QUuid & id) {
+            Q_EMIT listTags(
+                flags, NOTE_SEARCH_INDEX_LIST_LIMIT, offset, order, direction,
+                {}, id);
+        },
+        localStorageRequestKey(
+            "listTags", flags, NOTE_SEARCH_INDEX_LIST_LIMIT, offset, order,
+            direction, QString()));
+}
+
+void NoteSearchIndex::requestNotesList()
+{
+    QNTRACE(
+        "model:note_search_index",
+        "NoteSearchIndex::requestNotesList: offset = " << m_listNotesOffset);
+
+    LocalStorageManager::ListObjectsOptions flags =
+        LocalStorageManager::ListObjectsOption::ListAll;
+
+    // Resources' metadata tells whether notes have recognition data
+    LocalStorageManager::GetNoteOptions options(
+        LocalStorageManager::GetNoteOption::WithResourceMetadata);
+
+    auto order = LocalStorageManager::ListNotesOrder::NoOrder;
+    auto direction = LocalStorageManager::OrderDirection::Ascending;
+    const size_t offset = m_listNotesOffset;
+
+    m_listNotesRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, flags, options, offset, order, direction](const QUuid & id) {
+            Q_EMIT listNotes(
+                flags, options, NOTE_SEARCH_INDEX_LIST_LIMIT, offset, order,
+                direction, {}, id);
+        });
+}
+
+void NoteSearchIndex::requestChangedNotes()
+{
+    const QStringList noteLocalUids =
+        m_noteLocalUidsChangedWhileBuilding.values();
+
+    m_noteLocalUidsChangedWhileBuilding.clear();
+
+    QNTRACE(
+        "model:note_search_index",
+        "NoteSearchIndex::requestChangedNotes: notes count = "
+            << noteLocalUids.size());
+
+    LocalStorageManager::ListObjectsOptions flags =
+        LocalStorageManager::ListObjectsOption::ListAll;
+
+    LocalStorageManager::GetNoteOptions options(
+        LocalStorageManager::GetNoteOption::WithResourceMetadata);
+
+    auto order = LocalStorageManager::ListNotesOrder::NoOrder;
+    auto direction = LocalStorageManager::OrderDirection::Ascending;
+    const auto limit = static_cast<size_t>(noteLocalUids.size());
+
+    m_listChangedNotesRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Background,
+        [this, noteLocalUids, options, flags, limit, order,
+         direction](const QUuid & id) {
+            Q_EMIT listNotesByLocalUids(
+                noteLocalUids, options, flags, limit, 0, order, direction,
+                id);
+        });
+}
+
+void NoteSearchIndex::tokenizeNotes(QList<Note> notes)
+{
+    QNTRACE(
+        "model:note_search_index",
+        "NoteSearchIndex::tokenizeNotes: notes count = " << notes.size());
+
+    auto * pTokenizer = new NoteSearchIndexTokenizer(std::move(notes));
+
+    QObject::connect(
+        pTokenizer, &NoteSearchIndexTokenizer::finished, this,
+        &NoteSearchIndex::onNotesTokenized);
+
+    ++m_pendingTokenizersCount;
+    QThreadPool::globalInstance()->start(pTokenizer);
+}
+
+void NoteSearchIndex::finishBuildingIfPossible()
+{
+    if (!m_allNotesListed || (m_pendingTokenizersCount != 0) ||
+        !m_listChangedNotesRequestId.isNull() || m_isReady)
+    {
+        return;
+    }
+
+    if (!m_noteLocalUidsChangedWhileBuilding.isEmpty()) {
+        requestChangedNotes();
+        return;
+    }
+
+    QNDEBUG(
+        "model:note_search_index",
+        "NoteSearchIndex::finishBuildingIfPossible: indexed "
+            << m_notes.size() << " notes");
+
+    m_isReady = true;
+    Q_EMIT ready();
+}
+
+void NoteSearchIndex::addOrUpdateNote(
+    const Note & note, const bool updateTags, const bool updateResources)
+{
+    const QString & localUid = note.localUid();
+
+    NoteEntry entry;
+
+    auto it = m_notes.constFind(localUid);
+    if (it != m_notes.constEnd()) {
+        if (!updateTags) {
+            entry.m_tagLocalUids = it.value().m_tagLocalUids;
+        }
+
+        if (!note.hasContent()) {
+            entry.m_textTokens = it.value().m_textTokens;
+        }
+
+        if (!updateResources) {
+            entry.m_hasRecognitionData = it.value().m_hasRecognitionData;
+        }
+    }
+
+    if (note.hasNotebookLocalUid()) {
+        entry.m_notebookLocalUid = note.notebookLocalUid();
+    }
+    else if (it != m_notes.constEnd()) {
+        entry.m_notebookLocalUid = it.value().m_notebookLocalUid;
+    }
+
+    if (note.hasTitle()) {
+        entry.m_titleTokens = tokenizeNoteSearchIndexText(note.title());
+    }
+
+    if (note.hasContent()) {
+        entry.m_textTokens = tokenizeNoteSearchIndexText(note.plainText());
+    }
+
+    if (updateTags && note.hasTagLocalUids()) {
+        entry.m_tagLocalUids = note.tagLocalUids();
+    }
+
+    if (updateResources) {
+        entry.m_hasRecognitionData = noteHasRecognitionData(note);
+    }
+
+    insertNoteEntry(localUid, std::move(entry));
+}
+
+void NoteSearchIndex::insertNoteEntry(
+    const QString & localUid, NoteEntry entry)
+{
+    removeNote(localUid);
+
+    addPostings(m_noteLocalUidsByTitleToken, entry.m_titleTokens, localUid);
+    addPostings(m_noteLocalUidsByTextToken, entry.m_textTokens, localUid);
+
+    for (const auto & tagLocalUid: qAsConst(entry.m_tagLocalUids)) {
+        Q_UNUSED(m_noteLocalUidsByTagLocalUid[tagLocalUid].insert(localUid))
+    }
+
+    if (entry.m_hasRecognitionData) {
+        ++m_notesWithRecognitionDataCount;
+    }
+
+    m_notes[localUid] = std::move(entry);
+}
+
+void NoteSearchIndex::removeNote(const QString & localUid)
+{
+    auto it = m_notes.find(localUid);
+    if (it == m_notes.end()) {
+        return;
+    }
+
+    const auto & entry = it.value();
+
+    removePostings(m_noteLocalUidsByTitleToken, entry.m_titleTokens, localUid);
+    removePostings(m_noteLocalUidsByTextToken, entry.m_textTokens, localUid);
+
+    for (const auto & tagLocalUid: qAsConst(entry.m_tagLocalUids)) {
+        auto tagIt = m_noteLocalUidsByTagLocalUid.find(tagLocalUid);
+        if (tagIt == m_noteLocalUidsByTagLocalUid.end()) {
+            continue;
+        }
+
+        Q_UNUSED(tagIt.value().remove(localUid))
+        if (tagIt.value().isEmpty()) {
+            Q_UNUSED(m_noteLocalUidsByTagLocalUid.erase(tagIt))
+        }
+    }
+
+    if (entry.m_hasRecognitionData) {
+        --m_notesWithRecognitionDataCount;
+    }
+
+    Q_UNUSED(m_notes.erase(it))
+}
+
+void NoteSearchIndex::setTagName(
+    const QString & tagLocalUid, const QString & name)
+{
+    if (name.isEmpty()) {
+        Q_UNUSED(m_tagNamesByLocalUid.remove(tagLocalUid))
+        return;
+    }
+
+    m_tagNamesByLocalUid[tagLocalUid] = name.toCaseFolded();
+}
+
+void NoteSearchIndex::removeTag(const QString & tagLocalUid)
+{
+    Q_UNUSED(m_tagNamesByLocalUid.remove(tagLocalUid))
+
+    // Local storage removes the expunged tag from notes so the notes' entries
+    // need to be updated too
+    const auto noteLocalUids = m_noteLocalUidsByTagLocalUid.take(tagLocalUid);
+    for (const auto & noteLocalUid: noteLocalUids) {
+        auto it = m_notes.find(noteLocalUid);
+        if (it != m_notes.end()) {
+            Q_UNUSED(it.value().m_tagLocalUids.removeAll(tagLocalUid))
+        }
+    }
+}
+
+QSet<QString> NoteSearchIndex::findNoteLocalUids(const Term & term) const
+{
+    QSet<QString> noteLocalUids;
+
+    switch (term.m_scope) {
+    case Term::Scope::Any:
+        collectPostings(
+            m_noteLocalUidsByTitleToken, term.m_text, term.m_isPrefix,
+            noteLocalUids);
+        collectPostings(
+            m_noteLocalUidsByTextToken, term.m_text, term.m_isPrefix,
+            noteLocalUids);
+        collectTagPostings(term, /* match words = */ true, noteLocalUids);
+        break;
+    case Term::Scope::Title:
+        collectPostings(
+            m_noteLocalUidsByTitleToken, term.m_text, term.m_isPrefix,
+            noteLocalUids);
+        break;
+    case Term::Scope::Tag:
+        collectTagPostings(term, /* match words = */ false, noteLocalUids);
+        break;
+    }
+
+    return noteLocalUids;
+}
+
+void NoteSearchIndex::collectTagPostings(
+    const Term & term, const bool matchWords,
+    QSet<QString> & noteLocalUids) const
+{
+    const auto matches = [&term](const QString & str) {
+        return term.m_isPrefix ? str.startsWith(term.m_text)
+                               : (str == term.m_text);
+    };
+
+    // There are much fewer tags than words so tag names are just scanned
+    for (auto it = m_tagNamesByLocalUid.constBegin(),
+              end = m_tagNamesByLocalUid.constEnd();
+         it != end; ++it)
+    {
+        const QString & tagName = it.value();
+
+        bool tagMatches = matches(tagName);
+        if (!tagMatches && matchWords) {
+            const auto words = tokenizeNoteSearchIndexText(tagName);
+            tagMatches = std::any_of(words.begin(), words.end(), matches);
+        }
+
+        if (!tagMatches) {
+            continue;
+        }
+
+        auto noteIt = m_noteLocalUidsByTagLocalUid.constFind(it.key());
+        if (noteIt != m_noteLocalUidsByTagLocalUid.constEnd()) {
+            noteLocalUids.unite(noteIt.value());
+        }
+    }
+}
+
+bool NoteSearchIndex::restoreFromSnapshot(ModelSnapshot & snapshot)
+{
+    QNDEBUG("model:note_search_index", "NoteSearchIndex::restoreFromSnapshot");
+
+    if (snapshot.isEmpty()) {
+        return false;
+    }
+
+    auto & stream = snapshot.stream();
+
+    quint32 version = 0;
+    stream >> version;
+
+    if ((stream.status() != QDataStream::Ok) ||
+        (version != NOTE_SEARCH_INDEX_SNAPSHOT_VERSION))
+    {
+        QNWARNING(
+            "model:note_search_index",
+            "Unsupported note search index snapshot, version = " << version);
+        return false;
+    }
+
+    quint32 tagCount = 0;
+    stream >> tagCount;
+
+    QHash<QString, QString> tagNamesByLocalUid;
+    for (quint32 i = 0;
+         (i < tagCount) && (stream.status() == QDataStream::Ok); ++i)
+    {
+        QString localUid;
+        QString name;
+        stream >> localUid >> name;
+        tagNamesByLocalUid[localUid] = name;
+    }
+
+    quint32 noteCount = 0;
+    stream >> noteCount;
+
+    QHash<QString, NoteEntry> notes;
+    notes.reserve(static_cast<int>(std::min<quint32>(noteCount, 65536)));
+
+    for (quint32 i = 0;
+         (i < noteCount) && (stream.status() == QDataStream::Ok); ++i)
+    {
+        QString localUid;
+        NoteEntry entry;
+        stream >> localUid >> entry.m_notebookLocalUid >> entry.m_titleTokens >>
+            entry.m_textTokens >> entry.m_tagLocalUids >>
+            entry.m_hasRecognitionData;
+        notes[localUid] = std::move(entry);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        QNWARNING(
+            "model:note_search_index",
+            "Note search index snapshot is corrupted, ignoring it");
+        return false;
+    }
+
+    m_tagNamesByLocalUid = std::move(tagNamesByLocalUid);
+    for (auto it = notes.begin(), end = notes.end(); it != end; ++it) {
+        insertNoteEntry(it.key(), std::move(it.value()));
+    }
+
+    QNDEBUG(
+        "model:note_search_index",
+        "Restored note search index of " << m_notes.size() << " notes");
+
+    return true;
+}
+
+void NoteSearchIndex::addPostings(
+    Postings & postings, const QStringList & tokens,
+    const QString & noteLocalUid)
+{
+    for (const auto & token: qAsConst(tokens)) {
+        Q_UNUSED(postings[token].insert(noteLocalUid))
+    }
+}
+
+void NoteSearchIndex::removePostings(
+    Postings & postings, const QStringList & tokens,
+    const QString & noteLocalUid)
+{
+    for (const auto & token: qAsConst(tokens)) {
+        auto it = postings.find(token);
+        if (it == postings.end()) {
+            continue;
+        }
+
+        Q_UNUSED(it.value().remove(noteLocalUid))
+        if (it.value().isEmpty()) {
+            Q_UNUSED(postings.erase(it))
+        }
+    }
+}
+
+void NoteSearchIndex::collectPostings(
+    const Postings & postings, const QString & token, const bool isPrefix,
+    QSet<QString> & noteLocalUids)
+{
+    if (!isPrefix) {
+        auto it = postings.constFind(token);
+        if (it != postings.constEnd()) {
+            noteLocalUids.unite(it.value());
+        }
+
+        return;
+    }
+
+    for (auto it = postings.lowerBound(token), end = postings.constEnd();
+         (it != end) && it.key().startsWith(token); ++it)
+    {
+        noteLocalUids.unite(it.value());
+    }
+}
+
+} // namespace quentier
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_MODEL_NOTE_NOTE_SEARCH_INDEX_H
+#define QUENTIER_LIB_MODEL_NOTE_NOTE_SEARCH_INDEX_H
+
+#include "NoteSearchIndexTokenizer.h"
+
+#include <lib/model/common/ModelSnapshot.h>
+
+#include <quentier/local_storage/LocalStorageManagerAsync.h>
+#include <quentier/types/Account.h>
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QUuid>
+#include <QVector>
+
+#define NOTE_SEARCH_INDEX_LIST_LIMIT (100)
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageRequestScheduler)
+
+/**
+ * @brief The NoteSearchIndex class is the in-memory inverted index over
+ * the words of notes' titles and texts and over the names of notes' tags
+ * allowing to answer simple note search queries without querying the local
+ * storage
+ *
+ * The index is built in the background by listing tags and notes from
+ * the local storage page by page, the listed notes are tokenized on the thread
+ * pool, see NoteSearchIndexTokenizer. The index is then kept up to date by
+ * listening to
+ * the local storage's notifications about note and tag changes. It can be
+ * restored from the snapshot saved while the local storage was closed in
+ * which case no listing is needed as long as the snapshot is up to date.
+ *
+ * Only the queries consisting of plain words, "intitle:" and "tag:" terms,
+ * each optionally ending with the "*" wildcard, are answered by the index;
+ * everything else, for example negations, "any:" or other modifiers and
+ * quoted phrases, still needs to go through the local storage. Plain words
+ * are matched against notes' titles, texts and words of tags' names. The text
+ * recognized in resources is not indexed so plain words also go through
+ * the local storage as long as there are notes with recognition data.
+ *
+ * NOTE: the index should be created before the objects which use it from
+ * within their own handlers of local storage's note notifications so that
+ * the index is updated by the time those handlers run.
+ */
+class NoteSearchIndex final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NoteSearchIndex(
+        const Account & account,
+        LocalStorageManagerAsync & localStorageManagerAsync,
+        QObject * parent = nullptr, ModelSnapshot * pSnapshot = nullptr,
+        LocalStorageRequestScheduler * pRequestScheduler = nullptr);
+
+    virtual ~NoteSearchIndex() override;
+
+    const Account & account() const
+    {
+        return m_account;
+    }
+
+    /**
+     * @return      True if the index has been fully built, false otherwise
+     */
+    bool isReady() const
+    {
+        return m_isReady;
+    }
+
+    int noteCount() const
+    {
+        return m_notes.size();
+    }
+
+    /**
+     * @brief findNoteLocalUids method finds the notes matching the given
+     * search string
+     *
+     * @param searchString      Search string to find the notes by
+     * @param noteLocalUids     Local uids of found notes
+     * @return                  True if the index is ready and the search string
+     *                          can be answered by it, false otherwise in which
+     *                          case the search has to be done by the local
+     *                          storage
+     */
+    bool findNoteLocalUids(
+        const QString & searchString, QSet<QString> & noteLocalUids) const;
+
+    bool saveSnapshot(ModelSnapshotWriter & writer) const;
+
+Q_SIGNALS:
+    void ready();
+
+    // Informative signals for local storage
+    void listNotes(
+        LocalStorageManager::ListObjectsOptions flag,
+        LocalStorageManager::GetNoteOptions options, size_t limit,
+        size_t offset, LocalStorageManager::ListNotesOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        QString linkedNotebookGuid, QUuid requestId);
+
+    void listNotesByLocalUids(
+        QStringList noteLocalUids, LocalStorageManager::GetNoteOptions options,
+        LocalStorageManager::ListObjectsOptions flag, size_t limit,
+        size_t offset, LocalStorageManager::ListNotesOrder order,
+        LocalStorageManager::OrderDirection orderDirection, QUuid requestId);
+
+    void listTags(
+        LocalStorageManager::ListObjectsOptions flag, size_t limit,
+        size_t offset, LocalStorageManager::ListTagsOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        QString linkedNotebookGuid, QUuid requestId);
+
+private Q_SLOTS:
+    void onAddNoteComplete(Note note, QUuid requestId);
+
+    void onUpdateNoteComplete(
+        Note note, LocalStorageManager::UpdateNoteOptions options,
+        QUuid requestId);
+
+    void onExpungeNoteComplete(Note note, QUuid requestId);
+
+    void onListNotesComplete(
+        LocalStorageManager::ListObjectsOptions flag,
+        LocalStorageManager::GetNoteOptions options, size_t limit,
+        size_t offset, LocalStorageManager::ListNotesOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        QString linkedNotebookGuid, QList<Note> foundNotes, QUuid requestId);
+
+    void onListNotesFailed(
+        LocalStorageManager::ListObjectsOptions flag,
+        LocalStorageManager::GetNoteOptions options, size_t limit,
+        size_t offset, LocalStorageManager::ListNotesOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        QString linkedNotebookGuid, ErrorString errorDescription,
+        QUuid requestId);
+
+    void onListNotesByLocalUidsComplete(
+        QStringList noteLocalUids, LocalStorageManager::GetNoteOptions options,
+        LocalStorageManager::ListObjectsOptions flag, size_t limit,
+        size_t offset, LocalStorageManager::ListNotesOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        QList<Note> foundNotes, QUuid requestId);
+
+    void onListNotesByLocalUidsFailed(
+        QStringList noteLocalUids, LocalStorageManager::GetNoteOptions options,
+        LocalStorageManager::ListObjectsOptions flag, size_t limit,
+        size_t offset, LocalStorageManager::ListNotesOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        ErrorString errorDescription, QUuid requestId);
+
+    void onExpungeNotebookComplete(Notebook notebook, QUuid requestId);
+
+    void onAddTagComplete(Tag tag, QUuid requestId);
+    void onUpdateTagComplete(Tag tag, QUuid requestId);
+
+    void onExpungeTagComplete(
+        Tag tag, QStringList expungedChildTagLocalUids, QUuid requestId);
+
+    void onListTagsComplete(
+        LocalStorageManager::ListObjectsOptions flag, size_t limit,
+        size_t offset, LocalStorageManager::ListTagsOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        QString linkedNotebookGuid, QList<Tag> foundTags, QUuid requestId);
+
+    void onNotesTokenized(
+        QStringList noteLocalUids, QVector<NoteSearchIndexEntry> entries);
+
+    void onListTagsFailed(
+        LocalStorageManager::ListObjectsOptions flag, size_t limit,
+        size_t offset, LocalStorageManager::ListTagsOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        QString linkedNotebookGuid, ErrorString errorDescription,
+        QUuid requestId);
+
+private:
+    using NoteEntry = NoteSearchIndexEntry;
+
+    struct Term
+    {
+        enum class Scope
+        {
+            Any,
+            Title,
+            Tag
+        };
+
+        Scope m_scope = Scope::Any;
+        QString m_text;
+        bool m_isPrefix = false;
+    };
+
+    static bool parseSearchString(
+        const QString & searchString, QVector<Term> & terms);
+
+    void createConnections();
+
+    void requestTagsList();
+    void requestNotesList();
+    void requestChangedNotes();
+    void tokenizeNotes(QList<Note> notes);
+    void finishBuildingIfPossible();
+
+    void addOrUpdateNote(
+        const Note & note, const bool updateTags = true,
+        const bool updateResources = true);
+    void insertNoteEntry(const QString & localUid, NoteEntry entry);
+    void removeNote(const QString & localUid);
+
+    void setTagName(const QString & tagLocalUid, const QString & name);
+    void removeTag(const QString & tagLocalUid);
+
+    QSet<QString> findNoteLocalUids(const Term & term) const;
+
+    void collectTagPostings(
+        const Term & term, const bool matchWords,
+        QSet<QString> & noteLocalUids) const;
+
+    bool restoreFromSnapshot(ModelSnapshot & snapshot);
+
+    using Postings = QMap<QString, QSet<QString>>;
+
+    static void addPostings(
+        Postings & postings, const QStringList & tokens,
+        const QString & noteLocalUid);
+
+    static void removePostings(
+        Postings & postings, const QStringList & tokens,
+        const QString & noteLocalUid);
+
+    static void collectPostings(
+        const Postings & postings, const QString & token, const bool isPrefix,
+        QSet<QString> & noteLocalUids);
+
+private:
+    Q_DISABLE_COPY(NoteSearchIndex)
+
+private:
+    Account m_account;
+    LocalStorageManagerAsync & m_localStorageManagerAsync;
+    LocalStorageRequestScheduler * m_pRequestScheduler;
+
+    bool m_isReady = false;
+
+    QHash<QString, NoteEntry> m_notes;
+
+    // Sorted by token so that the tokens starting with the given prefix are
+    // adjacent
+    Postings m_noteLocalUidsByTitleToken;
+    Postings m_noteLocalUidsByTextToken;
+
+    // Tag names are stored case folded
+    QHash<QString, QString> m_tagNamesByLocalUid;
+    QHash<QString, QSet<QString>> m_noteLocalUidsByTagLocalUid;
+
+    int m_notesWithRecognitionDataCount = 0;
+
+    size_t m_listTagsOffset = 0;
+    QUuid m_listTagsRequestId;
+
+    size_t m_listNotesOffset = 0;
+    QUuid m_listNotesRequestId;
+    bool m_allNotesListed = false;
+    int m_pendingTokenizersCount = 0;
+
+    // Notes added, updated or expunged while the index was being built;
+    // the listed data might be older than the local storage's one and
+    // notifications about updates carry only the updated parts of notes so
+    // these notes are listed once again after all the others are indexed
+    QSet<QString> m_noteLocalUidsChangedWhileBuilding;
+    QUuid m_listChangedNotesRequestId;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_MODEL_NOTE_NOTE_SEARCH_INDEX_H
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NoteSearchIndexTokenizer.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Compat.h>
+
+#include <QSet>
+
+namespace quentier {
+
+QStringList tokenizeNoteSearchIndexText(const QString & text)
+{
+    QSet<QString> tokens;
+
+    const int length = text.size();
+    int pos = 0;
+    while (pos < length) {
+        if (!text[pos].isLetterOrNumber()) {
+            ++pos;
+            continue;
+        }
+
+        int end = pos;
+        while ((end < length) && text[end].isLetterOrNumber()) {
+            ++end;
+        }
+
+        Q_UNUSED(tokens.insert(text.mid(pos, end - pos).toCaseFolded()))
+        pos = end;
+    }
+
+    return tokens.values();
+}
+
+bool noteHasRecognitionData(const Note & note)
+{
+    if (!note.hasResources()) {
+        return false;
+    }
+
+    const auto resources = note.resources();
+    for (const auto & resource: qAsConst(resources)) {
+        if (resource.hasRecognitionDataHash() ||
+            resource.hasRecognitionDataBody())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+NoteSearchIndexTokenizer::NoteSearchIndexTokenizer(
+    QList<Note> notes, QObject * parent) :
+    QObject(parent),
+    QRunnable(), m_notes(std::move(notes))
+{}
+
+void NoteSearchIndexTokenizer::run()
+{
+    QNDEBUG(
+        "model:note_search_index",
+        "NoteSearchIndexTokenizer::run: notes count = " << m_notes.size());
+
+    QStringList noteLocalUids;
+    noteLocalUids.reserve(m_notes.size());
+
+    QVector<NoteSearchIndexEntry> entries;
+    entries.reserve(m_notes.size());
+
+    for (const auto & note: qAsConst(m_notes)) {
+        NoteSearchIndexEntry entry;
+
+        if (note.hasNotebookLocalUid()) {
+            entry.m_notebookLocalUid = note.notebookLocalUid();
+        }
+
+        if (note.hasTitle()) {
+            entry.m_titleTokens = tokenizeNoteSearchIndexText(note.title());
+        }
+
+        // Conversion of ENML into plain text is the most expensive part of
+        // indexing which is why it is done here rather than in the GUI thread
+        if (note.hasContent()) {
+            entry.m_textTokens = tokenizeNoteSearchIndexText(note.plainText());
+        }
+
+        if (note.hasTagLocalUids()) {
+            entry.m_tagLocalUids = note.tagLocalUids();
+        }
+
+        entry.m_hasRecognitionData = noteHasRecognitionData(note);
+
+        noteLocalUids << note.localUid();
+        entries << std::move(entry);
+    }
+
+    // Notes are not needed anymore and their contents can be large
+    m_notes.clear();
+
+    Q_EMIT finished(noteLocalUids, entries);
+}
+
+} // namespace quentier
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_MODEL_NOTE_NOTE_SEARCH_INDEX_TOKENIZER_H
+#define QUENTIER_LIB_MODEL_NOTE_NOTE_SEARCH_INDEX_TOKENIZER_H
+
+#include <quentier/types/Note.h>
+
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QRunnable>
+#include <QStringList>
+#include <QVector>
+
+namespace quentier {
+
+/**
+ * @brief The NoteSearchIndexEntry struct contains the data of a single note
+ * kept by NoteSearchIndex
+ */
+struct NoteSearchIndexEntry
+{
+    QString m_notebookLocalUid;
+    QStringList m_titleTokens;
+    QStringList m_textTokens;
+    QStringList m_tagLocalUids;
+
+    // The text recognized in note's resources is not indexed
+    bool m_hasRecognitionData = false;
+};
+
+/**
+ * Splits the text into case folded words, each word is listed once
+ */
+QStringList tokenizeNoteSearchIndexText(const QString & text);
+
+/**
+ * @return      True if any of note's resources has recognition data, false
+ *              otherwise. Resources' metadata is enough for the check.
+ */
+bool noteHasRecognitionData(const Note & note);
+
+/**
+ * @brief The NoteSearchIndexTokenizer class converts the listed notes'
+ * contents into plain text and splits notes' titles and texts into words;
+ * it is meant to be run on a thread pool so that the GUI thread only needs
+ * to merge the ready entries into the index
+ */
+class NoteSearchIndexTokenizer final : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    explicit NoteSearchIndexTokenizer(
+        QList<Note> notes, QObject * parent = nullptr);
+
+Q_SIGNALS:
+    void finished(
+        QStringList noteLocalUids, QVector<NoteSearchIndexEntry> entries);
+
+private:
+    virtual void run() override;
+
+private:
+    QList<Note> m_notes;
+};
+
+} // namespace quentier
+
+Q_DECLARE_METATYPE(quentier::NoteSearchIndexEntry)
+Q_DECLARE_METATYPE(QVector<quentier::NoteSearchIndexEntry>)
+
+#endif // QUENTIER_LIB_MODEL_NOTE_NOTE_SEARCH_INDEX_TOKENIZER_H
@@ -21,7 +21,10 @@
 #include "AllNotebooksRootItem.h"
 #include "InvisibleRootItem.h"
 
+#include <lib/model/common/ModelItemMimeData.h>
 #include <lib/model/common/NewItemNameGenerator.hpp>
+#include <lib/model/common/NoteCountAggregator.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
@@ -30,6 +33,9 @@
 #include <QDataStream>
 #include <QMimeData>
 
+#include <algorithm>
+#include <vector>
+
 namespace quentier {
 
 // Limit for the queries to the local storage
@@ -38,6 +44,8 @@ namespace quentier {
 
 #define NUM_NOTEBOOK_MODEL_COLUMNS (8)
 
+#define NOTEBOOK_MODEL_SNAPSHOT_VERSION (1)
+
 #define REPORT_ERROR(error, ...)                                               \
     ErrorString errorDescription(error);                                       \
     QNWARNING("model:notebook", errorDescription << "" __VA_ARGS__);           \
@@ -46,11 +54,48 @@ namespace quentier {
 NotebookModel::NotebookModel(
     const Account & account,
     LocalStorageManagerAsync & localStorageManagerAsync, NotebookCache & cache,
-    QObject * parent) :
+    QObject * parent, ModelSnapshot * pSnapshot,
+    LocalStorageRequestScheduler * pRequestScheduler,
+    NoteCountAggregator * pNoteCountAggregator) :
     AbstractItemModel(account, parent),
-    m_cache(cache)
+    m_localStorageManagerAsync(localStorageManagerAsync),
+    m_pRequestScheduler(pRequestScheduler),
+    m_pNoteCountAggregator(pNoteCountAggregator), m_cache(cache)
 {
-    createConnections(localStorageManagerAsync);
+    if (!m_pNoteCountAggregator) {
+        m_pNoteCountAggregator = new NoteCountAggregator(
+            localStorageManagerAsync, this, pRequestScheduler);
+
+        m_ownsNoteCountAggregator = true;
+
+        QObject::connect(
+            m_pNoteCountAggregator, &NoteCountAggregator::notifyError, this,
+            &NotebookModel::notifyError);
+    }
+
+    QObject::connect(
+        m_pNoteCountAggregator,
+        &NoteCountAggregator::noteCountForNotebookChanged, this,
+        &NotebookModel::onNoteCountForNotebookChanged);
+
+    connectToLocalStorage();
+
+    if (pSnapshot && restoreFromSnapshot(*pSnapshot) &&
+        pSnapshot->isUpToDate())
+    {
+        m_allNotebooksListed = true;
+        m_allLinkedNotebooksListed = true;
+
+        // Note counts from the up to date snapshot are actual so there's
+        // no need to request them
+        const auto & localUidIndex = m_data.get<ByLocalUid>();
+        for (const auto & item: localUidIndex) {
+            m_pNoteCountAggregator->seedNoteCountForNotebook(
+                item.localUid(), item.noteCount());
+        }
+
+        return;
+    }
 
     requestNotebooksList();
     requestLinkedNotebooksList();
@@ -1734,16 +1779,23 @@ QMimeData * NotebookModel::mimeData(const QModelIndexList & indexes) const
         return nullptr;
     }
 
-    QByteArray encodedItem;
-    QDataStream out(&encodedItem, QIODevice::WriteOnly);
-    out << *pItem;
+    const auto * pNotebookItem = pItem->cast<NotebookItem>();
+    if (!pNotebookItem) {
+        return nullptr;
+    }
+
+    // The item is only serialized if it's dragged to another process
+    const NotebookItem notebookItem = *pNotebookItem;
 
-    auto * pMimeData = new QMimeData;
-    pMimeData->setData(
+    return new ModelItemMimeData(
         NOTEBOOK_MODEL_MIME_TYPE,
-        qCompress(encodedItem, NOTEBOOK_MODEL_MIME_DATA_MAX_COMPRESSION));
-
-    return pMimeData;
+        static_cast<qint32>(INotebookModelItem::Type::Notebook),
+        notebookItem.localUid(), notebookItem.guid(), [notebookItem] {
+            QByteArray encodedItem;
+            QDataStream out(&encodedItem, QIODevice::WriteOnly);
+            out << notebookItem;
+            return encodedItem;
+        });
 }
 
 bool NotebookModel::dropMimeData(
@@ -1803,24 +1855,21 @@ bool NotebookModel::dropMimeData(
         return false;
     }
 
-    QByteArray data = qUncompress(pMimeData->data(NOTEBOOK_MODEL_MIME_TYPE));
-    QDataStream in(&data, QIODevice::ReadOnly);
-
-    qint32 type = 0;
-    in >> type;
-
-    if (type != static_cast<qint32>(INotebookModelItem::Type::Notebook)) {
+    QString notebookLocalUid;
+    QString notebookGuid;
+    if (!readModelItemMimeData<NotebookItem>(
+            *pMimeData, NOTEBOOK_MODEL_MIME_TYPE,
+            static_cast<qint32>(INotebookModelItem::Type::Notebook),
+            notebookLocalUid, notebookGuid))
+    {
         QNDEBUG(
             "model:notebook",
-            "Cannot drop items of unsupported types: " << type);
+            "Cannot drop items of unsupported types, can only drop notebooks");
         return false;
     }
 
-    NotebookItem notebookItem;
-    in >> notebookItem;
-
     auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto it = localUidIndex.find(notebookItem.localUid());
+    auto it = localUidIndex.find(notebookLocalUid);
     if (it == localUidIndex.end()) {
         REPORT_ERROR(
             QT_TR_NOOP("Internal error: failed to find the notebook being "
@@ -1828,7 +1877,7 @@ bool NotebookModel::dropMimeData(
         return false;
     }
 
-    notebookItem = *it;
+    NotebookItem notebookItem = *it;
 
     QString parentLinkedNotebookGuid;
 
@@ -1912,7 +1961,7 @@ void NotebookModel::onAddNotebookComplete(Notebook notebook, QUuid requestId)
     }
 
     onNotebookAddedOrUpdated(notebook);
-    requestNoteCountForNotebook(notebook);
+    requestNoteCountForNotebook(notebook.localUid());
 }
 
 void NotebookModel::onAddNotebookFailed(
@@ -1968,16 +2017,20 @@ void NotebookModel::onUpdateNotebookFailed(
 
     Q_UNUSED(m_updateNotebookRequestIds.erase(it))
 
-    requestId = QUuid::createUuid();
+    requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, notebook](const QUuid & id) {
+            Q_EMIT findNotebook(notebook, id);
+        });
+
     Q_UNUSED(m_findNotebookToRestoreFailedUpdateRequestIds.insert(requestId))
 
     QNTRACE(
         "model:notebook",
-        "Emitting the request to find the notebook: "
+        "Scheduled the request to find the notebook: "
             << "local uid = " << notebook.localUid()
             << ", request id = " << requestId);
-
-    Q_EMIT findNotebook(notebook, requestId);
 }
 
 void NotebookModel::onFindNotebookComplete(Notebook notebook, QUuid requestId)
@@ -2076,7 +2129,10 @@ void NotebookModel::onListNotebooksComplete(
 
     for (const auto & notebook: qAsConst(foundNotebooks)) {
         onNotebookAddedOrUpdated(notebook);
-        requestNoteCountForNotebook(notebook);
+        requestNoteCountForNotebook(notebook.localUid());
+
+        Q_UNUSED(m_notebookLocalUidsPendingReconciliation.remove(
+            notebook.localUid()))
     }
 
     m_listNotebooksRequestId = QUuid();
@@ -2091,6 +2147,21 @@ void NotebookModel::onListNotebooksComplete(
         return;
     }
 
+    // Notebooks restored from the snapshot but not listed from the local
+    // storage were expunged after the snapshot was taken
+    if (!m_notebookLocalUidsPendingReconciliation.isEmpty()) {
+        Q_EMIT aboutToRemoveNotebooks();
+
+        for (const auto & localUid:
+             qAsConst(m_notebookLocalUidsPendingReconciliation))
+        {
+            removeItemByLocalUid(localUid);
+        }
+
+        m_notebookLocalUidsPendingReconciliation.clear();
+        Q_EMIT removedNotebooks();
+    }
+
     m_allNotebooksListed = true;
 
     if (m_allLinkedNotebooksListed) {
@@ -2161,173 +2232,37 @@ void NotebookModel::onExpungeNotebookFailed(
     Q_UNUSED(m_expungeNotebookRequestIds.erase(it))
 
     onNotebookAddedOrUpdated(notebook);
-    requestNoteCountForNotebook(notebook);
+    requestNoteCountForNotebook(notebook.localUid());
 }
 
-void NotebookModel::onGetNoteCountPerNotebookComplete(
-    int noteCount, Notebook notebook,
-    LocalStorageManager::NoteCountOptions options, QUuid requestId)
+void NotebookModel::onNoteCountForNotebookChanged(
+    QString notebookLocalUid, int noteCount)
 {
-    Q_UNUSED(options)
-
-    auto it = m_noteCountPerNotebookRequestIds.find(requestId);
-    if (it == m_noteCountPerNotebookRequestIds.end()) {
-        return;
-    }
-
     QNTRACE(
         "model:notebook",
-        "NotebookModel::onGetNoteCountPerNotebookComplete: "
-            << "note count = " << noteCount << ", notebook = " << notebook
-            << "\nRequest id = " << requestId);
-
-    Q_UNUSED(m_noteCountPerNotebookRequestIds.erase(it))
-
-    QString notebookLocalUid = notebook.localUid();
+        "NotebookModel::onNoteCountForNotebookChanged: "
+            << "notebook local uid = " << notebookLocalUid
+            << ", note count = " << noteCount);
 
     auto & localUidIndex = m_data.get<ByLocalUid>();
     auto itemIt = localUidIndex.find(notebookLocalUid);
-    if (Q_UNLIKELY(itemIt == localUidIndex.end())) {
-        QNDEBUG(
+    if (itemIt == localUidIndex.end()) {
+        QNTRACE(
             "model:notebook",
             "Can't find the notebook item by local uid: " << notebookLocalUid);
         return;
     }
 
-    NotebookItem item = *itemIt;
-    item.setNoteCount(noteCount);
-
-    Q_UNUSED(updateNoteCountPerNotebookIndex(item, itemIt))
-}
-
-void NotebookModel::onGetNoteCountPerNotebookFailed(
-    ErrorString errorDescription, Notebook notebook,
-    LocalStorageManager::NoteCountOptions options, QUuid requestId)
-{
-    Q_UNUSED(options)
-
-    auto it = m_noteCountPerNotebookRequestIds.find(requestId);
-    if (it == m_noteCountPerNotebookRequestIds.end()) {
-        return;
-    }
-
-    QNWARNING(
-        "model:notebook",
-        "NotebookModel::onGetNoteCountPerNotebookFailed: "
-            << "error description = " << errorDescription
-            << ", notebook: " << notebook << "\nRequest id = " << requestId);
-
-    Q_UNUSED(m_noteCountPerNotebookRequestIds.erase(it))
-
-    // Not much can be done here - will just attempt ot "remove" the count from
-    // the item
-
-    QString notebookLocalUid = notebook.localUid();
-
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto itemIt = localUidIndex.find(notebookLocalUid);
-    if (Q_UNLIKELY(itemIt == localUidIndex.end())) {
-        QNDEBUG(
-            "model:notebook",
-            "Can't find the notebook item by local uid: " << notebookLocalUid);
+    if (itemIt->noteCount() == noteCount) {
         return;
     }
 
     NotebookItem item = *itemIt;
-    item.setNoteCount(-1);
+    item.setNoteCount(noteCount);
 
     Q_UNUSED(updateNoteCountPerNotebookIndex(item, itemIt))
 }
 
-void NotebookModel::onAddNoteComplete(Note note, QUuid requestId)
-{
-    QNTRACE(
-        "model:notebook",
-        "NotebookModel::onAddNoteComplete: note = " << note << ", request id = "
-                                                    << requestId);
-
-    if (Q_UNLIKELY(note.hasDeletionTimestamp())) {
-        return;
-    }
-
-    if (note.hasNotebookLocalUid()) {
-        bool res = incrementNoteCountForNotebook(note.notebookLocalUid());
-        if (res) {
-            return;
-        }
-    }
-
-    Notebook notebook;
-    if (note.hasNotebookLocalUid()) {
-        notebook.setLocalUid(note.notebookLocalUid());
-    }
-    else if (note.hasNotebookGuid()) {
-        notebook.setGuid(note.notebookGuid());
-    }
-    else {
-        QNDEBUG(
-            "model:notebook",
-            "Added note has no notebook local uid and no "
-                << "notebook guid, re-requesting the note count for all "
-                   "notebooks");
-        requestNoteCountForAllNotebooks();
-        return;
-    }
-
-    requestNoteCountForNotebook(notebook);
-}
-
-void NotebookModel::onNoteMovedToAnotherNotebook(
-    QString noteLocalUid, QString previousNotebookLocalUid,
-    QString newNotebookLocalUid)
-{
-    QNDEBUG(
-        "model:notebook",
-        "NotebookModel::onNoteMovedToAnotherNotebook: "
-            << "note local uid = " << noteLocalUid
-            << ", previous notebook local uid = " << previousNotebookLocalUid
-            << ", new notebook local uid = " << newNotebookLocalUid);
-
-    Q_UNUSED(decrementNoteCountForNotebook(previousNotebookLocalUid))
-    Q_UNUSED(incrementNoteCountForNotebook(newNotebookLocalUid))
-}
-
-void NotebookModel::onExpungeNoteComplete(Note note, QUuid requestId)
-{
-    QNTRACE(
-        "model:notebook",
-        "NotebookModel::onExpungeNoteComplete: note = "
-            << note << "\nRequest id = " << requestId);
-
-    QString notebookLocalUid;
-    if (note.hasNotebookLocalUid()) {
-        notebookLocalUid = note.notebookLocalUid();
-    }
-
-    // NOTE: it's not sufficient to decrement note count for notebook
-    // as this note might have had deletion timestamp set so it did not
-    // actually contribute to the displayed note count for this notebook
-
-    Notebook notebook;
-    if (!notebookLocalUid.isEmpty()) {
-        notebook.setLocalUid(notebookLocalUid);
-    }
-    else if (note.hasNotebookGuid()) {
-        notebook.setGuid(note.notebookGuid());
-    }
-    else {
-        QNDEBUG(
-            "model:notebook",
-            "Expunged note has no notebook local uid and "
-                << "no notebook guid, re-requesting the note count for all "
-                << "notebooks");
-        requestNoteCountForAllNotebooks();
-        return;
-    }
-
-    requestNoteCountForNotebook(notebook);
-}
-
 void NotebookModel::onAddLinkedNotebookComplete(
     LinkedNotebook linkedNotebook, QUuid requestId)
 {
@@ -2443,6 +2378,11 @@ void NotebookModel::onListAllLinkedNotebooksComplete(
          it != end; ++it)
     {
         onLinkedNotebookAddedOrUpdated(*it);
+
+        if (it->hasGuid()) {
+            Q_UNUSED(m_linkedNotebookGuidsPendingReconciliation.remove(
+                it->guid()))
+        }
     }
 
     m_listLinkedNotebooksRequestId = QUuid();
@@ -2461,6 +2401,21 @@ void NotebookModel::onListAllLinkedNotebooksComplete(
         return;
     }
 
+    // Linked notebooks restored from the snapshot but not listed from
+    // the local storage were expunged after the snapshot was taken
+    const auto linkedNotebookGuidsPendingReconciliation =
+        m_linkedNotebookGuidsPendingReconciliation;
+
+    m_linkedNotebookGuidsPendingReconciliation.clear();
+
+    for (const auto & linkedNotebookGuid:
+         qAsConst(linkedNotebookGuidsPendingReconciliation))
+    {
+        LinkedNotebook linkedNotebook;
+        linkedNotebook.setGuid(linkedNotebookGuid);
+        onExpungeLinkedNotebookComplete(linkedNotebook, QUuid());
+    }
+
     m_allLinkedNotebooksListed = true;
 
     if (m_allNotebooksListed) {
@@ -2492,139 +2447,193 @@ void NotebookModel::onListAllLinkedNotebooksFailed(
     Q_EMIT notifyError(errorDescription);
 }
 
-void NotebookModel::createConnections(
-    LocalStorageManagerAsync & localStorageManagerAsync)
+void NotebookModel::connectToLocalStorage()
 {
-    QNTRACE("model:notebook", "NotebookModel::createConnections");
+    QNTRACE("model:notebook", "NotebookModel::connectToLocalStorage");
+
+    if (m_connectedToLocalStorage) {
+        QNTRACE("model:notebook", "Already connected to local storage");
+        return;
+    }
 
     // Local signals to localStorageManagerAsync's slots
     QObject::connect(
-        this, &NotebookModel::addNotebook, &localStorageManagerAsync,
+        this, &NotebookModel::addNotebook, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onAddNotebookRequest);
 
     QObject::connect(
-        this, &NotebookModel::updateNotebook, &localStorageManagerAsync,
+        this, &NotebookModel::updateNotebook, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onUpdateNotebookRequest);
 
     QObject::connect(
-        this, &NotebookModel::findNotebook, &localStorageManagerAsync,
+        this, &NotebookModel::findNotebook, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onFindNotebookRequest);
 
     QObject::connect(
-        this, &NotebookModel::listNotebooks, &localStorageManagerAsync,
+        this, &NotebookModel::listNotebooks, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onListNotebooksRequest);
 
     QObject::connect(
-        this, &NotebookModel::expungeNotebook, &localStorageManagerAsync,
+        this, &NotebookModel::expungeNotebook, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onExpungeNotebookRequest);
 
     QObject::connect(
-        this, &NotebookModel::requestNoteCountPerNotebook,
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::onGetNoteCountPerNotebookRequest);
-
-    QObject::connect(
-        this, &NotebookModel::listAllLinkedNotebooks, &localStorageManagerAsync,
+        this, &NotebookModel::listAllLinkedNotebooks,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onListAllLinkedNotebooksRequest);
 
-    // localStorageManagerAsync's signals to local slots
+    // m_localStorageManagerAsync's signals to local slots
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::addNotebookComplete, this,
         &NotebookModel::onAddNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::addNotebookFailed,
-        this, &NotebookModel::onAddNotebookFailed);
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::addNotebookFailed, this,
+        &NotebookModel::onAddNotebookFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateNotebookComplete, this,
         &NotebookModel::onUpdateNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateNotebookFailed, this,
         &NotebookModel::onUpdateNotebookFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findNotebookComplete, this,
         &NotebookModel::onFindNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findNotebookFailed, this,
         &NotebookModel::onFindNotebookFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listNotebooksComplete, this,
         &NotebookModel::onListNotebooksComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listNotebooksFailed, this,
         &NotebookModel::onListNotebooksFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeNotebookComplete, this,
         &NotebookModel::onExpungeNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeNotebookFailed, this,
         &NotebookModel::onExpungeNotebookFailed);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::addNoteComplete,
-        this, &NotebookModel::onAddNoteComplete);
-
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::noteMovedToAnotherNotebook, this,
-        &NotebookModel::onNoteMovedToAnotherNotebook);
-
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::expungeNoteComplete, this,
-        &NotebookModel::onExpungeNoteComplete);
-
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountPerNotebookComplete, this,
-        &NotebookModel::onGetNoteCountPerNotebookComplete);
-
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountPerNotebookFailed, this,
-        &NotebookModel::onGetNoteCountPerNotebookFailed);
-
-    QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::addLinkedNotebookComplete, this,
         &NotebookModel::onAddLinkedNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateLinkedNotebookComplete, this,
         &NotebookModel::onUpdateLinkedNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeLinkedNotebookComplete, this,
         &NotebookModel::onExpungeLinkedNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listAllLinkedNotebooksComplete, this,
         &NotebookModel::onListAllLinkedNotebooksComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listAllLinkedNotebooksFailed, this,
         &NotebookModel::onListAllLinkedNotebooksFailed);
+
+    if (m_ownsNoteCountAggregator) {
+        m_pNoteCountAggregator->connectToLocalStorage();
+    }
+
+    m_connectedToLocalStorage = true;
+}
+
+void NotebookModel::disconnectFromLocalStorage()
+{
+    QNTRACE("model:notebook", "NotebookModel::disconnectFromLocalStorage");
+
+    if (!m_connectedToLocalStorage) {
+        QNTRACE("model:notebook", "Already disconnected from local storage");
+        return;
+    }
+
+    QObject::disconnect(&m_localStorageManagerAsync);
+    m_localStorageManagerAsync.disconnect(this);
+    m_connectedToLocalStorage = false;
+
+    // Queued requests would go nowhere now
+    if (m_pRequestScheduler) {
+        m_pRequestScheduler->cancelRequests(*this);
+    }
+
+    if (m_ownsNoteCountAggregator) {
+        m_pNoteCountAggregator->disconnectFromLocalStorage();
+    }
+}
+
+bool NotebookModel::saveSnapshot(ModelSnapshotWriter & writer) const
+{
+    QNDEBUG("model:notebook", "NotebookModel::saveSnapshot");
+
+    if (!m_allNotebooksListed || !m_allLinkedNotebooksListed ||
+        !m_notebookItemsNotYetInLocalStorageUids.isEmpty() ||
+        !m_addNotebookRequestIds.isEmpty() ||
+        !m_updateNotebookRequestIds.isEmpty() ||
+        !m_expungeNotebookRequestIds.isEmpty() ||
+        !m_findNotebookToRestoreFailedUpdateRequestIds.isEmpty() ||
+        !m_findNotebookToPerformUpdateRequestIds.isEmpty() ||
+        m_pNoteCountAggregator->hasPendingNotebookNoteCountRequests())
+    {
+        QNDEBUG(
+            "model:notebook",
+            "Notebook model is not in sync with local storage, won't save "
+                << "its snapshot");
+        return false;
+    }
+
+    auto & stream = writer.stream();
+
+    stream << quint32(NOTEBOOK_MODEL_SNAPSHOT_VERSION)
+           << quint32(m_linkedNotebookUsernamesByGuids.size());
+
+    for (auto it = m_linkedNotebookUsernamesByGuids.constBegin(),
+              end = m_linkedNotebookUsernamesByGuids.constEnd();
+         it != end; ++it)
+    {
+        stream << it.key() << it.value();
+    }
+
+    const auto & localUidIndex = m_data.get<ByLocalUid>();
+    stream << quint32(localUidIndex.size());
+
+    for (const auto & item: localUidIndex) {
+        stream << item.localUid() << item.guid() << item.linkedNotebookGuid()
+               << item.name() << item.stack() << item.isSynchronizable()
+               << item.isUpdatable() << item.nameIsUpdatable()
+               << item.isDirty() << item.isDefault() << item.isLastUsed()
+               << item.isPublished() << item.isFavorited()
+               << item.canCreateNotes() << item.canUpdateNotes()
+               << qint32(item.noteCount());
+    }
+
+    return stream.status() == QDataStream::Ok;
 }
 
 void NotebookModel::requestNotebooksList()
@@ -2639,48 +2648,45 @@ void NotebookModel::requestNotebooksList()
 
     auto order = LocalStorageManager::ListNotebooksOrder::NoOrder;
     auto direction = LocalStorageManager::OrderDirection::Ascending;
-    m_listNotebooksRequestId = QUuid::createUuid();
+    const size_t offset = m_listNotebooksOffset;
+
+    // Favorites model lists all notebooks in the same way
+    m_listNotebooksRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::VisibleView,
+        [this, flags, offset, order, direction](const QUuid & id) {
+            Q_EMIT listNotebooks(
+                flags, NOTEBOOK_LIST_LIMIT, offset, order, direction, {}, id);
+        },
+        localStorageRequestKey(
+            "listNotebooks", flags, NOTEBOOK_LIST_LIMIT, offset, order,
+            direction, QString()));
 
     QNTRACE(
         "model:notebook",
-        "Emitting the request to list notebooks: "
+        "Scheduled the request to list notebooks: "
             << "offset = " << m_listNotebooksOffset
             << ", request id = " << m_listNotebooksRequestId);
-
-    Q_EMIT listNotebooks(
-        flags, NOTEBOOK_LIST_LIMIT, m_listNotebooksOffset, order, direction, {},
-        m_listNotebooksRequestId);
 }
 
-void NotebookModel::requestNoteCountForNotebook(const Notebook & notebook)
+void NotebookModel::requestNoteCountForNotebook(
+    const QString & notebookLocalUid)
 {
     QNTRACE(
         "model:notebook",
-        "NotebookModel::requestNoteCountForNotebook: " << notebook);
-
-    QUuid requestId = QUuid::createUuid();
-    Q_UNUSED(m_noteCountPerNotebookRequestIds.insert(requestId))
-    QNTRACE(
-        "model:notebook",
-        "Emitting request to get the note count per "
-            << "notebook: request id = " << requestId);
-
-    LocalStorageManager::NoteCountOptions options(
-        LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes);
-
-    Q_EMIT requestNoteCountPerNotebook(notebook, options, requestId);
-}
+        "NotebookModel::requestNoteCountForNotebook: " << notebookLocalUid);
 
-void NotebookModel::requestNoteCountForAllNotebooks()
-{
-    QNTRACE("model:notebook", "NotebookModel::requestNoteCountForAllNotebooks");
+    // The note count might be already known to the aggregator if some other
+    // model has asked for it before
+    const int noteCount =
+        m_pNoteCountAggregator->noteCountForNotebook(notebookLocalUid);
 
-    const auto & localUidIndex = m_data.get<ByLocalUid>();
-    for (const auto & item: localUidIndex) {
-        Notebook notebook;
-        notebook.setLocalUid(item.localUid());
-        requestNoteCountForNotebook(notebook);
+    if (noteCount >= 0) {
+        onNoteCountForNotebookChanged(notebookLocalUid, noteCount);
+        return;
     }
+
+    m_pNoteCountAggregator->requestNoteCountForNotebook(notebookLocalUid);
 }
 
 void NotebookModel::requestLinkedNotebooksList()
@@ -2692,17 +2698,163 @@ void NotebookModel::requestLinkedNotebooksList()
 
     auto order = LocalStorageManager::ListLinkedNotebooksOrder::NoOrder;
     auto direction = LocalStorageManager::OrderDirection::Ascending;
-    m_listLinkedNotebooksRequestId = QUuid::createUuid();
+    const size_t offset = m_listLinkedNotebooksOffset;
+
+    // Tag model lists linked notebooks in the same way
+    m_listLinkedNotebooksRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::VisibleView,
+        [this, offset, order, direction](const QUuid & id) {
+            Q_EMIT listAllLinkedNotebooks(
+                LINKED_NOTEBOOK_LIST_LIMIT, offset, order, direction, id);
+        },
+        localStorageRequestKey(
+            "listAllLinkedNotebooks", LINKED_NOTEBOOK_LIST_LIMIT, offset, order,
+            direction));
 
     QNTRACE(
         "model:notebook",
-        "Emitting the request to list linked notebooks: "
+        "Scheduled the request to list linked notebooks: "
             << "offset = " << m_listLinkedNotebooksOffset
             << ", request id = " << m_listLinkedNotebooksRequestId);
+}
+
+bool NotebookModel::restoreFromSnapshot(ModelSnapshot & snapshot)
+{
+    QNDEBUG("model:notebook", "NotebookModel::restoreFromSnapshot");
+
+    if (snapshot.isEmpty()) {
+        return false;
+    }
+
+    auto & stream = snapshot.stream();
+
+    quint32 version = 0;
+    stream >> version;
+
+    if ((stream.status() != QDataStream::Ok) ||
+        (version != NOTEBOOK_MODEL_SNAPSHOT_VERSION))
+    {
+        QNWARNING(
+            "model:notebook",
+            "Unsupported notebook model snapshot, version = " << version);
+        return false;
+    }
+
+    // Reading everything before adding anything to the model so that
+    // the corrupted snapshot doesn't leave the model half populated
+    quint32 linkedNotebookCount = 0;
+    stream >> linkedNotebookCount;
+
+    QList<LinkedNotebook> linkedNotebooks;
+    for (quint32 i = 0;
+         (i < linkedNotebookCount) && (stream.status() == QDataStream::Ok); ++i)
+    {
+        QString guid;
+        QString username;
+        stream >> guid >> username;
+
+        LinkedNotebook linkedNotebook;
+        linkedNotebook.setGuid(guid);
+        linkedNotebook.setUsername(username);
+        linkedNotebooks << linkedNotebook;
+    }
+
+    quint32 notebookCount = 0;
+    stream >> notebookCount;
+
+    std::vector<NotebookItem> items;
+    items.reserve(std::min<quint32>(notebookCount, 1024));
+
+    for (quint32 i = 0;
+         (i < notebookCount) && (stream.status() == QDataStream::Ok); ++i)
+    {
+        QString localUid;
+        QString guid;
+        QString linkedNotebookGuid;
+        QString name;
+        QString stack;
+        bool isSynchronizable = false;
+        bool isUpdatable = false;
+        bool nameIsUpdatable = false;
+        bool isDirty = false;
+        bool isDefault = false;
+        bool isLastUsed = false;
+        bool isPublished = false;
+        bool isFavorited = false;
+        bool canCreateNotes = false;
+        bool canUpdateNotes = false;
+        qint32 noteCount = 0;
+
+        stream >> localUid >> guid >> linkedNotebookGuid >> name >> stack >>
+            isSynchronizable >> isUpdatable >> nameIsUpdatable >> isDirty >>
+            isDefault >> isLastUsed >> isPublished >> isFavorited >>
+            canCreateNotes >> canUpdateNotes >> noteCount;
+
+        NotebookItem item;
+        item.setLocalUid(std::move(localUid));
+        item.setGuid(std::move(guid));
+        item.setLinkedNotebookGuid(std::move(linkedNotebookGuid));
+        item.setName(std::move(name));
+        item.setStack(std::move(stack));
+        item.setSynchronizable(isSynchronizable);
+        item.setUpdatable(isUpdatable);
+        item.setNameIsUpdatable(nameIsUpdatable);
+        item.setDirty(isDirty);
+        item.setDefault(isDefault);
+        item.setLastUsed(isLastUsed);
+        item.setPublished(isPublished);
+        item.setFavorited(isFavorited);
+        item.setCanCreateNotes(canCreateNotes);
+        item.setCanUpdateNotes(canUpdateNotes);
+        item.setNoteCount(noteCount);
+        items.push_back(std::move(item));
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        QNWARNING("model:notebook", "Failed to read notebook model snapshot");
+        return false;
+    }
+
+    for (const auto & linkedNotebook: qAsConst(linkedNotebooks)) {
+        onLinkedNotebookAddedOrUpdated(linkedNotebook);
+
+        if (!snapshot.isUpToDate()) {
+            m_linkedNotebookGuidsPendingReconciliation.insert(
+                linkedNotebook.guid());
+        }
+    }
+
+    // NOTE: restored notebooks are not put into the cache as items don't
+    // contain all the fields of notebooks stored in the local storage
+    const auto & localUidIndex = m_data.get<ByLocalUid>();
+    for (const auto & item: items) {
+        if (localUidIndex.find(item.localUid()) != localUidIndex.end()) {
+            continue;
+        }
+
+        if (item.isDefault() && m_defaultNotebookLocalUid.isEmpty()) {
+            m_defaultNotebookLocalUid = item.localUid();
+        }
+
+        if (item.isLastUsed() && m_lastUsedNotebookLocalUid.isEmpty()) {
+            m_lastUsedNotebookLocalUid = item.localUid();
+        }
+
+        addNotebookItem(item);
+
+        if (!snapshot.isUpToDate()) {
+            m_notebookLocalUidsPendingReconciliation.insert(item.localUid());
+        }
+    }
 
-    Q_EMIT listAllLinkedNotebooks(
-        LINKED_NOTEBOOK_LIST_LIMIT, m_listLinkedNotebooksOffset, order,
-        direction, m_listLinkedNotebooksRequestId);
+    QNDEBUG(
+        "model:notebook",
+        "Restored " << items.size() << " notebooks and "
+                    << linkedNotebooks.size()
+                    << " linked notebooks from snapshot");
+
+    return true;
 }
 
 QVariant NotebookModel::dataImpl(
@@ -2777,12 +2929,17 @@ void NotebookModel::updateNotebookInLocalStorage(const NotebookItem & item)
 
         const auto * pCachedNotebook = m_cache.get(item.localUid());
         if (Q_UNLIKELY(!pCachedNotebook)) {
-            QUuid requestId = QUuid::createUuid();
-            Q_UNUSED(m_findNotebookToPerformUpdateRequestIds.insert(requestId))
-
             Notebook dummy;
             dummy.setLocalUid(item.localUid());
-            Q_EMIT findNotebook(dummy, requestId);
+
+            QUuid requestId = scheduleLocalStorageRequest(
+                m_pRequestScheduler, *this,
+                LocalStorageRequestScheduler::Priority::Interactive,
+                [this, dummy](const QUuid & id) {
+                    Q_EMIT findNotebook(dummy, id);
+                });
+
+            Q_UNUSED(m_findNotebookToPerformUpdateRequestIds.insert(requestId))
 
             QNTRACE(
                 "model:notebook",
@@ -2835,7 +2992,10 @@ void NotebookModel::updateNotebookInLocalStorage(const NotebookItem & item)
                 << "to the local storage: id = " << requestId
                 << ", notebook = " << notebook);
 
-        Q_EMIT addNotebook(notebook, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT addNotebook(notebook, id);
+            });
 
         Q_UNUSED(
             m_notebookItemsNotYetInLocalStorageUids.erase(notYetSavedItemIt))
@@ -2853,7 +3013,10 @@ void NotebookModel::updateNotebookInLocalStorage(const NotebookItem & item)
                 << "the local storage: id = " << requestId
                 << ", notebook = " << notebook);
 
-        Q_EMIT updateNotebook(notebook, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT updateNotebook(notebook, id);
+            });
     }
 }
 
@@ -2878,7 +3041,10 @@ void NotebookModel::expungeNotebookFromLocalStorage(const QString & localUid)
             << "from the local storage: request id = " << requestId
             << ", local uid = " << localUid);
 
-    Q_EMIT expungeNotebook(dummyNotebook, requestId);
+    sendLocalStorageRequest(
+        m_pRequestScheduler, requestId, [&](const QUuid & id) {
+            Q_EMIT expungeNotebook(dummyNotebook, id);
+        });
 }
 
 QString NotebookModel::nameForNewNotebook() const
@@ -2934,24 +3100,29 @@ void NotebookModel::onNotebookAdded(const Notebook & notebook)
         "NotebookModel::onNotebookAdded: notebook "
             << "local uid = " << notebook.localUid());
 
+    NotebookItem item;
+    notebookToItem(notebook, item);
+    addNotebookItem(item);
+}
+
+void NotebookModel::addNotebookItem(const NotebookItem & item)
+{
     checkAndCreateModelRootItems();
 
     INotebookModelItem * pParentItem = nullptr;
-    if (notebook.hasStack()) {
-        auto stackItemsWithParentPair = stackItemsWithParent(
-            notebook.hasLinkedNotebookGuid() ? notebook.linkedNotebookGuid()
-                                             : QString());
+    if (!item.stack().isEmpty()) {
+        auto stackItemsWithParentPair =
+            stackItemsWithParent(item.linkedNotebookGuid());
 
         auto * pStackItems = stackItemsWithParentPair.first;
         auto * pGrandParentItem = stackItemsWithParentPair.second;
-        const QString & stack = notebook.stack();
 
-        pParentItem =
-            &(findOrCreateStackItem(stack, *pStackItems, pGrandParentItem));
+        pParentItem = &(findOrCreateStackItem(
+            item.stack(), *pStackItems, pGrandParentItem));
     }
-    else if (notebook.hasLinkedNotebookGuid()) {
-        pParentItem = &(
-            findOrCreateLinkedNotebookModelItem(notebook.linkedNotebookGuid()));
+    else if (!item.linkedNotebookGuid().isEmpty()) {
+        pParentItem =
+            &(findOrCreateLinkedNotebookModelItem(item.linkedNotebookGuid()));
     }
     else {
         pParentItem = m_pAllNotebooksRootItem;
@@ -2959,9 +3130,6 @@ void NotebookModel::onNotebookAdded(const Notebook & notebook)
 
     auto parentIndex = indexForItem(pParentItem);
 
-    NotebookItem item;
-    notebookToItem(notebook, item);
-
     int row = pParentItem->childrenCount();
 
     auto & localUidIndex = m_data.get<ByLocalUid>();
@@ -3896,57 +4064,6 @@ void NotebookModel::updatePersistentModelIndices()
     }
 }
 
-bool NotebookModel::incrementNoteCountForNotebook(
-    const QString & notebookLocalUid)
-{
-    QNTRACE(
-        "model:notebook",
-        "NotebookModel::incrementNoteCountForNotebook: " << notebookLocalUid);
-
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto it = localUidIndex.find(notebookLocalUid);
-    if (Q_UNLIKELY(it == localUidIndex.end())) {
-        QNDEBUG(
-            "model:notebook",
-            "Wasn't able to find the notebook item by "
-                << "the specified local uid");
-        return false;
-    }
-
-    NotebookItem item = *it;
-    int noteCount = item.noteCount();
-    ++noteCount;
-    item.setNoteCount(noteCount);
-
-    return updateNoteCountPerNotebookIndex(item, it);
-}
-
-bool NotebookModel::decrementNoteCountForNotebook(
-    const QString & notebookLocalUid)
-{
-    QNTRACE(
-        "model:notebook",
-        "NotebookModel::decrementNoteCountForNotebook: " << notebookLocalUid);
-
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto it = localUidIndex.find(notebookLocalUid);
-    if (Q_UNLIKELY(it == localUidIndex.end())) {
-        QNDEBUG(
-            "model:notebook",
-            "Wasn't able to find the notebook item by "
-                << "the specified local uid");
-        return false;
-    }
-
-    NotebookItem item = *it;
-    int noteCount = item.noteCount();
-    --noteCount;
-    noteCount = std::max(noteCount, 0);
-    item.setNoteCount(noteCount);
-
-    return updateNoteCountPerNotebookIndex(item, it);
-}
-
 void NotebookModel::switchDefaultNotebookLocalUid(const QString & localUid)
 {
     QNTRACE(
@@ -27,6 +27,8 @@
 #include "StackItem.h"
 
 #include <lib/model/common/AbstractItemModel.h>
+#include <lib/model/common/LocalStorageRequestScheduler.h>
+#include <lib/model/common/ModelSnapshot.h>
 
 #include <quentier/local_storage/LocalStorageManagerAsync.h>
 #include <quentier/types/Account.h>
@@ -54,12 +56,12 @@ RESTORE_WARNINGS
 #define NOTEBOOK_MODEL_MIME_TYPE                                               \
     QStringLiteral("application/x-com.quentier.notebookmodeldatalist")
 
-#define NOTEBOOK_MODEL_MIME_DATA_MAX_COMPRESSION (9)
-
 QT_FORWARD_DECLARE_CLASS(QDebug)
 
 namespace quentier {
 
+QT_FORWARD_DECLARE_CLASS(NoteCountAggregator)
+
 class NotebookModel : public AbstractItemModel
 {
     Q_OBJECT
@@ -67,10 +69,38 @@ public:
     explicit NotebookModel(
         const Account & account,
         LocalStorageManagerAsync & localStorageManagerAsync,
-        NotebookCache & cache, QObject * parent = nullptr);
+        NotebookCache & cache, QObject * parent = nullptr,
+        ModelSnapshot * pSnapshot = nullptr,
+        LocalStorageRequestScheduler * pRequestScheduler = nullptr,
+        NoteCountAggregator * pNoteCountAggregator = nullptr);
 
     virtual ~NotebookModel();
 
+    /**
+     * @brief connectToLocalStorage and disconnectFromLocalStorage methods
+     * allow to temporarily detach the model from local storage i.e. when
+     * the model is kept aside for an account which is not active at
+     * the moment; the model is connected to local storage on construction
+     */
+    void connectToLocalStorage();
+    void disconnectFromLocalStorage();
+
+    bool isConnectedToLocalStorage() const
+    {
+        return m_connectedToLocalStorage;
+    }
+
+    /**
+     * @brief saveSnapshot method writes the snapshot of notebook items, linked
+     * notebooks and note counts which can be passed to the model's constructor
+     * on the next startup
+     * @param writer                The writer to write the snapshot to
+     * @return                      True if the snapshot was written, false if
+     *                              the model is not fully loaded yet or waits
+     *                              for responses from the local storage
+     */
+    bool saveSnapshot(ModelSnapshotWriter & writer) const;
+
     const Account & account() const
     {
         return m_account;
@@ -461,10 +491,6 @@ Q_SIGNALS:
 
     void expungeNotebook(Notebook notebook, QUuid requestId);
 
-    void requestNoteCountPerNotebook(
-        Notebook notebook, LocalStorageManager::NoteCountOptions options,
-        QUuid requestId);
-
     void listAllLinkedNotebooks(
         const size_t limit, const size_t offset,
         const LocalStorageManager::ListLinkedNotebooksOrder order,
@@ -507,21 +533,8 @@ private Q_SLOTS:
     void onExpungeNotebookFailed(
         Notebook notebook, ErrorString errorDescription, QUuid requestId);
 
-    void onGetNoteCountPerNotebookComplete(
-        int noteCount, Notebook notebook,
-        LocalStorageManager::NoteCountOptions options, QUuid requestId);
-
-    void onGetNoteCountPerNotebookFailed(
-        ErrorString errorDescription, Notebook notebook,
-        LocalStorageManager::NoteCountOptions options, QUuid requestId);
-
-    void onAddNoteComplete(Note note, QUuid requestId);
-
-    void onNoteMovedToAnotherNotebook(
-        QString noteLocalUid, QString previousNotebookLocalUid,
-        QString newNotebookLocalUid);
-
-    void onExpungeNoteComplete(Note note, QUuid requestId);
+    void onNoteCountForNotebookChanged(
+        QString notebookLocalUid, int noteCount);
 
     void onAddLinkedNotebookComplete(
         LinkedNotebook linkedNotebook, QUuid requestId);
@@ -545,11 +558,10 @@ private Q_SLOTS:
         ErrorString errorDescription, QUuid requestId);
 
 private:
-    void createConnections(LocalStorageManagerAsync & localStorageManagerAsync);
     void requestNotebooksList();
-    void requestNoteCountForNotebook(const Notebook & notebook);
-    void requestNoteCountForAllNotebooks();
+    void requestNoteCountForNotebook(const QString & notebookLocalUid);
     void requestLinkedNotebooksList();
+    bool restoreFromSnapshot(ModelSnapshot & snapshot);
 
     QVariant dataImpl(
         const INotebookModelItem & item, const Column column) const;
@@ -590,14 +602,6 @@ private:
 
     void updatePersistentModelIndices();
 
-    // Returns true if successfully incremented the note count for the notebook
-    // item with the corresponding local uid
-    bool incrementNoteCountForNotebook(const QString & notebookLocalUid);
-
-    // Returns true if successfully decremented the note count for the notebook
-    // item with the corresponding local uid
-    bool decrementNoteCountForNotebook(const QString & notebookLocalUid);
-
     void switchDefaultNotebookLocalUid(const QString & localUid);
     void switchLastUsedNotebookLocalUid(const QString & localUid);
 
@@ -740,6 +744,7 @@ private:
 private:
     void onNotebookAddedOrUpdated(const Notebook & notebook);
     void onNotebookAdded(const Notebook & notebook);
+    void addNotebookItem(const NotebookItem & item);
 
     void onNotebookUpdated(
         const Notebook & notebook, NotebookDataByLocalUid::iterator it);
@@ -835,6 +840,15 @@ private:
     mutable IndexIdToLinkedNotebookGuidBimap m_indexIdToLinkedNotebookGuidBimap;
     mutable IndexId m_lastFreeIndexId = 2;
 
+    LocalStorageManagerAsync & m_localStorageManagerAsync;
+    bool m_connectedToLocalStorage = false;
+
+    LocalStorageRequestScheduler * m_pRequestScheduler;
+
+    // Either shared with other models or owned by this model
+    NoteCountAggregator * m_pNoteCountAggregator;
+    bool m_ownsNoteCountAggregator = false;
+
     NotebookCache & m_cache;
 
     size_t m_listNotebooksOffset = 0;
@@ -848,8 +862,6 @@ private:
     QSet<QUuid> m_findNotebookToRestoreFailedUpdateRequestIds;
     QSet<QUuid> m_findNotebookToPerformUpdateRequestIds;
 
-    QSet<QUuid> m_noteCountPerNotebookRequestIds;
-
     QHash<QString, QString> m_linkedNotebookUsernamesByGuids;
 
     size_t m_listLinkedNotebooksOffset = 0;
@@ -862,6 +874,12 @@ private:
 
     bool m_allNotebooksListed = false;
     bool m_allLinkedNotebooksListed = false;
+
+    // Local uids of notebooks and guids of linked notebooks restored from
+    // the outdated snapshot which have not been listed from the local storage
+    // yet
+    QSet<QString> m_notebookLocalUidsPendingReconciliation;
+    QSet<QString> m_linkedNotebookGuidsPendingReconciliation;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(NotebookModel::Filters)
@@ -22,6 +22,7 @@
 #include "InvisibleRootItem.h"
 
 #include <lib/model/common/NewItemNameGenerator.hpp>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
@@ -29,12 +30,15 @@
 
 #include <algorithm>
 #include <limits>
+#include <vector>
 
 // Limit for the queries to the local storage
 #define SAVED_SEARCH_LIST_LIMIT (100)
 
 #define NUM_SAVED_SEARCH_MODEL_COLUMNS (4)
 
+#define SAVED_SEARCH_MODEL_SNAPSHOT_VERSION (1)
+
 #define REPORT_ERROR(error, ...)                                               \
     ErrorString errorDescription(error);                                       \
     QNWARNING(                                                                 \
@@ -47,11 +51,21 @@ namespace quentier {
 SavedSearchModel::SavedSearchModel(
     const Account & account,
     LocalStorageManagerAsync & localStorageManagerAsync,
-    SavedSearchCache & cache, QObject * parent) :
+    SavedSearchCache & cache, QObject * parent, ModelSnapshot * pSnapshot,
+    LocalStorageRequestScheduler * pRequestScheduler) :
     AbstractItemModel(account, parent),
-    m_cache(cache)
+    m_localStorageManagerAsync(localStorageManagerAsync),
+    m_pRequestScheduler(pRequestScheduler), m_cache(cache)
 {
-    createConnections(localStorageManagerAsync);
+    connectToLocalStorage();
+
+    if (pSnapshot && restoreFromSnapshot(*pSnapshot) &&
+        pSnapshot->isUpToDate())
+    {
+        m_allSavedSearchesListed = true;
+        return;
+    }
+
     requestSavedSearchesList();
 }
 
@@ -302,6 +316,40 @@ void SavedSearchModel::unfavoriteSavedSearch(const QModelIndex & index)
     setSavedSearchFavorited(index, false);
 }
 
+bool SavedSearchModel::saveSnapshot(ModelSnapshotWriter & writer) const
+{
+    QNDEBUG("model:saved_search", "SavedSearchModel::saveSnapshot");
+
+    if (!m_allSavedSearchesListed ||
+        !m_savedSearchItemsNotYetInLocalStorageUids.isEmpty() ||
+        !m_addSavedSearchRequestIds.isEmpty() ||
+        !m_updateSavedSearchRequestIds.isEmpty() ||
+        !m_expungeSavedSearchRequestIds.isEmpty() ||
+        !m_findSavedSearchToRestoreFailedUpdateRequestIds.isEmpty() ||
+        !m_findSavedSearchToPerformUpdateRequestIds.isEmpty())
+    {
+        QNDEBUG(
+            "model:saved_search",
+            "Saved search model is not in sync with local storage, won't "
+                << "save its snapshot");
+        return false;
+    }
+
+    auto & stream = writer.stream();
+
+    const auto & index = m_data.get<ByIndex>();
+    stream << quint32(SAVED_SEARCH_MODEL_SNAPSHOT_VERSION)
+           << quint32(index.size());
+
+    for (const auto & item: index) {
+        stream << item.localUid() << item.guid() << item.name() << item.query()
+               << item.isSynchronizable() << item.isDirty()
+               << item.isFavorited();
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
 QString SavedSearchModel::localUidForItemName(
     const QString & itemName, const QString & linkedNotebookGuid) const
 {
@@ -897,7 +945,10 @@ bool SavedSearchModel::removeRows(
                 << "the saved search from the local storage: request id = "
                 << requestId << ", saved search local uid: " << it->localUid());
 
-        Q_EMIT expungeSavedSearch(savedSearch, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT expungeSavedSearch(savedSearch, id);
+            });
     }
     Q_UNUSED(index.erase(index.begin() + row, index.begin() + row + count))
     endRemoveRows();
@@ -1087,16 +1138,20 @@ void SavedSearchModel::onUpdateSavedSearchFailed(
 
     Q_UNUSED(m_updateSavedSearchRequestIds.erase(it))
 
-    requestId = QUuid::createUuid();
+    requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, search](const QUuid & id) {
+            Q_EMIT findSavedSearch(search, id);
+        });
+
     Q_UNUSED(m_findSavedSearchToRestoreFailedUpdateRequestIds.insert(requestId))
 
     QNTRACE(
         "model:saved_search",
-        "Emitting the request to find the saved "
+        "Scheduled the request to find the saved "
             << "search: local uid = " << search.localUid()
             << ", request id = " << requestId);
-
-    Q_EMIT findSavedSearch(search, requestId);
 }
 
 void SavedSearchModel::onFindSavedSearchComplete(
@@ -1197,6 +1252,8 @@ void SavedSearchModel::onListSavedSearchesComplete(
 
     for (const auto & foundSearch: qAsConst(foundSearches)) {
         onSavedSearchAddedOrUpdated(foundSearch);
+        Q_UNUSED(
+            m_localUidsPendingReconciliation.remove(foundSearch.localUid()))
     }
 
     m_listSavedSearchesRequestId = QUuid();
@@ -1212,6 +1269,14 @@ void SavedSearchModel::onListSavedSearchesComplete(
         return;
     }
 
+    // Saved searches restored from the snapshot but not listed from the local
+    // storage were expunged after the snapshot was taken
+    for (const auto & localUid: qAsConst(m_localUidsPendingReconciliation)) {
+        removeItemByLocalUid(localUid);
+    }
+
+    m_localUidsPendingReconciliation.clear();
+
     m_allSavedSearchesListed = true;
     Q_EMIT notifyAllSavedSearchesListed();
     Q_EMIT notifyAllItemsListed();
@@ -1253,40 +1318,7 @@ void SavedSearchModel::onExpungeSavedSearchComplete(
         return;
     }
 
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto itemIt = localUidIndex.find(search.localUid());
-    if (Q_UNLIKELY(itemIt == localUidIndex.end())) {
-        QNDEBUG(
-            "model:saved_search",
-            "Expunged saved search was not found "
-                << "within the saved search model items: " << search);
-        return;
-    }
-
-    auto & index = m_data.get<ByIndex>();
-    auto indexIt = m_data.project<ByIndex>(itemIt);
-    if (Q_UNLIKELY(indexIt == index.end())) {
-        ErrorString error(
-            QT_TR_NOOP("Internal error: can't project the local uid index "
-                       "iterator to the random access index iterator within "
-                       "the saved searches model"));
-
-        QNWARNING("model:saved_search", error);
-        Q_EMIT notifyError(error);
-        return;
-    }
-
-    Q_EMIT aboutToRemoveSavedSearches();
-
-    int rowIndex = static_cast<int>(std::distance(index.begin(), indexIt));
-
-    beginRemoveRows(
-        indexForItem(m_pAllSavedSearchesRootItem), rowIndex, rowIndex);
-
-    Q_UNUSED(m_data.erase(indexIt))
-    endRemoveRows();
-
-    Q_EMIT removedSavedSearches();
+    removeItemByLocalUid(search.localUid());
 }
 
 void SavedSearchModel::onExpungeSavedSearchFailed(
@@ -1307,82 +1339,110 @@ void SavedSearchModel::onExpungeSavedSearchFailed(
     onSavedSearchAddedOrUpdated(search);
 }
 
-void SavedSearchModel::createConnections(
-    LocalStorageManagerAsync & localStorageManagerAsync)
+void SavedSearchModel::connectToLocalStorage()
 {
-    QNDEBUG("model:saved_search", "SavedSearchModel::createConnections");
+    QNDEBUG("model:saved_search", "SavedSearchModel::connectToLocalStorage");
+
+    if (m_connectedToLocalStorage) {
+        QNDEBUG("model:saved_search", "Already connected to local storage");
+        return;
+    }
 
     // Local signals to localStorageManagerAsync's slots
     QObject::connect(
-        this, &SavedSearchModel::addSavedSearch, &localStorageManagerAsync,
+        this, &SavedSearchModel::addSavedSearch, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onAddSavedSearchRequest);
 
     QObject::connect(
-        this, &SavedSearchModel::updateSavedSearch, &localStorageManagerAsync,
+        this, &SavedSearchModel::updateSavedSearch, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onUpdateSavedSearchRequest);
 
     QObject::connect(
-        this, &SavedSearchModel::findSavedSearch, &localStorageManagerAsync,
+        this, &SavedSearchModel::findSavedSearch, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onFindSavedSearchRequest);
 
     QObject::connect(
-        this, &SavedSearchModel::listSavedSearches, &localStorageManagerAsync,
+        this, &SavedSearchModel::listSavedSearches, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onListSavedSearchesRequest);
 
     QObject::connect(
-        this, &SavedSearchModel::expungeSavedSearch, &localStorageManagerAsync,
+        this, &SavedSearchModel::expungeSavedSearch,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onExpungeSavedSearchRequest);
 
-    // localStorageManagerAsync's signals to local slots
+    // m_localStorageManagerAsync's signals to local slots
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::addSavedSearchComplete, this,
         &SavedSearchModel::onAddSavedSearchComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::addSavedSearchFailed, this,
         &SavedSearchModel::onAddSavedSearchFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateSavedSearchComplete, this,
         &SavedSearchModel::onUpdateSavedSearchComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateSavedSearchFailed, this,
         &SavedSearchModel::onUpdateSavedSearchFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findSavedSearchComplete, this,
         &SavedSearchModel::onFindSavedSearchComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findSavedSearchFailed, this,
         &SavedSearchModel::onFindSavedSearchFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listSavedSearchesComplete, this,
         &SavedSearchModel::onListSavedSearchesComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listSavedSearchesFailed, this,
         &SavedSearchModel::onListSavedSearchesFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeSavedSearchComplete, this,
         &SavedSearchModel::onExpungeSavedSearchComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeSavedSearchFailed, this,
         &SavedSearchModel::onExpungeSavedSearchFailed);
+
+    m_connectedToLocalStorage = true;
+}
+
+void SavedSearchModel::disconnectFromLocalStorage()
+{
+    QNDEBUG(
+        "model:saved_search", "SavedSearchModel::disconnectFromLocalStorage");
+
+    if (!m_connectedToLocalStorage) {
+        QNDEBUG(
+            "model:saved_search", "Already disconnected from local storage");
+        return;
+    }
+
+    QObject::disconnect(&m_localStorageManagerAsync);
+    m_localStorageManagerAsync.disconnect(this);
+    m_connectedToLocalStorage = false;
+
+    // Queued requests would go nowhere now
+    if (m_pRequestScheduler) {
+        m_pRequestScheduler->cancelRequests(*this);
+    }
 }
 
 void SavedSearchModel::requestSavedSearchesList()
@@ -1401,24 +1461,95 @@ void SavedSearchModel::requestSavedSearchesList()
     LocalStorageManager::OrderDirection direction =
         LocalStorageManager::OrderDirection::Ascending;
 
-    m_listSavedSearchesRequestId = QUuid::createUuid();
+    const size_t offset = m_listSavedSearchesOffset;
+
+    m_listSavedSearchesRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::VisibleView,
+        [this, flags, offset, order, direction](const QUuid & id) {
+            Q_EMIT listSavedSearches(
+                flags, SAVED_SEARCH_LIST_LIMIT, offset, order, direction, id);
+        },
+        localStorageRequestKey(
+            "listSavedSearches", flags, SAVED_SEARCH_LIST_LIMIT, offset, order,
+            direction));
 
     QNTRACE(
         "model:saved_search",
-        "Emitting the request to list saved "
+        "Scheduled the request to list saved "
             << "searches: offset = " << m_listSavedSearchesOffset
             << ", request id = " << m_listSavedSearchesRequestId);
+}
+
+bool SavedSearchModel::restoreFromSnapshot(ModelSnapshot & snapshot)
+{
+    QNDEBUG("model:saved_search", "SavedSearchModel::restoreFromSnapshot");
+
+    if (snapshot.isEmpty()) {
+        return false;
+    }
 
-    Q_EMIT listSavedSearches(
-        flags, SAVED_SEARCH_LIST_LIMIT, m_listSavedSearchesOffset, order,
-        direction, m_listSavedSearchesRequestId);
+    auto & stream = snapshot.stream();
+
+    quint32 version = 0;
+    quint32 itemCount = 0;
+    stream >> version >> itemCount;
+
+    if ((stream.status() != QDataStream::Ok) ||
+        (version != SAVED_SEARCH_MODEL_SNAPSHOT_VERSION))
+    {
+        QNWARNING(
+            "model:saved_search",
+            "Unsupported saved search model snapshot, version = " << version);
+        return false;
+    }
+
+    // Reading all items before adding any of them to the model so that
+    // the corrupted snapshot doesn't leave the model half populated
+    std::vector<SavedSearchItem> items;
+    items.reserve(std::min<quint32>(itemCount, 1024));
+
+    for (quint32 i = 0; i < itemCount; ++i) {
+        QString localUid;
+        QString guid;
+        QString name;
+        QString query;
+        bool isSynchronizable = false;
+        bool isDirty = false;
+        bool isFavorited = false;
+
+        stream >> localUid >> guid >> name >> query >> isSynchronizable >>
+            isDirty >> isFavorited;
+
+        if (stream.status() != QDataStream::Ok) {
+            QNWARNING(
+                "model:saved_search",
+                "Failed to read saved search model snapshot");
+            return false;
+        }
+
+        items.emplace_back(
+            std::move(localUid), std::move(guid), std::move(name),
+            std::move(query), isSynchronizable, isDirty, isFavorited);
+    }
+
+    for (const auto & item: items) {
+        onSavedSearchItemAddedOrUpdated(item);
+
+        if (!snapshot.isUpToDate()) {
+            m_localUidsPendingReconciliation.insert(item.localUid());
+        }
+    }
+
+    QNDEBUG(
+        "model:saved_search",
+        "Restored " << items.size() << " saved searches from snapshot");
+
+    return true;
 }
 
 void SavedSearchModel::onSavedSearchAddedOrUpdated(const SavedSearch & search)
 {
-    auto & rowIndex = m_data.get<ByIndex>();
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-
     m_cache.put(search.localUid(), search);
 
     SavedSearchItem item(search.localUid());
@@ -1439,7 +1570,16 @@ void SavedSearchModel::onSavedSearchAddedOrUpdated(const SavedSearch & search)
     item.setDirty(search.isDirty());
     item.setFavorited(search.isFavorited());
 
-    auto itemIt = localUidIndex.find(search.localUid());
+    onSavedSearchItemAddedOrUpdated(item);
+}
+
+void SavedSearchModel::onSavedSearchItemAddedOrUpdated(
+    const SavedSearchItem & item)
+{
+    auto & rowIndex = m_data.get<ByIndex>();
+    auto & localUidIndex = m_data.get<ByLocalUid>();
+
+    auto itemIt = localUidIndex.find(item.localUid());
     if (itemIt == localUidIndex.end()) {
         checkAndCreateModelRootItems();
         Q_EMIT aboutToAddSavedSearch();
@@ -1454,13 +1594,13 @@ void SavedSearchModel::onSavedSearchAddedOrUpdated(const SavedSearch & search)
 
         updateRandomAccessIndexWithRespectToSorting(*itemIt);
 
-        auto addedSavedSearchIndex = indexForLocalUid(search.localUid());
+        auto addedSavedSearchIndex = indexForLocalUid(item.localUid());
         Q_EMIT addedSavedSearch(addedSavedSearchIndex);
 
         return;
     }
 
-    auto savedSearchIndexBefore = indexForLocalUid(search.localUid());
+    auto savedSearchIndexBefore = indexForLocalUid(item.localUid());
     Q_EMIT aboutToUpdateSavedSearch(savedSearchIndexBefore);
 
     localUidIndex.replace(itemIt, item);
@@ -1500,10 +1640,51 @@ void SavedSearchModel::onSavedSearchAddedOrUpdated(const SavedSearch & search)
 
     updateRandomAccessIndexWithRespectToSorting(item);
 
-    QModelIndex savedSearchIndexAfter = indexForLocalUid(search.localUid());
+    QModelIndex savedSearchIndexAfter = indexForLocalUid(item.localUid());
     Q_EMIT updatedSavedSearch(savedSearchIndexAfter);
 }
 
+void SavedSearchModel::removeItemByLocalUid(const QString & localUid)
+{
+    QNTRACE(
+        "model:saved_search",
+        "SavedSearchModel::removeItemByLocalUid: " << localUid);
+
+    auto & localUidIndex = m_data.get<ByLocalUid>();
+    auto itemIt = localUidIndex.find(localUid);
+    if (Q_UNLIKELY(itemIt == localUidIndex.end())) {
+        QNDEBUG(
+            "model:saved_search",
+            "Saved search to remove was not found within the model items");
+        return;
+    }
+
+    auto & index = m_data.get<ByIndex>();
+    auto indexIt = m_data.project<ByIndex>(itemIt);
+    if (Q_UNLIKELY(indexIt == index.end())) {
+        ErrorString error(
+            QT_TR_NOOP("Internal error: can't project the local uid index "
+                       "iterator to the random access index iterator within "
+                       "the saved searches model"));
+
+        QNWARNING("model:saved_search", error);
+        Q_EMIT notifyError(error);
+        return;
+    }
+
+    Q_EMIT aboutToRemoveSavedSearches();
+
+    int rowIndex = static_cast<int>(std::distance(index.begin(), indexIt));
+
+    beginRemoveRows(
+        indexForItem(m_pAllSavedSearchesRootItem), rowIndex, rowIndex);
+
+    Q_UNUSED(m_data.erase(indexIt))
+    endRemoveRows();
+
+    Q_EMIT removedSavedSearches();
+}
+
 QVariant SavedSearchModel::dataImpl(const int row, const Column column) const
 {
     QNTRACE(
@@ -1690,18 +1871,22 @@ void SavedSearchModel::updateSavedSearchInLocalStorage(
 
         const auto * pCachedSearch = m_cache.get(item.localUid());
         if (Q_UNLIKELY(!pCachedSearch)) {
-            auto requestId = QUuid::createUuid();
-            Q_UNUSED(
-                m_findSavedSearchToPerformUpdateRequestIds.insert(requestId))
-
             SavedSearch dummy;
             dummy.setLocalUid(item.localUid());
 
-            Q_EMIT findSavedSearch(dummy, requestId);
+            auto requestId = scheduleLocalStorageRequest(
+                m_pRequestScheduler, *this,
+                LocalStorageRequestScheduler::Priority::Interactive,
+                [this, dummy](const QUuid & id) {
+                    Q_EMIT findSavedSearch(dummy, id);
+                });
+
+            Q_UNUSED(
+                m_findSavedSearchToPerformUpdateRequestIds.insert(requestId))
 
             QNDEBUG(
                 "model:saved_search",
-                "Emitted the request to find the saved search: local uid = "
+                "Scheduled the request to find the saved search: local uid = "
                     << item.localUid() << ", request id = " << requestId);
             return;
         }
@@ -1721,7 +1906,10 @@ void SavedSearchModel::updateSavedSearchInLocalStorage(
 
     if (notYetSavedItemIt != m_savedSearchItemsNotYetInLocalStorageUids.end()) {
         Q_UNUSED(m_addSavedSearchRequestIds.insert(requestId));
-        Q_EMIT addSavedSearch(savedSearch, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT addSavedSearch(savedSearch, id);
+            });
 
         QNTRACE(
             "model:saved_search",
@@ -1738,7 +1926,10 @@ void SavedSearchModel::updateSavedSearchInLocalStorage(
         // remove its stale copy from the cache
         Q_UNUSED(m_cache.remove(savedSearch.localUid()))
 
-        Q_EMIT updateSavedSearch(savedSearch, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT updateSavedSearch(savedSearch, id);
+            });
 
         QNTRACE(
             "model:saved_search",
@@ -25,6 +25,8 @@
 #include "SavedSearchItem.h"
 
 #include <lib/model/common/AbstractItemModel.h>
+#include <lib/model/common/LocalStorageRequestScheduler.h>
+#include <lib/model/common/ModelSnapshot.h>
 
 #include <quentier/local_storage/LocalStorageManagerAsync.h>
 #include <quentier/types/Account.h>
@@ -50,10 +52,36 @@ public:
     explicit SavedSearchModel(
         const Account & account,
         LocalStorageManagerAsync & localStorageManagerAsync,
-        SavedSearchCache & cache, QObject * parent = nullptr);
+        SavedSearchCache & cache, QObject * parent = nullptr,
+        ModelSnapshot * pSnapshot = nullptr,
+        LocalStorageRequestScheduler * pRequestScheduler = nullptr);
 
     virtual ~SavedSearchModel() override;
 
+    /**
+     * @brief connectToLocalStorage and disconnectFromLocalStorage methods
+     * allow to temporarily detach the model from local storage i.e. when
+     * the model is kept aside for an account which is not active at
+     * the moment; the model is connected to local storage on construction
+     */
+    void connectToLocalStorage();
+    void disconnectFromLocalStorage();
+
+    bool isConnectedToLocalStorage() const
+    {
+        return m_connectedToLocalStorage;
+    }
+
+    /**
+     * @brief saveSnapshot method writes the snapshot of saved search items
+     * which can be passed to the model's constructor on the next startup
+     * @param writer                The writer to write the snapshot to
+     * @return                      True if the snapshot was written, false if
+     *                              the model is not fully loaded yet or waits
+     *                              for responses from the local storage
+     */
+    bool saveSnapshot(ModelSnapshotWriter & writer) const;
+
     enum class Column
     {
         Name = 0,
@@ -296,10 +324,13 @@ private Q_SLOTS:
         SavedSearch search, ErrorString errorDescription, QUuid requestId);
 
 private:
-    void createConnections(LocalStorageManagerAsync & localStorageManagerAsync);
     void requestSavedSearchesList();
 
+    bool restoreFromSnapshot(ModelSnapshot & snapshot);
+
     void onSavedSearchAddedOrUpdated(const SavedSearch & search);
+    void onSavedSearchItemAddedOrUpdated(const SavedSearchItem & item);
+    void removeItemByLocalUid(const QString & localUid);
 
     QVariant dataImpl(const int row, const Column column) const;
 
@@ -380,6 +411,11 @@ private:
     QUuid m_listSavedSearchesRequestId;
     QSet<QUuid> m_savedSearchItemsNotYetInLocalStorageUids;
 
+    LocalStorageManagerAsync & m_localStorageManagerAsync;
+    bool m_connectedToLocalStorage = false;
+
+    LocalStorageRequestScheduler * m_pRequestScheduler;
+
     SavedSearchCache & m_cache;
 
     QSet<QUuid> m_addSavedSearchRequestIds;
@@ -395,6 +431,10 @@ private:
     mutable int m_lastNewSavedSearchNameCounter = 0;
 
     bool m_allSavedSearchesListed = false;
+
+    // Local uids of items restored from the outdated snapshot which have not
+    // been listed from the local storage yet
+    QSet<QString> m_localUidsPendingReconciliation;
 };
 
 } // namespace quentier
@@ -21,7 +21,10 @@
 #include "AllTagsRootItem.h"
 #include "InvisibleRootItem.h"
 
+#include <lib/model/common/ModelItemMimeData.h>
 #include <lib/model/common/NewItemNameGenerator.hpp>
+#include <lib/model/common/NoteCountAggregator.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
@@ -41,6 +44,8 @@
 
 #define NUM_TAG_MODEL_COLUMNS (5)
 
+#define TAG_MODEL_SNAPSHOT_VERSION (1)
+
 #define REPORT_ERROR(error, ...)                                               \
     ErrorString errorDescription(error);                                       \
     QNWARNING("model:tag", errorDescription << "" __VA_ARGS__);                \
@@ -56,11 +61,52 @@ namespace quentier {
 TagModel::TagModel(
     const Account & account,
     LocalStorageManagerAsync & localStorageManagerAsync, TagCache & cache,
-    QObject * parent) :
+    QObject * parent, ModelSnapshot * pSnapshot,
+    LocalStorageRequestScheduler * pRequestScheduler,
+    NoteCountAggregator * pNoteCountAggregator) :
     AbstractItemModel(account, parent),
-    m_cache(cache)
+    m_localStorageManagerAsync(localStorageManagerAsync),
+    m_pRequestScheduler(pRequestScheduler),
+    m_pNoteCountAggregator(pNoteCountAggregator), m_cache(cache)
 {
-    createConnections(localStorageManagerAsync);
+    if (!m_pNoteCountAggregator) {
+        m_pNoteCountAggregator = new NoteCountAggregator(
+            localStorageManagerAsync, this, pRequestScheduler);
+
+        m_ownsNoteCountAggregator = true;
+
+        QObject::connect(
+            m_pNoteCountAggregator, &NoteCountAggregator::notifyError, this,
+            &TagModel::notifyError);
+    }
+
+    QObject::connect(
+        m_pNoteCountAggregator, &NoteCountAggregator::noteCountForTagChanged,
+        this, &TagModel::onNoteCountForTagChanged);
+
+    QObject::connect(
+        m_pNoteCountAggregator,
+        &NoteCountAggregator::noteCountsForAllTagsChanged, this,
+        &TagModel::onNoteCountsForAllTagsChanged);
+
+    connectToLocalStorage();
+
+    if (pSnapshot && restoreFromSnapshot(*pSnapshot) &&
+        pSnapshot->isUpToDate())
+    {
+        m_allTagsListed = true;
+        m_allLinkedNotebooksListed = true;
+
+        // Note counts from the up to date snapshot are actual so there's
+        // no need to request them
+        const auto & localUidIndex = m_data.get<ByLocalUid>();
+        for (const auto & item: localUidIndex) {
+            m_pNoteCountAggregator->seedNoteCountForTag(
+                item.localUid(), item.noteCount());
+        }
+
+        return;
+    }
 
     requestTagsList();
     requestLinkedNotebooksList();
@@ -1000,7 +1046,10 @@ bool TagModel::removeRows(int row, int count, const QModelIndex & parent)
 
         QUuid requestId = QUuid::createUuid();
         Q_UNUSED(m_expungeTagRequestIds.insert(requestId))
-        Q_EMIT expungeTag(tag, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT expungeTag(tag, id);
+            });
 
         QNTRACE(
             "model:tag",
@@ -1126,16 +1175,17 @@ QMimeData * TagModel::mimeData(const QModelIndexList & indexes) const
         return nullptr;
     }
 
-    QByteArray encodedItem;
-    QDataStream out(&encodedItem, QIODevice::WriteOnly);
-    out << *pTagItem;
-
-    auto * pMimeData = new QMimeData;
-    pMimeData->setData(
-        TAG_MODEL_MIME_TYPE,
-        qCompress(encodedItem, TAG_MODEL_MIME_DATA_MAX_COMPRESSION));
+    // The item is only serialized if it's dragged to another process
+    const TagItem tagItem = *pTagItem;
 
-    return pMimeData;
+    return new ModelItemMimeData(
+        TAG_MODEL_MIME_TYPE, static_cast<qint32>(ITagModelItem::Type::Tag),
+        tagItem.localUid(), tagItem.guid(), [tagItem] {
+            QByteArray encodedItem;
+            QDataStream out(&encodedItem, QIODevice::WriteOnly);
+            out << tagItem;
+            return encodedItem;
+        });
 }
 
 bool TagModel::dropMimeData(
@@ -1192,22 +1242,19 @@ bool TagModel::dropMimeData(
         return false;
     }
 
-    QByteArray data = qUncompress(pMimeData->data(TAG_MODEL_MIME_TYPE));
-    QDataStream in(&data, QIODevice::ReadOnly);
-
-    qint32 type;
-    in >> type;
-
-    if (type != static_cast<qint32>(ITagModelItem::Type::Tag)) {
+    QString tagLocalUid;
+    QString tagGuid;
+    if (!readModelItemMimeData<TagItem>(
+            *pMimeData, TAG_MODEL_MIME_TYPE,
+            static_cast<qint32>(ITagModelItem::Type::Tag), tagLocalUid,
+            tagGuid))
+    {
         QNDEBUG("model:tag", "Can only drag-drop tag model items of tag type");
         return false;
     }
 
-    TagItem tagItem;
-    in >> tagItem;
-
     auto & localUidIndex = m_data.get<ByLocalUid>();
-    auto it = localUidIndex.find(tagItem.localUid());
+    auto it = localUidIndex.find(tagLocalUid);
     if (it == localUidIndex.end()) {
         REPORT_ERROR(
             QT_TR_NOOP("Internal error: failed to find the notebook being "
@@ -1265,7 +1312,7 @@ bool TagModel::dropMimeData(
         return true;
     }
 
-    tagItem = *pTagItem;
+    TagItem tagItem = *pTagItem;
 
     const auto * pNewParentTagItem = pNewParentItem->cast<TagItem>();
     if (pNewParentTagItem) {
@@ -1321,7 +1368,7 @@ void TagModel::onAddTagComplete(Tag tag, QUuid requestId)
     }
 
     onTagAddedOrUpdated(tag);
-    requestNoteCountForTag(tag);
+    requestNoteCountForTag(tag.localUid());
 }
 
 void TagModel::onAddTagFailed(
@@ -1378,15 +1425,18 @@ void TagModel::onUpdateTagFailed(
             << ", request id = " << requestId);
 
     Q_UNUSED(m_updateTagRequestIds.erase(it))
-    requestId = QUuid::createUuid();
+
+    requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::Interactive,
+        [this, tag](const QUuid & id) { Q_EMIT findTag(tag, id); });
+
     Q_UNUSED(m_findTagToRestoreFailedUpdateRequestIds.insert(requestId))
 
     QNTRACE(
         "model:tag",
-        "Emitting the request to find a tag: local uid = "
+        "Scheduled the request to find a tag: local uid = "
             << tag.localUid() << ", request id = " << requestId);
-
-    Q_EMIT findTag(tag, requestId);
 }
 
 void TagModel::onFindTagComplete(Tag tag, QUuid requestId)
@@ -1516,6 +1566,7 @@ void TagModel::onListTagsComplete(
 
     for (const auto & tag: qAsConst(tags)) {
         onTagAddedOrUpdated(tag);
+        Q_UNUSED(m_tagLocalUidsPendingReconciliation.remove(tag.localUid()))
     }
 
     m_listTagsRequestId = QUuid();
@@ -1530,6 +1581,14 @@ void TagModel::onListTagsComplete(
         return;
     }
 
+    // Tags restored from the snapshot but not listed from the local storage
+    // were expunged after the snapshot was taken
+    for (const auto & localUid: qAsConst(m_tagLocalUidsPendingReconciliation)) {
+        removeItemByLocalUid(localUid);
+    }
+
+    m_tagLocalUidsPendingReconciliation.clear();
+
     m_allTagsListed = true;
     requestNoteCountsPerAllTags();
 
@@ -1605,83 +1664,27 @@ void TagModel::onExpungeTagFailed(
     onTagAddedOrUpdated(tag);
 }
 
-void TagModel::onGetNoteCountPerTagComplete(
-    int noteCount, Tag tag, LocalStorageManager::NoteCountOptions options,
-    QUuid requestId)
+void TagModel::onNoteCountForTagChanged(QString tagLocalUid, int noteCount)
 {
-    Q_UNUSED(options)
-
-    auto it = m_noteCountPerTagRequestIds.find(requestId);
-    if (it == m_noteCountPerTagRequestIds.end()) {
-        return;
-    }
-
     QNTRACE(
         "model:tag",
-        "TagModel::onGetNoteCountPerTagComplete: tag = "
-            << tag << "\nRequest id = " << requestId
-            << ", note count = " << noteCount);
+        "TagModel::onNoteCountForTagChanged: tag local uid = "
+            << tagLocalUid << ", note count = " << noteCount);
 
-    Q_UNUSED(m_noteCountPerTagRequestIds.erase(it))
-    setNoteCountForTag(tag.localUid(), noteCount);
+    setNoteCountForTag(tagLocalUid, noteCount);
 }
 
-void TagModel::onGetNoteCountPerTagFailed(
-    ErrorString errorDescription, Tag tag,
-    LocalStorageManager::NoteCountOptions options, QUuid requestId)
+void TagModel::onNoteCountsForAllTagsChanged()
 {
-    Q_UNUSED(options)
-
-    auto it = m_noteCountPerTagRequestIds.find(requestId);
-    if (it == m_noteCountPerTagRequestIds.end()) {
-        return;
-    }
-
-    QNDEBUG(
-        "model:tag",
-        "TagModel::onGetNoteCountPerTagFailed: "
-            << "error description = " << errorDescription << ", tag = " << tag
-            << ", request id = " << requestId);
-
-    Q_UNUSED(m_noteCountPerTagRequestIds.erase(it))
-
-    ErrorString error(QT_TR_NOOP("Failed to get note count for one of tags"));
-    error.appendBase(errorDescription.base());
-    error.appendBase(errorDescription.additionalBases());
-    error.details() = errorDescription.details();
-    Q_EMIT notifyError(error);
-}
-
-void TagModel::onGetNoteCountsPerAllTagsComplete(
-    QHash<QString, int> noteCountsPerTagLocalUid,
-    LocalStorageManager::NoteCountOptions options, QUuid requestId)
-{
-    Q_UNUSED(options)
-
-    if (requestId != m_noteCountsPerAllTagsRequestId) {
-        return;
-    }
-
-    QNTRACE(
-        "model:tag",
-        "TagModel::onGetNoteCountsPerAllTagsComplete: note "
-            << "counts were received for " << noteCountsPerTagLocalUid.size()
-            << " tag local uids; request id = " << requestId);
-
-    m_noteCountsPerAllTagsRequestId = QUuid();
+    QNTRACE("model:tag", "TagModel::onNoteCountsForAllTagsChanged");
 
     auto & localUidIndex = m_data.get<ByLocalUid>();
     for (auto it = localUidIndex.begin(), end = localUidIndex.end(); it != end;
          ++it)
     {
         TagItem item = *it;
-        auto noteCountIt = noteCountsPerTagLocalUid.find(item.localUid());
-        if (noteCountIt != noteCountsPerTagLocalUid.end()) {
-            item.setNoteCount(noteCountIt.value());
-        }
-        else {
-            item.setNoteCount(0);
-        }
+        item.setNoteCount(
+            m_pNoteCountAggregator->noteCountForTag(item.localUid()));
 
         localUidIndex.replace(it, item);
 
@@ -1716,31 +1719,6 @@ void TagModel::onGetNoteCountsPerAllTagsComplete(
     Q_EMIT dataChanged(startIndex, endIndex);
 }
 
-void TagModel::onGetNoteCountsPerAllTagsFailed(
-    ErrorString errorDescription, LocalStorageManager::NoteCountOptions options,
-    QUuid requestId)
-{
-    Q_UNUSED(options)
-
-    if (requestId != m_noteCountsPerAllTagsRequestId) {
-        return;
-    }
-
-    QNDEBUG(
-        "model:tag",
-        "TagModel::onGetNoteCountsPerAllTagsFailed: error "
-            << "description = " << errorDescription
-            << ", request id = " << requestId);
-
-    m_noteCountsPerAllTagsRequestId = QUuid();
-
-    ErrorString error(QT_TR_NOOP("Failed to get note counts for tags"));
-    error.appendBase(errorDescription.base());
-    error.appendBase(errorDescription.additionalBases());
-    error.details() = errorDescription.details();
-    Q_EMIT notifyError(error);
-}
-
 void TagModel::onExpungeNotelessTagsFromLinkedNotebooksComplete(QUuid requestId)
 {
     QNTRACE(
@@ -1758,19 +1736,21 @@ void TagModel::onExpungeNotelessTagsFromLinkedNotebooksComplete(QUuid requestId)
         // The item's current note count per tag may be invalid due to
         // asynchronous events sequence, need to ask the database if such
         // an item actually exists
-        QUuid requestId = QUuid::createUuid();
-        Q_UNUSED(m_findTagAfterNotelessTagsErasureRequestIds.insert(requestId))
-
         Tag tag;
         tag.setLocalUid(item.localUid());
 
+        QUuid requestId = scheduleLocalStorageRequest(
+            m_pRequestScheduler, *this,
+            LocalStorageRequestScheduler::Priority::Background,
+            [this, tag](const QUuid & id) { Q_EMIT findTag(tag, id); });
+
+        Q_UNUSED(m_findTagAfterNotelessTagsErasureRequestIds.insert(requestId))
+
         QNTRACE(
             "model:tag",
-            "Emitting the request to find tag from linked "
+            "Scheduled the request to find tag from linked "
                 << "notebook to check for its existence: " << item.localUid()
                 << ", request id = " << requestId);
-
-        Q_EMIT findTag(tag, requestId);
     }
 }
 
@@ -1830,9 +1810,8 @@ void TagModel::onExpungeNotebookComplete(Notebook notebook, QUuid requestId)
 
     Q_UNUSED(requestId)
 
-    // Notes from this notebook have been expunged along with it; need to
-    // re-request the number of notes per tag for all tags
-    requestNoteCountsPerAllTags();
+    // Note counts per tag affected by notes expunged along with this notebook
+    // are re-requested by the note count aggregator
 
     if (!notebook.hasLinkedNotebookGuid()) {
         return;
@@ -1854,135 +1833,6 @@ void TagModel::onExpungeNotebookComplete(Notebook notebook, QUuid requestId)
     it->m_canUpdateTags = false;
 }
 
-void TagModel::onAddNoteComplete(Note note, QUuid requestId)
-{
-    QNTRACE(
-        "model:tag",
-        "TagModel::onAddNoteComplete: note = " << note << "\nRequest id = "
-                                               << requestId);
-
-    if (Q_UNLIKELY(note.hasDeletionTimestamp())) {
-        return;
-    }
-
-    if (!note.hasTagLocalUids()) {
-        if (note.hasTagGuids()) {
-            QNDEBUG(
-                "model:tag",
-                "The note has tag guids but not tag local "
-                    << "uids, need to request the proper list of tags from "
-                       "this "
-                    << "note before their note counts can be updated");
-            requestTagsPerNote(note);
-        }
-        else {
-            QNDEBUG(
-                "model:tag",
-                "The note has no tags => no need to update "
-                    << "the note count per any tag");
-        }
-
-        return;
-    }
-
-    const auto & tagLocalUids = note.tagLocalUids();
-    for (const auto & tagLocalUid: qAsConst(tagLocalUids)) {
-        Tag dummy;
-        dummy.setLocalUid(tagLocalUid);
-        requestNoteCountForTag(dummy);
-    }
-}
-
-void TagModel::onNoteTagListChanged(
-    QString noteLocalUid, QStringList previousNoteTagLocalUids,
-    QStringList newNoteTagLocalUids)
-{
-    QNDEBUG(
-        "model:tag",
-        "TagModel::onNoteTagListChanged: note local uid = "
-            << noteLocalUid << ", previous note tag local uids = "
-            << previousNoteTagLocalUids.join(QStringLiteral(","))
-            << ", new note tag local uids = "
-            << newNoteTagLocalUids.join(QStringLiteral(",")));
-
-    std::sort(previousNoteTagLocalUids.begin(), previousNoteTagLocalUids.end());
-    std::sort(newNoteTagLocalUids.begin(), newNoteTagLocalUids.end());
-
-    std::vector<QString> commonTagLocalUids;
-
-    std::set_intersection(
-        previousNoteTagLocalUids.begin(), previousNoteTagLocalUids.end(),
-        newNoteTagLocalUids.begin(), newNoteTagLocalUids.end(),
-        std::back_inserter(commonTagLocalUids));
-
-    auto & localUidIndex = m_data.get<ByLocalUid>();
-
-    for (const auto & tagLocalUid: qAsConst(previousNoteTagLocalUids)) {
-        auto commonIt = std::find(
-            commonTagLocalUids.begin(), commonTagLocalUids.end(), tagLocalUid);
-
-        if (commonIt != commonTagLocalUids.end()) {
-            continue;
-        }
-
-        auto itemIt = localUidIndex.find(tagLocalUid);
-        if (Q_UNLIKELY(itemIt == localUidIndex.end())) {
-            // Probably this tag was expunged
-            QNDEBUG(
-                "model:tag", "No tag was found in the model: " << tagLocalUid);
-            continue;
-        }
-
-        int noteCount = itemIt->noteCount();
-        --noteCount;
-        noteCount = std::max(0, noteCount);
-        setNoteCountForTag(tagLocalUid, noteCount);
-    }
-
-    for (const auto & tagLocalUid: qAsConst(newNoteTagLocalUids)) {
-        auto commonIt = std::find(
-            commonTagLocalUids.begin(), commonTagLocalUids.end(), tagLocalUid);
-
-        if (commonIt != commonTagLocalUids.end()) {
-            continue;
-        }
-
-        auto itemIt = localUidIndex.find(tagLocalUid);
-        if (Q_UNLIKELY(itemIt == localUidIndex.end())) {
-            // Probably this tag was expunged
-            QNDEBUG(
-                "model:tag", "No tag was found in the model: " << tagLocalUid);
-            continue;
-        }
-
-        int noteCount = itemIt->noteCount();
-        ++noteCount;
-        setNoteCountForTag(tagLocalUid, noteCount);
-    }
-}
-
-void TagModel::onExpungeNoteComplete(Note note, QUuid requestId)
-{
-    QNTRACE(
-        "model:tag",
-        "TagModel::onExpungeNoteComplete: note = " << note << "\nRequest id = "
-                                                   << requestId);
-
-    if (note.hasTagLocalUids()) {
-        const auto & tagLocalUids = note.tagLocalUids();
-        for (const auto & tagLocalUid: qAsConst(tagLocalUids)) {
-            Tag tag;
-            tag.setLocalUid(tagLocalUid);
-            requestNoteCountForTag(tag);
-        }
-
-        return;
-    }
-
-    QNDEBUG("model:tag", "Note has no tag local uids");
-    requestNoteCountsPerAllTags();
-}
-
 void TagModel::onAddLinkedNotebookComplete(
     LinkedNotebook linkedNotebook, QUuid requestId)
 {
@@ -2064,54 +1914,6 @@ void TagModel::onExpungeLinkedNotebookComplete(
     }
 }
 
-void TagModel::onListAllTagsPerNoteComplete(
-    QList<Tag> foundTags, Note note,
-    LocalStorageManager::ListObjectsOptions flag, size_t limit, size_t offset,
-    LocalStorageManager::ListTagsOrder order,
-    LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
-{
-    auto it = m_listTagsPerNoteRequestIds.find(requestId);
-    if (it == m_listTagsPerNoteRequestIds.end()) {
-        return;
-    }
-
-    QNTRACE(
-        "model:tag",
-        "TagModel::onListAllTagsPerNoteComplete: note = "
-            << note << "\nFlag = " << flag << ", limit = " << limit
-            << ", offset = " << offset << ", order = " << order
-            << ", order direction = " << orderDirection
-            << ", request id = " << requestId);
-
-    for (const auto & foundTag: qAsConst(foundTags)) {
-        requestNoteCountForTag(foundTag);
-    }
-}
-
-void TagModel::onListAllTagsPerNoteFailed(
-    Note note, LocalStorageManager::ListObjectsOptions flag, size_t limit,
-    size_t offset, LocalStorageManager::ListTagsOrder order,
-    LocalStorageManager::OrderDirection orderDirection,
-    ErrorString errorDescription, QUuid requestId)
-{
-    auto it = m_listTagsPerNoteRequestIds.find(requestId);
-    if (it == m_listTagsPerNoteRequestIds.end()) {
-        return;
-    }
-
-    QNWARNING(
-        "model:tag",
-        "TagModel::onListAllTagsPerNoteFailed: note = "
-            << note << "\nFlag = " << flag << ", limit = " << limit
-            << ", offset = " << offset << ", order = " << order
-            << ", order direction = " << orderDirection << ", request id = "
-            << requestId << ", error description = " << errorDescription);
-
-    // Trying to work around this problem by re-requesting the note count for
-    // all tags
-    requestNoteCountsPerAllTags();
-}
-
 void TagModel::onListAllLinkedNotebooksComplete(
     size_t limit, size_t offset,
     LocalStorageManager::ListLinkedNotebooksOrder order,
@@ -2131,6 +1933,11 @@ void TagModel::onListAllLinkedNotebooksComplete(
 
     for (const auto & foundLinkedNotebook: qAsConst(foundLinkedNotebooks)) {
         onLinkedNotebookAddedOrUpdated(foundLinkedNotebook);
+
+        if (foundLinkedNotebook.hasGuid()) {
+            Q_UNUSED(m_linkedNotebookGuidsPendingReconciliation.remove(
+                foundLinkedNotebook.guid()))
+        }
     }
 
     m_listLinkedNotebooksRequestId = QUuid();
@@ -2149,6 +1956,21 @@ void TagModel::onListAllLinkedNotebooksComplete(
         return;
     }
 
+    // Linked notebooks restored from the snapshot but not listed from
+    // the local storage were expunged after the snapshot was taken
+    const auto linkedNotebookGuidsPendingReconciliation =
+        m_linkedNotebookGuidsPendingReconciliation;
+
+    m_linkedNotebookGuidsPendingReconciliation.clear();
+
+    for (const auto & linkedNotebookGuid:
+         qAsConst(linkedNotebookGuidsPendingReconciliation))
+    {
+        LinkedNotebook linkedNotebook;
+        linkedNotebook.setGuid(linkedNotebookGuid);
+        onExpungeLinkedNotebookComplete(linkedNotebook, QUuid());
+    }
+
     m_allLinkedNotebooksListed = true;
 
     if (m_allTagsListed) {
@@ -2180,185 +2002,218 @@ void TagModel::onListAllLinkedNotebooksFailed(
     Q_EMIT notifyError(errorDescription);
 }
 
-void TagModel::createConnections(
-    LocalStorageManagerAsync & localStorageManagerAsync)
+void TagModel::connectToLocalStorage()
 {
-    QNTRACE("model:tag", "TagModel::createConnections");
+    QNTRACE("model:tag", "TagModel::connectToLocalStorage");
+
+    if (m_connectedToLocalStorage) {
+        QNTRACE("model:tag", "Already connected to local storage");
+        return;
+    }
 
     // Local signals to localStorageManagerAsync's slots
 
     QObject::connect(
-        this, &TagModel::addTag, &localStorageManagerAsync,
+        this, &TagModel::addTag, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onAddTagRequest);
 
     QObject::connect(
-        this, &TagModel::updateTag, &localStorageManagerAsync,
+        this, &TagModel::updateTag, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onUpdateTagRequest);
 
     QObject::connect(
-        this, &TagModel::findTag, &localStorageManagerAsync,
+        this, &TagModel::findTag, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onFindTagRequest);
 
     QObject::connect(
-        this, &TagModel::listTags, &localStorageManagerAsync,
+        this, &TagModel::listTags, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onListTagsRequest);
 
     QObject::connect(
-        this, &TagModel::expungeTag, &localStorageManagerAsync,
+        this, &TagModel::expungeTag, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onExpungeTagRequest);
 
     QObject::connect(
-        this, &TagModel::findNotebook, &localStorageManagerAsync,
+        this, &TagModel::findNotebook, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onFindNotebookRequest);
 
     QObject::connect(
-        this, &TagModel::requestNoteCountPerTag, &localStorageManagerAsync,
-        &LocalStorageManagerAsync::onGetNoteCountPerTagRequest);
-
-    QObject::connect(
-        this, &TagModel::requestNoteCountsForAllTags, &localStorageManagerAsync,
-        &LocalStorageManagerAsync::onGetNoteCountsPerAllTagsRequest);
-
-    QObject::connect(
-        this, &TagModel::listAllTagsPerNote, &localStorageManagerAsync,
-        &LocalStorageManagerAsync::onListAllTagsPerNoteRequest);
-
-    QObject::connect(
-        this, &TagModel::listAllLinkedNotebooks, &localStorageManagerAsync,
+        this, &TagModel::listAllLinkedNotebooks, &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::onListAllLinkedNotebooksRequest);
 
-    // localStorageManagerAsync's signals to local slots
+    // m_localStorageManagerAsync's signals to local slots
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::addTagComplete,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::addTagComplete,
         this, &TagModel::onAddTagComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::addTagFailed,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::addTagFailed,
         this, &TagModel::onAddTagFailed);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::updateTagComplete,
-        this, &TagModel::onUpdateTagComplete);
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::updateTagComplete, this,
+        &TagModel::onUpdateTagComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::updateTagFailed,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::updateTagFailed,
         this, &TagModel::onUpdateTagFailed);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::findTagComplete,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::findTagComplete,
         this, &TagModel::onFindTagComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::findTagFailed,
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::findTagFailed,
         this, &TagModel::onFindTagFailed);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::listTagsComplete,
-        this, &TagModel::onListTagsComplete);
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::listTagsComplete, this,
+        &TagModel::onListTagsComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listTagsWithNoteLocalUidsFailed, this,
         &TagModel::onListTagsFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeTagComplete, this,
         &TagModel::onExpungeTagComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::expungeTagFailed,
-        this, &TagModel::onExpungeTagFailed);
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeTagFailed, this,
+        &TagModel::onExpungeTagFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountPerTagComplete, this,
-        &TagModel::onGetNoteCountPerTagComplete);
-
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountPerTagFailed, this,
-        &TagModel::onGetNoteCountPerTagFailed);
-
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountsPerAllTagsComplete, this,
-        &TagModel::onGetNoteCountsPerAllTagsComplete);
-
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::getNoteCountsPerAllTagsFailed, this,
-        &TagModel::onGetNoteCountsPerAllTagsFailed);
-
-    QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::
             expungeNotelessTagsFromLinkedNotebooksComplete,
         this, &TagModel::onExpungeNotelessTagsFromLinkedNotebooksComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findNotebookComplete, this,
         &TagModel::onFindNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::findNotebookFailed, this,
         &TagModel::onFindNotebookFailed);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateNotebookComplete, this,
         &TagModel::onUpdateNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeNotebookComplete, this,
         &TagModel::onExpungeNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync, &LocalStorageManagerAsync::addNoteComplete,
-        this, &TagModel::onAddNoteComplete);
-
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::noteTagListChanged, this,
-        &TagModel::onNoteTagListChanged);
-
-    QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::expungeNoteComplete, this,
-        &TagModel::onExpungeNoteComplete);
-
-    QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::addLinkedNotebookComplete, this,
         &TagModel::onAddLinkedNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::updateLinkedNotebookComplete, this,
         &TagModel::onUpdateLinkedNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::expungeLinkedNotebookComplete, this,
         &TagModel::onExpungeLinkedNotebookComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
-        &LocalStorageManagerAsync::listAllTagsPerNoteComplete, this,
-        &TagModel::onListAllTagsPerNoteComplete);
-
-    QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listAllLinkedNotebooksComplete, this,
         &TagModel::onListAllLinkedNotebooksComplete);
 
     QObject::connect(
-        &localStorageManagerAsync,
+        &m_localStorageManagerAsync,
         &LocalStorageManagerAsync::listAllLinkedNotebooksFailed, this,
         &TagModel::onListAllLinkedNotebooksFailed);
+
+    if (m_ownsNoteCountAggregator) {
+        m_pNoteCountAggregator->connectToLocalStorage();
+    }
+
+    m_connectedToLocalStorage = true;
+}
+
+void TagModel::disconnectFromLocalStorage()
+{
+    QNTRACE("model:tag", "TagModel::disconnectFromLocalStorage");
+
+    if (!m_connectedToLocalStorage) {
+        QNTRACE("model:tag", "Already disconnected from local storage");
+        return;
+    }
+
+    QObject::disconnect(&m_localStorageManagerAsync);
+    m_localStorageManagerAsync.disconnect(this);
+    m_connectedToLocalStorage = false;
+
+    // Queued requests would go nowhere now
+    if (m_pRequestScheduler) {
+        m_pRequestScheduler->cancelRequests(*this);
+    }
+
+    if (m_ownsNoteCountAggregator) {
+        m_pNoteCountAggregator->disconnectFromLocalStorage();
+    }
+}
+
+bool TagModel::saveSnapshot(ModelSnapshotWriter & writer) const
+{
+    QNDEBUG("model:tag", "TagModel::saveSnapshot");
+
+    if (!m_allTagsListed || !m_allLinkedNotebooksListed ||
+        !m_tagItemsNotYetInLocalStorageUids.isEmpty() ||
+        !m_addTagRequestIds.isEmpty() || !m_updateTagRequestIds.isEmpty() ||
+        !m_expungeTagRequestIds.isEmpty() ||
+        !m_findTagToRestoreFailedUpdateRequestIds.isEmpty() ||
+        !m_findTagToPerformUpdateRequestIds.isEmpty() ||
+        !m_findTagAfterNotelessTagsErasureRequestIds.isEmpty() ||
+        m_pNoteCountAggregator->hasPendingTagNoteCountRequests())
+    {
+        QNDEBUG(
+            "model:tag",
+            "Tag model is not in sync with local storage, won't save its "
+                << "snapshot");
+        return false;
+    }
+
+    auto & stream = writer.stream();
+
+    const auto & usernamesByGuids =
+        m_linkedNotebookOwnerUsernamesByLinkedNotebookGuids;
+
+    stream << quint32(TAG_MODEL_SNAPSHOT_VERSION)
+           << quint32(usernamesByGuids.size());
+
+    for (auto it = usernamesByGuids.constBegin(),
+              end = usernamesByGuids.constEnd();
+         it != end; ++it)
+    {
+        stream << it.key() << it.value();
+    }
+
+    const auto & localUidIndex = m_data.get<ByLocalUid>();
+    stream << quint32(localUidIndex.size());
+
+    for (const auto & item: localUidIndex) {
+        stream << item.localUid() << item.guid() << item.linkedNotebookGuid()
+               << item.name() << item.parentLocalUid() << item.parentGuid()
+               << item.isSynchronizable() << item.isDirty()
+               << item.isFavorited() << qint32(item.noteCount());
+    }
+
+    return stream.status() == QDataStream::Ok;
 }
 
 void TagModel::requestTagsList()
@@ -2372,67 +2227,50 @@ void TagModel::requestTagsList()
 
     auto order = LocalStorageManager::ListTagsOrder::NoOrder;
     auto direction = LocalStorageManager::OrderDirection::Ascending;
-
-    m_listTagsRequestId = QUuid::createUuid();
+    const size_t offset = m_listTagsOffset;
+
+    m_listTagsRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::VisibleView,
+        [this, flags, offset, order, direction](const QUuid & id) {
+            Q_EMIT listTags(
+                flags, TAG_LIST_LIMIT, offset, order, direction, {}, id);
+        },
+        localStorageRequestKey(
+            "listTags", flags, TAG_LIST_LIMIT, offset, order, direction,
+            QString()));
 
     QNTRACE(
         "model:tag",
-        "Emitting the request to list tags: offset = "
+        "Scheduled the request to list tags: offset = "
             << m_listTagsOffset << ", request id = " << m_listTagsRequestId);
-
-    Q_EMIT listTags(
-        flags, TAG_LIST_LIMIT, m_listTagsOffset, order, direction, {},
-        m_listTagsRequestId);
 }
 
-void TagModel::requestNoteCountForTag(const Tag & tag)
+void TagModel::requestNoteCountForTag(const QString & tagLocalUid)
 {
-    QNTRACE("model:tag", "TagModel::requestNoteCountForTag: " << tag);
-
-    QUuid requestId = QUuid::createUuid();
-    Q_UNUSED(m_noteCountPerTagRequestIds.insert(requestId))
-
-    QNTRACE(
-        "model:tag",
-        "Emitting the request to compute the number of notes "
-            << "per tag, request id = " << requestId);
+    QNTRACE("model:tag", "TagModel::requestNoteCountForTag: " << tagLocalUid);
 
-    LocalStorageManager::NoteCountOptions options(
-        LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes);
+    // The note count might be already known to the aggregator if some other
+    // model has asked for it before
+    const int noteCount = m_pNoteCountAggregator->noteCountForTag(tagLocalUid);
+    if (noteCount >= 0) {
+        setNoteCountForTag(tagLocalUid, noteCount);
+        return;
+    }
 
-    Q_EMIT requestNoteCountPerTag(tag, options, requestId);
-}
-
-void TagModel::requestTagsPerNote(const Note & note)
-{
-    QNTRACE("model:tag", "TagModel::requestTagsPerNote: " << note);
-
-    QUuid requestId = QUuid::createUuid();
-    Q_UNUSED(m_listTagsPerNoteRequestIds.insert(requestId))
-
-    QNTRACE(
-        "model:tag",
-        "Emitting the request to list tags per note: request "
-            << "id = " << requestId);
-
-    Q_EMIT listAllTagsPerNote(
-        note, LocalStorageManager::ListObjectsOption::ListAll,
-        /* limit = */ 0,
-        /* offset = */ 0, LocalStorageManager::ListTagsOrder::NoOrder,
-        LocalStorageManager::OrderDirection::Ascending, requestId);
+    m_pNoteCountAggregator->requestNoteCountForTag(tagLocalUid);
 }
 
 void TagModel::requestNoteCountsPerAllTags()
 {
     QNTRACE("model:tag", "TagModel::requestNoteCountsPerAllTags");
 
-    m_noteCountsPerAllTagsRequestId = QUuid::createUuid();
-
-    LocalStorageManager::NoteCountOptions options(
-        LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes);
+    if (m_pNoteCountAggregator->hasNoteCountsForAllTags()) {
+        onNoteCountsForAllTagsChanged();
+        return;
+    }
 
-    Q_EMIT requestNoteCountsForAllTags(
-        options, m_noteCountsPerAllTagsRequestId);
+    m_pNoteCountAggregator->requestNoteCountsForAllTags();
 }
 
 void TagModel::requestLinkedNotebooksList()
@@ -2441,18 +2279,160 @@ void TagModel::requestLinkedNotebooksList()
 
     auto order = LocalStorageManager::ListLinkedNotebooksOrder::NoOrder;
     auto direction = LocalStorageManager::OrderDirection::Ascending;
-
-    m_listLinkedNotebooksRequestId = QUuid::createUuid();
+    const size_t offset = m_listLinkedNotebooksOffset;
+
+    // Notebook model lists linked notebooks in the same way
+    m_listLinkedNotebooksRequestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::VisibleView,
+        [this, offset, order, direction](const QUuid & id) {
+            Q_EMIT listAllLinkedNotebooks(
+                LINKED_NOTEBOOK_LIST_LIMIT, offset, order, direction, id);
+        },
+        localStorageRequestKey(
+            "listAllLinkedNotebooks", LINKED_NOTEBOOK_LIST_LIMIT, offset, order,
+            direction));
 
     QNTRACE(
         "model:tag",
-        "Emitting the request to list linked notebooks: "
+        "Scheduled the request to list linked notebooks: "
             << "offset = " << m_listLinkedNotebooksOffset
             << ", request id = " << m_listLinkedNotebooksRequestId);
+}
+
+bool TagModel::restoreFromSnapshot(ModelSnapshot & snapshot)
+{
+    QNDEBUG("model:tag", "TagModel::restoreFromSnapshot");
+
+    if (snapshot.isEmpty()) {
+        return false;
+    }
+
+    auto & stream = snapshot.stream();
+
+    quint32 version = 0;
+    stream >> version;
+
+    if ((stream.status() != QDataStream::Ok) ||
+        (version != TAG_MODEL_SNAPSHOT_VERSION))
+    {
+        QNWARNING(
+            "model:tag",
+            "Unsupported tag model snapshot, version = " << version);
+        return false;
+    }
+
+    // Reading everything before adding anything to the model so that
+    // the corrupted snapshot doesn't leave the model half populated
+    quint32 linkedNotebookCount = 0;
+    stream >> linkedNotebookCount;
+
+    QList<LinkedNotebook> linkedNotebooks;
+    for (quint32 i = 0;
+         (i < linkedNotebookCount) && (stream.status() == QDataStream::Ok); ++i)
+    {
+        QString guid;
+        QString username;
+        stream >> guid >> username;
+
+        LinkedNotebook linkedNotebook;
+        linkedNotebook.setGuid(guid);
+        linkedNotebook.setUsername(username);
+        linkedNotebooks << linkedNotebook;
+    }
+
+    quint32 tagCount = 0;
+    stream >> tagCount;
+
+    std::vector<std::pair<Tag, qint32>> tagsWithNoteCounts;
+    tagsWithNoteCounts.reserve(std::min<quint32>(tagCount, 1024));
+
+    for (quint32 i = 0;
+         (i < tagCount) && (stream.status() == QDataStream::Ok); ++i)
+    {
+        QString localUid;
+        QString guid;
+        QString linkedNotebookGuid;
+        QString name;
+        QString parentLocalUid;
+        QString parentGuid;
+        bool isSynchronizable = false;
+        bool isDirty = false;
+        bool isFavorited = false;
+        qint32 noteCount = 0;
+
+        stream >> localUid >> guid >> linkedNotebookGuid >> name >>
+            parentLocalUid >> parentGuid >> isSynchronizable >> isDirty >>
+            isFavorited >> noteCount;
+
+        Tag tag;
+        tag.setLocalUid(localUid);
+
+        if (!guid.isEmpty()) {
+            tag.setGuid(guid);
+        }
+
+        if (!linkedNotebookGuid.isEmpty()) {
+            tag.setLinkedNotebookGuid(linkedNotebookGuid);
+        }
+
+        if (!name.isEmpty()) {
+            tag.setName(name);
+        }
+
+        if (!parentLocalUid.isEmpty()) {
+            tag.setParentLocalUid(parentLocalUid);
+        }
 
-    Q_EMIT listAllLinkedNotebooks(
-        LINKED_NOTEBOOK_LIST_LIMIT, m_listLinkedNotebooksOffset, order,
-        direction, m_listLinkedNotebooksRequestId);
+        if (!parentGuid.isEmpty()) {
+            tag.setParentGuid(parentGuid);
+        }
+
+        tag.setLocal(!isSynchronizable);
+        tag.setDirty(isDirty);
+        tag.setFavorited(isFavorited);
+
+        tagsWithNoteCounts.emplace_back(std::move(tag), noteCount);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        QNWARNING("model:tag", "Failed to read tag model snapshot");
+        return false;
+    }
+
+    for (const auto & linkedNotebook: qAsConst(linkedNotebooks)) {
+        onLinkedNotebookAddedOrUpdated(linkedNotebook);
+
+        if (!snapshot.isUpToDate()) {
+            m_linkedNotebookGuidsPendingReconciliation.insert(
+                linkedNotebook.guid());
+        }
+    }
+
+    // NOTE: restored tags are not put into the cache as they don't contain
+    // all the fields of tags stored in the local storage
+    const auto & localUidIndex = m_data.get<ByLocalUid>();
+    for (const auto & tagWithNoteCount: tagsWithNoteCounts) {
+        const auto & tag = tagWithNoteCount.first;
+        if (localUidIndex.find(tag.localUid()) != localUidIndex.end()) {
+            continue;
+        }
+
+        onTagAdded(tag, nullptr);
+        setNoteCountForTag(tag.localUid(), tagWithNoteCount.second);
+
+        if (!snapshot.isUpToDate()) {
+            m_tagLocalUidsPendingReconciliation.insert(tag.localUid());
+        }
+    }
+
+    QNDEBUG(
+        "model:tag",
+        "Restored " << tagsWithNoteCounts.size() << " tags and "
+                    << linkedNotebooks.size()
+                    << " linked notebooks from snapshot");
+
+    return true;
 }
 
 void TagModel::onTagAddedOrUpdated(
@@ -4215,19 +4195,21 @@ void TagModel::updateTagInLocalStorage(const TagItem & item)
 
         const auto * pCachedTag = m_cache.get(item.localUid());
         if (Q_UNLIKELY(!pCachedTag)) {
-            QUuid requestId = QUuid::createUuid();
-            Q_UNUSED(m_findTagToPerformUpdateRequestIds.insert(requestId))
-
             Tag dummy;
             dummy.setLocalUid(item.localUid());
 
+            QUuid requestId = scheduleLocalStorageRequest(
+                m_pRequestScheduler, *this,
+                LocalStorageRequestScheduler::Priority::Interactive,
+                [this, dummy](const QUuid & id) { Q_EMIT findTag(dummy, id); });
+
+            Q_UNUSED(m_findTagToPerformUpdateRequestIds.insert(requestId))
+
             QNDEBUG(
                 "model:tag",
-                "Emitting the request to find tag: "
+                "Scheduled the request to find tag: "
                     << "local uid = " << item.localUid()
                     << ", request id = " << requestId);
-
-            Q_EMIT findTag(dummy, requestId);
             return;
         }
 
@@ -4246,7 +4228,10 @@ void TagModel::updateTagInLocalStorage(const TagItem & item)
             "Emitting the request to add the tag to the local "
                 << "storage: id = " << requestId << ", tag: " << tag);
 
-        Q_EMIT addTag(tag, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT addTag(tag, id);
+            });
         Q_UNUSED(m_tagItemsNotYetInLocalStorageUids.erase(notYetSavedItemIt))
     }
     else {
@@ -4261,7 +4246,10 @@ void TagModel::updateTagInLocalStorage(const TagItem & item)
             "Emitting the request to update tag in the local "
                 << "storage: id = " << requestId << ", tag: " << tag);
 
-        Q_EMIT updateTag(tag, requestId);
+        sendLocalStorageRequest(
+            m_pRequestScheduler, requestId, [&](const QUuid & id) {
+                Q_EMIT updateTag(tag, id);
+            });
     }
 }
 
@@ -4530,24 +4518,29 @@ void TagModel::checkAndFindLinkedNotebookRestrictions(const TagItem & tagItem)
         return;
     }
 
-    auto requestId = QUuid::createUuid();
+    Notebook notebook;
+    notebook.unsetLocalUid();
+    notebook.setLinkedNotebookGuid(linkedNotebookGuid);
+
+    auto requestId = scheduleLocalStorageRequest(
+        m_pRequestScheduler, *this,
+        LocalStorageRequestScheduler::Priority::VisibleView,
+        [this, notebook](const QUuid & id) {
+            Q_EMIT findNotebook(notebook, id);
+        },
+        localStorageRequestKey(
+            "findNotebookByLinkedNotebookGuid", linkedNotebookGuid));
 
     m_findNotebookRequestForLinkedNotebookGuid.insert(
         LinkedNotebookGuidWithFindNotebookRequestIdBimap::value_type(
             linkedNotebookGuid, requestId));
 
-    Notebook notebook;
-    notebook.unsetLocalUid();
-    notebook.setLinkedNotebookGuid(linkedNotebookGuid);
-
     QNTRACE(
         "model:tag",
-        "Emitted the request to find notebook by linked "
+        "Scheduled the request to find notebook by linked "
             << "notebook guid: " << linkedNotebookGuid
             << ", for the purpose of finding the tag restrictions; "
             << "request id = " << requestId);
-
-    Q_EMIT findNotebook(notebook, requestId);
 }
 
 bool TagModel::tagItemMatchesByLinkedNotebook(
@@ -26,6 +26,8 @@
 #include "TagLinkedNotebookRootItem.h"
 
 #include <lib/model/common/AbstractItemModel.h>
+#include <lib/model/common/LocalStorageRequestScheduler.h>
+#include <lib/model/common/ModelSnapshot.h>
 
 #include <quentier/local_storage/LocalStorageManagerAsync.h>
 #include <quentier/types/Account.h>
@@ -54,10 +56,10 @@ RESTORE_WARNINGS
 #define TAG_MODEL_MIME_TYPE                                                    \
     QStringLiteral("application/x-com.quentier.tagmodeldatalist")
 
-#define TAG_MODEL_MIME_DATA_MAX_COMPRESSION (9)
-
 namespace quentier {
 
+QT_FORWARD_DECLARE_CLASS(NoteCountAggregator)
+
 class TagModel : public AbstractItemModel
 {
     Q_OBJECT
@@ -65,10 +67,37 @@ public:
     explicit TagModel(
         const Account & account,
         LocalStorageManagerAsync & localStorageManagerAsync, TagCache & cache,
-        QObject * parent = nullptr);
+        QObject * parent = nullptr, ModelSnapshot * pSnapshot = nullptr,
+        LocalStorageRequestScheduler * pRequestScheduler = nullptr,
+        NoteCountAggregator * pNoteCountAggregator = nullptr);
 
     virtual ~TagModel() override;
 
+    /**
+     * @brief connectToLocalStorage and disconnectFromLocalStorage methods
+     * allow to temporarily detach the model from local storage i.e. when
+     * the model is kept aside for an account which is not active at
+     * the moment; the model is connected to local storage on construction
+     */
+    void connectToLocalStorage();
+    void disconnectFromLocalStorage();
+
+    bool isConnectedToLocalStorage() const
+    {
+        return m_connectedToLocalStorage;
+    }
+
+    /**
+     * @brief saveSnapshot method writes the snapshot of tag items, linked
+     * notebooks and note counts which can be passed to the model's constructor
+     * on the next startup
+     * @param writer                The writer to write the snapshot to
+     * @return                      True if the snapshot was written, false if
+     *                              the model is not fully loaded yet or waits
+     *                              for responses from the local storage
+     */
+    bool saveSnapshot(ModelSnapshotWriter & writer) const;
+
     enum class Column
     {
         Name = 0,
@@ -373,18 +402,6 @@ Q_SIGNALS:
     void expungeTag(Tag tag, QUuid requestId);
     void findNotebook(Notebook notebook, QUuid requestId);
 
-    void requestNoteCountPerTag(
-        Tag tag, LocalStorageManager::NoteCountOptions options,
-        QUuid requestId);
-
-    void requestNoteCountsForAllTags(
-        LocalStorageManager::NoteCountOptions options, QUuid requestId);
-
-    void listAllTagsPerNote(
-        Note note, LocalStorageManager::ListObjectsOptions flag, size_t limit,
-        size_t offset, LocalStorageManager::ListTagsOrder order,
-        LocalStorageManager::OrderDirection orderDirection, QUuid requestId);
-
     void listAllLinkedNotebooks(
         const size_t limit, const size_t offset,
         const LocalStorageManager::ListLinkedNotebooksOrder order,
@@ -426,21 +443,8 @@ private Q_SLOTS:
     void onExpungeTagFailed(
         Tag tag, ErrorString errorDescription, QUuid requestId);
 
-    void onGetNoteCountPerTagComplete(
-        int noteCount, Tag tag, LocalStorageManager::NoteCountOptions options,
-        QUuid requestId);
-
-    void onGetNoteCountPerTagFailed(
-        ErrorString errorDescription, Tag tag,
-        LocalStorageManager::NoteCountOptions options, QUuid requestId);
-
-    void onGetNoteCountsPerAllTagsComplete(
-        QHash<QString, int> noteCountsPerTagLocalUid,
-        LocalStorageManager::NoteCountOptions options, QUuid requestId);
-
-    void onGetNoteCountsPerAllTagsFailed(
-        ErrorString errorDescription,
-        LocalStorageManager::NoteCountOptions options, QUuid requestId);
+    void onNoteCountForTagChanged(QString tagLocalUid, int noteCount);
+    void onNoteCountsForAllTagsChanged();
 
     void onExpungeNotelessTagsFromLinkedNotebooksComplete(QUuid requestId);
 
@@ -453,14 +457,6 @@ private Q_SLOTS:
 
     void onExpungeNotebookComplete(Notebook notebook, QUuid requestId);
 
-    void onAddNoteComplete(Note note, QUuid requestId);
-
-    void onNoteTagListChanged(
-        QString noteLocalUid, QStringList previousNoteTagLocalUids,
-        QStringList newNoteTagLocalUids);
-
-    void onExpungeNoteComplete(Note note, QUuid requestId);
-
     void onAddLinkedNotebookComplete(
         LinkedNotebook linkedNotebook, QUuid requestId);
 
@@ -470,18 +466,6 @@ private Q_SLOTS:
     void onExpungeLinkedNotebookComplete(
         LinkedNotebook linkedNotebook, QUuid requestId);
 
-    void onListAllTagsPerNoteComplete(
-        QList<Tag> foundTags, Note note,
-        LocalStorageManager::ListObjectsOptions flag, size_t limit,
-        size_t offset, LocalStorageManager::ListTagsOrder order,
-        LocalStorageManager::OrderDirection orderDirection, QUuid requestId);
-
-    void onListAllTagsPerNoteFailed(
-        Note note, LocalStorageManager::ListObjectsOptions flag, size_t limit,
-        size_t offset, LocalStorageManager::ListTagsOrder order,
-        LocalStorageManager::OrderDirection orderDirection,
-        ErrorString errorDescription, QUuid requestId);
-
     void onListAllLinkedNotebooksComplete(
         size_t limit, size_t offset,
         LocalStorageManager::ListLinkedNotebooksOrder order,
@@ -495,10 +479,9 @@ private Q_SLOTS:
         ErrorString errorDescription, QUuid requestId);
 
 private:
-    void createConnections(LocalStorageManagerAsync & localStorageManagerAsync);
     void requestTagsList();
-    void requestNoteCountForTag(const Tag & tag);
-    void requestTagsPerNote(const Note & note);
+    bool restoreFromSnapshot(ModelSnapshot & snapshot);
+    void requestNoteCountForTag(const QString & tagLocalUid);
     void requestNoteCountsPerAllTags();
     void requestLinkedNotebooksList();
 
@@ -654,6 +637,15 @@ private:
     ITagModelItem * m_pAllTagsRootItem = nullptr;
     IndexId m_allTagsRootItemIndexId = 1;
 
+    LocalStorageManagerAsync & m_localStorageManagerAsync;
+    bool m_connectedToLocalStorage = false;
+
+    LocalStorageRequestScheduler * m_pRequestScheduler;
+
+    // Either shared with other models or owned by this model
+    NoteCountAggregator * m_pNoteCountAggregator;
+    bool m_ownsNoteCountAggregator = false;
+
     TagCache & m_cache;
 
     LinkedNotebookItems m_linkedNotebookItems;
@@ -670,15 +662,10 @@ private:
     QSet<QUuid> m_updateTagRequestIds;
     QSet<QUuid> m_expungeTagRequestIds;
 
-    QSet<QUuid> m_noteCountPerTagRequestIds;
-    QUuid m_noteCountsPerAllTagsRequestId;
-
     QSet<QUuid> m_findTagToRestoreFailedUpdateRequestIds;
     QSet<QUuid> m_findTagToPerformUpdateRequestIds;
     QSet<QUuid> m_findTagAfterNotelessTagsErasureRequestIds;
 
-    QSet<QUuid> m_listTagsPerNoteRequestIds;
-
     QHash<QString, QString> m_linkedNotebookOwnerUsernamesByLinkedNotebookGuids;
     size_t m_listLinkedNotebooksOffset = 0;
     QUuid m_listLinkedNotebooksRequestId;
@@ -705,6 +692,12 @@ private:
 
     bool m_allTagsListed = false;
     bool m_allLinkedNotebooksListed = false;
+
+    // Local uids of tags and guids of linked notebooks restored from
+    // the outdated snapshot which have not been listed from the local storage
+    // yet
+    QSet<QString> m_tagLocalUidsPendingReconciliation;
+    QSet<QString> m_linkedNotebookGuidsPendingReconciliation;
 };
 
 } // namespace quentier
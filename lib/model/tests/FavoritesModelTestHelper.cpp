@@ -22,6 +22,7 @@
 
 #include <lib/model/favorites/FavoritesModel.h>
 #include <lib/model/note/NoteModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/exception/IQuentierException.h>
 #include <quentier/logging/QuentierLogger.h>
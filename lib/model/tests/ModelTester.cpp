@@ -24,7 +24,10 @@
 #include "SavedSearchModelTestHelper.h"
 #include "TagModelTestHelper.h"
 
+#include <lib/model/common/NoteCountAggregator.h>
+#include <lib/model/note/NoteSearchIndex.h>
 #include <lib/model/saved_search/SavedSearchModel.h>
+#include <lib/model/tag/AllTagsRootItem.h>
 #include <lib/model/tag/TagModel.h>
 
 #include <quentier/exception/IQuentierException.h>
@@ -44,6 +47,8 @@
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
 
+#include <utility>
+
 // 10 minutes, the timeout for async stuff to complete
 #define MAX_ALLOWED_MILLISECONDS 600000
 
@@ -427,6 +432,292 @@ void ModelTester::testTagModelItemSerialization()
     QVERIFY(restoredItem.parent() == item.parent());
 }
 
+void ModelTester::testModelItemChildRows()
+{
+    using namespace quentier;
+
+    AllTagsRootItem rootItem;
+
+    QList<TagItem *> items;
+    for (int i = 0; i < 5; ++i) {
+        auto * pItem = new TagItem(UidGenerator::Generate());
+        pItem->setName(QString::number(i));
+        items << pItem;
+        rootItem.addChild(pItem);
+    }
+
+    for (int i = 0; i < items.size(); ++i) {
+        QVERIFY(rootItem.rowForChild(items[i]) == i);
+    }
+
+    auto * pInsertedItem = new TagItem(UidGenerator::Generate());
+    pInsertedItem->setName(QStringLiteral("inserted"));
+    rootItem.insertChild(1, pInsertedItem);
+    items.insert(1, pInsertedItem);
+
+    for (int i = 0; i < items.size(); ++i) {
+        QVERIFY(rootItem.rowForChild(items[i]) == i);
+    }
+
+    QVERIFY(rootItem.swapChildren(0, 3));
+    std::swap(items[0], items[3]);
+
+    for (int i = 0; i < items.size(); ++i) {
+        QVERIFY(rootItem.rowForChild(items[i]) == i);
+    }
+
+    auto * pTakenItem = rootItem.takeChild(2);
+    QVERIFY(pTakenItem == items.takeAt(2));
+    QVERIFY(rootItem.rowForChild(pTakenItem) < 0);
+
+    for (int i = 0; i < items.size(); ++i) {
+        QVERIFY(rootItem.rowForChild(items[i]) == i);
+    }
+
+    rootItem.sortChildren(
+        [](const ITagModelItem * pLhs, const ITagModelItem * pRhs) {
+            return pLhs->cast<TagItem>()->nameUpper() >
+                pRhs->cast<TagItem>()->nameUpper();
+        });
+
+    for (int row = 0; row < rootItem.childrenCount(); ++row) {
+        QVERIFY(rootItem.rowForChild(rootItem.childAtRow(row)) == row);
+    }
+
+    AllTagsRootItem otherRootItem;
+    pTakenItem->setParent(&otherRootItem);
+    QVERIFY(otherRootItem.rowForChild(pTakenItem) == 0);
+    QVERIFY(rootItem.rowForChild(pTakenItem) < 0);
+
+    delete pTakenItem;
+    qDeleteAll(rootItem.children());
+}
+
+void ModelTester::benchmarkModelItemChildRows()
+{
+    using namespace quentier;
+
+    // Flat tree similar to that of the tag model for an account with lots
+    // of tags
+    AllTagsRootItem rootItem;
+
+    const int numItems = 10000;
+    for (int i = 0; i < numItems; ++i) {
+        rootItem.addChild(new TagItem(UidGenerator::Generate()));
+    }
+
+    const auto children = rootItem.children();
+    int rowsSum = 0;
+
+    QBENCHMARK
+    {
+        for (const auto * pChild: qAsConst(children)) {
+            rowsSum += rootItem.rowForChild(pChild);
+        }
+    }
+
+    QVERIFY(rowsSum > 0);
+    qDeleteAll(children);
+}
+
+void ModelTester::testNoteSearchIndex()
+{
+    using namespace quentier;
+
+    delete m_pLocalStorageManagerAsync;
+
+    Account account(
+        QStringLiteral("ModelTester_note_search_index_test_fake_user"),
+        Account::Type::Evernote, 400);
+
+    LocalStorageManager::StartupOptions startupOptions(
+        LocalStorageManager::StartupOption::ClearDatabase);
+
+    m_pLocalStorageManagerAsync =
+        new LocalStorageManagerAsync(account, startupOptions, this);
+
+    m_pLocalStorageManagerAsync->init();
+
+    NoteSearchIndex index(account, *m_pLocalStorageManagerAsync);
+    QTRY_VERIFY(index.isReady());
+    QVERIFY(index.noteCount() == 0);
+
+    Tag tag;
+    tag.setName(QStringLiteral("Work"));
+    Q_EMIT m_pLocalStorageManagerAsync->addTagComplete(tag, QUuid());
+
+    const QString notebookLocalUid = UidGenerator::Generate();
+
+    Note firstNote;
+    firstNote.setNotebookLocalUid(notebookLocalUid);
+    firstNote.setTitle(QStringLiteral("Shopping list"));
+    firstNote.setContent(
+        QStringLiteral("<en-note><div>Buy milk and bread</div></en-note>"));
+    firstNote.addTagLocalUid(tag.localUid());
+    Q_EMIT m_pLocalStorageManagerAsync->addNoteComplete(firstNote, QUuid());
+
+    Note secondNote;
+    secondNote.setNotebookLocalUid(notebookLocalUid);
+    secondNote.setTitle(QStringLiteral("Meeting notes"));
+    secondNote.setContent(
+        QStringLiteral("<en-note><div>Discuss the budget</div></en-note>"));
+    Q_EMIT m_pLocalStorageManagerAsync->addNoteComplete(secondNote, QUuid());
+
+    QVERIFY(index.noteCount() == 2);
+
+    const QSet<QString> firstNoteOnly = QSet<QString>() << firstNote.localUid();
+    const QSet<QString> secondNoteOnly = QSet<QString>()
+        << secondNote.localUid();
+    const QSet<QString> bothNotes = firstNoteOnly + secondNoteOnly;
+
+    QSet<QString> noteLocalUids;
+    QVERIFY(index.findNoteLocalUids(QStringLiteral("MILK"), noteLocalUids));
+    QVERIFY(noteLocalUids == firstNoteOnly);
+
+    QVERIFY(index.findNoteLocalUids(
+        QStringLiteral("intitle:meeting"), noteLocalUids));
+    QVERIFY(noteLocalUids == secondNoteOnly);
+
+    QVERIFY(index.findNoteLocalUids(QStringLiteral("tag:work"), noteLocalUids));
+    QVERIFY(noteLocalUids == firstNoteOnly);
+
+    QVERIFY(index.findNoteLocalUids(QStringLiteral("bu*"), noteLocalUids));
+    QVERIFY(noteLocalUids == bothNotes);
+
+    QVERIFY(index.findNoteLocalUids(
+        QStringLiteral("shopping budget"), noteLocalUids));
+    QVERIFY(noteLocalUids.isEmpty());
+
+    // Plain words match words of tags' names too
+    QVERIFY(index.findNoteLocalUids(QStringLiteral("work"), noteLocalUids));
+    QVERIFY(noteLocalUids == firstNoteOnly);
+
+    // Queries requiring the full search grammar are not answered
+    QVERIFY(!index.findNoteLocalUids(QStringLiteral("-milk"), noteLocalUids));
+    QVERIFY(!index.findNoteLocalUids(
+        QStringLiteral("any: milk budget"), noteLocalUids));
+    QVERIFY(!index.findNoteLocalUids(
+        QStringLiteral("\"milk and\""), noteLocalUids));
+    QVERIFY(!index.findNoteLocalUids(
+        QStringLiteral("notebook:Default"), noteLocalUids));
+
+    secondNote.addTagLocalUid(tag.localUid());
+    Q_EMIT m_pLocalStorageManagerAsync->updateNoteComplete(
+        secondNote,
+        LocalStorageManager::UpdateNoteOptions(
+            LocalStorageManager::UpdateNoteOption::UpdateTags),
+        QUuid());
+
+    QVERIFY(index.findNoteLocalUids(QStringLiteral("tag:wo*"), noteLocalUids));
+    QVERIFY(noteLocalUids == bothNotes);
+
+    // Text recognized in resources is not indexed so plain words can't be
+    // answered once some note has recognition data
+    Resource resource;
+    resource.setNoteLocalUid(secondNote.localUid());
+    resource.setRecognitionDataHash(QByteArray(16, '\x01'));
+    secondNote.addResource(resource);
+    Q_EMIT m_pLocalStorageManagerAsync->updateNoteComplete(
+        secondNote,
+        LocalStorageManager::UpdateNoteOptions(
+            LocalStorageManager::UpdateNoteOption::UpdateResourceMetadata),
+        QUuid());
+
+    QVERIFY(!index.findNoteLocalUids(QStringLiteral("milk"), noteLocalUids));
+    QVERIFY(index.findNoteLocalUids(
+        QStringLiteral("intitle:meeting"), noteLocalUids));
+    QVERIFY(noteLocalUids == secondNoteOnly);
+
+    Q_EMIT m_pLocalStorageManagerAsync->expungeNoteComplete(
+        secondNote, QUuid());
+
+    Q_EMIT m_pLocalStorageManagerAsync->expungeNoteComplete(firstNote, QUuid());
+
+    QVERIFY(index.findNoteLocalUids(QStringLiteral("milk"), noteLocalUids));
+    QVERIFY(noteLocalUids.isEmpty());
+
+    Q_EMIT m_pLocalStorageManagerAsync->expungeTagComplete(
+        tag, QStringList(), QUuid());
+
+    QVERIFY(index.findNoteLocalUids(QStringLiteral("tag:work"), noteLocalUids));
+    QVERIFY(noteLocalUids.isEmpty());
+}
+
+void ModelTester::testNoteCountAggregator()
+{
+    using namespace quentier;
+
+    delete m_pLocalStorageManagerAsync;
+
+    Account account(
+        QStringLiteral("ModelTester_note_count_aggregator_test_fake_user"),
+        Account::Type::Evernote, 500);
+
+    LocalStorageManager::StartupOptions startupOptions(
+        LocalStorageManager::StartupOption::ClearDatabase);
+
+    m_pLocalStorageManagerAsync =
+        new LocalStorageManagerAsync(account, startupOptions, this);
+
+    m_pLocalStorageManagerAsync->init();
+
+    NoteCountAggregator aggregator(*m_pLocalStorageManagerAsync);
+
+    const QString firstNotebookLocalUid = UidGenerator::Generate();
+    const QString secondNotebookLocalUid = UidGenerator::Generate();
+    const QString tagLocalUid = UidGenerator::Generate();
+
+    // Unknown counts are not guessed from note changes
+    QVERIFY(aggregator.noteCountForNotebook(firstNotebookLocalUid) == -1);
+    QVERIFY(aggregator.noteCountForTag(tagLocalUid) == -1);
+
+    aggregator.seedNoteCountForNotebook(firstNotebookLocalUid, 0);
+    aggregator.seedNoteCountForNotebook(secondNotebookLocalUid, 0);
+    aggregator.seedNoteCountForTag(tagLocalUid, 0);
+
+    QSignalSpy notebookCountSpy(
+        &aggregator, &NoteCountAggregator::noteCountForNotebookChanged);
+
+    QSignalSpy tagCountSpy(
+        &aggregator, &NoteCountAggregator::noteCountForTagChanged);
+
+    Note note;
+    note.setNotebookLocalUid(firstNotebookLocalUid);
+    note.addTagLocalUid(tagLocalUid);
+    Q_EMIT m_pLocalStorageManagerAsync->addNoteComplete(note, QUuid());
+
+    QVERIFY(aggregator.noteCountForNotebook(firstNotebookLocalUid) == 1);
+    QVERIFY(aggregator.noteCountForTag(tagLocalUid) == 1);
+    QVERIFY(notebookCountSpy.count() == 1);
+    QVERIFY(tagCountSpy.count() == 1);
+
+    Q_EMIT m_pLocalStorageManagerAsync->noteMovedToAnotherNotebook(
+        note.localUid(), firstNotebookLocalUid, secondNotebookLocalUid);
+
+    QVERIFY(aggregator.noteCountForNotebook(firstNotebookLocalUid) == 0);
+    QVERIFY(aggregator.noteCountForNotebook(secondNotebookLocalUid) == 1);
+    QVERIFY(notebookCountSpy.count() == 3);
+
+    Q_EMIT m_pLocalStorageManagerAsync->noteTagListChanged(
+        note.localUid(), QStringList() << tagLocalUid, QStringList());
+
+    QVERIFY(aggregator.noteCountForTag(tagLocalUid) == 0);
+    QVERIFY(tagCountSpy.count() == 2);
+
+    // Changes which don't affect the counts are not announced
+    Q_EMIT m_pLocalStorageManagerAsync->noteTagListChanged(
+        note.localUid(), QStringList(), QStringList());
+
+    QVERIFY(tagCountSpy.count() == 2);
+
+    Tag tag;
+    tag.setLocalUid(tagLocalUid);
+    Q_EMIT m_pLocalStorageManagerAsync->expungeTagComplete(
+        tag, QStringList(), QUuid());
+
+    QVERIFY(aggregator.noteCountForTag(tagLocalUid) == -1);
+}
+
 int main(int argc, char * argv[])
 {
     QApplication app(argc, argv);
@@ -38,6 +38,10 @@ private Q_SLOTS:
     void testNoteModel();
     void testFavoritesModel();
     void testTagModelItemSerialization();
+    void testModelItemChildRows();
+    void benchmarkModelItemChildRows();
+    void testNoteSearchIndex();
+    void testNoteCountAggregator();
 
 private:
     quentier::LocalStorageManagerAsync * m_pLocalStorageManagerAsync = nullptr;
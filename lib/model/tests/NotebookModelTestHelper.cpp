@@ -22,6 +22,7 @@
 #include "modeltest.h"
 
 #include <lib/model/notebook/NotebookModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/exception/IQuentierException.h>
 #include <quentier/logging/QuentierLogger.h>
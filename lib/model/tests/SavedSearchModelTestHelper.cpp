@@ -22,6 +22,7 @@
 #include "modeltest.h"
 
 #include <lib/model/saved_search/SavedSearchModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/exception/IQuentierException.h>
 #include <quentier/logging/QuentierLogger.h>
@@ -0,0 +1,459 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NetworkFetchService.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Compat.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSaveFile>
+#include <QTimer>
+
+#include <algorithm>
+
+#define NETWORK_FETCH_SERVICE_TIMEOUT_CHECKER_INTERVAL (1000)
+
+namespace quentier {
+
+NetworkFetchService::NetworkFetchService(
+    const int maxConcurrentRequests, const QString & cacheDirPath,
+    const qint64 timeoutMsec, QObject * parent) :
+    QObject(parent),
+    m_pNetworkAccessManager(new QNetworkAccessManager(this)),
+    m_maxConcurrentRequests(std::max(maxConcurrentRequests, 1)),
+    m_cacheDirPath(cacheDirPath), m_timeoutMsec(timeoutMsec)
+{
+    if (!m_cacheDirPath.isEmpty()) {
+        QDir cacheDir(m_cacheDirPath);
+        if (!cacheDir.exists() && !cacheDir.mkpath(m_cacheDirPath)) {
+            QNWARNING(
+                "network",
+                "Failed to create cache dir for network fetch service: "
+                    << m_cacheDirPath);
+        }
+    }
+
+    QObject::connect(
+        m_pNetworkAccessManager, &QNetworkAccessManager::sslErrors, this,
+        &NetworkFetchService::onReplySslErrors);
+}
+
+NetworkFetchService::~NetworkFetchService()
+{
+    QNDEBUG("network", "NetworkFetchService::~NetworkFetchService");
+
+    const auto replies = m_urlsByReply.keys();
+    for (auto * pReply: qAsConst(replies)) {
+        QObject::disconnect(pReply, nullptr, this, nullptr);
+        pReply->abort();
+    }
+}
+
+QUuid NetworkFetchService::fetch(const QUrl & url)
+{
+    QUuid requestId = QUuid::createUuid();
+
+    QNDEBUG(
+        "network",
+        "NetworkFetchService::fetch: url = " << url << ", request id = "
+                                             << requestId);
+
+    auto it = m_requestIdsByUrl.find(url);
+    if (it != m_requestIdsByUrl.end()) {
+        QNDEBUG(
+            "network",
+            "Data by this url is already being fetched, coalescing "
+                << "the requests");
+        it.value() << requestId;
+        return requestId;
+    }
+
+    m_requestIdsByUrl[url] << requestId;
+    m_pendingUrls.enqueue(url);
+
+    schedulePendingRequestsStart();
+    return requestId;
+}
+
+void NetworkFetchService::cancel(const QUuid & requestId)
+{
+    QNDEBUG("network", "NetworkFetchService::cancel: " << requestId);
+
+    for (auto it = m_requestIdsByUrl.begin(), end = m_requestIdsByUrl.end();
+         it != end; ++it)
+    {
+        auto & requestIds = it.value();
+        if (!requestIds.removeOne(requestId)) {
+            continue;
+        }
+
+        if (!requestIds.isEmpty()) {
+            return;
+        }
+
+        const QUrl url = it.key();
+        Q_UNUSED(m_requestIdsByUrl.erase(it))
+
+        if (m_pendingUrls.removeOne(url)) {
+            return;
+        }
+
+        for (auto replyIt = m_urlsByReply.begin(),
+                  replyEnd = m_urlsByReply.end();
+             replyIt != replyEnd; ++replyIt)
+        {
+            if (replyIt.value() != url) {
+                continue;
+            }
+
+            auto * pReply = replyIt.key();
+            QObject::disconnect(pReply, nullptr, this, nullptr);
+            Q_UNUSED(m_urlsByReply.erase(replyIt))
+            Q_UNUSED(m_lastNetworkTimeByReply.remove(pReply))
+            pReply->abort();
+            pReply->deleteLater();
+            break;
+        }
+
+        schedulePendingRequestsStart();
+        return;
+    }
+}
+
+void NetworkFetchService::startPendingRequests()
+{
+    QNDEBUG(
+        "network",
+        "NetworkFetchService::startPendingRequests: pending "
+            << m_pendingUrls.size() << ", active " << m_urlsByReply.size());
+
+    m_pendingRequestsStartScheduled = false;
+
+    while (!m_pendingUrls.isEmpty() &&
+           (m_urlsByReply.size() < m_maxConcurrentRequests))
+    {
+        const QUrl url = m_pendingUrls.dequeue();
+
+        QByteArray cachedData;
+        if (readFromCache(url, cachedData)) {
+            QNDEBUG("network", "Found cached data for url " << url);
+            ++m_cacheHitsCount;
+            finishRequests(url, true, cachedData, ErrorString());
+            continue;
+        }
+
+        if (m_cacheOnly) {
+            QNDEBUG("network", "No cached data for url " << url);
+            ErrorString errorDescription(
+                QT_TR_NOOP("no cached data for the url"));
+            errorDescription.details() = url.toString();
+            finishRequests(url, false, QByteArray(), errorDescription);
+            continue;
+        }
+
+        startRequest(url);
+    }
+}
+
+void NetworkFetchService::onReplyFinished()
+{
+    auto * pReply = qobject_cast<QNetworkReply *>(sender());
+    if (Q_UNLIKELY(!pReply)) {
+        return;
+    }
+
+    auto it = m_urlsByReply.find(pReply);
+    if (it == m_urlsByReply.end()) {
+        QNDEBUG(
+            "network",
+            "NetworkFetchService::onReplyFinished: reply is no longer "
+                << "tracked, probably due to timeout or cancellation");
+        pReply->deleteLater();
+        return;
+    }
+
+    QNDEBUG(
+        "network",
+        "NetworkFetchService::onReplyFinished: url = " << it.value());
+
+    if (pReply->error() != QNetworkReply::NoError) {
+        ErrorString errorDescription(QT_TR_NOOP("network error"));
+        errorDescription.details() += QStringLiteral("(");
+        errorDescription.details() += QString::number(pReply->error());
+        errorDescription.details() += QStringLiteral(") ");
+        errorDescription.details() += pReply->errorString();
+        finishReply(pReply, false, QByteArray(), errorDescription);
+        return;
+    }
+
+    // Redirects which were not followed and other non-successful responses
+    // don't carry the requested data and must not get into the cache
+    const QVariant statusCodeAttribute =
+        pReply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+
+    bool conversionResult = false;
+    const int statusCode = statusCodeAttribute.toInt(&conversionResult);
+    if (!conversionResult || (statusCode < 200) || (statusCode >= 300)) {
+        ErrorString errorDescription(
+            QT_TR_NOOP("unexpected HTTP status code"));
+
+        QString str;
+        QDebug dbg(&str);
+        dbg << statusCodeAttribute;
+
+        errorDescription.details() += str;
+        finishReply(pReply, false, QByteArray(), errorDescription);
+        return;
+    }
+
+    const QByteArray fetchedData = pReply->readAll();
+    writeToCache(it.value(), fetchedData);
+    finishReply(pReply, true, fetchedData, ErrorString());
+}
+
+void NetworkFetchService::onReplyDownloadProgress(
+    qint64 bytesFetched, qint64 bytesTotal)
+{
+    auto * pReply = qobject_cast<QNetworkReply *>(sender());
+    auto it = m_urlsByReply.find(pReply);
+    if (it == m_urlsByReply.end()) {
+        return;
+    }
+
+    QNTRACE(
+        "network",
+        "NetworkFetchService::onReplyDownloadProgress: url = "
+            << it.value() << ", fetched " << bytesFetched << " bytes, total "
+            << bytesTotal << " bytes");
+
+    m_lastNetworkTimeByReply[pReply] = QDateTime::currentMSecsSinceEpoch();
+
+    const auto requestIds = m_requestIdsByUrl.value(it.value());
+    for (const auto & requestId: qAsConst(requestIds)) {
+        Q_EMIT downloadProgress(requestId, bytesFetched, bytesTotal);
+    }
+}
+
+void NetworkFetchService::checkForTimeouts()
+{
+    if (m_urlsByReply.isEmpty()) {
+        if (m_pTimeoutTimer) {
+            m_pTimeoutTimer->stop();
+        }
+
+        return;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    QList<QNetworkReply *> timedOutReplies;
+    for (auto it = m_lastNetworkTimeByReply.constBegin(),
+              end = m_lastNetworkTimeByReply.constEnd();
+         it != end; ++it)
+    {
+        if ((now - it.value()) > m_timeoutMsec) {
+            timedOutReplies << it.key();
+        }
+    }
+
+    for (auto * pReply: qAsConst(timedOutReplies)) {
+        QNDEBUG(
+            "network",
+            "NetworkFetchService: request timed out: url = "
+                << m_urlsByReply.value(pReply));
+
+        QObject::disconnect(pReply, nullptr, this, nullptr);
+
+        ErrorString errorDescription(QT_TR_NOOP("connection timeout"));
+        finishReply(pReply, false, QByteArray(), errorDescription);
+        pReply->abort();
+    }
+}
+
+void NetworkFetchService::schedulePendingRequestsStart()
+{
+    if (m_pendingRequestsStartScheduled) {
+        return;
+    }
+
+    m_pendingRequestsStartScheduled = true;
+    QTimer::singleShot(0, this, SLOT(startPendingRequests()));
+}
+
+void NetworkFetchService::startRequest(const QUrl & url)
+{
+    QNDEBUG("network", "NetworkFetchService::startRequest: url = " << url);
+
+    QNetworkRequest request;
+    request.setUrl(url);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    request.setAttribute(
+        QNetworkRequest::RedirectPolicyAttribute,
+        QNetworkRequest::NoLessSafeRedirectPolicy);
+#elif QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+#endif
+
+    auto * pReply = m_pNetworkAccessManager->get(request);
+    m_urlsByReply[pReply] = url;
+    m_lastNetworkTimeByReply[pReply] = QDateTime::currentMSecsSinceEpoch();
+
+    QObject::connect(
+        pReply, &QNetworkReply::finished, this,
+        &NetworkFetchService::onReplyFinished);
+
+    QObject::connect(
+        pReply, &QNetworkReply::downloadProgress, this,
+        &NetworkFetchService::onReplyDownloadProgress);
+
+    if (m_timeoutMsec <= 0) {
+        return;
+    }
+
+    if (!m_pTimeoutTimer) {
+        m_pTimeoutTimer = new QTimer(this);
+
+        QObject::connect(
+            m_pTimeoutTimer, &QTimer::timeout, this,
+            &NetworkFetchService::checkForTimeouts);
+    }
+
+    if (!m_pTimeoutTimer->isActive()) {
+        m_pTimeoutTimer->start(NETWORK_FETCH_SERVICE_TIMEOUT_CHECKER_INTERVAL);
+    }
+}
+
+void NetworkFetchService::onReplySslErrors(
+    QNetworkReply * pReply, QList<QSslError> errors)
+{
+    if (!m_urlsByReply.contains(pReply)) {
+        return;
+    }
+
+    QNDEBUG(
+        "network",
+        "NetworkFetchService::onReplySslErrors: url = "
+            << m_urlsByReply.value(pReply));
+
+    ErrorString errorDescription(QT_TR_NOOP("SSL errors"));
+
+    for (const auto & error: qAsConst(errors)) {
+        errorDescription.details() += QStringLiteral("(");
+        errorDescription.details() += QString::number(error.error());
+        errorDescription.details() += QStringLiteral(") ");
+        errorDescription.details() += error.errorString();
+        errorDescription.details() += QStringLiteral("; ");
+    }
+
+    QObject::disconnect(pReply, nullptr, this, nullptr);
+    finishReply(pReply, false, QByteArray(), errorDescription);
+    pReply->abort();
+}
+
+void NetworkFetchService::finishRequests(
+    const QUrl & url, const bool status, const QByteArray & fetchedData,
+    const ErrorString & errorDescription)
+{
+    const auto requestIds = m_requestIdsByUrl.take(url);
+    for (const auto & requestId: qAsConst(requestIds)) {
+        Q_EMIT finished(requestId, status, fetchedData, errorDescription);
+    }
+}
+
+void NetworkFetchService::finishReply(
+    QNetworkReply * pReply, const bool status, const QByteArray & fetchedData,
+    const ErrorString & errorDescription)
+{
+    const QUrl url = m_urlsByReply.take(pReply);
+    Q_UNUSED(m_lastNetworkTimeByReply.remove(pReply))
+
+    // NOTE: QNetworkReply must not be deleted directly from within the slot
+    // connected to its signals
+    pReply->deleteLater();
+
+    finishRequests(url, status, fetchedData, errorDescription);
+    schedulePendingRequestsStart();
+}
+
+QString NetworkFetchService::cacheFilePath(const QUrl & url) const
+{
+    if (m_cacheDirPath.isEmpty()) {
+        return {};
+    }
+
+    const QByteArray urlHash = QCryptographicHash::hash(
+        url.toEncoded(), QCryptographicHash::Sha1);
+
+    return m_cacheDirPath + QStringLiteral("/") +
+        QString::fromUtf8(urlHash.toHex());
+}
+
+bool NetworkFetchService::readFromCache(
+    const QUrl & url, QByteArray & data) const
+{
+    const QString filePath = cacheFilePath(url);
+    if (filePath.isEmpty()) {
+        return false;
+    }
+
+    QFile file(filePath);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    data = file.readAll();
+    return true;
+}
+
+void NetworkFetchService::writeToCache(
+    const QUrl & url, const QByteArray & data) const
+{
+    const QString filePath = cacheFilePath(url);
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    // QSaveFile ensures a partially written file never appears in the cache
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        QNWARNING(
+            "network",
+            "Failed to open cache file for writing: "
+                << filePath << ": " << file.errorString());
+        return;
+    }
+
+    if (file.write(data) != data.size() || !file.commit()) {
+        QNWARNING(
+            "network",
+            "Failed to write cache file: " << filePath << ": "
+                                           << file.errorString());
+    }
+}
+
+} // namespace quentier
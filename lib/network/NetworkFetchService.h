@@ -0,0 +1,195 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_NETWORK_NETWORK_FETCH_SERVICE_H
+#define QUENTIER_LIB_NETWORK_NETWORK_FETCH_SERVICE_H
+
+#include "NetworkReplyFetcher.h"
+
+#include <quentier/types/ErrorString.h>
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QQueue>
+#include <QSslError>
+#include <QUrl>
+#include <QUuid>
+
+#define NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS (6)
+
+QT_FORWARD_DECLARE_CLASS(QNetworkAccessManager)
+QT_FORWARD_DECLARE_CLASS(QNetworkReply)
+QT_FORWARD_DECLARE_CLASS(QTimer)
+
+namespace quentier {
+
+/**
+ * @brief The NetworkFetchService class downloads data by URLs using a single
+ * shared QNetworkAccessManager so that connections are reused between
+ * requests.
+ *
+ * The number of simultaneously running requests is bounded, the rest of
+ * requests wait in the queue. Simultaneous requests for the same URL are
+ * coalesced into a single download. If cache dir path is specified, fetched
+ * data is stored in files named after the hash of the URL inside that dir
+ * and subsequent requests for the same URL are served from there without
+ * touching the network. In cache only mode requests for URLs not found in
+ * the cache fail instead of going to the network.
+ *
+ * The results are always delivered asynchronously i.e. never from within
+ * the fetch call.
+ */
+class NetworkFetchService final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NetworkFetchService(
+        const int maxConcurrentRequests =
+            NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS,
+        const QString & cacheDirPath = QString(),
+        const qint64 timeoutMsec = NETWORK_REPLY_FETCHER_DEFAULT_TIMEOUT_MSEC,
+        QObject * parent = nullptr);
+
+    virtual ~NetworkFetchService() override;
+
+    int maxConcurrentRequests() const
+    {
+        return m_maxConcurrentRequests;
+    }
+
+    const QString & cacheDirPath() const
+    {
+        return m_cacheDirPath;
+    }
+
+    qint64 timeoutMsec() const
+    {
+        return m_timeoutMsec;
+    }
+
+    bool isCacheOnly() const
+    {
+        return m_cacheOnly;
+    }
+
+    void setCacheOnly(const bool cacheOnly)
+    {
+        m_cacheOnly = cacheOnly;
+    }
+
+    /**
+     * @return      Number of URLs being downloaded at the moment
+     */
+    int activeRequestsCount() const
+    {
+        return m_urlsByReply.size();
+    }
+
+    /**
+     * @return      Number of URLs waiting for their turn to be downloaded
+     */
+    int pendingRequestsCount() const
+    {
+        return m_pendingUrls.size();
+    }
+
+    /**
+     * @return      Number of requests served from the on-disk cache so far
+     */
+    quint64 cacheHitsCount() const
+    {
+        return m_cacheHitsCount;
+    }
+
+    /**
+     * @brief fetch method schedules the download of data by the given URL
+     *
+     * @param url           URL to fetch the data from
+     * @return              Request id identifying the request within
+     *                      finished and downloadProgress signals
+     */
+    QUuid fetch(const QUrl & url);
+
+    /**
+     * @brief cancel method cancels the previously scheduled request; no
+     * signals would be emitted for the cancelled request
+     */
+    void cancel(const QUuid & requestId);
+
+Q_SIGNALS:
+    void finished(
+        QUuid requestId, bool status, QByteArray fetchedData,
+        ErrorString errorDescription);
+
+    void downloadProgress(
+        QUuid requestId, qint64 bytesFetched, qint64 bytesTotal);
+
+private Q_SLOTS:
+    void startPendingRequests();
+
+    void onReplyFinished();
+    void onReplySslErrors(QNetworkReply * pReply, QList<QSslError> errors);
+    void onReplyDownloadProgress(qint64 bytesFetched, qint64 bytesTotal);
+
+    void checkForTimeouts();
+
+private:
+    void schedulePendingRequestsStart();
+    void startRequest(const QUrl & url);
+
+    void finishRequests(
+        const QUrl & url, const bool status, const QByteArray & fetchedData,
+        const ErrorString & errorDescription);
+
+    void finishReply(
+        QNetworkReply * pReply, const bool status,
+        const QByteArray & fetchedData, const ErrorString & errorDescription);
+
+    QString cacheFilePath(const QUrl & url) const;
+    bool readFromCache(const QUrl & url, QByteArray & data) const;
+    void writeToCache(const QUrl & url, const QByteArray & data) const;
+
+private:
+    Q_DISABLE_COPY(NetworkFetchService)
+
+private:
+    QNetworkAccessManager * m_pNetworkAccessManager;
+
+    const int m_maxConcurrentRequests;
+    const QString m_cacheDirPath;
+    const qint64 m_timeoutMsec;
+    bool m_cacheOnly = false;
+
+    // Ids of requests waiting for the data from the same URL
+    QHash<QUrl, QList<QUuid>> m_requestIdsByUrl;
+
+    QQueue<QUrl> m_pendingUrls;
+    bool m_pendingRequestsStartScheduled = false;
+
+    QHash<QNetworkReply *, QUrl> m_urlsByReply;
+    QHash<QNetworkReply *, qint64> m_lastNetworkTimeByReply;
+
+    QTimer * m_pTimeoutTimer = nullptr;
+
+    quint64 m_cacheHitsCount = 0;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_NETWORK_NETWORK_FETCH_SERVICE_H
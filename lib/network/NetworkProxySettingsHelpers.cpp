@@ -20,6 +20,7 @@
 
 #include <lib/preferences/keys/Files.h>
 #include <lib/preferences/keys/Synchronization.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/types/Account.h>
@@ -18,6 +18,8 @@
 
 #include "NetworkReplyFetcher.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
 
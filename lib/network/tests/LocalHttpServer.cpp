@@ -0,0 +1,173 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalHttpServer.h"
+
+#include <QHostAddress>
+#include <QTcpSocket>
+
+namespace quentier {
+
+LocalHttpServer::LocalHttpServer(QObject * parent) : QObject(parent)
+{
+    QObject::connect(
+        &m_server, &QTcpServer::newConnection, this,
+        &LocalHttpServer::onNewConnection);
+}
+
+LocalHttpServer::~LocalHttpServer() = default;
+
+bool LocalHttpServer::listen()
+{
+    return m_server.listen(QHostAddress::LocalHost);
+}
+
+void LocalHttpServer::close()
+{
+    m_server.close();
+}
+
+QUrl LocalHttpServer::url(const QString & path) const
+{
+    QUrl url;
+    url.setScheme(QStringLiteral("http"));
+    url.setHost(QStringLiteral("127.0.0.1"));
+    url.setPort(m_server.serverPort());
+    url.setPath(path);
+    return url;
+}
+
+void LocalHttpServer::setData(const QString & path, const QByteArray & data)
+{
+    m_dataByPath[path] = data;
+}
+
+void LocalHttpServer::setRedirect(
+    const QString & path, const QString & targetPath, const int statusCode)
+{
+    m_redirectsByPath[path] = qMakePair(statusCode, targetPath);
+}
+
+void LocalHttpServer::setRespondingEnabled(const bool enabled)
+{
+    m_respondingEnabled = enabled;
+    if (!enabled) {
+        return;
+    }
+
+    const auto heldBackPathsBySocket = m_heldBackPathsBySocket;
+    m_heldBackPathsBySocket.clear();
+
+    for (auto it = heldBackPathsBySocket.constBegin(),
+              end = heldBackPathsBySocket.constEnd();
+         it != end; ++it)
+    {
+        respond(*it.key(), it.value());
+    }
+}
+
+int LocalHttpServer::requestsCount(const QString & path) const
+{
+    return m_requestsCountByPath.value(path);
+}
+
+void LocalHttpServer::onNewConnection()
+{
+    while (m_server.hasPendingConnections()) {
+        auto * pSocket = m_server.nextPendingConnection();
+
+        QObject::connect(
+            pSocket, &QTcpSocket::readyRead, this,
+            &LocalHttpServer::onReadyRead);
+
+        QObject::connect(
+            pSocket, &QTcpSocket::disconnected, pSocket,
+            &QTcpSocket::deleteLater);
+
+        QObject::connect(
+            pSocket, &QTcpSocket::destroyed, this, [this, pSocket] {
+                Q_UNUSED(m_heldBackPathsBySocket.remove(pSocket))
+            });
+    }
+}
+
+void LocalHttpServer::onReadyRead()
+{
+    auto * pSocket = qobject_cast<QTcpSocket *>(sender());
+    if (!pSocket) {
+        return;
+    }
+
+    // Wait for the whole request header to arrive
+    if (!pSocket->peek(pSocket->bytesAvailable()).contains("\r\n\r\n")) {
+        return;
+    }
+
+    const QByteArray request = pSocket->readAll();
+    const QList<QByteArray> requestLineParts =
+        request.left(request.indexOf("\r\n")).split(' ');
+
+    const QString path = (requestLineParts.size() >= 2)
+        ? QString::fromUtf8(requestLineParts[1])
+        : QString();
+
+    ++m_requestsCountByPath[path];
+    Q_EMIT requestReceived(path);
+
+    if (!m_respondingEnabled) {
+        m_heldBackPathsBySocket[pSocket] = path;
+        return;
+    }
+
+    respond(*pSocket, path);
+}
+
+void LocalHttpServer::respond(QTcpSocket & socket, const QString & path)
+{
+    QByteArray response;
+
+    auto redirectIt = m_redirectsByPath.constFind(path);
+    auto it = m_dataByPath.constFind(path);
+    if (redirectIt != m_redirectsByPath.constEnd()) {
+        const QByteArray body = QByteArrayLiteral("Redirect");
+        response = "HTTP/1.1 " + QByteArray::number(redirectIt->first) +
+            " Redirect\r\n";
+        response += "Location: " + url(redirectIt->second).toEncoded();
+        response += "\r\nContent-Length: " + QByteArray::number(body.size());
+        response += "\r\nConnection: close\r\n\r\n";
+        response += body;
+    }
+    else if (it == m_dataByPath.constEnd()) {
+        const QByteArray body = QByteArrayLiteral("Not found");
+        response = QByteArrayLiteral("HTTP/1.1 404 Not Found\r\n");
+        response += "Content-Length: " + QByteArray::number(body.size());
+        response += "\r\nConnection: close\r\n\r\n";
+        response += body;
+    }
+    else {
+        response = QByteArrayLiteral("HTTP/1.1 200 OK\r\n");
+        response += "Content-Length: " + QByteArray::number(it->size());
+        response += "\r\nConnection: close\r\n\r\n";
+        response += it.value();
+    }
+
+    Q_UNUSED(socket.write(response))
+    socket.disconnectFromHost();
+}
+
+} // namespace quentier
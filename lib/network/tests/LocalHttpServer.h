@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_NETWORK_TESTS_LOCAL_HTTP_SERVER_H
+#define QUENTIER_LIB_NETWORK_TESTS_LOCAL_HTTP_SERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QTcpServer>
+#include <QUrl>
+
+QT_FORWARD_DECLARE_CLASS(QTcpSocket)
+
+namespace quentier {
+
+/**
+ * @brief The LocalHttpServer class is a minimal HTTP server listening on
+ * the local host which answers GET requests with the data set up for their
+ * paths, redirects requests for the paths set up for redirection and responds
+ * with 404 to requests for unknown paths. Responses can be held back to keep
+ * requests in progress.
+ */
+class LocalHttpServer final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LocalHttpServer(QObject * parent = nullptr);
+
+    virtual ~LocalHttpServer() override;
+
+    bool listen();
+    void close();
+
+    QUrl url(const QString & path) const;
+
+    void setData(const QString & path, const QByteArray & data);
+
+    /**
+     * @brief setRedirect method makes the server respond to requests for
+     * the path with the given redirection status code and the location
+     * pointing to the target path
+     */
+    void setRedirect(
+        const QString & path, const QString & targetPath,
+        const int statusCode = 302);
+
+    /**
+     * @brief setRespondingEnabled method allows to hold back the responses;
+     * the requests received while responding is disabled are answered once
+     * it is enabled again
+     */
+    void setRespondingEnabled(const bool enabled);
+
+    /**
+     * @return      Number of requests received for the path
+     */
+    int requestsCount(const QString & path) const;
+
+Q_SIGNALS:
+    void requestReceived(QString path);
+
+private Q_SLOTS:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    void respond(QTcpSocket & socket, const QString & path);
+
+private:
+    QTcpServer m_server;
+    QHash<QString, QByteArray> m_dataByPath;
+    QHash<QString, QPair<int, QString>> m_redirectsByPath;
+    QHash<QString, int> m_requestsCountByPath;
+    QHash<QTcpSocket *, QString> m_heldBackPathsBySocket;
+    bool m_respondingEnabled = true;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_NETWORK_TESTS_LOCAL_HTTP_SERVER_H
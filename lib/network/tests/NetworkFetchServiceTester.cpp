@@ -0,0 +1,350 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NetworkFetchServiceTester.h"
+#include "LocalHttpServer.h"
+
+#include <lib/network/NetworkFetchService.h>
+
+#include <quentier/utility/Initialize.h>
+
+#include <QtTest/QtTest>
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+#define FETCH_TIMEOUT_MSEC (10000)
+
+using namespace quentier;
+
+namespace {
+
+struct FetchResult
+{
+    QUuid m_requestId;
+    bool m_status = false;
+    QByteArray m_data;
+    ErrorString m_errorDescription;
+};
+
+void collectResults(
+    NetworkFetchService & service, QVector<FetchResult> & results)
+{
+    QObject::connect(
+        &service, &NetworkFetchService::finished, &service,
+        [&results](
+            QUuid requestId, bool status, QByteArray fetchedData,
+            ErrorString errorDescription) {
+            FetchResult result;
+            result.m_requestId = requestId;
+            result.m_status = status;
+            result.m_data = fetchedData;
+            result.m_errorDescription = errorDescription;
+            results << result;
+        });
+}
+
+} // namespace
+
+NetworkFetchServiceTester::NetworkFetchServiceTester(QObject * parent) :
+    QObject(parent)
+{}
+
+NetworkFetchServiceTester::~NetworkFetchServiceTester() = default;
+
+void NetworkFetchServiceTester::testFetch()
+{
+    LocalHttpServer server;
+    QVERIFY(server.listen());
+
+    const QByteArray data = QByteArrayLiteral("Hello from local server");
+    server.setData(QStringLiteral("/data"), data);
+
+    NetworkFetchService service;
+    QVector<FetchResult> results;
+    collectResults(service, results);
+
+    const QUuid requestId = service.fetch(server.url(QStringLiteral("/data")));
+
+    // Results are never delivered from within the fetch call
+    QCOMPARE(results.size(), 0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 1, FETCH_TIMEOUT_MSEC);
+
+    const auto result = results.at(0);
+    QCOMPARE(result.m_requestId, requestId);
+    QVERIFY(result.m_status);
+    QCOMPARE(result.m_data, data);
+    QCOMPARE(server.requestsCount(QStringLiteral("/data")), 1);
+}
+
+void NetworkFetchServiceTester::testCoalescingOfConcurrentFetches()
+{
+    LocalHttpServer server;
+    QVERIFY(server.listen());
+
+    const QByteArray data = QByteArrayLiteral("Shared data");
+    server.setData(QStringLiteral("/shared"), data);
+
+    // Keep the first request in progress until all fetches are made
+    server.setRespondingEnabled(false);
+
+    NetworkFetchService service;
+    QVector<FetchResult> results;
+    collectResults(service, results);
+    QSignalSpy requestReceivedSpy(&server, &LocalHttpServer::requestReceived);
+
+    const QUrl url = server.url(QStringLiteral("/shared"));
+    const QUuid firstRequestId = service.fetch(url);
+
+    QTRY_COMPARE_WITH_TIMEOUT(
+        requestReceivedSpy.count(), 1, FETCH_TIMEOUT_MSEC);
+    QCOMPARE(service.activeRequestsCount(), 1);
+
+    // Fetches made both while the download is pending and while it is in
+    // progress join the same download
+    const QUuid secondRequestId = service.fetch(url);
+    const QUuid thirdRequestId = service.fetch(url);
+    QCOMPARE(service.activeRequestsCount(), 1);
+    QCOMPARE(service.pendingRequestsCount(), 0);
+
+    server.setRespondingEnabled(true);
+
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 3, FETCH_TIMEOUT_MSEC);
+    QCOMPARE(server.requestsCount(QStringLiteral("/shared")), 1);
+
+    QSet<QUuid> finishedRequestIds;
+    for (const auto & result: qAsConst(results)) {
+        QVERIFY(result.m_status);
+        QCOMPARE(result.m_data, data);
+        finishedRequestIds.insert(result.m_requestId);
+    }
+
+    QCOMPARE(
+        finishedRequestIds,
+        QSet<QUuid>() << firstRequestId << secondRequestId << thirdRequestId);
+
+    // Once the download is finished, the next fetch downloads the data anew
+    service.fetch(url);
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 4, FETCH_TIMEOUT_MSEC);
+    QCOMPARE(server.requestsCount(QStringLiteral("/shared")), 2);
+}
+
+void NetworkFetchServiceTester::testCaching()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+
+    LocalHttpServer server;
+    QVERIFY(server.listen());
+
+    const QByteArray data = QByteArrayLiteral("Cached data");
+    server.setData(QStringLiteral("/cached"), data);
+
+    const QUrl url = server.url(QStringLiteral("/cached"));
+
+    {
+        NetworkFetchService service(
+            NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS,
+            cacheDir.path());
+
+        QVector<FetchResult> results;
+        collectResults(service, results);
+
+        service.fetch(url);
+        QTRY_COMPARE_WITH_TIMEOUT(results.size(), 1, FETCH_TIMEOUT_MSEC);
+        QVERIFY(results.at(0).m_status);
+        QCOMPARE(service.cacheHitsCount(), quint64(0));
+
+        service.fetch(url);
+        QTRY_COMPARE_WITH_TIMEOUT(results.size(), 2, FETCH_TIMEOUT_MSEC);
+
+        const auto result = results.at(1);
+        QVERIFY(result.m_status);
+        QCOMPARE(result.m_data, data);
+        QCOMPARE(service.cacheHitsCount(), quint64(1));
+        QCOMPARE(server.requestsCount(QStringLiteral("/cached")), 1);
+    }
+
+    // The cache outlives the service and doesn't need the server
+    server.close();
+
+    NetworkFetchService service(
+        NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS,
+        cacheDir.path());
+
+    QVector<FetchResult> results;
+    collectResults(service, results);
+
+    service.fetch(url);
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 1, FETCH_TIMEOUT_MSEC);
+
+    const auto result = results.at(0);
+    QVERIFY(result.m_status);
+    QCOMPARE(result.m_data, data);
+    QCOMPARE(service.cacheHitsCount(), quint64(1));
+}
+
+void NetworkFetchServiceTester::testHttpErrorPropagation()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+
+    LocalHttpServer server;
+    QVERIFY(server.listen());
+
+    NetworkFetchService service(
+        NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS,
+        cacheDir.path());
+
+    QVector<FetchResult> results;
+    collectResults(service, results);
+
+    const QUrl url = server.url(QStringLiteral("/missing"));
+    const QUuid firstRequestId = service.fetch(url);
+    const QUuid secondRequestId = service.fetch(url);
+
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 2, FETCH_TIMEOUT_MSEC);
+
+    // The error is delivered to all requests waiting for the URL
+    QSet<QUuid> finishedRequestIds;
+    for (const auto & result: qAsConst(results)) {
+        QVERIFY(!result.m_status);
+        QVERIFY(result.m_data.isEmpty());
+        QVERIFY(!result.m_errorDescription.isEmpty());
+        finishedRequestIds.insert(result.m_requestId);
+    }
+
+    QCOMPARE(
+        finishedRequestIds,
+        QSet<QUuid>() << firstRequestId << secondRequestId);
+
+    // Errors are not cached
+    service.fetch(url);
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 3, FETCH_TIMEOUT_MSEC);
+    QVERIFY(!results.at(2).m_status);
+    QCOMPARE(server.requestsCount(QStringLiteral("/missing")), 2);
+    QCOMPARE(service.cacheHitsCount(), quint64(0));
+}
+
+void NetworkFetchServiceTester::testRedirectFollowing()
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 6, 0)
+    QSKIP("Following redirects requires Qt 5.6 or newer");
+#endif
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+
+    LocalHttpServer server;
+    QVERIFY(server.listen());
+
+    const QByteArray data = QByteArrayLiteral("Redirected data");
+    server.setData(QStringLiteral("/target"), data);
+    server.setRedirect(QStringLiteral("/moved"), QStringLiteral("/target"));
+
+    NetworkFetchService service(
+        NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS,
+        cacheDir.path());
+
+    QVector<FetchResult> results;
+    collectResults(service, results);
+
+    const QUrl url = server.url(QStringLiteral("/moved"));
+    service.fetch(url);
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 1, FETCH_TIMEOUT_MSEC);
+
+    const auto result = results.at(0);
+    QVERIFY(result.m_status);
+    QCOMPARE(result.m_data, data);
+    QCOMPARE(server.requestsCount(QStringLiteral("/target")), 1);
+
+    // The data is cached for the originally requested URL
+    service.fetch(url);
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 2, FETCH_TIMEOUT_MSEC);
+    QCOMPARE(results.at(1).m_data, data);
+    QCOMPARE(service.cacheHitsCount(), quint64(1));
+    QCOMPARE(server.requestsCount(QStringLiteral("/moved")), 1);
+}
+
+void NetworkFetchServiceTester::testUnsuccessfulStatusCodeNotCached()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+
+    LocalHttpServer server;
+    QVERIFY(server.listen());
+
+    // 300 is not followed automatically and is not a network error either
+    server.setData(QStringLiteral("/target"), QByteArrayLiteral("Data"));
+    server.setRedirect(
+        QStringLiteral("/choices"), QStringLiteral("/target"), 300);
+
+    NetworkFetchService service(
+        NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS,
+        cacheDir.path());
+
+    QVector<FetchResult> results;
+    collectResults(service, results);
+
+    const QUrl url = server.url(QStringLiteral("/choices"));
+    service.fetch(url);
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 1, FETCH_TIMEOUT_MSEC);
+
+    const auto result = results.at(0);
+    QVERIFY(!result.m_status);
+    QVERIFY(result.m_data.isEmpty());
+    QVERIFY(!result.m_errorDescription.isEmpty());
+
+    service.fetch(url);
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 2, FETCH_TIMEOUT_MSEC);
+    QVERIFY(!results.at(1).m_status);
+    QCOMPARE(server.requestsCount(QStringLiteral("/choices")), 2);
+    QCOMPARE(service.cacheHitsCount(), quint64(0));
+}
+
+void NetworkFetchServiceTester::testConnectionErrorPropagation()
+{
+    LocalHttpServer server;
+    QVERIFY(server.listen());
+
+    // Nobody listens on this port anymore
+    const QUrl url = server.url(QStringLiteral("/data"));
+    server.close();
+
+    NetworkFetchService service;
+    QVector<FetchResult> results;
+    collectResults(service, results);
+
+    const QUuid requestId = service.fetch(url);
+    QTRY_COMPARE_WITH_TIMEOUT(results.size(), 1, FETCH_TIMEOUT_MSEC);
+
+    const auto result = results.at(0);
+    QCOMPARE(result.m_requestId, requestId);
+    QVERIFY(!result.m_status);
+    QVERIFY(!result.m_errorDescription.isEmpty());
+    QCOMPARE(service.activeRequestsCount(), 0);
+}
+
+int main(int argc, char * argv[])
+{
+    QCoreApplication app(argc, argv);
+    quentier::initializeLibquentier();
+    NetworkFetchServiceTester tester;
+    return QTest::qExec(&tester, argc, argv);
+}
@@ -44,6 +44,7 @@ using quentier::ShortcutSettingsWidget;
 #include <lib/tray/SystemTrayIconManager.h>
 #include <lib/utility/ActionsInfo.h>
 #include <lib/utility/ColorCodeValidator.h>
+#include <lib/utility/Log.h>
 #include <lib/utility/StartAtLogin.h>
 
 #include <quentier/logging/QuentierLogger.h>
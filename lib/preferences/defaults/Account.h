@@ -0,0 +1,39 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_PREFERENCES_DEFAULTS_ACCOUNT_H
+#define QUENTIER_LIB_PREFERENCES_DEFAULTS_ACCOUNT_H
+
+namespace quentier {
+namespace preferences {
+namespace defaults {
+
+// Won't keep models of the previously active accounts in memory by default
+constexpr bool keepInactiveAccountModels = false;
+
+// Models of inactive accounts can occupy up to 64 Mb of memory by default
+constexpr int inactiveAccountModelsMemoryLimitMb = 64;
+
+// Will keep the in-memory index of notes' words for simple searches by default
+constexpr bool useNoteSearchIndex = true;
+
+} // namespace defaults
+} // namespace preferences
+} // namespace quentier
+
+#endif // QUENTIER_LIB_PREFERENCES_DEFAULTS_ACCOUNT_H
@@ -54,6 +54,22 @@ constexpr const char * lastUsedAccountEvernoteAccountType =
 constexpr const char * lastUsedAccountEvernoteHost =
     "LastUsedAccountEvernoteHost";
 
+// Name of preference specifying whether models of the previously active
+// account should be kept in memory after switching to another account so that
+// switching back to that account doesn't require loading everything again
+constexpr const char * keepInactiveAccountModels = "KeepInactiveAccountModels";
+
+// Name of preference specifying the approximate amount of memory in megabytes
+// which the kept models of inactive accounts are allowed to occupy; the least
+// recently used accounts' models are released when the limit is exceeded
+constexpr const char * inactiveAccountModelsMemoryLimitMb =
+    "InactiveAccountModelsMemoryLimitMb";
+
+// Name of preference specifying whether the in-memory index of notes' words
+// should be kept for the account so that simple note searches don't require
+// querying the local storage
+constexpr const char * useNoteSearchIndex = "UseNoteSearchIndex";
+
 // Name of the environment variable which can be set to the name of the account
 // which Quentier should use on startup
 constexpr const char * startupAccountNameEnvVar = "QUENTIER_ACCOUNT_NAME";
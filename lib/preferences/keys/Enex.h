@@ -50,6 +50,12 @@ constexpr const char * lastEnexImportPath = "LastImportEnexPath";
 constexpr const char * lastImportEnexNotebookName =
     "LastImportEnexNotebookName";
 
+// Name of technical preference (not really a preference but a value stored
+// alongside preferences) containing a boolean flag indicating whether
+// the last time some notes were imported from enex the import was made
+// resumable i.e. its progress was recorded in a file next to the enex file
+constexpr const char * lastImportEnexResumable = "LastImportEnexResumable";
+
 } // namespace keys
 } // namespace preferences
 } // namespace quentier
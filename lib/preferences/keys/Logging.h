@@ -43,6 +43,11 @@ constexpr const char * loggingFilterByComponentRegex = "FilterByComponentRegex";
 constexpr const char * enableLogViewerInternalLogs =
     "EnableLogViewerInternalLogs";
 
+// Name of preference specifying whether log entries from Quentier's own hot
+// code paths should also be written into the structured log file which
+// the log viewer reads much faster than the text log
+constexpr const char * enableStructuredLog = "EnableStructuredLog";
+
 } // namespace keys
 } // namespace preferences
 } // namespace quentier
@@ -22,6 +22,7 @@
 
 #include <lib/preferences/keys/Files.h>
 #include <lib/preferences/keys/PanelColors.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/types/ErrorString.h>
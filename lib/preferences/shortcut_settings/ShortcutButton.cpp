@@ -25,6 +25,8 @@
 
 #include "ShortcutButton.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 
 #include <QApplication>
@@ -30,6 +30,7 @@ using quentier::ShortcutButton;
 #include "ui_ShortcutSettingsWidget.h"
 
 #include <lib/utility/ActionsInfo.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/types/ErrorString.h>
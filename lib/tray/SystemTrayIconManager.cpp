@@ -22,6 +22,7 @@
 #include <lib/preferences/defaults/SystemTray.h>
 #include <lib/preferences/keys/Files.h>
 #include <lib/preferences/keys/SystemTray.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
@@ -20,6 +20,8 @@
 #include "AppImageUpdateProvider.h"
 #include "appimageupdaterbridge_enums.hpp"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 
 #include <QCoreApplication>
@@ -18,6 +18,8 @@
 
 #include "AppImageUpdateProvider.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/FileSystem.h>
 
@@ -20,6 +20,7 @@
 
 #include <lib/network/NetworkReplyFetcher.h>
 #include <lib/update/UpdateInfo.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
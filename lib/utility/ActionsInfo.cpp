@@ -18,6 +18,8 @@
 
 #include "ActionsInfo.h"
 
+#include "Log.h"
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
 
@@ -18,6 +18,8 @@
 
 #include "AsyncFileWriter.h"
 
+#include "Log.h"
+
 #include <quentier/logging/QuentierLogger.h>
 
 #include <QFile>
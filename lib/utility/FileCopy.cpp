@@ -0,0 +1,276 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FileCopy.h"
+
+#include "Log.h"
+
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#elif defined(Q_OS_MAC)
+#include <AvailabilityMacros.h>
+#if MAC_OS_X_VERSION_MAX_ALLOWED >= 101200
+#include <sys/clonefile.h>
+#define QUENTIER_HAS_CLONEFILE
+#endif
+#endif
+
+#define FILE_COPY_CHUNK_SIZE (8 * 1024 * 1024)
+
+namespace quentier {
+
+namespace {
+
+enum class CopyStatus
+{
+    Done,
+    Unsupported,
+    Cancelled,
+    Failed
+};
+
+bool notifyProgress(
+    const FileCopyProgressCallback & progressCallback,
+    const qint64 bytesCopied)
+{
+    if (!progressCallback) {
+        return true;
+    }
+
+    return progressCallback(bytesCopied);
+}
+
+#if defined(Q_OS_LINUX)
+
+CopyStatus cloneFile(QFile & sourceFile, QFile & targetFile)
+{
+#ifdef FICLONE
+    if (::ioctl(targetFile.handle(), FICLONE, sourceFile.handle()) == 0) {
+        return CopyStatus::Done;
+    }
+#else
+    Q_UNUSED(sourceFile)
+    Q_UNUSED(targetFile)
+#endif
+
+    return CopyStatus::Unsupported;
+}
+
+CopyStatus copyFileRange(
+    QFile & sourceFile, QFile & targetFile, const qint64 size,
+    const FileCopyProgressCallback & progressCallback,
+    ErrorString & errorDescription)
+{
+#ifdef __NR_copy_file_range
+    qint64 bytesCopied = 0;
+    while (bytesCopied < size) {
+        const auto chunkSize = static_cast<size_t>(std::min<qint64>(
+            size - bytesCopied, FILE_COPY_CHUNK_SIZE));
+
+        const auto res = ::syscall(
+            __NR_copy_file_range, sourceFile.handle(), nullptr,
+            targetFile.handle(), nullptr, chunkSize, 0u);
+
+        if (res < 0) {
+            const int error = errno;
+            if ((bytesCopied == 0) &&
+                ((error == ENOSYS) || (error == EXDEV) || (error == EINVAL) ||
+                 (error == EOPNOTSUPP)))
+            {
+                return CopyStatus::Unsupported;
+            }
+
+            errorDescription.setBase(QT_TR_NOOP("failed to copy file"));
+            errorDescription.details() =
+                QString::fromLocal8Bit(std::strerror(error));
+            return CopyStatus::Failed;
+        }
+
+        if (res == 0) {
+            // The source file must have been truncated while being copied
+            break;
+        }
+
+        bytesCopied += static_cast<qint64>(res);
+        if (!notifyProgress(progressCallback, bytesCopied)) {
+            return CopyStatus::Cancelled;
+        }
+    }
+
+    return CopyStatus::Done;
+#else
+    Q_UNUSED(sourceFile)
+    Q_UNUSED(targetFile)
+    Q_UNUSED(size)
+    Q_UNUSED(progressCallback)
+    Q_UNUSED(errorDescription)
+    return CopyStatus::Unsupported;
+#endif
+}
+
+#endif // Q_OS_LINUX
+
+CopyStatus streamFile(
+    QFile & sourceFile, QFile & targetFile,
+    const FileCopyProgressCallback & progressCallback,
+    ErrorString & errorDescription)
+{
+    QByteArray buffer;
+    qint64 bytesCopied = 0;
+
+    while (!sourceFile.atEnd()) {
+        buffer = sourceFile.read(FILE_COPY_CHUNK_SIZE);
+        if (buffer.isEmpty()) {
+            if (sourceFile.error() != QFileDevice::NoError) {
+                errorDescription.setBase(
+                    QT_TR_NOOP("failed to read the file being copied"));
+                errorDescription.details() = sourceFile.errorString();
+                return CopyStatus::Failed;
+            }
+
+            break;
+        }
+
+        if (targetFile.write(buffer) != buffer.size()) {
+            errorDescription.setBase(
+                QT_TR_NOOP("failed to write the copy of the file"));
+            errorDescription.details() = targetFile.errorString();
+            return CopyStatus::Failed;
+        }
+
+        bytesCopied += buffer.size();
+        if (!notifyProgress(progressCallback, bytesCopied)) {
+            return CopyStatus::Cancelled;
+        }
+    }
+
+    return CopyStatus::Done;
+}
+
+} // namespace
+
+bool copyFile(
+    const QString & sourceFilePath, const QString & targetFilePath,
+    const FileCopyProgressCallback & progressCallback,
+    ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "utility",
+        "copyFile: from " << sourceFilePath << " to " << targetFilePath);
+
+    QFileInfo sourceFileInfo(sourceFilePath);
+    const qint64 size = sourceFileInfo.size();
+    const bool targetFileExists = QFile::exists(targetFilePath);
+
+#ifdef QUENTIER_HAS_CLONEFILE
+    // clonefile can only create new files
+    if (!targetFileExists &&
+        (::clonefile(
+             QFile::encodeName(sourceFilePath).constData(),
+             QFile::encodeName(targetFilePath).constData(), 0) == 0))
+    {
+        QNDEBUG("utility", "Cloned the file");
+
+        if (!notifyProgress(progressCallback, size)) {
+            Q_UNUSED(QFile::remove(targetFilePath))
+            errorDescription.setBase(QT_TR_NOOP("file copying was cancelled"));
+            return false;
+        }
+
+        return true;
+    }
+#endif
+
+    QFile sourceFile(sourceFilePath);
+    if (!sourceFile.open(QIODevice::ReadOnly)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("can't open the file to copy for reading"));
+        errorDescription.details() = sourceFile.errorString();
+        QNWARNING("utility", errorDescription);
+        return false;
+    }
+
+    QFile targetFile(targetFilePath);
+    if (!targetFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("can't open the copy of the file for writing"));
+        errorDescription.details() = targetFile.errorString();
+        QNWARNING("utility", errorDescription);
+        return false;
+    }
+
+    auto status = CopyStatus::Unsupported;
+
+#if defined(Q_OS_LINUX)
+    status = cloneFile(sourceFile, targetFile);
+    if (status == CopyStatus::Done) {
+        QNDEBUG("utility", "Cloned the file");
+        if (!notifyProgress(progressCallback, size)) {
+            status = CopyStatus::Cancelled;
+        }
+    }
+    else {
+        status = copyFileRange(
+            sourceFile, targetFile, size, progressCallback, errorDescription);
+
+        if (status == CopyStatus::Done) {
+            QNDEBUG("utility", "Copied the file with copy_file_range");
+        }
+    }
+#endif
+
+    if (status == CopyStatus::Unsupported) {
+        status = streamFile(
+            sourceFile, targetFile, progressCallback, errorDescription);
+    }
+
+    sourceFile.close();
+
+    if (status == CopyStatus::Done) {
+        Q_UNUSED(targetFile.setPermissions(sourceFile.permissions()))
+        targetFile.close();
+        return true;
+    }
+
+    targetFile.close();
+    if (!targetFileExists) {
+        Q_UNUSED(targetFile.remove())
+    }
+
+    if (status == CopyStatus::Cancelled) {
+        errorDescription.setBase(QT_TR_NOOP("file copying was cancelled"));
+    }
+
+    QNINFO("utility", "Failed to copy file: " << errorDescription);
+    return false;
+}
+
+} // namespace quentier
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_UTILITY_FILE_COPY_H
+#define QUENTIER_LIB_UTILITY_FILE_COPY_H
+
+#include <quentier/types/ErrorString.h>
+
+#include <QString>
+
+#include <functional>
+
+namespace quentier {
+
+/**
+ * Callback receiving the number of bytes copied so far; returning false from
+ * it cancels the copying
+ */
+using FileCopyProgressCallback = std::function<bool(qint64 bytesCopied)>;
+
+/**
+ * @brief copyFile function copies the file using the cheapest way supported
+ * by the platform and the filesystem: copy-on-write clone of the file
+ * (reflink) if possible, in-kernel copy via copy_file_range on Linux if not
+ * and streamed copy otherwise.
+ *
+ * If target file already exists, it is overwritten in place. If copying
+ * fails or is cancelled, partially written target file is removed unless it
+ * existed before the copying.
+ *
+ * @param sourceFilePath        Path to the file to copy
+ * @param targetFilePath        Path to the copy
+ * @param progressCallback      Callback notified about the progress of
+ *                              copying, can be empty
+ * @param errorDescription      Textual description of the error if copying
+ *                              failed or was cancelled
+ * @return                      True if the file was copied successfully,
+ *                              false otherwise
+ */
+bool copyFile(
+    const QString & sourceFilePath, const QString & targetFilePath,
+    const FileCopyProgressCallback & progressCallback,
+    ErrorString & errorDescription);
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_UTILITY_FILE_COPY_H
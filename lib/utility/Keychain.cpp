@@ -18,6 +18,8 @@
 
 #include "Keychain.h"
 
+#include "Log.h"
+
 #include <lib/utility/VersionInfo.h>
 
 #include <quentier/logging/QuentierLogger.h>
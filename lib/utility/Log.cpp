@@ -1,5 +1,5 @@
 /*
- * Copyright 2020 Dmitry Ivanov
+ * Copyright 2020-2021 Dmitry Ivanov
  *
  * This file is part of Quentier.
  *
@@ -17,13 +17,392 @@
  */
 
 #include "Log.h"
+#include "StructuredLog.h"
 
 #include <lib/preferences/keys/Logging.h>
 
 #include <quentier/utility/ApplicationSettings.h>
 
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QThread>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Must be a power of two
+#define ASYNC_LOG_WRITER_BUFFER_SIZE (16384)
+
+// 100 Mb
+#define STRUCTURED_LOG_MAX_FILE_SIZE (104857600)
+
+// Max time for which entries written synchronously can stay in the structured
+// log writer's buffer
+#define STRUCTURED_LOG_FLUSH_INTERVAL_MSEC (1000)
+
 namespace quentier {
 
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct LogComponentLevelRegistry
+{
+    QMutex m_mutex;
+    std::vector<LogComponentLevel *> m_componentLevels;
+    QRegularExpression m_filter;
+};
+
+LogComponentLevelRegistry & logComponentLevelRegistry()
+{
+    static LogComponentLevelRegistry registry;
+    return registry;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct StructuredLog
+{
+    QMutex m_mutex;
+    std::unique_ptr<StructuredLogWriter> m_pWriter;
+};
+
+StructuredLog & structuredLog()
+{
+    static StructuredLog log;
+    return log;
+}
+
+std::atomic<bool> gStructuredLogEnabled{false};
+std::atomic<qint64> gStructuredLogLastFlushTimestamp{0};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct LogRecord
+{
+    qint64 m_timestamp = 0;
+    QString m_sourceFileName;
+    int m_sourceFileLineNumber = 0;
+    const char * m_component = nullptr;
+
+    // Used instead of m_component for components which are not string
+    // literals
+    QString m_componentName;
+
+    QString m_message;
+    LogLevel m_logLevel = LogLevel::Trace;
+};
+
+void writeLogRecord(const LogRecord & record)
+{
+    const QString component = record.m_component
+        ? QString::fromUtf8(record.m_component)
+        : record.m_componentName;
+
+    QuentierAddLogEntry(
+        record.m_sourceFileName, record.m_sourceFileLineNumber, component,
+        record.m_message, record.m_logLevel);
+
+    if (!gStructuredLogEnabled.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    auto & log = structuredLog();
+    QMutexLocker lock(&log.m_mutex);
+
+    if (log.m_pWriter) {
+        log.m_pWriter->addEntry(
+            record.m_timestamp, record.m_sourceFileName,
+            record.m_sourceFileLineNumber, component, record.m_message,
+            record.m_logLevel);
+    }
+}
+
+void flushStructuredLog()
+{
+    if (!gStructuredLogEnabled.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    auto & log = structuredLog();
+    QMutexLocker lock(&log.m_mutex);
+
+    if (log.m_pWriter) {
+        log.m_pWriter->flush();
+    }
+
+    gStructuredLogLastFlushTimestamp.store(
+        QDateTime::currentMSecsSinceEpoch(), std::memory_order_relaxed);
+}
+
+/**
+ * Entries written synchronously are flushed in batches: the writer flushes
+ * its buffer by itself once enough entries are accumulated and the rest are
+ * flushed by the first entry after the flush interval has passed. Errors are
+ * flushed right away as they often precede crashes.
+ */
+void flushStructuredLogIfNecessary(
+    const qint64 timestamp, const LogLevel logLevel)
+{
+    if ((logLevel == LogLevel::Error) ||
+        (timestamp - gStructuredLogLastFlushTimestamp.load(
+                         std::memory_order_relaxed) >=
+         STRUCTURED_LOG_FLUSH_INTERVAL_MSEC))
+    {
+        flushStructuredLog();
+    }
+}
+
+/**
+ * Bounded multi producer multi consumer queue which doesn't use locks: each
+ * cell carries a sequence number telling whether the cell is ready to be
+ * written to or read from at the given position
+ */
+class LogRecordRingBuffer
+{
+public:
+    LogRecordRingBuffer() : m_cells(ASYNC_LOG_WRITER_BUFFER_SIZE)
+    {
+        for (size_t i = 0; i < m_cells.size(); ++i) {
+            m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(LogRecord && record)
+    {
+        Cell * pCell = nullptr;
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            pCell = &m_cells[pos & m_mask];
+
+            const size_t sequence =
+                pCell->m_sequence.load(std::memory_order_acquire);
+
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                // The buffer is full
+                return false;
+            }
+            else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        pCell->m_record = std::move(record);
+        pCell->m_sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(LogRecord & record)
+    {
+        Cell * pCell = nullptr;
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            pCell = &m_cells[pos & m_mask];
+
+            const size_t sequence =
+                pCell->m_sequence.load(std::memory_order_acquire);
+
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                static_cast<std::ptrdiff_t>(pos + 1);
+
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                // The buffer is empty
+                return false;
+            }
+            else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        record = std::move(pCell->m_record);
+        pCell->m_record = LogRecord();
+
+        pCell->m_sequence.store(
+            pos + m_mask + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return m_dequeuePos.load() == m_enqueuePos.load();
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> m_sequence{0};
+        LogRecord m_record;
+    };
+
+    std::vector<Cell> m_cells;
+    const size_t m_mask = ASYNC_LOG_WRITER_BUFFER_SIZE - 1;
+
+    std::atomic<size_t> m_enqueuePos{0};
+    std::atomic<size_t> m_dequeuePos{0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class AsyncLogWriter final : public QThread
+{
+public:
+    /**
+     * @param record        The record to be written by the writer thread
+     * @return              False if the queue is full, true otherwise
+     */
+    bool addRecord(LogRecord && record)
+    {
+        if (!m_buffer.push(std::move(record))) {
+            return false;
+        }
+
+        // Only the first producer after the writer went idle needs to wake
+        // it up, the rest of producers don't touch the semaphore
+        if (m_idle.exchange(false)) {
+            m_wakeUpSemaphore.release();
+        }
+
+        return true;
+    }
+
+    void countDroppedRecord()
+    {
+        Q_UNUSED(m_droppedRecordsCount.fetch_add(1))
+    }
+
+    /**
+     * Writes all queued records in the calling thread and flushes them to
+     * the disk. The calling thread doesn't wait for the writer thread to get
+     * to the records, at most for it to finish writing a single record.
+     */
+    void drain()
+    {
+        {
+            QMutexLocker lock(&m_writeMutex);
+
+            LogRecord record;
+            while (m_buffer.pop(record)) {
+                writeLogRecord(record);
+            }
+        }
+
+        flushStructuredLog();
+    }
+
+    void stop()
+    {
+        m_stopped.store(true);
+        m_wakeUpSemaphore.release();
+        Q_UNUSED(wait())
+    }
+
+protected:
+    virtual void run() override
+    {
+        while (!m_stopped.load()) {
+            if (writePendingRecords()) {
+                continue;
+            }
+
+            m_idle.store(true);
+
+            // Some record might have been added after the last check but
+            // before the idle flag was set
+            if (!m_buffer.isEmpty()) {
+                if (!m_idle.exchange(false)) {
+                    // The producer has already released the semaphore
+                    m_wakeUpSemaphore.acquire();
+                }
+
+                continue;
+            }
+
+            m_wakeUpSemaphore.acquire();
+        }
+
+        Q_UNUSED(writePendingRecords())
+    }
+
+private:
+    bool writePendingRecords()
+    {
+        bool wroteRecords = false;
+
+        LogRecord record;
+        while (true) {
+            // Records are popped and written under the lock one by one so
+            // that the records drained by producers are not written out of
+            // order and producers never wait for more than one record
+            QMutexLocker lock(&m_writeMutex);
+            if (!m_buffer.pop(record)) {
+                break;
+            }
+
+            writeLogRecord(record);
+            wroteRecords = true;
+        }
+
+        if (wroteRecords) {
+            flushStructuredLog();
+        }
+
+        const quint64 droppedRecordsCount = m_droppedRecordsCount.exchange(0);
+        if (droppedRecordsCount != 0) {
+            QNWARNING(
+                "utility:log",
+                "Log buffer overflow, dropped " << droppedRecordsCount
+                                                << " log entries");
+        }
+
+        return wroteRecords;
+    }
+
+private:
+    LogRecordRingBuffer m_buffer;
+
+    QSemaphore m_wakeUpSemaphore;
+    std::atomic<bool> m_idle{false};
+    std::atomic<bool> m_stopped{false};
+
+    std::atomic<quint64> m_droppedRecordsCount{0};
+
+    // Guards popping and writing of records which is done both by the writer
+    // thread and by producers draining the queue
+    QMutex m_writeMutex;
+};
+
+// The writer is never deleted as producers might still access it from other
+// threads after it is stopped
+AsyncLogWriter * gAsyncLogWriter = nullptr;
+std::atomic<bool> gAsyncLogWriterRunning{false};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
 QString restoreLogFilterByComponent()
 {
     ApplicationSettings appSettings;
@@ -49,4 +428,216 @@ void setLogFilterByComponent(const QString & filter)
     appSettings.endGroup();
 }
 
+void applyMinLogLevel(const LogLevel logLevel)
+{
+    QuentierSetMinLogLevel(logLevel);
+
+    auto & registry = logComponentLevelRegistry();
+    QMutexLocker lock(&registry.m_mutex);
+
+    for (auto * pComponentLevel: registry.m_componentLevels) {
+        pComponentLevel->update(logLevel, registry.m_filter);
+    }
+}
+
+void applyLogComponentFilter(const QRegularExpression & filter)
+{
+    QuentierSetLogComponentFilter(filter);
+
+    auto & registry = logComponentLevelRegistry();
+    QMutexLocker lock(&registry.m_mutex);
+
+    registry.m_filter = filter;
+
+    const LogLevel minLogLevel = QuentierMinLogLevel();
+    for (auto * pComponentLevel: registry.m_componentLevels) {
+        pComponentLevel->update(minLogLevel, filter);
+    }
+}
+
+bool restoreStructuredLogEnabled()
+{
+    ApplicationSettings appSettings;
+    appSettings.beginGroup(preferences::keys::loggingGroup);
+
+    const bool enabled =
+        appSettings.value(preferences::keys::enableStructuredLog).toBool();
+
+    appSettings.endGroup();
+
+    return enabled;
+}
+
+void applyStructuredLogEnabled(const bool enabled)
+{
+    auto & log = structuredLog();
+    QMutexLocker lock(&log.m_mutex);
+
+    if (enabled == static_cast<bool>(log.m_pWriter)) {
+        return;
+    }
+
+    if (!enabled) {
+        gStructuredLogEnabled.store(false, std::memory_order_release);
+        log.m_pWriter.reset();
+        return;
+    }
+
+    log.m_pWriter = std::make_unique<StructuredLogWriter>(
+        QuentierLogFilesDirPath() + QStringLiteral("/") +
+            structuredLogFileName(),
+        STRUCTURED_LOG_MAX_FILE_SIZE);
+
+    if (!log.m_pWriter->isOpen()) {
+        log.m_pWriter.reset();
+        QNWARNING("utility:log", "Failed to open the structured log file");
+        return;
+    }
+
+    gStructuredLogEnabled.store(true, std::memory_order_release);
+}
+
+void startAsyncLogWriter()
+{
+    if (gAsyncLogWriterRunning.load()) {
+        return;
+    }
+
+    if (!gAsyncLogWriter) {
+        gAsyncLogWriter = new AsyncLogWriter;
+    }
+
+    // Producers of errors drain the queue by themselves so the writer runs at
+    // normal priority in order not to keep them waiting behind a backlog
+    gAsyncLogWriter->start(QThread::NormalPriority);
+    gAsyncLogWriterRunning.store(true);
+}
+
+void stopAsyncLogWriter()
+{
+    if (!gAsyncLogWriterRunning.exchange(false)) {
+        return;
+    }
+
+    gAsyncLogWriter->stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+LogComponentLevel::LogComponentLevel(const char * component) :
+    m_component(component), m_minLogLevel(std::numeric_limits<int>::max())
+{
+    auto & registry = logComponentLevelRegistry();
+    QMutexLocker lock(&registry.m_mutex);
+
+    update(QuentierMinLogLevel(), registry.m_filter);
+    registry.m_componentLevels.push_back(this);
+}
+
+LogComponentLevel::~LogComponentLevel()
+{
+    auto & registry = logComponentLevelRegistry();
+    QMutexLocker lock(&registry.m_mutex);
+
+    auto & componentLevels = registry.m_componentLevels;
+    componentLevels.erase(
+        std::remove(componentLevels.begin(), componentLevels.end(), this),
+        componentLevels.end());
+}
+
+void LogComponentLevel::update(
+    const LogLevel minLogLevel, const QRegularExpression & filter)
+{
+    const bool passesFilter = filter.pattern().isEmpty() ||
+        filter.match(QString::fromUtf8(m_component)).hasMatch();
+
+    m_minLogLevel.store(
+        passesFilter ? static_cast<int>(minLogLevel)
+                     : std::numeric_limits<int>::max(),
+        std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+void addLogRecord(LogRecord && record)
+{
+    const LogLevel logLevel = record.m_logLevel;
+
+    // The logger stamps the time of the entry when it is written so entries
+    // of all levels go through the same queue to keep the order in which they
+    // were added; entries logged by the writer thread itself are written
+    // right away as the writer can't wait for itself
+    if (gAsyncLogWriterRunning.load(std::memory_order_acquire) &&
+        (QThread::currentThread() != gAsyncLogWriter))
+    {
+        if (gAsyncLogWriter->addRecord(std::move(record))) {
+            // Errors often precede crashes so they should reach the disk
+            // before the producer goes on; the producer writes the queued
+            // records itself rather than waits for the writer thread
+            if (logLevel == LogLevel::Error) {
+                gAsyncLogWriter->drain();
+            }
+
+            return;
+        }
+
+        // The queue is full: trace and debug entries are dropped while
+        // entries of higher levels are written out of order rather than lost
+        if ((logLevel == LogLevel::Trace) || (logLevel == LogLevel::Debug)) {
+            gAsyncLogWriter->countDroppedRecord();
+            return;
+        }
+    }
+
+    writeLogRecord(record);
+    flushStructuredLogIfNecessary(record.m_timestamp, logLevel);
+}
+
+} // namespace
+
+bool isLogComponentActive(const QString & component, const LogLevel logLevel)
+{
+    if (static_cast<int>(logLevel) < static_cast<int>(QuentierMinLogLevel())) {
+        return false;
+    }
+
+    auto & registry = logComponentLevelRegistry();
+    QMutexLocker lock(&registry.m_mutex);
+
+    return registry.m_filter.pattern().isEmpty() ||
+        registry.m_filter.match(component).hasMatch();
+}
+
+void addComponentLogEntry(
+    QString sourceFileName, const int sourceFileLineNumber,
+    const char * component, QString message, const LogLevel logLevel)
+{
+    LogRecord record;
+    record.m_timestamp = QDateTime::currentMSecsSinceEpoch();
+    record.m_sourceFileName = std::move(sourceFileName);
+    record.m_sourceFileLineNumber = sourceFileLineNumber;
+    record.m_component = component;
+    record.m_message = std::move(message);
+    record.m_logLevel = logLevel;
+
+    addLogRecord(std::move(record));
+}
+
+void addComponentLogEntry(
+    QString sourceFileName, const int sourceFileLineNumber,
+    QString component, QString message, const LogLevel logLevel)
+{
+    LogRecord record;
+    record.m_timestamp = QDateTime::currentMSecsSinceEpoch();
+    record.m_sourceFileName = std::move(sourceFileName);
+    record.m_sourceFileLineNumber = sourceFileLineNumber;
+    record.m_componentName = std::move(component);
+    record.m_message = std::move(message);
+    record.m_logLevel = logLevel;
+
+    addLogRecord(std::move(record));
+}
+
 } // namespace quentier
@@ -1,5 +1,5 @@
 /*
- * Copyright 2020 Dmitry Ivanov
+ * Copyright 2020-2021 Dmitry Ivanov
  *
  * This file is part of Quentier.
  *
@@ -19,14 +19,194 @@
 #ifndef QUENTIER_LIB_UTILITY_LOG_H
 #define QUENTIER_LIB_UTILITY_LOG_H
 
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QDebug>
+#include <QRegularExpression>
 #include <QString>
 
+#include <atomic>
+#include <utility>
+
 namespace quentier {
 
 QString restoreLogFilterByComponent();
 
 void setLogFilterByComponent(const QString & filter);
 
+/**
+ * Sets min log level to the logger and updates the log levels cached
+ * by LogComponentLevel instances
+ */
+void applyMinLogLevel(const LogLevel logLevel);
+
+/**
+ * Sets filter by component to the logger and updates the log levels cached
+ * by LogComponentLevel instances
+ */
+void applyLogComponentFilter(const QRegularExpression & filter);
+
+bool restoreStructuredLogEnabled();
+
+/**
+ * Enables or disables writing the entries added via addComponentLogEntry into
+ * the structured log file along with the regular log, see StructuredLog.h.
+ * Since QN* macros are redefined below to go through addComponentLogEntry,
+ * the structured log receives all entries logged by Quentier itself; entries
+ * logged by libquentier internally only go to the regular log.
+ */
+void applyStructuredLogEnabled(const bool enabled);
+
+/**
+ * Starts the background thread writing log entries added via
+ * addComponentLogEntry; until it is started the entries are written
+ * synchronously
+ */
+void startAsyncLogWriter();
+
+/**
+ * Writes all pending log entries and stops the background log writer thread
+ */
+void stopAsyncLogWriter();
+
+/**
+ * @brief The LogComponentLevel class caches the min log level for a single log
+ * component considering both the logger's min log level and its filter by
+ * component so that checking whether the message should be logged at all
+ * takes a single atomic load, without formatting the message and matching
+ * the component against the regex.
+ *
+ * Instances are meant to be function local statics created by
+ * QUENTIER_COMPONENT_LOG macro, component must be a string literal.
+ */
+class LogComponentLevel
+{
+public:
+    explicit LogComponentLevel(const char * component);
+    ~LogComponentLevel();
+
+    bool isActive(const LogLevel logLevel) const
+    {
+        return static_cast<int>(logLevel) >=
+            m_minLogLevel.load(std::memory_order_relaxed);
+    }
+
+    void update(const LogLevel minLogLevel, const QRegularExpression & filter);
+
+private:
+    Q_DISABLE_COPY(LogComponentLevel)
+
+private:
+    const char * m_component;
+    std::atomic<int> m_minLogLevel;
+};
+
+/**
+ * Entries of all levels are passed to the background log writer thread if it
+ * is running so that they are written in the order in which they were added.
+ * The caller adding an error or fatal entry is blocked until the entry is
+ * written. If the writer's queue is full, trace and debug entries are dropped
+ * while entries of higher levels are written right away.
+ */
+void addComponentLogEntry(
+    QString sourceFileName, const int sourceFileLineNumber,
+    const char * component, QString message, const LogLevel logLevel);
+
+/**
+ * Overload for components which are not string literals
+ */
+void addComponentLogEntry(
+    QString sourceFileName, const int sourceFileLineNumber,
+    QString component, QString message, const LogLevel logLevel);
+
+/**
+ * Checks whether the entry of the component which is not a string literal
+ * passes the min log level and the filter by component; slower than
+ * LogComponentLevel::isActive
+ */
+bool isLogComponentActive(const QString & component, const LogLevel logLevel);
+
 } // namespace quentier
 
+/**
+ * Alternative to QNLOG macros for log entries in hot code paths: the check
+ * whether the entry passes the min log level and the filter by component is
+ * done before the message is formatted
+ */
+#define QUENTIER_COMPONENT_LOG(component, message, level)                      \
+    {                                                                          \
+        static quentier::LogComponentLevel quentierLogComponentLevel{          \
+            component};                                                        \
+        if (quentierLogComponentLevel.isActive(quentier::LogLevel::level)) {   \
+            QString quentierLogMessage;                                        \
+            {                                                                  \
+                QDebug quentierLogStream(&quentierLogMessage);                 \
+                quentierLogStream.nospace();                                   \
+                quentierLogStream.noquote();                                   \
+                quentierLogStream << message;                                  \
+            }                                                                  \
+            quentier::addComponentLogEntry(                                    \
+                QStringLiteral(__FILE__), __LINE__, component,                 \
+                std::move(quentierLogMessage), quentier::LogLevel::level);     \
+        }                                                                      \
+    }
+
+/**
+ * Same as QUENTIER_COMPONENT_LOG for components which are not string literals
+ */
+#define QUENTIER_DYNAMIC_COMPONENT_LOG(component, message, level)              \
+    {                                                                          \
+        const QString quentierLogComponent = component;                        \
+        if (quentier::isLogComponentActive(                                    \
+                quentierLogComponent, quentier::LogLevel::level))              \
+        {                                                                      \
+            QString quentierLogMessage;                                        \
+            {                                                                  \
+                QDebug quentierLogStream(&quentierLogMessage);                 \
+                quentierLogStream.nospace();                                   \
+                quentierLogStream.noquote();                                   \
+                quentierLogStream << message;                                  \
+            }                                                                  \
+            quentier::addComponentLogEntry(                                    \
+                QStringLiteral(__FILE__), __LINE__, quentierLogComponent,      \
+                std::move(quentierLogMessage), quentier::LogLevel::level);     \
+        }                                                                      \
+    }
+
+#define QCTRACE(component, message)                                            \
+    QUENTIER_COMPONENT_LOG(component, message, Trace)
+
+#define QCDEBUG(component, message)                                            \
+    QUENTIER_COMPONENT_LOG(component, message, Debug)
+
+#define QCINFO(component, message)                                             \
+    QUENTIER_COMPONENT_LOG(component, message, Info)
+
+#define QCWARNING(component, message)                                          \
+    QUENTIER_COMPONENT_LOG(component, message, Warning)
+
+#define QCERROR(component, message)                                            \
+    QUENTIER_COMPONENT_LOG(component, message, Error)
+
+// There's no dedicated log level for fatal errors, just like with QNFATAL
+#define QCFATAL(component, message)                                            \
+    QUENTIER_COMPONENT_LOG(component, message, Error)
+
+// Logger's own macros are redirected so that all entries logged by Quentier
+// go through the same queue, keep their order and reach the structured log
+
+#undef QNTRACE
+#undef QNDEBUG
+#undef QNINFO
+#undef QNWARNING
+#undef QNERROR
+#undef QNFATAL
+
+#define QNTRACE(component, message) QCTRACE(component, message)
+#define QNDEBUG(component, message) QCDEBUG(component, message)
+#define QNINFO(component, message) QCINFO(component, message)
+#define QNWARNING(component, message) QCWARNING(component, message)
+#define QNERROR(component, message) QCERROR(component, message)
+#define QNFATAL(component, message) QCFATAL(component, message)
+
 #endif // QUENTIER_LIB_UTILITY_LOG_H
@@ -18,6 +18,8 @@
 
 #include "StartAtLogin.h"
 
+#include "Log.h"
+
 #include <lib/preferences/defaults/StartAtLogin.h>
 #include <lib/preferences/keys/StartAtLogin.h>
 
@@ -0,0 +1,646 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StructuredLog.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QtEndian>
+
+#include <algorithm>
+#include <limits>
+
+#define STRUCTURED_LOG_MAGIC "QNLOGBIN"
+#define STRUCTURED_LOG_MAGIC_SIZE (8)
+#define STRUCTURED_LOG_VERSION (1)
+#define STRUCTURED_LOG_HEADER_SIZE (STRUCTURED_LOG_MAGIC_SIZE + 2)
+
+// Record size followed by record type
+#define STRUCTURED_LOG_RECORD_HEADER_SIZE (5)
+
+// Anything larger than this is considered the sign of the file corruption
+#define STRUCTURED_LOG_MAX_RECORD_SIZE (64 * 1024 * 1024)
+
+#define STRUCTURED_LOG_WRITER_BUFFER_SIZE (64 * 1024)
+
+// Milliseconds
+#define STRUCTURED_LOG_UTC_OFFSET_UPDATE_INTERVAL (60000)
+
+namespace quentier {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+
+enum class RecordType : quint8
+{
+    StringDefinition = 1,
+    LogEntry = 2
+};
+
+void setupDataStream(QDataStream & strm)
+{
+    strm.setVersion(QDataStream::Qt_5_5);
+    strm.setByteOrder(QDataStream::BigEndian);
+}
+
+bool isValidLogLevel(const quint8 logLevel)
+{
+    switch (static_cast<LogLevel>(logLevel)) {
+    case LogLevel::Trace:
+    case LogLevel::Debug:
+    case LogLevel::Info:
+    case LogLevel::Warning:
+    case LogLevel::Error:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+QString structuredLogFileName()
+{
+    return QStringLiteral("Quentier-log.qnlb");
+}
+
+bool isStructuredLogFile(QIODevice & device)
+{
+    if (!device.isReadable()) {
+        return false;
+    }
+
+    return device.peek(STRUCTURED_LOG_MAGIC_SIZE) ==
+        QByteArray(STRUCTURED_LOG_MAGIC);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+StructuredLogWriter::StructuredLogWriter(
+    const QString & filePath, const qint64 maxFileSize) :
+    m_file(filePath),
+    m_maxFileSize(maxFileSize)
+{
+    m_buffer.reserve(STRUCTURED_LOG_WRITER_BUFFER_SIZE);
+    open();
+}
+
+StructuredLogWriter::~StructuredLogWriter()
+{
+    flush();
+}
+
+bool StructuredLogWriter::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+void StructuredLogWriter::addEntry(
+    const qint64 timestamp, const QString & sourceFileName,
+    const int sourceFileLineNumber, const QString & component,
+    const QString & message, const LogLevel logLevel)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    if ((timestamp < m_utcOffsetTimestamp) ||
+        (timestamp - m_utcOffsetTimestamp >=
+         STRUCTURED_LOG_UTC_OFFSET_UPDATE_INTERVAL))
+    {
+        m_utcOffsetTimestamp = timestamp;
+        m_utcOffset = QDateTime::fromMSecsSinceEpoch(timestamp).offsetFromUtc();
+    }
+
+    // String definitions must precede the entry referring to them
+    const quint32 sourceFileNameIndex = stringIndex(sourceFileName);
+    const quint32 componentIndex = stringIndex(component);
+
+    beginRecord(static_cast<quint8>(RecordType::LogEntry));
+    {
+        QDataStream strm(&m_buffer, QIODevice::Append);
+        setupDataStream(strm);
+
+        strm << timestamp << m_utcOffset << sourceFileNameIndex
+             << static_cast<qint32>(sourceFileLineNumber) << componentIndex
+             << static_cast<quint8>(logLevel) << message.toUtf8();
+    }
+    endRecord();
+
+    if (m_buffer.size() >= STRUCTURED_LOG_WRITER_BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void StructuredLogWriter::flush()
+{
+    if (!m_file.isOpen() || m_buffer.isEmpty()) {
+        return;
+    }
+
+    if (m_file.size() < m_fileSize) {
+        // The file was wiped out, for example from the log viewer
+        startNewFile();
+    }
+    else if (m_fileSize + m_buffer.size() > m_maxFileSize) {
+        rotate();
+        if (!m_file.isOpen()) {
+            return;
+        }
+    }
+
+    const qint64 bytesWritten = m_file.write(m_buffer);
+    if (bytesWritten > 0) {
+        m_fileSize += bytesWritten;
+    }
+
+    Q_UNUSED(m_file.flush())
+    m_buffer.resize(0);
+}
+
+void StructuredLogWriter::open()
+{
+    if (m_file.exists() && (m_file.size() > 0)) {
+        // Need to know the strings defined in the existing file in order to
+        // keep appending to it
+        if (m_file.open(QIODevice::ReadOnly)) {
+            StructuredLogReader reader(m_file);
+            ErrorString errorDescription;
+            const bool res = reader.seekToEnd(errorDescription);
+            m_file.close();
+
+            if (res && (reader.pos() > 0) && (reader.pos() < m_maxFileSize)) {
+                for (int i = 0, count = reader.stringCount(); i < count; ++i) {
+                    const QString str = reader.string(static_cast<quint32>(i));
+                    m_stringIndexes[str] = static_cast<quint32>(i);
+                    m_strings << str;
+                }
+
+                m_fileSize = reader.pos();
+
+                // Dropping the incomplete record which is left if the app
+                // crashed while writing it
+                if (m_file.size() > m_fileSize) {
+                    Q_UNUSED(m_file.resize(m_fileSize))
+                }
+
+                if (m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+                    return;
+                }
+            }
+        }
+
+        // The existing file can't be appended to, moving it out of the way
+        m_stringIndexes.clear();
+        m_strings.clear();
+        rotate();
+        return;
+    }
+
+    if (m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        startNewFile();
+    }
+}
+
+void StructuredLogWriter::startNewFile()
+{
+    Q_UNUSED(m_file.resize(0))
+    m_fileSize = 0;
+
+    QByteArray pendingData;
+    pendingData.swap(m_buffer);
+
+    m_buffer.reserve(STRUCTURED_LOG_WRITER_BUFFER_SIZE);
+    m_buffer.append(STRUCTURED_LOG_MAGIC, STRUCTURED_LOG_MAGIC_SIZE);
+    {
+        QDataStream strm(&m_buffer, QIODevice::Append);
+        setupDataStream(strm);
+        strm << static_cast<quint16>(STRUCTURED_LOG_VERSION);
+    }
+
+    for (int i = 0, count = m_strings.size(); i < count; ++i) {
+        appendStringDefinition(static_cast<quint32>(i), m_strings[i]);
+    }
+
+    m_buffer.append(pendingData);
+}
+
+void StructuredLogWriter::rotate()
+{
+    m_file.close();
+
+    const QFileInfo fileInfo(m_file.fileName());
+
+    const QString previousFilePath = fileInfo.absolutePath() +
+        QStringLiteral("/") + fileInfo.completeBaseName() +
+        QStringLiteral("-previous.") + fileInfo.suffix();
+
+    Q_UNUSED(QFile::remove(previousFilePath))
+    Q_UNUSED(QFile::rename(fileInfo.absoluteFilePath(), previousFilePath))
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        m_buffer.resize(0);
+        return;
+    }
+
+    startNewFile();
+}
+
+quint32 StructuredLogWriter::stringIndex(const QString & str)
+{
+    const auto it = m_stringIndexes.constFind(str);
+    if (it != m_stringIndexes.constEnd()) {
+        return it.value();
+    }
+
+    const auto index = static_cast<quint32>(m_strings.size());
+    m_stringIndexes[str] = index;
+    m_strings << str;
+
+    appendStringDefinition(index, str);
+    return index;
+}
+
+void StructuredLogWriter::appendStringDefinition(
+    const quint32 index, const QString & str)
+{
+    beginRecord(static_cast<quint8>(RecordType::StringDefinition));
+    {
+        QDataStream strm(&m_buffer, QIODevice::Append);
+        setupDataStream(strm);
+        strm << index << str.toUtf8();
+    }
+    endRecord();
+}
+
+void StructuredLogWriter::beginRecord(const quint8 recordType)
+{
+    m_currentRecordStart = m_buffer.size();
+
+    // The size is filled in when the record is complete
+    m_buffer.append(STRUCTURED_LOG_RECORD_HEADER_SIZE - 1, '\0');
+    m_buffer.append(static_cast<char>(recordType));
+}
+
+void StructuredLogWriter::endRecord()
+{
+    const auto payloadSize = static_cast<quint32>(
+        m_buffer.size() - m_currentRecordStart -
+        STRUCTURED_LOG_RECORD_HEADER_SIZE);
+
+    qToBigEndian(
+        payloadSize,
+        reinterpret_cast<uchar *>(m_buffer.data() + m_currentRecordStart));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+StructuredLogReader::StructuredLogReader(QIODevice & device) : m_device(device)
+{}
+
+bool StructuredLogReader::seek(
+    const qint64 pos, ErrorString & errorDescription)
+{
+    if (!readHeaderIfNecessary(errorDescription)) {
+        return false;
+    }
+
+    if (m_scannedPos == 0) {
+        // The header is not written yet
+        m_pos = 0;
+        return true;
+    }
+
+    const qint64 targetPos =
+        std::max(pos, static_cast<qint64>(STRUCTURED_LOG_HEADER_SIZE));
+
+    if (!scanUntil(targetPos, errorDescription)) {
+        return false;
+    }
+
+    if (m_scannedPos < targetPos) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to read the structured log file: the position "
+                       "is beyond the last complete record"));
+        errorDescription.details() = QString::number(pos);
+        return false;
+    }
+
+    m_pos = targetPos;
+    return true;
+}
+
+bool StructuredLogReader::seekToEnd(ErrorString & errorDescription)
+{
+    if (!readHeaderIfNecessary(errorDescription)) {
+        return false;
+    }
+
+    if (m_scannedPos == 0) {
+        // The header is not written yet
+        m_pos = 0;
+        return true;
+    }
+
+    if (!scanUntil(std::numeric_limits<qint64>::max(), errorDescription)) {
+        return false;
+    }
+
+    m_pos = m_scannedPos;
+    return true;
+}
+
+StructuredLogReader::Status StructuredLogReader::readEntry(
+    StructuredLogEntry & entry, ErrorString & errorDescription)
+{
+    if (!readHeaderIfNecessary(errorDescription)) {
+        return Status::Error;
+    }
+
+    if (m_scannedPos == 0) {
+        return Status::EndOfFile;
+    }
+
+    m_pos = std::max(m_pos, static_cast<qint64>(STRUCTURED_LOG_HEADER_SIZE));
+
+    if (!m_device.seek(m_pos)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to read the structured log file: failed "
+                       "to seek at position"));
+        errorDescription.details() = QString::number(m_pos);
+        return Status::Error;
+    }
+
+    quint8 recordType = 0;
+    QByteArray payload;
+    while (true) {
+        const auto status =
+            readRecord(true, recordType, payload, errorDescription);
+
+        if (status != Status::Entry) {
+            return status;
+        }
+
+        m_pos = m_device.pos();
+
+        const bool newRecord = (m_pos > m_scannedPos);
+        if (newRecord) {
+            m_scannedPos = m_pos;
+        }
+
+        if (recordType == static_cast<quint8>(RecordType::StringDefinition)) {
+            if (newRecord &&
+                !processStringDefinition(payload, errorDescription))
+            {
+                return Status::Error;
+            }
+
+            continue;
+        }
+
+        if (recordType == static_cast<quint8>(RecordType::LogEntry)) {
+            if (!parseEntry(payload, entry, errorDescription)) {
+                return Status::Error;
+            }
+
+            return Status::Entry;
+        }
+
+        // Records of unknown types might be added by future versions of
+        // the format, just skipping them
+    }
+}
+
+qint64 StructuredLogReader::pos() const
+{
+    return m_pos;
+}
+
+QString StructuredLogReader::string(const quint32 index) const
+{
+    if (index >= static_cast<quint32>(m_strings.size())) {
+        return {};
+    }
+
+    return m_strings[static_cast<int>(index)];
+}
+
+int StructuredLogReader::stringCount() const
+{
+    return m_strings.size();
+}
+
+bool StructuredLogReader::readHeaderIfNecessary(ErrorString & errorDescription)
+{
+    if (m_scannedPos > m_device.size()) {
+        // The file was wiped out since the last read
+        m_pos = 0;
+        m_scannedPos = 0;
+        m_strings.clear();
+    }
+
+    if (m_scannedPos != 0) {
+        return true;
+    }
+
+    if (!m_device.seek(0)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to read the structured log file: failed "
+                       "to seek at the beginning"));
+        return false;
+    }
+
+    const QByteArray header = m_device.read(STRUCTURED_LOG_HEADER_SIZE);
+    if (header.size() < STRUCTURED_LOG_HEADER_SIZE) {
+        // The header is not written yet
+        return true;
+    }
+
+    if (!header.startsWith(QByteArray(STRUCTURED_LOG_MAGIC))) {
+        errorDescription.setBase(
+            QT_TR_NOOP("The file is not a structured log file"));
+        return false;
+    }
+
+    const auto version = qFromBigEndian<quint16>(
+        reinterpret_cast<const uchar *>(
+            header.constData() + STRUCTURED_LOG_MAGIC_SIZE));
+
+    if (version != STRUCTURED_LOG_VERSION) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Unsupported version of the structured log file"));
+        errorDescription.details() = QString::number(version);
+        return false;
+    }
+
+    m_scannedPos = STRUCTURED_LOG_HEADER_SIZE;
+    return true;
+}
+
+bool StructuredLogReader::scanUntil(
+    const qint64 pos, ErrorString & errorDescription)
+{
+    if (m_scannedPos >= pos) {
+        return true;
+    }
+
+    if (!m_device.seek(m_scannedPos)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to read the structured log file: failed "
+                       "to seek at position"));
+        errorDescription.details() = QString::number(m_scannedPos);
+        return false;
+    }
+
+    quint8 recordType = 0;
+    QByteArray payload;
+    while (m_scannedPos < pos) {
+        const auto status =
+            readRecord(false, recordType, payload, errorDescription);
+
+        if (status == Status::Error) {
+            return false;
+        }
+
+        if (status == Status::EndOfFile) {
+            break;
+        }
+
+        if ((recordType ==
+             static_cast<quint8>(RecordType::StringDefinition)) &&
+            !processStringDefinition(payload, errorDescription))
+        {
+            return false;
+        }
+
+        m_scannedPos = m_device.pos();
+    }
+
+    return true;
+}
+
+StructuredLogReader::Status StructuredLogReader::readRecord(
+    const bool readPayload, quint8 & recordType, QByteArray & payload,
+    ErrorString & errorDescription)
+{
+    const qint64 recordStart = m_device.pos();
+
+    const QByteArray recordHeader =
+        m_device.read(STRUCTURED_LOG_RECORD_HEADER_SIZE);
+
+    if (recordHeader.size() < STRUCTURED_LOG_RECORD_HEADER_SIZE) {
+        return Status::EndOfFile;
+    }
+
+    const auto payloadSize = qFromBigEndian<quint32>(
+        reinterpret_cast<const uchar *>(recordHeader.constData()));
+
+    if (payloadSize > STRUCTURED_LOG_MAX_RECORD_SIZE) {
+        errorDescription.setBase(
+            QT_TR_NOOP("The structured log file is corrupted: too large "
+                       "record size"));
+        errorDescription.details() = QString::number(recordStart);
+        return Status::Error;
+    }
+
+    recordType = static_cast<quint8>(recordHeader[4]);
+
+    const qint64 recordEnd = m_device.pos() + payloadSize;
+    if (recordEnd > m_device.size()) {
+        // The record is not completely written yet
+        return Status::EndOfFile;
+    }
+
+    // Log entries don't need to be parsed while looking for string definitions
+    if (readPayload ||
+        (recordType == static_cast<quint8>(RecordType::StringDefinition)))
+    {
+        payload = m_device.read(payloadSize);
+        if (payload.size() != static_cast<int>(payloadSize)) {
+            return Status::EndOfFile;
+        }
+    }
+    else if (!m_device.seek(recordEnd)) {
+        return Status::EndOfFile;
+    }
+
+    return Status::Entry;
+}
+
+bool StructuredLogReader::processStringDefinition(
+    const QByteArray & payload, ErrorString & errorDescription)
+{
+    QDataStream strm(payload);
+    setupDataStream(strm);
+
+    quint32 index = 0;
+    QByteArray str;
+    strm >> index >> str;
+
+    if ((strm.status() != QDataStream::Ok) ||
+        (index > static_cast<quint32>(m_strings.size())))
+    {
+        errorDescription.setBase(
+            QT_TR_NOOP("The structured log file is corrupted: failed "
+                       "to parse string definition"));
+        return false;
+    }
+
+    if (index == static_cast<quint32>(m_strings.size())) {
+        m_strings << QString::fromUtf8(str);
+    }
+    else {
+        m_strings[static_cast<int>(index)] = QString::fromUtf8(str);
+    }
+
+    return true;
+}
+
+bool StructuredLogReader::parseEntry(
+    const QByteArray & payload, StructuredLogEntry & entry,
+    ErrorString & errorDescription) const
+{
+    QDataStream strm(payload);
+    setupDataStream(strm);
+
+    quint8 logLevel = 0;
+    QByteArray message;
+
+    strm >> entry.m_timestamp >> entry.m_utcOffset >>
+        entry.m_sourceFileNameIndex >> entry.m_sourceFileLineNumber >>
+        entry.m_componentIndex >> logLevel >> message;
+
+    if ((strm.status() != QDataStream::Ok) || !isValidLogLevel(logLevel))
+    {
+        errorDescription.setBase(
+            QT_TR_NOOP("The structured log file is corrupted: failed "
+                       "to parse log entry"));
+        return false;
+    }
+
+    entry.m_logLevel = static_cast<LogLevel>(logLevel);
+    entry.m_message = QString::fromUtf8(message);
+    return true;
+}
+
+} // namespace quentier
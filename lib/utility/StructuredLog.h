@@ -0,0 +1,217 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_UTILITY_STRUCTURED_LOG_H
+#define QUENTIER_LIB_UTILITY_STRUCTURED_LOG_H
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+namespace quentier {
+
+/**
+ * Structured log file starts with a header consisting of the magic bytes and
+ * the format version. The header is followed by records, each record is
+ * prefixed with its size so that the reader never needs to scan the contents
+ * to find the boundaries of records. There are two types of records:
+ *  - string definition which binds an index to a source file name or
+ *    a component name
+ *  - log entry which has typed fields and refers to previously defined
+ *    strings by their indexes
+ */
+
+/**
+ * @return      The name of structured log file within the folder returned by
+ *              QuentierLogFilesDirPath
+ */
+QString structuredLogFileName();
+
+/**
+ * @return      True if the contents of the device start with the structured
+ *              log header, false otherwise. The position of the device is not
+ *              changed.
+ */
+bool isStructuredLogFile(QIODevice & device);
+
+struct StructuredLogEntry
+{
+    // Milliseconds since epoch
+    qint64 m_timestamp = 0;
+
+    // Offset from UTC in seconds of the timezone the entry was logged in
+    qint32 m_utcOffset = 0;
+
+    quint32 m_sourceFileNameIndex = 0;
+    qint32 m_sourceFileLineNumber = -1;
+    quint32 m_componentIndex = 0;
+    LogLevel m_logLevel = LogLevel::Info;
+    QString m_message;
+};
+
+/**
+ * @brief The StructuredLogWriter class appends log entries to the structured
+ * log file.
+ *
+ * Entries are accumulated in memory until flush is called or until enough
+ * of them are accumulated. If the file was wiped out or rotated, all known
+ * strings are defined anew at the beginning of the new file so that their
+ * indexes stay the same. The class is not thread-safe.
+ */
+class StructuredLogWriter
+{
+public:
+    explicit StructuredLogWriter(
+        const QString & filePath, const qint64 maxFileSize);
+
+    ~StructuredLogWriter();
+
+    bool isOpen() const;
+
+    void addEntry(
+        const qint64 timestamp, const QString & sourceFileName,
+        const int sourceFileLineNumber, const QString & component,
+        const QString & message, const LogLevel logLevel);
+
+    void flush();
+
+private:
+    void open();
+    void startNewFile();
+    void rotate();
+
+    quint32 stringIndex(const QString & str);
+    void appendStringDefinition(const quint32 index, const QString & str);
+
+    void beginRecord(const quint8 recordType);
+    void endRecord();
+
+private:
+    Q_DISABLE_COPY(StructuredLogWriter)
+
+private:
+    QFile m_file;
+    qint64 m_maxFileSize;
+
+    // The size of the file not counting the buffered data
+    qint64 m_fileSize = 0;
+
+    QHash<QString, quint32> m_stringIndexes;
+    QVector<QString> m_strings;
+
+    // Looking up the offset from UTC for each entry is expensive so it is
+    // only looked up once in a while
+    qint64 m_utcOffsetTimestamp = 0;
+    qint32 m_utcOffset = 0;
+
+    QByteArray m_buffer;
+    int m_currentRecordStart = 0;
+};
+
+/**
+ * @brief The StructuredLogReader class reads log entries from the structured
+ * log file.
+ *
+ * The reader remembers the strings defined in the file so that it can
+ * continue reading from any record boundary previously returned by pos
+ * method without parsing the whole file again. An incomplete record at the end
+ * of the file is not considered an error: the writer might have not finished
+ * writing it yet.
+ */
+class StructuredLogReader
+{
+public:
+    enum class Status
+    {
+        Entry = 0,
+        EndOfFile,
+        Error
+    };
+
+    /**
+     * @param device        The device to read from, must be open for reading
+     */
+    explicit StructuredLogReader(QIODevice & device);
+
+    /**
+     * Makes the reader continue reading from the specified position. Strings
+     * defined before this position are collected if they weren't collected
+     * yet.
+     */
+    bool seek(const qint64 pos, ErrorString & errorDescription);
+
+    /**
+     * Makes the reader continue reading after the last complete record
+     * in the file
+     */
+    bool seekToEnd(ErrorString & errorDescription);
+
+    Status readEntry(
+        StructuredLogEntry & entry, ErrorString & errorDescription);
+
+    /**
+     * @return      The position right after the last successfully read record
+     */
+    qint64 pos() const;
+
+    /**
+     * @return      The string defined in the file under the index or empty
+     *              string if there's no such index
+     */
+    QString string(const quint32 index) const;
+
+    int stringCount() const;
+
+private:
+    bool readHeaderIfNecessary(ErrorString & errorDescription);
+    bool scanUntil(const qint64 pos, ErrorString & errorDescription);
+
+    Status readRecord(
+        const bool readPayload, quint8 & recordType, QByteArray & payload,
+        ErrorString & errorDescription);
+
+    bool processStringDefinition(
+        const QByteArray & payload, ErrorString & errorDescription);
+
+    bool parseEntry(
+        const QByteArray & payload, StructuredLogEntry & entry,
+        ErrorString & errorDescription) const;
+
+private:
+    Q_DISABLE_COPY(StructuredLogReader)
+
+private:
+    QIODevice & m_device;
+    qint64 m_pos = 0;
+
+    // The position up to which the strings defined in the file are known
+    qint64 m_scannedPos = 0;
+
+    QVector<QString> m_strings;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_UTILITY_STRUCTURED_LOG_H
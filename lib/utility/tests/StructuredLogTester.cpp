@@ -0,0 +1,344 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StructuredLogTester.h"
+
+#include <lib/utility/StructuredLog.h>
+
+#include <QtTest/QtTest>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+
+#define STRUCTURED_LOG_TEST_MAX_FILE_SIZE (1024 * 1024)
+
+using namespace quentier;
+
+namespace {
+
+struct TestLogEntry
+{
+    qint64 m_timestamp = 0;
+    QString m_sourceFileName;
+    int m_sourceFileLineNumber = -1;
+    QString m_component;
+    QString m_message;
+    LogLevel m_logLevel = LogLevel::Info;
+};
+
+QVector<TestLogEntry> testLogEntries(
+    const int count, const qint64 firstTimestamp = 1600000000000)
+{
+    const QStringList sourceFileNames = QStringList()
+        << QStringLiteral("lib/model/note/NoteModel.cpp")
+        << QStringLiteral("lib/widget/NoteEditorWidget.cpp");
+
+    const QStringList components = QStringList()
+        << QStringLiteral("model:note") << QStringLiteral("widget:note_editor")
+        << QStringLiteral("synchronization");
+
+    const QVector<LogLevel> logLevels = QVector<LogLevel>()
+        << LogLevel::Trace << LogLevel::Debug << LogLevel::Info
+        << LogLevel::Warning << LogLevel::Error;
+
+    QVector<TestLogEntry> entries;
+    entries.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        TestLogEntry entry;
+        entry.m_timestamp = firstTimestamp + i * 17;
+        entry.m_sourceFileName = sourceFileNames[i % sourceFileNames.size()];
+        entry.m_sourceFileLineNumber = 100 + i;
+        entry.m_component = components[i % components.size()];
+
+        // Messages of different sizes with non-ASCII characters
+        entry.m_message = QStringLiteral("Message #") + QString::number(i) +
+            QString::fromUtf8(" \xC3\xA4\xC3\xB6\xC3\xBC ") +
+            QString(i % 7, QChar::fromLatin1('x'));
+
+        entry.m_logLevel = logLevels[i % logLevels.size()];
+        entries << entry;
+    }
+
+    return entries;
+}
+
+void addEntries(
+    StructuredLogWriter & writer, const QVector<TestLogEntry> & entries)
+{
+    for (const auto & entry: qAsConst(entries)) {
+        writer.addEntry(
+            entry.m_timestamp, entry.m_sourceFileName,
+            entry.m_sourceFileLineNumber, entry.m_component, entry.m_message,
+            entry.m_logLevel);
+    }
+}
+
+bool readEntries(
+    StructuredLogReader & reader, QVector<TestLogEntry> & entries,
+    QString & error)
+{
+    while (true) {
+        StructuredLogEntry entry;
+        ErrorString errorDescription;
+        const auto status = reader.readEntry(entry, errorDescription);
+        if (status == StructuredLogReader::Status::EndOfFile) {
+            return true;
+        }
+
+        if (status == StructuredLogReader::Status::Error) {
+            error = errorDescription.nonLocalizedString();
+            return false;
+        }
+
+        TestLogEntry testEntry;
+        testEntry.m_timestamp = entry.m_timestamp;
+        testEntry.m_sourceFileName =
+            reader.string(entry.m_sourceFileNameIndex);
+        testEntry.m_sourceFileLineNumber = entry.m_sourceFileLineNumber;
+        testEntry.m_component = reader.string(entry.m_componentIndex);
+        testEntry.m_message = entry.m_message;
+        testEntry.m_logLevel = entry.m_logLevel;
+        entries << testEntry;
+    }
+}
+
+bool compareEntries(
+    const QVector<TestLogEntry> & lhs, const QVector<TestLogEntry> & rhs,
+    QString & error)
+{
+    if (lhs.size() != rhs.size()) {
+        error = QStringLiteral("Different numbers of entries: ") +
+            QString::number(lhs.size()) + QStringLiteral(" vs ") +
+            QString::number(rhs.size());
+        return false;
+    }
+
+    for (int i = 0, size = lhs.size(); i < size; ++i) {
+        const auto & left = lhs[i];
+        const auto & right = rhs[i];
+
+        if ((left.m_timestamp != right.m_timestamp) ||
+            (left.m_sourceFileName != right.m_sourceFileName) ||
+            (left.m_sourceFileLineNumber != right.m_sourceFileLineNumber) ||
+            (left.m_component != right.m_component) ||
+            (left.m_message != right.m_message) ||
+            (left.m_logLevel != right.m_logLevel))
+        {
+            error = QStringLiteral("Entries differ at index ") +
+                QString::number(i) + QStringLiteral(": ") + left.m_message +
+                QStringLiteral(" vs ") + right.m_message;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+StructuredLogTester::StructuredLogTester(QObject * parent) : QObject(parent)
+{}
+
+StructuredLogTester::~StructuredLogTester() = default;
+
+void StructuredLogTester::testRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString filePath = dir.path() + QStringLiteral("/log.qnlb");
+    const auto entries = testLogEntries(100);
+
+    {
+        StructuredLogWriter writer(
+            filePath, STRUCTURED_LOG_TEST_MAX_FILE_SIZE);
+
+        QVERIFY(writer.isOpen());
+        addEntries(writer, entries);
+        writer.flush();
+    }
+
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(isStructuredLogFile(file));
+
+    StructuredLogReader reader(file);
+
+    QVector<TestLogEntry> readEntriesList;
+    QString error;
+    QVERIFY2(readEntries(reader, readEntriesList, error), qPrintable(error));
+    QVERIFY2(
+        compareEntries(entries, readEntriesList, error), qPrintable(error));
+
+    // Each source file name and component is defined only once
+    QCOMPARE(reader.stringCount(), 5);
+
+    // The reader can continue from a record boundary it returned before
+    ErrorString errorDescription;
+    QVERIFY(reader.seek(0, errorDescription));
+
+    StructuredLogEntry entry;
+    QVERIFY(
+        reader.readEntry(entry, errorDescription) ==
+        StructuredLogReader::Status::Entry);
+
+    const qint64 secondEntryPos = reader.pos();
+
+    StructuredLogReader anotherReader(file);
+    QVERIFY(anotherReader.seek(secondEntryPos, errorDescription));
+
+    readEntriesList.clear();
+    QVERIFY2(
+        readEntries(anotherReader, readEntriesList, error), qPrintable(error));
+    QVERIFY2(
+        compareEntries(entries.mid(1), readEntriesList, error),
+        qPrintable(error));
+}
+
+void StructuredLogTester::testTruncatedLastRecord()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString filePath = dir.path() + QStringLiteral("/log.qnlb");
+    const auto entries = testLogEntries(10);
+
+    {
+        StructuredLogWriter writer(
+            filePath, STRUCTURED_LOG_TEST_MAX_FILE_SIZE);
+
+        addEntries(writer, entries);
+        writer.flush();
+    }
+
+    // Simulating the app crashed in the middle of writing the last record
+    {
+        QFile file(filePath);
+        QVERIFY(file.resize(file.size() - 3));
+    }
+
+    {
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+
+        StructuredLogReader reader(file);
+
+        QVector<TestLogEntry> readEntriesList;
+        QString error;
+        QVERIFY2(
+            readEntries(reader, readEntriesList, error), qPrintable(error));
+
+        QVERIFY2(
+            compareEntries(
+                entries.mid(0, entries.size() - 1), readEntriesList, error),
+            qPrintable(error));
+    }
+
+    // The writer drops the incomplete record and keeps appending to the file
+    // using the strings defined in it
+    const auto moreEntries = testLogEntries(10, 1700000000000);
+    {
+        StructuredLogWriter writer(
+            filePath, STRUCTURED_LOG_TEST_MAX_FILE_SIZE);
+
+        QVERIFY(writer.isOpen());
+        addEntries(writer, moreEntries);
+        writer.flush();
+    }
+
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    StructuredLogReader reader(file);
+
+    QVector<TestLogEntry> readEntriesList;
+    QString error;
+    QVERIFY2(readEntries(reader, readEntriesList, error), qPrintable(error));
+
+    const auto expectedEntries =
+        entries.mid(0, entries.size() - 1) + moreEntries;
+
+    QVERIFY2(
+        compareEntries(expectedEntries, readEntriesList, error),
+        qPrintable(error));
+
+    QCOMPARE(reader.stringCount(), 5);
+}
+
+void StructuredLogTester::testWipedFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString filePath = dir.path() + QStringLiteral("/log.qnlb");
+
+    StructuredLogWriter writer(filePath, STRUCTURED_LOG_TEST_MAX_FILE_SIZE);
+    QVERIFY(writer.isOpen());
+
+    const auto entries = testLogEntries(100);
+    addEntries(writer, entries);
+    writer.flush();
+
+    // The file is read while being rewritten so no stale data is buffered
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    StructuredLogReader reader(file);
+
+    QVector<TestLogEntry> readEntriesList;
+    QString error;
+    QVERIFY2(readEntries(reader, readEntriesList, error), qPrintable(error));
+    QCOMPARE(readEntriesList.size(), entries.size());
+
+    // Wiping the file out the way the log viewer does it
+    {
+        QFile wipedFile(filePath);
+        QVERIFY(wipedFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    }
+
+    // The strings known to the writer are defined anew in the new file so
+    // the entries written after wiping refer to the right strings
+    const auto moreEntries = testLogEntries(3, 1700000000000);
+    addEntries(writer, moreEntries);
+    writer.flush();
+
+    QVERIFY(isStructuredLogFile(file));
+
+    // The reader notices the file was wiped out and starts over
+    readEntriesList.clear();
+    QVERIFY2(readEntries(reader, readEntriesList, error), qPrintable(error));
+    QVERIFY2(
+        compareEntries(moreEntries, readEntriesList, error),
+        qPrintable(error));
+
+    StructuredLogReader anotherReader(file);
+    readEntriesList.clear();
+    QVERIFY2(
+        readEntries(anotherReader, readEntriesList, error), qPrintable(error));
+    QVERIFY2(
+        compareEntries(moreEntries, readEntriesList, error),
+        qPrintable(error));
+}
+
+int main(int argc, char * argv[])
+{
+    QCoreApplication app(argc, argv);
+    StructuredLogTester tester;
+    return QTest::qExec(&tester, argc, argv);
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_UTILITY_TESTS_STRUCTURED_LOG_TESTER_H
+#define QUENTIER_LIB_UTILITY_TESTS_STRUCTURED_LOG_TESTER_H
+
+#include <QObject>
+
+class StructuredLogTester : public QObject
+{
+    Q_OBJECT
+public:
+    StructuredLogTester(QObject * parent = nullptr);
+
+    virtual ~StructuredLogTester() override;
+
+private Q_SLOTS:
+    void testRoundTrip();
+    void testTruncatedLastRecord();
+    void testWipedFile();
+};
+
+#endif // QUENTIER_LIB_UTILITY_TESTS_STRUCTURED_LOG_TESTER_H
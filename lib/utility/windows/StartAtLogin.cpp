@@ -19,6 +19,7 @@
 #include "../StartAtLogin.h"
 
 #include <lib/preferences/keys/StartAtLogin.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
@@ -21,6 +21,7 @@
 
 #include <lib/model/common/AbstractItemModel.h>
 #include <lib/preferences/keys/Files.h>
+#include <lib/utility/Log.h>
 #include <lib/widget/NoteFiltersManager.h>
 
 #include <quentier/logging/QuentierLogger.h>
@@ -28,11 +29,17 @@
 #include <quentier/utility/Compat.h>
 #include <quentier/utility/MessageBox.h>
 
+#include <QTimerEvent>
+
+// Delay between the first expand/collapse or selection change event and
+// the persistence of the accumulated changes
+#define PERSIST_PENDING_STATE_DELAY (1000)
+
 namespace quentier {
 
 #define MSLOG_BASE(level, message)                                             \
-    __QNLOG_BASE(                                                              \
-        (QString::fromUtf8("view:") + m_modelTypeName).toUtf8(),               \
+    QUENTIER_DYNAMIC_COMPONENT_LOG(                                            \
+        QString::fromUtf8("view:") + m_modelTypeName,                          \
         "[" << m_modelTypeName << "]: " << message, level)
 
 #define MSTRACE(message)   MSLOG_BASE(Trace, message)
@@ -58,14 +65,20 @@ AbstractNoteFilteringTreeView::AbstractNoteFilteringTreeView(
 
     QObject::connect(
         this, &AbstractNoteFilteringTreeView::expanded, this,
-        &AbstractNoteFilteringTreeView::onItemCollapsedOrExpanded);
+        &AbstractNoteFilteringTreeView::onItemExpanded);
 
     QObject::connect(
         this, &AbstractNoteFilteringTreeView::collapsed, this,
-        &AbstractNoteFilteringTreeView::onItemCollapsedOrExpanded);
+        &AbstractNoteFilteringTreeView::onItemCollapsed);
 }
 
-AbstractNoteFilteringTreeView::~AbstractNoteFilteringTreeView() = default;
+AbstractNoteFilteringTreeView::~AbstractNoteFilteringTreeView()
+{
+    // Subclasses are already destroyed at this point so only the pending
+    // selected items can be persisted here; the pending items state is
+    // persisted on hiding the view
+    persistPendingSelectedItems();
+}
 
 void AbstractNoteFilteringTreeView::setNoteFiltersManager(
     NoteFiltersManager & noteFiltersManager)
@@ -89,9 +102,14 @@ void AbstractNoteFilteringTreeView::setModel(QAbstractItemModel * pModel)
 
     auto * pPreviousModel = qobject_cast<AbstractItemModel *>(model());
     if (pPreviousModel) {
+        flushPendingState();
         pPreviousModel->disconnect(this);
     }
 
+    m_selectedItemLocalUids.clear();
+    m_selectedItemLocalUidsSet.clear();
+    m_selectedItemLocalUidsActual = false;
+
     m_itemLocalUidsPendingNoteFiltersManagerReadiness.clear();
     m_modelReady = false;
     m_trackingSelection = false;
@@ -106,6 +124,18 @@ void AbstractNoteFilteringTreeView::setModel(QAbstractItemModel * pModel)
 
     connectToModel(*pItemModel);
 
+    QObject::connect(
+        pItemModel, &AbstractItemModel::rowsAboutToBeRemoved, this,
+        &AbstractNoteFilteringTreeView::onModelAboutToChangeSelection);
+
+    QObject::connect(
+        pItemModel, &AbstractItemModel::layoutAboutToBeChanged, this,
+        &AbstractNoteFilteringTreeView::onModelAboutToChangeSelection);
+
+    QObject::connect(
+        pItemModel, &AbstractItemModel::modelAboutToBeReset, this,
+        &AbstractNoteFilteringTreeView::onModelAboutToChangeSelection);
+
     TreeView::setModel(pModel);
 
     auto * pOldSelectionModel = selectionModel();
@@ -218,8 +248,18 @@ void AbstractNoteFilteringTreeView::onAllItemsListed()
     m_trackingItemsState = true;
 }
 
+void AbstractNoteFilteringTreeView::onItemExpanded(const QModelIndex & index)
+{
+    onItemCollapsedOrExpanded(index, true);
+}
+
+void AbstractNoteFilteringTreeView::onItemCollapsed(const QModelIndex & index)
+{
+    onItemCollapsedOrExpanded(index, false);
+}
+
 void AbstractNoteFilteringTreeView::onItemCollapsedOrExpanded(
-    const QModelIndex & index)
+    const QModelIndex & index, const bool expanded)
 {
     MSTRACE(
         "AbstractNoteFilteringTreeView::onItemCollapsedOrExpanded: "
@@ -227,14 +267,16 @@ void AbstractNoteFilteringTreeView::onItemCollapsedOrExpanded(
         << ", row = " << index.row() << ", column = " << index.column()
         << ", parent: valid = " << (index.parent().isValid() ? "true" : "false")
         << ", row = " << index.parent().row()
-        << ", column = " << index.parent().column());
+        << ", column = " << index.parent().column()
+        << ", expanded = " << (expanded ? "true" : "false"));
 
     if (!m_trackingItemsState) {
         MSDEBUG("Not tracking the items state at this moment");
         return;
     }
 
-    saveItemsState();
+    updateItemExpandedState(index, expanded);
+    scheduleItemsStateSaving();
 }
 
 void AbstractNoteFilteringTreeView::onNoteFilterChanged()
@@ -361,6 +403,16 @@ void AbstractNoteFilteringTreeView::onNoteFiltersManagerReady()
     }
 }
 
+void AbstractNoteFilteringTreeView::onModelAboutToChangeSelection()
+{
+    MSTRACE("AbstractNoteFilteringTreeView::onModelAboutToChangeSelection");
+
+    // Removals and layout changes might alter the selection without
+    // the corresponding selection change notification so the incrementally
+    // maintained selected item local uids need to be collected anew
+    m_selectedItemLocalUidsActual = false;
+}
+
 void AbstractNoteFilteringTreeView::selectionChanged(
     const QItemSelection & selected, const QItemSelection & deselected)
 {
@@ -370,6 +422,30 @@ void AbstractNoteFilteringTreeView::selectionChanged(
     TreeView::selectionChanged(selected, deselected);
 }
 
+void AbstractNoteFilteringTreeView::hideEvent(QHideEvent * pEvent)
+{
+    flushPendingState();
+    TreeView::hideEvent(pEvent);
+}
+
+void AbstractNoteFilteringTreeView::timerEvent(QTimerEvent * pEvent)
+{
+    if (Q_UNLIKELY(!pEvent)) {
+        return;
+    }
+
+    if (pEvent->timerId() != m_persistPendingStateTimerId) {
+        TreeView::timerEvent(pEvent);
+        return;
+    }
+
+    MSDEBUG(
+        "AbstractNoteFilteringTreeView::timerEvent: persisting pending "
+        << "state");
+
+    flushPendingState();
+}
+
 void AbstractNoteFilteringTreeView::prepareForModelChange()
 {
     MSDEBUG("AbstractNoteFilteringTreeView::prepareForModelChange");
@@ -379,9 +455,12 @@ void AbstractNoteFilteringTreeView::prepareForModelChange()
         return;
     }
 
+    flushPendingState();
     saveItemsState();
+
     m_trackingSelection = false;
     m_trackingItemsState = false;
+    m_selectedItemLocalUidsActual = false;
 }
 
 void AbstractNoteFilteringTreeView::postProcessModelChange()
@@ -425,6 +504,10 @@ bool AbstractNoteFilteringTreeView::trackSelectionEnabled() const
 void AbstractNoteFilteringTreeView::setTrackSelectionEnabled(const bool enabled)
 {
     m_trackingSelection = enabled;
+
+    if (!enabled) {
+        m_selectedItemLocalUidsActual = false;
+    }
 }
 
 void AbstractNoteFilteringTreeView::saveAllItemsRootItemExpandedState(
@@ -444,6 +527,75 @@ void AbstractNoteFilteringTreeView::saveAllItemsRootItemExpandedState(
     appSettings.setValue(settingsKey, expanded);
 }
 
+void AbstractNoteFilteringTreeView::scheduleItemsStateSaving()
+{
+    m_hasPendingItemsState = true;
+    schedulePendingStateSaving();
+}
+
+void AbstractNoteFilteringTreeView::flushPendingState()
+{
+    if (m_persistPendingStateTimerId != 0) {
+        killTimer(m_persistPendingStateTimerId);
+        m_persistPendingStateTimerId = 0;
+    }
+
+    if (m_hasPendingItemsState) {
+        m_hasPendingItemsState = false;
+        saveItemsState();
+    }
+
+    persistPendingSelectedItems();
+}
+
+void AbstractNoteFilteringTreeView::schedulePendingStateSaving()
+{
+    if (m_persistPendingStateTimerId != 0) {
+        return;
+    }
+
+    m_persistPendingStateTimerId = startTimer(PERSIST_PENDING_STATE_DELAY);
+    if (Q_UNLIKELY(m_persistPendingStateTimerId == 0)) {
+        MSWARNING(
+            "Failed to start timer to postpone persisting the view's state, "
+            << "persisting it right away");
+        flushPendingState();
+    }
+}
+
+void AbstractNoteFilteringTreeView::persistPendingSelectedItems()
+{
+    if (!m_hasPendingSelectedItems) {
+        return;
+    }
+
+    m_hasPendingSelectedItems = false;
+
+    const auto & pending = m_pendingSelectedItems;
+
+    MSDEBUG(
+        "AbstractNoteFilteringTreeView::persistPendingSelectedItems: "
+        << pending.m_itemLocalUids.join(QStringLiteral(", ")));
+
+    ApplicationSettings appSettings(
+        pending.m_account, preferences::keys::files::userInterface);
+
+    appSettings.beginGroup(pending.m_groupKey);
+
+    appSettings.beginWriteArray(
+        pending.m_arrayKey, pending.m_itemLocalUids.size());
+
+    int i = 0;
+    for (const auto & itemLocalUid: qAsConst(pending.m_itemLocalUids)) {
+        appSettings.setArrayIndex(i);
+        appSettings.setValue(pending.m_itemKey, itemLocalUid);
+        ++i;
+    }
+
+    appSettings.endArray();
+    appSettings.endGroup();
+}
+
 void AbstractNoteFilteringTreeView::
     disconnectFromNoteFiltersManagerFilterChanged()
 {
@@ -467,25 +619,20 @@ void AbstractNoteFilteringTreeView::saveSelectedItems(
         "AbstractNoteFilteringTreeView::saveSelectedItems: "
         << itemLocalUids.join(QStringLiteral(", ")));
 
-    const QString groupKey = selectedItemsGroupKey();
-    const QString arrayKey = selectedItemsArrayKey();
-    const QString itemKey = selectedItemsKey();
-
-    ApplicationSettings appSettings(
-        account, preferences::keys::files::userInterface);
-
-    appSettings.beginGroup(groupKey);
-    appSettings.beginWriteArray(arrayKey, itemLocalUids.size());
-
-    int i = 0;
-    for (const auto & itemLocalUid: qAsConst(itemLocalUids)) {
-        appSettings.setArrayIndex(i);
-        appSettings.setValue(itemKey, itemLocalUid);
-        ++i;
+    if (m_hasPendingSelectedItems &&
+        !(m_pendingSelectedItems.m_account == account))
+    {
+        persistPendingSelectedItems();
     }
 
-    appSettings.endArray();
-    appSettings.endGroup();
+    m_pendingSelectedItems.m_account = account;
+    m_pendingSelectedItems.m_groupKey = selectedItemsGroupKey();
+    m_pendingSelectedItems.m_arrayKey = selectedItemsArrayKey();
+    m_pendingSelectedItems.m_itemKey = selectedItemsKey();
+    m_pendingSelectedItems.m_itemLocalUids = itemLocalUids;
+    m_hasPendingSelectedItems = true;
+
+    schedulePendingStateSaving();
 }
 
 void AbstractNoteFilteringTreeView::restoreSelectedItems(
@@ -528,6 +675,8 @@ void AbstractNoteFilteringTreeView::restoreSelectedItems(
     else {
         MSDEBUG("Filtering by selected items is switched off");
 
+        persistPendingSelectedItems();
+
         const QString groupKey = selectedItemsGroupKey();
         const QString arrayKey = selectedItemsArrayKey();
         const QString itemKey = selectedItemsKey();
@@ -706,12 +855,10 @@ void AbstractNoteFilteringTreeView::selectionChangedImpl(
 
     if (!m_trackingSelection) {
         MSTRACE("Not tracking selection at this time, skipping");
+        m_selectedItemLocalUidsActual = false;
         return;
     }
 
-    Q_UNUSED(selected)
-    Q_UNUSED(deselected)
-
     auto * pItemModel = qobject_cast<AbstractItemModel *>(model());
     if (Q_UNLIKELY(!pItemModel)) {
         MSDEBUG("Non-item model is used");
@@ -720,52 +867,93 @@ void AbstractNoteFilteringTreeView::selectionChangedImpl(
 
     const auto & account = pItemModel->account();
 
-    auto indexes = selectedIndexes();
-    if (indexes.isEmpty()) {
-        MSDEBUG("The new selection is empty");
-        handleNoSelectedItems(account);
-        return;
+    if (m_selectedItemLocalUidsActual) {
+        updateSelectedItemLocalUids(selected, deselected, *pItemModel);
+    }
+    else {
+        resetSelectedItemLocalUids(*pItemModel);
     }
 
     // FIXME: it should not be possible to have selected items and all items
     // root item simultaneously - need to figure out what to filter out from the
     // selection using "selected" and "deselected"
 
-    QStringList itemLocalUids;
+    const QStringList & itemLocalUids = m_selectedItemLocalUids;
+    if (itemLocalUids.isEmpty()) {
+        MSDEBUG("Found no items within the selection");
+        handleNoSelectedItems(account);
+        return;
+    }
 
-    for (const auto & selectedIndex: qAsConst(indexes)) {
-        if (!selectedIndex.isValid()) {
-            continue;
-        }
+    saveSelectedItems(account, itemLocalUids);
 
-        // A way to ensure only one index per row
-        if (selectedIndex.column() != pItemModel->nameColumn()) {
+    if (shouldFilterBySelectedItems(account)) {
+        setItemsToNoteFiltersManager(itemLocalUids);
+    }
+    else {
+        MSDEBUG("Filtering by selected items is switched off");
+    }
+}
+
+void AbstractNoteFilteringTreeView::updateSelectedItemLocalUids(
+    const QItemSelection & selected, const QItemSelection & deselected,
+    AbstractItemModel & itemModel)
+{
+    const auto deselectedIndexes = deselected.indexes();
+    for (const auto & deselectedIndex: qAsConst(deselectedIndexes)) {
+        if (!deselectedIndex.isValid() ||
+            (deselectedIndex.column() != itemModel.nameColumn()))
+        {
             continue;
         }
 
-        QString localUid = pItemModel->localUidForItemIndex(selectedIndex);
-        if (localUid.isEmpty()) {
-            continue;
+        QString localUid = itemModel.localUidForItemIndex(deselectedIndex);
+        if (m_selectedItemLocalUidsSet.remove(localUid)) {
+            Q_UNUSED(m_selectedItemLocalUids.removeOne(localUid))
         }
+    }
 
-        itemLocalUids << localUid;
-        processSelectedItem(localUid, *pItemModel);
+    const auto selectedIndexes = selected.indexes();
+    for (const auto & selectedIndex: qAsConst(selectedIndexes)) {
+        addSelectedItemLocalUid(selectedIndex, itemModel);
     }
+}
 
-    if (Q_UNLIKELY(itemLocalUids.isEmpty())) {
-        MSDEBUG("Found no items within the selected indexes");
-        handleNoSelectedItems(account);
-        return;
+void AbstractNoteFilteringTreeView::resetSelectedItemLocalUids(
+    AbstractItemModel & itemModel)
+{
+    m_selectedItemLocalUids.clear();
+    m_selectedItemLocalUidsSet.clear();
+
+    const auto indexes = selectedIndexes();
+    for (const auto & selectedIndex: qAsConst(indexes)) {
+        addSelectedItemLocalUid(selectedIndex, itemModel);
     }
 
-    saveSelectedItems(account, itemLocalUids);
+    m_selectedItemLocalUidsActual = true;
+}
 
-    if (shouldFilterBySelectedItems(account)) {
-        setItemsToNoteFiltersManager(itemLocalUids);
+void AbstractNoteFilteringTreeView::addSelectedItemLocalUid(
+    const QModelIndex & index, AbstractItemModel & itemModel)
+{
+    if (!index.isValid()) {
+        return;
     }
-    else {
-        MSDEBUG("Filtering by selected items is switched off");
+
+    // A way to ensure only one index per row
+    if (index.column() != itemModel.nameColumn()) {
+        return;
+    }
+
+    QString localUid = itemModel.localUidForItemIndex(index);
+    if (localUid.isEmpty() || m_selectedItemLocalUidsSet.contains(localUid)) {
+        return;
     }
+
+    m_selectedItemLocalUids << localUid;
+    Q_UNUSED(m_selectedItemLocalUidsSet.insert(localUid))
+
+    processSelectedItem(localUid, itemModel);
 }
 
 } // namespace quentier
@@ -21,13 +21,14 @@
 
 #include "TreeView.h"
 
+#include <quentier/types/Account.h>
 #include <quentier/types/ErrorString.h>
 
 #include <QPointer>
+#include <QSet>
 
 namespace quentier {
 
-QT_FORWARD_DECLARE_CLASS(Account)
 QT_FORWARD_DECLARE_CLASS(AbstractItemModel)
 QT_FORWARD_DECLARE_CLASS(ApplicationSettings)
 QT_FORWARD_DECLARE_CLASS(NoteFiltersManager)
@@ -77,6 +78,21 @@ protected:
      */
     virtual void restoreItemsState(const AbstractItemModel & itemModel) = 0;
 
+    /**
+     * @brief updateItemExpandedState is an optional method which
+     * the subclass can implement in order to track the expanded/collapsed
+     * states of model items incrementally instead of walking over all model
+     * items within saveItemsState. It is called for each expanded or
+     * collapsed item while the items state is being tracked; the persistence
+     * of the state is then scheduled to happen later via saveItemsState.
+     */
+    virtual void updateItemExpandedState(
+        const QModelIndex & index, const bool expanded)
+    {
+        Q_UNUSED(index)
+        Q_UNUSED(expanded)
+    }
+
     /**
      * View's group key for ApplicationSettings entry to save/load selected
      * items
@@ -148,14 +164,19 @@ protected:
 
 private Q_SLOTS:
     void onAllItemsListed();
-    void onItemCollapsedOrExpanded(const QModelIndex & index);
+    void onItemExpanded(const QModelIndex & index);
+    void onItemCollapsed(const QModelIndex & index);
     void onNoteFilterChanged();
     void onNoteFiltersManagerReady();
+    void onModelAboutToChangeSelection();
 
     virtual void selectionChanged(
         const QItemSelection & selected,
         const QItemSelection & deselected) override;
 
+    virtual void hideEvent(QHideEvent * pEvent) override;
+    virtual void timerEvent(QTimerEvent * pEvent) override;
+
 protected:
     void saveSelectedItems(
         const Account & account, const QStringList & itemLocalUids);
@@ -177,7 +198,27 @@ protected:
         ApplicationSettings & appSettings, const QString & settingsKey,
         const QModelIndex & allItemsRootItemIndex);
 
+    /**
+     * @brief scheduleItemsStateSaving method starts the timer after which
+     * saveItemsState would be called unless the timer is already running;
+     * that way multiple expand/collapse events are persisted in one batch
+     */
+    void scheduleItemsStateSaving();
+
+    /**
+     * @brief flushPendingState method immediately persists the items state
+     * and selected items if their saving was scheduled but has not happened
+     * yet
+     */
+    void flushPendingState();
+
 private:
+    void onItemCollapsedOrExpanded(
+        const QModelIndex & index, const bool expanded);
+
+    void schedulePendingStateSaving();
+    void persistPendingSelectedItems();
+
     void disconnectFromNoteFiltersManagerFilterChanged();
     void connectToNoteFiltersManagerFilterChanged();
 
@@ -189,7 +230,25 @@ private:
     void selectionChangedImpl(
         const QItemSelection & selected, const QItemSelection & deselected);
 
+    void updateSelectedItemLocalUids(
+        const QItemSelection & selected, const QItemSelection & deselected,
+        AbstractItemModel & itemModel);
+
+    void resetSelectedItemLocalUids(AbstractItemModel & itemModel);
+
+    void addSelectedItemLocalUid(
+        const QModelIndex & index, AbstractItemModel & itemModel);
+
 private:
+    struct PendingSelectedItems
+    {
+        Account m_account;
+        QString m_groupKey;
+        QString m_arrayKey;
+        QString m_itemKey;
+        QStringList m_itemLocalUids;
+    };
+
     const QString m_modelTypeName;
 
     QPointer<NoteFiltersManager> m_pNoteFiltersManager;
@@ -200,6 +259,18 @@ private:
     bool m_trackingItemsState = false;
     bool m_trackingSelection = false;
     bool m_modelReady = false;
+
+    // Local uids of currently selected items, maintained incrementally from
+    // selection changes while the selection is being tracked
+    QStringList m_selectedItemLocalUids;
+    QSet<QString> m_selectedItemLocalUidsSet;
+    bool m_selectedItemLocalUidsActual = false;
+
+    PendingSelectedItems m_pendingSelectedItems;
+    bool m_hasPendingSelectedItems = false;
+    bool m_hasPendingItemsState = false;
+
+    int m_persistPendingStateTimerId = 0;
 };
 
 } // namespace quentier
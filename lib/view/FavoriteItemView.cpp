@@ -21,6 +21,7 @@
 #include <lib/model/favorites/FavoritesModel.h>
 #include <lib/preferences/keys/Files.h>
 #include <lib/preferences/keys/SidePanelsFiltering.h>
+#include <lib/utility/Log.h>
 #include <lib/widget/NoteFiltersManager.h>
 
 #include <quentier/logging/QuentierLogger.h>
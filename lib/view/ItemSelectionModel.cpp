@@ -19,6 +19,7 @@
 #include "ItemSelectionModel.h"
 
 #include <lib/model/common/AbstractItemModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
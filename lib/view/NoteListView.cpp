@@ -23,6 +23,7 @@
 #include <lib/model/note/NoteModel.h>
 #include <lib/model/notebook/NotebookItem.h>
 #include <lib/model/notebook/NotebookModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
@@ -33,7 +34,9 @@
 #include <QMouseEvent>
 #include <QTimer>
 
+#include <algorithm>
 #include <iterator>
+#include <vector>
 
 #define REPORT_ERROR(error)                                                    \
     {                                                                          \
@@ -44,6 +47,41 @@
 
 namespace quentier {
 
+namespace {
+
+/**
+ * Merges the given rows into as few selection ranges as possible: thousands
+ * of one row ranges make QItemSelectionModel noticeably slow both on
+ * selecting and on subsequent selection queries
+ */
+QItemSelection rowRangesSelection(
+    std::vector<int> rows, const QAbstractItemModel & model, const int column)
+{
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    QItemSelection selection;
+
+    auto it = rows.begin();
+    while (it != rows.end()) {
+        auto rangeEndIt = it;
+        auto nextIt = std::next(rangeEndIt);
+        while ((nextIt != rows.end()) && (*nextIt == *rangeEndIt + 1)) {
+            rangeEndIt = nextIt;
+            ++nextIt;
+        }
+
+        selection.append(QItemSelectionRange(
+            model.index(*it, column), model.index(*rangeEndIt, column)));
+
+        it = nextIt;
+    }
+
+    return selection;
+}
+
+} // namespace
+
 NoteListView::NoteListView(QWidget * parent) : QListView(parent) {}
 
 void NoteListView::setNotebookItemView(NotebookItemView * pNotebookItemView)
@@ -67,20 +105,34 @@ QStringList NoteListView::selectedNotesLocalUids() const
         return result;
     }
 
-    auto indexes = selectedIndexes();
-    result.reserve(indexes.size());
+    auto * pSelectionModel = selectionModel();
+    if (Q_UNLIKELY(!pSelectionModel)) {
+        return result;
+    }
 
-    for (const auto & modelIndex: qAsConst(indexes)) {
-        const auto * pItem = pNoteModel->itemForIndex(modelIndex);
-        if (Q_UNLIKELY(!pItem)) {
-            QNWARNING(
-                "view:note",
-                "Found no note model item for selected "
-                    << "index");
-            continue;
-        }
+    // Walking through selection ranges instead of selected indexes: the latter
+    // would be materialized one by one for all the selected rows
+    const auto selection = pSelectionModel->selection();
+
+    QSet<int> processedRows;
+    for (const auto & range: qAsConst(selection)) {
+        for (int row = range.top(), bottom = range.bottom(); row <= bottom;
+             ++row)
+        {
+            if (processedRows.contains(row)) {
+                continue;
+            }
+
+            Q_UNUSED(processedRows.insert(row))
+
+            const auto * pItem = pNoteModel->itemAtRow(row);
+            if (Q_UNLIKELY(!pItem)) {
+                QNWARNING(
+                    "view:note",
+                    "Found no note model item for selected row " << row);
+                continue;
+            }
 
-        if (!result.contains(pItem->localUid())) {
             result.push_back(pItem->localUid());
         }
     }
@@ -180,10 +232,8 @@ void NoteListView::selectNotesByLocalUids(const QStringList & noteLocalUids)
         return;
     }
 
-    QItemSelection selection;
-
-    QItemSelectionModel::SelectionFlags selectionFlags(
-        QItemSelectionModel::Select);
+    std::vector<int> rows;
+    rows.reserve(static_cast<size_t>(noteLocalUids.size()));
 
     for (const auto & noteLocalUid: qAsConst(noteLocalUids)) {
         auto modelIndex = pNoteModel->indexForLocalUid(noteLocalUid);
@@ -195,15 +245,67 @@ void NoteListView::selectNotesByLocalUids(const QStringList & noteLocalUids)
             continue;
         }
 
-        QItemSelection currentSelection;
-        currentSelection.select(modelIndex, modelIndex);
-        selection.merge(currentSelection, selectionFlags);
+        rows.push_back(modelIndex.row());
     }
 
-    selectionFlags = QItemSelectionModel::SelectionFlags(
+    m_allMatchingNotesSelected = false;
+
+    pSelectionModel->select(
+        rowRangesSelection(std::move(rows), *pNoteModel, modelColumn()),
         QItemSelectionModel::ClearAndSelect);
+}
+
+void NoteListView::selectAll()
+{
+    QNTRACE("view:note", "NoteListView::selectAll");
+
+    if ((selectionMode() != QAbstractItemView::ExtendedSelection) &&
+        (selectionMode() != QAbstractItemView::MultiSelection))
+    {
+        QListView::selectAll();
+        return;
+    }
+
+    auto * pNoteModel = noteModel();
+    if (Q_UNLIKELY(!pNoteModel)) {
+        return;
+    }
 
-    pSelectionModel->select(selection, selectionFlags);
+    auto * pSelectionModel = selectionModel();
+    if (Q_UNLIKELY(!pSelectionModel)) {
+        QNDEBUG(
+            "view:note",
+            "Can't select all notes: no selection model within the view");
+        return;
+    }
+
+    // Notes which are not loaded into the model yet are not fetched here:
+    // instead the rows loaded later are appended to the selection as they
+    // are inserted
+    m_allMatchingNotesSelected = true;
+
+    const int rowCount = pNoteModel->rowCount(QModelIndex());
+    if (rowCount == 0) {
+        pSelectionModel->clearSelection();
+        return;
+    }
+
+    const int column = modelColumn();
+
+    pSelectionModel->select(
+        QItemSelection(
+            pNoteModel->index(0, column),
+            pNoteModel->index(rowCount - 1, column)),
+        QItemSelectionModel::ClearAndSelect);
+}
+
+void NoteListView::reset()
+{
+    QNTRACE("view:note", "NoteListView::reset");
+
+    // Reset of the model means a different set of notes matching the filters
+    m_allMatchingNotesSelected = false;
+    QListView::reset();
 }
 
 void NoteListView::dataChanged(
@@ -251,6 +353,19 @@ void NoteListView::rowsInserted(const QModelIndex & parent, int start, int end)
 
     QListView::rowsInserted(parent, start, end);
 
+    if (m_allMatchingNotesSelected) {
+        auto * pSelectionModel = selectionModel();
+        if (pSelectionModel && model()) {
+            const int column = modelColumn();
+
+            pSelectionModel->select(
+                QItemSelection(
+                    model()->index(start, column, parent),
+                    model()->index(end, column, parent)),
+                QItemSelectionModel::Select);
+        }
+    }
+
     if (Q_UNLIKELY(m_shouldSelectFirstNoteOnNextNoteAddition)) {
         m_shouldSelectFirstNoteOnNextNoteAddition = false;
 
@@ -449,6 +564,118 @@ void NoteListView::onFavoriteAction()
     }
 }
 
+void NoteListView::onDeleteSeveralNotesAction()
+{
+    QNDEBUG("view:note", "NoteListView::onDeleteSeveralNotesAction");
+
+    auto * pNoteModel = noteModel();
+    if (Q_UNLIKELY(!pNoteModel)) {
+        return;
+    }
+
+    const QStringList noteLocalUids = actionDataStringList();
+    if (noteLocalUids.isEmpty()) {
+        return;
+    }
+
+    ErrorString error;
+    if (!pNoteModel->deleteNotes(noteLocalUids, error)) {
+        ErrorString errorDescription(QT_TR_NOOP("Can't delete notes: "));
+        errorDescription.appendBase(error.base());
+        errorDescription.appendBase(error.additionalBases());
+        errorDescription.details() = error.details();
+        QNWARNING("view:note", errorDescription);
+        Q_EMIT notifyError(errorDescription);
+    }
+}
+
+void NoteListView::onMoveSeveralNotesToOtherNotebookAction()
+{
+    QNTRACE(
+        "view:note", "NoteListView::onMoveSeveralNotesToOtherNotebookAction");
+
+    // The last element of action data is the name of the target notebook
+    QStringList actionData = actionDataStringList();
+    if (actionData.size() < 2) {
+        REPORT_ERROR(
+            QT_TR_NOOP("Can't move notes to another notebook: internal "
+                       "error, wrong action data"));
+        return;
+    }
+
+    auto * pNoteModel = noteModel();
+    if (Q_UNLIKELY(!pNoteModel)) {
+        return;
+    }
+
+    QString notebookName = actionData.takeLast();
+
+    ErrorString error;
+    bool res =
+        pNoteModel->moveNotesToNotebook(actionData, notebookName, error);
+
+    if (!res) {
+        ErrorString errorDescription(
+            QT_TR_NOOP("Can't move notes to another notebook: "));
+
+        errorDescription.appendBase(error.base());
+        errorDescription.appendBase(error.additionalBases());
+        errorDescription.details() = error.details();
+        QNWARNING("view:note", errorDescription);
+        Q_EMIT notifyError(errorDescription);
+    }
+}
+
+void NoteListView::onUnfavoriteSeveralNotesAction()
+{
+    QNDEBUG("view:note", "NoteListView::onUnfavoriteSeveralNotesAction");
+
+    auto * pNoteModel = noteModel();
+    if (Q_UNLIKELY(!pNoteModel)) {
+        return;
+    }
+
+    const QStringList noteLocalUids = actionDataStringList();
+    if (noteLocalUids.isEmpty()) {
+        return;
+    }
+
+    ErrorString error;
+    if (!pNoteModel->unfavoriteNotes(noteLocalUids, error)) {
+        ErrorString errorDescription(QT_TR_NOOP("Can't unfavorite notes: "));
+        errorDescription.appendBase(error.base());
+        errorDescription.appendBase(error.additionalBases());
+        errorDescription.details() = error.details();
+        QNWARNING("view:note", errorDescription);
+        Q_EMIT notifyError(errorDescription);
+    }
+}
+
+void NoteListView::onFavoriteSeveralNotesAction()
+{
+    QNDEBUG("view:note", "NoteListView::onFavoriteSeveralNotesAction");
+
+    auto * pNoteModel = noteModel();
+    if (Q_UNLIKELY(!pNoteModel)) {
+        return;
+    }
+
+    const QStringList noteLocalUids = actionDataStringList();
+    if (noteLocalUids.isEmpty()) {
+        return;
+    }
+
+    ErrorString error;
+    if (!pNoteModel->favoriteNotes(noteLocalUids, error)) {
+        ErrorString errorDescription(QT_TR_NOOP("Can't favorite notes: "));
+        errorDescription.appendBase(error.base());
+        errorDescription.appendBase(error.additionalBases());
+        errorDescription.details() = error.details();
+        QNWARNING("view:note", errorDescription);
+        Q_EMIT notifyError(errorDescription);
+    }
+}
+
 void NoteListView::onShowNoteInfoAction()
 {
     QNDEBUG("view:note", "NoteListView::onShowNoteInfoAction");
@@ -610,31 +837,17 @@ void NoteListView::showContextMenuAtPoint(
         return;
     }
 
-    auto selectedRowIndexes = pSelectionModel->selectedIndexes();
-    selectedRowIndexes << currentIndex();
-
-    QStringList noteLocalUids;
-    noteLocalUids.reserve(selectedRowIndexes.size());
-
-    for (const auto & modelIndex: qAsConst(selectedRowIndexes)) {
-        const auto * pNoteModelItem = pNoteModel->itemForIndex(modelIndex);
-        if (Q_UNLIKELY(!pNoteModelItem)) {
-            QNWARNING(
-                "view:note",
-                "Detected selected model index for which "
-                    << "no model item was found");
-            continue;
-        }
+    QStringList noteLocalUids = selectedNotesLocalUids();
 
-        noteLocalUids << pNoteModelItem->localUid();
+    const auto * pCurrentNoteModelItem =
+        pNoteModel->itemForIndex(currentIndex());
 
-        QNTRACE(
-            "view:note",
-            "Included note local uid " << pNoteModelItem->localUid());
+    if (pCurrentNoteModelItem &&
+        !pSelectionModel->isSelected(currentIndex()))
+    {
+        noteLocalUids << pCurrentNoteModelItem->localUid();
     }
 
-    Q_UNUSED(noteLocalUids.removeDuplicates())
-
     QNTRACE(
         "view:note",
         "Selected note local uids: "
@@ -886,6 +1099,69 @@ void NoteListView::showMultipleNotesContextMenu(
     delete m_pNoteItemContextMenu;
     m_pNoteItemContextMenu = new QMenu(this);
 
+    ADD_CONTEXT_MENU_ACTION(
+        tr("Delete"), m_pNoteItemContextMenu, onDeleteSeveralNotesAction,
+        noteLocalUids, true);
+
+    const NotebookModel * pNotebookModel = nullptr;
+    if (m_pNotebookItemView) {
+        pNotebookModel =
+            qobject_cast<const NotebookModel *>(m_pNotebookItemView->model());
+    }
+
+    if (pNotebookModel) {
+        QStringList notebookNames = pNotebookModel->notebookNames(
+            NotebookModel::Filters(NotebookModel::Filter::CanCreateNotes));
+
+        if (!notebookNames.isEmpty()) {
+            auto * pTargetNotebooksSubMenu =
+                m_pNoteItemContextMenu->addMenu(tr("Move to notebook"));
+
+            for (const auto & notebookName: qAsConst(notebookNames)) {
+                QStringList actionData = noteLocalUids;
+                actionData << notebookName;
+
+                ADD_CONTEXT_MENU_ACTION(
+                    notebookName, pTargetNotebooksSubMenu,
+                    onMoveSeveralNotesToOtherNotebookAction, actionData, true);
+            }
+        }
+    }
+
+    bool hasFavoritedNotes = false;
+    bool hasNonFavoritedNotes = false;
+
+    const auto * pNoteModel = noteModel();
+    if (pNoteModel) {
+        for (const auto & noteLocalUid: qAsConst(noteLocalUids)) {
+            const auto * pItem = pNoteModel->itemForLocalUid(noteLocalUid);
+            if (!pItem) {
+                continue;
+            }
+
+            if (pItem->isFavorited()) {
+                hasFavoritedNotes = true;
+            }
+            else {
+                hasNonFavoritedNotes = true;
+            }
+        }
+    }
+
+    if (hasNonFavoritedNotes) {
+        ADD_CONTEXT_MENU_ACTION(
+            tr("Favorite"), m_pNoteItemContextMenu,
+            onFavoriteSeveralNotesAction, noteLocalUids, true);
+    }
+
+    if (hasFavoritedNotes) {
+        ADD_CONTEXT_MENU_ACTION(
+            tr("Unfavorite"), m_pNoteItemContextMenu,
+            onUnfavoriteSeveralNotesAction, noteLocalUids, true);
+    }
+
+    m_pNoteItemContextMenu->addSeparator();
+
     ADD_CONTEXT_MENU_ACTION(
         tr("Export to enex") + QStringLiteral("..."), m_pNoteItemContextMenu,
         onExportSeveralNotesToEnexAction, noteLocalUids, true);
@@ -900,6 +1176,9 @@ void NoteListView::currentChanged(
     QNTRACE("view:note", "NoteListView::currentChanged");
     Q_UNUSED(previous)
 
+    // Navigating through the list replaces the selection
+    m_allMatchingNotesSelected = false;
+
     if (!current.isValid()) {
         QNTRACE("view:note", "Current index is invalid");
         return;
@@ -937,6 +1216,7 @@ void NoteListView::mousePressEvent(QMouseEvent * pEvent)
         return;
     }
 
+    m_allMatchingNotesSelected = false;
     QListView::mousePressEvent(pEvent);
 
     if (m_pNoteItemContextMenu && !m_pNoteItemContextMenu->isHidden()) {
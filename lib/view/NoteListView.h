@@ -108,6 +108,15 @@ public Q_SLOTS:
      */
     void selectNotesByLocalUids(const QStringList & noteLocalUids);
 
+    /**
+     * Selects all notes matching the filters of the note model, including
+     * the ones which are not loaded into the model yet: their rows are
+     * selected as they get loaded. Rows are selected as a single range.
+     */
+    virtual void selectAll() override;
+
+    virtual void reset() override;
+
     /**
      * @brief The dataChanged method is redefined in NoteListView for the sole
      * reason of being a public slot instead of protected; it calls
@@ -133,6 +142,11 @@ protected Q_SLOTS:
     void onUnfavoriteAction();
     void onFavoriteAction();
 
+    void onDeleteSeveralNotesAction();
+    void onMoveSeveralNotesToOtherNotebookAction();
+    void onUnfavoriteSeveralNotesAction();
+    void onFavoriteSeveralNotesAction();
+
     void onShowNoteInfoAction();
     void onCopyInAppNoteLinkAction();
 
@@ -200,6 +214,9 @@ protected:
     NotebookItemView * m_pNotebookItemView = nullptr;
     bool m_shouldSelectFirstNoteOnNextNoteAddition = false;
 
+    // Set by selectAll until the selection is changed in some other way
+    bool m_allMatchingNotesSelected = false;
+
     Account m_currentAccount;
 
     QString m_lastCurrentNoteLocalUid;
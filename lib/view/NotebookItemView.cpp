@@ -25,6 +25,7 @@
 #include <lib/model/notebook/NotebookModel.h>
 #include <lib/preferences/keys/Files.h>
 #include <lib/preferences/keys/SidePanelsFiltering.h>
+#include <lib/utility/Log.h>
 #include <lib/widget/NoteFiltersManager.h>
 
 #include <quentier/logging/QuentierLogger.h>
@@ -112,71 +113,6 @@ void NotebookItemView::saveItemsState()
         return;
     }
 
-    QMap<QString, QStringList> expandedStackItemsByLinkedNotebookGuid;
-    QStringList expandedLinkedNotebookItemsGuids;
-
-    auto indexes = pNotebookModel->persistentIndexes();
-    for (const auto & index: qAsConst(indexes)) {
-        if (!isExpanded(index)) {
-            continue;
-        }
-
-        const auto * pModelItem = pNotebookModel->itemForIndex(index);
-        if (Q_UNLIKELY(!pModelItem)) {
-            QNWARNING(
-                "view:notebook",
-                "Can't save the state of notebook stack "
-                    << "expanded/folded state: no notebook model item "
-                    << "corresponding to the persistent notebook model index");
-            continue;
-        }
-
-        const auto * pNotebookItem = pModelItem->cast<NotebookItem>();
-        if (pNotebookItem) {
-            continue;
-        }
-
-        const auto * pStackItem = pModelItem->cast<StackItem>();
-        if (pStackItem) {
-            QString linkedNotebookGuid;
-            const auto * pParentItem = pModelItem->parent();
-            if (pParentItem &&
-                (pParentItem->type() ==
-                 INotebookModelItem::Type::LinkedNotebook))
-            {
-                auto * pLinkedNotebookItem =
-                    pParentItem->cast<LinkedNotebookRootItem>();
-
-                if (pLinkedNotebookItem) {
-                    linkedNotebookGuid =
-                        pLinkedNotebookItem->linkedNotebookGuid();
-                }
-            }
-
-            const QString & stackItemName = pStackItem->name();
-            if (Q_UNLIKELY(stackItemName.isEmpty())) {
-                QNDEBUG(
-                    "view:notebook",
-                    "Skipping the notebook stack item "
-                        << "without a name");
-                continue;
-            }
-
-            expandedStackItemsByLinkedNotebookGuid[linkedNotebookGuid].append(
-                stackItemName);
-
-            continue;
-        }
-
-        const auto * pLinkedNotebookItem =
-            pModelItem->cast<LinkedNotebookRootItem>();
-
-        if (pLinkedNotebookItem) {
-            expandedLinkedNotebookItemsGuids
-                << pLinkedNotebookItem->linkedNotebookGuid();
-        }
-    }
-
     ApplicationSettings appSettings(
         pNotebookModel->account(), preferences::keys::files::userInterface);
 
@@ -187,29 +123,24 @@ void NotebookItemView::saveItemsState()
     CLANG_SUPPRESS_WARNING(-Wrange-loop-analysis)
     // clang-format on
     for (const auto it: // clazy:exclude=range-loop
-         qevercloud::toRange(qAsConst(expandedStackItemsByLinkedNotebookGuid)))
+         qevercloud::toRange(
+             qAsConst(m_expandedStackNamesByLinkedNotebookGuid)))
     {
         const QString & linkedNotebookGuid = it.key();
-        const QStringList & stackItemNames = it.value();
+        const QStringList stackItemNames = it.value().values();
 
-        if (linkedNotebookGuid.isEmpty()) {
-            appSettings.setValue(LAST_EXPANDED_STACK_ITEMS_KEY, stackItemNames);
+        QString key = LAST_EXPANDED_STACK_ITEMS_KEY;
+        if (!linkedNotebookGuid.isEmpty()) {
+            key += QStringLiteral("/") + linkedNotebookGuid;
         }
-        else {
-            QString key = LAST_EXPANDED_STACK_ITEMS_KEY;
-
-            if (!linkedNotebookGuid.isEmpty()) {
-                key += QStringLiteral("/") + linkedNotebookGuid;
-            }
 
-            appSettings.setValue(key, stackItemNames);
-        }
+        appSettings.setValue(key, stackItemNames);
     }
     RESTORE_WARNINGS
 
     appSettings.setValue(
         LAST_EXPANDED_LINKED_NOTEBOOK_ITEMS_KEY,
-        expandedLinkedNotebookItemsGuids);
+        QStringList(m_expandedLinkedNotebookGuids.values()));
 
     saveAllItemsRootItemExpandedState(
         appSettings, ALL_NOTEBOOKS_ROOT_ITEM_EXPANDED_KEY,
@@ -228,6 +159,9 @@ void NotebookItemView::restoreItemsState(const AbstractItemModel & model)
         return;
     }
 
+    // Ensure the changes not yet persisted would not be lost
+    flushPendingState();
+
     const auto & linkedNotebookOwnerNamesByGuid =
         pNotebookModel->linkedNotebookOwnerNamesByGuid();
 
@@ -236,20 +170,28 @@ void NotebookItemView::restoreItemsState(const AbstractItemModel & model)
 
     appSettings.beginGroup(NOTEBOOK_ITEM_VIEW_GROUP_KEY);
 
-    auto expandedStacks =
+    m_expandedStackNamesByLinkedNotebookGuid.clear();
+
+    const auto expandedStacks =
         appSettings.value(LAST_EXPANDED_STACK_ITEMS_KEY).toStringList();
 
+    auto & expandedUserOwnStacks =
+        m_expandedStackNamesByLinkedNotebookGuid[QString()];
+
+    for (const auto & expandedStack: qAsConst(expandedStacks)) {
+        Q_UNUSED(expandedUserOwnStacks.insert(expandedStack))
+    }
+
     // clang-format off
     SAVE_WARNINGS
     CLANG_SUPPRESS_WARNING(-Wrange-loop-analysis)
     // clang-format on
-    QHash<QString, QStringList> expandedStacksByLinkedNotebookGuid;
     for (const auto it: // clazy:exclude=range-loop
          qevercloud::toRange(qAsConst(linkedNotebookOwnerNamesByGuid)))
     {
         const QString & linkedNotebookGuid = it.key();
 
-        auto expandedStacksForLinkedNotebook =
+        const auto expandedStacksForLinkedNotebook =
             appSettings
                 .value(
                     LAST_EXPANDED_STACK_ITEMS_KEY + QStringLiteral("/") +
@@ -260,15 +202,26 @@ void NotebookItemView::restoreItemsState(const AbstractItemModel & model)
             continue;
         }
 
-        expandedStacksByLinkedNotebookGuid[linkedNotebookGuid] =
-            expandedStacksForLinkedNotebook;
+        auto & expandedLinkedNotebookStacks =
+            m_expandedStackNamesByLinkedNotebookGuid[linkedNotebookGuid];
+
+        for (const auto & expandedStack:
+             qAsConst(expandedStacksForLinkedNotebook))
+        {
+            Q_UNUSED(expandedLinkedNotebookStacks.insert(expandedStack))
+        }
     }
     RESTORE_WARNINGS
 
-    auto expandedLinkedNotebookItemsGuids =
+    const auto expandedLinkedNotebookItemsGuids =
         appSettings.value(LAST_EXPANDED_LINKED_NOTEBOOK_ITEMS_KEY)
             .toStringList();
 
+    m_expandedLinkedNotebookGuids.clear();
+    for (const auto & guid: qAsConst(expandedLinkedNotebookItemsGuids)) {
+        Q_UNUSED(m_expandedLinkedNotebookGuids.insert(guid))
+    }
+
     auto allNotebooksRootItemExpandedPreference =
         appSettings.value(ALL_NOTEBOOKS_ROOT_ITEM_EXPANDED_KEY);
 
@@ -277,21 +230,14 @@ void NotebookItemView::restoreItemsState(const AbstractItemModel & model)
     bool wasTrackingNotebookItemsState = trackItemsStateEnabled();
     setTrackItemsStateEnabled(false);
 
-    setStacksExpanded(expandedStacks, *pNotebookModel, QString());
+    const auto linkedNotebookGuids =
+        m_expandedStackNamesByLinkedNotebookGuid.keys();
 
-    // clang-format off
-    SAVE_WARNINGS
-    CLANG_SUPPRESS_WARNING(-Wrange-loop-analysis)
-    // clang-format on
-    for (const auto it: // clazy:exclude=range-loop
-         qevercloud::toRange(qAsConst(expandedStacksByLinkedNotebookGuid)))
-    {
-        setStacksExpanded(it.value(), *pNotebookModel, it.key());
+    for (const auto & linkedNotebookGuid: qAsConst(linkedNotebookGuids)) {
+        setStacksExpanded(*pNotebookModel, linkedNotebookGuid);
     }
-    RESTORE_WARNINGS
 
-    setLinkedNotebooksExpanded(
-        expandedLinkedNotebookItemsGuids, *pNotebookModel);
+    setLinkedNotebooksExpanded(*pNotebookModel);
 
     bool allNotebooksRootItemExpanded = true;
     if (allNotebooksRootItemExpandedPreference.isValid()) {
@@ -305,6 +251,76 @@ void NotebookItemView::restoreItemsState(const AbstractItemModel & model)
     setTrackItemsStateEnabled(wasTrackingNotebookItemsState);
 }
 
+void NotebookItemView::updateItemExpandedState(
+    const QModelIndex & index, const bool expanded)
+{
+    auto * pNotebookModel = qobject_cast<NotebookModel *>(model());
+    if (Q_UNLIKELY(!pNotebookModel)) {
+        QNDEBUG("view:notebook", "Non-notebook model is used");
+        return;
+    }
+
+    const auto * pModelItem = pNotebookModel->itemForIndex(index);
+    if (Q_UNLIKELY(!pModelItem)) {
+        QNWARNING(
+            "view:notebook",
+            "Can't track the notebook model item's expanded/folded state: "
+                << "no notebook model item corresponding to the model "
+                << "index");
+        return;
+    }
+
+    const auto * pStackItem = pModelItem->cast<StackItem>();
+    if (pStackItem) {
+        const QString & stackItemName = pStackItem->name();
+        if (Q_UNLIKELY(stackItemName.isEmpty())) {
+            QNDEBUG(
+                "view:notebook",
+                "Skipping the notebook stack item without a name");
+            return;
+        }
+
+        QString linkedNotebookGuid;
+        const auto * pParentItem = pModelItem->parent();
+        if (pParentItem &&
+            (pParentItem->type() == INotebookModelItem::Type::LinkedNotebook))
+        {
+            auto * pLinkedNotebookItem =
+                pParentItem->cast<LinkedNotebookRootItem>();
+
+            if (pLinkedNotebookItem) {
+                linkedNotebookGuid = pLinkedNotebookItem->linkedNotebookGuid();
+            }
+        }
+
+        auto & expandedStackNames =
+            m_expandedStackNamesByLinkedNotebookGuid[linkedNotebookGuid];
+
+        if (expanded) {
+            Q_UNUSED(expandedStackNames.insert(stackItemName))
+        }
+        else {
+            Q_UNUSED(expandedStackNames.remove(stackItemName))
+        }
+
+        return;
+    }
+
+    const auto * pLinkedNotebookItem =
+        pModelItem->cast<LinkedNotebookRootItem>();
+
+    if (pLinkedNotebookItem) {
+        if (expanded) {
+            Q_UNUSED(m_expandedLinkedNotebookGuids.insert(
+                pLinkedNotebookItem->linkedNotebookGuid()))
+        }
+        else {
+            Q_UNUSED(m_expandedLinkedNotebookGuids.remove(
+                pLinkedNotebookItem->linkedNotebookGuid()))
+        }
+    }
+}
+
 QString NotebookItemView::selectedItemsGroupKey() const
 {
     return NOTEBOOK_ITEM_VIEW_GROUP_KEY;
@@ -774,27 +790,23 @@ void NotebookItemView::onNotebookStackRenamed(
         return;
     }
 
-    ApplicationSettings appSettings(
-        pNotebookModel->account(), preferences::keys::files::userInterface);
-
-    appSettings.beginGroup(NOTEBOOK_ITEM_VIEW_GROUP_KEY);
-    QString key = LAST_EXPANDED_STACK_ITEMS_KEY;
-    if (!linkedNotebookGuid.isEmpty()) {
-        key += QStringLiteral("/") + linkedNotebookGuid;
-    }
-
-    QStringList expandedStacks = appSettings.value(key).toStringList();
-    appSettings.endGroup();
+    auto & expandedStackNames =
+        m_expandedStackNamesByLinkedNotebookGuid[linkedNotebookGuid];
 
-    int previousStackIndex = expandedStacks.indexOf(previousStackName);
-    if (previousStackIndex < 0) {
+    if (!expandedStackNames.remove(previousStackName)) {
         QNDEBUG("view:notebook", "The renamed stack item hasn't been expanded");
     }
     else {
-        expandedStacks.replace(previousStackIndex, newStackName);
+        Q_UNUSED(expandedStackNames.insert(newStackName))
+        scheduleItemsStateSaving();
     }
 
-    setStacksExpanded(expandedStacks, *pNotebookModel, linkedNotebookGuid);
+    bool wasTrackingNotebookItemsState = trackItemsStateEnabled();
+    setTrackItemsStateEnabled(false);
+
+    setStacksExpanded(*pNotebookModel, linkedNotebookGuid);
+
+    setTrackItemsStateEnabled(wasTrackingNotebookItemsState);
 
     auto newStackItemIndex =
         pNotebookModel->indexForNotebookStack(newStackName, linkedNotebookGuid);
@@ -1083,15 +1095,21 @@ void NotebookItemView::showNotebookStackItemContextMenu(
 #undef ADD_CONTEXT_MENU_ACTION
 
 void NotebookItemView::setStacksExpanded(
-    const QStringList & expandedStackNames, const NotebookModel & model,
-    const QString & linkedNotebookGuid)
+    const NotebookModel & model, const QString & linkedNotebookGuid)
 {
     QNDEBUG(
         "view:notebook",
         "NotebookItemView::setStacksExpanded: "
             << "linked notebook guid = " << linkedNotebookGuid);
 
-    for (const auto & expandedStack: qAsConst(expandedStackNames)) {
+    const auto it =
+        m_expandedStackNamesByLinkedNotebookGuid.constFind(linkedNotebookGuid);
+
+    if (it == m_expandedStackNamesByLinkedNotebookGuid.constEnd()) {
+        return;
+    }
+
+    for (const auto & expandedStack: qAsConst(it.value())) {
         auto index =
             model.indexForNotebookStack(expandedStack, linkedNotebookGuid);
 
@@ -1103,26 +1121,25 @@ void NotebookItemView::setStacksExpanded(
     }
 }
 
-void NotebookItemView::setLinkedNotebooksExpanded(
-    const QStringList & expandedLinkedNotebookGuids,
-    const NotebookModel & model)
+void NotebookItemView::setLinkedNotebooksExpanded(const NotebookModel & model)
 {
     QNDEBUG(
         "view:notebook",
         "NotebookItemView::setLinkedNotebooksExpanded: "
-            << expandedLinkedNotebookGuids.join(QStringLiteral(", ")));
+            << m_expandedLinkedNotebookGuids.size());
 
-    for (const auto & expandedLinkedNotebookGuid:
-         qAsConst(expandedLinkedNotebookGuids))
+    for (auto it = m_expandedLinkedNotebookGuids.begin();
+         it != m_expandedLinkedNotebookGuids.end();)
     {
-        auto index =
-            model.indexForLinkedNotebookGuid(expandedLinkedNotebookGuid);
-
+        auto index = model.indexForLinkedNotebookGuid(*it);
         if (!index.isValid()) {
+            // The linked notebook is no longer within the model
+            it = m_expandedLinkedNotebookGuids.erase(it);
             continue;
         }
 
         setExpanded(index, true);
+        ++it;
     }
 }
 
@@ -49,6 +49,9 @@ private:
     virtual void restoreItemsState(
         const AbstractItemModel & itemModel) override;
 
+    virtual void updateItemExpandedState(
+        const QModelIndex & index, const bool expanded) override;
+
     virtual QString selectedItemsGroupKey() const override;
     virtual QString selectedItemsArrayKey() const override;
     virtual QString selectedItemsKey() const override;
@@ -114,12 +117,9 @@ private:
         const QPoint & point, NotebookModel & model);
 
     void setStacksExpanded(
-        const QStringList & expandedStackNames, const NotebookModel & model,
-        const QString & linkedNotebookGuid);
+        const NotebookModel & model, const QString & linkedNotebookGuid);
 
-    void setLinkedNotebooksExpanded(
-        const QStringList & expandedLinkedNotebookGuids,
-        const NotebookModel & model);
+    void setLinkedNotebooksExpanded(const NotebookModel & model);
 
     void setFavoritedFlag(const QAction & action, const bool favorited);
 
@@ -157,6 +157,11 @@ private:
     QMenu * m_pNotebookStackItemContextMenu = nullptr;
 
     QPointer<const NoteModel> m_pNoteModel;
+
+    // Expanded items are tracked from expanded/collapsed signals so that
+    // saving them doesn't require walking over all model items
+    QHash<QString, QSet<QString>> m_expandedStackNamesByLinkedNotebookGuid;
+    QSet<QString> m_expandedLinkedNotebookGuids;
 };
 
 } // namespace quentier
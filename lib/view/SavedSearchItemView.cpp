@@ -22,6 +22,7 @@
 #include <lib/model/saved_search/SavedSearchModel.h>
 #include <lib/preferences/keys/Files.h>
 #include <lib/preferences/keys/SidePanelsFiltering.h>
+#include <lib/utility/Log.h>
 #include <lib/widget/NoteFiltersManager.h>
 
 #include <quentier/logging/QuentierLogger.h>
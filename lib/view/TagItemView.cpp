@@ -24,6 +24,7 @@
 #include <lib/model/tag/TagModel.h>
 #include <lib/preferences/keys/Files.h>
 #include <lib/preferences/keys/SidePanelsFiltering.h>
+#include <lib/utility/Log.h>
 #include <lib/widget/NoteFiltersManager.h>
 
 #include <quentier/logging/QuentierLogger.h>
@@ -72,59 +73,18 @@ void TagItemView::saveItemsState()
         return;
     }
 
-    QStringList expandedTagItemsLocalUids;
-    QStringList expandedLinkedNotebookItemsGuids;
-
-    auto indexes = pTagModel->persistentIndexes();
-    for (const auto & index: qAsConst(indexes)) {
-        if (!isExpanded(index)) {
-            continue;
-        }
-
-        const auto * pModelItem = pTagModel->itemForIndex(index);
-        if (Q_UNLIKELY(!pModelItem)) {
-            QNWARNING(
-                "view:tag",
-                "Tag model returned null pointer to tag "
-                    << "model item for valid model index");
-            continue;
-        }
-
-        const auto * pTagItem = pModelItem->cast<TagItem>();
-        if (pTagItem) {
-            expandedTagItemsLocalUids << pTagItem->localUid();
-            QNTRACE(
-                "view:tag",
-                "Found expanded tag item: local uid = "
-                    << pTagItem->localUid());
-        }
-
-        const auto * pLinkedNotebookItem =
-            pModelItem->cast<TagLinkedNotebookRootItem>();
-
-        if (pLinkedNotebookItem) {
-            expandedLinkedNotebookItemsGuids
-                << pLinkedNotebookItem->linkedNotebookGuid();
-
-            QNTRACE(
-                "view:tag",
-                "Found expanded tag linked notebook root "
-                    << "item: linked notebook guid = "
-                    << pLinkedNotebookItem->linkedNotebookGuid());
-        }
-    }
-
     ApplicationSettings appSettings(
         pTagModel->account(), preferences::keys::files::userInterface);
 
     appSettings.beginGroup(TAG_ITEM_VIEW_GROUP_KEY);
 
     appSettings.setValue(
-        LAST_EXPANDED_TAG_ITEMS_KEY, expandedTagItemsLocalUids);
+        LAST_EXPANDED_TAG_ITEMS_KEY,
+        QStringList(m_expandedTagLocalUids.values()));
 
     appSettings.setValue(
         LAST_EXPANDED_LINKED_NOTEBOOK_ITEMS_KEY,
-        expandedLinkedNotebookItemsGuids);
+        QStringList(m_expandedLinkedNotebookGuids.values()));
 
     saveAllItemsRootItemExpandedState(
         appSettings, ALL_TAGS_ROOT_ITEM_EXPANDED_KEY,
@@ -143,15 +103,18 @@ void TagItemView::restoreItemsState(const AbstractItemModel & model)
         return;
     }
 
+    // Ensure the changes not yet persisted would not be lost
+    flushPendingState();
+
     ApplicationSettings appSettings(
         model.account(), preferences::keys::files::userInterface);
 
     appSettings.beginGroup(TAG_ITEM_VIEW_GROUP_KEY);
 
-    QStringList expandedTagItemsLocalUids =
+    const QStringList expandedTagItemsLocalUids =
         appSettings.value(LAST_EXPANDED_TAG_ITEMS_KEY).toStringList();
 
-    QStringList expandedLinkedNotebookItemsGuids =
+    const QStringList expandedLinkedNotebookItemsGuids =
         appSettings.value(LAST_EXPANDED_LINKED_NOTEBOOK_ITEMS_KEY)
             .toStringList();
 
@@ -160,11 +123,26 @@ void TagItemView::restoreItemsState(const AbstractItemModel & model)
 
     appSettings.endGroup();
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    m_expandedTagLocalUids = QSet<QString>(
+        expandedTagItemsLocalUids.constBegin(),
+        expandedTagItemsLocalUids.constEnd());
+
+    m_expandedLinkedNotebookGuids = QSet<QString>(
+        expandedLinkedNotebookItemsGuids.constBegin(),
+        expandedLinkedNotebookItemsGuids.constEnd());
+#else
+    m_expandedTagLocalUids = QSet<QString>::fromList(expandedTagItemsLocalUids);
+
+    m_expandedLinkedNotebookGuids =
+        QSet<QString>::fromList(expandedLinkedNotebookItemsGuids);
+#endif
+
     bool wasTrackingTagItemsState = trackItemsStateEnabled();
     setTrackItemsStateEnabled(false);
 
-    setTagsExpanded(expandedTagItemsLocalUids, *pTagModel);
-    setLinkedNotebooksExpanded(expandedLinkedNotebookItemsGuids, *pTagModel);
+    setTagsExpanded(*pTagModel);
+    setLinkedNotebooksExpanded(*pTagModel);
 
     bool allTagsRootItemExpanded = true;
     if (allTagsRootItemExpandedPreference.isValid()) {
@@ -177,6 +155,63 @@ void TagItemView::restoreItemsState(const AbstractItemModel & model)
     setTrackItemsStateEnabled(wasTrackingTagItemsState);
 }
 
+void TagItemView::updateItemExpandedState(
+    const QModelIndex & index, const bool expanded)
+{
+    const auto * pTagModel = qobject_cast<const TagModel *>(model());
+    if (Q_UNLIKELY(!pTagModel)) {
+        QNDEBUG("view:tag", "Non-tag model is used");
+        return;
+    }
+
+    const auto * pModelItem = pTagModel->itemForIndex(index);
+    if (Q_UNLIKELY(!pModelItem)) {
+        QNWARNING(
+            "view:tag",
+            "Tag model returned null pointer to tag "
+                << "model item for valid model index");
+        return;
+    }
+
+    const auto * pTagItem = pModelItem->cast<TagItem>();
+    if (pTagItem) {
+        QNTRACE(
+            "view:tag",
+            "Tag item " << (expanded ? "expanded" : "collapsed")
+                        << ": local uid = " << pTagItem->localUid());
+
+        if (expanded) {
+            Q_UNUSED(m_expandedTagLocalUids.insert(pTagItem->localUid()))
+        }
+        else {
+            Q_UNUSED(m_expandedTagLocalUids.remove(pTagItem->localUid()))
+        }
+
+        return;
+    }
+
+    const auto * pLinkedNotebookItem =
+        pModelItem->cast<TagLinkedNotebookRootItem>();
+
+    if (pLinkedNotebookItem) {
+        QNTRACE(
+            "view:tag",
+            "Tag linked notebook root item "
+                << (expanded ? "expanded" : "collapsed")
+                << ": linked notebook guid = "
+                << pLinkedNotebookItem->linkedNotebookGuid());
+
+        if (expanded) {
+            Q_UNUSED(m_expandedLinkedNotebookGuids.insert(
+                pLinkedNotebookItem->linkedNotebookGuid()))
+        }
+        else {
+            Q_UNUSED(m_expandedLinkedNotebookGuids.remove(
+                pLinkedNotebookItem->linkedNotebookGuid()))
+        }
+    }
+}
+
 QString TagItemView::selectedItemsGroupKey() const
 {
     return TAG_ITEM_VIEW_GROUP_KEY;
@@ -749,6 +784,9 @@ void TagItemView::onTagParentChanged(const QModelIndex & tagIndex)
         setExpanded(parentIndex, true);
 
         setTrackItemsStateEnabled(wasTrackingTagItemsState);
+
+        updateItemExpandedState(parentIndex, true);
+        scheduleItemsStateSaving();
     }
 
     restoreItemsState(*pTagModel);
@@ -997,44 +1035,45 @@ void TagItemView::contextMenuEvent(QContextMenuEvent * pEvent)
 
 #undef ADD_CONTEXT_MENU_ACTION
 
-void TagItemView::setTagsExpanded(
-    const QStringList & tagLocalUids, const TagModel & model)
+void TagItemView::setTagsExpanded(const TagModel & model)
 {
     QNDEBUG(
         "view:tag",
-        "TagItemView::setTagsExpanded: "
-            << tagLocalUids.size()
-            << ", tag local uids: " << tagLocalUids.join(QStringLiteral(",")));
+        "TagItemView::setTagsExpanded: " << m_expandedTagLocalUids.size());
 
-    for (const auto & tagLocalUid: qAsConst(tagLocalUids)) {
-        QModelIndex index = model.indexForLocalUid(tagLocalUid);
+    for (auto it = m_expandedTagLocalUids.begin();
+         it != m_expandedTagLocalUids.end();)
+    {
+        QModelIndex index = model.indexForLocalUid(*it);
         if (!index.isValid()) {
+            // The tag is no longer within the model, no need to keep it
+            it = m_expandedTagLocalUids.erase(it);
             continue;
         }
 
         setExpanded(index, true);
+        ++it;
     }
 }
 
-void TagItemView::setLinkedNotebooksExpanded(
-    const QStringList & linkedNotebookGuids, const TagModel & model)
+void TagItemView::setLinkedNotebooksExpanded(const TagModel & model)
 {
     QNDEBUG(
         "view:tag",
         "TagItemView::setLinkedNotebooksExpanded: "
-            << linkedNotebookGuids.size() << ", linked notebook guids: "
-            << linkedNotebookGuids.join(QStringLiteral(", ")));
+            << m_expandedLinkedNotebookGuids.size());
 
-    for (const auto & expandedLinkedNotebookGuid: qAsConst(linkedNotebookGuids))
+    for (auto it = m_expandedLinkedNotebookGuids.begin();
+         it != m_expandedLinkedNotebookGuids.end();)
     {
-        QModelIndex index =
-            model.indexForLinkedNotebookGuid(expandedLinkedNotebookGuid);
-
+        QModelIndex index = model.indexForLinkedNotebookGuid(*it);
         if (!index.isValid()) {
+            it = m_expandedLinkedNotebookGuids.erase(it);
             continue;
         }
 
         setExpanded(index, true);
+        ++it;
     }
 }
 
@@ -43,6 +43,9 @@ private:
     virtual void restoreItemsState(
         const AbstractItemModel & itemModel) override;
 
+    virtual void updateItemExpandedState(
+        const QModelIndex & index, const bool expanded) override;
+
     virtual QString selectedItemsGroupKey() const override;
     virtual QString selectedItemsArrayKey() const override;
     virtual QString selectedItemsKey() const override;
@@ -95,11 +98,8 @@ private Q_SLOTS:
     virtual void contextMenuEvent(QContextMenuEvent * pEvent) override;
 
 private:
-    void setTagsExpanded(
-        const QStringList & tagLocalUids, const TagModel & model);
-
-    void setLinkedNotebooksExpanded(
-        const QStringList & linkedNotebookGuids, const TagModel & model);
+    void setTagsExpanded(const TagModel & model);
+    void setLinkedNotebooksExpanded(const TagModel & model);
 
     void setFavoritedFlag(const QAction & action, const bool favorited);
 
@@ -108,6 +108,11 @@ private:
 
 private:
     QMenu * m_pTagItemContextMenu = nullptr;
+
+    // Expanded items are tracked from expanded/collapsed signals so that
+    // saving them doesn't require walking over all model items
+    QSet<QString> m_expandedTagLocalUids;
+    QSet<QString> m_expandedLinkedNotebookGuids;
 };
 
 } // namespace quentier
@@ -24,6 +24,7 @@
 
 #include <lib/model/common/AbstractItemModel.h>
 #include <lib/preferences/keys/Files.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
@@ -228,23 +229,28 @@ void AbstractFilterByModelItemWidget::addItemToFilter(
         return;
     }
 
-    auto * pItemWidget = new ListItemWidget(
-        itemName, localUid, linkedNotebookGuid, linkedNotebookUsername, this);
-
-    QObject::connect(
-        pItemWidget, &ListItemWidget::itemRemovedFromList, this,
-        &AbstractFilterByModelItemWidget::onItemRemovedFromList);
+    auto * pItemWidget = acquireItemWidget(
+        itemName, localUid, linkedNotebookGuid, linkedNotebookUsername);
 
     auto * pNewItemLineEdit = findNewItemWidget();
     if (pNewItemLineEdit) {
         m_pLayout->removeWidget(pNewItemLineEdit);
-        pNewItemLineEdit->hide();
-        pNewItemLineEdit->deleteLater();
-        pNewItemLineEdit = nullptr;
     }
 
     m_pLayout->addWidget(pItemWidget);
-    addNewItemWidget();
+
+    if (pNewItemLineEdit) {
+        NewListItemLineEdit::ItemInfo reservedItem;
+        reservedItem.m_name = itemName;
+        reservedItem.m_linkedNotebookGuid = linkedNotebookGuid;
+        reservedItem.m_linkedNotebookUsername = linkedNotebookUsername;
+        pNewItemLineEdit->addReservedItem(std::move(reservedItem));
+
+        m_pLayout->addWidget(pNewItemLineEdit);
+    }
+    else {
+        addNewItemWidget();
+    }
 
     persistFilteredItems();
 }
@@ -357,8 +363,7 @@ void AbstractFilterByModelItemWidget::onItemRemovedFromLocalStorage(
         }
 
         m_pLayout->removeWidget(pItemWidget);
-        pItemWidget->hide();
-        pItemWidget->deleteLater();
+        releaseItemWidget(pItemWidget);
         break;
     }
 
@@ -439,13 +444,9 @@ void AbstractFilterByModelItemWidget::onNewItemAdded()
 
     m_pLayout->removeWidget(pNewItemLineEdit);
 
-    auto * pItemWidget = new ListItemWidget(
+    auto * pItemWidget = acquireItemWidget(
         newItemName, localUid, newItemLinkedNotebookGuid,
-        newItemLinkedNotebookUsername, this);
-
-    QObject::connect(
-        pItemWidget, &ListItemWidget::itemRemovedFromList, this,
-        &AbstractFilterByModelItemWidget::onItemRemovedFromList);
+        newItemLinkedNotebookUsername);
 
     m_pLayout->addWidget(pItemWidget);
 
@@ -494,8 +495,7 @@ void AbstractFilterByModelItemWidget::onItemRemovedFromList(
         }
 
         m_pLayout->removeWidget(pItemWidget);
-        pItemWidget->hide();
-        pItemWidget->deleteLater();
+        releaseItemWidget(pItemWidget);
         break;
     }
 
@@ -612,13 +612,9 @@ void AbstractFilterByModelItemWidget::restoreFilteredItems()
             continue;
         }
 
-        auto * pItemWidget = new ListItemWidget(
+        auto * pItemWidget = acquireItemWidget(
             itemInfo.m_name, itemLocalUid, itemInfo.m_linkedNotebookGuid,
-            itemInfo.m_linkedNotebookUsername, this);
-
-        QObject::connect(
-            pItemWidget, &ListItemWidget::itemRemovedFromList, this,
-            &AbstractFilterByModelItemWidget::onItemRemovedFromList);
+            itemInfo.m_linkedNotebookUsername);
 
         m_pLayout->addWidget(pItemWidget);
     }
@@ -689,11 +685,49 @@ void AbstractFilterByModelItemWidget::clearLayout()
 
         auto * pWidget = pItem->widget();
         m_pLayout->removeWidget(pWidget);
+
+        auto * pItemWidget = qobject_cast<ListItemWidget *>(pWidget);
+        if (pItemWidget) {
+            releaseItemWidget(pItemWidget);
+            continue;
+        }
+
         pWidget->hide();
         pWidget->deleteLater();
     }
 }
 
+ListItemWidget * AbstractFilterByModelItemWidget::acquireItemWidget(
+    const QString & name, const QString & localUid,
+    const QString & linkedNotebookGuid, const QString & linkedNotebookUsername)
+{
+    if (!m_itemWidgetsPool.isEmpty()) {
+        auto * pItemWidget = m_itemWidgetsPool.takeLast();
+        pItemWidget->setName(name);
+        pItemWidget->setLocalUid(localUid);
+        pItemWidget->setLinkedNotebookGuid(linkedNotebookGuid);
+        pItemWidget->setLinkedNotebookUsername(linkedNotebookUsername);
+        pItemWidget->show();
+        return pItemWidget;
+    }
+
+    auto * pItemWidget = new ListItemWidget(
+        name, localUid, linkedNotebookGuid, linkedNotebookUsername, this);
+
+    QObject::connect(
+        pItemWidget, &ListItemWidget::itemRemovedFromList, this,
+        &AbstractFilterByModelItemWidget::onItemRemovedFromList);
+
+    return pItemWidget;
+}
+
+void AbstractFilterByModelItemWidget::releaseItemWidget(
+    ListItemWidget * pItemWidget)
+{
+    pItemWidget->hide();
+    m_itemWidgetsPool << pItemWidget;
+}
+
 NewListItemLineEdit * AbstractFilterByModelItemWidget::findNewItemWidget()
 {
     const int numItems = m_pLayout->count();
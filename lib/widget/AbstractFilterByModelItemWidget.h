@@ -24,6 +24,7 @@
 #include <quentier/utility/SuppressWarnings.h>
 
 #include <QPointer>
+#include <QVector>
 #include <QWidget>
 
 QT_FORWARD_DECLARE_CLASS(FlowLayout)
@@ -31,6 +32,7 @@ QT_FORWARD_DECLARE_CLASS(FlowLayout)
 namespace quentier {
 
 QT_FORWARD_DECLARE_CLASS(AbstractItemModel)
+QT_FORWARD_DECLARE_CLASS(ListItemWidget)
 QT_FORWARD_DECLARE_CLASS(NewListItemLineEdit)
 
 /**
@@ -160,6 +162,13 @@ private:
     void addNewItemWidget();
     void clearLayout();
 
+    ListItemWidget * acquireItemWidget(
+        const QString & name, const QString & localUid,
+        const QString & linkedNotebookGuid,
+        const QString & linkedNotebookUsername);
+
+    void releaseItemWidget(ListItemWidget * pItemWidget);
+
     NewListItemLineEdit * findNewItemWidget();
 
 private:
@@ -168,6 +177,10 @@ private:
     Account m_account;
     QPointer<AbstractItemModel> m_pItemModel;
     bool m_isReady = false;
+
+    // Item widgets removed from the filter are kept for reuse instead of
+    // being destroyed as the filter is rebuilt on each update
+    QVector<ListItemWidget *> m_itemWidgetsPool;
 };
 
 } // namespace quentier
@@ -20,6 +20,7 @@
 
 #include <lib/model/saved_search/SavedSearchModel.h>
 #include <lib/preferences/keys/Files.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
@@ -19,6 +19,8 @@
 #include "FilterBySearchStringWidget.h"
 #include "ui_FilterBySearchStringWidget.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 
 namespace quentier {
@@ -19,6 +19,7 @@
 #include "FilterByTagWidget.h"
 
 #include <lib/model/tag/TagModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/local_storage/LocalStorageManagerAsync.h>
 #include <quentier/logging/QuentierLogger.h>
@@ -78,6 +78,7 @@ FlowLayout::~FlowLayout()
 void FlowLayout::addItem(QLayoutItem * item)
 {
     itemList.append(item);
+    clearCachedSizes();
 }
 
 int FlowLayout::horizontalSpacing() const
@@ -111,12 +112,19 @@ QLayoutItem * FlowLayout::itemAt(int index) const
 QLayoutItem * FlowLayout::takeAt(int index)
 {
     if (index >= 0 && index < itemList.size()) {
+        clearCachedSizes();
         return itemList.takeAt(index);
     }
 
     return 0;
 }
 
+void FlowLayout::invalidate()
+{
+    clearCachedSizes();
+    QLayout::invalidate();
+}
+
 Qt::Orientations FlowLayout::expandingDirections() const
 {
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
@@ -133,7 +141,12 @@ bool FlowLayout::hasHeightForWidth() const
 
 int FlowLayout::heightForWidth(int width) const
 {
-    return doLayout(QRect(0, 0, width, 0), true);
+    if (m_cachedHeightForWidthWidth != width) {
+        m_cachedHeightForWidth = doLayout(QRect(0, 0, width, 0), true);
+        m_cachedHeightForWidthWidth = width;
+    }
+
+    return m_cachedHeightForWidth;
 }
 
 void FlowLayout::setGeometry(const QRect & rect)
@@ -167,41 +180,71 @@ int FlowLayout::doLayout(const QRect & rect, bool testOnly) const
     int y = effectiveRect.y();
     int lineHeight = 0;
 
-    for (auto it = itemList.begin(), end = itemList.end(); it != end; ++it) {
-        QLayoutItem * item = *it;
-        QWidget * wid = item->widget();
-        QSizePolicy::ControlType controlType = wid->sizePolicy().controlType();
+    const int hSpace = horizontalSpacing();
+    const int vSpace = verticalSpacing();
+    const auto & sizeHints = itemSizeHints();
 
-        int spaceX = horizontalSpacing();
-        if (spaceX == -1) {
-            spaceX = wid->style()->layoutSpacing(
-                controlType, controlType, Qt::Horizontal);
-        }
+    for (int i = 0, size = itemList.size(); i < size; ++i) {
+        QLayoutItem * item = itemList.at(i);
+        const QSize & itemSizeHint = sizeHints.at(i);
+
+        int spaceX = hSpace;
+        int spaceY = vSpace;
+        if (spaceX == -1 || spaceY == -1) {
+            QWidget * wid = item->widget();
+            QSizePolicy::ControlType controlType =
+                wid->sizePolicy().controlType();
 
-        int spaceY = verticalSpacing();
-        if (spaceY == -1) {
-            spaceY = wid->style()->layoutSpacing(
-                controlType, controlType, Qt::Vertical);
+            if (spaceX == -1) {
+                spaceX = wid->style()->layoutSpacing(
+                    controlType, controlType, Qt::Horizontal);
+            }
+
+            if (spaceY == -1) {
+                spaceY = wid->style()->layoutSpacing(
+                    controlType, controlType, Qt::Vertical);
+            }
         }
 
-        int nextX = x + item->sizeHint().width() + spaceX;
+        int nextX = x + itemSizeHint.width() + spaceX;
         if (nextX - spaceX > effectiveRect.right() && lineHeight > 0) {
             x = effectiveRect.x();
             y = y + lineHeight + spaceY;
-            nextX = x + item->sizeHint().width() + spaceX;
+            nextX = x + itemSizeHint.width() + spaceX;
             lineHeight = 0;
         }
 
         if (!testOnly) {
-            item->setGeometry(QRect(QPoint(x, y), item->sizeHint()));
+            item->setGeometry(QRect(QPoint(x, y), itemSizeHint));
         }
 
         x = nextX;
-        lineHeight = qMax(lineHeight, item->sizeHint().height());
+        lineHeight = qMax(lineHeight, itemSizeHint.height());
     }
 
     return y + lineHeight - rect.y() + bottom;
 }
+
+const QVector<QSize> & FlowLayout::itemSizeHints() const
+{
+    if (m_cachedSizeHints.size() != itemList.size()) {
+        m_cachedSizeHints.clear();
+        m_cachedSizeHints.reserve(itemList.size());
+        for (const auto * item: qAsConst(itemList)) {
+            m_cachedSizeHints << item->sizeHint();
+        }
+    }
+
+    return m_cachedSizeHints;
+}
+
+void FlowLayout::clearCachedSizes()
+{
+    m_cachedSizeHints.clear();
+    m_cachedHeightForWidthWidth = -1;
+    m_cachedHeightForWidth = -1;
+}
+
 int FlowLayout::smartSpacing(QStyle::PixelMetric pm) const
 {
     QObject * parent = this->parent();
@@ -54,6 +54,7 @@
 #include <QLayout>
 #include <QRect>
 #include <QStyle>
+#include <QVector>
 
 class FlowLayout final : public QLayout
 {
@@ -77,14 +78,25 @@ public:
     void setGeometry(const QRect & rect) override;
     QSize sizeHint() const override;
     QLayoutItem * takeAt(int index) override;
+    void invalidate() override;
 
 private:
     int doLayout(const QRect & rect, bool testOnly) const;
     int smartSpacing(QStyle::PixelMetric pm) const;
 
+    const QVector<QSize> & itemSizeHints() const;
+    void clearCachedSizes();
+
     QList<QLayoutItem *> itemList;
     int m_hSpace;
     int m_vSpace;
+
+    // Size hints of items are cached between layout passes and dropped
+    // whenever the layout is invalidated i.e. when items are added or removed
+    // or when any of the managed widgets calls updateGeometry
+    mutable QVector<QSize> m_cachedSizeHints;
+    mutable int m_cachedHeightForWidthWidth = -1;
+    mutable int m_cachedHeightForWidth = -1;
 };
 
 #endif // FLOWLAYOUT_H
@@ -19,6 +19,8 @@
 #include "ListItemWidget.h"
 #include "ui_ListItemWidget.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 
 namespace quentier {
@@ -102,6 +104,7 @@ QString ListItemWidget::name() const
 void ListItemWidget::setName(QString name)
 {
     m_pUi->itemNameLabel->setText(std::move(name));
+    updateGeometry();
 }
 
 QString ListItemWidget::localUid() const
@@ -122,6 +125,7 @@ QString ListItemWidget::linkedNotebookUsername() const
 void ListItemWidget::setLinkedNotebookUsername(QString name)
 {
     m_pUi->linkedNotebookUsernameLabel->setText(std::move(name));
+    updateGeometry();
 }
 
 QString ListItemWidget::linkedNotebookGuid() const
@@ -141,6 +145,8 @@ void ListItemWidget::setLinkedNotebookGuid(QString guid)
         m_pUi->userLabel->show();
         m_pUi->linkedNotebookUsernameLabel->show();
     }
+
+    updateGeometry();
 }
 
 QSize ListItemWidget::sizeHint() const
@@ -156,6 +162,7 @@ QSize ListItemWidget::minimumSizeHint() const
 void ListItemWidget::setItemRemovable(bool removable)
 {
     m_pUi->deleteItemButton->setHidden(!removable);
+    updateGeometry();
 }
 
 void ListItemWidget::onRemoveItemButtonPressed()
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStorageRequestTracerWidget.h"
+
+#include <lib/model/common/LocalStorageRequestTracer.h>
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/StandardPaths.h>
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimerEvent>
+#include <QVBoxLayout>
+
+#define REFRESH_TIMER_PERIOD (1000)
+
+namespace quentier {
+
+namespace {
+
+enum class Column
+{
+    RequestType = 0,
+    Requests,
+    FailedRequests,
+    AverageLatency,
+    MaxLatency,
+    AverageQueueWait,
+    MaxQueueWait,
+    AveragePayloadSize,
+    MaxPayloadSize
+};
+
+constexpr int columnCount()
+{
+    return static_cast<int>(Column::MaxPayloadSize) + 1;
+}
+
+void setCell(
+    QTableWidget & table, const int row, const Column column,
+    const QString & text)
+{
+    auto * pItem = table.item(row, static_cast<int>(column));
+    if (!pItem) {
+        pItem = new QTableWidgetItem;
+        pItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+        if (column != Column::RequestType) {
+            pItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+
+        table.setItem(row, static_cast<int>(column), pItem);
+    }
+
+    pItem->setText(text);
+}
+
+QString average(const qint64 total, const quint64 count)
+{
+    if (count == 0) {
+        return QStringLiteral("0");
+    }
+
+    return QString::number(
+        static_cast<double>(total) / static_cast<double>(count), 'f', 1);
+}
+
+} // namespace
+
+LocalStorageRequestTracerWidget::LocalStorageRequestTracerWidget(
+    LocalStorageRequestTracer & tracer, QWidget * parent) :
+    QWidget(parent),
+    m_pTracer(&tracer), m_pRequestsInFlightLabel(new QLabel(this)),
+    m_pStatisticsTableWidget(new QTableWidget(this))
+{
+    m_pStatisticsTableWidget->setColumnCount(columnCount());
+    m_pStatisticsTableWidget->setHorizontalHeaderLabels(
+        QStringList() << tr("Request") << tr("Count") << tr("Failed")
+                      << tr("Avg latency, ms") << tr("Max latency, ms")
+                      << tr("Avg queue wait, ms") << tr("Max queue wait, ms")
+                      << tr("Avg items") << tr("Max items"));
+
+    m_pStatisticsTableWidget->verticalHeader()->hide();
+    m_pStatisticsTableWidget->setSelectionBehavior(
+        QAbstractItemView::SelectRows);
+
+    m_pStatisticsTableWidget->horizontalHeader()->setSectionResizeMode(
+        QHeaderView::ResizeToContents);
+
+    auto * pResetButton = new QPushButton(tr("Reset"), this);
+    auto * pExportButton =
+        new QPushButton(tr("Export to file") + QStringLiteral("..."), this);
+
+    auto * pButtonsLayout = new QHBoxLayout;
+    pButtonsLayout->addWidget(m_pRequestsInFlightLabel);
+    pButtonsLayout->addStretch();
+    pButtonsLayout->addWidget(pResetButton);
+    pButtonsLayout->addWidget(pExportButton);
+
+    auto * pLayout = new QVBoxLayout(this);
+    pLayout->setContentsMargins(0, 0, 0, 0);
+    pLayout->addWidget(m_pStatisticsTableWidget);
+    pLayout->addLayout(pButtonsLayout);
+
+    QObject::connect(
+        pResetButton, &QPushButton::clicked, this,
+        &LocalStorageRequestTracerWidget::onResetButtonPressed);
+
+    QObject::connect(
+        pExportButton, &QPushButton::clicked, this,
+        &LocalStorageRequestTracerWidget::onExportButtonPressed);
+
+    refresh();
+}
+
+LocalStorageRequestTracerWidget::~LocalStorageRequestTracerWidget() = default;
+
+void LocalStorageRequestTracerWidget::onResetButtonPressed()
+{
+    QNDEBUG(
+        "widget:local_storage_request_tracer",
+        "LocalStorageRequestTracerWidget::onResetButtonPressed");
+
+    if (m_pTracer.isNull()) {
+        return;
+    }
+
+    m_pTracer->reset();
+    refresh();
+}
+
+void LocalStorageRequestTracerWidget::onExportButtonPressed()
+{
+    QNDEBUG(
+        "widget:local_storage_request_tracer",
+        "LocalStorageRequestTracerWidget::onExportButtonPressed");
+
+    if (m_pTracer.isNull()) {
+        return;
+    }
+
+    const QString filePath = QFileDialog::getSaveFileName(
+        this, tr("Export to file") + QStringLiteral("..."), documentsPath(),
+        tr("CSV files") + QStringLiteral(" (*.csv)"));
+
+    if (filePath.isEmpty()) {
+        QNDEBUG("widget:local_storage_request_tracer", "Export cancelled");
+        return;
+    }
+
+    ErrorString errorDescription;
+    if (!m_pTracer->exportToFile(filePath, errorDescription)) {
+        Q_EMIT notifyError(errorDescription);
+    }
+}
+
+void LocalStorageRequestTracerWidget::refresh()
+{
+    if (m_pTracer.isNull()) {
+        m_pRequestsInFlightLabel->clear();
+        m_pStatisticsTableWidget->setRowCount(0);
+        return;
+    }
+
+    m_pRequestsInFlightLabel->setText(
+        tr("Requests in flight") + QStringLiteral(": ") +
+        QString::number(m_pTracer->requestsInFlight()) +
+        QStringLiteral(", ") + tr("expired without response") +
+        QStringLiteral(": ") +
+        QString::number(m_pTracer->expiredRequestsCount()));
+
+    const auto & statistics = m_pTracer->statistics();
+    m_pStatisticsTableWidget->setRowCount(statistics.size());
+
+    int row = 0;
+    for (auto it = statistics.constBegin(), end = statistics.constEnd();
+         it != end; ++it, ++row)
+    {
+        const auto & entry = it.value();
+        const quint64 count = entry.m_requestsCount;
+        auto & table = *m_pStatisticsTableWidget;
+
+        setCell(table, row, Column::RequestType, it.key());
+        setCell(table, row, Column::Requests, QString::number(count));
+
+        setCell(
+            table, row, Column::FailedRequests,
+            QString::number(entry.m_failedRequestsCount));
+
+        setCell(
+            table, row, Column::AverageLatency,
+            average(entry.m_totalLatencyMsec, count));
+
+        setCell(
+            table, row, Column::MaxLatency,
+            QString::number(entry.m_maxLatencyMsec));
+
+        setCell(
+            table, row, Column::AverageQueueWait,
+            average(entry.m_totalQueueWaitMsec, count));
+
+        setCell(
+            table, row, Column::MaxQueueWait,
+            QString::number(entry.m_maxQueueWaitMsec));
+
+        setCell(
+            table, row, Column::AveragePayloadSize,
+            average(static_cast<qint64>(entry.m_totalPayloadSize), count));
+
+        setCell(
+            table, row, Column::MaxPayloadSize,
+            QString::number(entry.m_maxPayloadSize));
+    }
+}
+
+void LocalStorageRequestTracerWidget::showEvent(QShowEvent * pEvent)
+{
+    refresh();
+    m_refreshTimer.start(REFRESH_TIMER_PERIOD, this);
+    QWidget::showEvent(pEvent);
+}
+
+void LocalStorageRequestTracerWidget::hideEvent(QHideEvent * pEvent)
+{
+    m_refreshTimer.stop();
+    QWidget::hideEvent(pEvent);
+}
+
+void LocalStorageRequestTracerWidget::timerEvent(QTimerEvent * pEvent)
+{
+    if (Q_UNLIKELY(!pEvent)) {
+        return;
+    }
+
+    if (pEvent->timerId() == m_refreshTimer.timerId()) {
+        refresh();
+        return;
+    }
+
+    QWidget::timerEvent(pEvent);
+}
+
+} // namespace quentier
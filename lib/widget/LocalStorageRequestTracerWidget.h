@@ -0,0 +1,78 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_WIDGET_LOCAL_STORAGE_REQUEST_TRACER_WIDGET_H
+#define QUENTIER_LIB_WIDGET_LOCAL_STORAGE_REQUEST_TRACER_WIDGET_H
+
+#include <quentier/types/ErrorString.h>
+
+#include <QBasicTimer>
+#include <QPointer>
+#include <QWidget>
+
+QT_FORWARD_DECLARE_CLASS(QLabel)
+QT_FORWARD_DECLARE_CLASS(QTableWidget)
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageRequestTracer)
+
+/**
+ * @brief The LocalStorageRequestTracerWidget class displays the statistics
+ * of local storage requests collected by LocalStorageRequestTracer and allows
+ * to export them to a file
+ *
+ * The displayed statistics are refreshed periodically while the widget is
+ * visible.
+ */
+class LocalStorageRequestTracerWidget final : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LocalStorageRequestTracerWidget(
+        LocalStorageRequestTracer & tracer, QWidget * parent = nullptr);
+
+    virtual ~LocalStorageRequestTracerWidget() override;
+
+Q_SIGNALS:
+    void notifyError(ErrorString errorDescription);
+
+private Q_SLOTS:
+    void onResetButtonPressed();
+    void onExportButtonPressed();
+
+private:
+    void refresh();
+
+private:
+    virtual void showEvent(QShowEvent * pEvent) override;
+    virtual void hideEvent(QHideEvent * pEvent) override;
+    virtual void timerEvent(QTimerEvent * pEvent) override;
+
+private:
+    QPointer<LocalStorageRequestTracer> m_pTracer;
+
+    QLabel * m_pRequestsInFlightLabel;
+    QTableWidget * m_pStatisticsTableWidget;
+
+    QBasicTimer m_refreshTimer;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_WIDGET_LOCAL_STORAGE_REQUEST_TRACER_WIDGET_H
@@ -19,8 +19,11 @@
 #include "LogViewerWidget.h"
 #include "ui_LogViewerWidget.h"
 
+#include "LocalStorageRequestTracerWidget.h"
+
 #include <lib/delegate/LogViewerDelegate.h>
 #include <lib/preferences/keys/Logging.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/utility/ApplicationSettings.h>
 #include <quentier/utility/Compat.h>
@@ -51,7 +54,8 @@
 
 namespace quentier {
 
-LogViewerWidget::LogViewerWidget(QWidget * parent) :
+LogViewerWidget::LogViewerWidget(
+    QWidget * parent, LocalStorageRequestTracer * pLocalStorageRequestTracer) :
     QWidget(parent, Qt::Window), m_pUi(new Ui::LogViewerWidget),
     m_pLogViewerModel(new LogViewerModel(this))
 {
@@ -82,6 +86,7 @@ LogViewerWidget::LogViewerWidget(QWidget * parent) :
     setupLogFiles();
     setupFilterByLogLevelWidget();
     setupFilterByComponent();
+    setupLocalStorageRequestTracer(pLocalStorageRequestTracer);
     startWatchingForLogFilesFolderChanges();
 
     m_pUi->logEntriesTableView->setModel(m_pLogViewerModel);
@@ -111,6 +116,12 @@ LogViewerWidget::LogViewerWidget(QWidget * parent) :
         m_pUi->logFileWipePushButton, &QPushButton::clicked, this,
         &LogViewerWidget::onWipeLogPushButtonPressed);
 
+    m_pUi->structuredLogCheckBox->setChecked(restoreStructuredLogEnabled());
+
+    QObject::connect(
+        m_pUi->structuredLogCheckBox, &QCheckBox::toggled, this,
+        &LogViewerWidget::onStructuredLogCheckboxToggled);
+
     QObject::connect(
         m_pUi->filterByContentLineEdit, &QLineEdit::editingFinished, this,
         &LogViewerWidget::onFilterByContentEditingFinished);
@@ -348,6 +359,32 @@ void LogViewerWidget::setupFilterByComponent()
         this, &LogViewerWidget::onFilterByComponentEditingFinished);
 }
 
+void LogViewerWidget::setupLocalStorageRequestTracer(
+    LocalStorageRequestTracer * pLocalStorageRequestTracer)
+{
+    if (!pLocalStorageRequestTracer) {
+        m_pUi->localStorageRequestsPushButton->hide();
+        return;
+    }
+
+    m_pLocalStorageRequestTracerWidget =
+        new LocalStorageRequestTracerWidget(*pLocalStorageRequestTracer, this);
+
+    m_pLocalStorageRequestTracerWidget->hide();
+
+    // Right below the log entries and filters, above the status bar
+    m_pUi->verticalLayout->insertWidget(1, m_pLocalStorageRequestTracerWidget);
+
+    QObject::connect(
+        m_pLocalStorageRequestTracerWidget,
+        &LocalStorageRequestTracerWidget::notifyError, this,
+        &LogViewerWidget::onModelError);
+
+    QObject::connect(
+        m_pUi->localStorageRequestsPushButton, &QPushButton::toggled, this,
+        &LogViewerWidget::onLocalStorageRequestsButtonToggled);
+}
+
 void LogViewerWidget::onCurrentLogLevelChanged(int index)
 {
     QNDEBUG(
@@ -365,7 +402,7 @@ void LogViewerWidget::onCurrentLogLevelChanged(int index)
         return;
     }
 
-    QuentierSetMinLogLevel(static_cast<LogLevel>(index));
+    applyMinLogLevel(static_cast<LogLevel>(index));
 
     ApplicationSettings appSettings;
     appSettings.beginGroup(preferences::keys::loggingGroup);
@@ -478,7 +515,7 @@ void LogViewerWidget::onFilterByComponentEditingFinished()
     saveFilterByComponentState();
 
     QRegularExpression regex(m_pUi->filterByComponentRegexLineEdit->text());
-    QuentierSetLogComponentFilter(regex);
+    applyLogComponentFilter(regex);
 }
 
 void LogViewerWidget::onCurrentLogFileChanged(int currentLogFileIndex)
@@ -674,7 +711,7 @@ void LogViewerWidget::onTraceButtonToggled(bool checked)
         }
 
         // Enable tracing
-        QuentierSetMinLogLevel(LogLevel::Trace);
+        applyMinLogLevel(LogLevel::Trace);
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
         QObject::disconnect(
@@ -732,7 +769,7 @@ void LogViewerWidget::onTraceButtonToggled(bool checked)
         m_pUi->tracePushButton->setText(tr("Trace"));
 
         // Restore the previously backed up settings
-        QuentierSetMinLogLevel(m_minLogLevelBeforeTracing);
+        applyMinLogLevel(m_minLogLevelBeforeTracing);
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
         QObject::disconnect(
@@ -810,6 +847,30 @@ void LogViewerWidget::onTraceButtonToggled(bool checked)
     scheduleLogEntriesViewColumnsResize();
 }
 
+void LogViewerWidget::onStructuredLogCheckboxToggled(bool checked)
+{
+    QNDEBUG(
+        "widget:log_viewer",
+        "LogViewerWidget::onStructuredLogCheckboxToggled: "
+            << (checked ? "checked" : "unchecked"));
+
+    applyStructuredLogEnabled(checked);
+
+    ApplicationSettings appSettings;
+    appSettings.beginGroup(preferences::keys::loggingGroup);
+    appSettings.setValue(preferences::keys::enableStructuredLog, checked);
+    appSettings.endGroup();
+}
+
+void LogViewerWidget::onLocalStorageRequestsButtonToggled(bool checked)
+{
+    if (Q_UNLIKELY(!m_pLocalStorageRequestTracerWidget)) {
+        return;
+    }
+
+    m_pLocalStorageRequestTracerWidget->setVisible(checked);
+}
+
 void LogViewerWidget::onModelError(ErrorString errorDescription)
 {
     m_pUi->logFilePendingLoadLabel->setText(QString());
@@ -1181,7 +1242,7 @@ void LogViewerWidget::closeEvent(QCloseEvent * pEvent)
 {
     if (m_pUi->tracePushButton->isChecked()) {
         // Restore the previously backed up log level
-        QuentierSetMinLogLevel(m_minLogLevelBeforeTracing);
+        applyMinLogLevel(m_minLogLevelBeforeTracing);
     }
 
     QWidget::closeEvent(pEvent);
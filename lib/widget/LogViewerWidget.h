@@ -38,11 +38,16 @@ QT_FORWARD_DECLARE_CLASS(QMenu)
 
 namespace quentier {
 
+QT_FORWARD_DECLARE_CLASS(LocalStorageRequestTracer)
+QT_FORWARD_DECLARE_CLASS(LocalStorageRequestTracerWidget)
+
 class LogViewerWidget final : public QWidget
 {
     Q_OBJECT
 public:
-    explicit LogViewerWidget(QWidget * parent = nullptr);
+    explicit LogViewerWidget(
+        QWidget * parent = nullptr,
+        LocalStorageRequestTracer * pLocalStorageRequestTracer = nullptr);
 
     virtual ~LogViewerWidget() override;
 
@@ -52,6 +57,8 @@ private:
     void startWatchingForLogFilesFolderChanges();
     void setupFilterByLogLevelWidget();
     void setupFilterByComponent();
+    void setupLocalStorageRequestTracer(
+        LocalStorageRequestTracer * pLocalStorageRequestTracer);
 
 private Q_SLOTS:
     void onCurrentLogLevelChanged(int index);
@@ -73,6 +80,8 @@ private Q_SLOTS:
     void onResetButtonPressed();
 
     void onTraceButtonToggled(bool checked);
+    void onStructuredLogCheckboxToggled(bool checked);
+    void onLocalStorageRequestsButtonToggled(bool checked);
 
     void onModelError(ErrorString errorDescription);
     void onModelRowsInserted(const QModelIndex & parent, int first, int last);
@@ -120,6 +129,9 @@ private:
     QCheckBox * m_logLevelEnabledCheckboxPtrs[6];
     QMenu * m_pLogEntriesContextMenu = nullptr;
 
+    LocalStorageRequestTracerWidget * m_pLocalStorageRequestTracerWidget =
+        nullptr;
+
     // Backups for tracing mode
     LogLevel m_minLogLevelBeforeTracing = LogLevel::Info;
     QString m_filterByContentBeforeTracing;
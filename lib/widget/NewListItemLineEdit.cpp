@@ -19,7 +19,9 @@
 #include "NewListItemLineEdit.h"
 #include "ui_NewListItemLineEdit.h"
 
+#include <lib/model/common/ItemNameCompletionIndex.h>
 #include <lib/model/tag/TagModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
@@ -28,10 +30,6 @@
 #include <QAbstractItemView>
 #include <QCompleter>
 #include <QKeyEvent>
-#include <QModelIndex>
-#include <QStringListModel>
-
-#include <algorithm>
 
 namespace quentier {
 
@@ -41,25 +39,12 @@ NewListItemLineEdit::NewListItemLineEdit(
     QLineEdit(parent),
     m_pUi(new Ui::NewListItemLineEdit), m_pItemModel(pItemModel),
     m_reservedItems(std::move(reservedItems)),
-    m_pItemNamesModel(new QStringListModel(this)),
     m_pCompleter(new QCompleter(this))
 {
     m_pUi->setupUi(this);
     setPlaceholderText(tr("Click here to add") + QStringLiteral("..."));
     setupCompleter();
 
-    QObject::connect(
-        m_pItemModel.data(), &AbstractItemModel::rowsInserted, this,
-        &NewListItemLineEdit::onModelRowsInserted);
-
-    QObject::connect(
-        m_pItemModel.data(), &AbstractItemModel::rowsRemoved, this,
-        &NewListItemLineEdit::onModelRowsRemoved);
-
-    QObject::connect(
-        m_pItemModel.data(), &AbstractItemModel::dataChanged, this,
-        &NewListItemLineEdit::onModelDataChanged);
-
     // NOTE: working around what seems to be a Qt bug: when one selects some
     // item from the drop-down menu shown by QCompleter via pressing
     // Return/Enter, the line edit can't be cleared unless one presses Enter
@@ -99,6 +84,7 @@ void NewListItemLineEdit::setTargetLinkedNotebookGuid(
     QString linkedNotebookGuid)
 {
     m_targetLinkedNotebookGuid = std::move(linkedNotebookGuid);
+    setupCompleter();
 }
 
 QVector<NewListItemLineEdit::ItemInfo> NewListItemLineEdit::reservedItems()
@@ -195,67 +181,27 @@ void NewListItemLineEdit::focusInEvent(QFocusEvent * pEvent)
     }
 }
 
-void NewListItemLineEdit::onModelRowsInserted(
-    const QModelIndex & parent, int start, int end)
-{
-    QNDEBUG(
-        "widget:new_list_item_line_edit",
-        "NewListItemLineEdit::onModelRowsInserted");
-
-    Q_UNUSED(parent)
-    Q_UNUSED(start)
-    Q_UNUSED(end)
-
-    setupCompleter();
-}
-
-void NewListItemLineEdit::onModelRowsRemoved(
-    const QModelIndex & parent, int start, int end)
-{
-    QNDEBUG(
-        "widget:new_list_item_line_edit",
-        "NewListItemLineEdit::onModelRowsRemoved");
-
-    Q_UNUSED(parent)
-    Q_UNUSED(start)
-    Q_UNUSED(end)
-
-    setupCompleter();
-}
-
-void NewListItemLineEdit::onModelDataChanged(
-    const QModelIndex & topLeft, const QModelIndex & bottomRight,
-    const QVector<int> & roles)
-{
-    QNDEBUG(
-        "widget:new_list_item_line_edit",
-        "NewListItemLineEdit::onModelDataChanged");
-
-    Q_UNUSED(topLeft)
-    Q_UNUSED(bottomRight)
-    Q_UNUSED(roles)
-
-    setupCompleter();
-}
-
 void NewListItemLineEdit::setupCompleter()
 {
     QNDEBUG(
         "widget:new_list_item_line_edit",
         "NewListItemLineEdit::setupCompleter");
 
+    if (m_pItemModel.isNull()) {
+        return;
+    }
+
     m_pCompleter->setCaseSensitivity(Qt::CaseInsensitive);
     m_pCompleter->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
 
-    auto itemNames = itemNamesForCompleter();
-    m_pItemNamesModel->setStringList(itemNames);
+    // The index is shared between all line edits dealing with the same model
+    // and is kept up to date by itself so there's no need to track the changes
+    // of the model here
+    auto * pCompletionIndex = ItemNameCompletionIndex::forModel(*m_pItemModel);
 
-    QNTRACE(
-        "widget:new_list_item_line_edit",
-        "The item names to set to the completer: "
-            << itemNames.join(QStringLiteral(", ")));
+    m_pCompleter->setModel(
+        pCompletionIndex->completionModel(m_targetLinkedNotebookGuid));
 
-    m_pCompleter->setModel(m_pItemNamesModel);
     setCompleter(m_pCompleter);
 
 #ifdef LIB_QUENTIER_USE_QT_WEB_ENGINE
@@ -268,47 +214,4 @@ void NewListItemLineEdit::setupCompleter()
 #endif
 }
 
-QStringList NewListItemLineEdit::itemNamesForCompleter() const
-{
-    if (m_pItemModel.isNull()) {
-        return {};
-    }
-
-    QStringList itemNames;
-
-    if (!m_targetLinkedNotebookGuid.isNull()) {
-        itemNames = m_pItemModel->itemNames(m_targetLinkedNotebookGuid);
-
-        if (!m_targetLinkedNotebookGuid.isEmpty()) {
-            QString linkedNotebookUsername =
-                m_pItemModel->linkedNotebookUsername(
-                    m_targetLinkedNotebookGuid);
-
-            for (auto & itemName: itemNames) {
-                itemName += QStringLiteral(" \\ @");
-                itemName += linkedNotebookUsername;
-            }
-        }
-    }
-    else {
-        // First list item names corresponding to user's own account
-        itemNames = m_pItemModel->itemNames(QLatin1String(""));
-
-        // Now add items corresponding to linked notebooks
-        auto linkedNotebooksInfo = m_pItemModel->linkedNotebooksInfo();
-        for (const auto & info: qAsConst(linkedNotebooksInfo)) {
-            auto linkedNotebookItemNames = m_pItemModel->itemNames(info.m_guid);
-            for (auto & itemName: linkedNotebookItemNames) {
-                itemName += QStringLiteral(" \\ @");
-                itemName += info.m_username;
-            }
-
-            itemNames << linkedNotebookItemNames;
-        }
-    }
-
-    std::sort(itemNames.begin(), itemNames.end());
-    return itemNames;
-}
-
 } // namespace quentier
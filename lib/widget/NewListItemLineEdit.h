@@ -31,8 +31,6 @@ class NewListItemLineEdit;
 }
 
 QT_FORWARD_DECLARE_CLASS(QCompleter)
-QT_FORWARD_DECLARE_CLASS(QModelIndex)
-QT_FORWARD_DECLARE_CLASS(QStringListModel)
 
 namespace quentier {
 
@@ -75,24 +73,13 @@ protected:
     virtual void keyPressEvent(QKeyEvent * pEvent) override;
     virtual void focusInEvent(QFocusEvent * pEvent) override;
 
-private Q_SLOTS:
-    void onModelRowsInserted(const QModelIndex & parent, int start, int end);
-    void onModelRowsRemoved(const QModelIndex & parent, int start, int end);
-
-    void onModelDataChanged(
-        const QModelIndex & topLeft, const QModelIndex & bottomRight,
-        const QVector<int> & roles = QVector<int>());
-
 private:
     void setupCompleter();
 
-    QStringList itemNamesForCompleter() const;
-
 private:
     Ui::NewListItemLineEdit * m_pUi;
     QPointer<AbstractItemModel> m_pItemModel;
     QVector<ItemInfo> m_reservedItems;
-    QStringListModel * m_pItemNamesModel;
     QCompleter * m_pCompleter;
     QString m_targetLinkedNotebookGuid;
 };
@@ -19,6 +19,7 @@
 #include "NoteCountLabelController.h"
 
 #include <lib/model/note/NoteModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 
@@ -25,6 +25,7 @@
 #include <lib/preferences/defaults/NoteEditor.h>
 #include <lib/preferences/keys/Files.h>
 #include <lib/preferences/keys/NoteEditor.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/note_editor/NoteEditor.h>
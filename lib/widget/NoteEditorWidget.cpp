@@ -28,12 +28,14 @@
 
 #include <lib/delegate/LimitedFontsDelegate.h>
 #include <lib/enex/EnexExportDialog.h>
+#include <lib/model/common/ModelItemMimeData.h>
 #include <lib/model/tag/TagModel.h>
 #include <lib/preferences/defaults/NoteEditor.h>
 #include <lib/preferences/keys/Enex.h>
 #include <lib/preferences/keys/Files.h>
 #include <lib/preferences/keys/NoteEditor.h>
 #include <lib/utility/BasicXMLSyntaxHighlighter.h>
+#include <lib/utility/Log.h>
 
 // Doh, Qt Designer's inability to work with namespaces in the expected way
 // is deeply disappointing
@@ -802,13 +804,13 @@ void NoteEditorWidget::dropEvent(QDropEvent * pEvent)
         return;
     }
 
-    QByteArray data = qUncompress(pMimeData->data(TAG_MODEL_MIME_TYPE));
-    QDataStream in(&data, QIODevice::ReadOnly);
-
-    qint32 type = 0;
-    in >> type;
-
-    if (type != static_cast<qint32>(ITagModelItem::Type::Tag)) {
+    QString tagLocalUid;
+    QString tagGuid;
+    if (!readModelItemMimeData<TagItem>(
+            *pMimeData, TAG_MODEL_MIME_TYPE,
+            static_cast<qint32>(ITagModelItem::Type::Tag), tagLocalUid,
+            tagGuid))
+    {
         QNDEBUG(
             "widget:note_editor",
             "Can only drop tag model items of tag "
@@ -816,9 +818,6 @@ void NoteEditorWidget::dropEvent(QDropEvent * pEvent)
         return;
     }
 
-    TagItem item;
-    in >> item;
-
     if (Q_UNLIKELY(!m_pCurrentNote)) {
         QNDEBUG(
             "widget:note_editor",
@@ -827,26 +826,26 @@ void NoteEditorWidget::dropEvent(QDropEvent * pEvent)
         return;
     }
 
-    if (m_pCurrentNote->tagLocalUids().contains(item.localUid())) {
+    if (m_pCurrentNote->tagLocalUids().contains(tagLocalUid)) {
         QNDEBUG(
             "widget:note_editor",
             "Note set to the note editor ("
                 << m_pCurrentNote->localUid()
                 << ")is already marked with tag with "
-                << "local uid " << item.localUid());
+                << "local uid " << tagLocalUid);
         return;
     }
 
     QNDEBUG(
         "widget:note_editor",
-        "Adding tag with local uid " << item.localUid()
+        "Adding tag with local uid " << tagLocalUid
                                      << " to note with local uid "
                                      << m_pCurrentNote->localUid());
 
-    m_pCurrentNote->addTagLocalUid(item.localUid());
+    m_pCurrentNote->addTagLocalUid(tagLocalUid);
 
-    if (!item.guid().isEmpty()) {
-        m_pCurrentNote->addTagGuid(item.guid());
+    if (!tagGuid.isEmpty()) {
+        m_pCurrentNote->addTagGuid(tagGuid);
     }
 
     QStringList tagLocalUids = m_pCurrentNote->tagLocalUids();
@@ -25,10 +25,12 @@
 
 #include <lib/dialog/AddOrEditSavedSearchDialog.h>
 #include <lib/model/note/NoteModel.h>
+#include <lib/model/note/NoteSearchIndex.h>
 #include <lib/model/notebook/NotebookModel.h>
 #include <lib/model/saved_search/SavedSearchModel.h>
 #include <lib/model/tag/TagModel.h>
 #include <lib/preferences/keys/Files.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
@@ -56,13 +58,15 @@ NoteFiltersManager::NoteFiltersManager(
     FilterByNotebookWidget & filterByNotebookWidget, NoteModel & noteModel,
     FilterBySavedSearchWidget & filterBySavedSearchWidget,
     FilterBySearchStringWidget & FilterBySearchStringWidget,
-    LocalStorageManagerAsync & localStorageManagerAsync, QObject * parent) :
+    LocalStorageManagerAsync & localStorageManagerAsync, QObject * parent,
+    NoteSearchIndex * pNoteSearchIndex) :
     QObject(parent),
     m_account(account), m_filterByTagWidget(filterByTagWidget),
     m_filterByNotebookWidget(filterByNotebookWidget), m_pNoteModel(&noteModel),
     m_filterBySavedSearchWidget(filterBySavedSearchWidget),
     m_filterBySearchStringWidget(FilterBySearchStringWidget),
-    m_localStorageManagerAsync(localStorageManagerAsync)
+    m_localStorageManagerAsync(localStorageManagerAsync),
+    m_pNoteSearchIndex(pNoteSearchIndex)
 {
     createConnections();
 
@@ -1196,6 +1200,28 @@ bool NoteFiltersManager::setFilterBySearchString()
     // query (if there was any)
     m_findNoteLocalUidsForSavedSearchQueryRequestId = QUuid();
 
+    QSet<QString> noteLocalUids;
+    if (!m_pNoteSearchIndex.isNull() &&
+        m_pNoteSearchIndex->findNoteLocalUids(searchString, noteLocalUids))
+    {
+        QNTRACE(
+            "widget:note_filters",
+            "Found " << noteLocalUids.size() << " notes corresponding to "
+                     << "the search string within the note search index: "
+                     << searchString);
+
+        // Invalidate the active request to find note local uids per search
+        // string (if there was any) so that its results don't override these
+        m_findNoteLocalUidsForSearchStringRequestId = QUuid();
+
+        m_pNoteModel->setFilteredNoteLocalUids(noteLocalUids);
+
+        m_filterByTagWidget.setDisabled(true);
+        m_filterByNotebookWidget.setDisabled(true);
+
+        return true;
+    }
+
     m_findNoteLocalUidsForSearchStringRequestId = QUuid::createUuid();
 
     QNTRACE(
@@ -35,6 +35,7 @@ QT_FORWARD_DECLARE_CLASS(FilterBySavedSearchWidget)
 QT_FORWARD_DECLARE_CLASS(FilterBySearchStringWidget)
 QT_FORWARD_DECLARE_CLASS(FilterByTagWidget)
 QT_FORWARD_DECLARE_CLASS(NoteModel)
+QT_FORWARD_DECLARE_CLASS(NoteSearchIndex)
 QT_FORWARD_DECLARE_CLASS(TagModel)
 
 class NoteFiltersManager final : public QObject
@@ -47,7 +48,8 @@ public:
         FilterBySavedSearchWidget & filterBySavedSearchWidget,
         FilterBySearchStringWidget & FilterBySearchStringWidget,
         LocalStorageManagerAsync & localStorageManagerAsync,
-        QObject * parent = nullptr);
+        QObject * parent = nullptr,
+        NoteSearchIndex * pNoteSearchIndex = nullptr);
 
     virtual ~NoteFiltersManager() override;
 
@@ -217,6 +219,9 @@ private:
     FilterBySearchStringWidget & m_filterBySearchStringWidget;
     LocalStorageManagerAsync & m_localStorageManagerAsync;
 
+    // Answers simple search strings without querying the local storage
+    QPointer<NoteSearchIndex> m_pNoteSearchIndex;
+
     QString m_filteredSavedSearchLocalUid;
 
     QString m_lastSearchString;
@@ -23,6 +23,7 @@
 #include "NewListItemLineEdit.h"
 
 #include <lib/model/tag/TagModel.h>
+#include <lib/utility/Log.h>
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/Compat.h>
@@ -56,6 +57,14 @@ void NoteTagsWidget::setTagModel(TagModel * pTagModel)
             &NoteTagsWidget::onAllTagsListed);
     }
 
+    if ((m_pTagModel.data() != pTagModel) && m_pNewTagLineEdit) {
+        // The line edit's completer is bound to the previous tag model
+        m_pLayout->removeWidget(m_pNewTagLineEdit);
+        m_pNewTagLineEdit->hide();
+        m_pNewTagLineEdit->deleteLater();
+        m_pNewTagLineEdit = nullptr;
+    }
+
     m_pTagModel = QPointer<TagModel>(pTagModel);
 }
 
@@ -282,9 +291,8 @@ void NoteTagsWidget::onTagRemoved(
             pNewItemLineEdit->removeReservedItem(removedItemInfo);
         }
 
-        Q_UNUSED(m_pLayout->takeAt(i));
-        pTagItemWidget->hide();
-        pTagItemWidget->deleteLater();
+        delete m_pLayout->takeAt(i);
+        releaseTagWidget(pTagItemWidget);
         break;
     }
 
@@ -463,18 +471,7 @@ void NoteTagsWidget::onNewTagNameEntered()
     newItemLineEditHadFocus = pNewItemLineEdit->hasFocus();
     Q_UNUSED(m_pLayout->removeWidget(pNewItemLineEdit))
 
-    auto * pTagWidget = new ListItemWidget(tagName, tagLocalUid, this);
-    pTagWidget->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
-    pTagWidget->setItemRemovable(m_tagRestrictions.m_canUpdateNote);
-
-    QObject::connect(
-        pTagWidget, &ListItemWidget::itemRemovedFromList, this,
-        &NoteTagsWidget::onTagRemoved);
-
-    QObject::connect(
-        this, &NoteTagsWidget::canUpdateNoteRestrictionChanged, pTagWidget,
-        &ListItemWidget::setItemRemovable);
-
+    auto * pTagWidget = acquireTagWidget(tagName, tagLocalUid);
     m_pLayout->addWidget(pTagWidget);
 
     m_pLayout->addWidget(pNewItemLineEdit);
@@ -690,9 +687,8 @@ void NoteTagsWidget::onUpdateTagComplete(Tag tag, QUuid requestId)
                        "tag's "
                     << "widget");
 
-            pItem = m_pLayout->takeAt(i);
-            pItem->widget()->hide();
-            pItem->widget()->deleteLater();
+            delete m_pLayout->takeAt(i);
+            releaseTagWidget(pNoteTagWidget);
         }
         else {
             pNoteTagWidget->setName(tagName);
@@ -723,17 +719,19 @@ void NoteTagsWidget::onExpungeTagComplete(
 
 void NoteTagsWidget::clearLayout(const bool skipNewTagWidget)
 {
-    while (m_pLayout->count() > 0) {
-        auto * pItem = m_pLayout->takeAt(0);
-        pItem->widget()->hide();
-        pItem->widget()->deleteLater();
+    const auto tagWidgets = takeTagWidgetsFromLayout();
+    for (auto * pTagWidget: tagWidgets) {
+        releaseTagWidget(pTagWidget);
+    }
+
+    if (m_pNewTagLineEdit) {
+        m_pNewTagLineEdit->hide();
+        m_pNewTagLineEdit->clear();
     }
 
     m_lastDisplayedTagLocalUids.clear();
     m_currentNoteTagLocalUidToNameBimap.clear();
 
-    addTagIconToLayout();
-
     if (skipNewTagWidget || m_currentNote.localUid().isEmpty() ||
         m_currentNotebookLocalUid.isEmpty() ||
         !m_tagRestrictions.m_canUpdateNote)
@@ -802,14 +800,14 @@ void NoteTagsWidget::updateLayout()
         return;
     }
 
-    clearLayout(/* skip new tag widget = */ true);
-
     if (!m_pTagModel->allTagsListed()) {
         QNDEBUG(
             "widget:note_tags",
             "Not all tags have been listed within "
                 << "the tag model yet");
 
+        clearLayout(/* skip new tag widget = */ true);
+
         QObject::connect(
             m_pTagModel.data(), &TagModel::notifyAllTagsListed, this,
             &NoteTagsWidget::onAllTagsListed, Qt::UniqueConnection);
@@ -817,11 +815,15 @@ void NoteTagsWidget::updateLayout()
         return;
     }
 
-    m_lastDisplayedTagLocalUids.reserve(numTags);
+    // Widgets of tags still present within the note are put back into
+    // the layout in the note's tag order, the rest are returned to the pool
+    auto tagWidgetsByLocalUid = takeTagWidgetsFromLayout();
 
-    QStringList tagNames;
-    tagNames.reserve(numTags);
+    m_lastDisplayedTagLocalUids.clear();
+    m_lastDisplayedTagLocalUids.reserve(numTags);
+    m_currentNoteTagLocalUidToNameBimap.clear();
 
+    int numDisplayedTags = 0;
     for (int i = 0; i < numTags; ++i) {
         const QString & tagLocalUid = tagLocalUids[i];
 
@@ -858,34 +860,39 @@ void NoteTagsWidget::updateLayout()
         m_currentNoteTagLocalUidToNameBimap.insert(
             TagLocalUidToNameBimap::value_type(tagLocalUid, tagName));
 
-        tagNames << tagName;
-    }
-
-    for (int i = 0, size = tagNames.size(); i < size; ++i) {
-        const QString & tagName = tagNames[i];
-        const QString & tagLocalUid = tagLocalUids[i];
-
-        auto * pTagWidget = new ListItemWidget(tagName, tagLocalUid, this);
-        pTagWidget->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
-        pTagWidget->setItemRemovable(m_tagRestrictions.m_canUpdateNote);
+        ListItemWidget * pTagWidget = nullptr;
+        auto widgetIt = tagWidgetsByLocalUid.find(tagLocalUid);
+        if (widgetIt != tagWidgetsByLocalUid.end()) {
+            pTagWidget = widgetIt.value();
+            tagWidgetsByLocalUid.erase(widgetIt);
 
-        QObject::connect(
-            pTagWidget, &ListItemWidget::itemRemovedFromList, this,
-            &NoteTagsWidget::onTagRemoved);
+            if (pTagWidget->name() != tagName) {
+                pTagWidget->setName(tagName);
+            }
 
-        QObject::connect(
-            this, &NoteTagsWidget::canUpdateNoteRestrictionChanged, pTagWidget,
-            &ListItemWidget::setItemRemovable);
+            pTagWidget->setItemRemovable(m_tagRestrictions.m_canUpdateNote);
+        }
+        else {
+            pTagWidget = acquireTagWidget(tagName, tagLocalUid);
+        }
 
         m_pLayout->addWidget(pTagWidget);
+        ++numDisplayedTags;
+    }
+
+    for (auto * pTagWidget: qAsConst(tagWidgetsByLocalUid)) {
+        releaseTagWidget(pTagWidget);
     }
 
     if (Q_LIKELY(
-            (tagNames.size() < m_pTagModel->account().noteTagCountMax()) &&
+            (numDisplayedTags < m_pTagModel->account().noteTagCountMax()) &&
             (m_tagRestrictions.m_canUpdateNote)))
     {
         addNewTagWidgetToLayout();
     }
+    else if (m_pNewTagLineEdit) {
+        m_pNewTagLineEdit->hide();
+    }
 }
 
 void NoteTagsWidget::addTagIconToLayout()
@@ -893,34 +900,19 @@ void NoteTagsWidget::addTagIconToLayout()
     QNTRACE("widget:note_tags", "NoteTagsWidget::addTagIconToLayout");
 
     QPixmap tagIconImage(QStringLiteral(":/tag/tag.png"));
-    auto * pTagIconLabel = new QLabel(this);
-    pTagIconLabel->setPixmap(tagIconImage.scaled(QSize(20, 20)));
-    pTagIconLabel->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-    m_pLayout->addWidget(pTagIconLabel);
+    m_pTagIconLabel = new QLabel(this);
+    m_pTagIconLabel->setPixmap(tagIconImage.scaled(QSize(20, 20)));
+    m_pTagIconLabel->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    m_pLayout->addWidget(m_pTagIconLabel);
 }
 
 void NoteTagsWidget::addNewTagWidgetToLayout()
 {
     QNTRACE("widget:note_tags", "NoteTagsWidget::addNewTagWidgetToLayout");
 
-    const int numItems = m_pLayout->count();
-    for (int i = 0; i < numItems; ++i) {
-        auto * pItem = m_pLayout->itemAt(i);
-        if (Q_UNLIKELY(!pItem)) {
-            continue;
-        }
-
-        auto * pNewItemWidget =
-            qobject_cast<NewListItemLineEdit *>(pItem->widget());
-
-        if (!pNewItemWidget) {
-            continue;
-        }
-
-        pItem = m_pLayout->takeAt(i);
-        pItem->widget()->hide();
-        pItem->widget()->deleteLater();
-        break;
+    if (m_pNewTagLineEdit) {
+        m_pLayout->removeWidget(m_pNewTagLineEdit);
+        m_pNewTagLineEdit->hide();
     }
 
     if (Q_UNLIKELY(m_pTagModel.isNull())) {
@@ -944,6 +936,17 @@ void NoteTagsWidget::addNewTagWidgetToLayout()
         return;
     }
 
+    QString linkedNotebookUsername;
+    if (!m_currentLinkedNotebookGuid.isEmpty()) {
+        auto linkedNotebooksInfo = m_pTagModel->linkedNotebooksInfo();
+        for (const auto & linkedNotebookInfo: qAsConst(linkedNotebooksInfo)) {
+            if (linkedNotebookInfo.m_guid == m_currentLinkedNotebookGuid) {
+                linkedNotebookUsername = linkedNotebookInfo.m_username;
+                break;
+            }
+        }
+    }
+
     QVector<NewListItemLineEdit::ItemInfo> reservedItems;
 
     reservedItems.reserve(
@@ -956,62 +959,126 @@ void NoteTagsWidget::addNewTagWidgetToLayout()
         NewListItemLineEdit::ItemInfo item;
         item.m_name = it->first;
         item.m_linkedNotebookGuid = m_currentLinkedNotebookGuid;
+        item.m_linkedNotebookUsername = linkedNotebookUsername;
+        reservedItems << item;
+    }
 
-        if (!item.m_linkedNotebookGuid.isEmpty()) {
-            auto linkedNotebooksInfo = m_pTagModel->linkedNotebooksInfo();
-            for (const auto & linkedNotebookInfo: qAsConst(linkedNotebooksInfo))
-            {
-                if (linkedNotebookInfo.m_guid == item.m_linkedNotebookGuid) {
-                    item.m_linkedNotebookUsername =
-                        linkedNotebookInfo.m_username;
+    QString targetLinkedNotebookGuid =
+        (m_currentLinkedNotebookGuid.isEmpty() ? QLatin1String("")
+                                               : m_currentLinkedNotebookGuid);
 
-                    break;
-                }
-            }
-        }
-    }
+    if (!m_pNewTagLineEdit) {
+        m_pNewTagLineEdit =
+            new NewListItemLineEdit(m_pTagModel, reservedItems, this);
 
-    auto * pNewTagLineEdit =
-        new NewListItemLineEdit(m_pTagModel, reservedItems, this);
+        m_pNewTagLineEdit->setTargetLinkedNotebookGuid(
+            targetLinkedNotebookGuid);
 
-    pNewTagLineEdit->setTargetLinkedNotebookGuid(
-        m_currentLinkedNotebookGuid.isEmpty() ? QLatin1String("")
-                                              : m_currentLinkedNotebookGuid);
+        QObject::connect(
+            m_pNewTagLineEdit, &NewListItemLineEdit::returnPressed, this,
+            &NoteTagsWidget::onNewTagNameEntered);
 
-    QObject::connect(
-        pNewTagLineEdit, &NewListItemLineEdit::returnPressed, this,
-        &NoteTagsWidget::onNewTagNameEntered);
+        QObject::connect(
+            m_pNewTagLineEdit,
+            &NewListItemLineEdit::receivedFocusFromWindowSystem, this,
+            &NoteTagsWidget::newTagLineEditReceivedFocusFromWindowSystem);
+    }
+    else {
+        m_pNewTagLineEdit->setReservedItems(std::move(reservedItems));
 
-    QObject::connect(
-        pNewTagLineEdit, &NewListItemLineEdit::receivedFocusFromWindowSystem,
-        this, &NoteTagsWidget::newTagLineEditReceivedFocusFromWindowSystem);
+        if (m_pNewTagLineEdit->targetLinkedNotebookGuid() !=
+            targetLinkedNotebookGuid)
+        {
+            m_pNewTagLineEdit->setTargetLinkedNotebookGuid(
+                targetLinkedNotebookGuid);
+        }
+    }
 
-    m_pLayout->addWidget(pNewTagLineEdit);
+    m_pLayout->addWidget(m_pNewTagLineEdit);
+    m_pNewTagLineEdit->show();
 }
 
 void NoteTagsWidget::removeNewTagWidgetFromLayout()
 {
     QNTRACE("widget:note_tags", "NoteTagsWidget::removeNewTagWidgetFromLayout");
 
-    int numItems = m_pLayout->count();
-    for (int i = 0; i < numItems; ++i) {
+    if (!m_pNewTagLineEdit) {
+        return;
+    }
+
+    m_pLayout->removeWidget(m_pNewTagLineEdit);
+    m_pNewTagLineEdit->hide();
+    m_pNewTagLineEdit->clear();
+}
+
+QHash<QString, ListItemWidget *> NoteTagsWidget::takeTagWidgetsFromLayout()
+{
+    QHash<QString, ListItemWidget *> tagWidgetsByLocalUid;
+
+    for (int i = m_pLayout->count() - 1; i >= 0; --i) {
         auto * pItem = m_pLayout->itemAt(i);
         if (Q_UNLIKELY(!pItem)) {
             continue;
         }
 
-        auto * pNewTagLineEdit =
-            qobject_cast<NewListItemLineEdit *>(pItem->widget());
+        auto * pWidget = pItem->widget();
+        if (pWidget == m_pTagIconLabel) {
+            continue;
+        }
+
+        delete m_pLayout->takeAt(i);
 
-        if (!pNewTagLineEdit) {
+        auto * pTagWidget = qobject_cast<ListItemWidget *>(pWidget);
+        if (!pTagWidget) {
+            // The new tag line edit is put back by addNewTagWidgetToLayout
             continue;
         }
 
-        pItem = m_pLayout->takeAt(i);
-        delete pItem->widget();
-        delete pItem;
-        break;
+        auto it = tagWidgetsByLocalUid.find(pTagWidget->localUid());
+        if (Q_UNLIKELY(it != tagWidgetsByLocalUid.end())) {
+            releaseTagWidget(it.value());
+            it.value() = pTagWidget;
+            continue;
+        }
+
+        tagWidgetsByLocalUid[pTagWidget->localUid()] = pTagWidget;
     }
+
+    return tagWidgetsByLocalUid;
+}
+
+ListItemWidget * NoteTagsWidget::acquireTagWidget(
+    const QString & tagName, const QString & tagLocalUid)
+{
+    ListItemWidget * pTagWidget = nullptr;
+
+    if (!m_tagWidgetsPool.isEmpty()) {
+        pTagWidget = m_tagWidgetsPool.takeLast();
+        pTagWidget->setName(tagName);
+        pTagWidget->setLocalUid(tagLocalUid);
+    }
+    else {
+        pTagWidget = new ListItemWidget(tagName, tagLocalUid, this);
+        pTagWidget->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
+
+        QObject::connect(
+            pTagWidget, &ListItemWidget::itemRemovedFromList, this,
+            &NoteTagsWidget::onTagRemoved);
+
+        QObject::connect(
+            this, &NoteTagsWidget::canUpdateNoteRestrictionChanged, pTagWidget,
+            &ListItemWidget::setItemRemovable);
+    }
+
+    pTagWidget->setItemRemovable(m_tagRestrictions.m_canUpdateNote);
+    pTagWidget->show();
+    return pTagWidget;
+}
+
+void NoteTagsWidget::releaseTagWidget(ListItemWidget * pTagWidget)
+{
+    pTagWidget->hide();
+    m_tagWidgetsPool << pTagWidget;
 }
 
 void NoteTagsWidget::removeTagWidgetFromLayout(const QString & tagLocalUid)
@@ -1068,9 +1135,8 @@ void NoteTagsWidget::removeTagWidgetFromLayout(const QString & tagLocalUid)
             continue;
         }
 
-        pItem = m_pLayout->takeAt(i);
-        pItem->widget()->hide();
-        pItem->widget()->deleteLater();
+        delete m_pLayout->takeAt(i);
+        releaseTagWidget(pNoteTagWidget);
         break;
     }
 }
@@ -1136,21 +1202,8 @@ void NoteTagsWidget::createConnections(
 
 NewListItemLineEdit * NoteTagsWidget::findNewItemWidget()
 {
-    const int numItems = m_pLayout->count();
-    for (int i = 0; i < numItems; ++i) {
-        auto * pItem = m_pLayout->itemAt(i);
-        if (Q_UNLIKELY(!pItem)) {
-            continue;
-        }
-
-        auto * pNewItemWidget =
-            qobject_cast<NewListItemLineEdit *>(pItem->widget());
-
-        if (!pNewItemWidget) {
-            continue;
-        }
-
-        return pNewItemWidget;
+    if (m_pNewTagLineEdit && (m_pLayout->indexOf(m_pNewTagLineEdit) >= 0)) {
+        return m_pNewTagLineEdit;
     }
 
     return nullptr;
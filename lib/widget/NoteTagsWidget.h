@@ -26,6 +26,7 @@
 #include <QHash>
 #include <QPointer>
 #include <QSet>
+#include <QVector>
 #include <QWidget>
 
 SAVE_WARNINGS
@@ -37,11 +38,13 @@ MSVC_SUPPRESS_WARNING(4834)
 RESTORE_WARNINGS
 
 QT_FORWARD_DECLARE_CLASS(FlowLayout)
+QT_FORWARD_DECLARE_CLASS(QLabel)
 
 namespace quentier {
 
-QT_FORWARD_DECLARE_CLASS(TagModel)
+QT_FORWARD_DECLARE_CLASS(ListItemWidget)
 QT_FORWARD_DECLARE_CLASS(NewListItemLineEdit)
+QT_FORWARD_DECLARE_CLASS(TagModel)
 
 /**
  * @brief The NoteTagsWidget class demonstrates the tags of a particular note
@@ -140,6 +143,13 @@ private:
     void removeNewTagWidgetFromLayout();
     void removeTagWidgetFromLayout(const QString & tagLocalUid);
 
+    QHash<QString, ListItemWidget *> takeTagWidgetsFromLayout();
+
+    ListItemWidget * acquireTagWidget(
+        const QString & tagName, const QString & tagLocalUid);
+
+    void releaseTagWidget(ListItemWidget * pTagWidget);
+
     void setTagItemsRemovable(const bool removable);
 
     void createConnections(LocalStorageManagerAsync & localStorageManagerAsync);
@@ -169,6 +179,14 @@ private:
     StringUtils m_stringUtils;
 
     FlowLayout * m_pLayout;
+
+    QLabel * m_pTagIconLabel = nullptr;
+    NewListItemLineEdit * m_pNewTagLineEdit = nullptr;
+
+    // Tag widgets which are not displayed at the moment but are kept around
+    // so that switching between notes doesn't create and destroy the widgets
+    // for each tag over and over again
+    QVector<ListItemWidget *> m_tagWidgetsPool;
 };
 
 } // namespace quentier
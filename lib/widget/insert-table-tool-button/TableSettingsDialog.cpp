@@ -19,6 +19,8 @@
 #include "TableSettingsDialog.h"
 #include "ui_TableSettingsDialog.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 
 namespace quentier {
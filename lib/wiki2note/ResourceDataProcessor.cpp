@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ResourceDataProcessor.h"
+
+#include <lib/utility/Log.h>
+
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QCryptographicHash>
+#include <QMimeDatabase>
+#include <QMimeType>
+
+namespace quentier {
+
+ResourceDataProcessor::ResourceDataProcessor(
+    const QUrl & url, const QByteArray & data, QObject * parent) :
+    QObject(parent),
+    QRunnable(), m_url(url), m_data(data)
+{}
+
+void ResourceDataProcessor::run()
+{
+    QNDEBUG("wiki2note", "ResourceDataProcessor::run: url = " << m_url);
+
+    QByteArray dataHash =
+        QCryptographicHash::hash(m_data, QCryptographicHash::Md5);
+
+    QMimeDatabase mimeDatabase;
+    QMimeType mimeType = mimeDatabase.mimeTypeForData(m_data);
+    if (!mimeType.isValid()) {
+        // Try to extract the mime type from url
+        QString urlString = m_url.toString();
+        QString fileName;
+
+        int index = urlString.lastIndexOf(QChar::fromLatin1('/'));
+        if (index >= 0) {
+            fileName = urlString.mid(index + 1);
+        }
+
+        auto mimeTypes = mimeDatabase.mimeTypesForFileName(fileName);
+        for (auto it = mimeTypes.constBegin(), end = mimeTypes.constEnd();
+             it != end; ++it)
+        {
+            if (it->isValid()) {
+                mimeType = *it;
+                break;
+            }
+        }
+    }
+
+    QString mime;
+    if (mimeType.isValid()) {
+        mime = mimeType.name();
+    }
+    else {
+        // Just a wild guess as a last resort
+        mime = QStringLiteral("image/png");
+    }
+
+    Q_EMIT finished(m_url, dataHash, mime);
+}
+
+} // namespace quentier
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021 Dmitry Ivanov
+ *
+ * This file is part of Quentier.
+ *
+ * Quentier is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Quentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUENTIER_LIB_WIKI2NOTE_RESOURCE_DATA_PROCESSOR_H
+#define QUENTIER_LIB_WIKI2NOTE_RESOURCE_DATA_PROCESSOR_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QRunnable>
+#include <QUrl>
+
+namespace quentier {
+
+/**
+ * @brief The ResourceDataProcessor class computes the data hash and detects
+ * the mime type of the downloaded resource data; it is meant to be run
+ * on a thread pool so that these computations don't block the thread
+ * processing the network replies.
+ */
+class ResourceDataProcessor final : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    explicit ResourceDataProcessor(
+        const QUrl & url, const QByteArray & data, QObject * parent = nullptr);
+
+Q_SIGNALS:
+    void finished(QUrl url, QByteArray dataHash, QString mime);
+
+private:
+    virtual void run() override;
+
+private:
+    QUrl m_url;
+    QByteArray m_data;
+};
+
+} // namespace quentier
+
+#endif // QUENTIER_LIB_WIKI2NOTE_RESOURCE_DATA_PROCESSOR_H
@@ -17,15 +17,16 @@
  */
 
 #include "WikiArticleToNote.h"
+#include "ResourceDataProcessor.h"
+
+#include <lib/utility/Log.h>
 
 #include <quentier/enml/DecryptedTextManager.h>
 #include <quentier/enml/ENMLConverter.h>
 #include <quentier/logging/QuentierLogger.h>
 
 #include <QBuffer>
-#include <QCryptographicHash>
-#include <QMimeDatabase>
-#include <QMimeType>
+#include <QThreadPool>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
@@ -36,8 +37,22 @@ namespace quentier {
 WikiArticleToNote::WikiArticleToNote(
     ENMLConverter & enmlConverter, const qint64 timeoutMsec, QObject * parent) :
     QObject(parent),
-    m_enmlConverter(enmlConverter), m_networkReplyFetcherTimeout(timeoutMsec)
-{}
+    m_enmlConverter(enmlConverter),
+    m_pFetchService(new NetworkFetchService(
+        NETWORK_FETCH_SERVICE_DEFAULT_MAX_CONCURRENT_REQUESTS, QString(),
+        timeoutMsec, this))
+{
+    connectToFetchService();
+}
+
+WikiArticleToNote::WikiArticleToNote(
+    ENMLConverter & enmlConverter, NetworkFetchService & fetchService,
+    QObject * parent) :
+    QObject(parent),
+    m_enmlConverter(enmlConverter), m_pFetchService(&fetchService)
+{
+    connectToFetchService();
+}
 
 WikiArticleToNote::~WikiArticleToNote() = default;
 
@@ -81,42 +96,49 @@ void WikiArticleToNote::start(QByteArray wikiPageContent)
         return;
     }
 
-    if (m_imageDataFetchersWithProgress.isEmpty()) {
+    if (m_imageDataFetchProgressByRequestId.isEmpty()) {
         convertHtmlToEnmlAndComposeNote();
     }
     else {
         QNDEBUG(
             "wiki2note",
-            "Pending " << m_imageDataFetchersWithProgress.size()
+            "Pending " << m_imageDataFetchProgressByRequestId.size()
                        << " image data downloads");
     }
 }
 
-void WikiArticleToNote::onNetworkReplyFetcherFinished(
-    bool status, QByteArray fetchedData, ErrorString errorDescription)
+void WikiArticleToNote::onImageDataFetched(
+    QUuid requestId, bool status, QByteArray fetchedData,
+    ErrorString errorDescription)
 {
-    auto * pFetcher = qobject_cast<NetworkReplyFetcher *>(sender());
+    auto urlIt = m_imageUrlsByFetchRequestId.find(requestId);
+    if (urlIt == m_imageUrlsByFetchRequestId.end()) {
+        return;
+    }
+
+    const QUrl url = urlIt.value();
 
     QNDEBUG(
         "wiki2note",
-        "WikiArticleToNote::onNetworkReplyFetcherFinished: "
+        "WikiArticleToNote::onImageDataFetched: "
             << "status = " << (status ? "true" : "false")
-            << ", error description: " << errorDescription << "; url: "
-            << (pFetcher ? pFetcher->url().toString()
-                         : QStringLiteral("<unidentified>")));
+            << ", error description: " << errorDescription
+            << "; url: " << url.toString());
 
     if (!status) {
         finishWithError(errorDescription);
         return;
     }
 
-    createResource(fetchedData, pFetcher->url());
+    Q_UNUSED(m_imageUrlsByFetchRequestId.erase(urlIt))
+
+    createResource(fetchedData, url);
 
-    auto it = m_imageDataFetchersWithProgress.find(pFetcher);
-    if (Q_UNLIKELY(it == m_imageDataFetchersWithProgress.end())) {
+    auto it = m_imageDataFetchProgressByRequestId.find(requestId);
+    if (Q_UNLIKELY(it == m_imageDataFetchProgressByRequestId.end())) {
         errorDescription.setBase(
             QT_TR_NOOP("Internal error: detected reply from "
-                       "unidentified img data fetcher"));
+                       "unidentified img data fetch request"));
         finishWithError(errorDescription);
         return;
     }
@@ -124,39 +146,74 @@ void WikiArticleToNote::onNetworkReplyFetcherFinished(
     it.value() = 1.0;
     updateProgress();
 
-    m_imageDataFetchersWithProgress.erase(it);
-
-    if (m_imageDataFetchersWithProgress.isEmpty()) {
-        QNDEBUG("wiki2note", "Downloaded all images, converting HTML to note");
-        convertHtmlToEnmlAndComposeNote();
-    }
+    m_imageDataFetchProgressByRequestId.erase(it);
+    convertHtmlToEnmlIfReady();
 }
 
-void WikiArticleToNote::onNetworkReplyFetcherProgress(
-    qint64 bytesFetched, qint64 bytesTotal)
+void WikiArticleToNote::onImageDataFetchProgress(
+    QUuid requestId, qint64 bytesFetched, qint64 bytesTotal)
 {
-    auto * pFetcher = qobject_cast<NetworkReplyFetcher *>(sender());
+    auto it = m_imageDataFetchProgressByRequestId.find(requestId);
+    if (it == m_imageDataFetchProgressByRequestId.end()) {
+        return;
+    }
 
     QNDEBUG(
         "wiki2note",
-        "WikiArticleToNote::onNetworkReplyFetcherProgress: "
+        "WikiArticleToNote::onImageDataFetchProgress: "
             << "fetched " << bytesFetched << " out of " << bytesTotal
             << " bytes; url = "
-            << (pFetcher ? pFetcher->url().toString()
-                         : QStringLiteral("<unidentified>")));
+            << m_imageUrlsByFetchRequestId.value(requestId).toString());
 
     if (bytesTotal < 0) {
         // The exact number of bytes to download is not known
         return;
     }
 
-    auto it = m_imageDataFetchersWithProgress.find(pFetcher);
-    if (it != m_imageDataFetchersWithProgress.end()) {
-        it.value() = static_cast<double>(bytesFetched) /
-            static_cast<double>(std::max(bytesTotal, qint64(1)));
+    it.value() = static_cast<double>(bytesFetched) /
+        static_cast<double>(std::max(bytesTotal, qint64(1)));
 
-        updateProgress();
+    updateProgress();
+}
+
+void WikiArticleToNote::onResourceDataProcessed(
+    QUrl url, QByteArray dataHash, QString mime)
+{
+    if (!m_imageUrlsPendingDataProcessing.remove(url)) {
+        // Stale result, probably from before clear()
+        return;
+    }
+
+    QNDEBUG(
+        "wiki2note",
+        "WikiArticleToNote::onResourceDataProcessed: url = "
+            << url << ", mime = " << mime);
+
+    auto it = m_imageResourcesByUrl.find(url);
+    if (Q_UNLIKELY(it == m_imageResourcesByUrl.end())) {
+        ErrorString errorDescription(
+            QT_TR_NOOP("Internal error: no resource corresponding to "
+                       "processed img data"));
+        finishWithError(errorDescription);
+        return;
     }
+
+    auto & resource = it.value();
+    resource.setDataHash(dataHash);
+    resource.setMime(mime);
+
+    convertHtmlToEnmlIfReady();
+}
+
+void WikiArticleToNote::connectToFetchService()
+{
+    QObject::connect(
+        m_pFetchService.data(), &NetworkFetchService::finished, this,
+        &WikiArticleToNote::onImageDataFetched);
+
+    QObject::connect(
+        m_pFetchService.data(), &NetworkFetchService::downloadProgress, this,
+        &WikiArticleToNote::onImageDataFetchProgress);
 }
 
 void WikiArticleToNote::finishWithError(ErrorString errorDescription)
@@ -178,16 +235,18 @@ void WikiArticleToNote::clear()
 
     m_note = Note();
 
-    for (auto it = m_imageDataFetchersWithProgress.constBegin(),
-              end = m_imageDataFetchersWithProgress.constEnd();
-         it != end; ++it)
-    {
-        auto * pNetworkReplyFetcher = it.key();
-        pNetworkReplyFetcher->disconnect(this);
-        pNetworkReplyFetcher->deleteLater();
+    if (!m_pFetchService.isNull()) {
+        for (auto it = m_imageUrlsByFetchRequestId.constBegin(),
+                  end = m_imageUrlsByFetchRequestId.constEnd();
+             it != end; ++it)
+        {
+            m_pFetchService->cancel(it.key());
+        }
     }
 
-    m_imageDataFetchersWithProgress.clear();
+    m_imageUrlsByFetchRequestId.clear();
+    m_imageDataFetchProgressByRequestId.clear();
+    m_imageUrlsPendingDataProcessing.clear();
     m_imageResourcesByUrl.clear();
 
     m_html.clear();
@@ -198,19 +257,19 @@ void WikiArticleToNote::updateProgress()
 {
     QNDEBUG("wiki2note", "WikiArticleToNote::updateProgress");
 
-    if (m_imageDataFetchersWithProgress.isEmpty()) {
+    if (m_imageDataFetchProgressByRequestId.isEmpty()) {
         return;
     }
 
     double imageFetchersProgress = 0.0;
-    for (auto it = m_imageDataFetchersWithProgress.constBegin(),
-              end = m_imageDataFetchersWithProgress.constEnd();
+    for (auto it = m_imageDataFetchProgressByRequestId.constBegin(),
+              end = m_imageDataFetchProgressByRequestId.constEnd();
          it != end; ++it)
     {
         imageFetchersProgress += it.value();
     }
 
-    imageFetchersProgress /= m_imageDataFetchersWithProgress.size();
+    imageFetchersProgress /= m_imageDataFetchProgressByRequestId.size();
 
     // 10% of progress are reserved for final HTML to ENML conversion
     imageFetchersProgress *= 0.9;
@@ -314,25 +373,29 @@ bool WikiArticleToNote::setupImageDataFetching(ErrorString & errorDescription)
                         return false;
                     }
 
-                    QNDEBUG(
-                        "wiki2note",
-                        "Starting to download image: " << imgSrcUrl);
-
-                    auto * pFetcher = new NetworkReplyFetcher(
-                        imgSrcUrl, m_networkReplyFetcherTimeout);
-
-                    pFetcher->setParent(this);
-
-                    QObject::connect(
-                        pFetcher, &NetworkReplyFetcher::finished, this,
-                        &WikiArticleToNote::onNetworkReplyFetcherFinished);
+                    bool alreadyRequested = m_imageResourcesByUrl.contains(
+                        imgSrcUrl);
+
+                    if (!alreadyRequested) {
+                        for (const auto & url:
+                             qAsConst(m_imageUrlsByFetchRequestId))
+                        {
+                            if (url == imgSrcUrl) {
+                                alreadyRequested = true;
+                                break;
+                            }
+                        }
+                    }
 
-                    QObject::connect(
-                        pFetcher, &NetworkReplyFetcher::downloadProgress, this,
-                        &WikiArticleToNote::onNetworkReplyFetcherProgress);
+                    if (!alreadyRequested) {
+                        QNDEBUG(
+                            "wiki2note",
+                            "Starting to download image: " << imgSrcUrl);
 
-                    m_imageDataFetchersWithProgress[pFetcher] = 0.0;
-                    pFetcher->start();
+                        QUuid requestId = m_pFetchService->fetch(imgSrcUrl);
+                        m_imageUrlsByFetchRequestId[requestId] = imgSrcUrl;
+                        m_imageDataFetchProgressByRequestId[requestId] = 0.0;
+                    }
                 }
             }
 
@@ -389,9 +452,6 @@ void WikiArticleToNote::createResource(
     resource.setDataBody(fetchedData);
     resource.setDataSize(fetchedData.size());
 
-    resource.setDataHash(
-        QCryptographicHash::hash(fetchedData, QCryptographicHash::Md5));
-
     QString urlString = url.toString();
     QString fileName;
 
@@ -400,34 +460,44 @@ void WikiArticleToNote::createResource(
         fileName = urlString.mid(index + 1);
     }
 
-    QMimeDatabase mimeDatabase;
-    QMimeType mimeType = mimeDatabase.mimeTypeForData(fetchedData);
-    if (!mimeType.isValid()) {
-        // Try to extract the mime type from url
-        auto mimeTypes = mimeDatabase.mimeTypesForFileName(fileName);
-        for (auto it = mimeTypes.constBegin(), end = mimeTypes.constEnd();
-             it != end; ++it)
-        {
-            if (it->isValid()) {
-                mimeType = *it;
-                break;
-            }
-        }
-    }
-
-    if (mimeType.isValid()) {
-        resource.setMime(mimeType.name());
-    }
-    else {
-        // Just a wild guess as a last resort
-        resource.setMime(QStringLiteral("image/png"));
-    }
-
     qevercloud::ResourceAttributes & attributes = resource.resourceAttributes();
     attributes.sourceURL = urlString;
     if (!fileName.isEmpty()) {
         attributes.fileName = fileName;
     }
+
+    // Data hash and mime type are computed on the thread pool
+    Q_UNUSED(m_imageUrlsPendingDataProcessing.insert(url))
+
+    auto * pProcessor = new ResourceDataProcessor(url, fetchedData);
+
+    QObject::connect(
+        pProcessor, &ResourceDataProcessor::finished, this,
+        &WikiArticleToNote::onResourceDataProcessed, Qt::QueuedConnection);
+
+    QThreadPool::globalInstance()->start(pProcessor);
+}
+
+void WikiArticleToNote::convertHtmlToEnmlIfReady()
+{
+    if (!m_imageDataFetchProgressByRequestId.isEmpty()) {
+        QNDEBUG(
+            "wiki2note",
+            "Still pending " << m_imageDataFetchProgressByRequestId.size()
+                             << " image data downloads");
+        return;
+    }
+
+    if (!m_imageUrlsPendingDataProcessing.isEmpty()) {
+        QNDEBUG(
+            "wiki2note",
+            "Still pending " << m_imageUrlsPendingDataProcessing.size()
+                             << " image data processings");
+        return;
+    }
+
+    QNDEBUG("wiki2note", "Downloaded all images, converting HTML to note");
+    convertHtmlToEnmlAndComposeNote();
 }
 
 void WikiArticleToNote::convertHtmlToEnmlAndComposeNote()
@@ -19,14 +19,17 @@
 #ifndef QUENTIER_LIB_WIKI2NOTE_WIKI_ARTICLE_TO_NOTE_H
 #define QUENTIER_LIB_WIKI2NOTE_WIKI_ARTICLE_TO_NOTE_H
 
-#include <lib/network/NetworkReplyFetcher.h>
+#include <lib/network/NetworkFetchService.h>
 
 #include <quentier/types/Note.h>
 #include <quentier/types/Resource.h>
 
 #include <QHash>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
 #include <QUrl>
+#include <QUuid>
 
 namespace quentier {
 
@@ -39,11 +42,25 @@ class WikiArticleToNote final : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * Constructs WikiArticleToNote which would use its own
+     * NetworkFetchService without on-disk cache to download images
+     */
     explicit WikiArticleToNote(
         ENMLConverter & enmlConverter,
         const qint64 timeoutMsec = NETWORK_REPLY_FETCHER_DEFAULT_TIMEOUT_MSEC,
         QObject * parent = nullptr);
 
+    /**
+     * Constructs WikiArticleToNote which would use the passed in
+     * NetworkFetchService to download images; the service is meant to be
+     * shared between multiple WikiArticleToNote instances and must outlive
+     * them
+     */
+    explicit WikiArticleToNote(
+        ENMLConverter & enmlConverter, NetworkFetchService & fetchService,
+        QObject * parent = nullptr);
+
     virtual ~WikiArticleToNote() override;
 
     bool isStarted() const
@@ -74,12 +91,18 @@ public Q_SLOTS:
     void start(QByteArray wikiPageContent);
 
 private Q_SLOTS:
-    void onNetworkReplyFetcherFinished(
-        bool status, QByteArray fetchedData, ErrorString errorDescription);
+    void onImageDataFetched(
+        QUuid requestId, bool status, QByteArray fetchedData,
+        ErrorString errorDescription);
 
-    void onNetworkReplyFetcherProgress(qint64 bytesFetched, qint64 bytesTotal);
+    void onImageDataFetchProgress(
+        QUuid requestId, qint64 bytesFetched, qint64 bytesTotal);
+
+    void onResourceDataProcessed(QUrl url, QByteArray dataHash, QString mime);
 
 private:
+    void connectToFetchService();
+
     void finishWithError(ErrorString errorDescription);
     void clear();
 
@@ -89,20 +112,28 @@ private:
     bool setupImageDataFetching(ErrorString & errorDescription);
 
     void createResource(const QByteArray & fetchedData, const QUrl & url);
+    void convertHtmlToEnmlIfReady();
 
     void convertHtmlToEnmlAndComposeNote();
     bool preprocessHtmlForConversionToEnml();
 
 private:
     ENMLConverter & m_enmlConverter;
-    const qint64 m_networkReplyFetcherTimeout;
+    // Shared fetch service might be destroyed before this object during
+    // the teardown so guarding it with QPointer
+    QPointer<NetworkFetchService> m_pFetchService;
 
     Note m_note;
 
     bool m_started = false;
     bool m_finished = false;
 
-    QHash<NetworkReplyFetcher *, double> m_imageDataFetchersWithProgress;
+    QHash<QUuid, QUrl> m_imageUrlsByFetchRequestId;
+    QHash<QUuid, double> m_imageDataFetchProgressByRequestId;
+
+    // Urls of images which data is being hashed and mime type detected
+    // on the thread pool
+    QSet<QUrl> m_imageUrlsPendingDataProcessing;
 
     // Resources created from imgs downloaded by fetchers by imgs' urls
     QHash<QUrl, Resource> m_imageResourcesByUrl;
@@ -18,6 +18,8 @@
 
 #include "WikiRandomArticleUrlFetcher.h"
 
+#include <lib/utility/Log.h>
+
 #include <quentier/logging/QuentierLogger.h>
 
 #include <QXmlStreamReader>